@@ -18,10 +18,15 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
+#include <string.h>
+
 #include "DiscardClientHandler.h"
 
 #include "cetty/bootstrap/ClientBootstrap.h"
 #include "cetty/channel/socket/asio/AsioClientSocketChannelFactory.h"
+#if defined(__linux__)
+#include "cetty/channel/socket/epoll/EpollClientSocketChannelFactory.h"
+#endif
 #include "cetty/channel/IpAddress.h"
 #include "cetty/channel/SocketAddress.h"
 #include "cetty/channel/Channels.h"
@@ -29,6 +34,9 @@
 
 using namespace cetty::channel;
 using namespace cetty::channel::socket::asio;
+#if defined(__linux__)
+using namespace cetty::channel::socket::epoll;
+#endif
 
 using namespace cetty::bootstrap;
 using namespace cetty::buffer;
@@ -46,9 +54,9 @@ using namespace cetty::util;
 
 int main(int argc, const char* argv[]) {
     // Print usage if no argument is specified.
-    if (argc < 3 || argc > 4) {
+    if (argc < 3 || argc > 5) {
         printf("Usage: DiscardClient"
-                " <host> <port> [<first message size>]");
+                " <host> <port> [<first message size> <asio|epoll>]");
         return -1;
     }
 
@@ -56,7 +64,7 @@ int main(int argc, const char* argv[]) {
     std::string host = argv[1];
     int port = Integer::parse(argv[2]);
     int firstMessageSize;
-    if (argc == 4) {
+    if (argc >= 4) {
         firstMessageSize = Integer::parse(argv[3]);
     }
     else {
@@ -64,8 +72,17 @@ int main(int argc, const char* argv[]) {
     }
 
     // Configure the client.
-    ClientBootstrap bootstrap(
-        ChannelFactoryPtr(new AsioClientSocketChannelFactory(1)));
+    ChannelFactoryPtr factory;
+#if defined(__linux__)
+    if (argc == 5 && strcmp(argv[4], "epoll") == 0) {
+        factory = ChannelFactoryPtr(new EpollClientSocketChannelFactory(1));
+    }
+#endif
+    if (!factory) {
+        factory = ChannelFactoryPtr(new AsioClientSocketChannelFactory(1));
+    }
+
+    ClientBootstrap bootstrap(factory);
 
     // Set up the pipeline factory.
     bootstrap.getPipeline()->addLast(
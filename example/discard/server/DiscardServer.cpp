@@ -18,16 +18,24 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
+#include <string.h>
+
 #include "cetty/bootstrap/ServerBootstrap.h"
 #include "cetty/channel/SocketAddress.h"
 #include "cetty/channel/Channels.h"
 #include "cetty/channel/socket/asio/AsioServerSocketChannelFactory.h"
+#if defined(__linux__)
+#include "cetty/channel/socket/epoll/EpollServerSocketChannelFactory.h"
+#endif
 
 #include "DiscardServerHandler.h"
 
 using namespace cetty::bootstrap;
 using namespace cetty::channel;
 using namespace cetty::channel::socket::asio;
+#if defined(__linux__)
+using namespace cetty::channel::socket::epoll;
+#endif
 
 /**
  * Discards any incoming data.
@@ -39,9 +47,18 @@ using namespace cetty::channel::socket::asio;
  */
 
 int main(int argc, char* argv[]) {
-    // Configure the server.
-    ServerBootstrap bootstrap(
-        ChannelFactoryPtr(new AsioServerSocketChannelFactory(-1)));
+    // Configure the server, DiscardServer [asio|epoll]
+    ChannelFactoryPtr factory;
+#if defined(__linux__)
+    if (argc >= 2 && strcmp(argv[1], "epoll") == 0) {
+        factory = ChannelFactoryPtr(new EpollServerSocketChannelFactory(-1));
+    }
+#endif
+    if (!factory) {
+        factory = ChannelFactoryPtr(new AsioServerSocketChannelFactory(-1));
+    }
+
+    ServerBootstrap bootstrap(factory);
 
     // Set up the pipeline factory.
     bootstrap.getPipeline()->addLast(
@@ -1,5 +1,6 @@
 // echo.cpp : Defines the entry point for the console application.
 //
+#include <string.h>
 #include "boost/thread.hpp"
 #include "boost/date_time.hpp"
 
@@ -7,6 +8,9 @@
 
 #include "cetty/bootstrap/ClientBootstrap.h"
 #include "cetty/channel/socket/asio/AsioClientSocketChannelFactory.h"
+#if defined(__linux__)
+#include "cetty/channel/socket/epoll/EpollClientSocketChannelFactory.h"
+#endif
 #include "cetty/channel/IpAddress.h"
 #include "cetty/channel/SocketAddress.h"
 #include "cetty/channel/Channels.h"
@@ -15,6 +19,9 @@
 
 using namespace cetty::channel;
 using namespace cetty::channel::socket::asio;
+#if defined(__linux__)
+using namespace cetty::channel::socket::epoll;
+#endif
 
 using namespace cetty::bootstrap;
 using namespace cetty::buffer;
@@ -24,9 +31,9 @@ using namespace cetty::util;
 int main(int argc, char* argv[])
 {
     // Print usage if no argument is specified.
-    if (argc < 3 || argc > 7) {
+    if (argc < 3 || argc > 8) {
         printf(
-            "Usage: EchoClient \n\ <host> <port> [<first message size> <client count> <send message intervals> <io thread count>]");
+            "Usage: EchoClient \n\ <host> <port> [<first message size> <client count> <send message intervals> <io thread count> <asio|epoll>]");
         return -1;
     }
 
@@ -54,7 +61,15 @@ int main(int argc, char* argv[])
     }
 
     // Configure the client.
-    ChannelFactoryPtr factory = ChannelFactoryPtr(new AsioClientSocketChannelFactory(ioThreadCount));
+    ChannelFactoryPtr factory;
+#if defined(__linux__)
+    if (argc >= 8 && strcmp(argv[7], "epoll") == 0) {
+        factory = ChannelFactoryPtr(new EpollClientSocketChannelFactory(ioThreadCount));
+    }
+#endif
+    if (!factory) {
+        factory = ChannelFactoryPtr(new AsioClientSocketChannelFactory(ioThreadCount));
+    }
     ClientBootstrap bootstrap(factory);
 
     // Set up the pipeline factory.
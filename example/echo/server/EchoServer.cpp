@@ -1,20 +1,28 @@
 // echo.cpp : Defines the entry point for the console application.
 //
 
+#include <string.h>
 #include <boost/thread.hpp>
 #include <boost/date_time.hpp>
 
 #include "EchoServerHandler.h"
 
 #include "cetty/bootstrap/ServerBootstrap.h"
+#include "cetty/buffer/PooledChannelBufferFactory.h"
 
 #include "cetty/channel/Channels.h"
 #include "cetty/channel/IpAddress.h"
 #include "cetty/channel/SocketAddress.h"
 #include "cetty/channel/socket/asio/AsioServerSocketChannelFactory.h"
+#if defined(__linux__)
+#include "cetty/channel/socket/epoll/EpollServerSocketChannelFactory.h"
+#endif
 
 using namespace cetty::channel;
 using namespace cetty::channel::socket::asio;
+#if defined(__linux__)
+using namespace cetty::channel::socket::epoll;
+#endif
 
 using namespace cetty::bootstrap;
 using namespace cetty::buffer;
@@ -23,16 +31,29 @@ using namespace cetty::util;
 
 int main(int argc, char* argv[]) {
     int threadCount = -1;
-    if (argc == 2) {
+    if (argc >= 2) {
         threadCount = atoi(argv[1]);
     }
 
-    ServerBootstrap bootstrap(ChannelFactoryPtr(new AsioServerSocketChannelFactory(threadCount)));
+    // EchoServer [<io thread count> [asio|epoll]]
+    ChannelFactoryPtr factory;
+#if defined(__linux__)
+    if (argc >= 3 && strcmp(argv[2], "epoll") == 0) {
+        factory = ChannelFactoryPtr(new EpollServerSocketChannelFactory(threadCount));
+    }
+#endif
+    if (!factory) {
+        factory = ChannelFactoryPtr(new AsioServerSocketChannelFactory(threadCount));
+    }
+
+    ServerBootstrap bootstrap(factory);
     bootstrap.setPipeline(Channels::pipeline(ChannelHandlerPtr(new EchoServerHandler)));
 
 	bootstrap.setOption("child.tcpNoDelay", boost::any(true));
 	bootstrap.setOption("reuseAddress", boost::any(true));
     bootstrap.setOption("backlog", boost::any(4096));
+    bootstrap.setOption("child.bufferFactory",
+                        boost::any(&PooledChannelBufferFactory::getInstance()));
 
     // Bind and start to accept incoming connections.
     Channel* c = bootstrap.bind(SocketAddress(IpAddress::IPv4, 1980));
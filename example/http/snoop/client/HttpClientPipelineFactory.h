@@ -24,6 +24,7 @@
 #include "cetty/channel/Channels.h"
 #include "cetty/channel/ChannelPipelineFactory.h"
 #include "cetty/handler/codec/http/HttpClientCodec.h"
+#include "cetty/handler/codec/http/HttpContentDecompressor.h"
 
 #include "HttpResponseHandler.h"
 
@@ -66,7 +67,7 @@ public:
         pipeline->addLast("codec", ChannelHandlerPtr(new HttpClientCodec));
 
         // Remove the following line if you don't want automatic content decompression.
-        //pipeline->addLast("inflater", new HttpContentDecompressor());
+        pipeline->addLast("inflater", ChannelHandlerPtr(new HttpContentDecompressor()));
 
         // Uncomment the following line if you don't want to handle HttpChunks.
         //pipeline.addLast("aggregator", new HttpChunkAggregator(1048576));
@@ -19,11 +19,13 @@
  */
 
 #include "cetty/bootstrap/ServerBootstrap.h"
+#include "cetty/buffer/PooledChannelBufferFactory.h"
 #include "cetty/channel/SocketAddress.h"
 #include "cetty/channel/socket/asio/AsioServerSocketChannelFactory.h"
 #include "HttpServerPipelineFactory.h"
 
 using namespace cetty::bootstrap;
+using namespace cetty::buffer;
 using namespace cetty::channel;
 using namespace cetty::channel::socket::asio;
 
@@ -46,6 +48,8 @@ int main(int argc, const char* argv[]) {
     bootstrap.setOption("child.tcpNoDelay", boost::any(true));
     bootstrap.setOption("reuseAddress", boost::any(true));
     bootstrap.setOption("backlog", boost::any(4096));
+    bootstrap.setOption("child.bufferFactory",
+                        boost::any(&PooledChannelBufferFactory::getInstance()));
 
     // Set up the event pipeline factory.
     bootstrap.setPipelineFactory(
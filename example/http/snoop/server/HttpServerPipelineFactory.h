@@ -26,6 +26,7 @@
 
 #include "cetty/handler/codec/http/HttpRequestDecoder.h"
 #include "cetty/handler/codec/http/HttpResponseEncoder.h"
+#include "cetty/handler/codec/http/HttpContentCompressor.h"
 
 #include "HttpRequestHandler.h"
 
@@ -62,7 +63,7 @@ public:
         pipeline->addLast("encoder", ChannelHandlerPtr(new HttpResponseEncoder()));
         
         // Remove the following line if you don't want automatic content compression.
-        //pipeline.addLast("deflater", new HttpContentCompressor());
+        pipeline->addLast("deflater", ChannelHandlerPtr(new HttpContentCompressor()));
 
         pipeline->addLast("handler", ChannelHandlerPtr(new HttpRequestHandler()));
 
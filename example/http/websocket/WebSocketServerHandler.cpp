@@ -17,3 +17,5 @@
 #include "WebSocketServerHandler.h"
 
 const  std::string WebSocketServerHandler::WEBSOCKET_PATH = "/websocket";
+
+ChannelGroup WebSocketServerHandler::channels("websocket-chat");
@@ -14,6 +14,7 @@
  * under the License.
  */
 
+#include <boost/scoped_ptr.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 
 #include "cetty/channel/Channel.h"
@@ -24,6 +25,7 @@
 #include "cetty/channel/MessageEvent.h"
 #include "cetty/channel/ExceptionEvent.h"
 #include "cetty/channel/ChannelFutureListener.h"
+#include "cetty/channel/group/ChannelGroup.h"
 
 #include "cetty/handler/codec/http/DefaultHttpResponse.h"
 #include "cetty/handler/codec/http/HttpMessage.h"
@@ -36,12 +38,19 @@
 #include "cetty/handler/codec/http/websocket/WebSocketFrameEncoder.h"
 #include "cetty/handler/codec/http/websocket/WebSocketFrameDecoder.h"
 
+#include "cetty/handler/codec/http/websocketx/WebSocketFrame.h"
+#include "cetty/handler/codec/http/websocketx/WebSocket13FrameEncoder.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketServerHandshaker13.h"
+
 #include "WebSocketServerIndexPage.h"
 
 using namespace cetty::channel;
+using namespace cetty::channel::group;
 using namespace cetty::handler::codec::http;
 using namespace cetty::handler::codec::http::websocket;
 
+namespace websocketx = cetty::handler::codec::http::websocketx;
+
 /**
  * @author <a href="http://www.jboss.org/netty/">The Netty Project</a>
  * @author <a href="http://gleamynode.net/">Trustin Lee</a>
@@ -67,6 +76,11 @@ public:
         if (frame) {
             handleWebSocketFrame(ctx, frame);
         }
+        websocketx::WebSocketFramePtr framex =
+            e.getMessage().smartPointer<websocketx::WebSocketFrame>();
+        if (framex) {
+            handleWebSocketFrame(ctx, framex);
+        }
     }
 
     virtual void exceptionCaught(ChannelHandlerContext& ctx, const ExceptionEvent& e) {
@@ -98,6 +112,25 @@ private:
             return;
         }
 
+        // Serve the RFC 6455 handshake request.
+        if (req.getUri().compare(WEBSOCKET_PATH) == 0 &&
+                websocketx::WebSocketServerHandshaker13::isUpgradeRequest(req) &&
+                req.containsHeader(HttpHeaders::Names::SEC_WEBSOCKET_VERSION)) {
+            if (req.getHeader(HttpHeaders::Names::SEC_WEBSOCKET_VERSION)
+                    != websocketx::WebSocketServerHandshaker13::VERSION) {
+                websocketx::WebSocketServerHandshaker13::sendUnsupportedVersionResponse(
+                    ctx.getChannel());
+                return;
+            }
+
+            handshaker.reset(new websocketx::WebSocketServerHandshaker13("", true));
+            handshaker->handshake(ctx.getChannel(), req);
+
+            // joins the chat.
+            channels.add(ctx.getChannel());
+            return;
+        }
+
         // Serve the WebSocket handshake request.
         if (req.getUri().compare(WEBSOCKET_PATH) == 0 &&
 			boost::iequals(HttpHeaders::Values::UPGRADE, req.getHeader(HttpHeaders::Names::CONNECTION)) &&
@@ -169,6 +202,31 @@ private:
                 //new DefaultWebSocketFrame(frame.getTextData().toUpperCase()));
     }
 
+    void handleWebSocketFrame(ChannelHandlerContext& ctx,
+                              const websocketx::WebSocketFramePtr& frame) {
+        const websocketx::WebSocketFrameType& type = frame->getType();
+
+        if (type == websocketx::WebSocketFrameType::CLOSE) {
+            handshaker->close(ctx.getChannel(), frame);
+        }
+        else if (type == websocketx::WebSocketFrameType::PING) {
+            ctx.getChannel().write(ChannelMessage(websocketx::WebSocketFramePtr(
+                new websocketx::WebSocketFrame(websocketx::WebSocketFrameType::PONG,
+                                               frame->getBinaryData()))));
+        }
+        else if (type == websocketx::WebSocketFrameType::TEXT &&
+                 frame->isFinalFragment()) {
+            // Broadcast the chat message, which is encoded only once.
+            channels.write(ChannelMessage(frame),
+                           websocketx::WebSocket13FrameEncoder::encodeFrame,
+                           false);
+        }
+        else if (type != websocketx::WebSocketFrameType::PONG) {
+            // Echo the other messages back, fragment by fragment.
+            ctx.getChannel().write(ChannelMessage(frame));
+        }
+    }
+
     void sendHttpResponse(ChannelHandlerContext& ctx, HttpRequest& req, const HttpResponsePtr& res) {
         // Generate an error page if response status code is not OK (200).
         if (res->getStatus().getCode() != 200) {
@@ -192,4 +250,9 @@ private:
 
 private:
 	static const  std::string WEBSOCKET_PATH;
+
+    // all the RFC 6455 clients, which share the chat messages.
+    static ChannelGroup channels;
+
+    boost::scoped_ptr<websocketx::WebSocketServerHandshaker13> handshaker;
 };
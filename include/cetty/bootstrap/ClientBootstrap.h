@@ -53,6 +53,10 @@ using namespace cetty::channel;
  * For the detailed list of available options, please refer to
  * {@link ChannelConfig} and its sub-types.
  *
+ * The <tt>"channelPlacement"</tt> option, a <tt>std::string</tt>, chooses how
+ * the new channels are spread over the I/O threads of the factory,
+ * see {@link SocketChannelFactory#setChannelPlacement(const std::string&)}.
+ *
  * <h3>Configuring a channel pipeline</h3>
  *
  * Every channel has its own {@link ChannelPipeline} and you can configure it
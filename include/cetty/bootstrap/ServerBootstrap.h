@@ -80,6 +80,10 @@ using namespace cetty::channel;
  * For the detailed list of available options, please refer to
  * {@link ChannelConfig} and its sub-types.
  *
+ * The <tt>"channelPlacement"</tt> option, a <tt>std::string</tt>, chooses how
+ * the accepted channels are spread over the I/O threads of the factory,
+ * see {@link ServerSocketChannelFactory#setChannelPlacement(const std::string&)}.
+ *
  * <h3>Configuring a parent channel pipeline</h3>
  *
  * It is rare to customize the pipeline of a parent channel because what it is
@@ -166,6 +166,12 @@ public:
     virtual std::wstring toWideString(const Charset& charset);
     virtual std::wstring toWideString(int index, int length, const Charset& charset);
 
+    /**
+     * Returns the backing array of the buffer as one region when
+     * {@link #hasArray()}, or <tt>-1</tt> otherwise.
+     */
+    virtual int getContiguousBytes(int index, ConstArray& bytes) const;
+
     virtual int indexOf(int fromIndex, int toIndex, boost::int8_t value) const;
     virtual int indexOf(int fromIndex,
                         int toIndex,
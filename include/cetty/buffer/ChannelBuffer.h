@@ -1736,6 +1736,22 @@ public:
      */
     virtual int arrayOffset() const = 0;
 
+    /**
+     * Gets the contiguous memory which holds the byte at the specified
+     * absolute <tt>index</tt>, so the bytes can be scanned in bulk rather
+     * than by {@link #getByte(int)} one by one.  A heap buffer has only one
+     * region, a composite buffer has one region per component.
+     * This method does not modify <tt>readerIndex</tt> or <tt>writerIndex</tt>
+     * of this buffer.
+     *
+     * @param bytes set to the whole region when it is found
+     *
+     * @return the absolute index of the first byte of the region, or
+     *         <tt>-1</tt> if <tt>index</tt> is out of range or the bytes are
+     *         not accessible in memory.
+     */
+    virtual int getContiguousBytes(int index, ConstArray& bytes) const = 0;
+
     /**
      * Decodes this buffer's readable bytes into a string(utf-8) with the
      * specified character set name.  This method is identical to
@@ -56,6 +56,27 @@ public:
      */
     virtual bool find(const ChannelBuffer& buffer, int guessedIndex) const = 0;
 
+    /**
+     * Returns <tt>true</tt> if the finder only looks at the byte at the
+     * guessed index, so the buffer may pass its contiguous bytes to
+     * {@link #findFirst(const char*, int)} and
+     * {@link #findLast(const char*, int)} instead of calling
+     * {@link #find(const ChannelBuffer&, int)} for each index.
+     */
+    virtual bool isByteFinder() const { return false; }
+
+    /**
+     * Returns the offset of the first matched byte in <tt>bytes</tt>, or
+     * <tt>-1</tt> if not found.  Only called when {@link #isByteFinder()}.
+     */
+    virtual int findFirst(const char* bytes, int length) const { return -1; }
+
+    /**
+     * Returns the offset of the last matched byte in <tt>bytes</tt>, or
+     * <tt>-1</tt> if not found.  Only called when {@link #isByteFinder()}.
+     */
+    virtual int findLast(const char* bytes, int length) const { return -1; }
+
     /**
      * Index finder which locates a <tt>NUL (0x00)</tt> byte.
      */
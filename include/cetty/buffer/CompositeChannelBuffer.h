@@ -81,6 +81,8 @@ public:
     virtual ConstArray array() const;
     virtual int arrayOffset() const;
 
+    virtual int getContiguousBytes(int index, ConstArray& bytes) const;
+
     virtual int capacity() const;
 
     virtual boost::int8_t getByte(int index) const;
@@ -81,6 +81,10 @@ public:
         return buffer->arrayOffset();
     }
 
+    virtual int getContiguousBytes(int index, ConstArray& bytes) const {
+        return buffer->getContiguousBytes(index, bytes);
+    }
+
     virtual boost::int8_t getByte(int index) const {
         return buffer->getByte(index);
     }
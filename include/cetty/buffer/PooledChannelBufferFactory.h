@@ -0,0 +1,185 @@
+#if !defined(CETTY_BUFFER_POOLEDCHANNELBUFFERFACTORY_H)
+#define CETTY_BUFFER_POOLEDCHANNELBUFFERFACTORY_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+#include <utility>
+#include <boost/thread/tss.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "cetty/buffer/AbstractChannelBufferFactory.h"
+
+namespace cetty { namespace buffer {
+
+/**
+ * A {@link ChannelBufferFactory} which recycles the heap buffers it creates.
+ *
+ * The capacity of a buffer is rounded up to a power of two size class, from
+ * {@link #MIN_SIZE_CLASS} to the <tt>maxSizeClass</tt> of the factory, and
+ * the buffer object and its bytes are allocated as one block.  When the last
+ * reference to the buffer is released, the block is kept in a free list of
+ * the thread which allocated it, and is handed out again by the next
+ * {@link #getBuffer(ByteOrder, int)} of the same size class on that thread.
+ * So once the I/O threads have warmed up, creating and releasing buffers
+ * does not call <tt>malloc</tt> at all.
+ *
+ * A buffer released by another thread is pushed back to the owner thread
+ * through a lock-free queue, which the owner drains when its free list of a
+ * size class runs out.  When a thread exits, its cached blocks are freed,
+ * and the buffers it allocated which are released later are freed directly.
+ * The caches a thread keeps for a destroyed factory are freed when the
+ * thread exits, except the one of the thread destroying the factory.
+ *
+ * The buffers larger than the <tt>maxSizeClass</tt> are not pooled.
+ *
+ * The factory must outlive all the buffers it has created.
+ *
+ * <pre>
+ * channel.getConfig().setBufferFactory(&PooledChannelBufferFactory::getInstance());
+ * </pre>
+ */
+class PooledChannelBufferFactory : public AbstractChannelBufferFactory,
+                                   private boost::noncopyable {
+public:
+    /**
+     * the smallest size class, in bytes.
+     */
+    static const int MIN_SIZE_CLASS = 64;
+
+    /**
+     * the default largest size class, in bytes.
+     */
+    static const int DEFAULT_MAX_SIZE_CLASS = 1024 * 1024;
+
+    /**
+     * the default maximum blocks kept in the free list of one size class
+     * of one thread.
+     */
+    static const int DEFAULT_MAX_CACHED_COUNT = 256;
+
+public:
+    /**
+     * Returns the shared big-endian factory, which is never destroyed.
+     */
+    static ChannelBufferFactory& getInstance();
+
+    /**
+     * Returns the shared factory of the specified {@link ByteOrder},
+     * which is never destroyed.
+     */
+    static ChannelBufferFactory& getInstance(ByteOrder endianness);
+
+public:
+    /**
+     * Creates a new factory whose default {@link ByteOrder} is
+     * {@link ByteOrder#BIG_ENDIAN}.
+     */
+    PooledChannelBufferFactory();
+
+    /**
+     * Creates a new factory with the specified default {@link ByteOrder}.
+     */
+    PooledChannelBufferFactory(ByteOrder defaultOrder);
+
+    /**
+     * Creates a new factory.
+     *
+     * @param maxSizeClass   the largest pooled capacity, will be rounded up
+     *                       to a power of two
+     * @param maxCachedCount the maximum blocks kept in the free list of one
+     *                       size class of one thread
+     *
+     * @throws InvalidArgumentException
+     *         if <tt>maxSizeClass</tt> or <tt>maxCachedCount</tt> is negative.
+     */
+    PooledChannelBufferFactory(ByteOrder defaultOrder,
+                               int maxSizeClass,
+                               int maxCachedCount);
+
+    virtual ~PooledChannelBufferFactory();
+
+    using AbstractChannelBufferFactory::getBuffer;
+
+    virtual ChannelBufferPtr getBuffer(ByteOrder order, int capacity);
+
+    /**
+     * wraps the <tt>array</tt> without copying, as the
+     * {@link HeapChannelBufferFactory} does.
+     */
+    virtual ChannelBufferPtr getBuffer(ByteOrder order,
+                                       const Array& array,
+                                       int offset,
+                                       int length);
+
+    int getMaxSizeClass() const { return maxSizeClass; }
+    int getMaxCachedCount() const { return maxCachedCount; }
+
+    /**
+     * Returns the count of the free blocks cached by the calling thread,
+     * not including the ones released by the other threads and not drained
+     * yet.
+     */
+    int getCachedCount() const;
+
+    /**
+     * Returns the size class of the <tt>capacity</tt>, the smallest power
+     * of two which is not less than both the <tt>capacity</tt> and the
+     * {@link #MIN_SIZE_CLASS}.
+     */
+    static int sizeClassOf(int capacity);
+
+private:
+    class Block;
+    class ThreadCache;
+
+    // the caches of a thread, of all the factories it has used.  The
+    // factories are told apart by the ids, which are never reused, unlike
+    // the addresses.
+    typedef std::vector<std::pair<long, ThreadCache*> > ThreadCacheList;
+
+    template<typename HeapBuffer> friend class PooledHeapChannelBuffer;
+
+    void init(int maxSizeClass, int maxCachedCount);
+
+    // the cache of the calling thread, NULL if the thread has not one yet.
+    ThreadCache* currentThreadCache() const;
+    ThreadCache& threadCache() const;
+
+    // the cache of the calling thread for the factory of the id, which
+    // may have been destroyed.
+    static ThreadCache* findThreadCache(long factoryId);
+
+    // return the block of the buffer, called by the deleting buffer.
+    static void release(void* buffer);
+
+    // the cleanup of the thread's caches when the thread exits.
+    static void orphanThreadCaches(ThreadCacheList* list);
+
+private:
+    // never destroyed, the buffers may be released during the exit.
+    static boost::thread_specific_ptr<ThreadCacheList>& threadCaches();
+
+    int maxSizeClass;
+    int maxCachedCount;
+    int sizeClassCount;
+    long id;
+};
+
+}}
+
+#endif //#if !defined(CETTY_BUFFER_POOLEDCHANNELBUFFERFACTORY_H)
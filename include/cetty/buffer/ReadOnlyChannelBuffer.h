@@ -81,6 +81,10 @@ public:
         throw ReadOnlyBufferException();
     }
 
+    virtual int getContiguousBytes(int index, ConstArray& bytes) const {
+        return buffer->getContiguousBytes(index, bytes);
+    }
+
     virtual void discardReadBytes() {
         throw ReadOnlyBufferException();
     }
@@ -142,7 +146,12 @@ public:
         return ChannelBufferPtr(new ReadOnlyChannelBuffer(buf));
     }
 
-    virtual void slice(Array& array) {}
+    /**
+     * the slices of the bytes are only exposed to be written to a channel.
+     */
+    virtual void slice(Array& array) {
+        buffer->slice(readerIndex(), AbstractChannelBuffer::readableBytes())->readSlice(array);
+    }
 
     virtual boost::int8_t getByte(int index) const {
         return buffer->getByte(index);
@@ -168,12 +177,22 @@ public:
         return buffer->capacity();
     }
 
-    virtual void readSlice(Array& array){}
-    virtual void readSlice(GatheringBuffer& gathering) {}
+    virtual void readSlice(Array& array) {
+        slice(array);
+        AbstractChannelBuffer::readerIndex(writerIndex());
+    }
+
+    virtual void readSlice(GatheringBuffer& gathering) {
+        int length = AbstractChannelBuffer::readableBytes();
+        if (length > 0) {
+            buffer->slice(readerIndex(), length)->readSlice(gathering);
+            AbstractChannelBuffer::readerIndex(writerIndex());
+        }
+    }
 
 protected:
     ReadOnlyChannelBuffer(const ReadOnlyChannelBuffer& buffer) : buffer(buffer.buffer) {
-        AbstractChannelBuffer::setIndex(this->buffer->readerIndex(), this->buffer->writerIndex());
+        AbstractChannelBuffer::setIndex(buffer.readerIndex(), buffer.writerIndex());
     }
 
 private:
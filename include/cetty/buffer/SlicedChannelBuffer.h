@@ -81,6 +81,8 @@ public:
         return buffer->arrayOffset() + adjustment;
     }
 
+    virtual int getContiguousBytes(int index, ConstArray& bytes) const;
+
     virtual boost::int8_t  getByte(int index) const;
     virtual boost::int16_t getShort(int index) const;
     virtual boost::int32_t getUnsignedMedium(int index) const;
@@ -106,8 +108,8 @@ public:
     virtual void setBytes(int index, const ChannelBuffer& src, int srcIndex, int length);
     virtual int  setBytes(int index, InputStream& in, int length);
 
-    virtual void readSlice(Array& array){}
-    virtual void readSlice(GatheringBuffer& gathering){}
+    virtual void readSlice(Array& array);
+    virtual void readSlice(GatheringBuffer& gathering);
 
 private:
     void checkIndex(int index) const;
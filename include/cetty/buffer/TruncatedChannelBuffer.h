@@ -77,6 +77,8 @@ public:
         return buffer->arrayOffset();
     }
 
+    virtual int getContiguousBytes(int index, ConstArray& bytes) const;
+
     virtual void readableBytes(Array& array);
     virtual void writableBytes(Array& array);
 
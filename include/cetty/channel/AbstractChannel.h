@@ -23,6 +23,7 @@
 
 #include <string>
 #include <map>
+#include <boost/detail/atomic_count.hpp>
 
 #include "cetty/channel/Channel.h"
 #include "cetty/channel/ChannelPipeline.h"
@@ -32,6 +33,7 @@
 #include "cetty/channel/SucceededChannelFuture.h"
 #include "cetty/channel/DefaultChannelFuture.h"
 #include "cetty/channel/FailedChannelFuture.h"
+#include "cetty/channel/VoidChannelFuture.h"
 
 #include "cetty/channel/Channels.h"
 #include "cetty/channel/SocketAddress.h"
@@ -121,6 +123,33 @@ public:
         return this->succeededFuture;
     }
 
+    /**
+     * Returns the cached {@link VoidChannelFuture} instance.
+     */
+    virtual ChannelFuturePtr& getVoidFuture() {
+        return this->voidFuture;
+    }
+
+    /**
+     * Returns <tt>NULL</tt>, the transports which run every channel in one
+     * thread override it.
+     */
+    virtual ChannelEventLoop* getEventLoop() const {
+        return NULL;
+    }
+
+    virtual void retain() {
+        ++retainCount;
+    }
+
+    /**
+     * Deletes this channel in its event loop when the count of the
+     * retains drops to zero, or at once if there is no event loop.  The
+     * transport holds the first count, which it releases instead of
+     * deleting the channel after it is closed.
+     */
+    virtual void release();
+
     virtual ChannelFuturePtr connect(const SocketAddress& remoteAddress) {
         return Channels::connect(*this, remoteAddress);
     }
@@ -185,7 +214,8 @@ protected:
     AbstractChannel(
         Channel* parent, ChannelFactory* factory,
         ChannelPipeline* pipeline, ChannelSink* sink)
-            : parent(parent), factory(factory), pipeline(pipeline), interestOps(OP_READ) {
+            : parent(parent), factory(factory), pipeline(pipeline), interestOps(OP_READ),
+              retainCount(1) {
         BOOST_ASSERT(factory && pipeline && sink && "input must not to be NULL!");
         id = allocateId(this);
         init(pipeline, sink);
@@ -209,7 +239,8 @@ protected:
             Integer id,
             Channel* parent, ChannelFactory* factory,
             ChannelPipeline* pipeline, ChannelSink* sink)
-            : id(id), parent(parent), factory(factory), pipeline(pipeline), interestOps(OP_READ) {
+            : id(id), parent(parent), factory(factory), pipeline(pipeline), interestOps(OP_READ),
+              retainCount(1) {
         BOOST_ASSERT(factory && pipeline && sink && "input must not to be NULL!");
         init(pipeline, sink);
     }
@@ -309,11 +340,16 @@ private:
     void init(ChannelPipeline* pipeline, ChannelSink* sink) {
         pipeline->attach(this, sink);
         succeededFuture = ChannelFuturePtr(new SucceededChannelFuture(*this));
+        voidFuture = ChannelFuturePtr(new VoidChannelFuture(*this));
         closeFuture = ChannelCloseFuturePtr(new ChannelCloseFuture(*this));
 
         closeFuture->addListener(&ID_DEALLOCATOR);
     }
 
+    static void deleteChannel(AbstractChannel* channel) {
+        delete channel;
+    }
+
 private:
     static ChannelMap allChannels;
 	static IdDeallocator ID_DEALLOCATOR;
@@ -326,10 +362,14 @@ protected:
     ChannelPipeline* pipeline; // own pipeline, and maintenance life cycle.
 
     ChannelFuturePtr succeededFuture;
+    ChannelFuturePtr voidFuture;
     ChannelFuturePtr closeFuture;
 
     int interestOps;
 
+    // the transport and the objects which still refer to the channel.
+    boost::detail::atomic_count retainCount;
+
     /** Cache for the string representation of this channel */
     mutable std::string strVal;
 };
@@ -0,0 +1,133 @@
+#if !defined(CETTY_CHANNEL_ABSTRACTSTATICCHANNELPIPELINE_H)
+#define CETTY_CHANNEL_ABSTRACTSTATICCHANNELPIPELINE_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "cetty/channel/ChannelSink.h"
+#include "cetty/channel/ChannelHandler.h"
+#include "cetty/channel/ChannelPipeline.h"
+#include "cetty/channel/ChannelHandlerContext.h"
+
+namespace cetty { namespace util {
+class Exception;
+}}
+
+namespace cetty { namespace logging {
+class InternalLogger;
+}}
+
+namespace cetty { namespace channel {
+
+using namespace cetty::util;
+using namespace cetty::logging;
+
+class ChannelPipelineException;
+
+/**
+ * The part of the {@link StaticChannelPipeline} which does not depend on
+ * the types of the handlers: attaching, looking up the handlers, and
+ * notifying the exceptions thrown by the handlers.
+ *
+ * The handlers can not be added, removed or replaced, those operations
+ * throw an {@link UnsupportedOperationException}.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class AbstractStaticChannelPipeline : public ChannelPipeline {
+public:
+    virtual ~AbstractStaticChannelPipeline() {}
+
+    virtual Channel& getChannel() const;
+    virtual ChannelSink& getSink() const;
+
+    virtual void attach(Channel* channel, ChannelSink* sink);
+    virtual bool isAttached() const;
+
+    virtual void addFirst(const std::string& name, const ChannelHandlerPtr& handler);
+    virtual void addLast(const std::string& name, const ChannelHandlerPtr& handler);
+    virtual void addBefore(const std::string& baseName, const std::string& name, const ChannelHandlerPtr& handler);
+    virtual void addAfter(const std::string& baseName, const std::string& name, const ChannelHandlerPtr& handler);
+
+    virtual void remove(const ChannelHandlerPtr& handler);
+    virtual ChannelHandlerPtr remove(const std::string& name);
+    virtual ChannelHandlerPtr removeFirst();
+    virtual ChannelHandlerPtr removeLast();
+
+    virtual void replace(const ChannelHandlerPtr& oldHandler, const std::string& newName, const ChannelHandlerPtr& newHandler);
+    virtual ChannelHandlerPtr replace(const std::string& oldName, const std::string& newName, const ChannelHandlerPtr& newHandler);
+
+    virtual ChannelHandlerPtr getFirst() const;
+    virtual ChannelHandlerPtr getLast() const;
+    virtual ChannelHandlerPtr get(const std::string& name) const;
+
+    virtual ChannelHandlerContext* getContext(const std::string& name) const;
+    virtual ChannelHandlerContext* getContext(const ChannelHandlerPtr& handler) const;
+
+    virtual ChannelHandlers toMap() const;
+
+    virtual std::string toString() const;
+
+    virtual void notifyHandlerException(const ChannelEvent& evt, const Exception& e);
+
+protected:
+    AbstractStaticChannelPipeline();
+
+    /**
+     * Registers the context of the next handler, in the order of the
+     * handlers, and calls its {@link LifeCycleAwareChannelHandler#beforeAdd}
+     * and {@link LifeCycleAwareChannelHandler#afterAdd}.
+     */
+    void addContext(ChannelHandlerContext* ctx);
+
+protected:
+    class DiscardingChannelSink : public ChannelSink {
+    public:
+        DiscardingChannelSink() {}
+        virtual ~DiscardingChannelSink() {}
+
+        virtual void eventSunk(const ChannelPipeline& pipeline,
+                               const ChannelEvent& e);
+
+        virtual void writeRequested(const ChannelPipeline& pipeline,
+                                    const MessageEvent& e);
+
+        virtual void stateChangeRequested(const ChannelPipeline& pipeline,
+                                          const ChannelStateEvent& e);
+
+        virtual void exceptionCaught(const ChannelPipeline& pipeline,
+                                     const ChannelEvent& e,
+                                     const ChannelPipelineException& cause);
+    };
+
+protected:
+    static InternalLogger* logger;
+    static DiscardingChannelSink discardingSink;
+
+    Channel* channel;
+    ChannelSink* sink;
+
+private:
+    std::vector<ChannelHandlerContext*> contexts;
+};
+
+}}
+
+#endif //#if !defined(CETTY_CHANNEL_ABSTRACTSTATICCHANNELPIPELINE_H)
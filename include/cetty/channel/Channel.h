@@ -34,6 +34,7 @@ class ChannelFactory;
 class ChannelConfig;
 class ChannelPipeline;
 class ChannelFuture;
+class ChannelEventLoop;
 
 class ChannelMessage;
 
@@ -79,6 +80,24 @@ using namespace cetty::util;
  * operations.  For example, with the I/O datagram transport, multicast
  * join / leave operations are provided by {@link DatagramChannel}.
  *
+ * <h3>Who deletes a channel</h3>
+ * <p>
+ * A channel is created and deleted by its transport, never by the user.  The
+ * transport holds the first count of {@link #retain()}:
+ * <ul>
+ * <li>an accepted channel is released by the server pipeline sink when it is
+ *     closed, so it is deleted after its close, in its event loop, by the last
+ *     {@link #release()};</li>
+ * <li>a client channel is kept by the client {@link ChannelFactory} after it
+ *     is closed, so the pointer returned by {@link ChannelFactory#newChannel}
+ *     stays valid until the {@link ChannelFactory#releaseExternalResources()},
+ *     which deletes it after the event loops have exited.  All the retains of
+ *     a client channel must be released before that.</li>
+ * </ul>
+ * An object which may still refer to a channel after it is closed, as the
+ * queued tasks of an {@link ExecutionHandler} do, retains the channel and
+ * releases it when it is done with it.
+ *
  * <h3>InterestOps</h3>
  * <p>
  * A {@link Channel} has a property called {@link #getInterestOps() interestOps}.
@@ -247,7 +266,8 @@ public:
      * @param withFuture indicated wether to return a future or not
      *
      * @return the {@link ChannelFuture ChannelFuturePtr} which will be notified when the
-     *         write request succeeds or fails
+     *         write request succeeds or fails, or the {@link #getVoidFuture()
+     *         void future} if <tt>withFuture</tt> is <tt>false</tt>
      *
      */
     virtual ChannelFuturePtr write(const ChannelMessage& message,
@@ -340,6 +360,35 @@ public:
      */
     virtual ChannelFuturePtr& getSucceededFuture() = 0;
 
+    /**
+     * Returns the {@link VoidChannelFuture void future} of this channel,
+     * which is passed with the writes that do not ask for a future.
+     * This method always returns the same future instance.
+     */
+    virtual ChannelFuturePtr& getVoidFuture() = 0;
+
+    /**
+     * Returns the {@link ChannelEventLoop} whose thread runs the I/O of this
+     * channel, or <tt>NULL</tt> if the channel is not bound to one thread.
+     */
+    virtual ChannelEventLoop* getEventLoop() const = 0;
+
+    /**
+     * Keeps this channel from being deleted by its transport after it is
+     * closed, until the matching {@link #release()}.  It is used by the
+     * objects which may still refer to the channel from another thread,
+     * such as the queued tasks of an {@link ExecutionHandler}.
+     */
+    virtual void retain() = 0;
+
+    /**
+     * Releases a {@link #retain()}.  The last release, including the one of
+     * the transport, deletes the channel later in its event loop, or at once
+     * if the channel has no event loop.  The channel must not be used after
+     * the caller's release.
+     */
+    virtual void release() = 0;
+
     /**
      * Returns the current <tt>interestOps</tt> of this channel.
      *
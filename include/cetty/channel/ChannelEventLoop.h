@@ -0,0 +1,50 @@
+#if !defined(CETTY_CHANNEL_CHANNELEVENTLOOP_H)
+#define CETTY_CHANNEL_CHANNELEVENTLOOP_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <boost/function.hpp>
+
+namespace cetty { namespace channel {
+
+/**
+ * The thread which runs the I/O of a set of {@link Channel}s, e.g. an
+ * io_service of the {@link AsioServicePool}.  All the channels which return
+ * the same event loop from {@link Channel#getEventLoop()} are handled by the
+ * same thread, so a task executed in the event loop may operate on all of
+ * them without any locking.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class ChannelEventLoop {
+public:
+    typedef boost::function0<void> Task;
+
+public:
+    virtual ~ChannelEventLoop() {}
+
+    /**
+     * Runs the task in the thread of this event loop later, even if it is
+     * called by that thread.  It may be called by any thread.
+     */
+    virtual void execute(const Task& task) = 0;
+};
+
+}}
+
+#endif //#if !defined(CETTY_CHANNEL_CHANNELEVENTLOOP_H)
@@ -260,6 +260,13 @@ public:
      */
     virtual const Exception* getCause() const = 0;
 
+    /**
+     * Returns <tt>true</tt> if and only if this future is the
+     * {@link Channel#getVoidFuture() void future} of a channel, which is
+     * never completed and does not accept any listener.
+     */
+    virtual bool isVoid() const { return false; }
+
     /**
      * Cancels the I/O operation associated with this future
      * and notifies all listeners if canceled successfully.
@@ -298,7 +305,7 @@ public:
      *
      * @return <tt>true</tt> if and only if notification was made.
      */
-    virtual bool setProgress(int amount, int current, int total) = 0;
+    virtual bool setProgress(boost::int64_t amount, boost::int64_t current, boost::int64_t total) = 0;
 
     /**
      * Adds the specified listener, which is a function object, to this future.
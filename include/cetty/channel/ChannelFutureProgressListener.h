@@ -21,6 +21,7 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
+#include <boost/cstdint.hpp>
 #include "cetty/channel/ChannelFutureListener.h"
 
 namespace cetty { namespace channel {
@@ -62,7 +63,7 @@ public:
      * @param future  the source {@link ChannelFuture} which called this
      *                callback
      */
-    virtual void operationProgressed(const ChannelFuturePtr& future, int amount, int current, int total) = 0;
+    virtual void operationProgressed(const ChannelFuturePtr& future, boost::int64_t amount, boost::int64_t current, boost::int64_t total) = 0;
 };
 
 }}
@@ -17,10 +17,10 @@
  * under the License.
  */
 
+#include <string.h>
 #include <typeinfo>
 #include <string>
-#include <boost/any.hpp>
-#include <boost/shared_ptr.hpp>
+#include <vector>
 #include <boost/config.hpp>
 
 #include "cetty/channel/ChannelMessageHolder.h"
@@ -33,111 +33,162 @@ namespace cetty { namespace channel {
 using namespace cetty::util;
 using namespace cetty::buffer;
 
+template<>
+struct ChannelMessageTraits<ChannelBufferPtr>
+    : public ChannelMessageInlineTraits<ChannelBufferPtr, ChannelMessageType::BUFFER> {
+};
+
+/**
+ * The message passed through the {@link ChannelPipeline}.
+ *
+ * A {@link ChannelBuffer}, the other intrusive pointers, the raw pointers
+ * and the small trivially copyable values are kept inside the message,
+ * so wrapping them does not allocate.  Strings, vectors and the other
+ * values are kept in a shared {@link ChannelMessageHolder}.  The type of
+ * the value is identified by its {@link ChannelMessageType}, which is
+ * compared by address instead of by <tt>typeid</tt>.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
 class ChannelMessage {
 public:
     static ChannelMessage EMPTY_MESSAGE;
     static std::string    EMPTY_STRING;
     static std::wstring   EMPTY_WSTRING;
+    static ChannelBufferPtr EMPTY_BUFFER;
 	static std::vector<ChannelBufferPtr> EMPTY_BUFFERS;
 	static std::vector<ChannelMessage>   EMPTY_MESSAGES;
 
 public:
-    ChannelMessage() : buffer(), holder() {}
+    ChannelMessage() : type(NULL) {}
 
     template<typename T>
-    ChannelMessage(const T& value)
-        : buffer(), holder(new ChannelMessageHolderImpl<T>(value)) {}
+    ChannelMessage(const T& value) {
+        init<T>(value);
+    }
 
-    ChannelMessage(const ChannelBufferPtr& buffer)
-        : buffer(buffer), holder() {}
+    ChannelMessage(const ChannelBufferPtr& buffer) : type(NULL) {
+        if (buffer) {
+            init<ChannelBufferPtr>(buffer);
+        }
+    }
 
 	ChannelMessage(const ChannelBufferPtr& buffer0,
-				   const ChannelBufferPtr& buffer1)
-        : buffer(ChannelBuffers::wrappedBuffer(buffer0, buffer1)), holder() {
+				   const ChannelBufferPtr& buffer1) {
+        init<ChannelBufferPtr>(ChannelBuffers::wrappedBuffer(buffer0, buffer1));
 	}
 
 	ChannelMessage(const ChannelBufferPtr& buffer0,
 				   const ChannelBufferPtr& buffer1,
-				   const ChannelBufferPtr& buffer2)
-        : buffer(ChannelBuffers::wrappedBuffer(buffer0, buffer1, buffer2)),
-          holder() {
+				   const ChannelBufferPtr& buffer2) {
+        init<ChannelBufferPtr>(
+            ChannelBuffers::wrappedBuffer(buffer0, buffer1, buffer2));
 	}
 
 	ChannelMessage(const ChannelBufferPtr& buffer0,
 				   const ChannelBufferPtr& buffer1,
 				   const ChannelBufferPtr& buffer2,
-				   const ChannelBufferPtr& buffer3)
-        : buffer(ChannelBuffers::wrappedBuffer(buffer0, buffer1, buffer2, buffer3)),
-          holder() {
+				   const ChannelBufferPtr& buffer3) {
+        init<ChannelBufferPtr>(
+            ChannelBuffers::wrappedBuffer(buffer0, buffer1, buffer2, buffer3));
 	}
 
-    ChannelMessage(const std::vector<ChannelBufferPtr>& buffers)
-        : buffer(ChannelBuffers::wrappedBuffer(buffers)), holder() {
+    ChannelMessage(const std::vector<ChannelBufferPtr>& buffers) {
+        init<ChannelBufferPtr>(ChannelBuffers::wrappedBuffer(buffers));
     }
 
-    explicit ChannelMessage(const std::string& str)
-        : buffer(), holder(new ChannelMessageHolderImpl<std::string>(str)) {}
+    explicit ChannelMessage(const std::string& str) {
+        init<std::string>(str);
+    }
 
-    explicit ChannelMessage(const char* str)
-        : buffer(), holder(new ChannelMessageHolderImpl<std::string>(str)) {}
+    explicit ChannelMessage(const char* str) {
+        init<std::string>(std::string(str));
+    }
 
-    explicit ChannelMessage(const std::wstring& str)
-        : buffer(), holder(new ChannelMessageHolderImpl<std::wstring>(str)) {}
+    explicit ChannelMessage(const std::wstring& str) {
+        init<std::wstring>(str);
+    }
 
-    explicit ChannelMessage(const wchar_t* str)
-        : buffer(), holder(new ChannelMessageHolderImpl<std::wstring>(str)) {}
+    explicit ChannelMessage(const wchar_t* str) {
+        init<std::wstring>(std::wstring(str));
+    }
 
-    ChannelMessage(const ChannelMessage& msg)
-        : buffer(msg.buffer), holder(msg.holder) {}
+    ChannelMessage(const ChannelMessage& msg) {
+        copy(msg);
+    }
 
     ChannelMessage(const ChannelMessage& msg0,
                    const ChannelMessage& msg1) {
-        std::vector<ChannelMessage> msgs(1, msg0);
+        std::vector<ChannelMessage> msgs;
+        msgs.reserve(2);
+        msgs.push_back(msg0);
         msgs.push_back(msg1);
-        holder = ChannelMessageHolderPtr(
-            new ChannelMessageHolderImpl<std::vector<ChannelMessage> >(msgs));
+        init<std::vector<ChannelMessage> >(msgs);
     }
 
     ChannelMessage(const ChannelMessage& msg0,
                    const ChannelMessage& msg1,
                    const ChannelMessage& msg2) {
-        std::vector<ChannelMessage> msgs(1, msg0);
+        std::vector<ChannelMessage> msgs;
+        msgs.reserve(3);
+        msgs.push_back(msg0);
         msgs.push_back(msg1);
         msgs.push_back(msg2);
-        holder = ChannelMessageHolderPtr(
-            new ChannelMessageHolderImpl<std::vector<ChannelMessage> >(msgs));
+        init<std::vector<ChannelMessage> >(msgs);
     }
 
-    ~ChannelMessage() {}
+    ~ChannelMessage() {
+        if (type) {
+            type->destroy(&storage);
+        }
+    }
 
     ChannelMessage& operator=(const ChannelMessage& msg) {
-        holder = msg.holder;
-        buffer = msg.buffer;
+        // copy first, msg may be owned by the value of this message.
+        // the stored values are pointers or trivially copyable, so they
+        // can be moved bitwise.
+        const ChannelMessageType* copiedType = msg.type;
+        ChannelMessageStorage copied;
+        memset(&copied, 0, sizeof(copied));
+        if (copiedType) {
+            copiedType->copy(&copied, &msg.storage);
+        }
+
+        if (type) {
+            type->destroy(&storage);
+        }
+        type = copiedType;
+        storage = copied;
         return *this;
     }
 
     bool operator==(const ChannelMessage& msg) const {
-        return buffer == msg.buffer && holder == msg.holder;
+        return type == msg.type
+               && memcmp(&storage, &msg.storage, sizeof(storage)) == 0;
     }
 
-    bool empty() const { return (!holder && !buffer); }
-    bool isChannelBuffer() const { return buffer; }
-    bool isString() const { return holder && holder->isString(); }
-    bool isWideString() const { return holder && holder->isWideString(); }
-    bool isVector() const { return holder && holder->isVector(); }
-    bool isRawPointer() const { return holder && holder->isRawPointer(); }
-    bool isSmartPointer() const { return buffer || (holder && holder->isSmartPointer()); }
+    bool empty() const { return type == NULL; }
+    bool isChannelBuffer() const { return kind() == ChannelMessageType::BUFFER; }
+    bool isString() const { return kind() == ChannelMessageType::STRING; }
+    bool isWideString() const { return kind() == ChannelMessageType::WIDE_STRING; }
+    bool isVector() const { return kind() == ChannelMessageType::VECTOR; }
+    bool isRawPointer() const { return kind() == ChannelMessageType::RAW_POINTER; }
+    bool isSmartPointer() const {
+        return kind() == ChannelMessageType::BUFFER
+               || kind() == ChannelMessageType::SMART_POINTER;
+    }
 
     template<typename T>
     T& value() const {
-        if (holder) {
-            ChannelMessageHolderImpl<T>* impl = holderImpl<T>();
-            if (impl) {
-                return impl->value();
-            }
+        T* v = get<T>();
+        if (v) {
+            return *v;
+        }
+        if (type) {
             throw BadCastException(
                 std::string("Can not convert form ") +
-                holder->type().name() +
+                type->type().name() +
                 std::string(" to ") +
                 typeid(T).name());
         }
@@ -146,176 +197,141 @@ public:
 
     template<typename T>
     T* pointer() const {
-        ChannelMessageHolderImpl<T>* impl = holderImpl<T>();
-        if (impl) {
-            return &(impl->value());
-        }
-        return NULL;
+        return get<T>();
     }
 
     template<typename T, typename U>
     T* rawPointer() const {
-        if (buffer) return NULL; // not raw pointer type
-
-        ChannelMessageHolderImpl<U*>* impl = holderImpl<U*>();
-        if (impl) {
-            return dynamic_cast<T*>(impl->value());
+        U** p = get<U*>();
+        if (p) {
+            return dynamic_cast<T*>(*p);
         }
         return NULL;
     }
 
     template<typename T>
     T* rawPointer() const {
-        if (buffer) return NULL; // not raw pointer type
-
-        ChannelMessageHolderImpl<T*>* impl = holderImpl<T*>();
-        if (impl) {
-            return impl->value();
+        T** p = get<T*>();
+        if (p) {
+            return *p;
         }
         return NULL;
     }
 
     template<typename T, typename U>
     boost::intrusive_ptr<T> smartPointer() const {
-        if (buffer) return boost::dynamic_pointer_cast<T>(buffer);
-
-        ChannelMessageHolderImpl<boost::intrusive_ptr<U> >* impl =
-            holderImpl<boost::intrusive_ptr<U> >();
+        ChannelBufferPtr* buffer = get<ChannelBufferPtr>();
+        if (buffer) {
+            return boost::dynamic_pointer_cast<T>(*buffer);
+        }
 
-        if (impl) {
-            return boost::dynamic_pointer_cast<T>(impl->value());
+        boost::intrusive_ptr<U>* p = get<boost::intrusive_ptr<U> >();
+        if (p) {
+            return boost::dynamic_pointer_cast<T>(*p);
         }
         return boost::intrusive_ptr<T>();
     }
 
     template<typename T>
     boost::intrusive_ptr<T> smartPointer() const {
-        ChannelMessageHolderImpl<boost::intrusive_ptr<T> >* impl =
-            holderImpl<boost::intrusive_ptr<T> >();
-
-        if (impl) {
-            return (impl->value());
+        boost::intrusive_ptr<T>* p = get<boost::intrusive_ptr<T> >();
+        if (p) {
+            return *p;
         }
         return boost::intrusive_ptr<T>();
     }
 
     // vector operators.
     int vectorSize() const {
-        if (holder) {
-            return holder->vectorSize();
+        if (type) {
+            return type->vectorSize(&storage);
         }
         return 0;
     }
 
     template<typename T>
     T& value(int index) const {
-        if (!holder) {
+        if (!type) {
             throw InvalidAccessException("Can not convert empty value.");
         }
-        if (index < 0 || index >= holder->vectorSize()) {
+        if (index < 0 || index >= vectorSize()) {
             throw RangeException("Out of range.");
         }
 
-        ChannelMessageHolderImpl<std::vector<T> >* impl
-            = holderImpl<std::vector<T> >();
-        if (impl) {
-            return impl->value(index);
+        std::vector<T>* vec = get<std::vector<T> >();
+        if (vec) {
+            return (*vec)[index];
         }
 
         throw BadCastException(std::string("Can not convert form ") +
-                               holder->type().name() +
+                               type->type().name() +
                                std::string(" to ") +
                                typeid(T).name());
     }
 
     template<typename T>
     T* pointer(int index) const {
-        if (holder.get() && index >= 0 && index < holder->vectorSize()) {
-            ChannelMessageHolderImpl<std::vector<T> >* impl
-                = holderImpl<std::vector<T> >();
-            if (impl) {
-                return &(impl->value(index));
-            }
+        std::vector<T>* vec = get<std::vector<T> >();
+        if (vec && index >= 0 && index < (int)vec->size()) {
+            return &(*vec)[index];
         }
         return NULL;
     }
 
     template<typename T>
     T* rawPointer(int index) const {
-        if (holder.get() && index >= 0 && index < holder->vectorSize()) {
-            ChannelMessageHolderImpl<std::vector<T*> >* impl =
-                holderImpl<std::vector<T*> >();
-            if (impl) {
-                return impl->value(index);
-            }
+        std::vector<T*>* vec = get<std::vector<T*> >();
+        if (vec && index >= 0 && index < (int)vec->size()) {
+            return (*vec)[index];
         }
         return NULL;
     }
 
     template<typename T, typename U>
     T* rawPointer(int index) const {
-        if (holder.get() && index >= 0 && index < holder->vectorSize()) {
-            ChannelMessageHolderImpl<std::vector<U*> >* impl =
-                holderImpl<std::vector<U*> >();
-            if (impl) {
-                return dynamic_cast<T*>(impl->value(index));
-            }
+        std::vector<U*>* vec = get<std::vector<U*> >();
+        if (vec && index >= 0 && index < (int)vec->size()) {
+            return dynamic_cast<T*>((*vec)[index]);
         }
         return NULL;
     }
 
     template<typename T>
     boost::intrusive_ptr<T> smartPointer(int index) const {
-        if (holder.get() && index >= 0 && index < holder->vectorSize()) {
-            ChannelMessageHolderImpl<std::vector<boost::intrusive_ptr<T> > >* impl =
-                holderImpl<std::vector<boost::intrusive_ptr<T> > >();
-            if (impl) {
-                return impl->value(index);
-            }
+        std::vector<boost::intrusive_ptr<T> >* vec =
+            get<std::vector<boost::intrusive_ptr<T> > >();
+        if (vec && index >= 0 && index < (int)vec->size()) {
+            return (*vec)[index];
         }
         return boost::intrusive_ptr<T>();
     }
 
     template<typename T, typename U>
     boost::intrusive_ptr<T> smartPointer(int index) const {
-        if (holder.get() && index >= 0 && index < holder->vectorSize()) {
-            ChannelMessageHolderImpl<std::vector<boost::intrusive_ptr<U> > >* impl =
-                holderImpl<std::vector<boost::intrusive_ptr<U> > >();
-            if (impl) {
-                return boost::dynamic_pointer_cast<T>(impl->value(index));
-            }
+        std::vector<boost::intrusive_ptr<U> >* vec =
+            get<std::vector<boost::intrusive_ptr<U> > >();
+        if (vec && index >= 0 && index < (int)vec->size()) {
+            return boost::dynamic_pointer_cast<T>((*vec)[index]);
         }
         return boost::intrusive_ptr<T>();
     }
 
 	std::vector<ChannelBufferPtr>& channelBuffers() const {
-		if (holder.get() && holder->isVector()) {
-			ChannelMessageHolderImpl<std::vector<ChannelBufferPtr> >* impl =
-				holderImpl<std::vector<ChannelBufferPtr> >();
-			if (impl) {
-				return impl->value();
-			}
-		}
-		return EMPTY_BUFFERS;
+        std::vector<ChannelBufferPtr>* vec = get<std::vector<ChannelBufferPtr> >();
+        return vec ? *vec : EMPTY_BUFFERS;
 	}
 
 	std::vector<ChannelMessage>& channelMessages() const {
-		if (holder.get() && holder->isVector()) {
-			ChannelMessageHolderImpl<std::vector<ChannelMessage> >* impl =
-				holderImpl<std::vector<ChannelMessage> >();
-			if (impl) {
-				return impl->value();
-			}
-		}
-		return EMPTY_MESSAGES;
+        std::vector<ChannelMessage>* vec = get<std::vector<ChannelMessage> >();
+        return vec ? *vec : EMPTY_MESSAGES;
 	}
 
     std::string toString() const {
-        if (!holder) {
+        if (!type) {
             return "empty ChannelMessage";
         }
 
-        return holder->type().name();
+        return type->type().name();
     }
 
     // it is incompatible with c++ stardard, but only for remove the
@@ -324,97 +340,65 @@ public:
     template<> std::string& value<std::string>() const;
     template<> std::wstring& value<std::wstring>() const;
     template<> ChannelBufferPtr& value<ChannelBufferPtr>() const;
-    template<> ChannelBufferPtr* pointer<ChannelBufferPtr>() const;
-    template<> ChannelBufferPtr  smartPointer<ChannelBuffer>() const;
     template<> ChannelMessage& value<ChannelMessage>(int index) const;
 #endif
 
 private:
-    template <typename T>
-    ChannelMessageHolderImpl<T>* holderImpl() const {
-        if (holder.get() && holder->type() == typeid(T)) {
-            return static_cast<ChannelMessageHolderImpl<T>*>(holder.get());
-        }
-        return NULL;
-    }
-
-    // it is incompatible with c++ stardard, but only for remove the
-    // link errors under visual studio.
-#if defined(BOOST_MSVC)
-    template<> ChannelMessageHolderImpl<std::string>* holderImpl<std::string>() const;
-    template<> ChannelMessageHolderImpl<std::wstring>* holderImpl<std::wstring>() const;
-#endif
-
-private:
-    ChannelBufferPtr        buffer;
-    ChannelMessageHolderPtr holder;
-};
-
-template<> inline
-ChannelMessageHolderImpl<std::string>* ChannelMessage::holderImpl<std::string>() const {
-    if (holder && holder->isString()) {
-        return static_cast<ChannelMessageHolderImpl<std::string>*>(holder.get());
+    int kind() const {
+        return type ? type->kind : ChannelMessageType::EMPTY;
     }
-    return NULL;
-}
 
-template<> inline
-ChannelMessageHolderImpl<std::wstring>* ChannelMessage::holderImpl<std::wstring>() const {
-    if (holder && holder->isWideString()) {
-        return static_cast<ChannelMessageHolderImpl<std::wstring>*>(holder.get());
+    template<typename T>
+    void init(const T& value) {
+        // zero the unused bytes, operator== compares the whole storage.
+        memset(&storage, 0, sizeof(storage));
+        ChannelMessageTraits<T>::construct(&storage, value);
+        type = &ChannelMessageTypeOf<T>::instance;
     }
-    return NULL;
-}
 
-template<> inline
-std::string& ChannelMessage::value<std::string>() const {
-    if (holder) {
-        ChannelMessageHolderImpl<std::string>* impl = holderImpl<std::string>();
-        if (impl) {
-            return impl->value();
+    void copy(const ChannelMessage& msg) {
+        type = msg.type;
+        memset(&storage, 0, sizeof(storage));
+        if (type) {
+            type->copy(&storage, &msg.storage);
         }
-        return EMPTY_STRING;
     }
-    return EMPTY_STRING;
-}
 
-template<> inline
-std::wstring& ChannelMessage::value<std::wstring>() const {
-    if (holder) {
-        ChannelMessageHolderImpl<std::wstring>* impl = holderImpl<std::wstring>();
-        if (impl) {
-            return impl->value();
+    template<typename T>
+    T* get() const {
+        if (type == &ChannelMessageTypeOf<T>::instance) {
+            return &ChannelMessageTraits<T>::value(&storage);
         }
-        return EMPTY_WSTRING;
+        return NULL;
     }
-    return EMPTY_WSTRING;
-}
+
+private:
+    const ChannelMessageType* type;
+    mutable ChannelMessageStorage storage;
+};
 
 template<> inline
-ChannelBufferPtr& ChannelMessage::value<ChannelBufferPtr>() const {
-    return const_cast<ChannelBufferPtr&>(buffer);
+std::string& ChannelMessage::value<std::string>() const {
+    std::string* str = get<std::string>();
+    return str ? *str : EMPTY_STRING;
 }
 
 template<> inline
-ChannelBufferPtr* ChannelMessage::pointer<ChannelBufferPtr>() const {
-    return const_cast<ChannelBufferPtr*>(&buffer);
+std::wstring& ChannelMessage::value<std::wstring>() const {
+    std::wstring* str = get<std::wstring>();
+    return str ? *str : EMPTY_WSTRING;
 }
 
 template<> inline
-ChannelBufferPtr ChannelMessage::smartPointer<ChannelBuffer>() const {
-    return buffer;
+ChannelBufferPtr& ChannelMessage::value<ChannelBufferPtr>() const {
+    ChannelBufferPtr* buffer = get<ChannelBufferPtr>();
+    return buffer ? *buffer : EMPTY_BUFFER;
 }
 
 template<> inline
 ChannelMessage& ChannelMessage::value<ChannelMessage>(int index) const {
-    if (holder.get() && index >= 0 && index < holder->vectorSize()) {
-        ChannelMessageHolderImpl<std::vector<ChannelMessage> >* impl =
-            holderImpl<std::vector<ChannelMessage> >();
-        if (impl) {
-            return impl->value(index);
-        }
-    }
-    return ChannelMessage::EMPTY_MESSAGE;
+    ChannelMessage* msg = pointer<ChannelMessage>(index);
+    return msg ? *msg : ChannelMessage::EMPTY_MESSAGE;
 }
 
 }}
@@ -17,8 +17,15 @@
  * under the License.
  */
 
+#include <new>
 #include <string>
 #include <vector>
+#include <typeinfo>
+#include <boost/cstdint.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/mpl/if.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+#include <boost/type_traits/has_trivial_destructor.hpp>
 #include "cetty/util/ReferenceCounter.h"
 
 namespace cetty { namespace channel { 
@@ -256,6 +263,142 @@ private:
     T* ptr;
 };
 
+/**
+ * The storage inside a {@link ChannelMessage}.  Intrusive pointers, raw
+ * pointers and small trivially copyable values are kept in it directly,
+ * the other values are kept in it as a {@link ChannelMessageHolderPtr}.
+ */
+union ChannelMessageStorage {
+    void* pointers[2];
+    boost::int64_t integer;
+    double real;
+};
+
+/**
+ * Describes the type of the value held by a {@link ChannelMessage}.
+ * There is one instance for each type, so the types of two messages are
+ * the same only if their ChannelMessageType are the same object.
+ */
+struct ChannelMessageType {
+    enum Kind {
+        EMPTY,
+        BUFFER,
+        SMART_POINTER,
+        RAW_POINTER,
+        STRING,
+        WIDE_STRING,
+        VECTOR,
+        VALUE
+    };
+
+    int kind;
+
+    void (*copy)(void* to, const void* from);
+    void (*destroy)(void* storage);
+    int  (*vectorSize)(const void* storage);
+    const std::type_info& (*type)();
+};
+
+template<typename T, int KIND>
+struct ChannelMessageInlineTraits {
+    typedef T Stored;
+    static const int kind = KIND;
+
+    static void construct(void* storage, const T& value) {
+        new (storage) T(value);
+    }
+    static T& value(void* storage) {
+        return *static_cast<T*>(storage);
+    }
+    static int vectorSize(const void* storage) { return 0; }
+};
+
+template<typename T, int KIND>
+struct ChannelMessageHeapTraits {
+    typedef ChannelMessageHolderPtr Stored;
+    static const int kind = KIND;
+
+    static void construct(void* storage, const T& value) {
+        new (storage) ChannelMessageHolderPtr(new ChannelMessageHolderImpl<T>(value));
+    }
+    static T& value(void* storage) {
+        return static_cast<ChannelMessageHolderImpl<T>*>(
+            static_cast<ChannelMessageHolderPtr*>(storage)->get())->value();
+    }
+    static int vectorSize(const void* storage) { return 0; }
+};
+
+/**
+ * How a value of type <tt>T</tt> is kept in a {@link ChannelMessage}.
+ */
+template<typename T>
+struct ChannelMessageTraits
+    : public boost::mpl::if_c<sizeof(T) <= sizeof(ChannelMessageStorage)
+                              && boost::has_trivial_copy<T>::value
+                              && boost::has_trivial_destructor<T>::value,
+                              ChannelMessageInlineTraits<T, ChannelMessageType::VALUE>,
+                              ChannelMessageHeapTraits<T, ChannelMessageType::VALUE> >::type {
+};
+
+template<typename T>
+struct ChannelMessageTraits<boost::intrusive_ptr<T> >
+    : public ChannelMessageInlineTraits<boost::intrusive_ptr<T>,
+                                        ChannelMessageType::SMART_POINTER> {
+};
+
+template<typename T>
+struct ChannelMessageTraits<T*>
+    : public ChannelMessageInlineTraits<T*, ChannelMessageType::RAW_POINTER> {
+};
+
+template<>
+struct ChannelMessageTraits<std::string>
+    : public ChannelMessageHeapTraits<std::string, ChannelMessageType::STRING> {
+};
+
+template<>
+struct ChannelMessageTraits<std::wstring>
+    : public ChannelMessageHeapTraits<std::wstring, ChannelMessageType::WIDE_STRING> {
+};
+
+template<typename T>
+struct ChannelMessageTraits<std::vector<T> >
+    : public ChannelMessageHeapTraits<std::vector<T>, ChannelMessageType::VECTOR> {
+    static int vectorSize(const void* storage) {
+        return (int)ChannelMessageTraits::value(const_cast<void*>(storage)).size();
+    }
+};
+
+/**
+ * The {@link ChannelMessageType} of <tt>T</tt>.
+ */
+template<typename T>
+struct ChannelMessageTypeOf {
+    typedef ChannelMessageTraits<T> Traits;
+    typedef typename Traits::Stored Stored;
+
+    static void copy(void* to, const void* from) {
+        new (to) Stored(*static_cast<const Stored*>(from));
+    }
+    static void destroy(void* storage) {
+        static_cast<Stored*>(storage)->~Stored();
+    }
+    static const std::type_info& type() {
+        return typeid(T);
+    }
+
+    static const ChannelMessageType instance;
+};
+
+template<typename T>
+const ChannelMessageType ChannelMessageTypeOf<T>::instance = {
+    ChannelMessageTraits<T>::kind,
+    &ChannelMessageTypeOf<T>::copy,
+    &ChannelMessageTypeOf<T>::destroy,
+    &ChannelMessageTraits<T>::vectorSize,
+    &ChannelMessageTypeOf<T>::type
+};
+
 }}
 
 #endif //#if !defined(CETTY_CHANNEL_CHANNELMESSAGEHOLDER_H)
@@ -135,6 +135,7 @@ public:
 
     /**
      * Creates a new {@link ChannelFuture} for the specified {@link Channel}.
+     * The future is a {@link LightweightChannelFuture}.
      *
      * @param cancellable <tt>true</tt> if and only if the returned future
      *                    can be canceled by {@link ChannelFuture#cancel()}
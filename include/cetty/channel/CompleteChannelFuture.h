@@ -98,7 +98,7 @@ public:
         return true;
     }
 
-    virtual bool setProgress(int amount, int current, int total) {
+    virtual bool setProgress(boost::int64_t amount, boost::int64_t current, boost::int64_t total) {
         return false;
     }
 
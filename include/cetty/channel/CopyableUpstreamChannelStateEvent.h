@@ -0,0 +1,81 @@
+#if !defined(CETTY_CHANNEL_COPYABLEUPSTREAMCHANNELSTATEEVENT_H)
+#define CETTY_CHANNEL_COPYABLEUPSTREAMCHANNELSTATEEVENT_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/ChannelState.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/UpstreamChannelStateEvent.h"
+
+namespace cetty { namespace channel {
+
+/**
+ * The upstream {@link ChannelStateEvent} which keeps its own copy of the
+ * state and the value, so it can outlive the call which fired the event.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class CopyableUpstreamChannelStateEvent : public ChannelStateEvent {
+public:
+    /**
+     * Creates a new instance.
+     */
+    CopyableUpstreamChannelStateEvent(Channel& channel,
+                                      const ChannelState& state,
+                                      const boost::any& value)
+        : channel(channel), state(state), value(value) {
+    }
+
+    explicit CopyableUpstreamChannelStateEvent(const ChannelStateEvent& evt)
+        : channel(evt.getChannel()),
+          state(evt.getState()),
+          value(evt.getValue()) {
+    }
+
+    virtual ~CopyableUpstreamChannelStateEvent() {}
+
+    virtual Channel& getChannel() const {
+        return this->channel;
+    }
+
+    virtual const ChannelFuturePtr& getFuture() const {
+        return this->channel.getSucceededFuture();
+    }
+
+    virtual const ChannelState& getState() const {
+        return this->state;
+    }
+
+    virtual const boost::any& getValue() const {
+        return this->value;
+    }
+
+    virtual std::string toString() const {
+        return UpstreamChannelStateEvent(channel, state, value).toString();
+    }
+
+private:
+    Channel& channel;
+    ChannelState state;
+    boost::any   value;
+};
+
+}}
+
+#endif //#if !defined(CETTY_CHANNEL_COPYABLEUPSTREAMCHANNELSTATEEVENT_H)
@@ -17,33 +17,77 @@
  * under the License.
  */
 
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/SocketAddress.h"
 #include "cetty/channel/UpstreamMessageEvent.h"
 
 namespace cetty { namespace channel {
 
-class CopyableUpstreamMessageEvent : public UpstreamMessageEvent {
+/**
+ * The upstream {@link MessageEvent} which keeps its own copy of the message
+ * and the remote address, unlike the {@link UpstreamMessageEvent} which only
+ * refers to them, so it can outlive the call which fired the event, e.g.
+ * when it is handed to another thread.
+ *
+ * The message is copied as {@link ChannelMessage} does, which shares the
+ * pointed object of the pointer messages.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class CopyableUpstreamMessageEvent : public MessageEvent {
 public:
-    CopyableUpstreamMessageEvent(channel& channel,
+    /**
+     * Creates a new instance.
+     */
+    CopyableUpstreamMessageEvent(Channel& channel,
                                  const ChannelMessage& message,
-                                 const SocketAddress& remoteAddress) {
+                                 const SocketAddress& remoteAddress)
+        : channel(channel), message(message), remoteAddress(remoteAddress) {
+    }
+
+    CopyableUpstreamMessageEvent(const CopyableUpstreamMessageEvent& evt)
+        : channel(evt.channel),
+          message(evt.message),
+          remoteAddress(evt.remoteAddress) {
+    }
 
+    explicit CopyableUpstreamMessageEvent(const MessageEvent& evt)
+        : channel(evt.getChannel()),
+          message(evt.getMessage()),
+          remoteAddress(evt.getRemoteAddress()) {
     }
 
-    explicit CopyableUpstreamMessageEvent(const UpstreamMessageEvent& e) {
+    virtual ~CopyableUpstreamMessageEvent() {}
 
+    virtual Channel& getChannel() const {
+        return this->channel;
     }
 
-    explicit CopyableUpstreamMessageEvent(const MessageEvent& e) {
+    virtual const ChannelFuturePtr& getFuture() const {
+        return this->channel.getSucceededFuture();
+    }
+
+    virtual const ChannelMessage& getMessage() const {
+        return this->message;
+    }
 
+    virtual const SocketAddress& getRemoteAddress() const {
+        return this->remoteAddress;
     }
 
-    virtual CopyableUpstreamMessageEvent() {}
+    virtual std::string toString() const {
+        return UpstreamMessageEvent(channel, message, remoteAddress).toString();
+    }
+
+private:
+    CopyableUpstreamMessageEvent& operator=(const CopyableUpstreamMessageEvent&);
 
 private:
-    Channel* channel;
-    ChannelMessage   message; // need deep copy in different thread?
-    ChannelFuturePtr future;
-    SocketAddress    remoteAddress;
+    Channel& channel;
+    ChannelMessage message;
+    SocketAddress  remoteAddress;
 };
 
 }}
@@ -109,7 +109,7 @@ public:
 
     virtual bool cancel();
 
-    virtual bool setProgress(int amount, int current, int total);
+    virtual bool setProgress(boost::int64_t amount, boost::int64_t current, boost::int64_t total);
 
 private:
     bool await0(boost::int64_t timeoutMillis, bool interruptable);
@@ -120,9 +120,9 @@ private:
     void notifyListener(const ListenerFunction& l);
     void notifyListener(ChannelFutureListener* l);
     void notifyProgressListener(ChannelFutureProgressListener* l,
-                                int amount,
-                                int current,
-                                int total);
+                                boost::int64_t amount,
+                                boost::int64_t current,
+                                boost::int64_t total);
 
     boost::condition_variable& condition();
 
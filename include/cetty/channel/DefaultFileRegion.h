@@ -0,0 +1,82 @@
+#if !defined(CETTY_CHANNEL_DEFAULTFILEREGION_H)
+#define CETTY_CHANNEL_DEFAULTFILEREGION_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include "cetty/channel/FileRegion.h"
+
+namespace cetty { namespace channel {
+
+/**
+ * The default {@link FileRegion} of a file descriptor.
+ *
+ * A regular file is transferred by <tt>sendfile(2)</tt> from the offset,
+ * a pipe is transferred by <tt>splice(2)</tt> in sequence, so the position
+ * of a pipe region is ignored.  On the platforms without them, the region
+ * is read and written in blocks.
+ *
+ * {@link #transferTo} never blocks, it returns <tt>0</tt> if the socket is
+ * full or the pipe is empty for now.
+ */
+class DefaultFileRegion : public FileRegion {
+public:
+    /**
+     * Opens the whole regular file for reading.  The file is closed when
+     * the region is released or destroyed.  A pipe has no size, create its
+     * region from the file descriptor with the count instead.
+     *
+     * @throws FileException if the file can not be opened, or is not a
+     *         regular file.
+     */
+    explicit DefaultFileRegion(const std::string& path);
+
+    /**
+     * Creates a region of the file descriptor.
+     *
+     * @param releaseAfterTransfer whether the file descriptor is closed when
+     *                             the region is released or destroyed.
+     */
+    DefaultFileRegion(int fd,
+                      boost::int64_t position,
+                      boost::int64_t count,
+                      bool releaseAfterTransfer = false);
+
+    virtual ~DefaultFileRegion();
+
+    virtual boost::int64_t getPosition() const { return position; }
+    virtual boost::int64_t getCount() const { return count; }
+
+    int getFd() const { return fd; }
+    bool isPipe() const { return pipe; }
+    bool releaseAfterTransfer() const { return ownFd; }
+
+    virtual boost::int64_t transferTo(int fd, boost::int64_t position);
+
+    virtual void releaseExternalResources();
+
+private:
+    int fd;
+    boost::int64_t position;
+    boost::int64_t count;
+    bool ownFd;
+    bool pipe;
+};
+
+}}
+
+#endif //#if !defined(CETTY_CHANNEL_DEFAULTFILEREGION_H)
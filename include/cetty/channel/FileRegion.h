@@ -0,0 +1,90 @@
+#if !defined(CETTY_CHANNEL_FILEREGION_H)
+#define CETTY_CHANNEL_FILEREGION_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <boost/cstdint.hpp>
+#include <boost/intrusive_ptr.hpp>
+
+#include "cetty/util/ReferenceCounter.h"
+#include "cetty/util/ExternalResourceReleasable.h"
+
+namespace cetty { namespace channel {
+
+/**
+ * A region of a file that is sent via a {@link Channel} which supports
+ * <a href="http://en.wikipedia.org/wiki/Zero-copy">zero-copy file transfer</a>.
+ *
+ * <h3>Zero-copy transfer</h3>
+ *
+ * The region is transferred by <tt>sendfile(2)</tt>, or by <tt>splice(2)</tt>
+ * when the file descriptor is a pipe, so the content is copied from the file
+ * system cache to the socket directly without passing through the user
+ * space.
+ *
+ * <h3>Write a file region</h3>
+ *
+ * Write a {@link FileRegionPtr} as the message, the {@link ChannelFuture}
+ * of the write reports the progress of the transfer to its
+ * {@link ChannelFutureProgressListener}s:
+ * <pre>
+ * FileRegionPtr region(new DefaultFileRegion("index.html"));
+ * channel.write(ChannelMessage(region));
+ * </pre>
+ *
+ * Not all transports support it; the asio socket transport does.
+ */
+class FileRegion : public cetty::util::ReferenceCounter<FileRegion>,
+                   public cetty::util::ExternalResourceReleasable {
+public:
+    virtual ~FileRegion() {}
+
+    /**
+     * Returns the offset in the file where the transfer began.
+     */
+    virtual boost::int64_t getPosition() const = 0;
+
+    /**
+     * Returns the number of bytes to transfer.
+     */
+    virtual boost::int64_t getCount() const = 0;
+
+    /**
+     * Transfers the content of this file region to the specified
+     * non-blocking file descriptor.
+     *
+     * @param fd       the destination file descriptor, usually a socket
+     * @param position the relative offset of the file where the transfer
+     *                 begins from.  For example, <tt>0</tt> will make the
+     *                 transfer start from {@link #getPosition()}th byte and
+     *                 <tt>{@link #getCount()} - 1</tt> will make the last
+     *                 byte of the region transferred.
+     *
+     * @return the bytes transferred, <tt>0</tt> if the destination would
+     *         block.
+     *
+     * @throws IOException if the transfer failed, or the file is shorter
+     *         than the region.
+     */
+    virtual boost::int64_t transferTo(int fd, boost::int64_t position) = 0;
+};
+
+typedef boost::intrusive_ptr<FileRegion> FileRegionPtr;
+
+}}
+
+#endif //#if !defined(CETTY_CHANNEL_FILEREGION_H)
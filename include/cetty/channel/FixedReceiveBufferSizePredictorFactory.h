@@ -41,16 +41,21 @@ public:
      * Creates a new factory that returns a {@link FixedReceiveBufferSizePredictor}
      * which always returns the same prediction of the specified buffer size.
      */
-    FixedReceiveBufferSizePredictorFactory(int bufferSize) {
-        predictor = new FixedReceiveBufferSizePredictor(bufferSize);
+    FixedReceiveBufferSizePredictorFactory(int bufferSize)
+        : bufferSize(bufferSize) {
+        if (bufferSize <= 0) {
+            throw InvalidArgumentException("bufferSize must greater than 0");
+        }
     }
 
-    ReceiveBufferSizePredictor* getPredictor() {
-        return predictor;
+    virtual ~FixedReceiveBufferSizePredictorFactory() {}
+
+    virtual ReceiveBufferSizePredictor* getPredictor() {
+        return new FixedReceiveBufferSizePredictor(bufferSize);
     }
 
 private:
-    ReceiveBufferSizePredictor* predictor;
+    int bufferSize;
 };
 
 }}
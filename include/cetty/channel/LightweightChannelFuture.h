@@ -0,0 +1,158 @@
+#if !defined(CETTY_CHANNEL_LIGHTWEIGHTCHANNELFUTURE_H)
+#define CETTY_CHANNEL_LIGHTWEIGHTCHANNELFUTURE_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <list>
+#include <cstddef>
+#include <boost/atomic.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "cetty/channel/ChannelFuture.h"
+
+namespace cetty { namespace logging {
+class InternalLogger;
+}}
+
+namespace cetty { namespace channel {
+
+using namespace ::cetty::util;
+using namespace ::cetty::logging;
+
+class ChannelFutureProgressListener;
+
+/**
+ * The {@link ChannelFuture} returned by {@link Channels#future(Channel&)}.
+ *
+ * Most of the futures are completed and observed in the I/O thread of
+ * their channels, so this future does not carry a mutex: its state is an
+ * atomic word and its listeners are guarded by a spin lock, which is never
+ * contended in that case.  A mutex and a condition variable are only
+ * created when {@link #await()} is called before the future is done.
+ *
+ * The memory of the futures is recycled through a free list of the thread
+ * which releases them, so creating a future in the I/O thread does not
+ * call the global allocator once the thread is warm.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class LightweightChannelFuture : public ChannelFuture {
+public:
+    /**
+     * The most freed futures each thread keeps for reuse.
+     */
+    static const int MAX_CACHED_COUNT = 1024;
+
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p, std::size_t size);
+
+    /**
+     * Returns the count of the freed futures the current thread keeps.
+     */
+    static int getCachedCount();
+
+public:
+    /**
+     * Creates a new instance.
+     *
+     * @param channel
+     *        the {@link Channel} associated with this future
+     * @param cancellable
+     *        <tt>true</tt> if and only if this future can be canceled
+     */
+    LightweightChannelFuture(Channel& channel, bool cancellable);
+    virtual ~LightweightChannelFuture();
+
+    virtual Channel& getChannel() const {
+        return *(this->channel);
+    }
+
+    virtual bool isDone() const;
+    virtual bool isSuccess() const;
+    virtual const Exception* getCause() const;
+    virtual bool isCancelled() const;
+
+    virtual void setListener(const ListenerFunction& listener);
+    virtual void addListener(ChannelFutureListener* listener);
+    virtual void removeListener(const ChannelFutureListener* listener);
+
+    virtual ChannelFuture& await();
+    virtual bool await(boost::int64_t timeout, const TimeUnit& unit);
+    virtual bool await(boost::int64_t timeoutMillis);
+
+    virtual ChannelFuture& awaitUninterruptibly();
+    virtual bool awaitUninterruptibly(boost::int64_t timeout, const TimeUnit& unit);
+    virtual bool awaitUninterruptibly(boost::int64_t timeoutMillis);
+
+    virtual bool setSuccess();
+    virtual bool setFailure(const Exception& cause);
+
+    virtual bool cancel();
+
+    virtual bool setProgress(boost::int64_t amount, boost::int64_t current, boost::int64_t total);
+
+private:
+    enum State {
+        PENDING,
+        SUCCEEDED,
+        FAILED,
+        CANCELLED
+    };
+
+    class Waiter;
+    class ThreadCache;
+    class SpinGuard;
+
+    bool complete(int state, const Exception* cause);
+
+    Waiter& waiter();
+    void wait(bool interruptable);
+    bool wait(boost::int64_t timeoutMillis, bool interruptable);
+
+    void notifyListeners();
+    void notifyListener(const ListenerFunction& l);
+    void notifyListener(ChannelFutureListener* l);
+    void notifyProgressListener(ChannelFutureProgressListener* l,
+                                boost::int64_t amount,
+                                boost::int64_t current,
+                                boost::int64_t total);
+
+    static ThreadCache* threadCache();
+    static boost::thread_specific_ptr<ThreadCache>& threadCaches();
+
+private:
+    static InternalLogger* logger;
+
+    bool cancellable;
+    boost::atomic<int> state;
+    mutable boost::atomic<bool> locked;
+
+    Channel* channel;
+
+    ListenerFunction functionListener;
+    ChannelFutureListener* firstListener;
+    std::list<ChannelFutureListener*>* otherListeners;
+    std::list<ChannelFutureProgressListener*>* progressListeners;
+
+    Exception* cause;
+    Waiter* waiters;
+};
+
+}}
+
+#endif //#if !defined(CETTY_CHANNEL_LIGHTWEIGHTCHANNELFUTURE_H)
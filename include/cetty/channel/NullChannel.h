@@ -73,6 +73,12 @@ public:
 
     virtual ChannelFuturePtr& getCloseFuture();
     virtual ChannelFuturePtr& getSucceededFuture();
+    virtual ChannelFuturePtr& getVoidFuture();
+
+    virtual ChannelEventLoop* getEventLoop() const { return NULL; }
+
+    virtual void retain() {}
+    virtual void release() {}
 
     virtual int  getInterestOps() const { return OP_NONE; }
     virtual bool isReadable() const { return false; }
@@ -0,0 +1,591 @@
+#if !defined(CETTY_CHANNEL_STATICCHANNELPIPELINE_H)
+#define CETTY_CHANNEL_STATICCHANNELPIPELINE_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <typeinfo>
+
+#include <boost/static_assert.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/mpl/if.hpp>
+#include <boost/mpl/eval_if.hpp>
+#include <boost/mpl/identity.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/is_base_of.hpp>
+
+#include "cetty/channel/ChannelSink.h"
+#include "cetty/channel/ChannelUpstreamHandler.h"
+#include "cetty/channel/ChannelDownstreamHandler.h"
+#include "cetty/channel/AbstractStaticChannelPipeline.h"
+
+#include "cetty/channel/ChannelEvent.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/ChildChannelStateEvent.h"
+#include "cetty/channel/ExceptionEvent.h"
+#include "cetty/channel/WriteCompletionEvent.h"
+
+#include "cetty/util/Exception.h"
+#include "cetty/util/Integer.h"
+
+namespace cetty { namespace channel {
+
+/**
+ * Marks the unused handler slots of a {@link StaticChannelPipeline}.
+ */
+struct StaticChannelPipelineNullHandler {};
+
+/**
+ * A {@link ChannelPipeline} whose handlers are fixed at the construction,
+ * and whose types are known at compile time.
+ *
+ * The event is passed from a {@link ChannelHandlerContext} to the next
+ * handler by a non-virtual call to the method of the concrete handler type,
+ * without the <tt>dynamic_cast</tt> and the checks of the linked contexts
+ * of the {@link DefaultChannelPipeline}, so the compiler could inline the
+ * hops of a fixed chain such as <tt>decoder -> handler -> encoder</tt>.
+ * The handler still calls its context through the virtual
+ * {@link ChannelHandlerContext} interface.
+ *
+ * <pre>
+ * typedef StaticChannelPipeline<HttpRequestDecoder,
+ *                               HttpResponseEncoder,
+ *                               HttpSnoopServerHandler> HttpSnoopPipeline;
+ *
+ * ChannelPipeline* getPipeline() {
+ *     return new HttpSnoopPipeline(new HttpRequestDecoder,
+ *                                  new HttpResponseEncoder,
+ *                                  new HttpSnoopServerHandler);
+ * }
+ * </pre>
+ *
+ * Up to 8 handlers are supported.  The handlers are named by their
+ * positions, <tt>"0"</tt>, <tt>"1"</tt> and so on.  Each handler must be
+ * exactly of its type parameter, not a subclass of it, because the methods
+ * of the type parameter are called directly; the constructor throws an
+ * {@link InvalidArgumentException} otherwise.  The handlers can not be added,
+ * removed or replaced, those operations throw an
+ * {@link UnsupportedOperationException}.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+template<typename H0,
+         typename H1 = StaticChannelPipelineNullHandler,
+         typename H2 = StaticChannelPipelineNullHandler,
+         typename H3 = StaticChannelPipelineNullHandler,
+         typename H4 = StaticChannelPipelineNullHandler,
+         typename H5 = StaticChannelPipelineNullHandler,
+         typename H6 = StaticChannelPipelineNullHandler,
+         typename H7 = StaticChannelPipelineNullHandler>
+class StaticChannelPipeline : public AbstractStaticChannelPipeline {
+private:
+    typedef StaticChannelPipelineNullHandler NullHandler;
+
+    template<typename H>
+    struct IsNull {
+        static const int value = boost::is_same<H, NullHandler>::value ? 1 : 0;
+    };
+
+    // the unused slots must be the trailing ones.
+    BOOST_STATIC_ASSERT(IsNull<H0>::value == 0);
+    BOOST_STATIC_ASSERT(IsNull<H1>::value <= IsNull<H2>::value);
+    BOOST_STATIC_ASSERT(IsNull<H2>::value <= IsNull<H3>::value);
+    BOOST_STATIC_ASSERT(IsNull<H3>::value <= IsNull<H4>::value);
+    BOOST_STATIC_ASSERT(IsNull<H4>::value <= IsNull<H5>::value);
+    BOOST_STATIC_ASSERT(IsNull<H5>::value <= IsNull<H6>::value);
+    BOOST_STATIC_ASSERT(IsNull<H6>::value <= IsNull<H7>::value);
+
+public:
+    /**
+     * The count of the handlers.
+     */
+    static const int COUNT = 8 - (IsNull<H1>::value + IsNull<H2>::value +
+                                  IsNull<H3>::value + IsNull<H4>::value +
+                                  IsNull<H5>::value + IsNull<H6>::value +
+                                  IsNull<H7>::value);
+
+private:
+    template<int N, typename Dummy = void> struct HandlerAt;
+    template<typename Dummy> struct HandlerAt<0, Dummy> { typedef H0 type; };
+    template<typename Dummy> struct HandlerAt<1, Dummy> { typedef H1 type; };
+    template<typename Dummy> struct HandlerAt<2, Dummy> { typedef H2 type; };
+    template<typename Dummy> struct HandlerAt<3, Dummy> { typedef H3 type; };
+    template<typename Dummy> struct HandlerAt<4, Dummy> { typedef H4 type; };
+    template<typename Dummy> struct HandlerAt<5, Dummy> { typedef H5 type; };
+    template<typename Dummy> struct HandlerAt<6, Dummy> { typedef H6 type; };
+    template<typename Dummy> struct HandlerAt<7, Dummy> { typedef H7 type; };
+
+    template<typename H>
+    struct HandlerPtr {
+        typedef boost::intrusive_ptr<H> type;
+    };
+
+    // what to do with the handler at a position, resolved at compile time.
+    struct HandleTag {};
+    struct SkipTag {};
+    struct EndTag {};
+
+    template<typename Base, int N>
+    struct HandleOrSkip {
+        typedef typename boost::mpl::if_<
+            boost::is_base_of<Base, typename HandlerAt<N>::type>,
+            HandleTag,
+            SkipTag>::type type;
+    };
+
+    template<int N>
+    struct UpstreamTag {
+        typedef typename boost::mpl::eval_if_c<
+            (N >= COUNT),
+            boost::mpl::identity<EndTag>,
+            HandleOrSkip<ChannelUpstreamHandler, N> >::type type;
+    };
+
+    template<int N>
+    struct DownstreamTag {
+        typedef typename boost::mpl::eval_if_c<
+            (N < 0),
+            boost::mpl::identity<EndTag>,
+            HandleOrSkip<ChannelDownstreamHandler, N> >::type type;
+    };
+
+    // the calls of each kind of event, to the handler and to the sink.
+    struct HandleUpstream {
+        typedef ChannelEvent Event;
+        template<typename H>
+        static void call(H* h, ChannelHandlerContext& ctx, const Event& e) {
+            h->H::handleUpstream(ctx, e);
+        }
+    };
+
+    struct MessageReceived {
+        typedef MessageEvent Event;
+        template<typename H>
+        static void call(H* h, ChannelHandlerContext& ctx, const Event& e) {
+            h->H::messageReceived(ctx, e);
+        }
+    };
+
+    struct ExceptionCaught {
+        typedef ExceptionEvent Event;
+        template<typename H>
+        static void call(H* h, ChannelHandlerContext& ctx, const Event& e) {
+            h->H::exceptionCaught(ctx, e);
+        }
+    };
+
+    struct WriteCompleted {
+        typedef WriteCompletionEvent Event;
+        template<typename H>
+        static void call(H* h, ChannelHandlerContext& ctx, const Event& e) {
+            h->H::writeCompleted(ctx, e);
+        }
+    };
+
+    struct ChannelStateChanged {
+        typedef ChannelStateEvent Event;
+        template<typename H>
+        static void call(H* h, ChannelHandlerContext& ctx, const Event& e) {
+            h->H::channelStateChanged(ctx, e);
+        }
+    };
+
+    struct ChildChannelStateChanged {
+        typedef ChildChannelStateEvent Event;
+        template<typename H>
+        static void call(H* h, ChannelHandlerContext& ctx, const Event& e) {
+            h->H::childChannelStateChanged(ctx, e);
+        }
+    };
+
+    struct HandleDownstream {
+        typedef ChannelEvent Event;
+        template<typename H>
+        static void call(H* h, ChannelHandlerContext& ctx, const Event& e) {
+            h->H::handleDownstream(ctx, e);
+        }
+        static void sink(ChannelSink& s, const ChannelPipeline& p, const Event& e) {
+            s.eventSunk(p, e);
+        }
+    };
+
+    struct WriteRequested {
+        typedef MessageEvent Event;
+        template<typename H>
+        static void call(H* h, ChannelHandlerContext& ctx, const Event& e) {
+            h->H::writeRequested(ctx, e);
+        }
+        static void sink(ChannelSink& s, const ChannelPipeline& p, const Event& e) {
+            s.writeRequested(p, e);
+        }
+    };
+
+    struct StateChangeRequested {
+        typedef ChannelStateEvent Event;
+        template<typename H>
+        static void call(H* h, ChannelHandlerContext& ctx, const Event& e) {
+            h->H::stateChangeRequested(ctx, e);
+        }
+        static void sink(ChannelSink& s, const ChannelPipeline& p, const Event& e) {
+            s.stateChangeRequested(p, e);
+        }
+    };
+
+    template<typename Base, typename H>
+    static Base* cast(H* h, boost::true_type) { return h; }
+
+    template<typename Base, typename H>
+    static Base* cast(H* h, boost::false_type) { return NULL; }
+
+    template<int N>
+    class Context : public ChannelHandlerContext {
+    public:
+        typedef typename HandlerAt<N>::type Handler;
+
+        Context() : pipeline(NULL), handler(NULL), attachment(NULL) {}
+        virtual ~Context() {}
+
+        void init(StaticChannelPipeline* pipeline,
+                  const boost::intrusive_ptr<Handler>& handler) {
+            if (!handler) {
+                throw NullPointerException("handler");
+            }
+
+            // a subclass would silently lose its overrides, as the calls
+            // are qualified with the type parameter.
+            if (typeid(*handler) != typeid(Handler)) {
+                throw InvalidArgumentException(
+                    std::string("the handler ") + Integer::toString(N) +
+                    " must be exactly of its type parameter.");
+            }
+
+            this->pipeline = pipeline;
+            this->handler = handler.get();
+            this->handlerPtr = handler;
+            this->name = Integer::toString(N);
+        }
+
+        Handler* get() const { return handler; }
+
+        virtual Channel& getChannel() const {
+            return pipeline->getChannel();
+        }
+
+        virtual ChannelPipeline& getPipeline() const {
+            return *pipeline;
+        }
+
+        virtual const std::string& getName() const {
+            return name;
+        }
+
+        virtual const ChannelHandlerPtr& getHandler() const {
+            return handlerPtr;
+        }
+
+        virtual ChannelUpstreamHandler* getUpstreamHandler() const {
+            return cast<ChannelUpstreamHandler>(handler,
+                boost::is_base_of<ChannelUpstreamHandler, Handler>());
+        }
+
+        virtual ChannelDownstreamHandler* getDownstreamHandler() const {
+            return cast<ChannelDownstreamHandler>(handler,
+                boost::is_base_of<ChannelDownstreamHandler, Handler>());
+        }
+
+        virtual bool canHandleUpstream() const {
+            return boost::is_base_of<ChannelUpstreamHandler, Handler>::value;
+        }
+
+        virtual bool canHandleDownstream() const {
+            return boost::is_base_of<ChannelDownstreamHandler, Handler>::value;
+        }
+
+        virtual void sendUpstream(const ChannelEvent& e) {
+            pipeline->template upstream<N + 1, HandleUpstream>(e);
+        }
+        virtual void sendUpstream(const MessageEvent& e) {
+            pipeline->template upstream<N + 1, MessageReceived>(e);
+        }
+        virtual void sendUpstream(const ChannelStateEvent& e) {
+            pipeline->template upstream<N + 1, ChannelStateChanged>(e);
+        }
+        virtual void sendUpstream(const ChildChannelStateEvent& e) {
+            pipeline->template upstream<N + 1, ChildChannelStateChanged>(e);
+        }
+        virtual void sendUpstream(const WriteCompletionEvent& e) {
+            pipeline->template upstream<N + 1, WriteCompleted>(e);
+        }
+        virtual void sendUpstream(const ExceptionEvent& e) {
+            pipeline->template upstream<N + 1, ExceptionCaught>(e);
+        }
+
+        virtual void sendDownstream(const ChannelEvent& e) {
+            pipeline->template downstream<N - 1, HandleDownstream>(e);
+        }
+        virtual void sendDownstream(const MessageEvent& e) {
+            pipeline->template downstream<N - 1, WriteRequested>(e);
+        }
+        virtual void sendDownstream(const ChannelStateEvent& e) {
+            pipeline->template downstream<N - 1, StateChangeRequested>(e);
+        }
+
+        virtual void* getAttachment() {
+            return attachment;
+        }
+        virtual const void* getAttachment() const {
+            return attachment;
+        }
+        virtual void setAttachment(void* attachment) {
+            this->attachment = attachment;
+        }
+
+    private:
+        StaticChannelPipeline* pipeline;
+        Handler* handler;
+        ChannelHandlerPtr handlerPtr;
+        std::string name;
+        void* attachment;
+    };
+
+    template<int N> friend class Context;
+
+    // the contexts from N to the last one.
+    template<int N, bool END = (N >= COUNT)>
+    struct Contexts : public Contexts<N + 1> {
+        Context<N> context;
+    };
+
+    template<int N>
+    struct Contexts<N, true> {};
+
+public:
+    StaticChannelPipeline(const typename HandlerPtr<H0>::type& h0) {
+        BOOST_STATIC_ASSERT(COUNT == 1);
+        init<0>(h0);
+    }
+
+    StaticChannelPipeline(const typename HandlerPtr<H0>::type& h0,
+                          const typename HandlerPtr<H1>::type& h1) {
+        BOOST_STATIC_ASSERT(COUNT == 2);
+        init<0>(h0); init<1>(h1);
+    }
+
+    StaticChannelPipeline(const typename HandlerPtr<H0>::type& h0,
+                          const typename HandlerPtr<H1>::type& h1,
+                          const typename HandlerPtr<H2>::type& h2) {
+        BOOST_STATIC_ASSERT(COUNT == 3);
+        init<0>(h0); init<1>(h1); init<2>(h2);
+    }
+
+    StaticChannelPipeline(const typename HandlerPtr<H0>::type& h0,
+                          const typename HandlerPtr<H1>::type& h1,
+                          const typename HandlerPtr<H2>::type& h2,
+                          const typename HandlerPtr<H3>::type& h3) {
+        BOOST_STATIC_ASSERT(COUNT == 4);
+        init<0>(h0); init<1>(h1); init<2>(h2); init<3>(h3);
+    }
+
+    StaticChannelPipeline(const typename HandlerPtr<H0>::type& h0,
+                          const typename HandlerPtr<H1>::type& h1,
+                          const typename HandlerPtr<H2>::type& h2,
+                          const typename HandlerPtr<H3>::type& h3,
+                          const typename HandlerPtr<H4>::type& h4) {
+        BOOST_STATIC_ASSERT(COUNT == 5);
+        init<0>(h0); init<1>(h1); init<2>(h2); init<3>(h3); init<4>(h4);
+    }
+
+    StaticChannelPipeline(const typename HandlerPtr<H0>::type& h0,
+                          const typename HandlerPtr<H1>::type& h1,
+                          const typename HandlerPtr<H2>::type& h2,
+                          const typename HandlerPtr<H3>::type& h3,
+                          const typename HandlerPtr<H4>::type& h4,
+                          const typename HandlerPtr<H5>::type& h5) {
+        BOOST_STATIC_ASSERT(COUNT == 6);
+        init<0>(h0); init<1>(h1); init<2>(h2); init<3>(h3); init<4>(h4);
+        init<5>(h5);
+    }
+
+    StaticChannelPipeline(const typename HandlerPtr<H0>::type& h0,
+                          const typename HandlerPtr<H1>::type& h1,
+                          const typename HandlerPtr<H2>::type& h2,
+                          const typename HandlerPtr<H3>::type& h3,
+                          const typename HandlerPtr<H4>::type& h4,
+                          const typename HandlerPtr<H5>::type& h5,
+                          const typename HandlerPtr<H6>::type& h6) {
+        BOOST_STATIC_ASSERT(COUNT == 7);
+        init<0>(h0); init<1>(h1); init<2>(h2); init<3>(h3); init<4>(h4);
+        init<5>(h5); init<6>(h6);
+    }
+
+    StaticChannelPipeline(const typename HandlerPtr<H0>::type& h0,
+                          const typename HandlerPtr<H1>::type& h1,
+                          const typename HandlerPtr<H2>::type& h2,
+                          const typename HandlerPtr<H3>::type& h3,
+                          const typename HandlerPtr<H4>::type& h4,
+                          const typename HandlerPtr<H5>::type& h5,
+                          const typename HandlerPtr<H6>::type& h6,
+                          const typename HandlerPtr<H7>::type& h7) {
+        BOOST_STATIC_ASSERT(COUNT == 8);
+        init<0>(h0); init<1>(h1); init<2>(h2); init<3>(h3); init<4>(h4);
+        init<5>(h5); init<6>(h6); init<7>(h7);
+    }
+
+    virtual ~StaticChannelPipeline() {}
+
+    /**
+     * Returns the handler at the position <tt>N</tt> with its own type.
+     */
+    template<int N>
+    typename HandlerAt<N>::type* getHandler() const {
+        return context<N>().get();
+    }
+
+    virtual void sendUpstream(const ChannelEvent& e) {
+        upstream<0, HandleUpstream>(e);
+    }
+    virtual void sendUpstream(const MessageEvent& e) {
+        upstream<0, MessageReceived>(e);
+    }
+    virtual void sendUpstream(const ExceptionEvent& e) {
+        upstream<0, ExceptionCaught>(e);
+    }
+    virtual void sendUpstream(const WriteCompletionEvent& e) {
+        upstream<0, WriteCompleted>(e);
+    }
+    virtual void sendUpstream(const ChannelStateEvent& e) {
+        upstream<0, ChannelStateChanged>(e);
+    }
+    virtual void sendUpstream(const ChildChannelStateEvent& e) {
+        upstream<0, ChildChannelStateChanged>(e);
+    }
+
+    virtual void sendDownstream(const ChannelEvent& e) {
+        downstream<COUNT - 1, HandleDownstream>(e);
+    }
+    virtual void sendDownstream(const MessageEvent& e) {
+        downstream<COUNT - 1, WriteRequested>(e);
+    }
+    virtual void sendDownstream(const ChannelStateEvent& e) {
+        downstream<COUNT - 1, StateChangeRequested>(e);
+    }
+
+private:
+    template<int N>
+    Context<N>& context() const {
+        return const_cast<Contexts<N>&>(
+                   static_cast<const Contexts<N>&>(contexts)).context;
+    }
+
+    template<int N, typename H>
+    void init(const boost::intrusive_ptr<H>& handler) {
+        Context<N>& ctx = context<N>();
+        ctx.init(this, handler);
+        addContext(&ctx);
+    }
+
+    // passes the event to the first upstream handler from the position N.
+    template<int N, typename Call>
+    void upstream(const typename Call::Event& e) {
+        upstream<N, Call>(e, typename UpstreamTag<N>::type());
+    }
+
+    template<int N, typename Call>
+    void upstream(const typename Call::Event& e, HandleTag) {
+        Context<N>& ctx = context<N>();
+        try {
+            Call::call(ctx.get(), ctx, e);
+        }
+        catch (const Exception& t) {
+            notifyHandlerException(e, t);
+        }
+        catch (const std::exception& t) {
+            notifyHandlerException(e, Exception(t.what()));
+        }
+        catch (...) {
+            notifyHandlerException(e, Exception("unknown exception."));
+        }
+    }
+
+    template<int N, typename Call>
+    void upstream(const typename Call::Event& e, SkipTag) {
+        upstream<N + 1, Call>(e);
+    }
+
+    template<int N, typename Call>
+    void upstream(const typename Call::Event& e, EndTag) {
+        // the last upstream handler discards it.
+    }
+
+    // passes the event to the first downstream handler from the position N
+    // backward, and to the sink at last.
+    template<int N, typename Call>
+    void downstream(const typename Call::Event& e) {
+        downstream<N, Call>(e, typename DownstreamTag<N>::type());
+    }
+
+    template<int N, typename Call>
+    void downstream(const typename Call::Event& e, HandleTag) {
+        Context<N>& ctx = context<N>();
+        try {
+            Call::call(ctx.get(), ctx, e);
+        }
+        catch (const Exception& t) {
+            notifyHandlerException(e, t);
+        }
+        catch (const std::exception& t) {
+            notifyHandlerException(e, Exception(t.what()));
+        }
+        catch (...) {
+            notifyHandlerException(e, Exception("unknown exception."));
+        }
+    }
+
+    template<int N, typename Call>
+    void downstream(const typename Call::Event& e, SkipTag) {
+        downstream<N - 1, Call>(e);
+    }
+
+    template<int N, typename Call>
+    void downstream(const typename Call::Event& e, EndTag) {
+        try {
+            Call::sink(*sink, *this, e);
+        }
+        catch (const Exception& t) {
+            notifyHandlerException(e, t);
+        }
+        catch (const std::exception& t) {
+            notifyHandlerException(e, Exception(t.what()));
+        }
+        catch (...) {
+            notifyHandlerException(e, Exception("unknown exception."));
+        }
+    }
+
+private:
+    Contexts<0> contexts;
+};
+
+template<typename H0, typename H1, typename H2, typename H3,
+         typename H4, typename H5, typename H6, typename H7>
+const int StaticChannelPipeline<H0, H1, H2, H3, H4, H5, H6, H7>::COUNT;
+
+}}
+
+#endif //#if !defined(CETTY_CHANNEL_STATICCHANNELPIPELINE_H)
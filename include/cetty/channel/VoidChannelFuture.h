@@ -0,0 +1,112 @@
+#if !defined(CETTY_CHANNEL_VOIDCHANNELFUTURE_H)
+#define CETTY_CHANNEL_VOIDCHANNELFUTURE_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/util/Exception.h"
+
+namespace cetty { namespace channel {
+
+using namespace ::cetty::util;
+
+/**
+ * The {@link ChannelFuture} of the fire-and-forget operations.  There is
+ * only one instance for each {@link Channel}, see
+ * {@link Channel#getVoidFuture()}, so writing with it allocates no future.
+ *
+ * It is never completed: {@link #setSuccess()} and
+ * {@link #setFailure(const Exception&)} are ignored, and adding a listener
+ * or waiting for it throws an {@link IllegalStateException}.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class VoidChannelFuture : public ChannelFuture {
+public:
+    /**
+     * Creates a new instance.
+     *
+     * @param channel the {@link Channel} associated with this future
+     */
+    VoidChannelFuture(Channel& channel) : channel(&channel) {}
+
+    virtual ~VoidChannelFuture() {}
+
+    virtual Channel& getChannel() const {
+        return *channel;
+    }
+
+    virtual bool isDone() const { return false; }
+    virtual bool isCancelled() const { return false; }
+    virtual bool isSuccess() const { return false; }
+    virtual const Exception* getCause() const { return NULL; }
+    virtual bool isVoid() const { return true; }
+
+    virtual bool cancel() { return false; }
+    virtual bool setSuccess() { return false; }
+    virtual bool setFailure(const Exception& cause) { return false; }
+    virtual bool setProgress(boost::int64_t amount, boost::int64_t current, boost::int64_t total) { return false; }
+
+    virtual void setListener(const ListenerFunction& listener) {
+        fail();
+    }
+    virtual void addListener(ChannelFutureListener* listener) {
+        fail();
+    }
+    virtual void removeListener(const ChannelFutureListener* listener) {
+        // NOOP
+    }
+
+    virtual ChannelFuture& await() {
+        fail();
+        return *this;
+    }
+    virtual bool await(boost::int64_t timeout, const TimeUnit& unit) {
+        fail();
+        return false;
+    }
+    virtual bool await(boost::int64_t timeoutMillis) {
+        fail();
+        return false;
+    }
+
+    virtual ChannelFuture& awaitUninterruptibly() {
+        fail();
+        return *this;
+    }
+    virtual bool awaitUninterruptibly(boost::int64_t timeout, const TimeUnit& unit) {
+        fail();
+        return false;
+    }
+    virtual bool awaitUninterruptibly(boost::int64_t timeoutMillis) {
+        fail();
+        return false;
+    }
+
+private:
+    static void fail() {
+        throw IllegalStateException("void future");
+    }
+
+private:
+    Channel* channel;
+};
+
+}}
+
+#endif //#if !defined(CETTY_CHANNEL_VOIDCHANNELFUTURE_H)
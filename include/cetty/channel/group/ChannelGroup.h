@@ -0,0 +1,196 @@
+#if !defined(CETTY_CHANNEL_GROUP_CHANNELGROUP_H)
+#define CETTY_CHANNEL_GROUP_CHANNELGROUP_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <map>
+#include <string>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cetty/channel/ChannelFutureListener.h"
+#include "cetty/channel/group/ChannelGroupFuture.h"
+#include "cetty/util/Integer.h"
+
+namespace cetty { namespace channel {
+class Channel;
+class ChannelMessage;
+class ChannelEventLoop;
+}}
+
+namespace cetty { namespace channel { namespace group {
+
+using namespace cetty::channel;
+using namespace cetty::util;
+
+/**
+ * A thread-safe set of open {@link Channel}s, which provides the I/O
+ * operations on all of them at once.  A closed channel is removed from the
+ * group automatically, so there is no need to remove it manually.
+ *
+ * The channels are kept by their {@link Channel#getEventLoop() event loop}.
+ * An operation on the group is handed over to every event loop as one
+ * batch, which runs the operation on all the channels of that event loop in
+ * its thread, instead of one cross-thread handoff per channel.  The
+ * channels without an event loop are handled by the calling thread.
+ *
+ * A {@link ChannelBuffer} written to the group is wrapped once as a
+ * read-only buffer, which is shared by all the channels, each of them
+ * writes a duplicate with its own indexes.  The other messages are encoded
+ * by the pipeline of every channel, unless an encoder is passed to
+ * {@link #write(const ChannelMessage&, const MessageEncoder&, bool)} to
+ * encode the message once for all of them:
+ *
+ * <pre>
+ * ChannelGroup recipients;
+ * recipients.add(channelA);
+ * recipients.add(channelB);
+ * ...
+ * recipients.write(ChannelBuffers::copiedBuffer("Service will shut down for maintenance in 5 minutes."));
+ * </pre>
+ *
+ * The batches refer to the group when they run, so a group should be
+ * destroyed after its last operation is done, or after its event loops
+ * stop.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class ChannelGroup : private boost::noncopyable {
+public:
+    /**
+     * Encodes the message into the {@link ChannelBuffer} written to all
+     * the channels of the group.
+     */
+    typedef boost::function1<ChannelMessage, const ChannelMessage&> MessageEncoder;
+
+public:
+    ChannelGroup();
+    explicit ChannelGroup(const std::string& name);
+
+    ~ChannelGroup();
+
+    /**
+     * Returns the name of this group.  A group name is purely for helping
+     * you to distinguish one group from others.
+     */
+    const std::string& getName() const { return name; }
+
+    /**
+     * Adds the channel to this group, the channel is removed when it is
+     * closed.
+     *
+     * @return <tt>false</tt> if the channel is already in this group.
+     */
+    bool add(Channel& channel);
+
+    /**
+     * @return <tt>false</tt> if the channel is not in this group.
+     */
+    bool remove(Channel& channel);
+
+    /**
+     * Returns the {@link Channel} whose ID matches the specified integer.
+     *
+     * @return the matching {@link Channel} if found. <tt>NULL</tt> otherwise.
+     */
+    Channel* find(const Integer& id) const;
+
+    int  size() const;
+    bool empty() const;
+
+    /**
+     * Writes the message to all the channels of this group.
+     *
+     * @param withFuture whether to track the writes of the channels with a
+     *        {@link ChannelGroupFuture}, the channels write with their void
+     *        futures if not.
+     *
+     * @return the {@link ChannelGroupFuture} of the write operation, or an
+     *         empty pointer if <tt>withFuture</tt> is <tt>false</tt>.
+     */
+    ChannelGroupFuturePtr write(const ChannelMessage& message,
+                                bool withFuture = true);
+
+    /**
+     * Encodes the message with the encoder once, and writes the encoded
+     * message to all the channels of this group.
+     */
+    ChannelGroupFuturePtr write(const ChannelMessage& message,
+                                const MessageEncoder& encoder,
+                                bool withFuture = true);
+
+    /**
+     * Closes all the channels of this group.
+     */
+    ChannelGroupFuturePtr close();
+
+    std::string toString() const;
+
+private:
+    typedef boost::function1<ChannelFuturePtr, Channel&> Operation;
+    typedef std::map<Integer, Channel*> Channels;
+    typedef std::map<ChannelEventLoop*, Channels> EventLoopChannels;
+
+    /**
+     * The channels of the group, shared with the batches queued in the
+     * event loops, which may run after the group has been destroyed.
+     */
+    struct Members {
+        boost::mutex mutex;
+        Channels channels;
+        EventLoopChannels eventLoopChannels;
+    };
+
+    typedef boost::shared_ptr<Members> MembersPtr;
+
+    class ClosedChannelRemover : public ChannelFutureListener {
+    public:
+        ClosedChannelRemover(ChannelGroup& group) : group(group) {}
+        virtual ~ClosedChannelRemover() {}
+
+        virtual void operationComplete(const ChannelFuturePtr& future);
+        virtual std::string toString() const { return "ClosedChannelRemover"; }
+
+    private:
+        ChannelGroup& group;
+    };
+
+private:
+    ChannelGroupFuturePtr execute(const Operation& operation, bool withFuture);
+
+    /**
+     * runs the operation on the channels of the event loop, in its thread.
+     */
+    static void runBatch(const MembersPtr& members,
+                         ChannelEventLoop* eventLoop,
+                         const Operation& operation,
+                         const ChannelGroupFuturePtr& future);
+
+private:
+    std::string name;
+
+    MembersPtr members;
+
+    ClosedChannelRemover remover;
+};
+
+}}}
+
+#endif //#if !defined(CETTY_CHANNEL_GROUP_CHANNELGROUP_H)
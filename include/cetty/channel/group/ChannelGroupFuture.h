@@ -0,0 +1,166 @@
+#if !defined(CETTY_CHANNEL_GROUP_CHANNELGROUPFUTURE_H)
+#define CETTY_CHANNEL_GROUP_CHANNELGROUPFUTURE_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/ChannelFutureListener.h"
+#include "cetty/util/ReferenceCounter.h"
+
+namespace cetty { namespace channel { namespace group {
+
+using namespace cetty::channel;
+
+class ChannelGroup;
+class ChannelGroupFuture;
+
+typedef boost::intrusive_ptr<ChannelGroupFuture> ChannelGroupFuturePtr;
+
+/**
+ * The result of an asynchronous {@link ChannelGroup} operation, which is
+ * composed of the {@link ChannelFuture}s of the operations on every
+ * {@link Channel} of the group.
+ *
+ * The operation is handed over to the event loop of the channels in
+ * batches, so the count of the channels is only known when all the batches
+ * have run.  The future is {@link #isDone() done} when all the batches have
+ * run and all the channel futures are done.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class ChannelGroupFuture : public cetty::util::ReferenceCounter<ChannelGroupFuture>,
+                           private ChannelFutureListener {
+public:
+    typedef boost::function1<void, const ChannelGroupFuturePtr&> ListenerFunction;
+
+public:
+    /**
+     * Creates a new instance.
+     *
+     * @param group        the {@link ChannelGroup} of the operation
+     * @param batchCount   the count of the batches of the operation
+     */
+    ChannelGroupFuture(ChannelGroup& group, int batchCount);
+
+    virtual ~ChannelGroupFuture() {}
+
+    /**
+     * Returns the {@link ChannelGroup} which is associated with this future.
+     */
+    ChannelGroup& getGroup() const { return group; }
+
+    /**
+     * Returns <tt>true</tt> if and only if this future is complete,
+     * regardless of whether the operation was successful or failed.
+     */
+    bool isDone() const;
+
+    /**
+     * Returns the count of the channels which the operation is done on, and
+     * the counts of the succeeded and failed ones of them.
+     */
+    int getCompletedCount() const;
+    int getSuccessCount() const;
+    int getFailureCount() const;
+
+    /**
+     * Returns <tt>true</tt> if and only if the operation is done and
+     * succeeded on all the channels, or there was no channel.
+     */
+    bool isCompleteSuccess() const;
+
+    /**
+     * Returns <tt>true</tt> if and only if the operation is done and
+     * failed on all the channels, but there was at least one channel.
+     */
+    bool isCompleteFailure() const;
+
+    /**
+     * Returns <tt>true</tt> if and only if the operation is done, and
+     * succeeded on some channels but failed on the others.
+     */
+    bool isPartialSuccess() const;
+
+    /**
+     * Adds the listener which is notified when this future is
+     * {@link #isDone() done}.  If this future is already done, the listener
+     * is notified immediately.
+     */
+    void addListener(const ListenerFunction& listener);
+
+    /**
+     * Waits for this future to be completed.
+     */
+    ChannelGroupFuture& await();
+
+    /**
+     * Waits for this future to be completed within the specified time
+     * limit.
+     *
+     * @return <tt>true</tt> if and only if the future was completed within
+     *         the specified time limit
+     */
+    bool await(boost::int64_t timeoutMillis);
+
+private:
+    friend class ChannelGroup;
+
+    /**
+     * called by a batch, in the event loop, before the operation is
+     * started on its channels.
+     */
+    void addFuture(const ChannelFuturePtr& future);
+
+    /**
+     * called by a batch after the operation is started on all its
+     * channels.
+     */
+    void batchCompleted();
+
+    virtual void operationComplete(const ChannelFuturePtr& future);
+    virtual std::string toString() const { return "ChannelGroupFuture"; }
+
+    void checkDone(boost::mutex::scoped_lock& lock);
+
+private:
+    ChannelGroup& group;
+
+    mutable boost::mutex mutex;
+    boost::condition_variable cond;
+
+    int pendingBatches;
+    int futureCount;
+    int successCount;
+    int failureCount;
+    bool done;
+
+    std::vector<ListenerFunction> listeners;
+
+    // keeps this future alive until all the channel futures are done.
+    ChannelGroupFuturePtr self;
+};
+
+}}}
+
+#endif //#if !defined(CETTY_CHANNEL_GROUP_CHANNELGROUPFUTURE_H)
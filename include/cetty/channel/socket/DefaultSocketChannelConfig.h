@@ -33,8 +33,28 @@ namespace cetty { namespace channel { namespace socket {
 class DefaultSocketChannelConfig : public ::cetty::channel::DefaultChannelConfig,
                                    public ::cetty::channel::socket::SocketChannelConfig {
 public:
-    DefaultSocketChannelConfig() : DefaultChannelConfig() {}
+    DefaultSocketChannelConfig()
+        : DefaultChannelConfig(),
+          writeBatchSize(DEFAULT_WRITE_BATCH_SIZE),
+          writeBatchBytes(DEFAULT_WRITE_BATCH_BYTES) {}
+
 	virtual ~DefaultSocketChannelConfig() {}
+
+    virtual bool setOption(const std::string& key, const boost::any& value);
+
+    virtual int  getWriteBatchSize() const { return writeBatchSize; }
+    virtual void setWriteBatchSize(int writeBatchSize);
+
+    virtual int  getWriteBatchBytes() const { return writeBatchBytes; }
+    virtual void setWriteBatchBytes(int writeBatchBytes);
+
+private:
+    static const int DEFAULT_WRITE_BATCH_SIZE  = 64;
+    static const int DEFAULT_WRITE_BATCH_BYTES = 256 * 1024;
+
+private:
+    int writeBatchSize;
+    int writeBatchBytes;
 };
 
 }}}
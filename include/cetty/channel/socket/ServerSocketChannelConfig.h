@@ -44,6 +44,8 @@ namespace cetty { namespace channel  { namespace socket {
  * <td><tt>"reuseAddress"</tt></td><td>{@link #setReuseAddress(bool)}</td>
  * </tr><tr>
  * <td><tt>"receiveBufferSize"</tt></td><td>{@link #setReceiveBufferSize(int)}</td>
+ * </tr><tr>
+ * <td><tt>"reusePort"</tt></td><td>{@link #setReusePort(bool)}</td>
  * </tr>
  * </table>
  *
@@ -79,6 +81,23 @@ public:
      */
     virtual void setReuseAddress(bool reuseAddress) = 0;
 
+    /**
+     * Returns <tt>true</tt> if every I/O thread accepts the connections
+     * on its own <a><tt>SO_REUSEPORT</tt></a> listening socket.
+     */
+    virtual bool isReusePort() const = 0;
+
+    /**
+     * Sets whether every I/O thread binds its own <a><tt>SO_REUSEPORT</tt></a>
+     * listening socket and accepts the connections directly onto itself,
+     * instead of a single acceptor handing them to the I/O threads.  The
+     * kernel then spreads the incoming connections over the threads.
+     *
+     * It takes effect when the channel binds, and requires the operating
+     * system to support <tt>SO_REUSEPORT</tt>.
+     */
+    virtual void setReusePort(bool reusePort) = 0;
+
     /**
      * Gets the <a><tt>SO_RCVBUF</tt></a> option.
      */
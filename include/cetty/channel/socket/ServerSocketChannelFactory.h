@@ -1,3 +1,6 @@
+#if !defined(CETTY_CHANNEL_SOCKET_SERVERSOCKETCHANNELFACTORY_H)
+#define CETTY_CHANNEL_SOCKET_SERVERSOCKETCHANNELFACTORY_H
+
 /*
  * Copyright 2009 Red Hat, Inc.
  *
@@ -18,6 +21,7 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
+#include <string>
 #include "cetty/channel/ServerChannelFactory.h"
 
 namespace cetty { namespace channel  { namespace socket {
@@ -39,8 +43,18 @@ public:
 
     virtual int  getIpProtocolVersion() const = 0;
     virtual void setIpProtocolVersion(int version) = 0;
+
+    /**
+     * Sets the strategy placing the new channels on the I/O threads, such as
+     * <tt>"roundRobin"</tt>, <tt>"leastConnections"</tt>,
+     * <tt>"leastPendingBytes"</tt> or <tt>"powerOfTwoChoices"</tt>.
+     * The factories having only one way of placement ignore it.
+     */
+    virtual void setChannelPlacement(const std::string& strategy) {}
 };
 
 typedef boost::shared_ptr<ServerSocketChannelFactory> ServerSocketChannelFactoryPtr;
 
 }}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_SERVERSOCKETCHANNELFACTORY_H)
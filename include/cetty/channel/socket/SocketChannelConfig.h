@@ -51,6 +51,10 @@ namespace cetty { namespace channel { namespace socket {
  * <td><tt>"sendBufferSize"</tt></td><td>{@link #setSendBufferSize(int)}</td>
  * </tr><tr>
  * <td><tt>"trafficClass"</tt></td><td>{@link #setTrafficClass(int)}</td>
+ * </tr><tr>
+ * <td><tt>"writeBatchSize"</tt></td><td>{@link #setWriteBatchSize(int)}</td>
+ * </tr><tr>
+ * <td><tt>"writeBatchBytes"</tt></td><td>{@link #setWriteBatchBytes(int)}</td>
  * </tr>
  * </table>
  *
@@ -130,6 +134,29 @@ public:
      */
     virtual void setPerformancePreferences(
             int connectionTime, int latency, int bandwidth) = 0;
+
+    /**
+     * Gets the maximum count of the queued messages which will be flushed
+     * together in one gathering write.
+     */
+    virtual int getWriteBatchSize() const = 0;
+
+    /**
+     * Sets the maximum count of the queued messages which will be flushed
+     * together in one gathering write.
+     */
+    virtual void setWriteBatchSize(int writeBatchSize) = 0;
+
+    /**
+     * Gets the maximum bytes of one gathering write.  A single message
+     * larger than this is still written in one write.
+     */
+    virtual int getWriteBatchBytes() const = 0;
+
+    /**
+     * Sets the maximum bytes of one gathering write.
+     */
+    virtual void setWriteBatchBytes(int writeBatchBytes) = 0;
 };
 
 }}}
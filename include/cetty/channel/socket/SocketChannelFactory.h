@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include <string>
 #include "cetty/channel/ChannelFactory.h"
 
 namespace cetty { namespace channel { namespace socket {
@@ -27,6 +28,14 @@ public:
 
     virtual int  getIpProtocolVersion() const = 0;
     virtual void setIpProtocolVersion(int version) = 0;
+
+    /**
+     * Sets the strategy placing the new channels on the I/O threads, such as
+     * <tt>"roundRobin"</tt>, <tt>"leastConnections"</tt>,
+     * <tt>"leastPendingBytes"</tt> or <tt>"powerOfTwoChoices"</tt>.
+     * The factories having only one way of placement ignore it.
+     */
+    virtual void setChannelPlacement(const std::string& strategy) {}
 };
 
 }}}
@@ -111,8 +111,13 @@ public:
      *        the {@link Executor} which will execute the I/O worker threads
      * @param workerCount
      *        the maximum number of I/O worker threads
+     * @param cpuAffinity
+     *        the cpus the I/O threads are pinned to when they start, see
+     *        {@link AsioServicePool#AsioServicePool(int, const std::vector<int>&)},
+     *        or an empty vector to leave them unpinned.
      */
-    AsioClientSocketChannelFactory(int ioThreadCount = 1);
+    AsioClientSocketChannelFactory(int ioThreadCount = 1,
+        const std::vector<int>& cpuAffinity = std::vector<int>());
     virtual ~AsioClientSocketChannelFactory();
 
     virtual Channel* newChannel(cetty::channel::ChannelPipeline* pipeline);
@@ -120,6 +125,10 @@ public:
     virtual int  getIpProtocolVersion() const { return ipProtocol; }
     virtual void setIpProtocolVersion(int version) { ipProtocol = version; } 
 
+    virtual void setChannelPlacement(const std::string& strategy) {
+        ioServicePool.setPlacementStrategy(strategy);
+    }
+
     virtual void releaseExternalResources();
 
     AsioServicePool& getIOServicePool() { return ioServicePool; }
@@ -21,6 +21,7 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
+#include <vector>
 #include <boost/asio.hpp>
 #include "cetty/channel/socket/DatagramChannelFactory.h"
 #include "cetty/channel/socket/asio/AsioServicePool.h"
@@ -97,8 +98,13 @@ public:
      *
      * @param workerExecutor
      *        the {@link Executor} which will execute the I/O worker threads
+     * @param cpuAffinity
+     *        the cpus the I/O threads are pinned to when they start, see
+     *        {@link AsioServicePool#AsioServicePool(int, const std::vector<int>&)},
+     *        or an empty vector to leave them unpinned.
      */
-    AsioDatagramChannelFactory(int ioThreadCount = 1);
+    AsioDatagramChannelFactory(int ioThreadCount = 1,
+        const std::vector<int>& cpuAffinity = std::vector<int>());
     virtual ~AsioDatagramChannelFactory();
 
     virtual Channel* newChannel(cetty::channel::ChannelPipeline* pipeline);
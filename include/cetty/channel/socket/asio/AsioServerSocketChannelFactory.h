@@ -1,4 +1,5 @@
 #if !defined(CETTY_CHANNEL_SOCKET_ASIO_ASIOSERVERSOCKETCHANNELFACTORY_H)
+#define CETTY_CHANNEL_SOCKET_ASIO_ASIOSERVERSOCKETCHANNELFACTORY_H
 
 /*
  * Copyright 2009 Red Hat, Inc.
@@ -20,6 +21,7 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
+#include <vector>
 #include <boost/asio.hpp>
 #include "cetty/channel/IpAddress.h"
 #include "cetty/channel/socket/ServerSocketChannelFactory.h"
@@ -108,10 +110,16 @@ public:
     /**
      * Creates a new instance.
      *
+     * @param cpuAffinity
+     *        the cpus the I/O threads are pinned to when they start, see
+     *        {@link AsioServicePool#AsioServicePool(int, const std::vector<int>&)},
+     *        or an empty vector to leave them unpinned.
+     *
      * @throws IOException
      *         if catch the exception, when open the acceptor.
      */
-    AsioServerSocketChannelFactory(int ioThreadCount = 1);
+    AsioServerSocketChannelFactory(int ioThreadCount = 1,
+        const std::vector<int>& cpuAffinity = std::vector<int>());
     virtual ~AsioServerSocketChannelFactory();
 
     virtual Channel* newChannel(cetty::channel::ChannelPipeline* pipeline);
@@ -119,6 +127,10 @@ public:
     virtual int  getIpProtocolVersion() const { return ipProtocol; }
     virtual void setIpProtocolVersion(int version) { ipProtocol = version; } 
 
+    virtual void setChannelPlacement(const std::string& strategy) {
+        ioServicePool.setPlacementStrategy(strategy);
+    }
+
     virtual void releaseExternalResources();
 
     AsioServicePool& getIOServicePool() { return ioServicePool; }
@@ -23,12 +23,17 @@
  * under the License.
  */
 
+#include <string>
 #include <vector>
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/mpl/size_t.hpp>
+#include <boost/detail/atomic_count.hpp>
+
+#include "cetty/channel/ChannelEventLoop.h"
+#include "cetty/util/internal/MpscQueue.h"
 
 namespace cetty { namespace channel { namespace socket { namespace asio {
 
@@ -37,19 +42,146 @@ namespace cetty { namespace channel { namespace socket { namespace asio {
  */
 class AsioServicePool : private boost::noncopyable {
 public:
-    class IOService {
+    /**
+     * An operation handed over to the thread of an {@link IOService} by
+     * {@link IOService#execute(Operation*)}.
+     */
+    class Operation : public cetty::util::internal::MpscQueueNode {
+    public:
+        virtual ~Operation() {}
+
+        /**
+         * called in the thread of the io_service.
+         */
+        virtual void run() = 0;
+    };
+
+    class IOService : public cetty::channel::ChannelEventLoop,
+                      private boost::noncopyable {
+    public:
+        /**
+         * the maximum operations run in one drain, the others are left
+         * to a following drain so the I/O completions are not starved.
+         */
+        static const int MAX_DRAIN_BATCH = 256;
+
     public:
-        IOService(int index) : poolIndex(index) {}
+        IOService(int index)
+            : poolIndex(index), cpuId(-1), nodeId(-1), channels(0), pendingBytes(0),
+              drainScheduled(false) {}
+
+        ~IOService();
 
         int index() const { return poolIndex; }
+
+        /**
+         * the cpu which the thread of this io_service is pinned to,
+         * or -1 if the thread is not pinned.
+         */
+        int cpu() const { return cpuId; }
+
+        /**
+         * the NUMA node of the {@link #cpu() cpu}, or -1 if unknown.
+         */
+        int numaNode() const { return nodeId; }
+
+        bool isPinned() const { return cpuId >= 0; }
         boost::asio::io_service& service() { return ioService; }
         operator boost::asio::io_service&() { return ioService; }
 
+        /**
+         * the count of the live channels running in this io_service.
+         */
+        long channelCount() const { return channels; }
+
+        /**
+         * the bytes queued for writing by the channels of this io_service.
+         */
+        long pendingWriteBytes() const { return pendingBytes; }
+
+        void increaseChannelCount() { ++channels; }
+        void decreaseChannelCount() { --channels; }
+
+        /**
+         * only called in the thread of this io_service.
+         */
+        void addPendingWriteBytes(int bytes) { pendingBytes += bytes; }
+
+        /**
+         * Runs the operation in the thread of this io_service, and deletes
+         * it after running.  It may be called by any thread.
+         *
+         * Unlike <tt>io_service::post</tt>, the operation is pushed into a
+         * lock-free queue, and the operations queued between two drains
+         * are run in a batch, woken up by a single post.  The operations
+         * from the same thread are run in the order they are executed.
+         */
+        void execute(Operation* operation);
+
+        /**
+         * Runs the task as an {@link Operation}.
+         */
+        virtual void execute(const Task& task);
+
+    private:
+        void drain();
+        void scheduleDrain();
+
     private:
+        friend class AsioServicePool;
+
         boost::asio::io_service ioService;
         int                     poolIndex;
+        int                     cpuId;
+        int                     nodeId;
+
+        boost::detail::atomic_count channels;
+
+        // only written by the thread of the io_service,
+        // the others only read it as a hint.
+        volatile long pendingBytes;
+
+        // the operations from the other threads, and whether a drain
+        // of them has been posted.
+        cetty::util::internal::MpscQueue operations;
+        boost::atomic<bool> drainScheduled;
+    };
+
+    /**
+     * Chooses the io_service for a new channel.
+     *
+     * The strategy may be called by several threads creating channels at
+     * the same time, it should only read the counters of the io_services
+     * and keep its own state atomic.
+     */
+    class PlacementStrategy {
+    public:
+        virtual ~PlacementStrategy() {}
+
+        /**
+         * returns the index of the io_service for the next channel.
+         */
+        virtual int choose(AsioServicePool& pool) = 0;
     };
 
+    typedef boost::shared_ptr<PlacementStrategy> PlacementStrategyPtr;
+
+    /**
+     * the names of the build-in placement strategies.
+     */
+    static const char* ROUND_ROBIN;
+    static const char* LEAST_CONNECTIONS;
+    static const char* LEAST_PENDING_BYTES;
+    static const char* POWER_OF_TWO_CHOICES;
+
+    /**
+     * Creates the build-in placement strategy by the name.
+     *
+     * @throws InvalidArgumentException
+     *         if the name is not one of the build-in strategies.
+     */
+    static PlacementStrategyPtr createPlacementStrategy(const std::string& name);
+
 public:
     /**
      * Construction of AsioServicePool
@@ -58,6 +190,24 @@ public:
      */
     AsioServicePool(int poolSize);
 
+    /**
+     * Constructs the pool whose threads are pinned to the cpus, the thread
+     * of the io_service <tt>i</tt> to <tt>cpus[i % cpus.size()]</tt>, and
+     * reports the resulting thread-to-core map to the log.
+     *
+     * Every thread pins itself when it starts, before it runs the
+     * io_service, so the read buffers of the channels, which are allocated
+     * by the threads of their io_services, come from the memory of the
+     * thread's NUMA node under the default first-touch policy of the
+     * operating system.  A thread which can not be pinned runs unpinned.
+     *
+     * Under single-thread mode, the thread calling {@link #run()} is pinned.
+     *
+     * @throws InvalidArgumentException
+     *         if <tt>cpus</tt> has a negative cpu.
+     */
+    AsioServicePool(int poolSize, const std::vector<int>& cpus);
+
     ~AsioServicePool() {}
     
     /**
@@ -77,14 +227,48 @@ public:
     void stop();
 
     /**
-     * Get an io_service to use.
+     * Get an io_service to use, which is chosen by the placement strategy,
+     * round-robin by default.
      */
     IOService& getIOService();
 
+    PlacementStrategyPtr getPlacementStrategy() const {
+        boost::lock_guard<boost::mutex> guard(placementMutex);
+        return placementStrategy;
+    }
+
+    /**
+     * Sets the placement strategy, the channels created before keep their
+     * io_services.
+     */
+    void setPlacementStrategy(const PlacementStrategyPtr& strategy);
+
+    /**
+     * Sets the build-in placement strategy by the name, does nothing if
+     * the strategy of the same name is already in use.
+     *
+     * @throws InvalidArgumentException
+     *         if the name is not one of the build-in strategies.
+     */
+    void setPlacementStrategy(const std::string& name);
+
     boost::asio::io_service& getIOService(int index) {
         return ioServices.at(index)->service();
     }
 
+    /**
+     * Get the io_service of the pool at the index.
+     */
+    IOService& at(int index) {
+        return *ioServices.at(index);
+    }
+
+    /**
+     * Returns the cpus which the threads are pinned to, or an empty vector
+     * if they are not pinned.
+     */
+    const std::vector<int>& getCpuAffinity() const { return cpuAffinity; }
+
     /**
      *
      */
@@ -103,7 +287,18 @@ private:
     typedef boost::shared_ptr<boost::asio::io_service::work> WorkPtr;
 
 private:
-    std::size_t runIOservice(boost::asio::io_service& ioservice);
+    void start(int poolSize);
+
+    /**
+     * Pins the calling thread if there is a cpu affinity, then runs the
+     * io_service.
+     */
+    std::size_t runIOservice(IOService& ioService);
+
+    /**
+     * Pins the calling thread, which runs the io_service, to the cpu.
+     */
+    bool pinThread(IOService& ioService, int cpu);
 
 private:
     // indicated this pool using thread.
@@ -112,8 +307,14 @@ private:
     // io service pool already running.
     bool running;
 
-    // The next io_service to use for a connection.
-    int nextIOserviceIndex;
+    // Chooses the next io_service to use for a connection.
+    PlacementStrategyPtr placementStrategy;
+
+    // the name of the build-in strategy in use, empty for a custom one.
+    std::string placementName;
+
+    // guards the strategy against the threads creating channels.
+    mutable boost::mutex placementMutex;
 
     // 
     boost::thread::id mainThreadId;
@@ -125,6 +326,9 @@ private:
     std::vector<WorkPtr> works;
 
     std::vector<ThreadPtr> threads;
+
+    // the cpus to pin the threads of the io_services to.
+    std::vector<int> cpuAffinity;
 };
 
 }}}}
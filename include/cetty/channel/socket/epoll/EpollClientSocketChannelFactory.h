@@ -0,0 +1,90 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLCLIENTSOCKETCHANNELFACTORY_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_EPOLLCLIENTSOCKETCHANNELFACTORY_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+
+#include "cetty/channel/IpAddress.h"
+#include "cetty/channel/socket/ClientSocketChannelFactory.h"
+#include "cetty/channel/socket/asio/AsioServicePool.h"
+#include "cetty/channel/socket/epoll/EpollEventLoopPool.h"
+
+#include "cetty/util/TimerFactory.h"
+
+namespace cetty { namespace channel { namespace socket { namespace asio {
+class AsioTcpSocketAddressImplFactory;
+class AsioIpAddressImplFactory;
+}}}}
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::channel::socket::asio;
+using namespace cetty::util;
+
+class EpollClientSocketPipelineSink;
+
+/**
+ * A {@link ClientSocketChannelFactory} which creates a client-side
+ * {@link SocketChannel} on top of the native, edge-triggered epoll of Linux.
+ *
+ * It is a drop-in replacement of the {@link AsioClientSocketChannelFactory}.
+ */
+class EpollClientSocketChannelFactory
+    : public cetty::channel::socket::ClientSocketChannelFactory {
+public:
+    /**
+     * Creates a new instance.
+     *
+     * @param ioThreadCount the count of the event loop threads,
+     *        -1 for the count of the processors, 0 for running
+     *        in the caller thread.
+     */
+    EpollClientSocketChannelFactory(int ioThreadCount = 1);
+    virtual ~EpollClientSocketChannelFactory();
+
+    virtual Channel* newChannel(cetty::channel::ChannelPipeline* pipeline);
+
+    virtual int  getIpProtocolVersion() const { return ipProtocol; }
+    virtual void setIpProtocolVersion(int version) { ipProtocol = version; }
+
+    virtual void releaseExternalResources();
+
+    EpollEventLoopPool& getEventLoopPool() { return eventLoopPool; }
+
+    void start();
+
+private:
+    int ipProtocol;
+
+    EpollClientSocketPipelineSink* sink;
+
+    EpollEventLoopPool eventLoopPool;
+    AsioServicePool    servicePool;
+
+    TimerFactoryPtr timerFactory;
+
+    std::vector<Channel*> clientChannels;
+
+    AsioTcpSocketAddressImplFactory* socketAddressFactory;
+    AsioIpAddressImplFactory* ipAddressFactory;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLCLIENTSOCKETCHANNELFACTORY_H)
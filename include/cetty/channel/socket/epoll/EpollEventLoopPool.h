@@ -0,0 +1,237 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLEVENTLOOPPOOL_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_EPOLLEVENTLOOPPOOL_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
+
+#include "cetty/channel/ChannelEventLoop.h"
+#include "cetty/util/Timer.h"
+#include "cetty/util/HashedWheelTimer.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+/**
+ * A pool of epoll based event loops, the counterpart of the
+ * {@link AsioServicePool} for the native epoll transport.
+ *
+ * Every event loop owns one epoll instance, an eventfd used to wake it up,
+ * a queue of pending tasks posted by other threads, and a
+ * {@link HashedWheelTimer} whose ticks are armed on a timerfd, so the
+ * timeouts of its channels expire in the loop thread.  All file
+ * descriptors are registered edge-triggered, so a handler must drain the
+ * socket until <tt>EAGAIN</tt> every time it is notified.
+ */
+class EpollEventLoopPool : private boost::noncopyable {
+public:
+    typedef boost::function0<void> Functor;
+
+    /**
+     * Receives the readiness notifications of one file descriptor.
+     */
+    class EventHandler {
+    public:
+        virtual ~EventHandler() {}
+
+        virtual void handleEvents(boost::uint32_t events) = 0;
+    };
+
+    class EventLoop : public cetty::channel::ChannelEventLoop,
+                      public cetty::util::HashedWheelTimer::TickSource,
+                      private boost::noncopyable {
+    public:
+        EventLoop(int index);
+        ~EventLoop();
+
+        int index() const { return poolIndex; }
+
+        /**
+         * Returns the timer of this loop, which runs its timeouts in the
+         * loop thread.
+         */
+        const cetty::util::TimerPtr& getTimer() const { return timer; }
+
+        /**
+         * Registers the file descriptor edge-triggered for the given events.
+         */
+        bool add(int fd, boost::uint32_t events, EventHandler* handler);
+        bool modify(int fd, boost::uint32_t events, EventHandler* handler);
+        bool remove(int fd);
+
+        /**
+         * Queues the functor to be run by the loop thread.  Can be called
+         * from any thread, the loop is only woken up when the queue was
+         * empty before.
+         */
+        void post(const Functor& functor);
+
+        /**
+         * Runs the functor immediately if called from the loop thread,
+         * otherwise {@link #post post} it.
+         */
+        void dispatch(const Functor& functor);
+
+        /**
+         * {@link #post Posts} the task.
+         */
+        virtual void execute(const Task& task) { post(task); }
+
+        /**
+         * Arms the timerfd for the tick of the {@link #getTimer() timer}.
+         */
+        virtual void expiresAt(const cetty::util::HashedWheelTimer::TimeType& time,
+                               const TickFunctor& onTick);
+
+        virtual void cancel();
+
+        bool isInLoopThread() const {
+            return boost::this_thread::get_id() == threadId;
+        }
+
+        const boost::thread::id& getThreadId() const { return threadId; }
+
+        void run();
+        void stop();
+
+    private:
+        friend class EpollEventLoopPool;
+
+        void wakeup();
+        void handleWakeup();
+        void handleTick();
+        void runPendingFunctors();
+
+    private:
+        // tells the loop the timerfd is readable.
+        class TickHandler : public EventHandler {
+        public:
+            TickHandler(EventLoop& loop) : loop(loop) {}
+            virtual void handleEvents(boost::uint32_t events) { loop.handleTick(); }
+
+        private:
+            EventLoop& loop;
+        };
+
+    private:
+        static const int MAX_EVENTS_PER_POLL = 256;
+
+        int poolIndex;
+        int epollFd;
+        int wakeupFd;
+        int timerFd;
+
+        volatile bool stopped;
+
+        // set by the pool before the loop thread runs, and never changed.
+        boost::thread::id threadId;
+
+        boost::mutex mutex;
+        std::vector<Functor> pendingFunctors;
+
+        TickHandler tickHandler;
+        TickFunctor tickFunctor;
+        cetty::util::TimerPtr timer;
+    };
+
+public:
+    /**
+     * Construction of EpollEventLoopPool
+     *
+     * if multi-thread, will automatically run.
+     */
+    EpollEventLoopPool(int poolSize);
+
+    ~EpollEventLoopPool();
+
+    /**
+     * Run all event loops in the pool.
+     * Usually, you only need to run manually under single-thread mode,
+     * from the thread which created the pool.
+     */
+    void run();
+
+    /**
+     *
+     */
+    void waitForExit();
+
+    /**
+     * Stop all event loops in the pool.
+     */
+    void stop();
+
+    /**
+     * Get an event loop to use.
+     */
+    EventLoop& getEventLoop();
+
+    EventLoop& getEventLoop(int index) {
+        return *eventLoops.at(index);
+    }
+
+    /**
+     *
+     */
+    boost::thread::id getThreadId(int index);
+
+    /**
+     *
+     */
+    bool isSingleThread() const { return !usingthread; }
+
+    int size() const { return static_cast<int>(eventLoops.size()); }
+
+private:
+    typedef boost::shared_ptr<boost::thread> ThreadPtr;
+    typedef boost::shared_ptr<EventLoop> EventLoopPtr;
+
+private:
+    /**
+     * Runs the event loop once the pool has set the thread ids of all the
+     * event loops.
+     */
+    void runEventLoop(EventLoop* eventLoop);
+
+private:
+    // indicated this pool using thread.
+    bool usingthread;
+
+    // event loop pool already running.
+    bool running;
+
+    // The next event loop to use for a connection, taken by the bosses
+    // and the connectors from their own threads.
+    boost::atomic<unsigned long> nextEventLoopIndex;
+
+    boost::thread::id mainThreadId;
+
+    // held while the threads are created and their ids are set.
+    boost::mutex startMutex;
+
+    std::vector<EventLoopPtr> eventLoops;
+    std::vector<ThreadPtr> threads;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLEVENTLOOPPOOL_H)
@@ -0,0 +1,100 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSERVERSOCKETCHANNELFACTORY_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSERVERSOCKETCHANNELFACTORY_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+
+#include "cetty/channel/IpAddress.h"
+#include "cetty/channel/socket/ServerSocketChannelFactory.h"
+#include "cetty/channel/socket/asio/AsioServicePool.h"
+#include "cetty/channel/socket/epoll/EpollEventLoopPool.h"
+
+#include "cetty/util/TimerFactory.h"
+
+namespace cetty { namespace channel { namespace socket { namespace asio {
+class AsioTcpSocketAddressImplFactory;
+class AsioIpAddressImplFactory;
+}}}}
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::channel::socket;
+using namespace cetty::channel::socket::asio;
+using namespace cetty::util;
+
+class EpollServerSocketChannel;
+class EpollServerSocketPipelineSink;
+
+/**
+ * A {@link ServerSocketChannelFactory} which creates a server-side
+ * {@link SocketChannel} on top of the native, edge-triggered epoll of Linux.
+ *
+ * It is a drop-in replacement of the {@link AsioServerSocketChannelFactory},
+ * the same {@link ChannelPipeline} works with both of them:
+ * <pre>
+ * ServerBootstrap bootstrap(
+ *     ChannelFactoryPtr(new EpollServerSocketChannelFactory(threadCount)));
+ * </pre>
+ *
+ * The accepted connections are distributed over the event loops of an
+ * {@link EpollEventLoopPool} in a round-robin way.  The {@link Timer} of a
+ * channel is the {@link HashedWheelTimer} of its event loop, only the
+ * {@link SocketAddress} resolution still relies on a small stand alone
+ * asio service.
+ */
+class EpollServerSocketChannelFactory : public ServerSocketChannelFactory {
+public:
+    /**
+     * Creates a new instance.
+     *
+     * @param ioThreadCount the count of the event loop threads,
+     *        -1 for the count of the processors, 0 for running
+     *        in the caller thread.
+     */
+    EpollServerSocketChannelFactory(int ioThreadCount = 1);
+    virtual ~EpollServerSocketChannelFactory();
+
+    virtual Channel* newChannel(cetty::channel::ChannelPipeline* pipeline);
+
+    virtual int  getIpProtocolVersion() const { return ipProtocol; }
+    virtual void setIpProtocolVersion(int version) { ipProtocol = version; }
+
+    virtual void releaseExternalResources();
+
+    EpollEventLoopPool& getEventLoopPool() { return eventLoopPool; }
+
+private:
+    int ipProtocol;
+
+    EpollServerSocketPipelineSink* sink;
+
+    EpollEventLoopPool eventLoopPool;
+    AsioServicePool    servicePool;
+
+    TimerFactoryPtr timerFactory;
+
+    AsioTcpSocketAddressImplFactory* socketAddressFactory;
+    AsioIpAddressImplFactory* ipAddressFactory;
+
+    std::vector<EpollServerSocketChannel*> channels;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSERVERSOCKETCHANNELFACTORY_H)
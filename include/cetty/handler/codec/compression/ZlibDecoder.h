@@ -0,0 +1,73 @@
+#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBDECODER_H)
+#define CETTY_HANDLER_CODEC_COMPRESSION_ZLIBDECODER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/oneone/OneToOneDecoder.h"
+#include "cetty/handler/codec/compression/ZlibWrapper.h"
+#include "cetty/handler/codec/compression/ZlibInflater.h"
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+using namespace cetty::channel;
+using namespace cetty::handler::codec::oneone;
+
+/**
+ * Decompresses a {@link ChannelBuffer} using the inflate algorithm.
+ * The received bytes after the end of the compressed stream are discarded.
+ *
+ *
+ * @author <a href="http://gleamynode.net/">Trustin Lee</a>
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ *
+ * @apiviz.landmark
+ * @apiviz.has org.jboss.netty.handler.codec.compression.ZlibWrapper
+ */
+
+class ZlibDecoder : public OneToOneDecoder {
+public:
+    /**
+     * Creates a new zlib decoder of the {@link ZlibWrapper#ZLIB} wrapper.
+     */
+    ZlibDecoder();
+
+    ZlibDecoder(const ZlibWrapper& wrapper);
+
+    virtual ~ZlibDecoder() {}
+
+    virtual ChannelHandlerPtr clone();
+    virtual std::string toString() const;
+
+    /**
+     * Returns <tt>true</tt> if and only if the end of the compressed stream
+     * has been reached.
+     */
+    bool isClosed() const { return inflater.isFinished(); }
+
+protected:
+    virtual ChannelMessage decode(ChannelHandlerContext& ctx,
+                                  Channel& channel,
+                                  const ChannelMessage& msg);
+
+private:
+    ZlibInflater inflater;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBDECODER_H)
@@ -0,0 +1,129 @@
+#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBDEFLATER_H)
+#define CETTY_HANDLER_CODEC_COMPRESSION_ZLIBDEFLATER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/handler/codec/compression/ZlibWrapper.h"
+
+struct z_stream_s;
+
+namespace cetty { namespace buffer {
+class ChannelBufferFactory;
+}}
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+using namespace cetty::buffer;
+
+/**
+ * Compresses a stream of {@link ChannelBuffer}s piece by piece with zlib.
+ * <p>
+ * The zlib stream is taken from the {@link ZlibStreamPool} of the calling
+ * thread at the first deflation, and given back once the stream is
+ * {@link #finish() finished} or the deflater is destroyed.  The compressed
+ * bytes are written straight into the buffers of the
+ * {@link ChannelBufferFactory}, which is the thread cached
+ * {@link PooledChannelBufferFactory} by default.
+ * <p>
+ * A deflater is not thread safe, it is meant to be used by one channel.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class ZlibDeflater : private boost::noncopyable {
+public:
+    static const int DEFAULT_COMPRESSION_LEVEL = 6;
+
+public:
+    /**
+     * Creates a new deflater with the default compression level
+     * (<tt>6</tt>) and the {@link ZlibWrapper#ZLIB} wrapper.
+     */
+    ZlibDeflater();
+
+    /**
+     * Creates a new deflater.
+     *
+     * @param compressionLevel
+     *        <tt>1</tt> yields the fastest compression and <tt>9</tt> yields the
+     *        best compression.  <tt>0</tt> means no compression.
+     *
+     * @throws InvalidArgumentException
+     *         if the level is not in [0, 9] or the wrapper is
+     *         {@link ZlibWrapper#ZLIB_OR_NONE}
+     */
+    ZlibDeflater(const ZlibWrapper& wrapper, int compressionLevel);
+
+    ZlibDeflater(const ZlibWrapper& wrapper,
+                 int compressionLevel,
+                 ChannelBufferFactory& factory);
+
+    ~ZlibDeflater();
+
+    /**
+     * Compresses the readable bytes of <tt>in</tt>, without modifying its
+     * <tt>readerIndex</tt>.
+     *
+     * @param flush if <tt>true</tt>, all the bytes compressed so far are
+     *        returned (<tt>Z_SYNC_FLUSH</tt>), so the peer can decompress
+     *        them at once, otherwise zlib may keep them for a better ratio.
+     *
+     * @return the compressed bytes, may be empty.
+     *
+     * @throws IllegalStateException if the deflater is finished.
+     * @throws CompressionException if zlib fails.
+     */
+    ChannelBufferPtr deflate(const ChannelBufferPtr& in, bool flush);
+
+    /**
+     * Ends the stream, returns the remaining compressed bytes and the footer
+     * of the wrapper, and gives back the zlib stream.  Returns an empty buffer
+     * if already finished.
+     */
+    ChannelBufferPtr finish();
+
+    bool isFinished() const { return finished; }
+
+    const ZlibWrapper& getWrapper() const { return wrapper; }
+
+    int getCompressionLevel() const { return compressionLevel; }
+
+private:
+    void init(ChannelBufferFactory& factory);
+
+    void compress(const char* bytes, int length, int flush);
+    ChannelBufferPtr drainOutput();
+    void releaseStream();
+
+private:
+    ZlibWrapper wrapper;
+    int compressionLevel;
+    bool finished;
+
+    z_stream_s* stream;
+    ChannelBufferFactory* factory;
+
+    std::vector<ChannelBufferPtr> outputs;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBDEFLATER_H)
@@ -0,0 +1,96 @@
+#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBENCODER_H)
+#define CETTY_HANDLER_CODEC_COMPRESSION_ZLIBENCODER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/oneone/OneToOneEncoder.h"
+#include "cetty/handler/codec/compression/ZlibWrapper.h"
+#include "cetty/handler/codec/compression/ZlibDeflater.h"
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+using namespace cetty::channel;
+using namespace cetty::handler::codec::oneone;
+
+/**
+ * Compresses a {@link ChannelBuffer} using the deflate algorithm.
+ * <p>
+ * Every written buffer is flushed (<tt>Z_SYNC_FLUSH</tt>), so the peer is
+ * able to decompress it as soon as it arrives.  The stream is finished,
+ * and the footer of the {@link ZlibWrapper} is written, before the channel
+ * is closed, disconnected or unbound.
+ *
+ *
+ * @author <a href="http://gleamynode.net/">Trustin Lee</a>
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ *
+ * @apiviz.landmark
+ * @apiviz.has org.jboss.netty.handler.codec.compression.ZlibWrapper
+ */
+
+class ZlibEncoder : public OneToOneEncoder {
+public:
+    /**
+     * Creates a new zlib encoder with the default compression level (<tt>6</tt>)
+     * and the {@link ZlibWrapper#ZLIB} wrapper.
+     */
+    ZlibEncoder();
+
+    /**
+     * Creates a new zlib encoder with the specified <tt>compressionLevel</tt>
+     * and the {@link ZlibWrapper#ZLIB} wrapper.
+     *
+     * @throws InvalidArgumentException if the level is not in [0, 9]
+     */
+    ZlibEncoder(int compressionLevel);
+
+    ZlibEncoder(const ZlibWrapper& wrapper);
+
+    /**
+     * @throws InvalidArgumentException
+     *         if the level is not in [0, 9] or the wrapper is
+     *         {@link ZlibWrapper#ZLIB_OR_NONE}
+     */
+    ZlibEncoder(const ZlibWrapper& wrapper, int compressionLevel);
+
+    virtual ~ZlibEncoder() {}
+
+    virtual ChannelHandlerPtr clone();
+    virtual std::string toString() const;
+
+    /**
+     * Returns <tt>true</tt> if and only if the end of the compressed stream
+     * has been reached.
+     */
+    bool isClosed() const { return deflater.isFinished(); }
+
+    virtual void stateChangeRequested(ChannelHandlerContext& ctx,
+                                      const ChannelStateEvent& e);
+
+protected:
+    virtual ChannelMessage encode(ChannelHandlerContext& ctx,
+                                  Channel& channel,
+                                  const ChannelMessage& msg);
+
+private:
+    ZlibDeflater deflater;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBENCODER_H)
@@ -0,0 +1,106 @@
+#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBINFLATER_H)
+#define CETTY_HANDLER_CODEC_COMPRESSION_ZLIBINFLATER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/handler/codec/compression/ZlibWrapper.h"
+
+struct z_stream_s;
+
+namespace cetty { namespace buffer {
+class ChannelBufferFactory;
+}}
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+using namespace cetty::buffer;
+
+/**
+ * Decompresses a stream of {@link ChannelBuffer}s piece by piece with zlib,
+ * the counterpart of {@link ZlibDeflater}.
+ * <p>
+ * The zlib stream is taken from the {@link ZlibStreamPool} of the calling
+ * thread when the first bytes arrive, and given back at the end of the
+ * compressed stream or when the inflater is destroyed.  Any bytes after the
+ * end of the stream are ignored.
+ * <p>
+ * An inflater is not thread safe, it is meant to be used by one channel.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class ZlibInflater : private boost::noncopyable {
+public:
+    /**
+     * Creates a new inflater of the {@link ZlibWrapper#ZLIB} wrapper.
+     */
+    ZlibInflater();
+
+    /**
+     * Creates a new inflater.  With {@link ZlibWrapper#ZLIB_OR_NONE} the
+     * wrapper is guessed from the first two bytes of the stream.
+     */
+    explicit ZlibInflater(const ZlibWrapper& wrapper);
+
+    ZlibInflater(const ZlibWrapper& wrapper, ChannelBufferFactory& factory);
+
+    ~ZlibInflater();
+
+    /**
+     * Decompresses the readable bytes of <tt>in</tt>, without modifying its
+     * <tt>readerIndex</tt>.
+     *
+     * @return the decompressed bytes, may be empty.
+     *
+     * @throws CompressionException if the bytes are corrupted.
+     */
+    ChannelBufferPtr inflate(const ChannelBufferPtr& in);
+
+    /**
+     * Returns <tt>true</tt> if the end of the compressed stream is reached.
+     */
+    bool isFinished() const { return finished; }
+
+    const ZlibWrapper& getWrapper() const { return wrapper; }
+
+private:
+    void decompress(const char* bytes, int length);
+    ChannelBufferPtr drainOutput();
+    void releaseStream();
+
+private:
+    ZlibWrapper wrapper;
+    int windowBits;
+    bool finished;
+
+    z_stream_s* stream;
+    ChannelBufferFactory* factory;
+
+    // the first byte of a ZLIB_OR_NONE stream, until the second arrives.
+    std::string header;
+
+    std::vector<ChannelBufferPtr> outputs;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBINFLATER_H)
@@ -0,0 +1,78 @@
+#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBSTREAMPOOL_H)
+#define CETTY_HANDLER_CODEC_COMPRESSION_ZLIBSTREAMPOOL_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+struct z_stream_s;
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+/**
+ * Caches the initialized zlib streams of each thread, so a stream is only
+ * reset rather than initialized for every compressed message, which saves
+ * the allocation of the about 256KB deflate state.
+ * <p>
+ * The streams are kept per thread, which is the I/O thread for the codecs
+ * in a pipeline, and told apart by their <tt>windowBits</tt> and level.  A
+ * stream may be released in another thread than the acquiring one, it is
+ * then cached by the releasing thread.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class ZlibStreamPool {
+public:
+    /**
+     * The maximum number of the cached streams of a kind in a thread.
+     */
+    static const int MAX_CACHED_COUNT = 8;
+
+public:
+    /**
+     * Returns a stream ready to deflate.
+     *
+     * @throws CompressionException if the stream can not be initialized.
+     */
+    static z_stream_s* acquireDeflater(int windowBits, int compressionLevel);
+
+    static void releaseDeflater(z_stream_s* stream, int windowBits, int compressionLevel);
+
+    /**
+     * Returns a stream ready to inflate.
+     *
+     * @throws CompressionException if the stream can not be initialized.
+     */
+    static z_stream_s* acquireInflater(int windowBits);
+
+    static void releaseInflater(z_stream_s* stream, int windowBits);
+
+    /**
+     * Returns the number of the streams cached by the calling thread.
+     */
+    static int getCachedCount();
+
+private:
+    class ThreadCache;
+
+    static ThreadCache& threadCache();
+
+    ZlibStreamPool() {}
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBSTREAMPOOL_H)
@@ -0,0 +1,76 @@
+#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBWRAPPER_H)
+#define CETTY_HANDLER_CODEC_COMPRESSION_ZLIBWRAPPER_H
+
+/*
+ * Copyright 2009 Red Hat, Inc.
+ *
+ * Red Hat licenses this file to you under the Apache License, version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ */
+
+#include <string>
+#include "cetty/util/Enum.h"
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+/**
+ * The container file formats that wrap the stream compressed by the
+ * <tt>DEFLATE</tt> algorithm.
+ *
+ *
+ * @author <a href="http://gleamynode.net/">Trustin Lee</a>
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class ZlibWrapper : public cetty::util::Enum<ZlibWrapper> {
+public:
+    /**
+     * The ZLIB wrapper as specified in <a href="http://tools.ietf.org/html/rfc1950">RFC 1950</a>.
+     */
+    static const ZlibWrapper ZLIB;
+
+    /**
+     * The GZIP wrapper as specified in <a href="http://tools.ietf.org/html/rfc1952">RFC 1952</a>.
+     */
+    static const ZlibWrapper GZIP;
+
+    /**
+     * Raw DEFLATE stream only (no header and no footer).
+     */
+    static const ZlibWrapper NONE;
+
+    /**
+     * Try {@link #ZLIB} first and then {@link #NONE} if the first attempt fails.
+     * Please note that you can specify this wrapper type only when decompressing.
+     */
+    static const ZlibWrapper ZLIB_OR_NONE;
+
+    /**
+     * Returns the <tt>windowBits</tt> which makes zlib read or write this
+     * wrapper.  {@link #ZLIB_OR_NONE} is resolved by the decoder, so it
+     * has the one of {@link #ZLIB}.
+     */
+    int windowBits() const;
+
+    std::string toString() const;
+
+private:
+    ZlibWrapper(int value) : cetty::util::Enum<ZlibWrapper>(value) {}
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_COMPRESSION_ZLIBWRAPPER_H)
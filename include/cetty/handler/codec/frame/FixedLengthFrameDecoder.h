@@ -79,7 +79,8 @@ protected:
             return ChannelMessage::EMPTY_MESSAGE;
         }
         else {
-            ChannelBufferPtr sub = buffer->slice(buffer->readerIndex(), frameLength);
+            ChannelBufferPtr sub =
+                extractFrame(buffer, buffer->readerIndex(), frameLength);
             buffer->readerIndex(buffer->readerIndex() + frameLength);
 
             return ChannelMessage(sub);
@@ -22,7 +22,9 @@
  */
 
 #include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/channel/Channel.h"
 #include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/SocketAddress.h"
 #include "cetty/channel/SimpleChannelUpstreamHandler.h"
 
 namespace cetty { namespace handler { namespace codec { namespace frame { 
@@ -121,6 +123,21 @@ using namespace cetty::buffer;
  * }
  * </pre>
  *
+ * <h3>Cumulating without copying</h3>
+ * <p>
+ * When the channel owns its read buffer (see
+ * {@link ChannelConfig#channelOwnBuffer()}), the bytes which are left
+ * undecoded are kept as a slice of the read buffer, and the next received
+ * bytes are appended as another slice, so the cumulative buffer may be a
+ * {@link CompositeChannelBuffer}.  The channel allocates a new read buffer
+ * rather than reuse one which is still referenced by a slice.  Only the
+ * fragments of at most {@link #MAX_COPIED_FRAGMENT_SIZE} bytes are copied,
+ * so that a large read buffer is not kept alive by a few bytes.
+ * <p>
+ * Use {@link #extractFrame(const ChannelBufferPtr&, int, int)} to take a
+ * frame out of the cumulative buffer, which returns a slice rather than a
+ * copy whenever the bytes will not be overwritten.
+ *
  * <h3>Returning a POJO rather than a {@link ChannelBuffer}</h3>
  * <p>
  * Please note that you can return an object of a different type than
@@ -190,9 +207,35 @@ public:
     virtual void exceptionCaught(
             ChannelHandlerContext& ctx, const ExceptionEvent& e);
 
+    /**
+     * Stops decoding, and keeps the received bytes undecoded from now on.
+     * It is called when this decoder is going to be replaced while it may
+     * be still on the call stack, e.g. by a handler of a decoded frame, so
+     * the bytes of the next protocol are left for the new decoder.
+     */
+    void stopDecoding() { decodingStopped = true; }
+
+    bool isDecodingStopped() const { return decodingStopped; }
+
+    /**
+     * Returns the received bytes which have not been decoded, or an empty
+     * pointer if there is none, and clears them.
+     */
+    ChannelBufferPtr takeUndecoded();
+
+public:
+    /**
+     * The undecoded bytes, up to this size, are copied rather than sliced.
+     */
+    static const int MAX_COPIED_FRAGMENT_SIZE = 1024;
+
 protected:
-    FrameDecoder() : unfold(false) {}
-    FrameDecoder(bool unfold) : unfold(unfold) {}
+    FrameDecoder()
+        : channelOwnBuffer(false), unfold(false), sliceable(false),
+          decodingStopped(false) {}
+    FrameDecoder(bool unfold)
+        : channelOwnBuffer(false), unfold(unfold), sliceable(false),
+          decodingStopped(false) {}
 
     /**
      * Decodes the received packets so far into a frame.
@@ -231,6 +274,17 @@ protected:
         return decode(ctx, channel, buffer);
     }
 
+    /**
+     * Extracts the sub-region of the specified buffer as a frame.  Returns a
+     * slice of the buffer if its bytes are not overwritten after the current
+     * {@link #decode(ChannelHandlerContext&, Channel&, const ChannelBufferPtr&)}
+     * call returns, i.e. the buffer is the cumulative buffer or is owned by
+     * the channel, otherwise returns a copy.
+     */
+    virtual ChannelBufferPtr extractFrame(const ChannelBufferPtr& buffer,
+                                          int index,
+                                          int length);
+
 private:
     void callDecode(ChannelHandlerContext& context,
                     Channel& channel,
@@ -243,11 +297,20 @@ private:
 
     void cleanup(ChannelHandlerContext& ctx, const ChannelStateEvent& e);
 
-    ChannelBufferPtr& getCumulation(ChannelHandlerContext& ctx);
+    /**
+     * Moves the readable bytes of the input to the end of the cumulation.
+     */
+    void appendToCumulation(const ChannelBufferPtr& input);
+
+    ChannelBufferPtr retain(const ChannelBufferPtr& input) const;
 
 protected:
     bool channelOwnBuffer;
     bool unfold;
+
+    // whether the buffer being decoded can be sliced.
+    bool sliceable;
+    bool decodingStopped;
     ChannelBufferPtr cumulation;
 };
 
@@ -208,13 +208,15 @@ public:
     LengthFieldBasedFrameDecoder(
             int maxFrameLength,
             int lengthFieldOffset, int lengthFieldLength)
-          : discardingTooLongFrame(true),
+          : discardingTooLongFrame(false),
             maxFrameLength(maxFrameLength),
             lengthFieldOffset(lengthFieldOffset),
             lengthFieldLength(lengthFieldLength),
             lengthFieldEndOffset(lengthFieldOffset + lengthFieldLength),
             lengthAdjustment(0),
-            initialBytesToStrip(0) {
+            initialBytesToStrip(0),
+            tooLongFrameLength(0),
+            bytesToDiscard(0) {
         validateParameters();
     }
 
@@ -239,24 +241,28 @@ public:
                                  int lengthFieldLength,
                                  int lengthAdjustment,
                                  int initialBytesToStrip)
-            : discardingTooLongFrame(true),
+            : discardingTooLongFrame(false),
               maxFrameLength(maxFrameLength),
               lengthFieldOffset(lengthFieldOffset),
               lengthFieldLength(lengthFieldLength),
               lengthFieldEndOffset(lengthFieldOffset + lengthFieldLength),
               lengthAdjustment(lengthAdjustment),
-              initialBytesToStrip(initialBytesToStrip) {
+              initialBytesToStrip(initialBytesToStrip),
+              tooLongFrameLength(0),
+              bytesToDiscard(0) {
         validateParameters();
     }
 
     LengthFieldBasedFrameDecoder(const LengthFieldBasedFrameDecoder& decoder)
-        : discardingTooLongFrame(decoder.discardingTooLongFrame),
+        : discardingTooLongFrame(false),
           maxFrameLength(decoder.maxFrameLength),
           lengthFieldOffset(decoder.lengthFieldOffset),
           lengthFieldLength(decoder.lengthFieldLength),
           lengthFieldEndOffset(decoder.lengthFieldEndOffset),
           lengthAdjustment(decoder.lengthAdjustment),
-          initialBytesToStrip(decoder.initialBytesToStrip) {
+          initialBytesToStrip(decoder.initialBytesToStrip),
+          tooLongFrameLength(0),
+          bytesToDiscard(0) {
     }
 
     virtual ~LengthFieldBasedFrameDecoder() {}
@@ -268,23 +274,6 @@ protected:
     virtual ChannelMessage decode(
         ChannelHandlerContext& ctx, Channel& channel, const ChannelBufferPtr& buffer);
 
-    /**
-     * Extract the sub-region of the specified buffer. This method is called by
-     * {@link #decode(ChannelHandlerContext, Channel, ChannelBuffer)} for each
-     * frame.  The default implementation returns a copy of the sub-region.
-     * For example, you could override this method to use an alternative
-     * {@link ChannelBufferFactory}.
-     * <p>
-     * If you are sure that the frame and its content are not accessed after
-     * the current {@link #decode(ChannelHandlerContext, Channel, ChannelBuffer)}
-     * call returns, you can even avoid memory copy by returning the sliced
-     * sub-region (i.e. <tt>return buffer.slice(index, length)</tt>).
-     * It's often useful when you convert the extracted frame into an object.
-     * Refer to the source code of {@link ObjectDecoder} to see how this method
-     * is overridden to avoid memory copy.
-     */
-    ChannelBufferPtr extractFrame(const ChannelBufferPtr& buffer, int index, int length);
-
 private:
     void fail(ChannelHandlerContext& ctx, int frameLength);
     void validateParameters();
@@ -25,6 +25,22 @@
 
 namespace cetty { namespace handler { namespace codec { namespace http {
 
+/**
+ * The default {@link HttpHeader} implementation.
+ * <p>
+ * The well-known names of {@link HttpHeaders::Names} are interned as tokens
+ * with precomputed hashes, so a header of them is matched by comparing the
+ * tokens.  Looking up a header by one of the {@link HttpHeaders::Names}
+ * constants does not even hash the name.
+ * <p>
+ * The headers added from a received buffer refer to its bytes, which are
+ * copied into strings only when they are read by {@link #get(const std::string&)}
+ * or the like.  The removed entries are kept for the next headers, so
+ * decoding the headers of a reused message allocates nothing.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
 class DefaultHttpHeader : public HttpHeader {
 public:
     DefaultHttpHeader();
@@ -48,6 +64,12 @@ public:
     virtual void add(const std::string& name, const std::string& value);
     virtual void add(const std::string& name, int value);
 
+    virtual void add(const ChannelBufferPtr& buffer,
+                     const char* name,
+                     int nameSize,
+                     const char* value,
+                     int valueSize);
+
     virtual void set(const std::string& name, const std::string& value);
     virtual void set(const std::string& name, int value);
 
@@ -59,19 +81,27 @@ public:
     virtual void clear();
 
 private:
+    /**
+     * A header name to look up: its hash, and its token if it is a
+     * well-known name, otherwise <tt>-1</tt>.
+     */
+    struct Name {
+        int hash;
+        int token;
+        const char* data;
+        int size;
+    };
+
     class Entry {
     public:
         int hash;
-        std::string key;
-        std::string value;
+        int token;
         Entry* next;
         Entry* before;
         Entry* after;
 
-        Entry() : hash(-1), key(), value(), next(NULL), before(NULL), after(NULL) {}
-        Entry(int hash, const std::string& key, const std::string& value)
-            : hash(hash), key(key), value(value), next(NULL), before(NULL), after(NULL) {
-        }
+        Entry() : hash(-1), token(-1), next(NULL), before(NULL), after(NULL),
+            nameRef(NULL), nameSize(0), valueRef(NULL), valueSize(0) {}
 
         void remove() {
             before->after = after;
@@ -85,40 +115,47 @@ private:
             after->before = this;
         }
 
-        const std::string& getKey() const {
-            return key;
-        }
+        const std::string& getKey() const;
 
         const std::string& getValue() const {
+            if (valueRef) {
+                value.assign(valueRef, valueSize);
+                valueRef = NULL;
+            }
             return value;
         }
 
-        void setValue(const std::string& value) {
-            this->value = value;
-        }
+        bool hasName(const Name& name) const;
+        bool hasValue(const std::string& value) const;
 
-        void set(int hash, const std::string& key, const std::string& value) {
-            this->hash = hash;
-            this->key = key;
+        void setName(const Name& name, bool copy);
+        void setValue(const std::string& value) {
             this->value = value;
+            valueRef = NULL;
         }
-
-        std::string toString() {
-            std::string buf(key);
-            buf += "=";
-            buf += value;
-            return buf;
+        void setValue(const char* value, int size) {
+            valueRef = value;
+            valueSize = size;
         }
 
         void clear() {
             key.clear();
             value.clear();
+            token = -1;
+            nameRef = valueRef = NULL;
             next = NULL;
         }
 
-        bool empty() const {
-            return key.empty();
-        }
+    private:
+        // the referenced bytes, which are copied into the strings on the
+        // first read.
+        mutable const char* nameRef;
+        int nameSize;
+        mutable const char* valueRef;
+        int valueSize;
+
+        mutable std::string key;
+        mutable std::string value;
 
     private:
         Entry(const Entry&);
@@ -126,15 +163,19 @@ private:
     };
 
 private:
-    Entry* newEntry(int h, const std::string& name, const std::string& value);
+    Entry* newEntry();
     void deleteEntry(Entry* entry);
     void clearFreeList();
 
-    void addHeader(int h, int i, const std::string& name, const std::string& value);
-    void removeHeader(int h, int i, const std::string& name);
-    void removeHeader(int h, int i, const std::string& name, const std::string& value);
+    Entry* find(const Name& name) const;
+
+    void addHeader(const Name& name, const std::string& value);
+    void removeHeader(const Name& name);
+    void removeHeader(const Name& name, const std::string& value);
 
 private:
+    friend class KnownHeaderNames;
+
     DefaultHttpHeader(const DefaultHttpHeader&);
     DefaultHttpHeader& operator=(const DefaultHttpHeader&);
 
@@ -142,13 +183,19 @@ private:
     static const int BUCKET_SIZE = 17;
     static const std::string EMPTY_VALUE;
 
-    static int  hash(const std::string& name);
-    static bool eq(const std::string& name1, const std::string& name2);
+    static Name nameOf(const std::string& name);
+    static Name nameOf(const char* name, int size);
+
+    static int  hash(const char* name, int size);
+    static bool eq(const char* name1, int size1, const char* name2, int size2);
     static int  index(int hash);
 
     Entry* entries[BUCKET_SIZE];
     Entry* head;
     Entry* freelist;
+
+    // the buffers which the referenced bytes belong to.
+    std::vector<ChannelBufferPtr> buffers;
 };
 
 }}}}
@@ -25,6 +25,8 @@
 
 #include "cetty/channel/ChannelUpstreamHandler.h"
 #include "cetty/channel/ChannelDownstreamHandler.h"
+#include "cetty/handler/codec/http/HttpMethod.h"
+#include "cetty/handler/codec/http/HttpRequest.h"
 #include "cetty/handler/codec/http/HttpRequestEncoder.h"
 #include "cetty/handler/codec/http/HttpResponseDecoder.h"
 
@@ -58,7 +60,7 @@ public:
      * <tt>maxChunkSize (8192)</tt>).
      */
     HttpClientCodec() 
-        : decoder(4096, 8192, 8192) {
+        : done(false), decoder(4096, 8192, 8192) {
         decoder.setHttpClientCodec(this);
         encoder.setHttpClientCodec(this);
     }
@@ -68,7 +70,8 @@ public:
      */
     HttpClientCodec(
             int maxInitialLineLength, int maxHeaderSize, int maxChunkSize)
-            : decoder(maxInitialLineLength, maxHeaderSize, maxChunkSize) {
+            : done(false),
+              decoder(maxInitialLineLength, maxHeaderSize, maxChunkSize) {
         decoder.setHttpClientCodec(this);
         encoder.setHttpClientCodec(this);
     }
@@ -133,11 +136,15 @@ private:
 
     protected:
         virtual ChannelMessage encode(
-            ChannelHandlerContext& ctx, Channel& channel, ChannelMessage& msg) {
-            HttpRequestPtr request = msg.smartPointer<HttpRequest, HttpMessage>();
+            ChannelHandlerContext& ctx, Channel& channel, const ChannelMessage& msg) {
+            HttpRequestPtr request = msg.smartPointer<HttpRequest>();
+            if (!request) {
+                request = msg.smartPointer<HttpRequest, HttpMessage>();
+            }
             
+            // the responses come in the order of the requests.
             if (request && !codec->isDone()) {
-                codec->queue.push_front(request->getMethod());
+                codec->queue.push_back(request->getMethod());
             }
             return HttpRequestEncoder::encode(ctx, channel, msg);
         }
@@ -174,13 +181,12 @@ private:
     protected:
         virtual ChannelMessage decode(ChannelHandlerContext& ctx,
                                       Channel& channel,
-                                      const ReplayingDecoderBufferPtr& buffer,
-                                      const int& state) {
+                                      const ChannelBufferPtr& buffer) {
             if (codec->isDone()) {
-                return buffer->readBytes(actualReadableBytes());
+                return buffer->readBytes(buffer->readableBytes());
             }
             else {
-                return HttpResponseDecoder::decode(ctx, channel, buffer, state);
+                return HttpResponseDecoder::decode(ctx, channel, buffer);
             }
         }
 
@@ -80,7 +80,9 @@ public:
 
 public:
     static void validateHeaderName(const std::string& name);
+    static void validateHeaderName(const char* name, int size);
     static void validateHeaderValue(const std::string& value);
+    static void validateHeaderValue(const char* value, int size);
     static bool isTransferEncodingChunked(const HttpMessage& m);
 
 private:
@@ -0,0 +1,218 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPCONNECTIONPOOL_H)
+#define CETTY_HANDLER_CODEC_HTTP_HTTPCONNECTIONPOOL_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <map>
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cetty/bootstrap/ClientBootstrap.h"
+#include "cetty/channel/ChannelFactory.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/handler/codec/http/HttpRequest.h"
+#include "cetty/handler/codec/http/HttpResponseFuture.h"
+
+namespace cetty { namespace util {
+class Timeout;
+}}
+
+namespace cetty { namespace handler { namespace codec { namespace http {
+
+using namespace cetty::channel;
+using namespace cetty::bootstrap;
+
+/**
+ * A pool of keep-alive HTTP client connections, keyed by <tt>host:port</tt>,
+ * which is built on a {@link ClientBootstrap} with an
+ * {@link HttpClientCodec} and an {@link HttpChunkAggregator}.
+ * <p>
+ * A request is sent over an idle connection of its host if there is one,
+ * which is counted as a hit.  Otherwise a new connection is opened, which
+ * is counted as a miss, unless the host already has
+ * <tt>maxConnectionsPerHost</tt> connections, then the request waits for
+ * the first connection which finishes its response.  The connections which
+ * stay idle for <tt>idleTimeout</tt> milliseconds are closed by the
+ * {@link Timer} of their I/O thread.
+ * <p>
+ * The connections are placed on the threads of the {@link AsioServicePool}
+ * by the {@link ChannelFactory}, so a host with several connections uses
+ * several I/O threads, as the placement strategy of the factory chooses:
+ * <pre>
+ * AsioClientSocketChannelFactory* factory = new AsioClientSocketChannelFactory(4);
+ * factory->setChannelPlacement(AsioServicePool::LEAST_CONNECTIONS);
+ *
+ * HttpConnectionPool pool(ChannelFactoryPtr(factory), 8, 30000);
+ * HttpResponseFuturePtr future = pool.request("localhost", 8080, request);
+ * </pre>
+ * A response is only reused when both the request and the response are
+ * keep-alive.  The pool must outlive its connections, so call
+ * {@link #releaseExternalResources()} before destroying it.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class HttpConnectionPool : private boost::noncopyable {
+public:
+    static const int DEFAULT_MAX_CONNECTIONS_PER_HOST = 8;
+    static const int DEFAULT_IDLE_TIMEOUT = 60000;
+    static const int DEFAULT_MAX_CONTENT_LENGTH = 1048576;
+
+public:
+    /**
+     * Creates a new instance with <tt>maxConnectionsPerHost (8)</tt>,
+     * <tt>idleTimeout (60000)</tt> and <tt>maxContentLength (1048576)</tt>.
+     */
+    HttpConnectionPool(const ChannelFactoryPtr& factory);
+
+    /**
+     * Creates a new instance.
+     *
+     * @param maxConnectionsPerHost
+     *        the maximum number of the connections of a host.
+     * @param idleTimeout
+     *        the milliseconds after which an idle connection is closed.
+     * @param maxContentLength
+     *        the maximum length of the content of a response.
+     *
+     * @throws InvalidArgumentException
+     *         if any of the parameters is not positive.
+     */
+    HttpConnectionPool(const ChannelFactoryPtr& factory,
+                       int maxConnectionsPerHost,
+                       int idleTimeout,
+                       int maxContentLength = DEFAULT_MAX_CONTENT_LENGTH);
+
+    ~HttpConnectionPool();
+
+    /**
+     * Returns the bootstrap of the connections, to set the options of them.
+     */
+    ClientBootstrap& getBootstrap() { return bootstrap; }
+
+    int getMaxConnectionsPerHost() const { return maxConnectionsPerHost; }
+    int getIdleTimeout() const { return idleTimeout; }
+
+    /**
+     * Sends the <tt>request</tt> to <tt>host:port</tt>.
+     *
+     * @return the future of the response.
+     *
+     * @throws IllegalStateException if the pool has been closed.
+     */
+    HttpResponseFuturePtr request(const std::string& host,
+                                  int port,
+                                  const HttpRequestPtr& request);
+
+    /**
+     * Returns the number of the open or opening connections of the host.
+     */
+    int getConnectionCount(const std::string& host, int port) const;
+
+    /**
+     * Returns the number of the idle connections of the host.
+     */
+    int getIdleConnectionCount(const std::string& host, int port) const;
+
+    /**
+     * Returns the number of the requests which are sent over an idle
+     * connection.
+     */
+    boost::int64_t getHitCount() const;
+
+    /**
+     * Returns the number of the requests which open a new connection.
+     */
+    boost::int64_t getMissCount() const;
+
+    /**
+     * Returns the number of the requests which wait for a connection,
+     * because their host has the maximum number of connections.
+     */
+    boost::int64_t getWaitCount() const;
+
+    /**
+     * Returns the total milliseconds the requests have waited for a
+     * connection.
+     */
+    boost::int64_t getWaitTime() const;
+
+    /**
+     * Closes the idle connections and fails the waiting requests.  The
+     * busy connections are closed after their responses.
+     */
+    void close();
+
+    /**
+     * Closes the pool and releases the resources of the channel factory.
+     */
+    void releaseExternalResources();
+
+private:
+    class Connection;
+    class HostPool;
+    class ConnectionPipelineFactory;
+    class Liveness;
+
+    typedef boost::shared_ptr<Liveness> LivenessPtr;
+    typedef std::map<std::string, HostPool*> HostPools;
+
+private:
+    HostPool& getHostPool(const std::string& host, int port);
+    const HostPool* findHostPool(const std::string& host, int port) const;
+
+    void connect(HostPool& pool,
+                 const HttpRequestPtr& request,
+                 const HttpResponseFuturePtr& future);
+
+    void connected(HostPool* pool,
+                   const HttpRequestPtr& request,
+                   const HttpResponseFuturePtr& future,
+                   const ChannelFuturePtr& connectFuture);
+
+    void release(Connection& connection);
+    void remove(Connection& connection);
+    void evict(const LivenessPtr& liveness,
+               HostPool* pool,
+               Connection* connection,
+               int generation,
+               cetty::util::Timeout& timeout);
+
+private:
+    int maxConnectionsPerHost;
+    int idleTimeout;
+    int maxContentLength;
+
+    boost::atomic<bool> closed;
+
+    // checked by the idle timeouts, which may expire after the pool has
+    // been destroyed.
+    LivenessPtr liveness;
+
+    ClientBootstrap bootstrap;
+
+    mutable boost::mutex mutex;
+    HostPools hostPools;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPCONNECTIONPOOL_H)
@@ -21,14 +21,16 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
+#include "cetty/handler/codec/http/HttpContentEncoder.h"
+
 namespace cetty { namespace handler { namespace codec { namespace http { 
 
 /**
  * Compresses an {@link HttpMessage} and an {@link HttpChunk} in <tt>gzip</tt> or
  * <tt>deflate</tt> encoding while respecting the <tt>"Accept-Encoding"</tt> header.
- * If there is no matching encoding, no compression is done.  For more
- * information on how this handler modifies the message, please refer to
- * {@link HttpContentEncoder}.
+ * If there is no matching encoding, or the content is shorter than the
+ * threshold, no compression is done.  For more information on how this
+ * handler modifies the message, please refer to {@link HttpContentEncoder}.
  *
  * 
  * @author <a href="http://gleamynode.net/">Trustin Lee</a>
@@ -36,12 +38,18 @@ namespace cetty { namespace handler { namespace codec { namespace http {
  */
 
 class HttpContentCompressor : public HttpContentEncoder {
+public:
+    /**
+     * The default minimum length of the content to compress, as a smaller
+     * content does not fill even one packet.
+     */
+    static const int DEFAULT_CONTENT_SIZE_THRESHOLD = 1024;
+
 public:
     /**
      * Creates a new handler with the default compression level (<tt>6</tt>).
      */
-    HttpContentCompressor() : compressionLevel(6) {
-    }
+    HttpContentCompressor();
 
     /**
      * Creates a new handler with the specified compression level.
@@ -51,59 +59,33 @@ public:
      *        best compression.  <tt>0</tt> means no compression.  The default
      *        compression level is <tt>6</tt>.
      */
-    HttpContentCompressor(int compressionLevel) : compressionLevel(compressionLevel) {
-        if (compressionLevel < 0 || compressionLevel > 9) {
-            throw InvalidArgumentException(
-                std::string("compressionLevel: ") +
-                Integer::toString(compressionLevel) +
-                std::string(" (expected: 0-9)"));    
-        }
-    }
+    HttpContentCompressor(int compressionLevel);
+
+    /**
+     * Creates a new handler with the specified compression level and the
+     * minimum length of the content to compress.
+     */
+    HttpContentCompressor(int compressionLevel, int contentSizeThreshold);
 
     virtual ~HttpContentCompressor() {}
 
+    virtual ChannelHandlerPtr clone();
+    virtual std::string toString() const;
+
 protected:
-    EncoderEmbedder<ChannelBuffer> newContentEncoder(std::string acceptEncoding) {
-        ZlibWrapper wrapper = determineWrapper(acceptEncoding);
-        if (wrapper == null) {
-            return null;
-        }
-
-        return new EncoderEmbedder<ChannelBuffer>(new ZlibEncoder(wrapper, compressionLevel));
-    }
-
-    std::string getTargetContentEncoding(std::string acceptEncoding) {
-        ZlibWrapper wrapper = determineWrapper(acceptEncoding);
-        if (wrapper == null) {
-            return null;
-        }
-
-        switch (wrapper) {
-        case GZIP:
-            return "gzip";
-        case ZLIB:
-            return "deflate";
-        default:
-            throw new Error();
-        }
-    }
+    virtual ZlibDeflater* newContentEncoder(const std::string& acceptEncoding);
+
+    virtual std::string getTargetContentEncoding(const std::string& acceptEncoding);
 
 private:
-    ZlibWrapper determineWrapper(std::string acceptEncoding) {
-        // FIXME: Use the Q value.
-        if (acceptEncoding.indexOf("gzip") >= 0) {
-            return ZlibWrapper.GZIP;
-        }
-        if (acceptEncoding.indexOf("deflate") >= 0) {
-            return ZlibWrapper.ZLIB;
-        }
-        return null;
-    }
+    /**
+     * Returns the wrapper of the best accepted encoding, or <tt>NULL</tt>.
+     */
+    const ZlibWrapper* determineWrapper(const std::string& acceptEncoding) const;
 
 private:
     int compressionLevel;
-}
-
+};
 
 }}}}
 
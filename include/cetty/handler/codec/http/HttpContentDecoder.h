@@ -21,23 +21,34 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
+#include <string>
+#include <boost/scoped_ptr.hpp>
+
 #include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/handler/codec/compression/ZlibInflater.h"
 
 namespace cetty { namespace handler { namespace codec { namespace http { 
 
+class HttpMessage;
+
+using namespace cetty::channel;
+using namespace cetty::handler::codec::compression;
+
 /**
  * Decodes the content of the received {@link HttpRequest} and {@link HttpChunk}.
  * The original content is replaced with the new content decoded by the
- * {@link DecoderEmbedder}, which is created by {@link #newContentDecoder(std::string)}.
+ * {@link ZlibInflater}, which is created by {@link #newContentDecoder(std::string)}.
  * Once decoding is finished, the value of the <tt>'Content-Encoding'</tt>
  * header is set to the target content encoding, as returned by {@link #getTargetContentEncoding(std::string)}.
  * Also, the <tt>'Content-Length'</tt> header is updated to the length of the
  * decoded content.  If the content encoding of the original is not supported
- * by the decoder, {@link #newContentDecoder(String)} should return <tt>null</tt>
+ * by the decoder, {@link #newContentDecoder(std::string)} should return <tt>NULL</tt>
  * so that no decoding occurs (i.e. pass-through).
  * <p>
+ * The chunks are decoded one by one as they are received.
+ * <p>
  * Please note that this is an abstract class.  You have to extend this class
- * and implement {@link #newContentDecoder(String)} properly to make this class
+ * and implement {@link #newContentDecoder(std::string)} properly to make this class
  * functional.  For example, refer to the source code of {@link HttpContentDecompressor}.
  * <p>
  * This handler must be placed after {@link HttpMessageDecoder} in the pipeline
@@ -51,105 +62,27 @@ namespace cetty { namespace handler { namespace codec { namespace http {
 
 class HttpContentDecoder : public cetty::channel::SimpleChannelUpstreamHandler {
 public:
-    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
-        Object msg = e.getMessage();
-        if (msg instanceof HttpResponse && ((HttpResponse) msg).getStatus().getCode() == 100) {
-            // 100-continue response must be passed through.
-            ctx.sendDownstream(e);
-        }
-        else if (msg instanceof HttpMessage) {
-            HttpMessage m = (HttpMessage) msg;
-
-            decoder = null;
-
-            // Determine the content encoding.
-            std::string contentEncoding = m.getHeader(HttpHeaders.Names.CONTENT_ENCODING);
-            if (contentEncoding != null) {
-                contentEncoding = contentEncoding.trim();
-            }
-            else {
-                contentEncoding = HttpHeaders::Values::IDENTITY;
-            }
-
-            bool hasContent = m.isChunked() || m.getContent().readable();
-            if (hasContent && (decoder = newContentDecoder(contentEncoding)) != null) {
-                // Decode the content and remove or replace the existing headers
-                // so that the message looks like a decoded message.
-                m.setHeader(
-                        HttpHeaders.Names.CONTENT_ENCODING,
-                        getTargetContentEncoding(contentEncoding));
-
-                if (!m.isChunked()) {
-                    ChannelBuffer content = m.getContent();
-                    // Decode the content
-                    content = ChannelBuffers::wrappedBuffer(
-                            decode(content), finishDecode());
-
-                    // Replace the content.
-                    m.setContent(content);
-                    if (m.containsHeader(HttpHeaders.Names.CONTENT_LENGTH)) {
-                        m.setHeader(
-                                HttpHeaders.Names.CONTENT_LENGTH,
-                                Integer.toString(content.readableBytes()));
-                    }
-                }
-            }
-
-            // Because HttpMessage is a mutable object, we can simply forward the received event.
-            ctx.sendUpstream(e);
-        }
-        else if (msg instanceof HttpChunk) {
-            HttpChunk c = (HttpChunk) msg;
-            ChannelBuffer content = c.getContent();
-
-            // Decode the chunk if necessary.
-            if (decoder != null) {
-                if (!c.isLast()) {
-                    content = decode(content);
-                    if (content.readable()) {
-                        c.setContent(content);
-                        ctx.sendUpstream(e);
-                    }
-                } else {
-                    ChannelBuffer lastProduct = finishDecode();
-
-                    // Generate an additional chunk if the decoder produced
-                    // the last product on closure,
-                    if (lastProduct.readable()) {
-                        Channels.fireMessageReceived(
-                                ctx, new DefaultHttpChunk(lastProduct), e.getRemoteAddress());
-                    }
-
-                    // Emit the last chunk.
-                    ctx.sendUpstream(e);
-                }
-            }
-            else {
-                ctx.sendUpstream(e);
-            }
-        }
-        else {
-            ctx.sendUpstream(e);
-        }
-    }
+    virtual ~HttpContentDecoder() {}
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e);
 
 protected:
     /**
      * Creates a new instance.
      */
-    HttpContentDecoder() {
-    }
+    HttpContentDecoder() {}
 
     /**
-     * Returns a new {@link DecoderEmbedder} that decodes the HTTP message
-     * content encoded in the specified <tt>contentEncoding</tt>.
+     * Returns a new {@link ZlibInflater} that decodes the HTTP message
+     * content encoded in the specified <tt>contentEncoding</tt>.  The caller
+     * takes the ownership of the inflater.
      *
      * @param contentEncoding the value of the <tt>"Content-Encoding"</tt> header
-     * @return a new {@link DecoderEmbedder} if the specified encoding is supported.
-     *         <tt>null</tt> otherwise (alternatively, you can throw an exception
+     * @return a new {@link ZlibInflater} if the specified encoding is supported.
+     *         <tt>NULL</tt> otherwise (alternatively, you can throw an exception
      *         to block unknown encoding).
      */
-    virtual DecoderEmbedder<ChannelBuffer> newContentDecoder(std::string contentEncoding) = 0;
+    virtual ZlibInflater* newContentDecoder(const std::string& contentEncoding) = 0;
 
     /**
      * Returns the expected content encoding of the decoded content.
@@ -159,32 +92,15 @@ protected:
      * @param contentEncoding the value of the <tt>"Content-Encoding"</tt> header
      * @return the expected content encoding of the new content
      */
-    std::string getTargetContentEncoding(std::string contentEncoding) {
-        return HttpHeaders.Values.IDENTITY;
-    }
+    virtual std::string getTargetContentEncoding(const std::string& contentEncoding);
 
 private:
-    ChannelBuffer decode(ChannelBuffer buf) {
-        decoder.offer(buf);
-        return ChannelBuffers.wrappedBuffer(decoder.pollAll(new ChannelBuffer[decoder.size()]));
-    }
-
-    ChannelBuffer finishDecode() {
-        ChannelBuffer result;
-        if (decoder.finish()) {
-            result = ChannelBuffers.wrappedBuffer(decoder.pollAll(new ChannelBuffer[decoder.size()]));
-        } else {
-            result = ChannelBuffers.EMPTY_BUFFER;
-        }
-        decoder = null;
-        return result;
-    }
+    void decodeMessage(HttpMessage& message);
 
 private:
-    DecoderEmbedder<ChannelBuffer> decoder;
+    boost::scoped_ptr<ZlibInflater> decoder;
 };
 
-
 }}}}
 
 #endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPCONTENTDECODER_H)
@@ -39,18 +39,11 @@ public:
     HttpContentDecompressor() {}
     virtual ~HttpContentDecompressor() {}
 
+    virtual ChannelHandlerPtr clone();
+    virtual std::string toString() const;
+
 protected:
-    virtual DecoderEmbedder<ChannelBuffer> newContentDecoder(std::string contentEncoding) throws Exception {
-        if ("gzip".equalsIgnoreCase(contentEncoding) || "x-gzip".equalsIgnoreCase(contentEncoding)) {
-            return new DecoderEmbedder<ChannelBuffer>(new ZlibDecoder(ZlibWrapper.GZIP));
-        }
-        else if ("deflate".equalsIgnoreCase(contentEncoding) || "x-deflate".equalsIgnoreCase(contentEncoding)) {
-            return new DecoderEmbedder<ChannelBuffer>(new ZlibDecoder(ZlibWrapper.ZLIB));
-        }
-
-        // 'identity' or unsupported
-        return null;
-    }
+    virtual ZlibInflater* newContentDecoder(const std::string& contentEncoding);
 };
 
 }}}}
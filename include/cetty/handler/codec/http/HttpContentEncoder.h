@@ -21,24 +21,41 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
+#include <deque>
+#include <string>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
 #include "cetty/channel/SimpleChannelHandler.h"
+#include "cetty/handler/codec/compression/ZlibDeflater.h"
 
 namespace cetty { namespace handler { namespace codec { namespace http { 
 
+class HttpMessage;
+
+using namespace cetty::channel;
+using namespace cetty::handler::codec::compression;
+
 /**
  * Encodes the content of the outbound {@link HttpResponse} and {@link HttpChunk}.
  * The original content is replaced with the new content encoded by the
- * {@link EncoderEmbedder}, which is created by {@link #newContentEncoder(String)}.
+ * {@link ZlibDeflater}, which is created by {@link #newContentEncoder(std::string)}.
  * Once encoding is finished, the value of the <tt>'Content-Encoding'</tt> header
- * is set to the target content encoding, as returned by {@link #getTargetContentEncoding(String)}.
+ * is set to the target content encoding, as returned by {@link #getTargetContentEncoding(std::string)}.
  * Also, the <tt>'Content-Length'</tt> header is updated to the length of the
  * encoded content.  If there is no supported encoding in the
  * corresponding {@link HttpRequest}'s <tt>"Accept-Encoding"</tt> header,
- * {@link #newContentEncoder(String)} should return <tt>null</tt> so that no
+ * {@link #newContentEncoder(std::string)} should return <tt>NULL</tt> so that no
  * encoding occurs (i.e. pass-through).
  * <p>
+ * The content of a chunked message is compressed chunk by chunk as the
+ * chunks are written, so it is never held in memory as a whole.  The
+ * content of a message which is not chunked and shorter than
+ * {@link #getContentSizeThreshold()} is passed through, as compressing it
+ * would cost more than sending it.
+ * <p>
  * Please note that this is an abstract class.  You have to extend this class
- * and implement {@link #newContentEncoder(String)} and {@link #getTargetContentEncoding(String)}
+ * and implement {@link #newContentEncoder(std::string)} and {@link #getTargetContentEncoding(std::string)}
  * properly to make this class functional.  For example, refer to the source
  * code of {@link HttpContentCompressor}.
  * <p>
@@ -51,124 +68,43 @@ namespace cetty { namespace handler { namespace codec { namespace http {
  * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
  */
 
-class HttpContentEncoder : public cetty:::channel::SimpleChannelHandler {
+class HttpContentEncoder : public cetty::channel::SimpleChannelHandler {
 public:
-    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
-        Object msg = e.getMessage();
-        if (!(msg instanceof HttpMessage)) {
-            ctx.sendUpstream(e);
-            return;
-        }
-
-        HttpMessage m = (HttpMessage) msg;
-        std::string acceptedEncoding = m.getHeader(HttpHeaders::Names::ACCEPT_ENCODING);
-        if (acceptedEncoding == null) {
-            acceptedEncoding = HttpHeaders.Values.IDENTITY;
-        }
-        bool offered = acceptEncodingQueue.offer(acceptedEncoding);
-        assert offered;
-
-        ctx.sendUpstream(e);
-    }
-
-    virtual void writeRequested(ChannelHandlerContext& ctx, const MessageEvent& e) {
-
-        Object msg = e.getMessage();
-        if (msg instanceof HttpResponse && ((HttpResponse) msg).getStatus().getCode() == 100) {
-            // 100-continue response must be passed through.
-            ctx.sendDownstream(e);
-        }
-        else  if (msg instanceof HttpMessage) {
-            HttpMessage m = (HttpMessage) msg;
-
-            encoder = null;
-
-            // Determine the content encoding.
-            std::string acceptEncoding = acceptEncodingQueue.poll();
-            if (acceptEncoding == null) {
-                throw new IllegalStateException("cannot send more responses than requests");
-            }
-
-            if ((encoder = newContentEncoder(acceptEncoding)) != null) {
-                // Encode the content and remove or replace the existing headers
-                // so that the message looks like a decoded message.
-                m.setHeader(
-                        HttpHeaders.Names.CONTENT_ENCODING,
-                        getTargetContentEncoding(acceptEncoding));
-
-                if (!m.isChunked()) {
-                    ChannelBuffer content = m.getContent();
-                    // Encode the content.
-                    content = ChannelBuffers.wrappedBuffer(
-                            encode(content), finishEncode());
-
-                    // Replace the content.
-                    m.setContent(content);
-                    if (m.containsHeader(HttpHeaders.Names.CONTENT_LENGTH)) {
-                        m.setHeader(
-                                HttpHeaders.Names.CONTENT_LENGTH,
-                                Integer.toString(content.readableBytes()));
-                    }
-                }
-            }
-
-            // Because HttpMessage is a mutable object, we can simply forward the write request.
-            ctx.sendDownstream(e);
-        }
-        else if (msg instanceof HttpChunk) {
-            HttpChunk c = (HttpChunk) msg;
-            ChannelBuffer content = c.getContent();
-
-            // Encode the chunk if necessary.
-            if (encoder != null) {
-                if (!c.isLast()) {
-                    content = encode(content);
-                    if (content.readable()) {
-                        c.setContent(content);
-                        ctx.sendDownstream(e);
-                    }
-                }
-                else {
-                    ChannelBuffer lastProduct = finishEncode();
-
-                    // Generate an additional chunk if the decoder produced
-                    // the last product on closure,
-                    if (lastProduct.readable()) {
-                        Channels.write(
-                                ctx, Channels.succeededFuture(e.getChannel()), new DefaultHttpChunk(lastProduct), e.getRemoteAddress());
-                    }
-
-                    // Emit the last chunk.
-                    ctx.sendDownstream(e);
-                }
-            }
-            else {
-                ctx.sendDownstream(e);
-            }
-        }
-        else {
-            ctx.sendDownstream(e);
-        }
-    }
+    virtual ~HttpContentEncoder() {}
+
+    /**
+     * Returns the minimum length of the content of a message which is not
+     * chunked to be encoded.
+     */
+    int getContentSizeThreshold() const { return contentSizeThreshold; }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e);
+
+    virtual void writeRequested(ChannelHandlerContext& ctx, const MessageEvent& e);
 
 protected:
     /**
      * Creates a new instance.
+     *
+     * @param contentSizeThreshold
+     *        the minimum length of the content of a message which is not
+     *        chunked to be encoded, <tt>0</tt> to encode any content.
+     *
+     * @throws InvalidArgumentException if the threshold is negative.
      */
-    HttpContentEncoder() {
-    }
+    HttpContentEncoder(int contentSizeThreshold);
 
     /**
-     * Returns a new {@link EncoderEmbedder} that encodes the HTTP message
-     * content.
+     * Returns a new {@link ZlibDeflater} that encodes the HTTP message
+     * content.  The caller takes the ownership of the deflater.
      *
      * @param acceptEncoding
      *        the value of the <tt>"Accept-Encoding"</tt> header
      *
-     * @return a new {@link EncoderEmbedder} if there is a supported encoding
-     *         in <tt>acceptEncoding</tt>.  <tt>null</tt> otherwise.
+     * @return a new {@link ZlibDeflater} if there is a supported encoding
+     *         in <tt>acceptEncoding</tt>.  <tt>NULL</tt> otherwise.
      */
-    virtual EncoderEmbedder<ChannelBuffer> newContentEncoder(const std::string& acceptEncoding) = 0;
+    virtual ZlibDeflater* newContentEncoder(const std::string& acceptEncoding) = 0;
 
     /**
      * Returns the expected content encoding of the encoded content.
@@ -179,26 +115,17 @@ protected:
     virtual std::string getTargetContentEncoding(const std::string& acceptEncoding) = 0;
 
 private:
-    ChannelBuffer encode(ChannelBuffer buf) {
-        encoder.offer(buf);
-        return ChannelBuffers.wrappedBuffer(encoder.pollAll(new ChannelBuffer[encoder.size()]));
-    }
-
-    ChannelBuffer finishEncode() {
-        ChannelBuffer result;
-        if (encoder.finish()) {
-            result = ChannelBuffers.wrappedBuffer(encoder.pollAll(new ChannelBuffer[encoder.size()]));
-        }
-        else {
-            result = ChannelBuffers.EMPTY_BUFFER;
-        }
-        encoder = null;
-        return result;
-    }
+    void encodeMessage(HttpMessage& message, const std::string& acceptEncoding);
 
 private:
-    private final Queue<std::string> acceptEncodingQueue = new LinkedTransferQueue<std::string>();
-    private volatile EncoderEmbedder<ChannelBuffer> encoder;
+    int contentSizeThreshold;
+
+    // the requests are received in the I/O thread, while the responses
+    // may be written in any thread.
+    boost::mutex mutex;
+    std::deque<std::string> acceptEncodings;
+
+    boost::scoped_ptr<ZlibDeflater> encoder;
 };
 
 }}}}
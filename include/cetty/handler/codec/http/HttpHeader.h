@@ -21,8 +21,12 @@
 #include <vector>
 #include <utility>
 
+#include "cetty/buffer/ChannelBuffer.h"
+
 namespace cetty { namespace handler { namespace codec { namespace http { 
 
+using namespace cetty::buffer;
+
 class HttpHeader {
 public:
     typedef std::pair<std::string, std::string> NameValuePair;
@@ -81,6 +85,19 @@ public:
     virtual void add(const std::string& name, const std::string& value) = 0;
     virtual void add(const std::string& name, int value) = 0;
 
+    /**
+     * Adds a new header whose name and value refer to the bytes of the
+     * <tt>buffer</tt> rather than copies of them.  The buffer is retained
+     * until the headers are cleared, so the bytes must not be overwritten
+     * in the meantime, e.g. the buffer is a cumulation or the channel owns
+     * its read buffer.
+     */
+    virtual void add(const ChannelBufferPtr& buffer,
+                     const char* name,
+                     int nameSize,
+                     const char* value,
+                     int valueSize) = 0;
+
     /**
      * Sets a new header with the specified name and value.  If there is an
      * existing header with the same name, the existing header is removed.
@@ -221,6 +221,18 @@ public:
          * <tt>"Retry-After"</tt>
          */
         static const std::string RETRY_AFTER;
+        /**
+         * <tt>"Sec-WebSocket-Accept"</tt>
+         */
+        static const std::string SEC_WEBSOCKET_ACCEPT;
+        /**
+         * <tt>"Sec-WebSocket-Extensions"</tt>
+         */
+        static const std::string SEC_WEBSOCKET_EXTENSIONS;
+        /**
+         * <tt>"Sec-WebSocket-Key"</tt>
+         */
+        static const std::string SEC_WEBSOCKET_KEY;
         /**
          * <tt>"Sec-WebSocket-Key1"</tt>
          */
@@ -241,6 +253,10 @@ public:
          * <tt>"Sec-WebSocket-Protocol"</tt>
          */
         static const std::string SEC_WEBSOCKET_PROTOCOL;
+        /**
+         * <tt>"Sec-WebSocket-Version"</tt>
+         */
+        static const std::string SEC_WEBSOCKET_VERSION;
         /**
          * <tt>"Server"</tt>
          */
@@ -21,19 +21,18 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
-#include <vector>
+#include <string>
 
 #include "cetty/handler/codec/http/HttpMessage.h"
 #include "cetty/handler/codec/http/HttpChunkTrailer.h"
-#include "cetty/handler/codec/replay/ReplayingDecoderBuffer.h"
-#include "cetty/handler/codec/replay/ReplayingDecoder.h"
+#include "cetty/handler/codec/frame/FrameDecoder.h"
 
 namespace cetty { namespace handler { namespace codec { namespace http { 
 
 class HttpMessage;
 
 using namespace cetty::channel;
-using namespace cetty::handler::codec::replay;
+using namespace cetty::handler::codec::frame;
 
 /**
  * Decodes {@link ChannelBuffer}s into {@link HttpMessage}s and
@@ -98,6 +97,19 @@ using namespace cetty::handler::codec::replay;
  * {@link ChannelPipeline}.  However, please note that your server might not
  * be as memory efficient as without the aggregator.
  *
+ * <h3>Incremental parsing</h3>
+ *
+ * The decoder keeps its position across the received packets: a complete
+ * line is parsed and consumed as soon as it is received, and the scan for
+ * the end of an incomplete line resumes where the last scan stopped, so a
+ * header block received in many small packets is scanned only once.  The
+ * lines are located with the vectorized {@link ChannelBuffer#indexOf}, and
+ * parsed in place unless a line spans two received packets.  The content
+ * and the chunks are slices of the received buffers when the channel owns
+ * them (see {@link FrameDecoder}), and so are the header names and values,
+ * which are added by {@link HttpHeader#add(const ChannelBufferPtr&, const char*, int, const char*, int)}
+ * without copying unless a header is continued on the next line.
+ *
  * <h3>Extensibility</h3>
  *
  * Please note that this decoder is designed to be extended to implement
@@ -115,8 +127,7 @@ using namespace cetty::handler::codec::replay;
  * @apiviz.landmark
  */
 
-class HttpMessageDecoder
-    : public cetty::handler::codec::replay::ReplayingDecoder {
+class HttpMessageDecoder : public cetty::handler::codec::frame::FrameDecoder {
 private:
    /**
     * The internal state of {@link HttpMessageDecoder}.
@@ -143,26 +154,21 @@ private:
         READ_CHUNK_FOOTER
     };
 
+    /**
+     * A reference to the bytes of a line, which are not owned.
+     */
     class FastString {
     public:
         FastString() : data(NULL), size(0) {}
-        FastString(char* data, int size) : data(data), size(size) {}
+        FastString(const char* data, int size) : data(data), size(size) {}
 
         inline void clear() { data = NULL; size = 0; }
         inline bool empty() const { return size == 0; }
         inline int  length() const { return size; }
 
-        inline operator char*() { return data; }
-        
-        inline char* c_str() { return data; }
-        inline const char* c_str() const { return data; }
-
         inline char operator[](int index) const {
             return data[index];
         }
-        inline char& operator[](int index) {
-            return data[index];
-        }
         inline char at(int index) const {
             BOOST_ASSERT(index < size);
             return data[index];
@@ -173,7 +179,11 @@ private:
         FastString trim() const;
         bool equalsIgnoreCase(const std::string& str) const;
 
-        char* data;
+        void appendTo(std::string& str) const {
+            str.append(data, size);
+        }
+
+        const char* data;
         int   size;
     };
 
@@ -185,11 +195,6 @@ protected:
      * Creates a new instance with the default
      * <tt>maxInitialLineLength (4096)</tt>, <tt>maxHeaderSize (8192)</tt>, and
      * <tt>maxChunkSize (8192)</tt>.
-     *
-     * if channel buffer size < (maxInitialLineLength + maxHeaderSize + maxChunkSize),
-     * may cause some memory copy.
-     * if < (maxInitialLineLength + maxHeaderSize) may cause some memory allocation.
-     *
      */
     HttpMessageDecoder();
 
@@ -202,10 +207,13 @@ protected:
 protected:
     virtual ChannelMessage decode(ChannelHandlerContext& ctx,
                                   Channel& channel,
-                                  const ReplayingDecoderBufferPtr& buffer,
-                                  int state);
+                                  const ChannelBufferPtr& buffer);
+
+    virtual ChannelMessage decodeLast(ChannelHandlerContext& ctx,
+                                      Channel& channel,
+                                      const ChannelBufferPtr& buffer);
 
-    bool isContentAlwaysEmpty(const HttpMessage& msg) const;
+    virtual bool isContentAlwaysEmpty(const HttpMessage& msg) const;
 
 protected:
     virtual bool isDecodingRequest() const = 0;
@@ -217,43 +225,93 @@ protected:
 private:
     ChannelMessage reset();
 
-    bool skipControlCharacters(const ReplayingDecoderBufferPtr& buffer) const;
-    bool readFixedLengthContent(const ReplayingDecoderBufferPtr& buffer);
+    bool skipControlCharacters(const ChannelBufferPtr& buffer) const;
 
     //throws TooLongFrameException
-    int readHeaders(const ReplayingDecoderBufferPtr& buffer);
+    bool readInitialLine(const ChannelBufferPtr& buffer);
+
+    /**
+     * @return the next state, or <tt>READ_HEADER</tt> if more bytes are needed.
+     */
+    //throws TooLongFrameException
+    int readHeaders(const ChannelBufferPtr& buffer);
 
+    /**
+     * @return true if the last line of the trailer has been read.
+     */
     //throws TooLongFrameException
-    HttpChunkTrailerPtr readTrailingHeaders(const ReplayingDecoderBufferPtr& buffer);
+    bool readTrailingHeaders(const ChannelBufferPtr& buffer);
+
+    /**
+     * Reads a line, without the line terminator, into <tt>line</tt>.
+     * The scan for the line terminator resumes where the last call stopped.
+     * The line refers to the received bytes, or to the <tt>lineBuffer</tt>
+     * if it spans two packets, so it is valid until the next read.
+     *
+     * @return false if the line is not complete yet.
+     */
+    bool readLine(const ChannelBufferPtr& buffer, FastString& line);
 
-    //throws TooLongFrameException 
-    FastString readHeader(const ReplayingDecoderBufferPtr& buffer);
+    //throws TooLongFrameException
+    bool readLine(const ChannelBufferPtr& buffer,
+                  int maxLineLength,
+                  FastString& line);
 
     //throws TooLongFrameException
-    FastString readLine(const ReplayingDecoderBufferPtr& buffer, int maxLineLength);
+    bool readHeaderLine(const ChannelBufferPtr& buffer, FastString& line);
+
+    bool hasHeader() const { return headerBuffer || !headerName.empty(); }
+
+    void setHeader(const ChannelBufferPtr& buffer,
+                   const FastString& line,
+                   bool referable);
+    void appendHeaderValue(const FastString& line);
+
+    void flushHeader();
+    void flushTrailingHeader();
 
     int getChunkSize(const FastString& hex) const;
 
     /**
-     * @return true can read out a line completely. false means need to read more bytes.
+     * @return the count of the parts, 3 for a valid initial line.
      */
-    bool splitInitialLine(FastString& sb, std::vector<FastString>& lines);
-    void splitHeader(FastString& sb, std::vector<FastString>& header);
+    int splitInitialLine(char* line, int length, const char* parts[3]);
+    void splitHeader(const FastString& sb, FastString& name, FastString& value);
 
     int findNonWhitespace(const FastString& sb, int offset);
     int findWhitespace(const FastString& sb, int offset);
     int findEndOfString(const FastString& sb);
 
+    ChannelBufferPtr readContent(const ChannelBufferPtr& buffer, int length);
+
 protected:
     int maxInitialLineLength;
     int maxHeaderSize;
     int maxChunkSize;
     
 private:
+    int  state;
     int  chunkSize;
     int  headerSize;
+
+    // the bytes of the current line which have been scanned.
+    int  lineScanned;
+
     HttpMessagePtr message;
+    HttpChunkTrailerPtr trailer;
     ChannelBufferPtr content;
+
+    // the line which spans the received packets, and the header which may
+    // be continued on the next line.
+    std::string lineBuffer;
+    std::string headerName;
+    std::string headerValue;
+
+    // the header which refers to the bytes of the retained headerBuffer,
+    // instead of the headerName and headerValue.
+    ChannelBufferPtr headerBuffer;
+    FastString headerNameRef;
+    FastString headerValueRef;
 };
 
 }}}}
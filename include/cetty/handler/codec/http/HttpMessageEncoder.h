@@ -37,6 +37,21 @@ class HttpMessage;
  * Encodes an {@link HttpMessage} or an {@link HttpChunk} into
  * a {@link ChannelBuffer}.
  *
+ * <h3>Sending a file</h3>
+ *
+ * A {@link FileRegionPtr} passes through this encoder without being copied
+ * into a buffer, so the transport can send it with zero-copy.  Write the
+ * message with an empty content and the <tt>Content-Length</tt> of the
+ * region first, then write the region itself:
+ * <pre>
+ * FileRegionPtr region(new DefaultFileRegion("index.html"));
+ * HttpHeaders::setContentLength(*response, region->getCount());
+ * channel.write(ChannelMessage(response));
+ * channel.write(ChannelMessage(region));
+ * </pre>
+ * If the message is <tt>Transfer-Encoding: chunked</tt>, the region is sent
+ * as a single chunk.
+ *
  * <h3>Extensibility</h3>
  *
  * Please note that this encoder is designed to be extended to implement
@@ -59,11 +74,17 @@ class HttpMessageEncoder
 public:
     virtual ~HttpMessageEncoder() {}
 
+    /**
+     * drops an empty {@link FileRegion} of a chunked message, and completes
+     * the future of its write with success, as nothing has to be written.
+     */
+    virtual void writeRequested(ChannelHandlerContext& ctx, const MessageEvent& e);
+
 protected:
     /**
      * Creates a new instance.
      */
-    HttpMessageEncoder() {}
+    HttpMessageEncoder() : chunked(false) {}
 
     virtual ChannelMessage encode(ChannelHandlerContext& ctx,
                                   Channel& channel,
@@ -24,6 +24,8 @@
  *
  */
 
+#include <string>
+
 namespace cetty { namespace handler { namespace codec { namespace http { 
 
 /**
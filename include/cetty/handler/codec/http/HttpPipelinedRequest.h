@@ -0,0 +1,82 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPPIPELINEDREQUEST_H)
+#define CETTY_HANDLER_CODEC_HTTP_HTTPPIPELINEDREQUEST_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/util/ReferenceCounter.h"
+#include "cetty/handler/codec/http/HttpMessage.h"
+#include "cetty/handler/codec/http/HttpPipelinedResponse.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http {
+
+/**
+ * A decoded {@link HttpRequest} tagged with its sequence number on the
+ * connection by the {@link HttpPipeliningHandler}.  The following
+ * {@link HttpChunk}s of a chunked request are received as is.
+ * <p>
+ * The handler answers the request by writing what {@link #respond} returns,
+ * in any order against the other requests:
+ * <pre>
+ * HttpPipelinedRequestPtr request =
+ *     e.getMessage().smartPointer&lt;HttpPipelinedRequest&gt;();
+ * HttpResponsePtr response(new DefaultHttpResponse(...));
+ * ...
+ * e.getChannel().write(ChannelMessage(request->respond(response)));
+ * </pre>
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class HttpPipelinedRequest : public cetty::util::ReferenceCounter<HttpPipelinedRequest> {
+public:
+    HttpPipelinedRequest(int sequence, const HttpMessagePtr& request)
+        : sequence(sequence), request(request) {
+    }
+
+    virtual ~HttpPipelinedRequest() {}
+
+    int getSequence() const { return sequence; }
+
+    /**
+     * Returns the decoded request, which is an {@link HttpRequest}.
+     */
+    const HttpMessagePtr& getRequest() const { return request; }
+
+    /**
+     * Returns the response to write for this request.  A chunked response
+     * is finished by responding its 'end of content' chunk.
+     */
+    HttpPipelinedResponsePtr respond(const HttpResponsePtr& response) const {
+        return HttpPipelinedResponsePtr(
+                   new HttpPipelinedResponse(sequence, response));
+    }
+
+    HttpPipelinedResponsePtr respond(const HttpChunkPtr& chunk) const {
+        return HttpPipelinedResponsePtr(
+                   new HttpPipelinedResponse(sequence, chunk));
+    }
+
+private:
+    int sequence;
+    HttpMessagePtr request;
+};
+
+typedef boost::intrusive_ptr<HttpPipelinedRequest> HttpPipelinedRequestPtr;
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPPIPELINEDREQUEST_H)
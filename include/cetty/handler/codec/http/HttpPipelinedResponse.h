@@ -0,0 +1,81 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPPIPELINEDRESPONSE_H)
+#define CETTY_HANDLER_CODEC_HTTP_HTTPPIPELINEDRESPONSE_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/util/ReferenceCounter.h"
+#include "cetty/handler/codec/http/HttpChunk.h"
+#include "cetty/handler/codec/http/HttpResponse.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http {
+
+using namespace cetty::channel;
+
+/**
+ * An {@link HttpResponse} or one of its following {@link HttpChunk}s which
+ * answers an {@link HttpPipelinedRequest}.  Create it by
+ * {@link HttpPipelinedRequest#respond(const HttpResponsePtr&)} and write it
+ * to the {@link Channel}, so the {@link HttpPipeliningHandler} can write it
+ * in the order of the requests.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class HttpPipelinedResponse : public cetty::util::ReferenceCounter<HttpPipelinedResponse> {
+public:
+    HttpPipelinedResponse(int sequence, const HttpResponsePtr& response)
+        : sequence(sequence),
+          last(!response->isChunked()),
+          message(response) {
+    }
+
+    HttpPipelinedResponse(int sequence, const HttpChunkPtr& chunk)
+        : sequence(sequence),
+          last(chunk->isLast()),
+          message(chunk) {
+    }
+
+    virtual ~HttpPipelinedResponse() {}
+
+    /**
+     * Returns the sequence number of the request which this response answers.
+     */
+    int getSequence() const { return sequence; }
+
+    /**
+     * Returns <tt>true</tt> if this is the last part of the response, that
+     * is a response which is not chunked or the 'end of content' chunk.
+     */
+    bool isLast() const { return last; }
+
+    /**
+     * Returns the {@link HttpResponse} or {@link HttpChunk} to write.
+     */
+    const ChannelMessage& getMessage() const { return message; }
+
+private:
+    int sequence;
+    bool last;
+    ChannelMessage message;
+};
+
+typedef boost::intrusive_ptr<HttpPipelinedResponse> HttpPipelinedResponsePtr;
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPPIPELINEDRESPONSE_H)
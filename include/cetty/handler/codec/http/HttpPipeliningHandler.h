@@ -0,0 +1,164 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPPIPELININGHANDLER_H)
+#define CETTY_HANDLER_CODEC_HTTP_HTTPPIPELININGHANDLER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <map>
+#include <deque>
+#include <boost/thread/recursive_mutex.hpp>
+
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/SimpleChannelHandler.h"
+#include "cetty/handler/codec/http/HttpPipelinedRequest.h"
+#include "cetty/handler/codec/http/HttpPipelinedResponse.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http {
+
+using namespace cetty::channel;
+
+/**
+ * A {@link ChannelHandler} which supports HTTP/1.1 pipelining, that is a
+ * client sends several requests without waiting for their responses, and
+ * the responses must be sent back in the order of the requests.
+ * <p>
+ * Each decoded request is received as an {@link HttpPipelinedRequest} with
+ * its sequence number, and the handler may answer the requests in any order
+ * by writing the {@link HttpPipelinedResponse}s created from them.  The
+ * response of the oldest request is written at once, and the responses of
+ * the later requests are kept until all the responses before them have been
+ * written, then written back to back, so the {@link Channel} gathers them
+ * into as few writes as it can.
+ * <p>
+ * At most <tt>maxOutstandingRequests</tt> requests are waiting for their
+ * responses.  The later requests are kept in this handler, and the reading
+ * of the {@link Channel} is suspended until the earlier requests have been
+ * answered.
+ * <p>
+ * Insert this handler after the codec and before the handler which answers
+ * the requests:
+ * <pre>
+ * {@link ChannelPipeline} p = ...;
+ * ...
+ * p.addLast("codec", new {@link HttpServerCodec}());
+ * p.addLast("aggregator", new {@link HttpChunkAggregator}(1048576));
+ * p.addLast("pipelining", <b>new {@link HttpPipeliningHandler}(16)</b>);
+ * p.addLast("handler", new HttpRequestHandler());
+ * </pre>
+ * This handler keeps the state of one connection.  The requests are
+ * received in the I/O thread of the channel, while the responses may be
+ * written from any thread, e.g. the workers of an {@link ExecutionHandler}.
+ * The sequences and the responses written before their turn are shared by
+ * both and guarded by a lock, and the suspended requests are only resumed
+ * in the I/O thread, by a task executed in the
+ * {@link Channel#getEventLoop() event loop} of the channel.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class HttpPipeliningHandler : public cetty::channel::SimpleChannelHandler {
+public:
+    static const int DEFAULT_MAX_OUTSTANDING_REQUESTS = 16;
+
+public:
+    /**
+     * Creates a new instance with <tt>maxOutstandingRequests (16)</tt>.
+     */
+    HttpPipeliningHandler();
+
+    /**
+     * Creates a new instance.
+     *
+     * @param maxOutstandingRequests
+     *        the maximum number of the requests which are waiting for their
+     *        responses.
+     *
+     * @throws InvalidArgumentException
+     *         if <tt>maxOutstandingRequests</tt> is not positive.
+     */
+    HttpPipeliningHandler(int maxOutstandingRequests);
+
+    virtual ~HttpPipeliningHandler() {}
+
+    virtual ChannelHandlerPtr clone();
+    virtual std::string toString() const;
+
+    /**
+     * Returns the number of the requests which are waiting for their
+     * responses.
+     */
+    int getOutstandingRequests() const;
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e);
+    virtual void channelClosed(ChannelHandlerContext& ctx, const ChannelStateEvent& e);
+
+    virtual void writeRequested(ChannelHandlerContext& ctx, const MessageEvent& e);
+
+private:
+    struct PendingWrite {
+        PendingWrite(const ChannelMessage& message,
+                     const ChannelFuturePtr& future,
+                     bool last)
+            : message(message), future(future), last(last) {
+        }
+
+        ChannelMessage   message;
+        ChannelFuturePtr future;
+        bool             last;
+    };
+
+    typedef std::deque<PendingWrite> PendingWrites;
+    typedef std::map<int, PendingWrites> PendingResponses;
+
+private:
+    bool suspendRequests();
+
+    void forwardRequest(ChannelHandlerContext& ctx, const ChannelMessage& message);
+
+    void completeResponse(ChannelHandlerContext& ctx);
+    void flushResponses(ChannelHandlerContext& ctx);
+    void scheduleResume(ChannelHandlerContext& ctx);
+    void resumeRequests(ChannelHandlerContext& ctx);
+
+private:
+    int maxOutstandingRequests;
+
+    // guards the state below, up to the pending responses, which is shared
+    // by the I/O thread and the threads writing the responses.
+    mutable boost::recursive_mutex mutex;
+
+    int outstandingRequests;
+
+    int nextRequestSequence;
+    int nextWriteSequence;
+
+    // the requests are suspended, and need resuming once a response is done.
+    bool suspended;
+
+    // the responses which are written before their turn, by sequence.
+    PendingResponses pendingResponses;
+
+    // only used in the I/O thread.
+    bool resuming;
+
+    // the requests (and their chunks) which exceed the limit.
+    std::deque<ChannelMessage> suspendedRequests;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPPIPELININGHANDLER_H)
@@ -105,7 +105,9 @@ protected:
                                          const char* str3) {
         BOOST_ASSERT(str1 && str2 && str3 
                   && "createMessage parameters should not be NULL");
-        if (!request) { //has not initial ready.
+        // a request which is still referenced, e.g. waiting for its
+        // pipelined response, can not be reused.
+        if (!request || request->refcount() > 1) {
             request = DefaultHttpRequestPtr(
                 new DefaultHttpRequest(HttpVersion::valueOf(str3),
                                        HttpMethod::valueOf(str1),
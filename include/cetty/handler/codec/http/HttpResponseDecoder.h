@@ -101,8 +101,8 @@ public:
      * <tt>maxChunkSize (8192)</tt>.
      */
     HttpResponseDecoder()
-        : response(new DefaultHttpResponse),
-          HttpMessageDecoder(4096, 8192, 8192) {
+        : HttpMessageDecoder(4096, 8192, 8192),
+          response(new DefaultHttpResponse) {
     }
 
     /**
@@ -110,10 +110,10 @@ public:
      */
     HttpResponseDecoder(
             int maxInitialLineLength, int maxHeaderSize, int maxChunkSize)
-            : response(new DefaultHttpResponse),
-              HttpMessageDecoder(maxInitialLineLength,
+            : HttpMessageDecoder(maxInitialLineLength,
                                  maxHeaderSize,
-                                 maxChunkSize) {
+                                 maxChunkSize),
+              response(new DefaultHttpResponse) {
     }
 
     virtual ~HttpResponseDecoder() {}
@@ -133,6 +133,11 @@ protected:
     virtual HttpMessagePtr createMessage(const char* str1,
                                          const char* str2,
                                          const char* str3) {
+        // a response which is still referenced can not be reused.
+        if (response->refcount() > 1) {
+            response = DefaultHttpResponsePtr(new DefaultHttpResponse);
+        }
+
         response->clear();
         response->setProtocolVersion(HttpVersion::valueOf(str1));
         response->setStatus(HttpResponseStatus(Integer::parse(str2), str3));
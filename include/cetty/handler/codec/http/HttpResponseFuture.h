@@ -0,0 +1,113 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPRESPONSEFUTURE_H)
+#define CETTY_HANDLER_CODEC_HTTP_HTTPRESPONSEFUTURE_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "cetty/util/Exception.h"
+#include "cetty/util/ReferenceCounter.h"
+#include "cetty/handler/codec/http/HttpResponse.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http {
+
+using namespace cetty::util;
+
+class HttpResponseFuture;
+typedef boost::intrusive_ptr<HttpResponseFuture> HttpResponseFuturePtr;
+
+/**
+ * The result of an asynchronous HTTP request, such as the one sent by an
+ * {@link HttpConnectionPool}.  It is done when the whole response has been
+ * received, or the request has failed because of the connection.
+ * <p>
+ * As {@link ChannelFuture}, prefer {@link #setListener} to the
+ * <tt>await*()</tt> methods, which must not be called in an I/O thread.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class HttpResponseFuture : public cetty::util::ReferenceCounter<HttpResponseFuture> {
+public:
+    typedef boost::function1<void, const HttpResponseFuturePtr&> ListenerFunction;
+
+public:
+    HttpResponseFuture();
+    virtual ~HttpResponseFuture();
+
+    bool isDone() const;
+
+    /**
+     * Returns <tt>true</tt> if and only if the response has been received.
+     */
+    bool isSuccess() const;
+
+    /**
+     * Returns the received response, or an empty pointer if the request
+     * is not done or has failed.
+     */
+    HttpResponsePtr getResponse() const;
+
+    /**
+     * Returns the cause of the failure, or <tt>NULL</tt> if the request
+     * is not done or has succeeded.
+     */
+    const Exception* getCause() const;
+
+    /**
+     * Sets the listener which is notified when the request is done.  It
+     * is notified immediately if the request is already done.
+     */
+    void setListener(const ListenerFunction& listener);
+
+    HttpResponseFuture& awaitUninterruptibly();
+    bool awaitUninterruptibly(boost::int64_t timeoutMillis);
+
+    /**
+     * Marks the request as succeeded with the <tt>response</tt> and
+     * notifies the listener.
+     *
+     * @return <tt>true</tt> if and only if successfully marked this future
+     *         as a success.  Otherwise <tt>false</tt> because this future is
+     *         already marked as either a success or a failure.
+     */
+    bool setResponse(const HttpResponsePtr& response);
+
+    /**
+     * Marks the request as failed and notifies the listener.
+     */
+    bool setFailure(const Exception& cause);
+
+private:
+    void notifyListener();
+
+private:
+    bool done;
+    HttpResponsePtr response;
+    Exception* cause;
+    ListenerFunction listener;
+
+    mutable boost::mutex mutex;
+    boost::condition_variable cond;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_HTTPRESPONSEFUTURE_H)
@@ -57,6 +57,11 @@ public:
         : decoder(maxInitialLineLength, maxHeaderSize, maxChunkSize) {
     }
 
+    /**
+     * Returns the request decoder of this codec.
+     */
+    HttpRequestDecoder& getDecoder() { return decoder; }
+
     void handleUpstream(ChannelHandlerContext& ctx, const ChannelEvent& e) {
         decoder.handleUpstream(ctx, e);
     }
@@ -0,0 +1,100 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKET13FRAMEDECODER_H)
+#define CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKET13FRAMEDECODER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/frame/FrameDecoder.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::channel;
+using namespace cetty::buffer;
+using namespace cetty::handler::codec::frame;
+
+/**
+ * Decodes the {@link ChannelBuffer}s into the {@link WebSocketFrame}s of
+ * <a href="http://tools.ietf.org/html/rfc6455">RFC 6455</a>, the version
+ * <tt>13</tt> of the Web Socket protocol.
+ * <p>
+ * The fragments and the control frames are passed on as they are received,
+ * with the payload unmasked.  The payload is a slice of the received bytes
+ * whenever {@link FrameDecoder#extractFrame} can slice it, and it is unmasked
+ * in place, so a frame is neither copied nor allocated.
+ * <p>
+ * When the peer violates the protocol, a close frame with the status code
+ * <tt>1002</tt> (or <tt>1009</tt> for a too long frame) is sent, the channel
+ * is closed, and a {@link CorruptedFrameException} (or a
+ * {@link TooLongFrameException}) is raised.  The bytes following a close
+ * frame are discarded.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class WebSocket13FrameDecoder : public FrameDecoder {
+public:
+    static const int DEFAULT_MAX_FRAME_PAYLOAD_LENGTH = 1024 * 1024;
+
+public:
+    /**
+     * Creates a decoder of a server, which expects masked frames and allows
+     * no extension.
+     */
+    WebSocket13FrameDecoder();
+
+    /**
+     * @param expectMaskedFrames
+     *        <tt>true</tt> for a server, which receives the masked frames of
+     *        a client, <tt>false</tt> for a client.
+     * @param allowExtensions
+     *        <tt>true</tt> if the reserved bits may be set by an extension,
+     *        e.g. the <tt>permessage-deflate</tt> one.
+     * @param maxFramePayloadLength
+     *        the maximum length of the payload of a frame.
+     */
+    WebSocket13FrameDecoder(bool expectMaskedFrames,
+                            bool allowExtensions,
+                            int maxFramePayloadLength);
+
+    virtual ~WebSocket13FrameDecoder() {}
+
+    virtual ChannelHandlerPtr clone();
+    virtual std::string toString() const { return "WebSocket13FrameDecoder"; }
+
+protected:
+    virtual ChannelMessage decode(ChannelHandlerContext& ctx,
+                                  Channel& channel,
+                                  const ChannelBufferPtr& buffer);
+
+private:
+    void protocolViolation(Channel& channel,
+                           const ChannelBufferPtr& buffer,
+                           int statusCode,
+                           const std::string& reason);
+
+private:
+    bool expectMaskedFrames;
+    bool allowExtensions;
+    int  maxFramePayloadLength;
+
+    // the opcode of the fragmented message being received, or -1.
+    int  fragmentedOpcode;
+    bool receivedClosingHandshake;
+};
+
+}}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKET13FRAMEDECODER_H)
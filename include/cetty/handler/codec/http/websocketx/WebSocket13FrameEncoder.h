@@ -0,0 +1,77 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKET13FRAMEENCODER_H)
+#define CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKET13FRAMEENCODER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/oneone/OneToOneEncoder.h"
+#include "cetty/util/Random.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::channel;
+
+/**
+ * Encodes a {@link WebSocketFrame} into the frame of
+ * <a href="http://tools.ietf.org/html/rfc6455">RFC 6455</a>.
+ * <p>
+ * A server sends the payload unmasked, so the encoded frame is the header
+ * followed by the payload buffer of the frame as it is, without a copy, and
+ * the same frame may be written to many channels.  A client masks the
+ * payload with a random key into a new buffer.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class WebSocket13FrameEncoder : public cetty::handler::codec::oneone::OneToOneEncoder {
+public:
+    /**
+     * @param maskPayload <tt>true</tt> for a client, which masks the payload.
+     */
+    explicit WebSocket13FrameEncoder(bool maskPayload = false)
+        : maskPayload(maskPayload) {}
+
+    virtual ~WebSocket13FrameEncoder() {}
+
+    virtual ChannelHandlerPtr clone();
+    virtual std::string toString() const { return "WebSocket13FrameEncoder"; }
+
+    /**
+     * Encodes the {@link WebSocketFrame} unmasked as a server sends it, and
+     * returns the other messages as they are.  It encodes a frame once for
+     * all the channels of a {@link ChannelGroup}:
+     *
+     * <pre>
+     * group.write(ChannelMessage(frame), WebSocket13FrameEncoder::encodeFrame);
+     * </pre>
+     *
+     * the encoded frame passes through the encoders of the channels.
+     */
+    static ChannelMessage encodeFrame(const ChannelMessage& msg);
+
+protected:
+    virtual ChannelMessage encode(ChannelHandlerContext& ctx,
+                                  Channel& channel,
+                                  const ChannelMessage& msg);
+
+private:
+    bool maskPayload;
+    cetty::util::Random random;
+};
+
+}}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKET13FRAMEENCODER_H)
@@ -0,0 +1,139 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETFRAME_H)
+#define CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETFRAME_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/util/ReferenceCounter.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketFrameType.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::buffer;
+
+class WebSocketFrame;
+typedef boost::intrusive_ptr<WebSocketFrame> WebSocketFramePtr;
+
+/**
+ * A Web Socket frame of <a href="http://tools.ietf.org/html/rfc6455">RFC 6455</a>.
+ * <p>
+ * A message is sent either in a single final {@link WebSocketFrameType#TEXT}
+ * or {@link WebSocketFrameType#BINARY} frame, or in a non-final one followed
+ * by {@link WebSocketFrameType#CONTINUATION} frames, the last of which is
+ * final.  The control frames may be injected between the fragments.
+ * <p>
+ * The data is never masked: the decoder unmasks the received frames and the
+ * encoder masks the frames it sends if it is a client.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class WebSocketFrame : public cetty::util::ReferenceCounter<WebSocketFrame> {
+public:
+    /**
+     * The reserved bit which marks the first frame of a compressed message
+     * (<tt>RSV1</tt>), see {@link WebSocketPerMessageDeflateEncoder}.
+     */
+    static const int RSV1 = 0x04;
+
+    /**
+     * Normal closure status code.
+     */
+    static const int NORMAL_CLOSURE = 1000;
+
+    /**
+     * The status code of a close frame which has none.
+     */
+    static const int NO_STATUS_CODE = -1;
+
+public:
+    /**
+     * Creates a final frame with no reserved bits set.
+     */
+    WebSocketFrame(const WebSocketFrameType& type, const ChannelBufferPtr& binaryData);
+
+    WebSocketFrame(const WebSocketFrameType& type,
+                   bool finalFragment,
+                   int rsv,
+                   const ChannelBufferPtr& binaryData);
+
+    /**
+     * Creates a final {@link WebSocketFrameType#TEXT} frame.
+     */
+    explicit WebSocketFrame(const std::string& text);
+
+    virtual ~WebSocketFrame() {}
+
+    /**
+     * Creates a {@link WebSocketFrameType#CLOSE} frame with the status code
+     * and the reason, which is empty if <tt>statusCode</tt> is
+     * {@link #NO_STATUS_CODE}.
+     */
+    static WebSocketFramePtr createCloseFrame(int statusCode, const std::string& reasonText);
+
+    const WebSocketFrameType& getType() const { return type; }
+
+    bool isText() const { return type == WebSocketFrameType::TEXT; }
+    bool isBinary() const { return type == WebSocketFrameType::BINARY; }
+    bool isControl() const { return type.isControl(); }
+
+    /**
+     * Returns <tt>true</tt> if this is the last fragment of a message.
+     */
+    bool isFinalFragment() const { return finalFragment; }
+    void setFinalFragment(bool finalFragment) { this->finalFragment = finalFragment; }
+
+    /**
+     * Returns the 3 reserved bits, <tt>RSV1</tt> being the most significant.
+     */
+    int getRsv() const { return rsv; }
+    void setRsv(int rsv) { this->rsv = rsv & 0x07; }
+
+    /**
+     * Returns the (unmasked) payload of this frame.
+     */
+    const ChannelBufferPtr& getBinaryData() const { return binaryData; }
+    void setBinaryData(const ChannelBufferPtr& binaryData);
+
+    /**
+     * Returns the payload as a UTF-8 string.
+     */
+    std::string getTextData() const;
+
+    /**
+     * Returns the status code of a close frame, or {@link #NO_STATUS_CODE}.
+     */
+    int getCloseStatusCode() const;
+
+    /**
+     * Returns the reason of a close frame, which follows the status code.
+     */
+    std::string getCloseReasonText() const;
+
+    std::string toString() const;
+
+private:
+    WebSocketFrameType type;
+    bool finalFragment;
+    int rsv;
+    ChannelBufferPtr binaryData;
+};
+
+}}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETFRAME_H)
@@ -0,0 +1,73 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETFRAMETYPE_H)
+#define CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETFRAMETYPE_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include "cetty/util/Enum.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+/**
+ * The opcode of a Web Socket frame, as specified in
+ * <a href="http://tools.ietf.org/html/rfc6455#section-5.2">RFC 6455</a>.
+ * The value of each type is its opcode.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class WebSocketFrameType : public cetty::util::Enum<WebSocketFrameType> {
+public:
+    /**
+     * A fragment of a message which was started by a text or binary frame.
+     */
+    static const WebSocketFrameType CONTINUATION;
+
+    static const WebSocketFrameType TEXT;
+    static const WebSocketFrameType BINARY;
+
+    static const WebSocketFrameType CLOSE;
+    static const WebSocketFrameType PING;
+    static const WebSocketFrameType PONG;
+
+    /**
+     * Returns the type of the specified <tt>opcode</tt>.
+     *
+     * @throws InvalidArgumentException if the opcode is reserved.
+     */
+    static const WebSocketFrameType& valueOf(int opcode);
+
+    /**
+     * Returns <tt>true</tt> if the <tt>opcode</tt> is not reserved.
+     */
+    static bool isDefined(int opcode);
+
+    /**
+     * Returns <tt>true</tt> if this is a control frame type, i.e.
+     * {@link #CLOSE}, {@link #PING} or {@link #PONG}.
+     */
+    bool isControl() const { return (m_value & 0x08) != 0; }
+
+    std::string toString() const;
+
+private:
+    WebSocketFrameType(int value) : cetty::util::Enum<WebSocketFrameType>(value) {}
+};
+
+}}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETFRAMETYPE_H)
@@ -0,0 +1,72 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETPERMESSAGEDEFLATEDECODER_H)
+#define CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETPERMESSAGEDEFLATEDECODER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <boost/scoped_ptr.hpp>
+#include "cetty/handler/codec/oneone/OneToOneDecoder.h"
+#include "cetty/handler/codec/compression/ZlibInflater.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::channel;
+using namespace cetty::handler::codec::compression;
+
+/**
+ * Decompresses the messages received as {@link WebSocketFrame}s with the
+ * <tt>permessage-deflate</tt> extension of
+ * <a href="http://tools.ietf.org/html/rfc7692">RFC 7692</a>.
+ * <p>
+ * A message is compressed if its first frame has the <tt>RSV1</tt> bit set,
+ * then each of its frames is inflated, and the
+ * <tt>0x00 0x00 0xFF 0xFF</tt> trailer stripped by the peer is inflated
+ * after the last one.  The other frames are passed through.
+ * <p>
+ * With <tt>noContextTakeover</tt> (<tt>client_no_context_takeover</tt> for
+ * a server), the inflater is dropped at the end of each message, so its
+ * zlib stream goes back to the {@link ZlibStreamPool} of the I/O thread.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class WebSocketPerMessageDeflateDecoder
+        : public cetty::handler::codec::oneone::OneToOneDecoder {
+public:
+    explicit WebSocketPerMessageDeflateDecoder(bool noContextTakeover = false)
+        : noContextTakeover(noContextTakeover), decompressing(false) {}
+
+    virtual ~WebSocketPerMessageDeflateDecoder() {}
+
+    virtual ChannelHandlerPtr clone();
+    virtual std::string toString() const { return "WebSocketPerMessageDeflateDecoder"; }
+
+protected:
+    virtual ChannelMessage decode(ChannelHandlerContext& ctx,
+                                  Channel& channel,
+                                  const ChannelMessage& msg);
+
+private:
+    bool noContextTakeover;
+
+    // whether the message being received is compressed.
+    bool decompressing;
+    boost::scoped_ptr<ZlibInflater> inflater;
+};
+
+}}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETPERMESSAGEDEFLATEDECODER_H)
@@ -0,0 +1,79 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETPERMESSAGEDEFLATEENCODER_H)
+#define CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETPERMESSAGEDEFLATEENCODER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <boost/scoped_ptr.hpp>
+#include "cetty/handler/codec/oneone/OneToOneEncoder.h"
+#include "cetty/handler/codec/compression/ZlibDeflater.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::channel;
+using namespace cetty::handler::codec::compression;
+
+/**
+ * Compresses the messages sent as {@link WebSocketFrame}s with the
+ * <tt>permessage-deflate</tt> extension of
+ * <a href="http://tools.ietf.org/html/rfc7692">RFC 7692</a>.
+ * <p>
+ * Each data frame is deflated and sync flushed, the first frame of a
+ * message has the <tt>RSV1</tt> bit set, and the <tt>0x00 0x00 0xFF 0xFF</tt>
+ * trailer of the flush is stripped from the last one.  The control frames
+ * are passed through.  A new frame is written, so the frame given by the
+ * user is not modified and may be written to other channels as well.
+ * <p>
+ * With <tt>noContextTakeover</tt> (<tt>server_no_context_takeover</tt> for
+ * a server), the deflater is dropped at the end of each message, so its
+ * zlib stream goes back to the {@link ZlibStreamPool} of the I/O thread
+ * and an idle connection holds no compression state.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class WebSocketPerMessageDeflateEncoder
+        : public cetty::handler::codec::oneone::OneToOneEncoder {
+public:
+    WebSocketPerMessageDeflateEncoder();
+
+    /**
+     * @throws InvalidArgumentException if the level is not in [0, 9].
+     */
+    WebSocketPerMessageDeflateEncoder(int compressionLevel, bool noContextTakeover);
+
+    virtual ~WebSocketPerMessageDeflateEncoder() {}
+
+    virtual ChannelHandlerPtr clone();
+    virtual std::string toString() const { return "WebSocketPerMessageDeflateEncoder"; }
+
+protected:
+    virtual ChannelMessage encode(ChannelHandlerContext& ctx,
+                                  Channel& channel,
+                                  const ChannelMessage& msg);
+
+private:
+    int  compressionLevel;
+    bool noContextTakeover;
+
+    // whether the message being sent is compressed.
+    bool compressing;
+    boost::scoped_ptr<ZlibDeflater> deflater;
+};
+
+}}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETPERMESSAGEDEFLATEENCODER_H)
@@ -0,0 +1,171 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETSERVERHANDSHAKER13_H)
+#define CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETSERVERHANDSHAKER13_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/handler/codec/http/HttpRequest.h"
+#include "cetty/handler/codec/http/HttpResponse.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketFrame.h"
+
+namespace cetty { namespace channel {
+class Channel;
+}}
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::channel;
+using namespace cetty::handler::codec::http;
+
+/**
+ * Performs the server side opening handshake of
+ * <a href="http://tools.ietf.org/html/rfc6455">RFC 6455</a>, the version
+ * <tt>13</tt> of the Web Socket protocol.
+ * <p>
+ * The response is written, then the {@link HttpRequestDecoder} and the
+ * {@link HttpResponseEncoder} of the pipeline are replaced by a
+ * {@link WebSocket13FrameDecoder} (<tt>"wsdecoder"</tt>) and a
+ * {@link WebSocket13FrameEncoder} (<tt>"wsencoder"</tt>), and the
+ * {@link HttpChunkAggregator} is removed.
+ * <p>
+ * If the extensions are allowed and the client offers
+ * <tt>permessage-deflate</tt>
+ * (<a href="http://tools.ietf.org/html/rfc7692">RFC 7692</a>), it is
+ * accepted with <tt>server_no_context_takeover</tt>, and a
+ * {@link WebSocketPerMessageDeflateDecoder} (<tt>"wsinflater"</tt>) and a
+ * {@link WebSocketPerMessageDeflateEncoder} (<tt>"wsdeflater"</tt>) are
+ * added next to the frame codec.  The deflate streams are then held only
+ * while a message is compressed, and shared by the connections of an I/O
+ * thread through the {@link ZlibStreamPool}.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class WebSocketServerHandshaker13 {
+public:
+    static const std::string VERSION;
+
+    static const std::string PERMESSAGE_DEFLATE;
+
+public:
+    /**
+     * @param subprotocols
+     *        the comma separated sub protocols supported by the server,
+     *        or an empty string if none.
+     * @param allowExtensions
+     *        <tt>true</tt> to negotiate <tt>permessage-deflate</tt>.
+     */
+    WebSocketServerHandshaker13(const std::string& subprotocols,
+                                bool allowExtensions);
+
+    WebSocketServerHandshaker13(const std::string& subprotocols,
+                                bool allowExtensions,
+                                int maxFramePayloadLength);
+
+    /**
+     * Returns <tt>true</tt> if the request asks for upgrading the connection
+     * to the Web Socket protocol, whichever its version.
+     */
+    static bool isUpgradeRequest(const HttpRequest& request);
+
+    /**
+     * Writes the <tt>426 Upgrade Required</tt> response listing the supported
+     * version, for the request of another version.
+     */
+    static ChannelFuturePtr sendUnsupportedVersionResponse(Channel& channel);
+
+    /**
+     * Answers the opening handshake and upgrades the pipeline.  It may be
+     * called by a handler of the decoded request: the HTTP decoder stops
+     * decoding, and is replaced after the current event, then the bytes
+     * received after the request are passed to the frame decoder.
+     *
+     * @return the future of the handshake response.
+     *
+     * @throws InvalidArgumentException
+     *         if the request is not a version 13 handshake, then no response
+     *         is written.
+     * @throws IllegalStateException
+     *         if the channel has no event loop to replace the HTTP decoder
+     *         in, then no response is written.
+     */
+    ChannelFuturePtr handshake(Channel& channel, const HttpRequest& request);
+
+    /**
+     * Writes the close frame, then closes the channel.
+     */
+    ChannelFuturePtr close(Channel& channel, const WebSocketFramePtr& frame);
+
+    /**
+     * Returns the sub protocol selected by the last handshake, or an empty
+     * string if none.
+     */
+    const std::string& getSelectedSubprotocol() const { return selectedSubprotocol; }
+
+    /**
+     * Returns <tt>true</tt> if the last handshake has accepted the
+     * <tt>permessage-deflate</tt> extension.
+     */
+    bool isDeflateNegotiated() const { return deflateNegotiated; }
+
+private:
+    HttpResponsePtr newHandshakeResponse(const HttpRequest& request,
+                                         bool* clientNoContextTakeover);
+
+    std::string selectSubprotocol(const std::string& requested) const;
+
+    /**
+     * Returns <tt>true</tt> if the offered extension is a
+     * <tt>permessage-deflate</tt> the server can accept.
+     */
+    static bool acceptDeflate(const std::string& offer,
+                              bool* clientNoContextTakeover);
+
+    /**
+     * Replaces the HTTP encoder at once, and the HTTP decoder after the
+     * current event in the event loop of the channel, when the decoder is
+     * no longer on the call stack.
+     */
+    void upgradePipeline(Channel& channel, bool clientNoContextTakeover);
+
+    /**
+     * Replaces the stopped HTTP decoder and removes the aggregator, then
+     * forwards the undecoded bytes to the frame decoder.  Releases the
+     * channel retained by {@link #upgradePipeline}.
+     */
+    static void upgradeDecoder(Channel* channel,
+                               const std::string& httpDecoderName,
+                               const std::string& aggregatorName,
+                               bool deflateNegotiated,
+                               bool clientNoContextTakeover,
+                               int maxFramePayloadLength);
+
+private:
+    std::vector<std::string> subprotocols;
+    bool allowExtensions;
+    int  maxFramePayloadLength;
+
+    std::string selectedSubprotocol;
+    bool deflateNegotiated;
+};
+
+}}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETSERVERHANDSHAKER13_H)
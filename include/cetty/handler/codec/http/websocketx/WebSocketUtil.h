@@ -0,0 +1,92 @@
+#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETUTIL_H)
+#define CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETUTIL_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include "cetty/buffer/ChannelBuffer.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::buffer;
+
+/**
+ * The helpers of the Web Socket handshake and of the frame masking.
+ * <p>
+ * The masking XORs the payload with the 4 bytes key.  On x86 it is done 16
+ * bytes at a time with SSE2, or 32 bytes at a time with AVX2 when the
+ * processor supports it, which is checked once at run time.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class WebSocketUtil {
+public:
+    static const int MASK_KEY_SIZE = 4;
+
+    /**
+     * The GUID which is appended to <tt>Sec-WebSocket-Key</tt> before
+     * hashing it into <tt>Sec-WebSocket-Accept</tt>.
+     */
+    static const std::string ACCEPT_GUID;
+
+public:
+    /**
+     * Masks, or unmasks, <tt>length</tt> bytes in place.
+     *
+     * @param keyOffset the index in the key of the first byte, i.e. the
+     *                  number of the payload bytes masked before
+     *                  <tt>bytes</tt>, modulo 4.
+     *
+     * @return the key offset of the byte following the last one.
+     */
+    static int mask(char* bytes, int length, const char* key, int keyOffset);
+
+    /**
+     * Masks, or unmasks, the readable bytes of the buffer in place.  The
+     * bytes of a buffer which is not accessible in memory are read, masked
+     * and set back one region at a time.
+     */
+    static void mask(const ChannelBufferPtr& buffer, const char* key);
+
+    /**
+     * Returns the <tt>Sec-WebSocket-Accept</tt> value of the
+     * <tt>Sec-WebSocket-Key</tt>: the base64 encoded SHA-1 of the key
+     * followed by {@link #ACCEPT_GUID}.
+     */
+    static std::string calculateAccept(const std::string& key);
+
+    /**
+     * Returns the 20 bytes SHA-1 digest of the data.
+     */
+    static std::string sha1(const std::string& data);
+
+    static std::string base64(const std::string& data);
+
+    /**
+     * Returns the name of the instruction set used by the masking:
+     * <tt>"AVX2"</tt>, <tt>"SSE2"</tt> or <tt>"NONE"</tt>.
+     */
+    static const char* getInstructionSet();
+
+private:
+    WebSocketUtil() {}
+};
+
+}}}}}
+
+#endif //#if !defined(CETTY_HANDLER_CODEC_HTTP_WEBSOCKETX_WEBSOCKETUTIL_H)
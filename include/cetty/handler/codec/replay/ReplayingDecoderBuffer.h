@@ -62,6 +62,8 @@ public:
 
     virtual int arrayOffset() const;
 
+    virtual int getContiguousBytes(int index, ConstArray& bytes) const;
+
     virtual void clear();
 
     virtual bool equals(const ChannelBuffer& buffer) const;
@@ -0,0 +1,134 @@
+#if !defined(CETTY_HANDLER_EXECUTION_EXECUTIONHANDLER_H)
+#define CETTY_HANDLER_EXECUTION_EXECUTIONHANDLER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/util/ExternalResourceReleasable.h"
+#include "cetty/handler/execution/OrderedMemoryAwareThreadPool.h"
+
+namespace cetty { namespace channel {
+class ChannelMessage;
+}}
+
+namespace cetty { namespace handler { namespace execution {
+
+using namespace cetty::util;
+using namespace cetty::channel;
+
+/**
+ * Forwards the upstream events to an {@link OrderedMemoryAwareThreadPool},
+ * so the handlers after it run in the worker threads of the pool rather
+ * than the I/O thread.  It is usually placed after the decoders, before the
+ * handler which calls a blocking service (e.g. a database):
+ *
+ * <pre>
+ * OrderedMemoryAwareThreadPoolPtr pool(
+ *     new OrderedMemoryAwareThreadPool(16, 1048576, 16777216));
+ * ChannelHandlerPtr executionHandler(new ExecutionHandler(pool));
+ *
+ * pipeline->addLast("decoder", new MyProtocolDecoder());
+ * pipeline->addLast("encoder", new MyProtocolEncoder());
+ * pipeline->addLast("executor", executionHandler);
+ * pipeline->addLast("handler", new MyBusinessLogicHandler());
+ * </pre>
+ *
+ * The events of a channel are handled in the order they were fired, one at
+ * a time, though maybe by different worker threads.  The handler is shared
+ * by all the pipelines, and the pool should be shut down by
+ * {@link #releaseExternalResources()} when the application exits.
+ *
+ * The upstream events only refer to the data of the caller which fired
+ * them, so they are copied before being queued.  A {@link ChannelBuffer}
+ * message is copied out of the buffer, which is then marked as read, since
+ * the I/O thread reuses its read buffer.  The events with no known type,
+ * handled by {@link #handleUpstream}, are forwarded in the current thread.
+ *
+ * The size of each queued message is estimated by {@link #estimateSize},
+ * the pool suspends reading from a channel whose queued messages are over
+ * its memory budget, see {@link OrderedMemoryAwareThreadPool}.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class ExecutionHandler : public SimpleChannelUpstreamHandler,
+                         public ExternalResourceReleasable {
+public:
+    /**
+     * Creates a new instance with the specified thread pool.
+     *
+     * @throws NullPointerException if <tt>threadPool</tt> is empty.
+     */
+    ExecutionHandler(const OrderedMemoryAwareThreadPoolPtr& threadPool);
+
+    virtual ~ExecutionHandler();
+
+    /**
+     * Returns the {@link OrderedMemoryAwareThreadPool} of this handler.
+     */
+    const OrderedMemoryAwareThreadPoolPtr& getThreadPool() const {
+        return threadPool;
+    }
+
+    /**
+     * Shuts down the thread pool of this handler.
+     */
+    virtual void releaseExternalResources();
+
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "ExecutionHandler"; }
+
+    virtual void handleUpstream(ChannelHandlerContext& ctx,
+                                const ChannelEvent& e);
+
+    virtual void messageReceived(ChannelHandlerContext& ctx,
+                                 const MessageEvent& e);
+
+    virtual void exceptionCaught(ChannelHandlerContext& ctx,
+                                 const ExceptionEvent& e);
+
+    virtual void writeCompleted(ChannelHandlerContext& ctx,
+                                const WriteCompletionEvent& e);
+
+    virtual void channelStateChanged(ChannelHandlerContext& ctx,
+                                     const ChannelStateEvent& e);
+
+    virtual void childChannelStateChanged(ChannelHandlerContext& ctx,
+                                          const ChildChannelStateEvent& e);
+
+protected:
+    /**
+     * Returns the estimated size of the memory held by the message, which is
+     * the readable bytes of a {@link ChannelBuffer}, the length of a string,
+     * or a small constant for the other messages.
+     */
+    virtual int estimateSize(const ChannelMessage& message) const;
+
+private:
+    typedef OrderedMemoryAwareThreadPool::Runnable Runnable;
+    typedef OrderedMemoryAwareThreadPool::ChildExecutor ChildExecutor;
+    typedef OrderedMemoryAwareThreadPool::ChildExecutorPtr ChildExecutorPtr;
+
+    void execute(ChannelHandlerContext& ctx, Runnable* task, int size);
+
+private:
+    OrderedMemoryAwareThreadPoolPtr threadPool;
+};
+
+}}}
+
+#endif //#if !defined(CETTY_HANDLER_EXECUTION_EXECUTIONHANDLER_H)
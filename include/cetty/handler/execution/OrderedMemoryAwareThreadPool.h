@@ -0,0 +1,247 @@
+#if !defined(CETTY_HANDLER_EXECUTION_ORDEREDMEMORYAWARETHREADPOOL_H)
+#define CETTY_HANDLER_EXECUTION_ORDEREDMEMORYAWARETHREADPOOL_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <deque>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "cetty/util/ReferenceCounter.h"
+
+namespace cetty { namespace channel {
+class Channel;
+}}
+
+namespace cetty { namespace logging {
+class InternalLogger;
+}}
+
+namespace cetty { namespace handler { namespace execution {
+
+using namespace cetty::util;
+using namespace cetty::channel;
+using namespace cetty::logging;
+
+class OrderedMemoryAwareThreadPool;
+typedef boost::intrusive_ptr<OrderedMemoryAwareThreadPool> OrderedMemoryAwareThreadPoolPtr;
+
+/**
+ * A thread pool which runs the tasks of a {@link Channel} one by one in
+ * the order they were submitted, while the tasks of different channels run
+ * in parallel.  It is used by {@link ExecutionHandler} to move the blocking
+ * business logic out of the I/O threads.
+ *
+ * <h3>Scheduling</h3>
+ * The tasks of a channel are queued in its {@link ChildExecutor}.  A child
+ * executor with pending tasks is placed in the deque of one worker thread,
+ * the one which ran it last time, so a channel tends to stay on the same
+ * core.  A worker takes the child executors from the head of its own deque,
+ * and when its deque is empty it steals from the tail of the other ones,
+ * so a few busy channels can not leave the other workers idle.  A worker
+ * runs at most {@link #MAX_TASKS_PER_RUN} tasks of a child executor before
+ * putting it back, and a child executor is held by only one worker at a
+ * time, which keeps the order of the tasks of the channel.
+ *
+ * <h3>Memory awareness</h3>
+ * Each task has an estimated size.  When the pending size of a channel
+ * exceeds <tt>maxChannelMemorySize</tt>, or the pending size of the pool
+ * exceeds <tt>maxTotalMemorySize</tt>, the channel is suspended by
+ * {@link Channel#setReadable(bool) Channel.setReadable(false)}.  It is
+ * resumed when its pending size drops under the half of
+ * <tt>maxChannelMemorySize</tt> while the pool is under its limit, or when
+ * all of its tasks are done.  A limit of <tt>0</tt> disables the check.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class OrderedMemoryAwareThreadPool
+    : public ReferenceCounter<OrderedMemoryAwareThreadPool>,
+      private boost::noncopyable {
+public:
+    /**
+     * A task run by the pool.
+     */
+    class Runnable {
+    public:
+        virtual ~Runnable() {}
+        virtual void run() = 0;
+    };
+
+    /**
+     * The serial queue of the tasks of a {@link Channel}.  It
+     * {@link Channel#retain() retains} the channel, so a closed channel is
+     * not deleted while its tasks are still queued or running.
+     */
+    class ChildExecutor : public ReferenceCounter<ChildExecutor> {
+    public:
+        ChildExecutor(Channel& channel, int worker);
+        virtual ~ChildExecutor();
+
+        Channel& getChannel() const { return channel; }
+
+        /**
+         * Returns the total estimated size of the pending tasks.
+         */
+        int getPendingSize() const;
+
+        /**
+         * Returns <tt>true</tt> if the channel was suspended by the pool.
+         */
+        bool isSuspended() const;
+
+    private:
+        friend class OrderedMemoryAwareThreadPool;
+
+        struct Task {
+            Task(Runnable* runnable, int size) : runnable(runnable), size(size) {}
+
+            Runnable* runnable;
+            int size;
+        };
+
+    private:
+        Channel& channel;
+
+        // the setReadable may fire an event back to the pool in the same thread.
+        mutable boost::recursive_mutex mutex;
+        std::deque<Task> tasks;
+
+        int  pendingSize;
+        int  worker;
+        bool scheduled;
+        bool suspended;
+    };
+
+    typedef boost::intrusive_ptr<ChildExecutor> ChildExecutorPtr;
+
+    /**
+     * The most tasks of a {@link ChildExecutor} run before the worker
+     * goes to another one.
+     */
+    static const int MAX_TASKS_PER_RUN = 16;
+
+public:
+    /**
+     * Creates a new instance.
+     *
+     * @param threadCount
+     *        the count of the worker threads
+     * @param maxChannelMemorySize
+     *        the maximum total size of the queued tasks per channel.
+     *        Specify <tt>0</tt> to disable.
+     * @param maxTotalMemorySize
+     *        the maximum total size of the queued tasks of this pool.
+     *        Specify <tt>0</tt> to disable.
+     *
+     * @throws InvalidArgumentException
+     *         if <tt>threadCount</tt> is not positive or a limit is negative.
+     */
+    OrderedMemoryAwareThreadPool(int threadCount,
+                                 int maxChannelMemorySize,
+                                 int maxTotalMemorySize);
+
+    /**
+     * Shuts down the pool and deletes the tasks which were never run.
+     */
+    virtual ~OrderedMemoryAwareThreadPool();
+
+    /**
+     * Creates the {@link ChildExecutor} of the specified channel.  All the
+     * tasks of the channel should be submitted with it.
+     */
+    ChildExecutorPtr newChildExecutor(Channel& channel);
+
+    /**
+     * Queues the task into the child executor, the pool takes the ownership
+     * of the task.
+     *
+     * @param size the estimated size of the memory held by the task.
+     *
+     * @throws IllegalStateException if the pool has been shut down.
+     */
+    void execute(const ChildExecutorPtr& child, Runnable* task, int size);
+
+    /**
+     * Stops accepting new tasks, waits for the queued tasks to be done and
+     * then joins the worker threads.  It must not be called from a worker
+     * thread.
+     */
+    void shutdown();
+
+    bool isShutdown() const;
+
+    int getThreadCount() const { return static_cast<int>(threads.size()); }
+    int getMaxChannelMemorySize() const { return maxChannelMemorySize; }
+    int getMaxTotalMemorySize() const { return maxTotalMemorySize; }
+
+    /**
+     * Returns the total estimated size of the pending tasks of all channels.
+     */
+    int getTotalPendingSize() const { return totalPendingSize; }
+
+private:
+    struct Worker {
+        boost::mutex mutex;
+        std::deque<ChildExecutorPtr> children;
+    };
+
+    typedef boost::shared_ptr<boost::thread> ThreadPtr;
+    typedef boost::shared_ptr<Worker> WorkerPtr;
+
+private:
+    void run(int index);
+    void runChild(const ChildExecutorPtr& child, int index);
+
+    void schedule(const ChildExecutorPtr& child, int index);
+    ChildExecutorPtr take(int index);
+    ChildExecutorPtr steal(int index);
+
+    void taskDone(ChildExecutor& child, int size);
+
+private:
+    static InternalLogger* logger;
+
+    int maxChannelMemorySize;
+    int maxTotalMemorySize;
+
+    std::vector<WorkerPtr> workers;
+    std::vector<ThreadPtr> threads;
+
+    boost::atomic<int> nextWorker;
+    boost::atomic<int> totalPendingSize;
+
+    // the count of the child executors waiting in the deques.
+    boost::atomic<int> scheduledCount;
+    boost::atomic<int> idleCount;
+    boost::atomic<bool> stopped;
+
+    boost::mutex idleMutex;
+    boost::condition_variable idleCondition;
+    boost::mutex shutdownMutex;
+};
+
+}}}
+
+#endif //#if !defined(CETTY_HANDLER_EXECUTION_ORDEREDMEMORYAWARETHREADPOOL_H)
@@ -23,6 +23,7 @@
 
 #include <boost/cstdint.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/atomic.hpp>
 #include <boost/date_time/posix_time/ptime.hpp>
 
 #include "cetty/channel/SimpleChannelUpstreamHandler.h"
@@ -30,6 +31,11 @@
 #include "cetty/util/ExternalResourceReleasable.h"
 #include "cetty/util/Timer.h"
 #include "cetty/util/TimerTask.h"
+#include "cetty/handler/timeout/IdleStateSweeper.h"
+
+namespace cetty { namespace channel {
+class Channel;
+}}
 
 namespace cetty { namespace util {
 class TimeUnit;
@@ -115,6 +121,22 @@ class IdleState;
  * created should be stopped manually by calling {@link #releaseExternalResources()}
  * or {@link Timer#stop()} when your application shuts down.
  *
+ * <h3>Sweep mode</h3>
+ *
+ * By default, every channel reads the clock on each read and write, and
+ * keeps up to three timeouts which reschedule themselves.  If a sweep
+ * interval is specified, the handler works in the sweep mode instead: the
+ * channels of an event loop are checked together by an
+ * {@link IdleStateSweeper} once per sweep interval, and a read or a write
+ * only stamps the time cached by the last sweep, without any lock or clock
+ * read.  The idle time is then detected with the precision of the sweep
+ * interval:
+ *
+ * <pre>
+ * // detects the idle channels every second.
+ * new IdleStateHandler(60, 30, 0, 1, TimeUnit::SECONDS);
+ * </pre>
+ *
  *
  * @author <a href="http://gleamynode.net/">Trustin Lee</a>
  * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
@@ -186,6 +208,35 @@ public:
                      boost::int64_t allIdleTime,
                      const TimeUnit& unit);
 
+    /**
+     * Creates a new instance in the sweep mode.
+     *
+     * @param readerIdleTime
+     *        an {@link IdleStateEvent} whose state is {@link IdleState#READER_IDLE}
+     *        will be triggered when no read was performed for the specified
+     *        period of time.  Specify <tt>0</tt> to disable.
+     * @param writerIdleTime
+     *        an {@link IdleStateEvent} whose state is {@link IdleState#WRITER_IDLE}
+     *        will be triggered when no write was performed for the specified
+     *        period of time.  Specify <tt>0</tt> to disable.
+     * @param allIdleTime
+     *        an {@link IdleStateEvent} whose state is {@link IdleState#ALL_IDLE}
+     *        will be triggered when neither read nor write was performed for
+     *        the specified period of time.  Specify <tt>0</tt> to disable.
+     * @param sweepInterval
+     *        the interval of the sweeps which check the idle channels of an
+     *        I/O thread.  Specify <tt>0</tt> to use the timeouts per channel.
+     * @param unit
+     *        the {@link TimeUnit} of <tt>readerIdleTime</tt>,
+     *        <tt>writeIdleTime</tt>, <tt>allIdleTime</tt> and
+     *        <tt>sweepInterval</tt>
+     */
+    IdleStateHandler(boost::int64_t readerIdleTime,
+                     boost::int64_t writerIdleTime,
+                     boost::int64_t allIdleTime,
+                     boost::int64_t sweepInterval,
+                     const TimeUnit& unit);
+
     /**
      * Stops the {@link Timer} which was specified in the constructor of this
      * handler.  You should not call this method if the {@link Timer} is in use
@@ -213,8 +264,28 @@ protected:
     void channelIdle(ChannelHandlerContext& ctx, const IdleState& state, const time_type& lastActivityTime);
 
 private:
+    friend class IdleStateSweeper;
+
     void initialize(ChannelHandlerContext& ctx);
-    void destroy();
+    void initializeSweep(ChannelHandlerContext& ctx);
+    void destroy(ChannelHandlerContext& ctx);
+
+    /**
+     * Links the entries in the event loop of the sweeper, unless the
+     * handler has been destroyed since the sweep mode was initialized.
+     */
+    static void addToSweeper(const ChannelHandlerPtr& handler,
+                             ChannelHandlerContext* ctx,
+                             const IdleStateSweeperPtr& sweeper,
+                             int generation);
+
+    /**
+     * Unlinks the entries in the event loop of the sweeper, and releases
+     * the channel retained by {@link #initializeSweep}.
+     */
+    static void removeFromSweeper(const ChannelHandlerPtr& handler,
+                                  Channel* channel,
+                                  const IdleStateSweeperPtr& sweeper);
 
 private:
 
@@ -294,6 +365,13 @@ private:
     boost::int64_t allIdleTimeMillis;
     TimeoutPtr allIdleTimeout;
     AllIdleTimeoutTask* allTimeoutTask;
+
+    boost::int64_t sweepIntervalMillis;
+    IdleStateSweeperPtr sweeper;
+    boost::atomic<int> sweepGeneration;
+    IdleStateSweeper::Entry readerEntry;
+    IdleStateSweeper::Entry writerEntry;
+    IdleStateSweeper::Entry allEntry;
 };
 
 }}}
@@ -0,0 +1,191 @@
+#if !defined(CETTY_HANDLER_TIMEOUT_IDLESTATESWEEPER_H)
+#define CETTY_HANDLER_TIMEOUT_IDLESTATESWEEPER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <map>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/date_time/posix_time/ptime.hpp>
+
+#include "cetty/util/Timer.h"
+
+namespace cetty { namespace channel {
+class ChannelEventLoop;
+class ChannelHandlerContext;
+}}
+
+namespace cetty { namespace handler { namespace timeout {
+
+using namespace cetty::channel;
+using namespace cetty::util;
+
+class IdleState;
+class IdleStateHandler;
+class IdleStateSweeper;
+
+typedef boost::shared_ptr<IdleStateSweeper> IdleStateSweeperPtr;
+
+/**
+ * Detects the idle channels of an event loop for the
+ * {@link IdleStateHandler}s which are in the sweep mode, without any timer
+ * per channel.
+ *
+ * Every sweep reads the clock once and caches the time.  A read or a write
+ * never reads the clock, it only stamps the cached time on the channel and
+ * moves it to the tail of an intrusive list, so the list is always ordered
+ * by the last activity.  The channels which have been stamped since the
+ * last sweep are already at the tail and are left where they are.  There
+ * is a list for every idle state and idle time.
+ *
+ * A single periodic {@link Timeout} of the {@link Timer} runs the sweep in
+ * the event loop, which only visits the channels at the head of the lists
+ * whose idle time has elapsed, and triggers an {@link IdleStateEvent} for
+ * each of them.  As the activities are stamped with the time of the sweep
+ * before them, an idle channel is detected at most one sweep interval
+ * early or late.
+ *
+ * The sweeper is not thread safe: except {@link #getSweeper}, it is only
+ * used in the thread of its event loop (or of the timer, if the channels
+ * have no event loop), so a read or a write takes no lock.  It is shared by
+ * the handlers of the event loop which hold it, and is released with the
+ * last of them.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class IdleStateSweeper : private boost::noncopyable,
+    public boost::enable_shared_from_this<IdleStateSweeper> {
+public:
+    typedef boost::posix_time::ptime time_type;
+
+    class ActivityList;
+
+    /**
+     * The node of a channel in the list of an idle state, which is a
+     * member of the {@link IdleStateHandler}.
+     */
+    class Entry : private boost::noncopyable {
+    public:
+        Entry() : ctx(NULL), handler(NULL), list(NULL), prev(NULL), next(NULL) {}
+
+        bool isLinked() const { return list != NULL; }
+
+    private:
+        friend class IdleStateSweeper;
+
+        ChannelHandlerContext* ctx;
+        IdleStateHandler* handler;
+
+        time_type lastActivityTime;
+        time_type deadline;
+
+        ActivityList* list;
+        Entry* prev;
+        Entry* next;
+    };
+
+public:
+    IdleStateSweeper(ChannelEventLoop* eventLoop,
+                     const TimerPtr& timer,
+                     boost::int64_t sweepIntervalMillis);
+
+    ~IdleStateSweeper();
+
+    /**
+     * Returns the sweeper of the event loop which shares the {@link Timer}
+     * and the sweep interval, and creates it if there is none.  It may be
+     * called by any thread.
+     *
+     * @param eventLoop the event loop of the channels, or <tt>NULL</tt> if
+     *        they have none, then the sweeps run in the thread of the timer.
+     */
+    static IdleStateSweeperPtr getSweeper(ChannelEventLoop* eventLoop,
+                                          const TimerPtr& timer,
+                                          boost::int64_t sweepIntervalMillis);
+
+    ChannelEventLoop* getEventLoop() const { return eventLoop; }
+
+    /**
+     * Links the entry into the list of the idle state and idle time, and
+     * starts the sweeps if they have not been started.
+     */
+    void add(Entry& entry,
+             ChannelHandlerContext& ctx,
+             IdleStateHandler& handler,
+             const IdleState& state,
+             boost::int64_t idleTimeMillis);
+
+    void remove(Entry& entry);
+
+    /**
+     * Stamps the time cached by the last sweep on the entries which are
+     * linked, which belong to the same sweeper.
+     */
+    static void touch(Entry& entry, Entry& allEntry);
+
+    /**
+     * Returns the count of the linked entries.
+     */
+    int getEntryCount() const { return entryCount; }
+
+    /**
+     * Returns the time cached by the last sweep, which the reads and the
+     * writes are stamped with.
+     */
+    const time_type& getCachedTime() const { return currentTime; }
+
+private:
+    typedef std::pair<int, boost::int64_t> ListKey;
+    typedef std::map<ListKey, ActivityList*> ActivityLists;
+
+    void sweep();
+    void scheduleSweep();
+
+    /**
+     * Runs the sweep in the event loop, the timer may be shared by the
+     * event loops.
+     */
+    static void expired(const IdleStateSweeperPtr& sweeper, Timeout& timeout);
+
+    /**
+     * Reads the clock into the cached time, which is only done by the
+     * sweeps, and by {@link #add} when there is no sweep.
+     */
+    const time_type& refreshTime();
+
+    void stamp(Entry& entry, const time_type& time);
+    void link(Entry& entry);
+    void unlink(Entry& entry);
+
+private:
+    ChannelEventLoop* eventLoop;
+    TimerPtr timer;
+    boost::int64_t sweepIntervalMillis;
+
+    time_type currentTime;
+    ActivityLists lists;
+
+    int  entryCount;
+    bool sweeping;
+};
+
+}}}
+
+#endif //#if !defined(CETTY_HANDLER_TIMEOUT_IDLESTATESWEEPER_H)
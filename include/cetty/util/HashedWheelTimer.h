@@ -0,0 +1,226 @@
+#if !defined(CETTY_UTIL_HASHEDWHEELTIMER_H)
+#define CETTY_UTIL_HASHEDWHEELTIMER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/deadline_timer.hpp>
+
+#include "cetty/util/Timer.h"
+#include "cetty/util/Timeout.h"
+
+namespace cetty { namespace util {
+
+/**
+ * A {@link Timer} optimized for approximated I/O timeout scheduling, which
+ * is driven by the thread of a <tt>boost::asio::io_service</tt>, or by an
+ * event loop through a {@link HashedWheelTimer::TickSource}.
+ *
+ * <h3>Tick Duration</h3>
+ *
+ * As described with 'approximated', this timer does not execute the
+ * scheduled {@link TimerTask} on time.  On every tick, it checks if there
+ * are any {@link TimerTask}s behind the schedule and executes them.
+ * You can increase or decrease the accuracy of the execution timing by
+ * specifying smaller or larger tick duration in the constructor.  In most
+ * network applications, I/O timeout does not need to be accurate.
+ * Therefore, the default tick duration is 100 milliseconds and you will
+ * not need to try different configurations in most cases.
+ *
+ * <h3>Ticks per Wheel (Wheel Size)</h3>
+ *
+ * The timer maintains a data structure called 'wheel'.  To put simply, a
+ * wheel is a hash table of {@link TimerTask}s whose hash function is
+ * 'dead line of the task'.  The default number of ticks per wheel (i.e.
+ * the size of the wheel) is 512.  You could specify a larger value if you
+ * are going to schedule a lot of timeouts.
+ *
+ * Scheduling and cancelling a timeout are O(1), the timeouts are linked
+ * into the buckets of the wheel, and unlinked as soon as they are expired
+ * or cancelled.  Only one <tt>deadline_timer</tt>, or tick source, is used
+ * for the ticks, and it is armed only while there are pending timeouts.
+ *
+ * <h3>Do not create many instances.</h3>
+ *
+ * The timer is shared by all the channels of an I/O thread, see
+ * {@link cetty::util::internal::asio::AsioHashedWheelTimerFactory}, and
+ * every epoll event loop owns one, see
+ * {@link cetty::util::internal::epoll::EpollHashedWheelTimerFactory}.
+ * The timeouts may be scheduled from any thread, but the tasks are always
+ * executed in the thread of the <tt>io_service</tt> or the event loop.
+ *
+ * <h3>Implementation Details</h3>
+ *
+ * The timer is based on
+ * <a href="http://cseweb.ucsd.edu/users/varghese/">George Varghese</a> and
+ * Tony Lauck's paper,
+ * <a href="http://cseweb.ucsd.edu/users/varghese/PAPERS/twheel.ps.Z">'Hashed
+ * and Hierarchical Timing Wheels: data structures to efficiently implement a
+ * timer facility'</a>.
+ *
+ * @author <a href="http://gleamynode.net/">Trustin Lee</a>
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class HashedWheelTimer : public cetty::util::Timer {
+public:
+    static const boost::int64_t DEFAULT_TICK_DURATION = 100;
+    static const int DEFAULT_TICKS_PER_WHEEL = 512;
+
+    typedef boost::asio::deadline_timer::time_type TimeType;
+
+    /**
+     * Arms the ticks of a timer which is not driven by an <tt>io_service</tt>.
+     */
+    class TickSource {
+    public:
+        typedef boost::function0<void> TickFunctor;
+
+    public:
+        virtual ~TickSource() {}
+
+        /**
+         * Calls the functor once, in the thread which runs the timeouts, at
+         * or after the given time.  It replaces the functor armed before,
+         * and may be called from any thread.
+         */
+        virtual void expiresAt(const TimeType& time, const TickFunctor& onTick) = 0;
+
+        /**
+         * Drops the functor armed, if any.
+         */
+        virtual void cancel() = 0;
+    };
+
+public:
+    /**
+     * Creates a new timer with the default tick duration and the default
+     * number of ticks per wheel.
+     */
+    HashedWheelTimer(boost::asio::io_service& ioService);
+
+    /**
+     * Creates a new timer.
+     *
+     * @param ioService     the io_service whose thread drives the ticks
+     * @param tickDuration  the duration (milliseconds) between ticks
+     * @param ticksPerWheel the size of the wheel, which is rounded up to
+     *                      the power of two
+     *
+     * @throws InvalidArgumentException if either of the
+     *         <tt>tickDuration</tt> and <tt>ticksPerWheel</tt> is not positive
+     */
+    HashedWheelTimer(boost::asio::io_service& ioService,
+                     boost::int64_t tickDuration,
+                     int ticksPerWheel);
+
+    /**
+     * Creates a new timer whose ticks are armed on the tick source, which
+     * must outlive the timer.
+     *
+     * @param tickSource    the source which calls the ticks in its thread
+     * @param tickDuration  the duration (milliseconds) between ticks
+     * @param ticksPerWheel the size of the wheel, which is rounded up to
+     *                      the power of two
+     *
+     * @throws InvalidArgumentException if either of the
+     *         <tt>tickDuration</tt> and <tt>ticksPerWheel</tt> is not positive
+     */
+    HashedWheelTimer(TickSource& tickSource,
+                     boost::int64_t tickDuration = DEFAULT_TICK_DURATION,
+                     int ticksPerWheel = DEFAULT_TICKS_PER_WHEEL);
+
+    virtual ~HashedWheelTimer();
+
+    virtual const TimeoutPtr& newTimeout(TimerTask& task, boost::int64_t delay);
+    virtual const TimeoutPtr& newTimeout(TimerTask& task, boost::int64_t delay, const TimeUnit& unit);
+
+    virtual const TimeoutPtr& newTimeout(const TaskType& task, boost::int64_t delay);
+    virtual const TimeoutPtr& newTimeout(const TaskType& task, boost::int64_t delay, const TimeUnit& unit);
+
+    /**
+     * Cancels all the pending timeouts, no timeout could be scheduled any
+     * more after the timer is stopped.
+     */
+    virtual void stop();
+
+    boost::int64_t getTickDuration() const { return tickDuration; }
+    int getTicksPerWheel() const { return static_cast<int>(wheel.size()); }
+
+    /**
+     * Returns the count of the timeouts which are neither expired nor
+     * cancelled.
+     */
+    int getPendingCount() const;
+
+private:
+    class HashedWheelTimeout;
+    friend class HashedWheelTimeout;
+
+private:
+    const TimeoutPtr& schedule(HashedWheelTimeout* timeout, boost::int64_t delay);
+    void cancel(HashedWheelTimeout& timeout);
+
+    void init(boost::int64_t tickDuration, int ticksPerWheel);
+
+    void startTicking();
+    void onTick(const boost::system::error_code& error);
+    void expireTimeouts(int bucket, std::vector<TimeoutPtr>& expired);
+
+    void link(HashedWheelTimeout* timeout, int bucket);
+    void unlink(HashedWheelTimeout* timeout);
+    void clear(std::vector<TimeoutPtr>& cancelled);
+
+    TimeType getTickTime(boost::int64_t tick) const;
+
+    static int normalizeTicksPerWheel(int ticksPerWheel);
+
+private:
+    boost::int64_t tickDuration;
+    int mask;
+
+    // the heads of the buckets, which are linked lists of the timeouts.
+    std::vector<HashedWheelTimeout*> wheel;
+
+    boost::int64_t tick;
+    TimeType startTime;
+
+    int  pendingCount;
+    bool ticking;
+    bool stopped;
+
+    mutable boost::mutex mutex;
+
+    // either of them drives the ticks.
+    boost::scoped_ptr<boost::asio::deadline_timer> tickTimer;
+    TickSource* tickSource;
+
+    // the last scheduled timeout of every thread, to which the reference
+    // returned by newTimeout refers.
+    boost::thread_specific_ptr<TimeoutPtr> scheduledTimeouts;
+};
+
+}}
+
+#endif //#if !defined(CETTY_UTIL_HASHEDWHEELTIMER_H)
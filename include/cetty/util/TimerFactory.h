@@ -58,6 +58,12 @@ public:
 
     static void resetFactory(const TimerFactoryPtr& timerFactory);
 
+    /**
+     * stops the timers of the factory injected, and drops it, so no
+     * factory is set as before any injection.
+     */
+    static void resetFactory();
+
     static TimerFactory& getFactory();
 
 private:
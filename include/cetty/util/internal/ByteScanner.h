@@ -0,0 +1,108 @@
+#if !defined(CETTY_UTIL_INTERNAL_BYTESCANNER_H)
+#define CETTY_UTIL_INTERNAL_BYTESCANNER_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+namespace cetty { namespace util { namespace internal {
+
+/**
+ * Scans contiguous bytes for a byte, a set of bytes or a byte sequence.
+ *
+ * On x86 the bytes are compared 16 at a time with SSE2, or 32 at a time
+ * with AVX2 when the processor supports it, which is checked once at run
+ * time.  The other platforms use a portable byte-by-byte loop.
+ *
+ * All the methods return the offset of the match from <tt>bytes</tt>, or
+ * <tt>-1</tt> if there is no match.
+ *
+ * @author <a href="mailto:frankee.zhou@gmail.com">Frankee Zhou</a>
+ */
+
+class ByteScanner {
+public:
+    /**
+     * A set of at most {@link #MAX_SIZE} bytes to look for, or to skip over
+     * if the set is negated.
+     */
+    class ByteSet {
+    public:
+        static const int MAX_SIZE = 4;
+
+        explicit ByteSet(char b0, bool negated = false);
+        ByteSet(char b0, char b1, bool negated = false);
+
+        /**
+         * @throws InvalidArgumentException
+         *         if <tt>size</tt> is not in [1, {@link #MAX_SIZE}].
+         */
+        ByteSet(const char* bytes, int size, bool negated = false);
+
+        bool matches(char b) const {
+            bool found = false;
+
+            for (int i = 0; i < count; ++i) {
+                found |= (values[i] == b);
+            }
+
+            return found != negated;
+        }
+
+        int size() const { return count; }
+        const char* bytes() const { return values; }
+        bool isNegated() const { return negated; }
+
+    private:
+        char values[MAX_SIZE];
+        int  count;
+        bool negated;
+    };
+
+public:
+    static int findFirst(const char* bytes, int length, char value);
+    static int findFirst(const char* bytes, int length, const ByteSet& set);
+
+    static int findLast(const char* bytes, int length, char value);
+    static int findLast(const char* bytes, int length, const ByteSet& set);
+
+    /**
+     * Finds the first <tt>first</tt> which is followed by <tt>second</tt>,
+     * e.g. a <tt>CRLF</tt>.
+     */
+    static int findPair(const char* bytes, int length, char first, char second);
+
+    /**
+     * Finds the first occurrence of <tt>needle</tt>.  An empty needle is
+     * found at <tt>0</tt>.
+     */
+    static int findSequence(const char* bytes,
+                            int length,
+                            const char* needle,
+                            int needleLength);
+
+    /**
+     * Returns the name of the instruction set in use: <tt>"AVX2"</tt>,
+     * <tt>"SSE2"</tt> or <tt>"NONE"</tt>.
+     */
+    static const char* getInstructionSet();
+
+private:
+    ByteScanner() {}
+};
+
+}}}
+
+#endif //#if !defined(CETTY_UTIL_INTERNAL_BYTESCANNER_H)
@@ -0,0 +1,114 @@
+#if !defined(CETTY_UTIL_INTERNAL_MPSCQUEUE_H)
+#define CETTY_UTIL_INTERNAL_MPSCQUEUE_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace cetty { namespace util { namespace internal {
+
+/**
+ * The node of the {@link MpscQueue}, the elements of the queue should
+ * inherit from it.
+ */
+class MpscQueueNode {
+public:
+    MpscQueueNode() : next(0) {}
+
+private:
+    friend class MpscQueue;
+    boost::atomic<MpscQueueNode*> next;
+};
+
+/**
+ * An intrusive, unbounded, lock-free multi-producer single-consumer queue
+ * (the one of Dmitry Vyukov).
+ *
+ * {@link #push(MpscQueueNode*)} may be called by any thread, it costs one
+ * atomic exchange and never blocks.  {@link #pop()} and {@link #empty()}
+ * must only be called by the consumer thread.
+ *
+ * The queue does not own the nodes.
+ */
+class MpscQueue : private boost::noncopyable {
+public:
+    MpscQueue() : head(&stub), tail(&stub) {}
+
+    void push(MpscQueueNode* node) {
+        node->next.store(0, boost::memory_order_relaxed);
+        MpscQueueNode* prev = head.exchange(node, boost::memory_order_acq_rel);
+        // between the exchange and the store, the consumer sees the queue
+        // as empty from <tt>prev</tt> on, see pop().
+        prev->next.store(node, boost::memory_order_release);
+    }
+
+    /**
+     * Retrieves and removes the first node of the queue, or returns
+     * <tt>NULL</tt> if the queue is empty or a producer has not finished
+     * linking its node yet.
+     */
+    MpscQueueNode* pop() {
+        MpscQueueNode* first = tail;
+        MpscQueueNode* next = first->next.load(boost::memory_order_acquire);
+
+        if (first == &stub) {
+            if (0 == next) {
+                return 0;
+            }
+
+            tail = next;
+            first = next;
+            next = next->next.load(boost::memory_order_acquire);
+        }
+
+        if (next) {
+            tail = next;
+            return first;
+        }
+
+        if (first != head.load(boost::memory_order_acquire)) {
+            // a producer is in the middle of push().
+            return 0;
+        }
+
+        // first is the last one, push the stub back behind it.
+        push(&stub);
+
+        next = first->next.load(boost::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return first;
+        }
+
+        return 0;
+    }
+
+    bool empty() const {
+        return tail == &stub &&
+               0 == stub.next.load(boost::memory_order_acquire);
+    }
+
+private:
+    boost::atomic<MpscQueueNode*> head;
+    MpscQueueNode* tail;
+    MpscQueueNode  stub;
+};
+
+}}}
+
+#endif //#if !defined(CETTY_UTIL_INTERNAL_MPSCQUEUE_H)
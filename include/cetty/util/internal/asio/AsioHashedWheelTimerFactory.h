@@ -0,0 +1,96 @@
+#if !defined(CETTY_UTIL_INTERNAL_ASIO_ASIOHASHEDWHEELTIMERFACTORY_H)
+#define CETTY_UTIL_INTERNAL_ASIO_ASIOHASHEDWHEELTIMERFACTORY_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+#include "cetty/util/Exception.h"
+#include "cetty/util/TimerFactory.h"
+#include "cetty/util/HashedWheelTimer.h"
+#include "cetty/channel/socket/asio/AsioServicePool.h"
+
+namespace cetty { namespace channel { namespace socket { namespace asio {
+class AsioSocketChannel;
+class AsioDatagramChannel;
+}}}}
+
+namespace cetty { namespace util { namespace internal { namespace asio {
+
+using namespace cetty::util;
+using namespace cetty::channel::socket::asio;
+
+/**
+ * The {@link TimerFactory} which creates one {@link HashedWheelTimer} for
+ * every I/O thread of the {@link AsioServicePool}, so the timeouts of a
+ * channel are expired in the same thread as its pipeline.
+ *
+ * It is installed by the asio channel factories.  To use a different tick
+ * duration or wheel size, reset it before any channel is opened:
+ *
+ * <pre>
+ * AsioServerSocketChannelFactory factory(4);
+ * TimerFactory::resetFactory(TimerFactoryPtr(
+ *     new AsioSocketHashedWheelTimerFactory(factory.getIOServicePool(), 10, 4096)));
+ * </pre>
+ */
+template<class AsioChannelType>
+class AsioHashedWheelTimerFactory : public cetty::util::TimerFactory {
+public:
+    AsioHashedWheelTimerFactory(AsioServicePool& pool,
+                                boost::int64_t tickDuration = HashedWheelTimer::DEFAULT_TICK_DURATION,
+                                int ticksPerWheel = HashedWheelTimer::DEFAULT_TICKS_PER_WHEEL)
+        : pool(pool) {
+        int j = pool.size();
+        for (int i = 0; i < j; ++i) {
+            timers.push_back(TimerPtr(new HashedWheelTimer(pool.getIOService(i),
+                                      tickDuration,
+                                      ticksPerWheel)));
+        }
+    }
+
+    virtual ~AsioHashedWheelTimerFactory() {}
+
+    virtual const TimerPtr& getTimer(cetty::channel::Channel& channel) {
+        AsioChannelType* socketChannel =
+            dynamic_cast<AsioChannelType*>(&channel);
+
+        BOOST_ASSERT(socketChannel && "Can't parse the correct channel instance.");
+        if (socketChannel) {
+            return timers[socketChannel->getIOService().index()];
+        }
+
+        throw InvalidArgumentException("Can't parse the correct channel instance.");
+    }
+
+    virtual void stopTimers() {
+        std::size_t j = timers.size();
+        for (std::size_t i = 0; i < j; ++i) {
+            timers[i]->stop();
+        }
+    }
+
+private:
+    AsioServicePool& pool;
+    std::vector<TimerPtr> timers;
+};
+
+typedef AsioHashedWheelTimerFactory<AsioSocketChannel> AsioSocketHashedWheelTimerFactory;
+typedef AsioHashedWheelTimerFactory<AsioDatagramChannel> AsioDatagramHashedWheelTimerFactory;
+
+}}}}
+
+#endif //#if !defined(CETTY_UTIL_INTERNAL_ASIO_ASIOHASHEDWHEELTIMERFACTORY_H)
@@ -18,6 +18,7 @@
  */
 
 #include <vector>
+#include "cetty/util/Exception.h"
 #include "cetty/util/TimerFactory.h"
 #include "cetty/util/internal/asio/AsioDeadlineTimer.h"
 #include "cetty/channel/socket/asio/AsioServicePool.h"
@@ -29,7 +30,7 @@ using namespace cetty::channel::socket::asio;
 
 class AsioStandAloneDeadlineTimerFactory : public cetty::util::TimerFactory {
 public:
-    AsioDeadlineTimerFactory(AsioServicePool& pool) : pool(pool) {
+    AsioStandAloneDeadlineTimerFactory(AsioServicePool& pool) : pool(pool) {
         if (pool.size() == 0) {
             throw InvalidArgumentException("the pool is empty.");
         }
@@ -37,7 +38,7 @@ public:
         timer = TimerPtr(new AsioDeadlineTimer(pool.getIOService(0)));
     }
 
-    virtual ~AsioDeadlineTimerFactory() {}
+    virtual ~AsioStandAloneDeadlineTimerFactory() {}
 
     virtual const TimerPtr& getTimer(cetty::channel::Channel& channel) {
         return timer;
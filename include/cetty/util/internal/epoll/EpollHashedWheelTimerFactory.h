@@ -0,0 +1,68 @@
+#if !defined(CETTY_UTIL_INTERNAL_EPOLL_EPOLLHASHEDWHEELTIMERFACTORY_H)
+#define CETTY_UTIL_INTERNAL_EPOLL_EPOLLHASHEDWHEELTIMERFACTORY_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/util/Exception.h"
+#include "cetty/util/TimerFactory.h"
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/socket/epoll/EpollEventLoopPool.h"
+
+namespace cetty { namespace util { namespace internal { namespace epoll {
+
+using namespace cetty::util;
+using namespace cetty::channel::socket::epoll;
+
+/**
+ * The {@link TimerFactory} which returns the {@link HashedWheelTimer} of the
+ * event loop of a channel, so the timeouts of a channel are expired in the
+ * same thread as its pipeline, ticked by the timerfd of the loop.
+ *
+ * It is installed by the epoll channel factories.
+ */
+class EpollHashedWheelTimerFactory : public cetty::util::TimerFactory {
+public:
+    EpollHashedWheelTimerFactory(EpollEventLoopPool& pool) : pool(pool) {}
+
+    virtual ~EpollHashedWheelTimerFactory() {}
+
+    virtual const TimerPtr& getTimer(cetty::channel::Channel& channel) {
+        EpollEventLoopPool::EventLoop* eventLoop =
+            dynamic_cast<EpollEventLoopPool::EventLoop*>(channel.getEventLoop());
+
+        BOOST_ASSERT(eventLoop && "Can't parse the correct channel instance.");
+        if (eventLoop) {
+            return eventLoop->getTimer();
+        }
+
+        throw InvalidArgumentException("Can't parse the correct channel instance.");
+    }
+
+    virtual void stopTimers() {
+        int j = pool.size();
+        for (int i = 0; i < j; ++i) {
+            pool.getEventLoop(i).getTimer()->stop();
+        }
+    }
+
+private:
+    EpollEventLoopPool& pool;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_UTIL_INTERNAL_EPOLL_EPOLLHASHEDWHEELTIMERFACTORY_H)
@@ -78,6 +78,12 @@ ChannelFuturePtr ClientBootstrap::connect(const SocketAddress& remoteAddress, co
             boost::dynamic_pointer_cast<ClientSocketChannelFactory>(factory);
         if (clientFactory) {
             clientFactory->setIpProtocolVersion(remoteAddress.family());
+
+            const std::string* placement =
+                getTypedOption<std::string>("channelPlacement");
+            if (placement) {
+                clientFactory->setChannelPlacement(*placement);
+            }
         }
 
     	ch = getFactory()->newChannel(pipeline);
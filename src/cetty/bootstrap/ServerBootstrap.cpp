@@ -74,6 +74,12 @@ Channel* ServerBootstrap::bind(const SocketAddress& localAddress) {
         boost::dynamic_pointer_cast<ServerSocketChannelFactory>(factory);
     if (serverFactory) {
         serverFactory->setIpProtocolVersion(localAddress.family());
+
+        const std::string* placement =
+            getTypedOption<std::string>("channelPlacement");
+        if (placement) {
+            serverFactory->setChannelPlacement(*placement);
+        }
     }
 
     Channel* channel = getFactory()->newChannel(bossPipeline);
@@ -587,6 +587,15 @@ std::wstring AbstractChannelBuffer::toWideString(int index, int length, const Ch
 //         toByteBuffer(index, length), charset);
 }
 
+int AbstractChannelBuffer::getContiguousBytes(int index, ConstArray& bytes) const {
+    if (index < 0 || index >= capacity() || !hasArray()) {
+        return -1;
+    }
+
+    bytes = ConstArray(array().data() + arrayOffset(), capacity());
+    return 0;
+}
+
 int AbstractChannelBuffer::indexOf(int fromIndex, int toIndex, boost::int8_t value) const {
     return ChannelBuffers::indexOf(*this, fromIndex, toIndex, value);
 }
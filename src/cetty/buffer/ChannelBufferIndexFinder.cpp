@@ -16,114 +16,131 @@
 
 #include "cetty/buffer/ChannelBufferIndexFinder.h"
 #include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/util/internal/ByteScanner.h"
 
 namespace cetty { namespace buffer {
 
+using namespace cetty::util::internal;
+
 /**
- * Index finder which locates a <tt>NUL (0x00)</tt> byte.
+ * Index finder which matches the byte at the index against a set of bytes,
+ * so it can scan the contiguous bytes in bulk.
  */
-class ChannelBufferIndexNullFinder : public ChannelBufferIndexFinder {
+class ChannelBufferByteSetFinder : public ChannelBufferIndexFinder {
 public:
+    ChannelBufferByteSetFinder(const ByteScanner::ByteSet& set) : set(set) {}
+
     bool find(const ChannelBuffer& buffer, int guessedIndex) const {
-        return buffer.getByte(guessedIndex) == 0;
+        return set.matches(buffer.getByte(guessedIndex));
+    }
+
+    bool isByteFinder() const {
+        return true;
+    }
+
+    int findFirst(const char* bytes, int length) const {
+        return ByteScanner::findFirst(bytes, length, set);
+    }
+
+    int findLast(const char* bytes, int length) const {
+        return ByteScanner::findLast(bytes, length, set);
     }
+
+private:
+    ByteScanner::ByteSet set;
+};
+
+/**
+ * Index finder which locates a <tt>NUL (0x00)</tt> byte.
+ */
+class ChannelBufferIndexNullFinder : public ChannelBufferByteSetFinder {
+public:
+    ChannelBufferIndexNullFinder()
+        : ChannelBufferByteSetFinder(ByteScanner::ByteSet('\0')) {}
 };
 
 /**
  * Index finder which locates a non-<tt>NUL (0x00)</tt> byte.
  */
-class ChannelBufferIndexNotNulFinder : public ChannelBufferIndexFinder {
+class ChannelBufferIndexNotNulFinder : public ChannelBufferByteSetFinder {
 public:
-    bool find(const ChannelBuffer& buffer, int guessedIndex) const {
-        return buffer.getByte(guessedIndex) != 0;
-    }
+    ChannelBufferIndexNotNulFinder()
+        : ChannelBufferByteSetFinder(ByteScanner::ByteSet('\0', true)) {}
 };
 
 /**
  * Index finder which locates a <tt>CR ('\r')</tt> byte.
  */
-class ChannelBufferIndexCrFinder : public ChannelBufferIndexFinder {
+class ChannelBufferIndexCrFinder : public ChannelBufferByteSetFinder {
 public:
-    bool find(const ChannelBuffer& buffer, int guessedIndex) const {
-        return buffer.getByte(guessedIndex) == '\r';
-    }
+    ChannelBufferIndexCrFinder()
+        : ChannelBufferByteSetFinder(ByteScanner::ByteSet('\r')) {}
 };
 
 /**
  * Index finder which locates a non-<tt>CR ('\r')</tt> byte.
  */
-class ChannelBufferIndexNotCrFinder : public ChannelBufferIndexFinder {
+class ChannelBufferIndexNotCrFinder : public ChannelBufferByteSetFinder {
 public:
-    bool find(const ChannelBuffer& buffer, int guessedIndex) const {
-        return buffer.getByte(guessedIndex) != '\r';
-    }
+    ChannelBufferIndexNotCrFinder()
+        : ChannelBufferByteSetFinder(ByteScanner::ByteSet('\r', true)) {}
 };
 
 /**
  * Index finder which locates a <tt>LF ('\n')</tt> byte.
  */
-class ChannelBufferIndexLfFinder : public ChannelBufferIndexFinder {
+class ChannelBufferIndexLfFinder : public ChannelBufferByteSetFinder {
 public:
-    bool find(const ChannelBuffer& buffer, int guessedIndex) const {
-        return buffer.getByte(guessedIndex) == '\n';
-    }
+    ChannelBufferIndexLfFinder()
+        : ChannelBufferByteSetFinder(ByteScanner::ByteSet('\n')) {}
 };
 
 /**
  * Index finder which locates a non-<tt>LF ('\n')</tt> byte.
  */
-class ChannelBufferIndexNotLfFinder : public ChannelBufferIndexFinder {
+class ChannelBufferIndexNotLfFinder : public ChannelBufferByteSetFinder {
 public:
-    bool find(const ChannelBuffer& buffer, int guessedIndex) const {
-        return buffer.getByte(guessedIndex) != '\n';
-    }
+    ChannelBufferIndexNotLfFinder()
+        : ChannelBufferByteSetFinder(ByteScanner::ByteSet('\n', true)) {}
 };
 
 /**
  * Index finder which locates a <tt>CR ('\r')</tt> or <tt>LF ('\n')</tt>.
  */
-class ChannelBufferIndexCrLfFinder : public ChannelBufferIndexFinder {
+class ChannelBufferIndexCrLfFinder : public ChannelBufferByteSetFinder {
 public:
-    bool find(const ChannelBuffer& buffer, int guessedIndex) const {
-        boost::int8_t b = buffer.getByte(guessedIndex);
-        return b == '\r' || b == '\n';
-    }
+    ChannelBufferIndexCrLfFinder()
+        : ChannelBufferByteSetFinder(ByteScanner::ByteSet('\r', '\n')) {}
 };
 
 /**
  * Index finder which locates a byte which is neither a <tt>CR ('\r')</tt>
  * nor a <tt>LF ('\n')</tt>.
  */
-class ChannelBufferIndexNotCrLfFinder : public ChannelBufferIndexFinder {
+class ChannelBufferIndexNotCrLfFinder : public ChannelBufferByteSetFinder {
 public:
-    bool find(const ChannelBuffer& buffer, int guessedIndex) const {
-        boost::int8_t b = buffer.getByte(guessedIndex);
-        return b != '\r' && b != '\n';
-    }
+    ChannelBufferIndexNotCrLfFinder()
+        : ChannelBufferByteSetFinder(ByteScanner::ByteSet('\r', '\n', true)) {}
 };
 
 /**
  * Index finder which locates a linear whitespace
  * (<tt>' '</tt> and <tt>'\t'</tt>).
  */
-class ChannelBufferIndexLinearWhitespaceFinder : public ChannelBufferIndexFinder {
+class ChannelBufferIndexLinearWhitespaceFinder : public ChannelBufferByteSetFinder {
 public:
-    bool find(const ChannelBuffer& buffer, int guessedIndex) const {
-        boost::int8_t b = buffer.getByte(guessedIndex);
-        return b == ' ' || b == '\t';
-    }
+    ChannelBufferIndexLinearWhitespaceFinder()
+        : ChannelBufferByteSetFinder(ByteScanner::ByteSet(' ', '\t')) {}
 };
 
 /**
  * Index finder which locates a byte which is not a linear whitespace
  * (neither <tt>' '</tt> nor <tt>'\t'</tt>).
  */
-class ChannelBufferIndexNotLinearWhitespaceFinder : public ChannelBufferIndexFinder {
+class ChannelBufferIndexNotLinearWhitespaceFinder : public ChannelBufferByteSetFinder {
 public:
-    bool find(const ChannelBuffer& buffer, int guessedIndex) const {
-        boost::int8_t b = buffer.getByte(guessedIndex);
-        return b != ' ' && b != '\t';
-    }
+    ChannelBufferIndexNotLinearWhitespaceFinder()
+        : ChannelBufferByteSetFinder(ByteScanner::ByteSet(' ', '\t', true)) {}
 };
 
 static ChannelBufferIndexNullFinder nullFinder;
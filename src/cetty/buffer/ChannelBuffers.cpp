@@ -14,6 +14,7 @@
  * under the License.
  */
 
+#include <algorithm>
 #include <boost/integer.hpp>
 
 #include "cetty/buffer/ChannelBuffers.h"
@@ -29,10 +30,12 @@
 #include "cetty/buffer/ChannelBufferIndexFinder.h"
 
 #include "cetty/util/Exception.h"
+#include "cetty/util/internal/ByteScanner.h"
 
 namespace cetty { namespace buffer {
 
 using namespace cetty::util;
+using namespace cetty::util::internal;
 
 ChannelBufferPtr ChannelBuffers::EMPTY_BUFFER = 
                                     ChannelBufferPtr(new BigEndianHeapChannelBuffer(0));
@@ -612,15 +615,88 @@ ChannelBufferPtr ChannelBuffers::unmodifiableBuffer(const ChannelBufferPtr& buff
     return ChannelBufferPtr(new ReadOnlyChannelBuffer(buffer));
 }
 
-int ChannelBuffers::firstIndexOf( const ChannelBuffer& buffer, int fromIndex, int toIndex, const ChannelBufferIndexFinder& indexFinder )
-{
-    fromIndex = std::max(fromIndex, 0);
-    if (fromIndex >= toIndex || buffer.capacity() == 0) {
-        return -1;
+/**
+ * Matches the bytes equal to a value.
+ */
+class ByteValueMatcher {
+public:
+    ByteValueMatcher(boost::int8_t value) : value(value) {}
+
+    bool scannable() const { return true; }
+
+    bool match(const ChannelBuffer& buffer, int index) const {
+        return buffer.getByte(index) == value;
+    }
+
+    int first(const char* bytes, int length) const {
+        return ByteScanner::findFirst(bytes, length, static_cast<char>(value));
+    }
+
+    int last(const char* bytes, int length) const {
+        return ByteScanner::findLast(bytes, length, static_cast<char>(value));
+    }
+
+private:
+    boost::int8_t value;
+};
+
+/**
+ * Matches the indexes accepted by a {@link ChannelBufferIndexFinder}.
+ */
+class IndexFinderMatcher {
+public:
+    IndexFinderMatcher(const ChannelBufferIndexFinder& finder) : finder(finder) {}
+
+    bool scannable() const { return finder.isByteFinder(); }
+
+    bool match(const ChannelBuffer& buffer, int index) const {
+        return finder.find(buffer, index);
+    }
+
+    int first(const char* bytes, int length) const {
+        return finder.findFirst(bytes, length);
+    }
+
+    int last(const char* bytes, int length) const {
+        return finder.findLast(bytes, length);
+    }
+
+private:
+    const ChannelBufferIndexFinder& finder;
+};
+
+/**
+ * Scans [fromIndex, toIndex) region by region, and falls back to check the
+ * indexes one by one where the buffer has no contiguous bytes.
+ */
+template<typename Matcher>
+static int scanFirst(const ChannelBuffer& buffer,
+                     int fromIndex,
+                     int toIndex,
+                     const Matcher& matcher) {
+    int i = fromIndex;
+
+    if (matcher.scannable()) {
+        ConstArray region;
+
+        while (i < toIndex) {
+            int start = buffer.getContiguousBytes(i, region);
+            if (start < 0) {
+                break;
+            }
+
+            int end = std::min(start + region.length(), toIndex);
+            int found = matcher.first(region.data() + (i - start), end - i);
+            if (found >= 0) {
+                return i + found;
+            }
+
+            i = end;
+        }
     }
 
-    for (int i = fromIndex; i < toIndex; i ++) {
-        if (indexFinder.find(buffer, i)) {
+    for (; i < toIndex; ++i) {
+        if (matcher.match(buffer, i)) {
             return i;
         }
     }
@@ -628,20 +704,62 @@ int ChannelBuffers::firstIndexOf( const ChannelBuffer& buffer, int fromIndex, in
     return -1;
 }
 
-int ChannelBuffers::firstIndexOf( const ChannelBuffer& buffer, int fromIndex, int toIndex, boost::int8_t value )
+/**
+ * Scans [toIndex, fromIndex) backward, the same way as scanFirst.
+ */
+template<typename Matcher>
+static int scanLast(const ChannelBuffer& buffer,
+                    int fromIndex,
+                    int toIndex,
+                    const Matcher& matcher) {
+    int i = fromIndex;
+
+    if (matcher.scannable()) {
+        ConstArray region;
+
+        while (i > toIndex) {
+            int start = buffer.getContiguousBytes(i - 1, region);
+            if (start < 0) {
+                break;
+            }
+
+            int begin = std::max(start, toIndex);
+            int found = matcher.last(region.data() + (begin - start), i - begin);
+            if (found >= 0) {
+                return begin + found;
+            }
+
+            i = begin;
+        }
+    }
+
+    for (--i; i >= toIndex; --i) {
+        if (matcher.match(buffer, i)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int ChannelBuffers::firstIndexOf( const ChannelBuffer& buffer, int fromIndex, int toIndex, const ChannelBufferIndexFinder& indexFinder )
 {
     fromIndex = std::max(fromIndex, 0);
     if (fromIndex >= toIndex || buffer.capacity() == 0) {
         return -1;
     }
 
-    for (int i = fromIndex; i < toIndex; ++i) {
-        if (buffer.getByte(i) == value) {
-            return i;
-        }
+    return scanFirst(buffer, fromIndex, toIndex, IndexFinderMatcher(indexFinder));
+}
+
+int ChannelBuffers::firstIndexOf( const ChannelBuffer& buffer, int fromIndex, int toIndex, boost::int8_t value )
+{
+    fromIndex = std::max(fromIndex, 0);
+    if (fromIndex >= toIndex || buffer.capacity() == 0) {
+        return -1;
     }
 
-    return -1;
+    return scanFirst(buffer, fromIndex, toIndex, ByteValueMatcher(value));
 }
 
 int ChannelBuffers::lastIndexOf( const ChannelBuffer& buffer, int fromIndex, int toIndex, const ChannelBufferIndexFinder& indexFinder )
@@ -651,13 +769,7 @@ int ChannelBuffers::lastIndexOf( const ChannelBuffer& buffer, int fromIndex, int
         return -1;
     }
 
-    for (int i = fromIndex - 1; i >= toIndex; i --) {
-        if (indexFinder.find(buffer, i)) {
-            return i;
-        }
-    }
-
-    return -1;
+    return scanLast(buffer, fromIndex, toIndex, IndexFinderMatcher(indexFinder));
 }
 
 int ChannelBuffers::lastIndexOf(const ChannelBuffer& buffer, int fromIndex, int toIndex, boost::int8_t value) {
@@ -666,13 +778,7 @@ int ChannelBuffers::lastIndexOf(const ChannelBuffer& buffer, int fromIndex, int
         return -1;
     }
 
-    for (int i = fromIndex - 1; i >= toIndex; --i) {
-        if (buffer.getByte(i) == value) {
-            return i;
-        }
-    }
-
-    return -1;
+    return scanLast(buffer, fromIndex, toIndex, ByteValueMatcher(value));
 }
 
 int ChannelBuffers::hashCode(const ChannelBuffer& buffer) {
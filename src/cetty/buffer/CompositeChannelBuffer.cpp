@@ -96,6 +96,18 @@ int CompositeChannelBuffer::arrayOffset() const {
     throw UnsupportedOperationException();
 }
 
+int CompositeChannelBuffer::getContiguousBytes(int index, ConstArray& bytes) const {
+    if (index < 0 || index >= capacity()) {
+        return -1;
+    }
+
+    int componentId = getComponentId(index);
+    int start = components[componentId]->getContiguousBytes(
+                    index - indices[componentId], bytes);
+
+    return start < 0 ? -1 : start + indices[componentId];
+}
+
 int CompositeChannelBuffer::capacity() const {
     return indices[components.size()];
 }
@@ -561,14 +573,36 @@ void CompositeChannelBuffer::readSlice(Array& array) {
 }
 
 void CompositeChannelBuffer::readSlice(GatheringBuffer& gathering) {
-    size_t i,j;
-    Array arry;
-    for (i = 0, j = components.size(); i < j; ++i) {
-        if (components[i]->readable()) {
-            components[i]->readSlice(arry);
-            gathering.append(arry.data(), arry.length());
+    int index = readerIdx;
+    if (index == writerIdx) {
+        return;
+    }
+
+    // append the readable region of every component in place, so a
+    // composite of any fan-out can be written with one gathering write.
+    int componentId = getComponentId(index);
+    while (index < writerIdx) {
+        const ChannelBufferPtr& s = components[componentId];
+        int adjustment = indices[componentId];
+        int localLength =
+            std::min(writerIdx, indices[componentId + 1]) - index;
+
+        if (localLength > 0) {
+            if (s->hasArray()) {
+                gathering.append(
+                    s->array().data(s->arrayOffset() + index - adjustment),
+                    localLength);
+            }
+            else {
+                s->slice(index - adjustment, localLength)->readSlice(gathering);
+            }
         }
+
+        index += localLength;
+        ++componentId;
     }
+
+    readerIdx = writerIdx;
 }
 
-}}
\ No newline at end of file
+}}
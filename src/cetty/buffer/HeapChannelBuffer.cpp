@@ -84,7 +84,7 @@ void HeapChannelBuffer::readableBytes(Array& array) {
 }
 
 void HeapChannelBuffer::writableBytes(Array& array) {
-    array.reset(this->arry.data(writerIdx), this->arry.length() - readerIdx);
+    array.reset(this->arry.data(writerIdx), this->arry.length() - writerIdx);
 }
 
 boost::int8_t HeapChannelBuffer::getByte(int index) const {
@@ -0,0 +1,502 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/buffer/PooledChannelBufferFactory.h"
+
+#include <new>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/detail/atomic_count.hpp>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/buffer/BigEndianHeapChannelBuffer.h"
+#include "cetty/buffer/LittleEndianHeapChannelBuffer.h"
+#include "cetty/util/Exception.h"
+#include "cetty/util/internal/MpscQueue.h"
+
+namespace cetty { namespace buffer {
+
+using namespace cetty::util;
+using namespace cetty::util::internal;
+
+/**
+ * The heap buffer living in a block of the {@link PooledChannelBufferFactory},
+ * which gives the block back to the factory instead of freeing it.
+ */
+template<typename HeapBuffer>
+class PooledHeapChannelBuffer : public HeapBuffer {
+public:
+    PooledHeapChannelBuffer(PooledChannelBufferFactory& pool, const Array& array)
+        : HeapBuffer(array, false), pool(pool) {
+        // a new buffer rather than a wrapped array, nothing to read.
+        this->setIndex(0, 0);
+    }
+
+    virtual ~PooledHeapChannelBuffer() {}
+
+    virtual ChannelBufferFactory& factory() const {
+        return pool;
+    }
+
+    static void* operator new(std::size_t, void* block) {
+        return block;
+    }
+
+    static void operator delete(void* buffer, void*) {
+        PooledChannelBufferFactory::release(buffer);
+    }
+
+    static void operator delete(void* buffer) {
+        PooledChannelBufferFactory::release(buffer);
+    }
+
+private:
+    PooledChannelBufferFactory& pool;
+};
+
+typedef PooledHeapChannelBuffer<BigEndianHeapChannelBuffer> PooledBigEndianBuffer;
+typedef PooledHeapChannelBuffer<LittleEndianHeapChannelBuffer> PooledLittleEndianBuffer;
+
+// keeps the buffer object and its bytes 16 bytes aligned.
+#define CETTY_BUFFER_POOLED_ALIGN(size) \
+    (((size) + 15) & ~static_cast<std::size_t>(15))
+
+static const std::size_t BUFFER_OBJECT_SIZE = CETTY_BUFFER_POOLED_ALIGN(
+    sizeof(PooledBigEndianBuffer) > sizeof(PooledLittleEndianBuffer) ?
+    sizeof(PooledBigEndianBuffer) : sizeof(PooledLittleEndianBuffer));
+
+/**
+ * The header of a block, followed by the buffer object and then its bytes.
+ */
+class PooledChannelBufferFactory::Block : public MpscQueueNode {
+public:
+    // NULL if the block is not pooled.
+    ThreadCache* owner;
+    Block* nextFree;
+    int sizeClassIndex;
+
+    static Block* allocate(int bytes) {
+        void* memory = ::operator new(HEADER_SIZE + BUFFER_OBJECT_SIZE + bytes);
+        return new (memory) Block;
+    }
+
+    static void free(Block* block) {
+        block->~Block();
+        ::operator delete(block);
+    }
+
+    static Block* of(void* buffer) {
+        return reinterpret_cast<Block*>(static_cast<char*>(buffer) - HEADER_SIZE);
+    }
+
+    void* buffer() {
+        return reinterpret_cast<char*>(this) + HEADER_SIZE;
+    }
+
+    char* bytes() {
+        return reinterpret_cast<char*>(this) + HEADER_SIZE + BUFFER_OBJECT_SIZE;
+    }
+
+private:
+    Block() : owner(NULL), nextFree(NULL), sizeClassIndex(-1) {}
+    ~Block() {}
+
+    static const std::size_t HEADER_SIZE;
+};
+
+const std::size_t PooledChannelBufferFactory::Block::HEADER_SIZE =
+    CETTY_BUFFER_POOLED_ALIGN(sizeof(PooledChannelBufferFactory::Block));
+
+/**
+ * The free lists of the blocks allocated by one thread.
+ *
+ * The cache is held by its thread and by every pooled block it has
+ * allocated, and is deleted with the last of them.  When the thread exits,
+ * the cache is orphaned: its free blocks are freed, and the blocks released
+ * later by the other threads are freed directly instead of being queued.
+ */
+class PooledChannelBufferFactory::ThreadCache : private boost::noncopyable {
+public:
+    ThreadCache(const PooledChannelBufferFactory& factory)
+        : factoryId(factory.id),
+          maxCachedCount(factory.maxCachedCount),
+          freeLists(factory.sizeClassCount, static_cast<Block*>(NULL)),
+          counts(factory.sizeClassCount, 0),
+          refs(1),
+          remoteFreeing(0),
+          orphaned(false) {
+    }
+
+    /**
+     * only called by the owner thread.
+     */
+    Block* allocate(int sizeClassIndex) {
+        if (NULL == freeLists[sizeClassIndex]) {
+            drainRemoteFrees();
+        }
+
+        Block* block = freeLists[sizeClassIndex];
+        if (block) {
+            freeLists[sizeClassIndex] = block->nextFree;
+            --counts[sizeClassIndex];
+        }
+        return block;
+    }
+
+    /**
+     * allocates a new block owned by the cache, only called by the owner
+     * thread.
+     */
+    Block* allocateNew(int sizeClass, int sizeClassIndex) {
+        Block* block = Block::allocate(sizeClass);
+        block->owner = this;
+        block->sizeClassIndex = sizeClassIndex;
+
+        refs.fetch_add(1, boost::memory_order_relaxed);
+        return block;
+    }
+
+    /**
+     * only called by the owner thread.
+     */
+    void free(Block* block) {
+        int index = block->sizeClassIndex;
+
+        if (counts[index] >= maxCachedCount) {
+            // the thread still holds the cache.
+            freeBlock(block);
+            return;
+        }
+
+        block->nextFree = freeLists[index];
+        freeLists[index] = block;
+        ++counts[index];
+    }
+
+    /**
+     * called by the other threads.
+     */
+    void freeRemotely(Block* block) {
+        // seq_cst against the store of the flag in orphan(), so either the
+        // owner waits for the push, or this thread sees the flag.
+        remoteFreeing.fetch_add(1);
+
+        if (orphaned.load()) {
+            remoteFreeing.fetch_sub(1);
+            freeBlock(block);
+            return;
+        }
+
+        remoteFrees.push(block);
+        remoteFreeing.fetch_sub(1);
+    }
+
+    /**
+     * Frees the cached blocks and the ones queued by the other threads,
+     * which are freed directly from now on.  Called once the owner thread
+     * will not use the cache any more, which still holds it.
+     */
+    void orphan() {
+        if (orphaned.exchange(true)) {
+            return;
+        }
+
+        while (remoteFreeing.load() != 0) {
+            boost::this_thread::yield();
+        }
+
+        MpscQueueNode* node;
+        while ((node = remoteFrees.pop()) != NULL) {
+            freeBlock(static_cast<Block*>(node));
+        }
+
+        for (std::size_t i = 0; i < freeLists.size(); ++i) {
+            while (freeLists[i]) {
+                Block* block = freeLists[i];
+                freeLists[i] = block->nextFree;
+                freeBlock(block);
+            }
+            counts[i] = 0;
+        }
+    }
+
+    /**
+     * Drops the reference of the thread or of a block, and deletes the
+     * cache if it was the last one.
+     */
+    void release() {
+        if (refs.fetch_sub(1, boost::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    int cachedCount() const {
+        int count = 0;
+        for (std::size_t i = 0; i < counts.size(); ++i) {
+            count += counts[i];
+        }
+        return count;
+    }
+
+    long getFactoryId() const {
+        return factoryId;
+    }
+
+    static void freeBlock(Block* block) {
+        ThreadCache* owner = block->owner;
+        Block::free(block);
+        owner->release();
+    }
+
+private:
+    ~ThreadCache() {}
+
+    void drainRemoteFrees() {
+        MpscQueueNode* node;
+        while ((node = remoteFrees.pop()) != NULL) {
+            free(static_cast<Block*>(node));
+        }
+    }
+
+private:
+    // by value, the factory may have been destroyed when a block of the
+    // cache is released.
+    long factoryId;
+    int maxCachedCount;
+
+    std::vector<Block*> freeLists;
+    std::vector<int> counts;
+
+    MpscQueue remoteFrees;
+
+    boost::atomic<long> refs;
+    boost::atomic<int> remoteFreeing;
+    boost::atomic<bool> orphaned;
+};
+
+static boost::detail::atomic_count factoryIds(0);
+
+ChannelBufferFactory& PooledChannelBufferFactory::getInstance() {
+    return getInstance(ByteOrder::BYTE_ORDER_BIG);
+}
+
+ChannelBufferFactory& PooledChannelBufferFactory::getInstance(ByteOrder endianness) {
+    static PooledChannelBufferFactory* instanceBE =
+        new PooledChannelBufferFactory(ByteOrder::BYTE_ORDER_BIG);
+    static PooledChannelBufferFactory* instanceLE =
+        new PooledChannelBufferFactory(ByteOrder::BYTE_ORDER_LITTLE);
+
+    if (endianness == ByteOrder::BYTE_ORDER_BIG) {
+        return *instanceBE;
+    }
+    else if (endianness == ByteOrder::BYTE_ORDER_LITTLE) {
+        return *instanceLE;
+    }
+    else {
+        throw IllegalStateException("Should not reach here");
+    }
+}
+
+boost::thread_specific_ptr<PooledChannelBufferFactory::ThreadCacheList>&
+PooledChannelBufferFactory::threadCaches() {
+    static boost::thread_specific_ptr<ThreadCacheList>* caches =
+        new boost::thread_specific_ptr<ThreadCacheList>(&orphanThreadCaches);
+    return *caches;
+}
+
+void PooledChannelBufferFactory::orphanThreadCaches(ThreadCacheList* list) {
+    for (std::size_t i = 0; i < list->size(); ++i) {
+        ThreadCache* cache = (*list)[i].second;
+        cache->orphan();
+        cache->release();
+    }
+    delete list;
+}
+
+PooledChannelBufferFactory::PooledChannelBufferFactory()
+    : AbstractChannelBufferFactory() {
+    init(DEFAULT_MAX_SIZE_CLASS, DEFAULT_MAX_CACHED_COUNT);
+}
+
+PooledChannelBufferFactory::PooledChannelBufferFactory(ByteOrder defaultOrder)
+    : AbstractChannelBufferFactory(defaultOrder) {
+    init(DEFAULT_MAX_SIZE_CLASS, DEFAULT_MAX_CACHED_COUNT);
+}
+
+PooledChannelBufferFactory::PooledChannelBufferFactory(ByteOrder defaultOrder,
+                                                       int maxSizeClass,
+                                                       int maxCachedCount)
+    : AbstractChannelBufferFactory(defaultOrder) {
+    init(maxSizeClass, maxCachedCount);
+}
+
+PooledChannelBufferFactory::~PooledChannelBufferFactory() {
+    // the caches of the other threads are orphaned when they exit.
+    ThreadCacheList* list = threadCaches().get();
+    if (NULL == list) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < list->size(); ++i) {
+        if ((*list)[i].first == id) {
+            ThreadCache* cache = (*list)[i].second;
+            list->erase(list->begin() + i);
+
+            cache->orphan();
+            cache->release();
+            break;
+        }
+    }
+}
+
+void PooledChannelBufferFactory::init(int maxSizeClass, int maxCachedCount) {
+    if (maxSizeClass < 0) {
+        throw InvalidArgumentException("maxSizeClass: is less then zero");
+    }
+    if (maxCachedCount < 0) {
+        throw InvalidArgumentException("maxCachedCount: is less then zero");
+    }
+
+    this->maxCachedCount = maxCachedCount;
+    this->maxSizeClass = 0;
+    this->sizeClassCount = 0;
+    this->id = ++factoryIds;
+
+    if (maxSizeClass > 0) {
+        this->maxSizeClass = sizeClassOf(maxSizeClass);
+        for (int size = MIN_SIZE_CLASS; size <= this->maxSizeClass; size <<= 1) {
+            ++sizeClassCount;
+        }
+    }
+}
+
+int PooledChannelBufferFactory::sizeClassOf(int capacity) {
+    static const int MAX_SIZE_CLASS = 1 << 30;
+
+    int sizeClass = MIN_SIZE_CLASS;
+    while (sizeClass < capacity && sizeClass < MAX_SIZE_CLASS) {
+        sizeClass <<= 1;
+    }
+    return sizeClass;
+}
+
+ChannelBufferPtr PooledChannelBufferFactory::getBuffer(ByteOrder order, int capacity) {
+    if (capacity < 0) {
+        throw InvalidArgumentException("capacity: is less then zero");
+    }
+    if (capacity == 0) {
+        return ChannelBuffers::buffer(order, 0);
+    }
+
+    Block* block = NULL;
+
+    if (capacity <= maxSizeClass) {
+        int sizeClass = sizeClassOf(capacity);
+        int index = 0;
+        while ((MIN_SIZE_CLASS << index) < sizeClass) {
+            ++index;
+        }
+
+        ThreadCache& cache = threadCache();
+        block = cache.allocate(index);
+
+        if (NULL == block) {
+            block = cache.allocateNew(sizeClass, index);
+        }
+    }
+    else {
+        block = Block::allocate(capacity);
+    }
+
+    Array array(block->bytes(), capacity);
+
+    if (order == ByteOrder::BYTE_ORDER_LITTLE) {
+        return ChannelBufferPtr(
+                   new (block->buffer()) PooledLittleEndianBuffer(*this, array));
+    }
+    else {
+        return ChannelBufferPtr(
+                   new (block->buffer()) PooledBigEndianBuffer(*this, array));
+    }
+}
+
+ChannelBufferPtr PooledChannelBufferFactory::getBuffer(ByteOrder order,
+                                                       const Array& array,
+                                                       int offset,
+                                                       int length) {
+    return ChannelBuffers::wrappedBuffer(order, array, offset, length);
+}
+
+int PooledChannelBufferFactory::getCachedCount() const {
+    ThreadCache* cache = currentThreadCache();
+    return cache ? cache->cachedCount() : 0;
+}
+
+PooledChannelBufferFactory::ThreadCache*
+PooledChannelBufferFactory::currentThreadCache() const {
+    return findThreadCache(id);
+}
+
+PooledChannelBufferFactory::ThreadCache*
+PooledChannelBufferFactory::findThreadCache(long factoryId) {
+    ThreadCacheList* list = threadCaches().get();
+    if (NULL == list) {
+        return NULL;
+    }
+
+    for (std::size_t i = 0; i < list->size(); ++i) {
+        if ((*list)[i].first == factoryId) {
+            return (*list)[i].second;
+        }
+    }
+    return NULL;
+}
+
+PooledChannelBufferFactory::ThreadCache&
+PooledChannelBufferFactory::threadCache() const {
+    ThreadCache* cache = currentThreadCache();
+    if (cache) {
+        return *cache;
+    }
+
+    ThreadCacheList* list = threadCaches().get();
+    if (NULL == list) {
+        list = new ThreadCacheList;
+        threadCaches().reset(list);
+    }
+
+    cache = new ThreadCache(*this);
+    list->push_back(std::make_pair(id, cache));
+
+    return *cache;
+}
+
+void PooledChannelBufferFactory::release(void* buffer) {
+    Block* block = Block::of(buffer);
+    ThreadCache* owner = block->owner;
+
+    if (NULL == owner) {
+        Block::free(block);
+    }
+    else if (findThreadCache(owner->getFactoryId()) == owner) {
+        owner->free(block);
+    }
+    else {
+        owner->freeRemotely(block);
+    }
+}
+
+}}
@@ -15,7 +15,11 @@
  */
 
 #include "cetty/buffer/SlicedChannelBuffer.h"
+
+#include <algorithm>
+
 #include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/buffer/GatheringBuffer.h"
 
 #include "cetty/util/Integer.h"
 #include "cetty/util/Exception.h"
@@ -143,6 +147,24 @@ int SlicedChannelBuffer::setBytes(int index, InputStream& in, int length) {
     return buffer->setBytes(index + adjustment, in, length);
 }
 
+int SlicedChannelBuffer::getContiguousBytes(int index, ConstArray& bytes) const {
+    if (index < 0 || index >= capacity()) {
+        return -1;
+    }
+
+    ConstArray region;
+    int start = buffer->getContiguousBytes(index + adjustment, region);
+    if (start < 0) {
+        return -1;
+    }
+
+    // clip the region of the underlying buffer to this slice.
+    int begin = std::max(start, adjustment);
+    int end = std::min(start + region.length(), adjustment + length);
+    bytes = ConstArray(region.data() + (begin - start), end - begin);
+    return begin - adjustment;
+}
+
 void SlicedChannelBuffer::checkIndex(int index) const {
     if (index < 0 || index >= capacity()) {
         throw RangeException("");
@@ -162,4 +184,30 @@ void SlicedChannelBuffer::checkIndex(int startIndex, int length) const {
     }
 }
 
+void SlicedChannelBuffer::readSlice(Array& array) {
+    if (hasArray()) {
+        array.reset(buffer->array().data(arrayOffset() + readerIdx),
+                    writerIdx - readerIdx);
+    }
+    else {
+        array.reset(NULL, 0);
+    }
+    readerIdx = writerIdx;
+}
+
+void SlicedChannelBuffer::readSlice(GatheringBuffer& gathering) {
+    int length = writerIdx - readerIdx;
+    if (length <= 0) {
+        return;
+    }
+
+    if (hasArray()) {
+        gathering.append(buffer->array().data(arrayOffset() + readerIdx), length);
+    }
+    else {
+        buffer->slice(adjustment + readerIdx, length)->readSlice(gathering);
+    }
+    readerIdx = writerIdx;
+}
+
 }}
\ No newline at end of file
@@ -15,6 +15,9 @@
  */
 
 #include "cetty/buffer/TruncatedChannelBuffer.h"
+
+#include <algorithm>
+
 #include "cetty/buffer/ChannelBuffers.h"
 #include "cetty/util/Integer.h"
 #include "cetty/util/Exception.h"
@@ -146,6 +149,21 @@ int TruncatedChannelBuffer::setBytes(int index, InputStream& in, int length) {
     return buffer->setBytes(index, in, length);
 }
 
+int TruncatedChannelBuffer::getContiguousBytes(int index, ConstArray& bytes) const {
+    if (index < 0 || index >= capacity()) {
+        return -1;
+    }
+
+    ConstArray region;
+    int start = buffer->getContiguousBytes(index, region);
+    if (start < 0) {
+        return -1;
+    }
+
+    bytes = ConstArray(region.data(), std::min(region.length(), length - start));
+    return start;
+}
+
 void TruncatedChannelBuffer::checkIndex(int index) const {
     if (index < 0 || index >= capacity()) {
         throw RangeException("");
@@ -15,9 +15,11 @@
  */
 
 #include <boost/crc.hpp>
+#include <boost/bind.hpp>
 
 #include "cetty/channel/AbstractChannel.h"
 #include "cetty/channel/ChannelState.h"
+#include "cetty/channel/ChannelEventLoop.h"
 #include "cetty/channel/DownstreamMessageEvent.h"
 #include "cetty/channel/DownstreamChannelStateEvent.h"
 
@@ -73,6 +75,22 @@ std::string AbstractChannel::toString() const {
     return buf;
 }
 
+void AbstractChannel::release() {
+    if (--retainCount != 0) {
+        return;
+    }
+
+    // the last release may come from another thread, or while the channel
+    // is still on the call stack.
+    ChannelEventLoop* eventLoop = getEventLoop();
+    if (eventLoop) {
+        eventLoop->execute(boost::bind(&AbstractChannel::deleteChannel, this));
+    }
+    else {
+        delete this;
+    }
+}
+
 ChannelFuturePtr AbstractChannel::write(const ChannelMessage& message,
                                         bool withFuture /*= true*/) {
     return AbstractChannel::write(message, getRemoteAddress(), withFuture);
@@ -81,11 +99,7 @@ ChannelFuturePtr AbstractChannel::write(const ChannelMessage& message,
 ChannelFuturePtr AbstractChannel::write(const ChannelMessage& message,
                                         const SocketAddress& remoteAddress,
                                         bool withFuture /*= true*/) {
-    ChannelFuturePtr future;
-
-    if (withFuture) {
-        future = Channels::future(*this);
-    }
+    ChannelFuturePtr future = withFuture ? Channels::future(*this) : voidFuture;
 
     pipeline->sendDownstream(DownstreamMessageEvent(*this, future, message, remoteAddress));
 
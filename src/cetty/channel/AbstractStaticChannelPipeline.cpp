@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/AbstractStaticChannelPipeline.h"
+
+#include "cetty/channel/ChannelEvent.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/ExceptionEvent.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/ChannelPipelineException.h"
+#include "cetty/channel/ChannelHandlerLifeCycleException.h"
+#include "cetty/channel/LifeCycleAwareChannelHandler.h"
+
+#include "cetty/logging/InternalLogger.h"
+#include "cetty/logging/InternalLoggerFactory.h"
+
+#include "cetty/util/Exception.h"
+
+namespace cetty { namespace channel {
+
+using namespace cetty::util;
+
+AbstractStaticChannelPipeline::DiscardingChannelSink AbstractStaticChannelPipeline::discardingSink;
+InternalLogger* AbstractStaticChannelPipeline::logger = InternalLoggerFactory::getInstance("StaticChannelPipeline");
+
+void AbstractStaticChannelPipeline::DiscardingChannelSink::eventSunk(const ChannelPipeline& pipeline, const ChannelEvent& e) {
+    logger->warn(std::string("Not attached yet; discarding: ") + e.toString());
+}
+
+void AbstractStaticChannelPipeline::DiscardingChannelSink::writeRequested(const ChannelPipeline& pipeline, const MessageEvent& e) {
+    logger->warn(std::string("Not attached yet; discarding: ") + e.toString());
+}
+
+void AbstractStaticChannelPipeline::DiscardingChannelSink::stateChangeRequested(const ChannelPipeline& pipeline, const ChannelStateEvent& e) {
+    logger->warn(std::string("Not attached yet; discarding: ") + e.toString());
+}
+
+void AbstractStaticChannelPipeline::DiscardingChannelSink::exceptionCaught(
+                                                        const ChannelPipeline& pipeline,
+                                                        const ChannelEvent& e,
+                                                        const ChannelPipelineException& cause) {
+    cause.rethrow();
+}
+
+AbstractStaticChannelPipeline::AbstractStaticChannelPipeline()
+    : channel(NULL), sink(&discardingSink) {
+}
+
+Channel& AbstractStaticChannelPipeline::getChannel() const {
+    if (this->channel == NULL) {
+        throw IllegalStateException("channel has not been attached");
+    }
+
+    return *(this->channel);
+}
+
+ChannelSink& AbstractStaticChannelPipeline::getSink() const {
+    return *(this->sink);
+}
+
+void AbstractStaticChannelPipeline::attach(Channel* channel, ChannelSink* sink) {
+    if (channel == NULL) {
+        throw NullPointerException("channel");
+    }
+    if (sink == NULL) {
+        throw NullPointerException("sink");
+    }
+
+    if (this->channel != NULL || this->sink != &discardingSink) {
+        throw IllegalStateException("attached already");
+    }
+
+    this->channel = channel;
+    this->sink = sink;
+}
+
+bool AbstractStaticChannelPipeline::isAttached() const {
+    return sink != &discardingSink;
+}
+
+void AbstractStaticChannelPipeline::addFirst(const std::string& name, const ChannelHandlerPtr& handler) {
+    throw UnsupportedOperationException("the handlers of StaticChannelPipeline are fixed.");
+}
+
+void AbstractStaticChannelPipeline::addLast(const std::string& name, const ChannelHandlerPtr& handler) {
+    throw UnsupportedOperationException("the handlers of StaticChannelPipeline are fixed.");
+}
+
+void AbstractStaticChannelPipeline::addBefore(const std::string& baseName, const std::string& name, const ChannelHandlerPtr& handler) {
+    throw UnsupportedOperationException("the handlers of StaticChannelPipeline are fixed.");
+}
+
+void AbstractStaticChannelPipeline::addAfter(const std::string& baseName, const std::string& name, const ChannelHandlerPtr& handler) {
+    throw UnsupportedOperationException("the handlers of StaticChannelPipeline are fixed.");
+}
+
+void AbstractStaticChannelPipeline::remove(const ChannelHandlerPtr& handler) {
+    throw UnsupportedOperationException("the handlers of StaticChannelPipeline are fixed.");
+}
+
+ChannelHandlerPtr AbstractStaticChannelPipeline::remove(const std::string& name) {
+    throw UnsupportedOperationException("the handlers of StaticChannelPipeline are fixed.");
+}
+
+ChannelHandlerPtr AbstractStaticChannelPipeline::removeFirst() {
+    throw UnsupportedOperationException("the handlers of StaticChannelPipeline are fixed.");
+}
+
+ChannelHandlerPtr AbstractStaticChannelPipeline::removeLast() {
+    throw UnsupportedOperationException("the handlers of StaticChannelPipeline are fixed.");
+}
+
+void AbstractStaticChannelPipeline::replace(const ChannelHandlerPtr& oldHandler, const std::string& newName, const ChannelHandlerPtr& newHandler) {
+    throw UnsupportedOperationException("the handlers of StaticChannelPipeline are fixed.");
+}
+
+ChannelHandlerPtr AbstractStaticChannelPipeline::replace(const std::string& oldName, const std::string& newName, const ChannelHandlerPtr& newHandler) {
+    throw UnsupportedOperationException("the handlers of StaticChannelPipeline are fixed.");
+}
+
+ChannelHandlerPtr AbstractStaticChannelPipeline::getFirst() const {
+    if (contexts.empty()) {
+        return ChannelHandlerPtr();
+    }
+    return contexts.front()->getHandler();
+}
+
+ChannelHandlerPtr AbstractStaticChannelPipeline::getLast() const {
+    if (contexts.empty()) {
+        return ChannelHandlerPtr();
+    }
+    return contexts.back()->getHandler();
+}
+
+ChannelHandlerPtr AbstractStaticChannelPipeline::get(const std::string& name) const {
+    ChannelHandlerContext* ctx = getContext(name);
+    if (ctx == NULL) {
+        return ChannelHandlerPtr();
+    }
+    return ctx->getHandler();
+}
+
+ChannelHandlerContext* AbstractStaticChannelPipeline::getContext(const std::string& name) const {
+    for (size_t i = 0; i < contexts.size(); ++i) {
+        if (contexts[i]->getName() == name) {
+            return contexts[i];
+        }
+    }
+    return NULL;
+}
+
+ChannelHandlerContext* AbstractStaticChannelPipeline::getContext(const ChannelHandlerPtr& handler) const {
+    if (!handler) {
+        throw NullPointerException("handler");
+    }
+
+    for (size_t i = 0; i < contexts.size(); ++i) {
+        if (contexts[i]->getHandler() == handler) {
+            return contexts[i];
+        }
+    }
+    return NULL;
+}
+
+ChannelPipeline::ChannelHandlers AbstractStaticChannelPipeline::toMap() const {
+    ChannelHandlers map;
+
+    for (size_t i = 0; i < contexts.size(); ++i) {
+        map.push_back(std::make_pair(contexts[i]->getName(),
+                                     contexts[i]->getHandler()));
+    }
+    return map;
+}
+
+std::string AbstractStaticChannelPipeline::toString() const {
+    std::string buf("StaticChannelPipeline {");
+    buf.reserve(1024);
+
+    for (size_t i = 0; i < contexts.size(); ++i) {
+        if (i > 0) {
+            buf.append(", ");
+        }
+        buf.append("(");
+        buf.append(contexts[i]->getName());
+        buf.append(" = ");
+        buf.append(contexts[i]->getHandler()->toString());
+        buf.append(")");
+    }
+    buf.append(" }");
+    return buf;
+}
+
+void AbstractStaticChannelPipeline::notifyHandlerException(const ChannelEvent& evt, const Exception& e) {
+    const ExceptionEvent* exceptionEvt = dynamic_cast<const ExceptionEvent*>(&evt);
+    if (exceptionEvt) {
+        logger->warn(
+                "An exception was thrown by a user handler \
+                 while handling an exception event ( ... )", e);
+        return;
+    }
+
+    ChannelPipelineException pe(e.getMessage(), e.getCode());
+    try {
+        sink->exceptionCaught(*this, evt, pe);
+    }
+    catch (const Exception& e1) {
+        logger->warn("An exception was thrown by an exception handler.", e1);
+    }
+}
+
+void AbstractStaticChannelPipeline::addContext(ChannelHandlerContext* ctx) {
+    LifeCycleAwareChannelHandler* h =
+        dynamic_cast<LifeCycleAwareChannelHandler*>(ctx->getHandler().get());
+
+    if (h) {
+        try {
+            h->beforeAdd(*ctx);
+        }
+        catch (const Exception& e) {
+            throw ChannelHandlerLifeCycleException(
+                ".beforeAdd() has thrown an exception; not adding.", e);
+        }
+    }
+
+    contexts.push_back(ctx);
+
+    if (h) {
+        try {
+            h->afterAdd(*ctx);
+        }
+        catch (const Exception& e) {
+            // the handler can not be removed from a static pipeline.
+            throw ChannelHandlerLifeCycleException(
+                ".afterAdd() has thrown an exception.", e);
+        }
+    }
+}
+
+}}
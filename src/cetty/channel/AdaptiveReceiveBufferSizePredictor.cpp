@@ -15,6 +15,8 @@
  */
 
 #include "cetty/channel/AdaptiveReceiveBufferSizePredictor.h"
+
+#include <boost/thread/once.hpp>
 #include "cetty/util/Exception.h"
 
 namespace cetty { namespace channel {
@@ -58,8 +60,12 @@ void AdaptiveReceiveBufferSizePredictor::previousReceiveBufferSize(int previousR
     }
 }
 
+static boost::once_flag sizeTableInited = BOOST_ONCE_INIT;
+
 void AdaptiveReceiveBufferSizePredictor::init(int minimum, int initial, int maximum) {
-    initSizeTable();
+    // the predictors are created by the channels in all the I/O threads.
+    boost::call_once(&AdaptiveReceiveBufferSizePredictor::initSizeTable,
+                     sizeTableInited);
 
     int minIndex = getSizeTableIndex(minimum);
     if (SIZE_TABLE[minIndex] < minimum) {
@@ -77,12 +83,10 @@ void AdaptiveReceiveBufferSizePredictor::init(int minimum, int initial, int maxi
 
     index = getSizeTableIndex(initial);
     nextReceiveBuffSz = SIZE_TABLE[index];
+    decreaseNow = false;
 }
 
 void AdaptiveReceiveBufferSizePredictor::initSizeTable() {
-    static bool isInited = false;
-    if (isInited) return;
-
     std::vector<int> sizeTable;
     for (int i = 1; i <= 8; i ++) {
         sizeTable.push_back(i);
@@ -107,8 +111,6 @@ void AdaptiveReceiveBufferSizePredictor::initSizeTable() {
     for (int i = 0; i < SIZE_TABLE_CNT; ++i) {
         SIZE_TABLE[i] = sizeTable.at(i);
     }
-
-    isInited = true;
 }
 
 int AdaptiveReceiveBufferSizePredictor::getSizeTableIndex(int size) {
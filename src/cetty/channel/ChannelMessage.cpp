@@ -21,6 +21,7 @@ namespace cetty { namespace channel {
 ChannelMessage ChannelMessage::EMPTY_MESSAGE;
 std::string ChannelMessage::EMPTY_STRING;
 std::wstring ChannelMessage::EMPTY_WSTRING;
+ChannelBufferPtr ChannelMessage::EMPTY_BUFFER;
 std::vector<ChannelBufferPtr> ChannelMessage::EMPTY_BUFFERS;
 std::vector<ChannelMessage> ChannelMessage::EMPTY_MESSAGES;
 
@@ -27,7 +27,7 @@
 #include "cetty/channel/DownstreamChannelStateEvent.h"
 #include "cetty/channel/UpstreamMessageEvent.h"
 #include "cetty/channel/DownstreamMessageEvent.h"
-#include "cetty/channel/DefaultChannelFuture.h"
+#include "cetty/channel/LightweightChannelFuture.h"
 #include "cetty/channel/DefaultChannelPipeline.h"
 #include "cetty/channel/DefaultChildChannelStateEvent.h"
 #include "cetty/channel/DefaultWriteCompletionEvent.h"
@@ -129,7 +129,7 @@ ChannelPipelineFactoryPtr Channels::pipelineFactory(ChannelPipeline* pipeline )
 }
 
 ChannelFuturePtr Channels::future(Channel& channel, bool cancellable) {
-    return ChannelFuturePtr(new DefaultChannelFuture(channel, cancellable));
+    return ChannelFuturePtr(new LightweightChannelFuture(channel, cancellable));
 }
 
 ChannelFuturePtr Channels::failedFuture(Channel& channel, const Exception& cause) {
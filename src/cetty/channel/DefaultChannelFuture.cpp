@@ -334,7 +334,7 @@ bool DefaultChannelFuture::cancel() {
     return true;
 }
 
-bool DefaultChannelFuture::setProgress(int amount, int current, int total) {
+bool DefaultChannelFuture::setProgress(boost::int64_t amount, boost::int64_t current, boost::int64_t total) {
     std::list<ChannelFutureProgressListener*> tmplist;
 
     {
@@ -476,7 +476,7 @@ void DefaultChannelFuture::notifyListener(const ListenerFunction& l) {
     }
 }
 
-void DefaultChannelFuture::notifyProgressListener(ChannelFutureProgressListener* l, int amount, int current, int total) {
+void DefaultChannelFuture::notifyProgressListener(ChannelFutureProgressListener* l, boost::int64_t amount, boost::int64_t current, boost::int64_t total) {
     if (NULL == l) return;
 
     try {
@@ -45,7 +45,10 @@ DefaultChannelPipeline::DefaultChannelHandlerContext::DefaultChannelHandlerConte
                           canHandleUps(false),
                           canHandleDowns(false),
                           name(name),
-                          handler(handler) {
+                          handler(handler),
+                          upstreamHandler(NULL),
+                          downstreamHandler(NULL),
+                          attachment(NULL) {
     upstreamHandler = dynamic_cast<ChannelUpstreamHandler*>(handler.get());
     if (upstreamHandler) {
         this->canHandleUps = true;
@@ -566,13 +569,16 @@ DefaultChannelPipeline::replace(DefaultChannelHandlerContext* ctx,
     ChannelHandlerPtr replacedHandle;
     if (!newHandler) return replacedHandle;
 
+    // removeFirst() and removeLast() delete the context.
     if (ctx == head) {
         replacedHandle = removeFirst();
         addFirst(newName, newHandler);
+        return replacedHandle;
     }
     else if (ctx == tail) {
         replacedHandle = removeLast();
         addLast(newName, newHandler);
+        return replacedHandle;
     }
     else {
         bool sameName = (ctx->getName().compare(newName) == 0);
@@ -624,16 +630,15 @@ DefaultChannelPipeline::replace(DefaultChannelHandlerContext* ctx,
             addException = e;
         }
 
-        if (!removed || !added) {
-            delete ctx;
-        }
+        replacedHandle = ctx->getHandler();
+        delete ctx;
 
         if (!removed && !added) {
             logger->warn(removeException.what(), removeException);
             logger->warn(addException.what(), addException);
             throw ChannelHandlerLifeCycleException(
                 std::string("Both ") +
-                ctx->getHandler()->toString() +
+                replacedHandle->toString() +
                 std::string(".afterRemove() and ") +
                 newCtx->getHandler()->toString() +
                 std::string(".afterAdd() failed; see logs."));
@@ -644,11 +649,8 @@ DefaultChannelPipeline::replace(DefaultChannelHandlerContext* ctx,
         else if (!added) {
             addException.rethrow();
         }
-
-        replacedHandle = ctx->getHandler();
     }
 
-    delete ctx;
     return replacedHandle;
 }
 
@@ -1109,9 +1111,8 @@ void DefaultChannelPipeline::updateUpstreamList() {
 
     while (up) {
         if (up->canHandleUps) {
-            if (upstreamHead) {
-                up->nextUpstream = upstreamHead;
-            }
+            // the last one may still point to a removed context.
+            up->nextUpstream = upstreamHead;
             upstreamHead = up;
         }
         up = up->prev;
@@ -1124,9 +1125,7 @@ void DefaultChannelPipeline::updateDownstreamList() {
 
     while (down) {
         if (down->canHandleDowns) {
-            if (downstreamHead) {
-                down->nextDownstream = downstreamHead;
-            }
+            down->nextDownstream = downstreamHead;
             downstreamHead = down;
         }
         down = down->next;
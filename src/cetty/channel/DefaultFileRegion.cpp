@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/DefaultFileRegion.h"
+
+#include <boost/config.hpp>
+
+#if !defined(BOOST_WINDOWS)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+#include "cetty/util/Exception.h"
+
+namespace cetty { namespace channel {
+
+using namespace cetty::util;
+
+// the most bytes sendfile(2) transfers in one call.
+static const boost::int64_t MAX_TRANSFER_SIZE = 0x7ffff000;
+
+DefaultFileRegion::DefaultFileRegion(const std::string& path)
+    : fd(-1), position(0), count(0), ownFd(true), pipe(false) {
+#if !defined(BOOST_WINDOWS)
+    // O_NONBLOCK, so opening a fifo does not wait for its writer.
+    fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+    if (fd < 0) {
+        throw FileException("can not open the file", path, errno);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        int error = errno;
+        ::close(fd);
+        throw FileException("can not stat the file", path, error);
+    }
+
+    // the size of anything else, such as a fifo, is not its count.
+    if (!S_ISREG(st.st_mode)) {
+        ::close(fd);
+        throw FileException("not a regular file", path, EINVAL);
+    }
+
+    count = st.st_size;
+#else
+    throw UnsupportedOperationException("FileRegion is not supported.");
+#endif
+}
+
+DefaultFileRegion::DefaultFileRegion(int fd,
+                                     boost::int64_t position,
+                                     boost::int64_t count,
+                                     bool releaseAfterTransfer)
+    : fd(fd), position(position), count(count), ownFd(releaseAfterTransfer),
+      pipe(false) {
+    if (fd < 0) {
+        throw InvalidArgumentException("fd: is less then zero");
+    }
+    if (position < 0) {
+        throw InvalidArgumentException("position: is less then zero");
+    }
+    if (count < 0) {
+        throw InvalidArgumentException("count: is less then zero");
+    }
+
+#if !defined(BOOST_WINDOWS)
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+        pipe = S_ISFIFO(st.st_mode);
+    }
+#endif
+}
+
+DefaultFileRegion::~DefaultFileRegion() {
+    releaseExternalResources();
+}
+
+void DefaultFileRegion::releaseExternalResources() {
+#if !defined(BOOST_WINDOWS)
+    if (ownFd && fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+boost::int64_t DefaultFileRegion::transferTo(int out, boost::int64_t position) {
+    boost::int64_t remaining = this->count - position;
+
+    if (position < 0 || remaining < 0) {
+        throw InvalidArgumentException("position out of range");
+    }
+    if (remaining == 0) {
+        return 0;
+    }
+    if (this->fd < 0) {
+        throw IOException("the file region has been released.");
+    }
+
+#if !defined(BOOST_WINDOWS)
+    std::size_t length = static_cast<std::size_t>(
+                             remaining < MAX_TRANSFER_SIZE ? remaining : MAX_TRANSFER_SIZE);
+    ssize_t transferred;
+
+    do {
+#if defined(__linux__)
+        if (pipe) {
+            // never blocks the io thread, an empty pipe is taken as
+            // a short write, as a full socket is.
+            transferred = ::splice(this->fd, NULL, out, NULL, length,
+                                   SPLICE_F_MOVE | SPLICE_F_MORE | SPLICE_F_NONBLOCK);
+        }
+        else {
+            off_t offset = static_cast<off_t>(this->position + position);
+            transferred = ::sendfile(out, this->fd, &offset, length);
+        }
+#else
+        char block[8192];
+        if (length > sizeof(block)) {
+            length = sizeof(block);
+        }
+
+        if (pipe) {
+            // what read but not written could not be read again.
+            throw UnsupportedOperationException(
+                "transferring a pipe is only supported on linux.");
+        }
+
+        transferred = ::pread(this->fd, block, length,
+                              static_cast<off_t>(this->position + position));
+
+        if (transferred > 0) {
+            transferred = ::write(out, block, transferred);
+        }
+#endif
+    } while (transferred < 0 && errno == EINTR);
+
+    if (transferred < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        throw IOException("transferring the file region failed", errno);
+    }
+    if (transferred == 0) {
+        throw IOException("the file is shorter than the region.");
+    }
+
+    return transferred;
+#else
+    throw UnsupportedOperationException("FileRegion is not supported.");
+#endif
+}
+
+}}
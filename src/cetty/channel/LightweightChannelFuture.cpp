@@ -0,0 +1,552 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/LightweightChannelFuture.h"
+
+#include <new>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "cetty/channel/ChannelFutureListener.h"
+#include "cetty/channel/ChannelFutureProgressListener.h"
+
+#include "cetty/logging/InternalLogger.h"
+#include "cetty/logging/InternalLoggerFactory.h"
+
+#include "cetty/util/TimeUnit.h"
+#include "cetty/util/Exception.h"
+
+// boost::thread_specific_ptr::get() costs a map lookup, so the cache of
+// the current thread is also kept in a native thread local pointer.
+#if defined(__GNUC__)
+#define CETTY_FUTURE_THREAD_LOCAL __thread
+#elif defined(BOOST_MSVC)
+#define CETTY_FUTURE_THREAD_LOCAL __declspec(thread)
+#endif
+
+namespace cetty { namespace channel {
+
+using namespace cetty::util;
+using namespace cetty::logging;
+
+#if defined(CETTY_FUTURE_THREAD_LOCAL)
+static CETTY_FUTURE_THREAD_LOCAL void* currentThreadCache = NULL;
+#endif
+
+/**
+ * Created only when a thread waits for the future before it is done.
+ */
+class LightweightChannelFuture::Waiter : private boost::noncopyable {
+public:
+    boost::mutex mutex;
+    boost::condition_variable condition;
+};
+
+/**
+ * The freed futures kept by one thread, linked through their first word.
+ */
+class LightweightChannelFuture::ThreadCache : private boost::noncopyable {
+public:
+    ThreadCache() : head(NULL), count(0) {}
+
+    ~ThreadCache() {
+#if defined(CETTY_FUTURE_THREAD_LOCAL)
+        // deleted by the exiting thread, which may still release futures.
+        currentThreadCache = NULL;
+#endif
+        while (head) {
+            void* p = head;
+            head = *static_cast<void**>(p);
+            ::operator delete(p);
+        }
+    }
+
+    void* allocate() {
+        void* p = head;
+        if (p) {
+            head = *static_cast<void**>(p);
+            --count;
+        }
+        return p;
+    }
+
+    bool free(void* p) {
+        if (count >= MAX_CACHED_COUNT) {
+            return false;
+        }
+
+        *static_cast<void**>(p) = head;
+        head = p;
+        ++count;
+        return true;
+    }
+
+    int cachedCount() const {
+        return count;
+    }
+
+private:
+    void* head;
+    int count;
+};
+
+class LightweightChannelFuture::SpinGuard : private boost::noncopyable {
+public:
+    SpinGuard(boost::atomic<bool>& locked) : locked(locked) {
+        while (locked.exchange(true, boost::memory_order_acquire)) {
+            boost::this_thread::yield();
+        }
+    }
+
+    ~SpinGuard() {
+        locked.store(false, boost::memory_order_release);
+    }
+
+private:
+    boost::atomic<bool>& locked;
+};
+
+InternalLogger* LightweightChannelFuture::logger =
+    InternalLoggerFactory::getInstance("LightweightChannelFuture");
+
+boost::thread_specific_ptr<LightweightChannelFuture::ThreadCache>&
+LightweightChannelFuture::threadCaches() {
+    static boost::thread_specific_ptr<ThreadCache>* caches =
+        new boost::thread_specific_ptr<ThreadCache>;
+    return *caches;
+}
+
+LightweightChannelFuture::ThreadCache* LightweightChannelFuture::threadCache() {
+#if defined(CETTY_FUTURE_THREAD_LOCAL)
+    return static_cast<ThreadCache*>(currentThreadCache);
+#else
+    return threadCaches().get();
+#endif
+}
+
+void* LightweightChannelFuture::operator new(std::size_t size) {
+    if (size == sizeof(LightweightChannelFuture)) {
+        ThreadCache* cache = threadCache();
+        if (NULL == cache) {
+            cache = new ThreadCache;
+            threadCaches().reset(cache);
+#if defined(CETTY_FUTURE_THREAD_LOCAL)
+            currentThreadCache = cache;
+#endif
+        }
+
+        void* p = cache->allocate();
+        if (p) {
+            return p;
+        }
+    }
+
+    return ::operator new(size);
+}
+
+void LightweightChannelFuture::operator delete(void* p, std::size_t size) {
+    if (NULL == p) {
+        return;
+    }
+
+    // the memory of the futures is interchangeable, a future released in
+    // another thread is kept by that thread.
+    if (size == sizeof(LightweightChannelFuture)) {
+        ThreadCache* cache = threadCache();
+        if (cache && cache->free(p)) {
+            return;
+        }
+    }
+
+    ::operator delete(p);
+}
+
+int LightweightChannelFuture::getCachedCount() {
+    ThreadCache* cache = threadCache();
+    return cache ? cache->cachedCount() : 0;
+}
+
+LightweightChannelFuture::LightweightChannelFuture(Channel& channel,
+                                                   bool cancellable)
+    : cancellable(cancellable),
+      state(PENDING),
+      locked(false),
+      channel(&channel),
+      functionListener(0),
+      firstListener(NULL),
+      otherListeners(NULL),
+      progressListeners(NULL),
+      cause(NULL),
+      waiters(NULL) {
+}
+
+LightweightChannelFuture::~LightweightChannelFuture() {
+    if (otherListeners) {
+        delete otherListeners;
+    }
+
+    if (progressListeners) {
+        delete progressListeners;
+    }
+
+    if (cause) {
+        delete cause;
+    }
+
+    if (waiters) {
+        delete waiters;
+    }
+}
+
+bool LightweightChannelFuture::isDone() const {
+    return state.load(boost::memory_order_acquire) != PENDING;
+}
+
+bool LightweightChannelFuture::isSuccess() const {
+    return state.load(boost::memory_order_acquire) == SUCCEEDED;
+}
+
+const Exception* LightweightChannelFuture::getCause() const {
+    // cause is written before the state is released.
+    if (state.load(boost::memory_order_acquire) == FAILED) {
+        return cause;
+    }
+    return NULL;
+}
+
+bool LightweightChannelFuture::isCancelled() const {
+    return state.load(boost::memory_order_acquire) == CANCELLED;
+}
+
+void LightweightChannelFuture::setListener(const ListenerFunction& listener) {
+    if (listener.empty()) {
+        return;
+    }
+
+    {
+        SpinGuard guard(locked);
+        if (!isDone()) {
+            functionListener = listener;
+            return;
+        }
+    }
+
+    notifyListener(listener);
+}
+
+void LightweightChannelFuture::addListener(ChannelFutureListener* listener) {
+    if (listener == NULL) {
+        return;
+    }
+
+    {
+        SpinGuard guard(locked);
+
+        if (!isDone()) {
+            if (firstListener == NULL) {
+                firstListener = listener;
+            }
+            else {
+                if (otherListeners == NULL) {
+                    otherListeners = new std::list<ChannelFutureListener*>();
+                }
+                otherListeners->push_back(listener);
+            }
+
+            ChannelFutureProgressListener* progressListener =
+                dynamic_cast<ChannelFutureProgressListener*>(listener);
+            if (progressListener) {
+                if (progressListeners == NULL) {
+                    progressListeners = new std::list<ChannelFutureProgressListener*>();
+                }
+                progressListeners->push_back(progressListener);
+            }
+            return;
+        }
+    }
+
+    notifyListener(listener);
+}
+
+void LightweightChannelFuture::removeListener(const ChannelFutureListener* listener) {
+    if (listener == NULL) {
+        return;
+    }
+
+    SpinGuard guard(locked);
+    if (isDone()) {
+        return;
+    }
+
+    if (listener == firstListener) {
+        if (otherListeners != NULL && !otherListeners->empty()) {
+            firstListener = otherListeners->front();
+            otherListeners->pop_front();
+        }
+        else {
+            firstListener = NULL;
+        }
+    }
+    else if (otherListeners != NULL) {
+        otherListeners->remove((ChannelFutureListener* const)listener);
+    }
+
+    const ChannelFutureProgressListener* progressListener =
+        dynamic_cast<const ChannelFutureProgressListener*>(listener);
+    if (progressListener && progressListeners) {
+        progressListeners->remove(
+            (ChannelFutureProgressListener* const)progressListener);
+    }
+}
+
+ChannelFuture& LightweightChannelFuture::await() {
+    if (boost::this_thread::interruption_requested()) {
+        throw InterruptedException();
+    }
+
+    if (!isDone()) {
+        wait(true);
+    }
+    return *this;
+}
+
+bool LightweightChannelFuture::await(boost::int64_t timeout, const TimeUnit& unit) {
+    return await(unit.toMillis(timeout));
+}
+
+bool LightweightChannelFuture::await(boost::int64_t timeoutMillis) {
+    if (boost::this_thread::interruption_requested()) {
+        throw InterruptedException();
+    }
+
+    return isDone() || wait(timeoutMillis, true);
+}
+
+ChannelFuture& LightweightChannelFuture::awaitUninterruptibly() {
+    if (!isDone()) {
+        wait(false);
+    }
+    return *this;
+}
+
+bool LightweightChannelFuture::awaitUninterruptibly(boost::int64_t timeout,
+                                                    const TimeUnit& unit) {
+    return awaitUninterruptibly(unit.toMillis(timeout));
+}
+
+bool LightweightChannelFuture::awaitUninterruptibly(boost::int64_t timeoutMillis) {
+    return isDone() || wait(timeoutMillis, false);
+}
+
+bool LightweightChannelFuture::setSuccess() {
+    return complete(SUCCEEDED, NULL);
+}
+
+bool LightweightChannelFuture::setFailure(const Exception& cause) {
+    return complete(FAILED, &cause);
+}
+
+bool LightweightChannelFuture::cancel() {
+    if (!cancellable) {
+        return false;
+    }
+    return complete(CANCELLED, NULL);
+}
+
+bool LightweightChannelFuture::setProgress(boost::int64_t amount, boost::int64_t current, boost::int64_t total) {
+    std::list<ChannelFutureProgressListener*> tmplist;
+
+    {
+        SpinGuard guard(locked);
+
+        // Do not generate progress event after completion.
+        if (isDone()) {
+            return false;
+        }
+
+        if (progressListeners == NULL || progressListeners->empty()) {
+            return true;
+        }
+
+        tmplist = *progressListeners;
+    }
+
+    std::list<ChannelFutureProgressListener*>::iterator itr;
+    for (itr = tmplist.begin(); itr != tmplist.end(); ++itr) {
+        notifyProgressListener(*itr, amount, current, total);
+    }
+
+    return true;
+}
+
+bool LightweightChannelFuture::complete(int state, const Exception* cause) {
+    Waiter* waiting = NULL;
+
+    {
+        SpinGuard guard(locked);
+
+        // Allow only once.
+        if (isDone()) {
+            return false;
+        }
+
+        if (cause) {
+            this->cause = new Exception(*cause);
+        }
+
+        this->state.store(state, boost::memory_order_release);
+        waiting = waiters;
+    }
+
+    if (waiting) {
+        // a waiter checks the state while holding the mutex, so locking it
+        // here makes sure the waiter is either notified or sees the state.
+        boost::lock_guard<boost::mutex> guard(waiting->mutex);
+        waiting->condition.notify_all();
+    }
+
+    notifyListeners();
+    return true;
+}
+
+LightweightChannelFuture::Waiter& LightweightChannelFuture::waiter() {
+    SpinGuard guard(locked);
+
+    if (NULL == waiters) {
+        waiters = new Waiter;
+    }
+    return *waiters;
+}
+
+void LightweightChannelFuture::wait(bool interruptable) {
+    Waiter& w = waiter();
+    boost::unique_lock<boost::mutex> lock(w.mutex);
+
+    if (interruptable) {
+        try {
+            while (!isDone()) {
+                w.condition.wait(lock);
+            }
+        }
+        catch (const boost::thread_interrupted&) {
+            throw InterruptedException();
+        }
+    }
+    else {
+        boost::this_thread::disable_interruption di;
+        while (!isDone()) {
+            w.condition.wait(lock);
+        }
+    }
+}
+
+bool LightweightChannelFuture::wait(boost::int64_t timeoutMillis,
+                                    bool interruptable) {
+    if (timeoutMillis <= 0) {
+        return isDone();
+    }
+
+    boost::system_time expiredTime =
+        boost::get_system_time() + boost::posix_time::milliseconds(timeoutMillis);
+
+    Waiter& w = waiter();
+    boost::unique_lock<boost::mutex> lock(w.mutex);
+
+    if (interruptable) {
+        try {
+            while (!isDone()) {
+                if (!w.condition.timed_wait(lock, expiredTime)) {
+                    return isDone();
+                }
+            }
+        }
+        catch (const boost::thread_interrupted&) {
+            throw InterruptedException();
+        }
+    }
+    else {
+        boost::this_thread::disable_interruption di;
+        while (!isDone()) {
+            if (!w.condition.timed_wait(lock, expiredTime)) {
+                return isDone();
+            }
+        }
+    }
+
+    return true;
+}
+
+void LightweightChannelFuture::notifyListeners() {
+    // no lock is needed: once the future is done, the listeners are never
+    // modified - see addListener() and removeListener().
+    if (firstListener != NULL) {
+        notifyListener(firstListener);
+        firstListener = NULL;
+
+        if (otherListeners && !otherListeners->empty()) {
+            std::list<ChannelFutureListener*>::iterator itr;
+            for (itr = otherListeners->begin(); itr != otherListeners->end(); ++itr) {
+                notifyListener(*itr);
+            }
+            otherListeners->clear();
+        }
+    }
+
+    if (functionListener) {
+        notifyListener(functionListener);
+        functionListener = 0;
+    }
+}
+
+void LightweightChannelFuture::notifyListener(ChannelFutureListener* l) {
+    try {
+        l->operationComplete(shared_from_this());
+    }
+    catch (const Exception& e) {
+        logger->warn(
+            "An exception was thrown by ChannelFutureListener .", e);
+    }
+}
+
+void LightweightChannelFuture::notifyListener(const ListenerFunction& l) {
+    try {
+        l(shared_from_this());
+    }
+    catch (const Exception& e) {
+        logger->warn(
+            "An exception was thrown by ChannelFutureListener .", e);
+    }
+}
+
+void LightweightChannelFuture::notifyProgressListener(ChannelFutureProgressListener* l,
+                                                      boost::int64_t amount,
+                                                      boost::int64_t current,
+                                                      boost::int64_t total) {
+    if (NULL == l) return;
+
+    try {
+        l->operationProgressed(shared_from_this(), amount, current, total);
+    }
+    catch (const Exception& e) {
+        logger->warn(
+            std::string("An exception was thrown by ").append(l->toString()),
+            e);
+    }
+}
+
+}}
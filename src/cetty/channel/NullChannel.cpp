@@ -113,6 +113,10 @@ ChannelFuturePtr& NullChannel::getSucceededFuture() {
     return failedFuture;
 }
 
+ChannelFuturePtr& NullChannel::getVoidFuture() {
+    return failedFuture;
+}
+
 cetty::channel::ChannelFuturePtr NullChannel::setInterestOps(int interestOps) {
     return failedFuture;
 }
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/group/ChannelGroup.h"
+
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/detail/atomic_count.hpp>
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelEventLoop.h"
+
+namespace cetty { namespace channel { namespace group {
+
+using namespace cetty::buffer;
+
+static boost::detail::atomic_count nextId(0);
+
+static ChannelFuturePtr writeBuffer(Channel& channel,
+                                    const ChannelBufferPtr& buffer,
+                                    bool withFuture) {
+    // the channel consumes the readable bytes of the buffer it writes.
+    return channel.write(ChannelMessage(buffer->duplicate()), withFuture);
+}
+
+static ChannelFuturePtr writeMessage(Channel& channel,
+                                     const ChannelMessage& message,
+                                     bool withFuture) {
+    return channel.write(message, withFuture);
+}
+
+static ChannelFuturePtr closeChannel(Channel& channel) {
+    return channel.close();
+}
+
+void ChannelGroup::ClosedChannelRemover::operationComplete(const ChannelFuturePtr& future) {
+    group.remove(future->getChannel());
+}
+
+ChannelGroup::ChannelGroup()
+    : name(std::string("group-") + Integer::toString(++nextId)),
+      members(new Members),
+      remover(*this) {
+}
+
+ChannelGroup::ChannelGroup(const std::string& name)
+    : name(name),
+      members(new Members),
+      remover(*this) {
+}
+
+ChannelGroup::~ChannelGroup() {
+    boost::mutex::scoped_lock lock(members->mutex);
+
+    Channels::iterator itr = members->channels.begin();
+    for (; itr != members->channels.end(); ++itr) {
+        itr->second->getCloseFuture()->removeListener(&remover);
+    }
+
+    // the closed channels are no longer removed, so the pending batches
+    // must not find any.
+    members->channels.clear();
+    members->eventLoopChannels.clear();
+}
+
+bool ChannelGroup::add(Channel& channel) {
+    {
+        boost::mutex::scoped_lock lock(members->mutex);
+
+        if (!members->channels.insert(std::make_pair(channel.getId(), &channel)).second) {
+            return false;
+        }
+
+        members->eventLoopChannels[channel.getEventLoop()].insert(
+            std::make_pair(channel.getId(), &channel));
+    }
+
+    // removes it immediately if the channel has been closed.
+    channel.getCloseFuture()->addListener(&remover);
+    return true;
+}
+
+bool ChannelGroup::remove(Channel& channel) {
+    {
+        boost::mutex::scoped_lock lock(members->mutex);
+
+        if (members->channels.erase(channel.getId()) == 0) {
+            return false;
+        }
+
+        EventLoopChannels::iterator itr =
+            members->eventLoopChannels.find(channel.getEventLoop());
+
+        if (itr != members->eventLoopChannels.end()) {
+            itr->second.erase(channel.getId());
+
+            if (itr->second.empty()) {
+                members->eventLoopChannels.erase(itr);
+            }
+        }
+    }
+
+    // does nothing if the channel is being closed.
+    channel.getCloseFuture()->removeListener(&remover);
+    return true;
+}
+
+Channel* ChannelGroup::find(const Integer& id) const {
+    boost::mutex::scoped_lock lock(members->mutex);
+
+    Channels::const_iterator itr = members->channels.find(id);
+    return itr != members->channels.end() ? itr->second : NULL;
+}
+
+int ChannelGroup::size() const {
+    boost::mutex::scoped_lock lock(members->mutex);
+    return static_cast<int>(members->channels.size());
+}
+
+bool ChannelGroup::empty() const {
+    boost::mutex::scoped_lock lock(members->mutex);
+    return members->channels.empty();
+}
+
+ChannelGroupFuturePtr ChannelGroup::write(const ChannelMessage& message,
+        bool withFuture) {
+    if (message.isChannelBuffer()) {
+        ChannelBufferPtr shared =
+            ChannelBuffers::unmodifiableBuffer(message.value<ChannelBufferPtr>());
+
+        return execute(boost::bind(writeBuffer, _1, shared, withFuture),
+                       withFuture);
+    }
+
+    return execute(boost::bind(writeMessage, _1, message, withFuture),
+                   withFuture);
+}
+
+ChannelGroupFuturePtr ChannelGroup::write(const ChannelMessage& message,
+        const MessageEncoder& encoder,
+        bool withFuture) {
+    return write(encoder(message), withFuture);
+}
+
+ChannelGroupFuturePtr ChannelGroup::close() {
+    return execute(closeChannel, true);
+}
+
+std::string ChannelGroup::toString() const {
+    return std::string("ChannelGroup(name: ") + name +
+           ", size: " + Integer::toString(size()) + ")";
+}
+
+ChannelGroupFuturePtr ChannelGroup::execute(const Operation& operation,
+        bool withFuture) {
+    std::vector<ChannelEventLoop*> eventLoops;
+    bool hasOwnChannels = false;
+
+    {
+        boost::mutex::scoped_lock lock(members->mutex);
+
+        EventLoopChannels::const_iterator itr = members->eventLoopChannels.begin();
+        for (; itr != members->eventLoopChannels.end(); ++itr) {
+            if (itr->first) {
+                eventLoops.push_back(itr->first);
+            }
+            else {
+                hasOwnChannels = true;
+            }
+        }
+    }
+
+    ChannelGroupFuturePtr future;
+    if (withFuture) {
+        int batchCount = static_cast<int>(eventLoops.size()) + (hasOwnChannels ? 1 : 0);
+        future = new ChannelGroupFuture(*this, batchCount);
+    }
+
+    // the channels are looked up again by the batch, in the thread of
+    // their event loop, where they are removed when closed.  The batch
+    // holds the members, not the group, which may be gone by then.
+    for (std::size_t i = 0; i < eventLoops.size(); ++i) {
+        eventLoops[i]->execute(boost::bind(&ChannelGroup::runBatch,
+                                           members,
+                                           eventLoops[i],
+                                           operation,
+                                           future));
+    }
+
+    if (hasOwnChannels) {
+        runBatch(members, NULL, operation, future);
+    }
+
+    return future;
+}
+
+void ChannelGroup::runBatch(const MembersPtr& members,
+                            ChannelEventLoop* eventLoop,
+                            const Operation& operation,
+                            const ChannelGroupFuturePtr& future) {
+    std::vector<Channel*> batch;
+
+    {
+        boost::mutex::scoped_lock lock(members->mutex);
+
+        EventLoopChannels::const_iterator itr =
+            members->eventLoopChannels.find(eventLoop);
+
+        if (itr != members->eventLoopChannels.end()) {
+            batch.reserve(itr->second.size());
+
+            Channels::const_iterator channelItr = itr->second.begin();
+            for (; channelItr != itr->second.end(); ++channelItr) {
+                batch.push_back(channelItr->second);
+            }
+        }
+    }
+
+    // a closed channel is deleted later by its event loop, so all the
+    // channels of the batch are still alive here.
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        ChannelFuturePtr channelFuture = operation(*batch[i]);
+
+        if (future && channelFuture && !channelFuture->isVoid()) {
+            future->addFuture(channelFuture);
+        }
+    }
+
+    if (future) {
+        future->batchCompleted();
+    }
+}
+
+}}}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/group/ChannelGroupFuture.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include "cetty/logging/InternalLogger.h"
+#include "cetty/logging/InternalLoggerFactory.h"
+#include "cetty/util/Exception.h"
+
+namespace cetty { namespace channel { namespace group {
+
+using namespace cetty::util;
+using namespace cetty::logging;
+
+static InternalLogger* logger =
+    InternalLoggerFactory::getInstance("ChannelGroupFuture");
+
+ChannelGroupFuture::ChannelGroupFuture(ChannelGroup& group, int batchCount)
+    : group(group),
+      pendingBatches(batchCount),
+      futureCount(0),
+      successCount(0),
+      failureCount(0),
+      done(batchCount <= 0) {
+    if (!done) {
+        self = ChannelGroupFuturePtr(this);
+    }
+}
+
+bool ChannelGroupFuture::isDone() const {
+    boost::mutex::scoped_lock lock(mutex);
+    return done;
+}
+
+int ChannelGroupFuture::getCompletedCount() const {
+    boost::mutex::scoped_lock lock(mutex);
+    return successCount + failureCount;
+}
+
+int ChannelGroupFuture::getSuccessCount() const {
+    boost::mutex::scoped_lock lock(mutex);
+    return successCount;
+}
+
+int ChannelGroupFuture::getFailureCount() const {
+    boost::mutex::scoped_lock lock(mutex);
+    return failureCount;
+}
+
+bool ChannelGroupFuture::isCompleteSuccess() const {
+    boost::mutex::scoped_lock lock(mutex);
+    return done && failureCount == 0;
+}
+
+bool ChannelGroupFuture::isCompleteFailure() const {
+    boost::mutex::scoped_lock lock(mutex);
+    return done && failureCount != 0 && successCount == 0;
+}
+
+bool ChannelGroupFuture::isPartialSuccess() const {
+    boost::mutex::scoped_lock lock(mutex);
+    return done && failureCount != 0 && successCount != 0;
+}
+
+void ChannelGroupFuture::addListener(const ListenerFunction& listener) {
+    if (listener.empty()) {
+        return;
+    }
+
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        if (!done) {
+            listeners.push_back(listener);
+            return;
+        }
+    }
+
+    listener(ChannelGroupFuturePtr(this));
+}
+
+ChannelGroupFuture& ChannelGroupFuture::await() {
+    boost::mutex::scoped_lock lock(mutex);
+    while (!done) {
+        cond.wait(lock);
+    }
+    return *this;
+}
+
+bool ChannelGroupFuture::await(boost::int64_t timeoutMillis) {
+    boost::system_time deadline = boost::get_system_time()
+                                  + boost::posix_time::milliseconds(timeoutMillis);
+
+    boost::mutex::scoped_lock lock(mutex);
+    while (!done) {
+        if (!cond.timed_wait(lock, deadline)) {
+            return done;
+        }
+    }
+    return true;
+}
+
+void ChannelGroupFuture::addFuture(const ChannelFuturePtr& future) {
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        ++futureCount;
+    }
+
+    // may be notified immediately.
+    future->addListener(this);
+}
+
+void ChannelGroupFuture::batchCompleted() {
+    boost::mutex::scoped_lock lock(mutex);
+    --pendingBatches;
+    checkDone(lock);
+}
+
+void ChannelGroupFuture::operationComplete(const ChannelFuturePtr& future) {
+    boost::mutex::scoped_lock lock(mutex);
+
+    if (future->isSuccess()) {
+        ++successCount;
+    }
+    else {
+        ++failureCount;
+    }
+
+    checkDone(lock);
+}
+
+void ChannelGroupFuture::checkDone(boost::mutex::scoped_lock& lock) {
+    if (done || pendingBatches > 0 || successCount + failureCount < futureCount) {
+        return;
+    }
+
+    done = true;
+    cond.notify_all();
+
+    std::vector<ListenerFunction> notifying;
+    notifying.swap(listeners);
+
+    // released after notifying the listeners, which may be the last owner.
+    ChannelGroupFuturePtr keeping;
+    keeping.swap(self);
+
+    lock.unlock();
+
+    for (std::size_t i = 0; i < notifying.size(); ++i) {
+        try {
+            notifying[i](keeping);
+        }
+        catch (const Exception& e) {
+            logger->warn(
+                "An exception was thrown by ChannelGroupFuture listener.", e);
+        }
+    }
+}
+
+}}}
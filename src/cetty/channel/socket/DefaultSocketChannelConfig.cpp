@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/DefaultSocketChannelConfig.h"
+#include "cetty/util/Exception.h"
+#include "cetty/util/internal/ConversionUtil.h"
+
+namespace cetty { namespace channel { namespace socket {
+
+using namespace cetty::util;
+using namespace cetty::util::internal;
+
+bool DefaultSocketChannelConfig::setOption(const std::string& key,
+                                           const boost::any& value) {
+    if (DefaultChannelConfig::setOption(key, value)) {
+        return true;
+    }
+
+    if (key == "writeBatchSize") {
+        setWriteBatchSize(ConversionUtil::toInt(value));
+    }
+    else if (key == "writeBatchBytes") {
+        setWriteBatchBytes(ConversionUtil::toInt(value));
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void DefaultSocketChannelConfig::setWriteBatchSize(int writeBatchSize) {
+    if (writeBatchSize <= 0) {
+        throw InvalidArgumentException("writeBatchSize must be a positive integer.");
+    }
+    this->writeBatchSize = writeBatchSize;
+}
+
+void DefaultSocketChannelConfig::setWriteBatchBytes(int writeBatchBytes) {
+    if (writeBatchBytes <= 0) {
+        throw InvalidArgumentException("writeBatchBytes must be a positive integer.");
+    }
+    this->writeBatchBytes = writeBatchBytes;
+}
+
+}}}
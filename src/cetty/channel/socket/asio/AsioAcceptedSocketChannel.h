@@ -58,15 +58,10 @@ public:
         AsioSocketChannel::setConnected();
         Channels::fireChannelConnected(*this, remoteAddress);
 
+        // start reading in the thread of the channel.
         if (isReadable()) {
-            Array readerBuffer;
-            readBuffer->writableBytes(readerBuffer);
-            tcpSocket.async_read_some(
-                boost::asio::buffer(readerBuffer.data(), readerBuffer.length()),
-                    boost::bind(&AsioSocketChannel::handleRead,
-                                this,
-                                boost::asio::placeholders::error,
-                                boost::asio::placeholders::bytes_transferred));
+            ioService.service().post(
+                boost::bind(&AsioSocketChannel::beginRead, this));
         }
 
         return true;
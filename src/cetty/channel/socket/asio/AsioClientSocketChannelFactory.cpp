@@ -20,7 +20,7 @@
 #include "cetty/channel/socket/asio/AsioClientSocketChannel.h"
 #include "cetty/channel/socket/asio/AsioClientSocketPipelineSink.h"
 #include "cetty/channel/socket/asio/AsioClientSocketChannelFactory.h"
-#include "cetty/util/internal/asio/AsioDeadlineTimerFactory.h"
+#include "cetty/util/internal/asio/AsioHashedWheelTimerFactory.h"
 #include "cetty/util/Exception.h"
 
 namespace cetty { namespace channel { namespace socket { namespace asio {
@@ -28,11 +28,12 @@ namespace cetty { namespace channel { namespace socket { namespace asio {
 using namespace cetty::util;
 using namespace cetty::util::internal::asio;
 
-AsioClientSocketChannelFactory::AsioClientSocketChannelFactory(int ioThreadCount)
-    : ipProtocol(IpAddress::IPv4), ioServicePool(ioThreadCount) {
+AsioClientSocketChannelFactory::AsioClientSocketChannelFactory(int ioThreadCount,
+                                                               const std::vector<int>& cpuAffinity)
+    : ipProtocol(IpAddress::IPv4), ioServicePool(ioThreadCount, cpuAffinity) {
     sink = new AsioClientSocketPipelineSink(ioServicePool);
 
-    timerFactory = TimerFactoryPtr(new AsioSocketDeadlineTimerFactory(ioServicePool));
+    timerFactory = TimerFactoryPtr(new AsioSocketHashedWheelTimerFactory(ioServicePool));
     TimerFactory::setFactory(timerFactory);
 
     createSocketAddressImplFactory();
@@ -259,7 +259,7 @@ void AsioDatagramChannel::sendto(const MessageEvent& evt) {
 
     if (writeRequest.hasBuffers()) {
         udpSocket.async_send_to(
-            writeRequest.gathring.buffers,
+            writeRequest.gathring,
             endpoint,
             make_custom_alloc_handler(writeAllocator,
                 boost::bind(&AsioDatagramChannel::handleSendTo,
@@ -25,21 +25,22 @@
 
 #include "cetty/channel/socket/asio/AsioIpAddressImplFactory.h"
 #include "cetty/channel/socket/asio/AsioSocketAddressImplFactory.h"
-#include "cetty/util/internal/asio/AsioDeadlineTimerFactory.h"
+#include "cetty/util/internal/asio/AsioHashedWheelTimerFactory.h"
 
 namespace cetty { namespace channel { namespace socket { namespace asio {
 
 using namespace cetty::channel;
 using namespace cetty::util::internal::asio;
 
-AsioDatagramChannelFactory::AsioDatagramChannelFactory(int ioThreadCount /*= 1*/)
+AsioDatagramChannelFactory::AsioDatagramChannelFactory(int ioThreadCount,
+                                                       const std::vector<int>& cpuAffinity)
     : started(false),
       ioThreadCount(ioThreadCount),
       ipProtocol(IpAddress::IPv4),
-      ioServicePool(ioThreadCount) {
+      ioServicePool(ioThreadCount, cpuAffinity) {
     this->sink = new AsioDatagramPipelineSink(ioServicePool);
 
-    timerFactory = TimerFactoryPtr(new AsioDatagramDeadlineTimerFactory(ioServicePool));
+    timerFactory = TimerFactoryPtr(new AsioDatagramHashedWheelTimerFactory(ioServicePool));
     TimerFactory::setFactory(timerFactory);
 
     createSocketAddressImplFactory();
@@ -23,21 +23,22 @@
 #include "cetty/channel/socket/asio/AsioIpAddressImplFactory.h"
 #include "cetty/channel/socket/asio/AsioServicePool.h"
 #include "cetty/channel/socket/asio/AsioSocketChannel.h"
-#include "cetty/util/internal/asio/AsioDeadlineTimerFactory.h"
+#include "cetty/util/internal/asio/AsioHashedWheelTimerFactory.h"
 
 namespace cetty { namespace channel { namespace socket { namespace asio { 
 
 using namespace cetty::channel;
 using namespace cetty::util::internal::asio;
 
-AsioServerSocketChannelFactory::AsioServerSocketChannelFactory(int ioThreadCount)
+AsioServerSocketChannelFactory::AsioServerSocketChannelFactory(int ioThreadCount,
+                                                               const std::vector<int>& cpuAffinity)
     : ipProtocol(IpAddress::IPv4),
-      ioServicePool(ioThreadCount),
-      acceptor(ioServicePool.getIOService()) {
+      ioServicePool(ioThreadCount, cpuAffinity),
+      acceptor(ioServicePool.getIOService(0)) {
 
     this->sink = new AsioServerSocketPipelineSink(ioServicePool, acceptor);
 
-    timerFactory = TimerFactoryPtr(new AsioSocketDeadlineTimerFactory(ioServicePool));
+    timerFactory = TimerFactoryPtr(new AsioSocketHashedWheelTimerFactory(ioServicePool));
     TimerFactory::setFactory(timerFactory);
 
     socketAddressFactory = new AsioTcpSocketAddressImplFactory(acceptor.io_service());
@@ -45,25 +45,32 @@ InternalLogger* AsioServerSocketPipelineSink::logger =
 AsioServerSocketPipelineSink::Boss::Boss(AsioServerSocketPipelineSink& sink,
                                          AsioServerSocketChannel& channel,
                                          AsioServicePool& ioServicePool,
-                                         boost::asio::ip::tcp::acceptor& acceptor)
-    : ioServicePool(ioServicePool),
+                                         boost::asio::ip::tcp::acceptor& acceptor,
+                                         int ioServiceIndex)
+    : ioServiceIndex(ioServiceIndex),
+      ioServicePool(ioServicePool),
       acceptor(acceptor),
       serverChannel(channel),
       sink(sink) {
 }
 
-void AsioServerSocketPipelineSink::Boss::run() {
+AsioAcceptedSocketChannel* AsioServerSocketPipelineSink::Boss::newChannel() {
     ChannelPipeline* pipeline =
         serverChannel.getConfig().getPipelineFactory()->getPipeline();
 
-    AsioServicePool::IOService& ioService = ioServicePool.getIOService();
-    AsioAcceptedSocketChannel* acceptedChannel
-        = new AsioAcceptedSocketChannel(&serverChannel,
-                                        &(serverChannel.getFactory()),
-                                        pipeline,
-                                        &sink,
-                                        ioService,
-                                        ioServicePool.getThreadId(ioService.index()));
+    AsioServicePool::IOService& ioService = ioServiceIndex < 0
+        ? ioServicePool.getIOService() : ioServicePool.at(ioServiceIndex);
+
+    return new AsioAcceptedSocketChannel(&serverChannel,
+                                         &(serverChannel.getFactory()),
+                                         pipeline,
+                                         &sink,
+                                         ioService,
+                                         ioServicePool.getThreadId(ioService.index()));
+}
+
+void AsioServerSocketPipelineSink::Boss::run() {
+    AsioAcceptedSocketChannel* acceptedChannel = newChannel();
 
     acceptor.async_accept(acceptedChannel->getSocket(),
         make_custom_alloc_handler(acceptAllocator,
@@ -78,33 +85,16 @@ void AsioServerSocketPipelineSink::Boss::handleAccept(
                                             AsioAcceptedSocketChannel* channel) {
     BOOST_ASSERT(channel);
     if (!error) {
-        if (!channel->start()) {
+        if (channel->start()) {
+            sink.addChildChannel(channel);
+        }
+        else {
             // has no local address or remote address
             // may never happened.
             delete channel;
         }
 
-		sink.serverChildrenChannels().insert(
-						std::make_pair<Integer, AsioSocketChannel*>(channel->getId(), channel));
-
-        ChannelPipeline* pipeline =
-            serverChannel.getConfig().getPipelineFactory()->getPipeline();
-
-        AsioServicePool::IOService& ioService = ioServicePool.getIOService();
-        channel = new AsioAcceptedSocketChannel(
-                                    &serverChannel,
-                                    &(serverChannel.getFactory()),
-                                    pipeline,
-                                    &sink,
-                                    ioService,
-                                    ioServicePool.getThreadId(ioService.index()));
-
-        acceptor.async_accept(channel->getSocket(),
-            make_custom_alloc_handler(acceptAllocator,
-                boost::bind(&AsioServerSocketPipelineSink::Boss::handleAccept,
-                            this,
-                            boost::asio::placeholders::error,
-                            channel)));
+        run();
     }
     else {
         delete channel;
@@ -114,6 +104,12 @@ void AsioServerSocketPipelineSink::Boss::handleAccept(
     }
 }
 
+AsioServerSocketPipelineSink::~AsioServerSocketPipelineSink() {
+    for (std::size_t i = 0; i < bosses.size(); ++i) {
+        delete bosses[i];
+    }
+}
+
 void AsioServerSocketPipelineSink::writeRequested(const cetty::channel::ChannelPipeline& pipeline,
                                                   const cetty::channel::MessageEvent& e) {
     Channel& channel = e.getChannel();
@@ -219,14 +215,53 @@ void AsioServerSocketPipelineSink::bind(AsioServerSocketChannel& channel,
         DefaultAsioServerSocketChannelConfig* config =
             dynamic_cast<DefaultAsioServerSocketChannelConfig*>(&channel.getConfig());
 
+        bool reusePort = config->isReusePort() && ioServicePool.size() > 1;
+
+#if defined(SO_REUSEPORT)
+        if (reusePort) {
+            acceptor.set_option(ReusePortOption(true));
+        }
+#else
+        if (reusePort) {
+            // without the per-io_service acceptors, the boss must assign
+            // the children to the io_services in turn.
+            reusePort = false;
+            logger->warn("SO_REUSEPORT is not supported, the reusePort option is ignored.");
+        }
+#endif
+
         acceptor.bind(ep);
         acceptor.listen(config->getBacklog());
 
+        if (reusePort) {
+            // the port of the channel's acceptor, which may be an
+            // ephemeral one if the port 0 is asked for.
+            bindReusePortAcceptors(channel,
+                                   acceptor.local_endpoint(),
+                                   config->getBacklog());
+        }
+
         bound = true;
         Channels::fireChannelBound(channel, channel.getLocalAddress());
 
-        boss = new Boss(*this, channel, ioServicePool, acceptor);
-        boss->run();
+        // the acceptor of the channel is opened in the first io_service.
+        bosses.push_back(new Boss(*this,
+                                  channel,
+                                  ioServicePool,
+                                  acceptor,
+                                  reusePort ? 0 : -1));
+
+        for (std::size_t i = 0; i < reusePortAcceptors.size(); ++i) {
+            bosses.push_back(new Boss(*this,
+                                      channel,
+                                      ioServicePool,
+                                      *reusePortAcceptors[i],
+                                      static_cast<int>(i + 1)));
+        }
+
+        for (std::size_t i = 0; i < bosses.size(); ++i) {
+            bosses[i]->run();
+        }
         bossStarted = true;
 
         future->setSuccess();
@@ -242,6 +277,36 @@ void AsioServerSocketPipelineSink::bind(AsioServerSocketChannel& channel,
     }
 }
 
+void AsioServerSocketPipelineSink::bindReusePortAcceptors(
+                            AsioServerSocketChannel& channel,
+                            const boost::asio::ip::tcp::endpoint& endpoint,
+                            int backlog) {
+#if defined(SO_REUSEPORT)
+    boost::asio::ip::tcp::acceptor::reuse_address reuseAddress;
+    acceptor.get_option(reuseAddress);
+
+    for (int i = 1; i < ioServicePool.size(); ++i) {
+        AcceptorPtr reusePortAcceptor(
+            new boost::asio::ip::tcp::acceptor(ioServicePool.getIOService(i)));
+
+        reusePortAcceptor->open(endpoint.protocol());
+        reusePortAcceptor->set_option(ReusePortOption(true));
+
+        reusePortAcceptor->set_option(reuseAddress);
+
+        reusePortAcceptor->bind(endpoint);
+        reusePortAcceptor->listen(backlog);
+
+        reusePortAcceptors.push_back(reusePortAcceptor);
+    }
+#endif
+}
+
+void AsioServerSocketPipelineSink::addChildChannel(AsioSocketChannel* channel) {
+    boost::mutex::scoped_lock lock(mutex);
+    clildrenChannels.insert(std::make_pair(Integer(channel->getId()), channel));
+}
+
 void AsioServerSocketPipelineSink::closeServerChannel(
                                         AsioServerSocketChannel& channel,
                                         const ChannelFuturePtr& future) {
@@ -271,16 +336,33 @@ void AsioServerSocketPipelineSink::closeServerChannel(
         Channels::fireExceptionCaught(channel, e);
     }
 
+    // an acceptor may be accepting in its own io_service right now, so it
+    // is closed there, as the epoll bosses are. The acceptor of the i-th
+    // one is bound on the io_service i + 1.
+    for (std::size_t i = 0; i < reusePortAcceptors.size(); ++i) {
+        ioServicePool.getIOService(static_cast<int>(i) + 1).post(boost::bind(
+            &AsioServerSocketPipelineSink::closeAcceptor,
+            reusePortAcceptors[i]));
+    }
+
 	//close all children Channels
-	while (!clildrenChannels.empty()) {
-		AsioSocketChannel* child = clildrenChannels.begin()->second;
-		if (child) {
-			closeAcceptChannel(*child, child->getCloseFuture());
-		}
-		else {
-			clildrenChannels.erase(clildrenChannels.begin());
-		}
-	}
+    std::vector<AsioSocketChannel*> children;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        ChildrenChannels::iterator itr = clildrenChannels.begin();
+        for (; itr != clildrenChannels.end(); ++itr) {
+            children.push_back(itr->second);
+        }
+    }
+
+    for (std::size_t i = 0; i < children.size(); ++i) {
+        children[i]->close();
+    }
+}
+
+void AsioServerSocketPipelineSink::closeAcceptor(const AcceptorPtr& acceptor) {
+    boost::system::error_code ec;
+    acceptor->close(ec);
 }
 
 void AsioServerSocketPipelineSink::closeAcceptChannel(
@@ -288,12 +370,21 @@ void AsioServerSocketPipelineSink::closeAcceptChannel(
                                         const ChannelFuturePtr& future) {
     channel.close(future);
 
-	//delete the channel.
-	ChildrenChannels::iterator itr = clildrenChannels.find(channel.getId());
-	if (itr != clildrenChannels.end()) {
-		delete itr->second;
-		clildrenChannels.erase(itr);
-	}
+    bool found = false;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        ChildrenChannels::iterator itr = clildrenChannels.find(channel.getId());
+        if (itr != clildrenChannels.end()) {
+            clildrenChannels.erase(itr);
+            found = true;
+        }
+    }
+
+    // the channel is deleted later in its I/O thread, when the tasks
+    // which still refer to it have released it too.
+    if (found) {
+        channel.release();
+    }
 }
 
 }}}}
@@ -21,7 +21,11 @@
  * Distributed under under the Apache License, version 2.0 (the "License").
  */
 
+#include <map>
+#include <vector>
 #include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "cetty/channel/AbstractChannelSink.h"
 #include "cetty/channel/ChannelFuture.h"
@@ -54,13 +58,26 @@ class AsioServerSocketChannel;
 class AsioServerSocketPipelineSink : public cetty::channel::AbstractChannelSink {
 private:
 	typedef std::map<Integer, AsioSocketChannel*> ChildrenChannels;
-
+    typedef boost::shared_ptr<boost::asio::ip::tcp::acceptor> AcceptorPtr;
+
+#if defined(SO_REUSEPORT)
+    typedef boost::asio::detail::socket_option::boolean<
+        SOL_SOCKET, SO_REUSEPORT> ReusePortOption;
+#endif
+
+    /**
+     * Accepts the connections of one acceptor.  The accepted channels are
+     * handed to the io_services of the pool in a round-robin way, or, when
+     * the boss owns a <tt>SO_REUSEPORT</tt> acceptor of an io_service, kept
+     * in the io_service of the acceptor.
+     */
     class Boss {
     public:
         Boss(AsioServerSocketPipelineSink& sink,
              AsioServerSocketChannel& channel,
              AsioServicePool& ioServicePool,
-             boost::asio::ip::tcp::acceptor& acceptor);
+             boost::asio::ip::tcp::acceptor& acceptor,
+             int ioServiceIndex = -1);
 
         // exceptions will be handled by the caller.
         void run();
@@ -68,6 +85,10 @@ private:
                           AsioAcceptedSocketChannel* channel);
 
     private:
+        AsioAcceptedSocketChannel* newChannel();
+
+    private:
+        int ioServiceIndex;
         AsioServicePool& ioServicePool;
         boost::asio::ip::tcp::acceptor& acceptor;
         AsioServerSocketChannel& serverChannel;
@@ -78,22 +99,16 @@ private:
 public:
     AsioServerSocketPipelineSink(AsioServicePool& ioServicePool,
         boost::asio::ip::tcp::acceptor& acceptor)
-        : boss(NULL), ioServicePool(ioServicePool), acceptor(acceptor) {
+        : ioServicePool(ioServicePool), acceptor(acceptor) {
     }
 
-    virtual ~AsioServerSocketPipelineSink() {
-        if (boss) {
-            delete boss;
-        }
-    }
+    virtual ~AsioServerSocketPipelineSink();
 
     virtual void writeRequested(const cetty::channel::ChannelPipeline& pipeline,
                                 const cetty::channel::MessageEvent& e);
 
     virtual void stateChangeRequested(const cetty::channel::ChannelPipeline& pipeline,
                                       const cetty::channel::ChannelStateEvent& e);
-	
-	ChildrenChannels serverChildrenChannels() { return clildrenChannels; }
 
 private:
     void handleServerSocket(AsioServerSocketChannel& channel, const ChannelEvent& e);
@@ -107,21 +122,41 @@ private:
         const ChannelFuturePtr& future,
         const SocketAddress& localAddress);
 
+    /**
+     * opens, binds and starts a <tt>SO_REUSEPORT</tt> acceptor for every
+     * io_service of the pool except the one of the channel's acceptor.
+     *
+     * @param endpoint the endpoint the channel's acceptor is bound to.
+     */
+    void bindReusePortAcceptors(AsioServerSocketChannel& channel,
+                                const boost::asio::ip::tcp::endpoint& endpoint,
+                                int backlog);
+
+    void addChildChannel(AsioSocketChannel* channel);
+
     void closeServerChannel(AsioServerSocketChannel& channel,
                             const ChannelFuturePtr& future);
 
     void closeAcceptChannel(AsioSocketChannel& channel,
                             const ChannelFuturePtr& future);
 
+    // posted to the io_service of the acceptor, which may be accepting.
+    static void closeAcceptor(const AcceptorPtr& acceptor);
+
 private:
     static InternalLogger* logger;
     
 private:
-    Boss* boss;
+    std::vector<Boss*> bosses;
 
     AsioServicePool& ioServicePool;
     boost::asio::ip::tcp::acceptor& acceptor;
 
+    // the acceptors of the other io_services in the SO_REUSEPORT mode.
+    std::vector<AcceptorPtr> reusePortAcceptors;
+
+    // accessed by all the io_services in the SO_REUSEPORT mode.
+    boost::mutex mutex;
 	ChildrenChannels clildrenChannels;
 };
 
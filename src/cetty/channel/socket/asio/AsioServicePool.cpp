@@ -22,17 +22,281 @@
 
 #include "cetty/channel/socket/asio/AsioServicePool.h"
 
+#include <ctime>
+#include <memory>
 #include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
 
+#if defined(__linux__)
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#include "cetty/logging/InternalLogger.h"
+#include "cetty/logging/InternalLoggerFactory.h"
+#include "cetty/util/Integer.h"
 #include "cetty/util/Exception.h"
 
 namespace cetty { namespace channel { namespace socket { namespace asio {
 
+using namespace cetty::util;
+using namespace cetty::logging;
+
+static InternalLogger* logger =
+    InternalLoggerFactory::getInstance("AsioServicePool");
+
+#if defined(__linux__)
+// the NUMA node of the cpu, from the sysfs entry "cpuN/nodeM".
+static int getNumaNode(int cpu) {
+    std::string path = std::string("/sys/devices/system/cpu/cpu") +
+                       Integer::toString(cpu);
+
+    DIR* dir = ::opendir(path.c_str());
+    if (NULL == dir) {
+        return -1;
+    }
+
+    int node = -1;
+    struct dirent* entry;
+    while ((entry = ::readdir(dir)) != NULL) {
+        if (::strncmp(entry->d_name, "node", 4) == 0 &&
+            ::isdigit(entry->d_name[4])) {
+            node = ::atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    ::closedir(dir);
+
+    return node;
+}
+#endif
+
+class RoundRobinPlacement : public AsioServicePool::PlacementStrategy {
+public:
+    RoundRobinPlacement() : next(0) {}
+    virtual ~RoundRobinPlacement() {}
+
+    virtual int choose(AsioServicePool& pool) {
+        return static_cast<int>(
+                   next.fetch_add(1, boost::memory_order_relaxed) %
+                   static_cast<boost::uint32_t>(pool.size()));
+    }
+
+private:
+    boost::atomic<boost::uint32_t> next;
+};
+
+class LeastConnectionsPlacement : public AsioServicePool::PlacementStrategy {
+public:
+    virtual ~LeastConnectionsPlacement() {}
+
+    virtual int choose(AsioServicePool& pool) {
+        int index = 0;
+        long least = pool.at(0).channelCount();
+
+        for (int i = 1; i < pool.size(); ++i) {
+            long count = pool.at(i).channelCount();
+            if (count < least) {
+                least = count;
+                index = i;
+            }
+        }
+        return index;
+    }
+};
+
+class LeastPendingBytesPlacement : public AsioServicePool::PlacementStrategy {
+public:
+    virtual ~LeastPendingBytesPlacement() {}
+
+    virtual int choose(AsioServicePool& pool) {
+        int index = 0;
+        long least = pool.at(0).pendingWriteBytes();
+
+        for (int i = 1; i < pool.size(); ++i) {
+            long bytes = pool.at(i).pendingWriteBytes();
+            if (bytes < least) {
+                least = bytes;
+                index = i;
+            }
+        }
+        return index;
+    }
+};
+
+/**
+ * samples two io_services at random and takes the one with less channels,
+ * which avoids both the herd behavior of the least-connections strategy
+ * and the scan of all the io_services.
+ */
+class PowerOfTwoChoicesPlacement : public AsioServicePool::PlacementStrategy {
+public:
+    PowerOfTwoChoicesPlacement()
+        : seed(static_cast<boost::uint32_t>(std::time(NULL)) ^
+               static_cast<boost::uint32_t>(reinterpret_cast<std::size_t>(this))),
+          sequence(0) {}
+    virtual ~PowerOfTwoChoicesPlacement() {}
+
+    virtual int choose(AsioServicePool& pool) {
+        int size = pool.size();
+        if (size < 2) {
+            return 0;
+        }
+
+        int first = static_cast<int>(nextRandom() % size);
+        int second = static_cast<int>(nextRandom() % (size - 1));
+        if (second >= first) {
+            ++second;
+        }
+
+        return pool.at(second).channelCount() < pool.at(first).channelCount()
+               ? second : first;
+    }
+
+private:
+    // hashes an atomic sequence (the murmur3 finalizer), so the threads
+    // creating channels concurrently never share a random state.
+    boost::uint32_t nextRandom() {
+        boost::uint32_t h =
+            seed + sequence.fetch_add(0x9e3779b9U, boost::memory_order_relaxed);
+
+        h ^= h >> 16;
+        h *= 0x85ebca6bU;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35U;
+        h ^= h >> 16;
+        return h;
+    }
+
+private:
+    const boost::uint32_t seed;
+    boost::atomic<boost::uint32_t> sequence;
+};
+
+const char* AsioServicePool::ROUND_ROBIN = "roundRobin";
+const char* AsioServicePool::LEAST_CONNECTIONS = "leastConnections";
+const char* AsioServicePool::LEAST_PENDING_BYTES = "leastPendingBytes";
+const char* AsioServicePool::POWER_OF_TWO_CHOICES = "powerOfTwoChoices";
+
+AsioServicePool::PlacementStrategyPtr
+AsioServicePool::createPlacementStrategy(const std::string& name) {
+    if (name.compare(ROUND_ROBIN) == 0) {
+        return PlacementStrategyPtr(new RoundRobinPlacement);
+    }
+    else if (name.compare(LEAST_CONNECTIONS) == 0) {
+        return PlacementStrategyPtr(new LeastConnectionsPlacement);
+    }
+    else if (name.compare(LEAST_PENDING_BYTES) == 0) {
+        return PlacementStrategyPtr(new LeastPendingBytesPlacement);
+    }
+    else if (name.compare(POWER_OF_TWO_CHOICES) == 0) {
+        return PlacementStrategyPtr(new PowerOfTwoChoicesPlacement);
+    }
+
+    throw InvalidArgumentException(
+        std::string("unknown placement strategy: ") + name);
+}
+
+// the operation of a task executed as a ChannelEventLoop.
+class TaskOperation : public AsioServicePool::Operation {
+public:
+    TaskOperation(const cetty::channel::ChannelEventLoop::Task& task) : task(task) {}
+    virtual ~TaskOperation() {}
+
+    virtual void run() { task(); }
+
+private:
+    cetty::channel::ChannelEventLoop::Task task;
+};
+
+AsioServicePool::IOService::~IOService() {
+    // the operations never run, only release them.
+    cetty::util::internal::MpscQueueNode* node;
+    while ((node = operations.pop()) != NULL) {
+        delete static_cast<Operation*>(node);
+    }
+}
+
+void AsioServicePool::IOService::execute(Operation* operation) {
+    BOOST_ASSERT(operation);
+    operations.push(operation);
+
+    // only the first operation since the last drain wakes up the thread.
+    if (!drainScheduled.exchange(true, boost::memory_order_acq_rel)) {
+        ioService.post(boost::bind(&IOService::drain, this));
+    }
+}
+
+void AsioServicePool::IOService::execute(const Task& task) {
+    execute(new TaskOperation(task));
+}
+
+void AsioServicePool::IOService::drain() {
+    // reset the flag before popping, the operations pushed from now on
+    // either are popped below, or schedule another drain.
+    drainScheduled.exchange(false, boost::memory_order_acq_rel);
+
+    cetty::util::internal::MpscQueueNode* node;
+    for (int i = 0; i < MAX_DRAIN_BATCH; ++i) {
+        node = operations.pop();
+        if (NULL == node) {
+            return;
+        }
+
+        std::auto_ptr<Operation> operation(static_cast<Operation*>(node));
+        try {
+            operation->run();
+        }
+        catch (...) {
+            // let the exception out of io_service::run() as post() does,
+            // but keep the rest of the operations going.
+            scheduleDrain();
+            throw;
+        }
+    }
+
+    scheduleDrain();
+}
+
+void AsioServicePool::IOService::scheduleDrain() {
+    if (!operations.empty() &&
+        !drainScheduled.exchange(true, boost::memory_order_acq_rel)) {
+        ioService.post(boost::bind(&IOService::drain, this));
+    }
+}
+
 AsioServicePool::AsioServicePool(int poolSize)
   : usingthread(true),
     running(false),
-    nextIOserviceIndex(0),
+    placementStrategy(new RoundRobinPlacement),
+    placementName(ROUND_ROBIN),
     mainThreadId(boost::this_thread::get_id()) {
+    start(poolSize);
+}
+
+AsioServicePool::AsioServicePool(int poolSize, const std::vector<int>& cpus)
+  : usingthread(true),
+    running(false),
+    placementStrategy(new RoundRobinPlacement),
+    placementName(ROUND_ROBIN),
+    mainThreadId(boost::this_thread::get_id()),
+    cpuAffinity(cpus) {
+    for (std::size_t i = 0; i < cpus.size(); ++i) {
+        if (cpus[i] < 0) {
+            throw InvalidArgumentException(
+                std::string("invalid cpu: ") + Integer::toString(cpus[i]));
+        }
+    }
+
+    start(poolSize);
+}
+
+void AsioServicePool::start(int poolSize) {
     if (poolSize < 0) {
         poolSize = boost::thread::hardware_concurrency();
     }
@@ -57,7 +321,7 @@ AsioServicePool::AsioServicePool(int poolSize)
             ThreadPtr thread(new boost::thread(
                 boost::bind(&AsioServicePool::runIOservice,
                             this,
-                            boost::ref(ioServices[i]->service()))));
+                            boost::ref(*ioServices[i]))));
             threads.push_back(thread);
         }
         running = true;
@@ -68,7 +332,7 @@ void AsioServicePool::run() {
     if (running) return;
 
     if (!usingthread) {
-        runIOservice(ioServices[0]->service());
+        runIOservice(*ioServices[0]);
     }
 
     running = true;
@@ -96,23 +360,84 @@ AsioServicePool::IOService& AsioServicePool::getIOService() {
         return *ioServices[0];
     }
 
-    // Use a round-robin scheme to choose the next io_service to use.
-    IOService& ioService = *ioServices[nextIOserviceIndex];
-    ++nextIOserviceIndex;
-    if (nextIOserviceIndex == (int)ioServices.size()) {
-        nextIOserviceIndex = 0;
+    PlacementStrategyPtr strategy;
+    {
+        boost::lock_guard<boost::mutex> guard(placementMutex);
+        strategy = placementStrategy;
+    }
+
+    int index = strategy->choose(*this);
+    BOOST_ASSERT(index >= 0 && index < (int)ioServices.size() && "Out of range");
+
+    return *ioServices[index];
+}
+
+void AsioServicePool::setPlacementStrategy(const PlacementStrategyPtr& strategy) {
+    if (!strategy) {
+        throw InvalidArgumentException("placement strategy is NULL");
+    }
+
+    boost::lock_guard<boost::mutex> guard(placementMutex);
+    placementStrategy = strategy;
+    placementName.clear();
+}
+
+void AsioServicePool::setPlacementStrategy(const std::string& name) {
+    boost::lock_guard<boost::mutex> guard(placementMutex);
+
+    // the bootstraps apply the option on every connect or bind, keeps the
+    // state of the current strategy, such as the round-robin cursor.
+    if (name == placementName) {
+        return;
+    }
+
+    placementStrategy = createPlacementStrategy(name);
+    placementName = name;
+}
+
+bool AsioServicePool::pinThread(IOService& ioService, int cpu) {
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    if (error != 0) {
+        logger->warn(std::string("failed to pin the thread of io_service ") +
+                     Integer::toString(ioService.index()) + " to cpu " +
+                     Integer::toString(cpu) + ", error: " +
+                     Integer::toString(error));
+        return false;
     }
 
-    return ioService;
+    ioService.cpuId = cpu;
+    ioService.nodeId = getNumaNode(cpu);
+
+    logger->info(std::string("io_service ") +
+                 Integer::toString(ioService.index()) + " -> cpu " +
+                 Integer::toString(cpu) + ", numa node " +
+                 Integer::toString(ioService.nodeId));
+    return true;
+#else
+    logger->warn("pinning the io_service threads is not supported.");
+    return false;
+#endif
 }
 
-std::size_t AsioServicePool::runIOservice(boost::asio::io_service& ioservice) {
+std::size_t AsioServicePool::runIOservice(IOService& ioService) {
+    // pinned before running anything, so the memory the thread allocates
+    // comes from the node of its cpu.
+    if (!cpuAffinity.empty()) {
+        pinThread(ioService, cpuAffinity[ioService.index() % cpuAffinity.size()]);
+    }
+
     boost::system::error_code err;
-    std::size_t opCount = ioservice.run(err);
+    std::size_t opCount = ioService.service().run(err);
 
-    // if error happened, try to recover.
     if (err) {
-        printf("io service has error = %d\n", err.value());
+        logger->error(std::string("io_service ") +
+                      Integer::toString(ioService.index()) +
+                      " stopped with error: " + err.message());
     }
     return opCount;
 }
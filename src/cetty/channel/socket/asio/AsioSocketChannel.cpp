@@ -24,6 +24,7 @@
 #include "cetty/channel/CopyableDownstreamMessageEvent.h"
 #include "cetty/channel/CopyableDownstreamChannelStateEvent.h"
 #include "cetty/channel/DefaultWriteCompletionEvent.h"
+#include "cetty/channel/ReceiveBufferSizePredictor.h"
 #include "cetty/channel/socket/asio/AsioSocketAddressImpl.h"
 
 #include "cetty/buffer/ChannelBuffer.h"
@@ -38,6 +39,42 @@ using namespace cetty::channel;
 using namespace cetty::buffer;
 using namespace cetty::util;
 
+// the downstream events sent from the other threads, run in the thread of
+// the io_service of the channel.
+class DownstreamMessageOperation : public AsioServicePool::Operation {
+public:
+    DownstreamMessageOperation(ChannelPipeline* pipeline,
+                               const CopyableDownstreamMessageEvent& evt)
+        : pipeline(pipeline), evt(evt) {}
+
+    virtual ~DownstreamMessageOperation() {}
+
+    virtual void run() {
+        pipeline->sendDownstream(evt);
+    }
+
+private:
+    ChannelPipeline* pipeline;
+    CopyableDownstreamMessageEvent evt;
+};
+
+class DownstreamStateChangeOperation : public AsioServicePool::Operation {
+public:
+    DownstreamStateChangeOperation(ChannelPipeline* pipeline,
+                                   const CopyableDownstreamChannelStateEvent& evt)
+        : pipeline(pipeline), evt(evt) {}
+
+    virtual ~DownstreamStateChangeOperation() {}
+
+    virtual void run() {
+        pipeline->sendDownstream(evt);
+    }
+
+private:
+    ChannelPipeline* pipeline;
+    CopyableDownstreamChannelStateEvent evt;
+};
+
 AsioSocketChannel::AsioSocketChannel(Channel* parent,
                                      ChannelFactory* factory,
                                      ChannelPipeline* pipeline,
@@ -51,15 +88,18 @@ AsioSocketChannel::AsioSocketChannel(Channel* parent,
       tcpSocket(ioService.service()),
       isWriting(false),
       highWaterMarkCounter(0),
+      writingCount(0),
+      readBufferFilled(false),
       config(tcpSocket),
       state(ST_CHANNEL_OPEN) {
     writeQueue.setChannel(*this);
-    ChannelBufferFactory* bufferFactory = config.getBufferFactory();
-    readBuffer = bufferFactory->getBuffer(bufferFactory->getDefaultOrder(),
-                                          config.getChannelOwnBufferSize());
+    ioService.increaseChannelCount();
 }
 
 AsioSocketChannel::~AsioSocketChannel() {
+    if (state != ST_CHANNEL_CLOSED) {
+        ioService.decreaseChannelCount();
+    }
 }
 
 const SocketAddress& AsioSocketChannel::getLocalAddress() const {
@@ -140,22 +180,15 @@ ChannelFuturePtr AsioSocketChannel::write(const ChannelMessage& message,
 
 ChannelFuturePtr AsioSocketChannel::write(const ChannelMessage& message,
                                           bool  withFutrue) {
-    ChannelFuturePtr future;
-    if (withFutrue) {
-        future = Channels::future(*this);
-    }
+    ChannelFuturePtr future = withFutrue ? Channels::future(*this) : voidFuture;
 
     if (boost::this_thread::get_id() == threadId) {
         pipeline->sendDownstream(
             DownstreamMessageEvent(*this, future, message, this->remoteAddress));
     }
     else {
-        ioService.service().post(
-            make_custom_alloc_handler(ipcWriteAllocator,
-            boost::bind<void, ChannelPipeline, const MessageEvent&>(
-                        &ChannelPipeline::sendDownstream,
-                        pipeline,
-                        CopyableDownstreamMessageEvent(*this, future, message, this->remoteAddress))));
+        ioService.execute(new DownstreamMessageOperation(pipeline,
+            CopyableDownstreamMessageEvent(*this, future, message, this->remoteAddress)));
     }
 
     return future;
@@ -172,34 +205,148 @@ void AsioSocketChannel::write(const MessageEvent& evt) {
         return;
     }
 
-    isWriting = true;
-    AsioWriteRequest writeRequest(evt);
+    const ChannelMessage& message = evt.getMessage();
+    int count = message.vectorSize();
 
-    writeQueue.offer(writeRequest, f);
+    if (count > 0 && message.pointer<ChannelMessage>(0)) {
+        // a vector of messages, such as a chunk header, a file region and
+        // a chunk trailer, each one is written in turn, the future is
+        // notified when the last one is written.
+        for (int i = 0; i < count; ++i) {
+            AsioWriteRequest writeRequest(*message.pointer<ChannelMessage>(i));
+            writeQueue.offer(writeRequest,
+                             i == count - 1 ? f : ChannelFuturePtr());
+        }
+    }
+    else {
+        AsioWriteRequest writeRequest(evt);
+        writeQueue.offer(writeRequest, f);
+    }
+
+    // hold the message back while a write is in flight, it will be
+    // flushed together with the others when the write completes.
+    if (!isWriting) {
+        flush();
+    }
+}
+
+void AsioSocketChannel::flush() {
+    int batchSize = config.getWriteBatchSize();
+    int batchBytes = config.getWriteBatchBytes();
+    int queuedCount = static_cast<int>(writeQueue.size());
+    int bytes = 0;
+
+    writingBuffers.clear();
+    writingCount = 0;
+
+    while (writingCount < queuedCount && writingCount < batchSize) {
+        AsioWriteOperation& op = writeQueue.at(writingCount);
+
+        // a file region is transferred alone, after the buffers before it.
+        if (op.isFileRegion()) {
+            if (writingCount == 0) {
+                writingCount = 1;
+                isWriting = true;
+                transferFileRegion();
+                return;
+            }
+            break;
+        }
+
+        if (writingCount > 0 && bytes + op.writeBufferSize > batchBytes) {
+            break;
+        }
+
+        op.appendTo(writingBuffers);
+        bytes += op.writeBufferSize;
+        ++writingCount;
+    }
 
-    if (writeRequest.writeBufferSize == 0) {
+    if (writingCount == 0) {
+        return;
+    }
+
+    isWriting = true;
+
+    if (bytes == 0) {
         ioService.service().post(boost::bind(
             &AsioSocketChannel::handleWrite, this, boost::system::error_code(), 0));
         return;
     }
 
-    if (writeRequest.hasBuffers()) {
-        boost::asio::async_write(tcpSocket,
-            writeRequest.gathring.buffers,
-            make_custom_alloc_handler(writeAllocator,
-                boost::bind(&AsioSocketChannel::handleWrite,
-                            this,
-                            boost::asio::placeholders::error,
-                            boost::asio::placeholders::bytes_transferred)));
+    boost::asio::async_write(tcpSocket,
+        writingBuffers,
+        make_custom_alloc_handler(writeAllocator,
+            boost::bind(&AsioSocketChannel::handleWrite,
+                        this,
+                        boost::asio::placeholders::error,
+                        boost::asio::placeholders::bytes_transferred)));
+}
+
+void AsioSocketChannel::transferFileRegion() {
+    AsioWriteOperation& op = writeQueue.at(0);
+    const FileRegionPtr& region = op.fileRegion;
+    boost::int64_t count = region->getCount();
+
+    try {
+        if (!tcpSocket.native_non_blocking()) {
+            tcpSocket.native_non_blocking(true);
+        }
+
+        while (op.fileTransferred < count) {
+            boost::int64_t transferred =
+                region->transferTo(tcpSocket.native_handle(), op.fileTransferred);
+
+            if (transferred == 0) {
+                // the socket buffer is full, go on when it is writable again.
+                tcpSocket.async_write_some(boost::asio::null_buffers(),
+                    make_custom_alloc_handler(writeAllocator,
+                        boost::bind(&AsioSocketChannel::handleFileRegionWritable,
+                                    this,
+                                    boost::asio::placeholders::error)));
+                return;
+            }
+
+            op.fileTransferred += transferred;
+            if (op.future) {
+                op.future->setProgress(transferred, op.fileTransferred, count);
+            }
+        }
+    }
+    catch (const Exception& e) {
+        ChannelFuturePtr future = writeQueue.poll().future;
+
+        isWriting = false;
+        writingCount = 0;
+
+        if (future) {
+            future->setFailure(e);
+        }
+        close();
+        return;
+    }
+    catch (const boost::system::system_error& e) {
+        ChannelFuturePtr future = writeQueue.poll().future;
+
+        isWriting = false;
+        writingCount = 0;
+
+        if (future) {
+            future->setFailure(IOException(e.what(), e.code().value()));
+        }
+        close();
+        return;
+    }
+
+    handleWrite(boost::system::error_code(), static_cast<size_t>(count));
+}
+
+void AsioSocketChannel::handleFileRegionWritable(const boost::system::error_code& error) {
+    if (!error) {
+        transferFileRegion();
     }
     else {
-        boost::asio::async_write(tcpSocket,
-            boost::asio::const_buffers_1(writeRequest.buffer),
-            make_custom_alloc_handler(writeAllocator,
-                boost::bind(&AsioSocketChannel::handleWrite,
-                            this,
-                            boost::asio::placeholders::error,
-                            boost::asio::placeholders::bytes_transferred)));
+        handleWrite(error, 0);
     }
 }
 
@@ -210,13 +357,9 @@ cetty::channel::ChannelFuturePtr AsioSocketChannel::unbind() {
                                     *this, future, ChannelState::BOUND));
     }
     else {
-        ioService.service().post(
-            make_custom_alloc_handler(ipcStateChangeAllocator,
-                boost::bind<void, ChannelPipeline, const ChannelStateEvent&>(
-                    &ChannelPipeline::sendDownstream,
-                    pipeline,
-                    CopyableDownstreamChannelStateEvent(
-                        *this, future, ChannelState::BOUND))));
+        ioService.execute(new DownstreamStateChangeOperation(pipeline,
+            CopyableDownstreamChannelStateEvent(
+                *this, future, ChannelState::BOUND)));
     }
 
     return future;
@@ -232,13 +375,9 @@ cetty::channel::ChannelFuturePtr AsioSocketChannel::close() {
                                     *this, closeFuture, ChannelState::OPEN));
     }
     else {
-        ioService.service().post(
-            make_custom_alloc_handler(ipcStateChangeAllocator,
-                boost::bind<void, ChannelPipeline, const ChannelStateEvent&>(
-                    &ChannelPipeline::sendDownstream,
-                    pipeline,
-                    CopyableDownstreamChannelStateEvent(
-                        *this, closeFuture, ChannelState::OPEN))));
+        ioService.execute(new DownstreamStateChangeOperation(pipeline,
+            CopyableDownstreamChannelStateEvent(
+                *this, closeFuture, ChannelState::OPEN)));
     }
 
     return closeFuture;
@@ -293,13 +432,9 @@ cetty::channel::ChannelFuturePtr AsioSocketChannel::disconnect() {
                                     *this, future, ChannelState::CONNECTED));
     }
     else {
-        ioService.service().post(
-            make_custom_alloc_handler(ipcStateChangeAllocator,
-                boost::bind<void, ChannelPipeline, const ChannelStateEvent&>(
-                &ChannelPipeline::sendDownstream,
-                pipeline,
-                CopyableDownstreamChannelStateEvent(
-                    *this, future, ChannelState::CONNECTED))));
+        ioService.execute(new DownstreamStateChangeOperation(pipeline,
+            CopyableDownstreamChannelStateEvent(
+                *this, future, ChannelState::CONNECTED)));
     }
 
     return future;
@@ -314,13 +449,9 @@ cetty::channel::ChannelFuturePtr AsioSocketChannel::setInterestOps(int interestO
             *this, future, ChannelState::INTEREST_OPS, boost::any(interestOps)));
     }
     else {
-        ioService.service().post(
-            make_custom_alloc_handler(ipcStateChangeAllocator,
-                boost::bind<void, ChannelPipeline, const ChannelStateEvent&>(
-                &ChannelPipeline::sendDownstream,
-                pipeline,
-                CopyableDownstreamChannelStateEvent(
-                    *this, future, ChannelState::INTEREST_OPS, boost::any(interestOps)))));
+        ioService.execute(new DownstreamStateChangeOperation(pipeline,
+            CopyableDownstreamChannelStateEvent(
+                *this, future, ChannelState::INTEREST_OPS, boost::any(interestOps))));
     }
 
     return future;
@@ -339,14 +470,7 @@ void AsioSocketChannel::setInterestOps(const ChannelFuturePtr& future, int inter
     bool changed = isOrgReadable != isNowReadable;
 
     if (changed && isNowReadable) {
-        Array readerArray;
-        readBuffer->writableBytes(readerArray);
-        tcpSocket.async_read_some(
-            boost::asio::buffer(readerArray.data(), readerArray.length()),
-            boost::bind(&AsioSocketChannel::handleRead,
-            this,
-            boost::asio::placeholders::error,
-            boost::asio::placeholders::bytes_transferred));
+        beginRead();
     }
 
     future->setSuccess();
@@ -355,48 +479,144 @@ void AsioSocketChannel::setInterestOps(const ChannelFuturePtr& future, int inter
     }
 }
 
+void AsioSocketChannel::beginRead() {
+    // an idle channel keeps no read buffer, unless some bytes are left
+    // unread or the last read filled it up.
+    if (readBuffer && !readBuffer->readable() && !readBufferFilled) {
+        readBuffer.reset();
+    }
+
+    // waits for the socket to be readable, and then reads into a buffer
+    // sized by the ReceiveBufferSizePredictor.
+    tcpSocket.async_read_some(boost::asio::null_buffers(),
+        make_custom_alloc_handler(readAllocator,
+            boost::bind(&AsioSocketChannel::handleRead,
+                        this,
+                        boost::asio::placeholders::error,
+                        boost::asio::placeholders::bytes_transferred)));
+}
+
+void AsioSocketChannel::prepareReadBuffer(int predictedSize) {
+    ChannelBufferFactory* bufferFactory = config.getBufferFactory();
+
+    if (!readBuffer) {
+        // allocated by the thread of the io_service, so the memory
+        // is local to the thread, and to its NUMA node if it is pinned.
+        readBuffer = bufferFactory->getBuffer(bufferFactory->getDefaultOrder(),
+                                              predictedSize);
+        return;
+    }
+
+    if (readBuffer->writableBytes() >= predictedSize) {
+        return;
+    }
+
+    // the read bytes may still be referenced by the slices which the
+    // handlers kept, then they must be neither moved nor overwritten.
+    if (readBuffer->refcount() == 1) {
+        readBuffer->discardReadBytes();
+        if (readBuffer->writableBytes() >= predictedSize) {
+            return;
+        }
+    }
+
+    // a partial message is left, or the buffer is shared by the slices,
+    // moves the unread bytes into a new buffer.
+    ChannelBufferPtr buffer = bufferFactory->getBuffer(
+                                  bufferFactory->getDefaultOrder(),
+                                  readBuffer->readableBytes() + predictedSize);
+    buffer->writeBytes(*readBuffer);
+    readBuffer = buffer;
+}
+
 void AsioSocketChannel::handleRead(const boost::system::error_code& error,
                                    size_t bytes_transferred) {
-    if (!error) {
-        readBuffer->offsetWriterIndex(bytes_transferred);
-
-        // Fire the event.
-        pipeline->sendUpstream(UpstreamMessageEvent(*this, readBuffer, remoteAddress));
-        //Channels::fireMessageReceived(*this, ChannelMessage(readBuffer));
-
-        if (interestOps & OP_READ) { //readable
-            Array readerBuffer;
-            readBuffer->writableBytes(readerBuffer);
-            tcpSocket.async_read_some(
-                boost::asio::buffer(readerBuffer.data(), readerBuffer.length()),
-                make_custom_alloc_handler(readAllocator,
-                    boost::bind(&AsioSocketChannel::handleRead,
-                                this,
-                                boost::asio::placeholders::error,
-                                boost::asio::placeholders::bytes_transferred)));
+    if (error) {
+        close();
+        return;
+    }
+
+    ReceiveBufferSizePredictor* predictor = config.getReceiveBufferSizePredictor();
+    prepareReadBuffer(predictor->nextReceiveBufferSize());
+
+    Array array;
+    readBuffer->writableBytes(array);
+
+    int length = array.length();
+    if (length > readBuffer->writableBytes()) {
+        length = readBuffer->writableBytes();
+    }
+
+    boost::system::error_code ec;
+    if (!tcpSocket.non_blocking()) {
+        tcpSocket.non_blocking(true, ec);
+    }
+
+    size_t n = tcpSocket.read_some(boost::asio::buffer(array.data(), length), ec);
+
+    if (ec == boost::asio::error::would_block ||
+            ec == boost::asio::error::try_again) {
+        // spurious readiness.
+        readBufferFilled = false;
+        if (interestOps & OP_READ) {
+            beginRead();
         }
+        return;
     }
-    else {
+    else if (ec) {
         close();
+        return;
+    }
+
+    readBuffer->offsetWriterIndex(static_cast<int>(n));
+    predictor->previousReceiveBufferSize(static_cast<int>(n));
+    readBufferFilled = (static_cast<int>(n) == length);
+
+    // Fire the event.
+    pipeline->sendUpstream(UpstreamMessageEvent(*this, readBuffer, remoteAddress));
+    //Channels::fireMessageReceived(*this, ChannelMessage(readBuffer));
+
+    if (interestOps & OP_READ) { //readable
+        beginRead();
     }
 }
 
 void AsioSocketChannel::handleWrite(const boost::system::error_code& error,
                                     size_t bytes_transferred) {
+    // retire the written operations while still writing, so a write from
+    // the low water mark event only queues its message.
+    std::vector<ChannelFuturePtr> futures;
+    for (int i = 0; i < writingCount && !writeQueue.empty(); ++i) {
+        const ChannelFuturePtr& future = writeQueue.poll().future;
+        if (future) {
+            futures.push_back(future);
+        }
+    }
+
+    isWriting = false;
+    writingCount = 0;
+
     if (!error) {
-        writeQueue.poll().setSuccess();
+        // the listeners and the handlers may write again, which flushes
+        // only the messages after the written ones.
+        for (std::size_t i = 0; i < futures.size(); ++i) {
+            futures[i]->setSuccess();
+        }
 
         pipeline->sendUpstream(DefaultWriteCompletionEvent(*this, bytes_transferred));
         //Channels::fireWriteComplete(*this, bytes_transferred);
 
-        if (writeQueue.empty()) {
-            isWriting = false;
+        if (!isWriting && !writeQueue.empty() && isConnected()) {
+            flush();
         }
     }
     else {
-        writeQueue.poll().setFailure(
-            RuntimeException(std::string("write buffer failed, code=") +
-                             Integer::toString(error.value())));
+        RuntimeException cause(std::string("write buffer failed, code=") +
+                               Integer::toString(error.value()));
+
+        for (std::size_t i = 0; i < futures.size(); ++i) {
+            futures[i]->setFailure(cause);
+        }
         close();
     }
 }
@@ -410,15 +630,7 @@ void AsioSocketChannel::handleConnect(const boost::system::error_code& error,
         cf->setSuccess();
 
         if (isReadable()) {
-            Array readerBuffer;
-            readBuffer->writableBytes(readerBuffer);
-            tcpSocket.async_read_some(
-                boost::asio::buffer(readerBuffer.data(), readerBuffer.length()),
-                make_custom_alloc_handler(readAllocator,
-                    boost::bind(&AsioSocketChannel::handleRead,
-                                this,
-                                boost::asio::placeholders::error,
-                                boost::asio::placeholders::bytes_transferred)));
+            beginRead();
         }
     }
     else if (endpoint_iterator != boost::asio::ip::tcp::resolver::iterator()) {
@@ -450,10 +662,10 @@ void AsioSocketChannel::cleanUpWriteBuffer() {
             cause = ChannelException("Channel has closed.");
         }
 
-        // last one in the writeBuffer should not been cleaned.
-        // it is already sent asynchronously, will take care of itself.
-        while (writeQueue.size() > 1) {
-            writeQueue.poll().setFailure(cause);
+        // the ones in the writing batch should not been cleaned.
+        // they are already sent asynchronously, will take care of themselves.
+        while (writeQueue.size() > (size_t)writingCount) {
+            writeQueue.pollLast().setFailure(cause);
             fireExceptionCaught = true;
         }
     }
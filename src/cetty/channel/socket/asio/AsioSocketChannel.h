@@ -22,13 +22,13 @@
  */
 
 #include <deque>
+#include <vector>
 
 #include <boost/any.hpp>
 #include <boost/assert.hpp>
 #include <boost/bind.hpp>
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
-#include <boost/detail/atomic_count.hpp>
 
 #include "cetty/buffer/ChannelBuffer.h"
 #include "cetty/channel/SocketAddress.h"
@@ -70,6 +70,10 @@ public:
         return ioService;
     }
 
+    virtual AsioServicePool::IOService* getEventLoop() const {
+        return &ioService;
+    }
+
     virtual const SocketAddress& getLocalAddress() const;
     virtual const SocketAddress& getRemoteAddress() const;
 
@@ -88,6 +92,9 @@ public:
 	virtual int getInterestOps() const;
 
     virtual bool setClosed() {
+        if (state != ST_CHANNEL_CLOSED) {
+            ioService.decreaseChannelCount();
+        }
         state = ST_CHANNEL_CLOSED;
         return AbstractChannel::setClosed();
     }
@@ -127,6 +134,18 @@ public:
     void setInterestOps(const ChannelFuturePtr& future, int interestOps);
     void cleanUpWriteBuffer();
 
+    /**
+     * waits for the socket to be readable, releases the read buffer if the
+     * channel is idle.  must be called in the thread of the channel.
+     */
+    void beginRead();
+
+    /**
+     * makes sure the read buffer has the predicted writable bytes,
+     * keeping the bytes left unread.
+     */
+    void prepareReadBuffer(int predictedSize);
+
     void handleRead(const boost::system::error_code& error, size_t bytes_transferred);
     void handleWrite(const boost::system::error_code& error, size_t bytes_transferred);
 
@@ -135,6 +154,19 @@ public:
                        const ChannelFuturePtr& cf);
 
 private:
+    /**
+     * writes all the queued messages, up to the batch limits of the config,
+     * with one gathering write.
+     */
+    void flush();
+
+    /**
+     * transfers the {@link FileRegion} at the head of the writeQueue with
+     * the non-blocking socket, resumes when the socket is writable again.
+     */
+    void transferFileRegion();
+    void handleFileRegionWritable(const boost::system::error_code& error);
+
     void handleAtHighWaterMark();
     void handleAtLowWaterMark();
 
@@ -152,12 +184,18 @@ protected:
     bool isWriting;
     int  highWaterMarkCounter;
 
+    // the count of the operations, at the head of the writeQueue,
+    // which are being written in the current gathering write.
+    int  writingCount;
+    std::vector<AsioWriteOperation::asio_buffer> writingBuffers;
+
+    // whether the last read filled up the read buffer, more may be pending.
+    bool readBufferFilled;
+
     DefaultAsioSocketChannelConfig config;
 
     handler_allocator<int> readAllocator;
     handler_allocator<int> writeAllocator;
-    handler_allocator<boost::detail::atomic_count> ipcWriteAllocator;
-    handler_allocator<boost::detail::atomic_count> ipcStateChangeAllocator;
 
     mutable SocketAddress localAddress;
     mutable SocketAddress remoteAddress;
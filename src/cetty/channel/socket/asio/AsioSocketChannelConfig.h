@@ -55,6 +55,11 @@ using namespace cetty::channel;
  * </tr>
  * </table>
  *
+ * The read buffer of the channel is sized by its
+ * {@link ReceiveBufferSizePredictor} before each read, instead of the
+ * <tt>"channelOwnBufferSize"</tt>, and is released while the channel is
+ * idle.
+ *
  * 
  * @author <a href="http://gleamynode.net/">Trustin Lee</a>
  *
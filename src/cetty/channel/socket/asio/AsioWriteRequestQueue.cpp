@@ -15,6 +15,8 @@
  */
 
 #include "cetty/channel/socket/asio/AsioWriteRequestQueue.h"
+#include <limits.h>
+
 #include "cetty/buffer/CompositeChannelBuffer.h"
 #include "cetty/channel/MessageEvent.h"
 #include "cetty/channel/ChannelMessage.h"
@@ -25,27 +27,41 @@ namespace cetty { namespace channel { namespace socket { namespace asio {
 using namespace cetty::channel;
 using namespace cetty::buffer;
 
-AsioWriteRequest::AsioWriteRequest(const MessageEvent& evt) {
-    const ChannelMessage& message = evt.getMessage();
+AsioWriteRequest::AsioWriteRequest(const MessageEvent& evt) : writeBufferSize(0) {
+    init(evt.getMessage());
+}
+
+AsioWriteRequest::AsioWriteRequest(const ChannelMessage& message) : writeBufferSize(0) {
+    init(message);
+}
+
+void AsioWriteRequest::init(const ChannelMessage& message) {
     if (message.isChannelBuffer()) {
-        const ChannelBufferPtr& channelBuffer = message.value<ChannelBufferPtr>();
+        channelBuffer = message.value<ChannelBufferPtr>();
         if (channelBuffer->hasArray()) {
             Array array;
             channelBuffer->readSlice(array);
 
             writeBufferSize = array.length();
             buffer = asio_buffer(array.data(), writeBufferSize);
-            gathring.buffers.truncatedIndex = 0;
         }
         else {
             channelBuffer->readSlice(gathring);
             writeBufferSize = gathring.bytesCount();
 
-            if (gathring.buffers.truncatedIndex == 1) {
-                buffer = gathring.buffers[0];
-                gathring.buffers.truncatedIndex = 0;
+            if (gathring.blockCount() == 1) {
+                buffer = *gathring.begin();
+                gathring.clear();
             }
         }
+        return;
+    }
+
+    fileRegion = message.smartPointer<FileRegion>();
+    if (fileRegion) {
+        // only for the water marks.
+        boost::int64_t count = fileRegion->getCount();
+        writeBufferSize = count > INT_MAX ? INT_MAX : static_cast<int>(count);
     }
 }
 
@@ -53,6 +69,8 @@ void AsioWriteOperationQueue::plusWriteBufferSize(int messageSize) {
     writeBufferSize += messageSize;
     
     if (NULL == channel) return;
+    channel->ioService.addPendingWriteBytes(messageSize);
+
     int highWaterMark = channel->config.getWriteBufferHighWaterMark();
 
     if (writeBufferSize >= highWaterMark) {
@@ -66,6 +84,8 @@ void AsioWriteOperationQueue::minusWriteBufferSize(int messageSize) {
     writeBufferSize -= messageSize;
 
     if (NULL == channel) return;
+    channel->ioService.addPendingWriteBytes(-messageSize);
+
     int lowWaterMark = channel->config.getWriteBufferLowWaterMark();
 
     if (writeBufferSize == 0 || writeBufferSize < lowWaterMark) {
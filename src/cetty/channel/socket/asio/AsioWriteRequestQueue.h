@@ -18,17 +18,19 @@
  */
 
 #include <deque>
+#include <vector>
 #include <boost/array.hpp>
 #include <boost/asio/buffer.hpp>
-#include <boost/static_assert.hpp>
 
 #include "cetty/buffer/ChannelBuffer.h"
 #include "cetty/buffer/GatheringBuffer.h"
 #include "cetty/channel/ChannelFuture.h"
 #include "cetty/channel/Channels.h"
+#include "cetty/channel/FileRegion.h"
 
 namespace cetty { namespace channel {
 class MessageEvent;
+class ChannelMessage;
 }}
 
 namespace cetty { namespace channel { namespace socket { namespace asio {
@@ -38,92 +40,94 @@ using namespace cetty::channel;
 
 class AsioSocketChannel;
 
-template<class T, std::size_t N>
-class TruncatableArray : public boost::array<T, N> {
-public:
-    // type definitions
-    typedef T*             iterator;
-    typedef const T*       const_iterator;
-    typedef T&             reference;
-    typedef const T&       const_reference;
-
-public:
-    TruncatableArray() : truncatedIndex(1) {
-        BOOST_STATIC_ASSERT(N > 0);
-    }
-
-public:
-    int truncatedIndex;
-
-public:
-
-    iterator        end()       { return boost::array<T, N>::elems+truncatedIndex; }
-    const_iterator  end() const { return boost::array<T, N>::elems+truncatedIndex; }
-
-    reference back()  {
-        BOOST_ASSERT(truncatedIndex);
-        return boost::array<T, N>::elems[truncatedIndex-1];
-    }
-    const_reference back() const {
-        BOOST_ASSERT(truncatedIndex);
-        return boost::array<T, N>::elems[truncatedIndex-1];
-    }
-};
-
+/**
+ * A {@link GatheringBuffer} of asio buffers.
+ *
+ * The first {@link #INLINE_BUFFER_COUNT} memory blocks are kept in an
+ * inline array, so the common case of a few blocks needs no heap
+ * allocation.  When more blocks are appended, all the blocks are moved to
+ * a vector, so a {@link CompositeChannelBuffer} of any fan-out still ends
+ * up as one contiguous buffer sequence for a single gathering write.
+ */
 class AsioGatheringBuffer : public cetty::buffer::GatheringBuffer {
 public:
     typedef boost::asio::mutable_buffer asio_buffer;
 
+    // makes it an asio buffer sequence.
+    typedef asio_buffer value_type;
+    typedef const asio_buffer* const_iterator;
+
 public:
-    AsioGatheringBuffer() : byteSize(0) {}
+    AsioGatheringBuffer() : count(0), byteSize(0) {}
     virtual ~AsioGatheringBuffer() {}
 
-
     virtual bool empty() const {
-        return buffers.truncatedIndex == 0;
+        return count == 0;
     }
 
     /**
      * underline memory block count.
      */
     virtual int  blockCount() const {
-        return buffers.truncatedIndex;
+        return count;
     }
 
     virtual int  bytesCount() const {
-        if (byteSize == 0) {
-            for (int i = 0; i < buffers.truncatedIndex; ++i) {
-                byteSize += (int)boost::asio::buffer_size(buffers[i]);
-            }
-        }
-
         return byteSize;
     }
-    
+
     virtual void clear() {
-        buffers.truncatedIndex = 0;
+        count = 0;
         byteSize = 0;
+        overflowBuffers.clear();
     }
 
     virtual void append(char* data, int size) {
-        BOOST_ASSERT(buffers.truncatedIndex < MAX_BUFFER_COUNT);
-        buffers[buffers.truncatedIndex++] = asio_buffer(data, size);
+        if (size <= 0) {
+            return;
+        }
+
+        if (count < INLINE_BUFFER_COUNT) {
+            inlineBuffers[count] = asio_buffer(data, size);
+        }
+        else {
+            if (count == INLINE_BUFFER_COUNT) {
+                overflowBuffers.reserve(INLINE_BUFFER_COUNT * 2);
+                overflowBuffers.assign(inlineBuffers.begin(), inlineBuffers.end());
+            }
+            overflowBuffers.push_back(asio_buffer(data, size));
+        }
+
+        ++count;
         byteSize += size;
     }
 
     virtual std::pair<char*, int> at(int index) {
-        BOOST_ASSERT(index >= 0 && index < MAX_BUFFER_COUNT);
-        asio_buffer& buffer = buffers[index];
+        BOOST_ASSERT(index >= 0 && index < count);
+        const asio_buffer& buffer = begin()[index];
         return std::make_pair<char*,int>(
                         boost::asio::buffer_cast<char*>(buffer),
                         (int)boost::asio::buffer_size(buffer));
     }
 
+    const_iterator begin() const {
+        return count > INLINE_BUFFER_COUNT ? &overflowBuffers[0] : inlineBuffers.data();
+    }
+    const_iterator end() const {
+        return begin() + count;
+    }
+
 public:
-    const static int  MAX_BUFFER_COUNT = 8;
+    /**
+     * the count of the memory blocks stored without heap allocation.
+     */
+    const static int INLINE_BUFFER_COUNT = 8;
 
-    mutable int byteSize;
-    TruncatableArray<asio_buffer, MAX_BUFFER_COUNT> buffers;
+private:
+    int count;
+    int byteSize;
+    boost::array<asio_buffer, INLINE_BUFFER_COUNT> inlineBuffers;
+    std::vector<asio_buffer> overflowBuffers;
 };
 
 class AsioWriteRequest {
@@ -136,27 +140,83 @@ public:
 
     int                 writeBufferSize;
 
+    // keeps the memory of the buffers alive until written.
+    ChannelBufferPtr    channelBuffer;
+
+    // transferred by sendfile instead of the buffers.
+    FileRegionPtr       fileRegion;
+
 public:
     AsioWriteRequest(const MessageEvent& evt);
+    AsioWriteRequest(const ChannelMessage& message);
     ~AsioWriteRequest() {}
 
-    bool hasBuffers() const { return gathring.buffers.truncatedIndex > 0; }
+    bool hasBuffers() const { return !gathring.empty(); }
+
+private:
+    void init(const ChannelMessage& message);
 };
 
 class AsioWriteOperation {
+public:
+    typedef boost::asio::mutable_buffer asio_buffer;
+
 public:
     int writeBufferSize;
     ChannelFuturePtr future;
 
-    AsioWriteOperation() : writeBufferSize(0) {}
+    asio_buffer         buffer;
+    AsioGatheringBuffer gathring;
+    ChannelBufferPtr    channelBuffer;
+
+    FileRegionPtr       fileRegion;
+    boost::int64_t      fileTransferred;
+
+    AsioWriteOperation() : writeBufferSize(0), fileTransferred(0) {}
 
-    AsioWriteOperation(int size, const ChannelFuturePtr& f)
-        : writeBufferSize(size), future(f) {
+    AsioWriteOperation(const AsioWriteRequest& request, const ChannelFuturePtr& f)
+        : writeBufferSize(request.writeBufferSize),
+          future(f),
+          buffer(request.buffer),
+          gathring(request.gathring),
+          channelBuffer(request.channelBuffer),
+          fileRegion(request.fileRegion),
+          fileTransferred(0) {
     }
 
     AsioWriteOperation(const AsioWriteOperation& op)
         : writeBufferSize(op.writeBufferSize),
-          future(op.future) {
+          future(op.future),
+          buffer(op.buffer),
+          gathring(op.gathring),
+          channelBuffer(op.channelBuffer),
+          fileRegion(op.fileRegion),
+          fileTransferred(op.fileTransferred) {
+    }
+
+    AsioWriteOperation& operator=(const AsioWriteOperation& op) {
+        writeBufferSize = op.writeBufferSize;
+        future = op.future;
+        buffer = op.buffer;
+        gathring = op.gathring;
+        channelBuffer = op.channelBuffer;
+        fileRegion = op.fileRegion;
+        fileTransferred = op.fileTransferred;
+        return *this;
+    }
+
+    bool isFileRegion() const { return fileRegion.get() != NULL; }
+
+    /**
+     * appends the memory blocks of this operation to the gathering list.
+     */
+    void appendTo(std::vector<asio_buffer>& buffers) const {
+        if (!gathring.empty()) {
+            buffers.insert(buffers.end(), gathring.begin(), gathring.end());
+        }
+        else if (writeBufferSize > 0) {
+            buffers.push_back(buffer);
+        }
     }
 
     bool setSuccess() {
@@ -184,6 +244,10 @@ public:
         return ops.front();
     }
 
+    AsioWriteOperation& at(size_t index) {
+        return ops[index];
+    }
+
     AsioWriteOperation& poll() {
         polledOp = ops.front();
         ops.pop_front();
@@ -191,8 +255,15 @@ public:
         return polledOp;
     }
 
+    AsioWriteOperation& pollLast() {
+        polledOp = ops.back();
+        ops.pop_back();
+        minusWriteBufferSize(polledOp.writeBufferSize);
+        return polledOp;
+    }
+
     void offer(const AsioWriteRequest& request, const ChannelFuturePtr& f) {
-        ops.push_back(AsioWriteOperation(request.writeBufferSize, f));
+        ops.push_back(AsioWriteOperation(request, f));
         plusWriteBufferSize(request.writeBufferSize);
     }
 
@@ -40,10 +40,19 @@ InternalLogger *DefaultAsioDatagramChannelConfig::logger =
     InternalLoggerFactory::getInstance("DefaultNioDatagramChannelConfig");
 
 DefaultAsioDatagramChannelConfig::DefaultAsioDatagramChannelConfig(udp_socket_type& socket)
-    : socket(socket), predictor(NULL), predictorFactory(DEFAULT_PREDICTOR_FACTORY) {
+    : socket(socket),
+      predictor(NULL),
+      predictorFactory(DEFAULT_PREDICTOR_FACTORY),
+      ownPredictor(false) {
     setChannelOwnBufferSize(DEFAULT_CHANNEL_OWN_BUFFER_SIZE);
 }
 
+DefaultAsioDatagramChannelConfig::~DefaultAsioDatagramChannelConfig() {
+    if (ownPredictor && predictor) {
+        delete predictor;
+    }
+}
+
 bool DefaultAsioDatagramChannelConfig::setOption(const std::string& key, const boost::any& value) {
     if (DefaultDatagramChannelConfig::setOption(key, value)) {
         return true;
@@ -302,6 +311,7 @@ ReceiveBufferSizePredictor* DefaultAsioDatagramChannelConfig::getReceiveBufferSi
         try {
             predictor = getReceiveBufferSizePredictorFactory()->getPredictor();
             this->predictor = predictor;
+            this->ownPredictor = true;
         }
         catch (const Exception& e) {
             throw ChannelException(
@@ -317,6 +327,10 @@ void DefaultAsioDatagramChannelConfig::setReceiveBufferSizePredictor(ReceiveBuff
         throw NullPointerException("predictor");
     }
 
+    if (ownPredictor && this->predictor != predictor) {
+        delete this->predictor;
+        ownPredictor = false;
+    }
     this->predictor = predictor;
 }
 
@@ -64,6 +64,7 @@ public:
 
 public:
     DefaultAsioDatagramChannelConfig(udp_socket_type& socket);
+    virtual ~DefaultAsioDatagramChannelConfig();
 
     virtual bool setOption(const std::string& key, const boost::any& value);
 
@@ -169,6 +170,9 @@ private:
     NetworkInterface outboundInterface;
     ReceiveBufferSizePredictor* predictor;
     ReceiveBufferSizePredictorFactory* predictorFactory;
+
+    // whether the predictor was created by the predictorFactory.
+    bool ownPredictor;
 };
 
 }}}}
@@ -45,7 +45,7 @@ public:
      * Creates a new instance.
      */
     DefaultAsioServerSocketChannelConfig(boost::asio::ip::tcp::acceptor& acceptor)
-        : acceptor(acceptor) {
+        : acceptor(acceptor), reusePort(false) {
     }
 
     virtual bool setOption(const std::string& key, const boost::any& value) {
@@ -62,6 +62,9 @@ public:
         else if (key.compare("backlog") == 0) {
             setBacklog(internal::ConversionUtil::toInt(value));
         }
+        else if (key.compare("reusePort") == 0) {
+            setReusePort(internal::ConversionUtil::toBoolean(value));
+        }
         else {
             return false;
         }
@@ -89,6 +92,19 @@ public:
         }
     }
 
+    virtual bool isReusePort() const {
+        return reusePort;
+    }
+
+    virtual void setReusePort(bool reusePort) {
+#if !defined(SO_REUSEPORT)
+        if (reusePort) {
+            throw ChannelException("SO_REUSEPORT is not supported.");
+        }
+#endif
+        this->reusePort = reusePort;
+    }
+
     virtual int getReceiveBufferSize() const {
         try {
             boost::asio::ip::tcp::acceptor::receive_buffer_size option;
@@ -130,6 +146,7 @@ public:
 private:
     boost::asio::ip::tcp::acceptor& acceptor;
     int backlog;
+    bool reusePort;
 };
 
 }}}}
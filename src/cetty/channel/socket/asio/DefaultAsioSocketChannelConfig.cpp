@@ -43,6 +43,12 @@ static AdaptiveReceiveBufferSizePredictorFactory adaptiveFactory;
 ReceiveBufferSizePredictorFactory* 
 DefaultAsioSocketChannelConfig::DEFAULT_PREDICTOR_FACTORY= &adaptiveFactory;
 
+DefaultAsioSocketChannelConfig::~DefaultAsioSocketChannelConfig() {
+    if (ownPredictor && predictor) {
+        delete predictor;
+    }
+}
+
 bool DefaultAsioSocketChannelConfig::setOption(const std::string& key, const boost::any& value) {
     if (DefaultSocketChannelConfig::setOption(key, value)) {
         return true;
@@ -284,6 +290,7 @@ ReceiveBufferSizePredictor* DefaultAsioSocketChannelConfig::getReceiveBufferSize
     try {
         predictor = getReceiveBufferSizePredictorFactory()->getPredictor();
         this->predictor = predictor;
+        this->ownPredictor = true;
     }
     catch (const Exception& e) {
         throw ChannelException(
@@ -297,6 +304,10 @@ void DefaultAsioSocketChannelConfig::setReceiveBufferSizePredictor(ReceiveBuffer
     if (predictor == NULL) {
         throw NullPointerException("predictor");
     }
+    if (ownPredictor && this->predictor != predictor) {
+        delete this->predictor;
+        ownPredictor = false;
+    }
     this->predictor = predictor;
 }
 
@@ -46,10 +46,13 @@ public:
           writeBufferLowWaterMark(0),
           writeBufferHighWaterMark(DEFAULT_WRITE_BUFFER_HIGH_WATERMARK),
           predictor(NULL),
-          predictorFactory(DEFAULT_PREDICTOR_FACTORY) {
+          predictorFactory(DEFAULT_PREDICTOR_FACTORY),
+          ownPredictor(false) {
         setChannelOwnBufferSize(DEFAULT_CHANNEL_OWN_BUFFER_SIZE);
     }
 
+    virtual ~DefaultAsioSocketChannelConfig();
+
     virtual bool setOption(const std::string& key, const boost::any& value);
 
     virtual int getReceiveBufferSize() const;
@@ -107,6 +110,9 @@ private:
 
     ReceiveBufferSizePredictor* predictor;
     ReceiveBufferSizePredictorFactory* predictorFactory;
+
+    // whether the predictor was created by the predictorFactory.
+    bool ownPredictor;
 };
 
 }}}}
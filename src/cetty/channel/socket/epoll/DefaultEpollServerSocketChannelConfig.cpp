@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/epoll/DefaultEpollServerSocketChannelConfig.h"
+
+#include <errno.h>
+
+#include "cetty/channel/ChannelException.h"
+#include "cetty/util/Exception.h"
+#include "cetty/util/internal/ConversionUtil.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::util;
+using namespace cetty::util::internal;
+
+bool DefaultEpollServerSocketChannelConfig::setOption(const std::string& key,
+                                                      const boost::any& value) {
+    if (DefaultServerChannelConfig::setOption(key, value)) {
+        return true;
+    }
+
+    if (key.compare("receiveBufferSize") == 0) {
+        setReceiveBufferSize(ConversionUtil::toInt(value));
+    }
+    else if (key.compare("reuseAddress") == 0) {
+        setReuseAddress(ConversionUtil::toBoolean(value));
+    }
+    else if (key.compare("backlog") == 0) {
+        setBacklog(ConversionUtil::toInt(value));
+    }
+    else if (key.compare("reusePort") == 0) {
+        setReusePort(ConversionUtil::toBoolean(value));
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+bool DefaultEpollServerSocketChannelConfig::isReuseAddress() const {
+    int value = 0;
+    socklen_t length = sizeof(value);
+
+    if (::getsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &value, &length) < 0) {
+        throw ChannelException("getsockopt(SO_REUSEADDR) failed", errno);
+    }
+    return value != 0;
+}
+
+void DefaultEpollServerSocketChannelConfig::setReuseAddress(bool reuseAddress) {
+    int value = reuseAddress ? 1 : 0;
+
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value)) < 0) {
+        throw ChannelException("setsockopt(SO_REUSEADDR) failed", errno);
+    }
+}
+
+void DefaultEpollServerSocketChannelConfig::setReusePort(bool reusePort) {
+#if defined(SO_REUSEPORT)
+    int value = reusePort ? 1 : 0;
+
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value)) < 0) {
+        throw ChannelException("setsockopt(SO_REUSEPORT) failed", errno);
+    }
+#else
+    if (reusePort) {
+        throw ChannelException("SO_REUSEPORT is not supported.");
+    }
+#endif
+    this->reusePort = reusePort;
+}
+
+int DefaultEpollServerSocketChannelConfig::getReceiveBufferSize() const {
+    int value = 0;
+    socklen_t length = sizeof(value);
+
+    if (::getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &value, &length) < 0) {
+        throw ChannelException("getsockopt(SO_RCVBUF) failed", errno);
+    }
+    return value;
+}
+
+void DefaultEpollServerSocketChannelConfig::setReceiveBufferSize(int receiveBufferSize) {
+    if (::setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
+                     &receiveBufferSize, sizeof(receiveBufferSize)) < 0) {
+        throw ChannelException("setsockopt(SO_RCVBUF) failed", errno);
+    }
+}
+
+void DefaultEpollServerSocketChannelConfig::setBacklog(int backlog) {
+    if (backlog < 0) {
+        throw InvalidArgumentException("backlog: is less then zero");
+    }
+    this->backlog = backlog;
+}
+
+}}}}
@@ -0,0 +1,76 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_DEFAULTEPOLLSERVERSOCKETCHANNELCONFIG_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_DEFAULTEPOLLSERVERSOCKETCHANNELCONFIG_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <sys/socket.h>
+#include "cetty/channel/socket/DefaultServerSocketChannelConfig.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::channel::socket;
+
+/**
+ * The {@link ServerSocketChannelConfig} of the native epoll transport,
+ * the options are applied on the listening file descriptor directly.
+ */
+class DefaultEpollServerSocketChannelConfig
+    : public cetty::channel::socket::DefaultServerSocketChannelConfig {
+
+public:
+    /**
+     * Creates a new instance.
+     */
+    DefaultEpollServerSocketChannelConfig(int fd)
+        : fd(fd), backlog(SOMAXCONN), reusePort(false) {
+    }
+
+    virtual bool setOption(const std::string& key, const boost::any& value);
+
+    virtual bool isReuseAddress() const;
+    virtual void setReuseAddress(bool reuseAddress);
+
+    virtual bool isReusePort() const {
+        return this->reusePort;
+    }
+
+    virtual void setReusePort(bool reusePort);
+
+    virtual int  getReceiveBufferSize() const;
+    virtual void setReceiveBufferSize(int receiveBufferSize);
+
+    virtual void setPerformancePreferences(int connectionTime, int latency, int bandwidth) {
+    }
+
+    virtual int getBacklog() const {
+        return this->backlog;
+    }
+
+    virtual void setBacklog(int backlog);
+
+    virtual bool channelOwnBuffer() const { return false; }
+
+private:
+    int fd;
+    int backlog;
+    bool reusePort;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_DEFAULTEPOLLSERVERSOCKETCHANNELCONFIG_H)
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/epoll/DefaultEpollSocketChannelConfig.h"
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "cetty/channel/ChannelException.h"
+#include "cetty/util/Exception.h"
+#include "cetty/util/internal/ConversionUtil.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::util;
+using namespace cetty::util::internal;
+
+bool DefaultEpollSocketChannelConfig::setOption(const std::string& key,
+                                                const boost::any& value) {
+    if (DefaultSocketChannelConfig::setOption(key, value)) {
+        return true;
+    }
+
+    if (key == "receiveBufferSize") {
+        setReceiveBufferSize(ConversionUtil::toInt(value));
+    }
+    else if (key == "sendBufferSize") {
+        setSendBufferSize(ConversionUtil::toInt(value));
+    }
+    else if (key == "tcpNoDelay") {
+        setTcpNoDelay(ConversionUtil::toBoolean(value));
+    }
+    else if (key == "keepAlive") {
+        setKeepAlive(ConversionUtil::toBoolean(value));
+    }
+    else if (key == "reuseAddress") {
+        setReuseAddress(ConversionUtil::toBoolean(value));
+    }
+    else if (key == "soLinger") {
+        setSoLinger(ConversionUtil::toInt(value));
+    }
+    else if (key == "writeBufferHighWaterMark") {
+        setWriteBufferHighWaterMark(ConversionUtil::toInt(value));
+    }
+    else if (key == "writeBufferLowWaterMark") {
+        setWriteBufferLowWaterMark(ConversionUtil::toInt(value));
+    }
+    else if (key == "writeSpinCount") {
+        setWriteSpinCount(ConversionUtil::toInt(value));
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+int DefaultEpollSocketChannelConfig::getReceiveBufferSize() const {
+    return getIntOption(SOL_SOCKET, SO_RCVBUF);
+}
+
+int DefaultEpollSocketChannelConfig::getSendBufferSize() const {
+    return getIntOption(SOL_SOCKET, SO_SNDBUF);
+}
+
+int DefaultEpollSocketChannelConfig::getSoLinger() const {
+    struct linger option;
+    socklen_t length = sizeof(option);
+
+    if (::getsockopt(fd, SOL_SOCKET, SO_LINGER, &option, &length) < 0) {
+        throw ChannelException("getsockopt(SO_LINGER) failed", errno);
+    }
+    return option.l_onoff ? option.l_linger : -1;
+}
+
+bool DefaultEpollSocketChannelConfig::isKeepAlive() const {
+    return getIntOption(SOL_SOCKET, SO_KEEPALIVE) != 0;
+}
+
+bool DefaultEpollSocketChannelConfig::isReuseAddress() const {
+    return getIntOption(SOL_SOCKET, SO_REUSEADDR) != 0;
+}
+
+bool DefaultEpollSocketChannelConfig::isTcpNoDelay() const {
+    return getIntOption(IPPROTO_TCP, TCP_NODELAY) != 0;
+}
+
+void DefaultEpollSocketChannelConfig::setKeepAlive(bool keepAlive) {
+    setIntOption(SOL_SOCKET, SO_KEEPALIVE, keepAlive ? 1 : 0);
+}
+
+void DefaultEpollSocketChannelConfig::setReceiveBufferSize(int receiveBufferSize) {
+    setIntOption(SOL_SOCKET, SO_RCVBUF, receiveBufferSize);
+}
+
+void DefaultEpollSocketChannelConfig::setReuseAddress(bool reuseAddress) {
+    setIntOption(SOL_SOCKET, SO_REUSEADDR, reuseAddress ? 1 : 0);
+}
+
+void DefaultEpollSocketChannelConfig::setSendBufferSize(int sendBufferSize) {
+    setIntOption(SOL_SOCKET, SO_SNDBUF, sendBufferSize);
+}
+
+void DefaultEpollSocketChannelConfig::setSoLinger(int soLinger) {
+    if (!setLinger(soLinger)) {
+        throw ChannelException("setsockopt(SO_LINGER) failed", errno);
+    }
+    storeOption(SOL_SOCKET, SO_LINGER, soLinger);
+}
+
+void DefaultEpollSocketChannelConfig::setTcpNoDelay(bool tcpNoDelay) {
+    setIntOption(IPPROTO_TCP, TCP_NODELAY, tcpNoDelay ? 1 : 0);
+}
+
+void DefaultEpollSocketChannelConfig::setWriteBufferHighWaterMark(int writeBufferHighWaterMark) {
+    if (writeBufferHighWaterMark < writeBufferLowWaterMark) {
+        throw InvalidArgumentException(
+            "writeBufferHighWaterMark must be greater than writeBufferLowWaterMark");
+    }
+    this->writeBufferHighWaterMark = writeBufferHighWaterMark;
+}
+
+void DefaultEpollSocketChannelConfig::setWriteBufferLowWaterMark(int writeBufferLowWaterMark) {
+    if (writeBufferLowWaterMark < 0 ||
+            writeBufferLowWaterMark > writeBufferHighWaterMark) {
+        throw InvalidArgumentException(
+            "writeBufferLowWaterMark must be in [0, writeBufferHighWaterMark]");
+    }
+    this->writeBufferLowWaterMark = writeBufferLowWaterMark;
+}
+
+void DefaultEpollSocketChannelConfig::setWriteSpinCount(int writeSpinCount) {
+    if (writeSpinCount <= 0) {
+        throw InvalidArgumentException("writeSpinCount must be a positive integer.");
+    }
+    this->writeSpinCount = writeSpinCount;
+}
+
+int DefaultEpollSocketChannelConfig::getIntOption(int level, int option) const {
+    int value = 0;
+    socklen_t length = sizeof(value);
+
+    if (::getsockopt(fd, level, option, &value, &length) < 0) {
+        throw ChannelException("getsockopt failed", errno);
+    }
+    return value;
+}
+
+void DefaultEpollSocketChannelConfig::setIntOption(int level, int option, int value) {
+    if (::setsockopt(fd, level, option, &value, sizeof(value)) < 0) {
+        throw ChannelException("setsockopt failed", errno);
+    }
+    storeOption(level, option, value);
+}
+
+bool DefaultEpollSocketChannelConfig::setLinger(int soLinger) {
+    struct linger option;
+    option.l_onoff = soLinger > 0 ? 1 : 0;
+    option.l_linger = soLinger > 0 ? soLinger : 0;
+
+    return ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &option, sizeof(option)) == 0;
+}
+
+void DefaultEpollSocketChannelConfig::storeOption(int level, int option, int value) {
+    for (std::size_t i = 0; i < options.size(); ++i) {
+        if (options[i].level == level && options[i].option == option) {
+            options[i].value = value;
+            return;
+        }
+    }
+
+    SocketOption stored;
+    stored.level = level;
+    stored.option = option;
+    stored.value = value;
+    options.push_back(stored);
+}
+
+bool DefaultEpollSocketChannelConfig::reapplyOptions() {
+    bool applied = true;
+
+    // the values are the ones set, not read back, SO_RCVBUF and SO_SNDBUF
+    // read back doubled on linux.
+    for (std::size_t i = 0; i < options.size(); ++i) {
+        const SocketOption& stored = options[i];
+
+        if (stored.level == SOL_SOCKET && stored.option == SO_LINGER) {
+            applied = setLinger(stored.value) && applied;
+        }
+        else if (::setsockopt(fd, stored.level, stored.option,
+                              &stored.value, sizeof(stored.value)) < 0) {
+            applied = false;
+        }
+    }
+
+    return applied;
+}
+
+}}}}
@@ -0,0 +1,131 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_DEFAULTEPOLLSOCKETCHANNELCONFIG_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_DEFAULTEPOLLSOCKETCHANNELCONFIG_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+#include "cetty/channel/socket/DefaultSocketChannelConfig.h"
+
+namespace cetty { namespace channel  { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+
+/**
+ * The {@link SocketChannelConfig} of the native epoll transport, the options
+ * are set on the file descriptor directly with <tt>setsockopt</tt>.
+ *
+ * In addition to the options provided by {@link SocketChannelConfig},
+ * the following options are available in the option map:
+ *
+ * <table border="1" cellspacing="0" cellpadding="6">
+ * <tr>
+ * <th>Name</th><th>Associated setter method</th>
+ * </tr><tr>
+ * <td><tt>"writeBufferHighWaterMark"</tt></td><td>{@link #setWriteBufferHighWaterMark(int)}</td>
+ * </tr><tr>
+ * <td><tt>"writeBufferLowWaterMark"</tt></td><td>{@link #setWriteBufferLowWaterMark(int)}</td>
+ * </tr><tr>
+ * <td><tt>"writeSpinCount"</tt></td><td>{@link #setWriteSpinCount(int)}</td>
+ * </tr>
+ * </table>
+ */
+class DefaultEpollSocketChannelConfig : public cetty::channel::socket::DefaultSocketChannelConfig {
+public:
+    DefaultEpollSocketChannelConfig(int fd)
+        : DefaultSocketChannelConfig(),
+          fd(fd),
+          writeSpinCount(DEFAULT_WRITE_SPIN_COUNT),
+          writeBufferLowWaterMark(DEFAULT_WRITE_BUFFER_LOW_WATERMARK),
+          writeBufferHighWaterMark(DEFAULT_WRITE_BUFFER_HIGH_WATERMARK) {
+        setChannelOwnBufferSize(DEFAULT_CHANNEL_OWN_BUFFER_SIZE);
+    }
+
+    virtual ~DefaultEpollSocketChannelConfig() {}
+
+    virtual bool setOption(const std::string& key, const boost::any& value);
+
+    virtual int getReceiveBufferSize() const;
+    virtual int getSendBufferSize() const;
+    virtual int getSoLinger() const;
+
+    virtual bool isKeepAlive() const;
+    virtual bool isReuseAddress() const;
+    virtual bool isTcpNoDelay() const;
+
+    virtual void setKeepAlive(bool keepAlive);
+    virtual void setPerformancePreferences(int connectionTime, int latency, int bandwidth) {}
+    virtual void setReceiveBufferSize(int receiveBufferSize);
+    virtual void setReuseAddress(bool reuseAddress);
+    virtual void setSendBufferSize(int sendBufferSize);
+    virtual void setSoLinger(int soLinger);
+    virtual void setTcpNoDelay(bool tcpNoDelay);
+
+    int  getWriteBufferHighWaterMark() const { return writeBufferHighWaterMark; }
+    void setWriteBufferHighWaterMark(int writeBufferHighWaterMark);
+
+    int  getWriteBufferLowWaterMark() const { return writeBufferLowWaterMark; }
+    void setWriteBufferLowWaterMark(int writeBufferLowWaterMark);
+
+    /**
+     * The maximum number of <tt>writev</tt> calls in one flush before
+     * yielding to the other channels of the event loop.
+     */
+    int  getWriteSpinCount() const { return writeSpinCount; }
+    void setWriteSpinCount(int writeSpinCount);
+
+    virtual bool channelOwnBuffer() const { return true; }
+
+    /**
+     * Sets the socket options set so far again, on the new socket which
+     * replaced the one of the channel under the same descriptor.
+     *
+     * @return <tt>false</tt> if any of them failed.
+     */
+    bool reapplyOptions();
+
+private:
+    struct SocketOption {
+        int level;
+        int option;
+        int value;
+    };
+
+    int getIntOption(int level, int option) const;
+    void setIntOption(int level, int option, int value);
+    bool setLinger(int soLinger);
+
+    void storeOption(int level, int option, int value);
+
+private:
+    static const int DEFAULT_CHANNEL_OWN_BUFFER_SIZE = 1024 * 32;
+    static const int DEFAULT_WRITE_SPIN_COUNT = 16;
+    static const int DEFAULT_WRITE_BUFFER_HIGH_WATERMARK = 2 * 1024 * 1024;
+    static const int DEFAULT_WRITE_BUFFER_LOW_WATERMARK  = 2 * 1024;
+
+private:
+    int fd;
+    int writeSpinCount;
+    int writeBufferLowWaterMark;
+    int writeBufferHighWaterMark;
+
+    // the options set on the socket, in order.
+    std::vector<SocketOption> options;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_DEFAULTEPOLLSOCKETCHANNELCONFIG_H)
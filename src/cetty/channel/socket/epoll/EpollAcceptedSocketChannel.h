@@ -0,0 +1,76 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLACCEPTEDSOCKETCHANNEL_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_EPOLLACCEPTEDSOCKETCHANNEL_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/socket/epoll/EpollSocketChannel.h"
+
+namespace cetty { namespace channel  { namespace socket { namespace epoll {
+
+class EpollAcceptedSocketChannel : public EpollSocketChannel {
+public:
+    EpollAcceptedSocketChannel(
+        Channel* parent,
+        ChannelFactory* factory,
+        ChannelPipeline* pipeline,
+        ChannelSink* sink,
+        EpollEventLoopPool::EventLoop& eventLoop,
+        int fd)
+            : EpollSocketChannel(parent, factory, pipeline, sink, eventLoop, fd) {
+    }
+
+    virtual ~EpollAcceptedSocketChannel() {}
+
+    /**
+     * must be called in the event loop thread of the channel.
+     */
+    bool start() {
+        Channels::fireChannelOpen(*this);
+
+        const SocketAddress& localAddress = EpollSocketChannel::getLocalAddress();
+        if (!localAddress.validated()) {
+            // logging
+            return false;
+        }
+        Channels::fireChannelBound(*this, localAddress);
+
+        const SocketAddress& remoteAddress = EpollSocketChannel::getRemoteAddress();
+        if (!remoteAddress.validated()) {
+            // logging
+            return false;
+        }
+
+        EpollSocketChannel::setConnected();
+        Channels::fireChannelConnected(*this, remoteAddress);
+
+        if (!registerEvents()) {
+            return false;
+        }
+
+        // edge-triggered, the data may have arrived before registering.
+        if (isReadable()) {
+            handleRead();
+        }
+
+        return true;
+    }
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLACCEPTEDSOCKETCHANNEL_H)
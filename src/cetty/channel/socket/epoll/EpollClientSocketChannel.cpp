@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/epoll/EpollClientSocketChannel.h"
+
+#include <errno.h>
+#include <sys/socket.h>
+
+#include "cetty/channel/IpAddress.h"
+#include "cetty/channel/ChannelException.h"
+#include "cetty/logging/InternalLoggerFactory.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::logging;
+
+InternalLogger* EpollClientSocketChannel::logger
+                    = InternalLoggerFactory::getInstance("EpollClientSocketChannel");
+
+EpollClientSocketChannel::EpollClientSocketChannel(ChannelFactory* factory,
+                                                   ChannelPipeline* pipeline,
+                                                   ChannelSink* sink,
+                                                   EpollEventLoopPool::EventLoop& eventLoop,
+                                                   int ipProtocol)
+    : EpollSocketChannel(NULL, factory, pipeline, sink, eventLoop, openSocket(ipProtocol)) {
+    Channels::fireChannelOpen(*this);
+}
+
+int EpollClientSocketChannel::openSocket(int ipProtocol) {
+    int family = (ipProtocol == IpAddress::IPv6) ? AF_INET6 : AF_INET;
+    int fd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (fd < 0) {
+        throw ChannelException("Failed to open a socket.", errno);
+    }
+    return fd;
+}
+
+}}}}
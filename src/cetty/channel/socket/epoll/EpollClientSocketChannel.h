@@ -0,0 +1,52 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLCLIENTSOCKETCHANNEL_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_EPOLLCLIENTSOCKETCHANNEL_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/socket/epoll/EpollSocketChannel.h"
+
+namespace cetty { namespace logging {
+class InternalLogger;
+}}
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::logging;
+
+class EpollClientSocketChannel : public EpollSocketChannel {
+public:
+    EpollClientSocketChannel(
+            ChannelFactory* factory,
+            ChannelPipeline* pipeline,
+            ChannelSink* sink,
+            EpollEventLoopPool::EventLoop& eventLoop,
+            int ipProtocol);
+
+    virtual ~EpollClientSocketChannel() {}
+
+private:
+    static int openSocket(int ipProtocol);
+
+private:
+    static InternalLogger* logger;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLCLIENTSOCKETCHANNEL_H)
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/epoll/EpollClientSocketChannelFactory.h"
+
+#include "cetty/channel/IpAddress.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/socket/asio/AsioIpAddressImplFactory.h"
+#include "cetty/channel/socket/asio/AsioSocketAddressImplFactory.h"
+#include "cetty/channel/socket/epoll/EpollClientSocketChannel.h"
+#include "cetty/channel/socket/epoll/EpollClientSocketPipelineSink.h"
+#include "cetty/util/internal/epoll/EpollHashedWheelTimerFactory.h"
+#include "cetty/util/Exception.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::util;
+using namespace cetty::util::internal::epoll;
+
+EpollClientSocketChannelFactory::EpollClientSocketChannelFactory(int ioThreadCount)
+    : ipProtocol(IpAddress::IPv4),
+      eventLoopPool(ioThreadCount),
+      servicePool(1) {
+    sink = new EpollClientSocketPipelineSink(eventLoopPool);
+
+    timerFactory = TimerFactoryPtr(new EpollHashedWheelTimerFactory(eventLoopPool));
+    TimerFactory::setFactory(timerFactory);
+
+    socketAddressFactory = new AsioTcpSocketAddressImplFactory(servicePool.getIOService(0));
+    ipAddressFactory = new AsioIpAddressImplFactory();
+
+    SocketAddress::setFacotry(socketAddressFactory);
+    IpAddress::setFactory(ipAddressFactory);
+}
+
+EpollClientSocketChannelFactory::~EpollClientSocketChannelFactory() {
+    if (socketAddressFactory) {
+        delete socketAddressFactory;
+        socketAddressFactory = NULL;
+    }
+
+    if (ipAddressFactory) {
+        delete ipAddressFactory;
+        ipAddressFactory = NULL;
+    }
+
+    if (NULL != sink) {
+        delete sink;
+    }
+}
+
+Channel* EpollClientSocketChannelFactory::newChannel(
+                    cetty::channel::ChannelPipeline* pipeline) {
+    EpollClientSocketChannel* client =
+        new EpollClientSocketChannel(this,
+                                     pipeline,
+                                     sink,
+                                     eventLoopPool.getEventLoop(),
+                                     ipProtocol);
+
+    clientChannels.push_back(client);
+    return client;
+}
+
+void EpollClientSocketChannelFactory::releaseExternalResources() {
+    eventLoopPool.stop();
+    eventLoopPool.waitForExit();
+
+    servicePool.stop();
+    servicePool.waitForExit();
+
+    std::vector<Channel*>::iterator itr;
+    for (itr = clientChannels.begin(); itr != clientChannels.end(); ++itr) {
+        delete *itr;
+    }
+    clientChannels.clear();
+}
+
+void EpollClientSocketChannelFactory::start() {
+    eventLoopPool.run();
+}
+
+}}}}
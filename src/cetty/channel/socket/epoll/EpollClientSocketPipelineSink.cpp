@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/epoll/EpollClientSocketPipelineSink.h"
+
+#include <boost/bind.hpp>
+
+#include "cetty/channel/ChannelState.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/SocketAddress.h"
+
+#include "cetty/channel/socket/epoll/EpollSocketChannel.h"
+#include "cetty/channel/socket/epoll/EpollEventLoopPool.h"
+#include "cetty/channel/socket/epoll/EpollClientSocketChannelFactory.h"
+
+#include "cetty/logging/InternalLoggerFactory.h"
+#include "cetty/util/internal/ConversionUtil.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::util;
+using namespace cetty::util::internal;
+using namespace cetty::logging;
+
+InternalLogger* EpollClientSocketPipelineSink::logger
+                    = InternalLoggerFactory::getInstance("EpollClientSocketPipelineSink");
+
+void EpollClientSocketPipelineSink::writeRequested(const cetty::channel::ChannelPipeline& pipeline,
+                                                   const cetty::channel::MessageEvent& e) {
+    Channel& channel = e.getChannel();
+    (static_cast<EpollSocketChannel*>(&channel))->write(e);
+}
+
+void EpollClientSocketPipelineSink::stateChangeRequested(const cetty::channel::ChannelPipeline& pipeline,
+                                                         const cetty::channel::ChannelStateEvent& e) {
+    Channel& channel = e.getChannel();
+    handleStateChange(*static_cast<EpollSocketChannel*>(&channel), e);
+}
+
+void EpollClientSocketPipelineSink::handleStateChange(EpollSocketChannel& channel,
+                                                      const ChannelStateEvent& evt) {
+    const ChannelFuturePtr& future = evt.getFuture();
+    const ChannelState& state = evt.getState();
+    const boost::any& value = evt.getValue();
+
+    if (state == ChannelState::OPEN) {
+        if (value.empty()) {
+            channel.close(future);
+        }
+    }
+    else if (state == ChannelState::BOUND) {
+        if (value.empty()) {
+            channel.close(future);
+        }
+    }
+    else if (state == ChannelState::CONNECTED) {
+        if (!value.empty()) {
+            const SocketAddress* address = boost::any_cast<SocketAddress>(&value);
+            if (address) {
+                connect(channel, future, *address);
+            }
+        }
+        else {
+            channel.close(future);
+        }
+    }
+    else if (state == ChannelState::INTEREST_OPS) {
+        channel.setInterestOps(future, ConversionUtil::toInt(value));
+    }
+}
+
+void EpollClientSocketPipelineSink::connect(EpollSocketChannel& channel,
+                                            const ChannelFuturePtr& cf,
+                                            const SocketAddress& remoteAddress) {
+    // the connect request usually comes from the bootstrap thread, the
+    // socket must only be touched in its event loop.
+    channel.getEventLoop()->dispatch(boost::bind(&EpollSocketChannel::connect,
+                                                &channel,
+                                                cf,
+                                                remoteAddress));
+
+    if (eventLoopPool.isSingleThread()) {
+        EpollClientSocketChannelFactory* factory
+            = dynamic_cast<EpollClientSocketChannelFactory*>(&channel.getFactory());
+
+        factory->start();
+    }
+}
+
+}}}}
@@ -0,0 +1,69 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLCLIENTSOCKETPIPELINESINK_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_EPOLLCLIENTSOCKETPIPELINESINK_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/AbstractChannelSink.h"
+
+namespace cetty { namespace channel {
+class SocketAddress;
+class ChannelPipeline;
+class MessageEvent;
+}}
+
+namespace cetty { namespace logging {
+class InternalLogger;
+}}
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::logging;
+
+class EpollSocketChannel;
+class EpollEventLoopPool;
+
+class EpollClientSocketPipelineSink : public ::cetty::channel::AbstractChannelSink {
+public:
+    EpollClientSocketPipelineSink(EpollEventLoopPool& eventLoopPool)
+        : eventLoopPool(eventLoopPool) {
+    }
+
+    virtual ~EpollClientSocketPipelineSink() {}
+
+    virtual void writeRequested(const cetty::channel::ChannelPipeline& pipeline,
+                                const cetty::channel::MessageEvent& e);
+
+    virtual void stateChangeRequested(const cetty::channel::ChannelPipeline& pipeline,
+                                      const cetty::channel::ChannelStateEvent& e);
+
+private:
+    void connect(EpollSocketChannel& channel,
+                 const ChannelFuturePtr& cf,
+                 const SocketAddress& remoteAddress);
+
+    void handleStateChange(EpollSocketChannel& channel, const ChannelStateEvent& evt);
+
+private:
+    static InternalLogger* logger;
+    EpollEventLoopPool& eventLoopPool;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLCLIENTSOCKETPIPELINESINK_H)
@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/epoll/EpollEventLoopPool.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include <boost/bind.hpp>
+
+#include "cetty/channel/ChannelException.h"
+#include "cetty/util/Exception.h"
+#include "cetty/util/Integer.h"
+#include "cetty/logging/InternalLogger.h"
+#include "cetty/logging/InternalLoggerFactory.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::util;
+using namespace cetty::logging;
+
+static InternalLogger* logger =
+    InternalLoggerFactory::getInstance("EpollEventLoopPool");
+
+EpollEventLoopPool::EventLoop::EventLoop(int index)
+    : poolIndex(index),
+      epollFd(-1),
+      wakeupFd(-1),
+      timerFd(-1),
+      stopped(false),
+      tickHandler(*this) {
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        throw ChannelException("Failed to create the epoll instance.", errno);
+    }
+
+    wakeupFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeupFd < 0) {
+        ::close(epollFd);
+        throw ChannelException("Failed to create the wakeup eventfd.", errno);
+    }
+
+    // the wakeup fd is the only one registered without a handler.
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLET;
+    event.data.ptr = NULL;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &event);
+
+    timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd < 0) {
+        ::close(wakeupFd);
+        ::close(epollFd);
+        throw ChannelException("Failed to create the tick timerfd.", errno);
+    }
+
+    add(timerFd, EPOLLIN, &tickHandler);
+    timer = TimerPtr(new HashedWheelTimer(*this));
+}
+
+EpollEventLoopPool::EventLoop::~EventLoop() {
+    // cancels the timeouts left, and drops the armed tick holding the timer.
+    timer->stop();
+
+    if (timerFd >= 0) {
+        ::close(timerFd);
+    }
+    if (wakeupFd >= 0) {
+        ::close(wakeupFd);
+    }
+    if (epollFd >= 0) {
+        ::close(epollFd);
+    }
+}
+
+bool EpollEventLoopPool::EventLoop::add(int fd,
+                                        boost::uint32_t events,
+                                        EventHandler* handler) {
+    struct epoll_event event;
+    event.events = events | EPOLLET;
+    event.data.ptr = handler;
+    return ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+bool EpollEventLoopPool::EventLoop::modify(int fd,
+                                           boost::uint32_t events,
+                                           EventHandler* handler) {
+    struct epoll_event event;
+    event.events = events | EPOLLET;
+    event.data.ptr = handler;
+    return ::epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+bool EpollEventLoopPool::EventLoop::remove(int fd) {
+    // a non-NULL event is required by the kernels before 2.6.9.
+    struct epoll_event event;
+    return ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, &event) == 0;
+}
+
+void EpollEventLoopPool::EventLoop::post(const Functor& functor) {
+    bool needWakeup;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        needWakeup = pendingFunctors.empty();
+        pendingFunctors.push_back(functor);
+    }
+
+    // only the first functor of a batch needs to kick the loop, the rest
+    // will be drained in the same round.
+    if (needWakeup) {
+        wakeup();
+    }
+}
+
+void EpollEventLoopPool::EventLoop::dispatch(const Functor& functor) {
+    if (isInLoopThread()) {
+        functor();
+    }
+    else {
+        post(functor);
+    }
+}
+
+void EpollEventLoopPool::EventLoop::run() {
+    struct epoll_event events[MAX_EVENTS_PER_POLL];
+
+    while (!stopped) {
+        int count = ::epoll_wait(epollFd, events, MAX_EVENTS_PER_POLL, -1);
+
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            logger->error(std::string("epoll event loop has error = ") +
+                          Integer::toString(errno));
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            EventHandler* handler =
+                static_cast<EventHandler*>(events[i].data.ptr);
+
+            if (handler) {
+                handler->handleEvents(events[i].events);
+            }
+            else {
+                handleWakeup();
+            }
+        }
+
+        runPendingFunctors();
+    }
+}
+
+void EpollEventLoopPool::EventLoop::stop() {
+    stopped = true;
+    wakeup();
+}
+
+void EpollEventLoopPool::EventLoop::wakeup() {
+    boost::uint64_t one = 1;
+    ssize_t n = ::write(wakeupFd, &one, sizeof(one));
+    (void)n;
+}
+
+void EpollEventLoopPool::EventLoop::handleWakeup() {
+    boost::uint64_t value;
+    while (::read(wakeupFd, &value, sizeof(value)) > 0) {
+    }
+}
+
+void EpollEventLoopPool::EventLoop::expiresAt(const HashedWheelTimer::TimeType& time,
+                                              const TickFunctor& onTick) {
+    TickFunctor replaced;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        replaced.swap(tickFunctor);
+        tickFunctor = onTick;
+    }
+
+    boost::int64_t micros = (time - boost::asio::deadline_timer::traits_type::now())
+                            .total_microseconds();
+
+    // a zero value would disarm the timerfd.
+    if (micros <= 0) {
+        micros = 1;
+    }
+
+    struct itimerspec spec;
+    ::memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = static_cast<time_t>(micros / 1000000);
+    spec.it_value.tv_nsec = static_cast<long>((micros % 1000000) * 1000);
+    ::timerfd_settime(timerFd, 0, &spec, NULL);
+}
+
+void EpollEventLoopPool::EventLoop::cancel() {
+    struct itimerspec spec;
+    ::memset(&spec, 0, sizeof(spec));
+    ::timerfd_settime(timerFd, 0, &spec, NULL);
+
+    TickFunctor dropped;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        dropped.swap(tickFunctor);
+    }
+}
+
+void EpollEventLoopPool::EventLoop::handleTick() {
+    boost::uint64_t expirations;
+    while (::read(timerFd, &expirations, sizeof(expirations)) > 0) {
+    }
+
+    // the tick re-arms the timerfd itself while there are pending timeouts.
+    TickFunctor onTick;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        onTick.swap(tickFunctor);
+    }
+
+    if (onTick) {
+        onTick();
+    }
+}
+
+void EpollEventLoopPool::EventLoop::runPendingFunctors() {
+    std::vector<Functor> functors;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        if (pendingFunctors.empty()) {
+            return;
+        }
+        functors.swap(pendingFunctors);
+    }
+
+    for (std::size_t i = 0, j = functors.size(); i < j; ++i) {
+        functors[i]();
+    }
+}
+
+EpollEventLoopPool::EpollEventLoopPool(int poolSize)
+    : usingthread(true),
+      running(false),
+      nextEventLoopIndex(0),
+      mainThreadId(boost::this_thread::get_id()) {
+    if (poolSize < 0) {
+        poolSize = boost::thread::hardware_concurrency();
+    }
+    else if (poolSize == 0) {
+        usingthread = false;
+        poolSize = 1;
+    }
+
+    for (int i = 0; i < poolSize; ++i) {
+        eventLoops.push_back(EventLoopPtr(new EventLoop(i)));
+    }
+
+    // automatic start
+    if (usingthread) {
+        // the threads wait for the lock, so every event loop knows its
+        // thread before any of them runs.
+        boost::mutex::scoped_lock lock(startMutex);
+
+        for (std::size_t i = 0; i < eventLoops.size(); ++i) {
+            ThreadPtr thread(new boost::thread(
+                boost::bind(&EpollEventLoopPool::runEventLoop,
+                            this,
+                            eventLoops[i].get())));
+            threads.push_back(thread);
+            eventLoops[i]->threadId = thread->get_id();
+        }
+        running = true;
+    }
+    else {
+        // runs in the main thread.
+        eventLoops[0]->threadId = mainThreadId;
+    }
+}
+
+EpollEventLoopPool::~EpollEventLoopPool() {
+    stop();
+    waitForExit();
+}
+
+void EpollEventLoopPool::runEventLoop(EventLoop* eventLoop) {
+    {
+        boost::mutex::scoped_lock lock(startMutex);
+    }
+
+    eventLoop->run();
+}
+
+void EpollEventLoopPool::run() {
+    if (running) return;
+
+    running = true;
+    if (!usingthread) {
+        eventLoops[0]->run();
+    }
+}
+
+void EpollEventLoopPool::waitForExit() {
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->join();
+    }
+    threads.clear();
+}
+
+void EpollEventLoopPool::stop() {
+    if (!running) return;
+
+    for (std::size_t i = 0; i < eventLoops.size(); ++i) {
+        eventLoops[i]->stop();
+    }
+}
+
+EpollEventLoopPool::EventLoop& EpollEventLoopPool::getEventLoop() {
+    if (eventLoops.size() == 1) {
+        return *eventLoops[0];
+    }
+
+    // Use a round-robin scheme to choose the next event loop to use.
+    unsigned long index =
+        nextEventLoopIndex.fetch_add(1, boost::memory_order_relaxed);
+
+    return *eventLoops[index % eventLoops.size()];
+}
+
+boost::thread::id EpollEventLoopPool::getThreadId(int index) {
+    if (!usingthread) return mainThreadId;
+
+    BOOST_ASSERT(index >= 0 && index < (int)threads.size() && "Out of range");
+    return threads[index]->get_id();
+}
+
+}}}}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/epoll/EpollServerSocketChannel.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/IpAddress.h"
+#include "cetty/channel/ChannelException.h"
+#include "cetty/logging/InternalLoggerFactory.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+InternalLogger* EpollServerSocketChannel::logger =
+        InternalLoggerFactory::getInstance("EpollServerSocketChannel");
+
+EpollServerSocketChannel::EpollServerSocketChannel(ChannelFactory* factory,
+                                                   ChannelPipeline* pipeline,
+                                                   ChannelSink* sink,
+                                                   int ipProtocol)
+    : ServerSocketChannel(factory, pipeline, sink),
+      fd(openSocket(ipProtocol)),
+      bound(false),
+      config(fd) {
+    Channels::fireChannelOpen(*this);
+}
+
+EpollServerSocketChannel::~EpollServerSocketChannel() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+const SocketAddress& EpollServerSocketChannel::getLocalAddress() const {
+    if (localAddress.validated() || fd < 0) {
+        return localAddress;
+    }
+
+    struct sockaddr_storage storage;
+    socklen_t length = sizeof(storage);
+    if (::getsockname(fd, reinterpret_cast<struct sockaddr*>(&storage), &length) < 0) {
+        return SocketAddress::NULL_ADDRESS;
+    }
+
+    char host[INET6_ADDRSTRLEN] = {0};
+    int port = 0;
+
+    if (storage.ss_family == AF_INET6) {
+        const struct sockaddr_in6* addr =
+            reinterpret_cast<const struct sockaddr_in6*>(&storage);
+        ::inet_ntop(AF_INET6, &addr->sin6_addr, host, sizeof(host));
+        port = ntohs(addr->sin6_port);
+    }
+    else {
+        const struct sockaddr_in* addr =
+            reinterpret_cast<const struct sockaddr_in*>(&storage);
+        ::inet_ntop(AF_INET, &addr->sin_addr, host, sizeof(host));
+        port = ntohs(addr->sin_port);
+    }
+
+    localAddress = SocketAddress(std::string(host), port);
+    return localAddress;
+}
+
+bool EpollServerSocketChannel::setClosed() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    return AbstractChannel::setClosed();
+}
+
+int EpollServerSocketChannel::openSocket(int ipProtocol) {
+    int family = (ipProtocol == IpAddress::IPv6) ? AF_INET6 : AF_INET;
+    int fd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (fd < 0) {
+        throw ChannelException("Failed to open a server socket.", errno);
+    }
+    return fd;
+}
+
+}}}}
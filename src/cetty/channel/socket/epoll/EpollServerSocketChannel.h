@@ -0,0 +1,83 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSERVERSOCKETCHANNEL_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSERVERSOCKETCHANNEL_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/ChannelConfig.h"
+#include "cetty/channel/socket/ServerSocketChannel.h"
+#include "cetty/channel/socket/epoll/DefaultEpollServerSocketChannelConfig.h"
+
+namespace cetty { namespace logging {
+class InternalLogger;
+}}
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::logging;
+using namespace cetty::channel;
+using namespace cetty::channel::socket;
+
+// only response to bind port, open and close.
+class EpollServerSocketChannel : public cetty::channel::socket::ServerSocketChannel {
+public:
+    EpollServerSocketChannel(ChannelFactory* factory,
+                             ChannelPipeline* pipeline,
+                             ChannelSink* sink,
+                             int ipProtocol);
+
+    virtual ~EpollServerSocketChannel();
+
+    int getFd() const { return fd; }
+
+    cetty::channel::ChannelConfig& getConfig() { return config; }
+    const cetty::channel::ChannelConfig& getConfig() const {
+        return config;
+    }
+
+    const SocketAddress& getLocalAddress() const;
+
+    const SocketAddress& getRemoteAddress() const {
+        return SocketAddress::NULL_ADDRESS;
+    }
+
+    bool isBound() const {
+        return isOpen() && bound;
+    }
+
+    void setBound() {
+        bound = true;
+    }
+
+    bool setClosed();
+
+private:
+    static int openSocket(int ipProtocol);
+
+private:
+    static InternalLogger* logger;
+
+    int  fd;
+    bool bound;
+
+    DefaultEpollServerSocketChannelConfig config;
+    mutable SocketAddress localAddress;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSERVERSOCKETCHANNEL_H)
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/epoll/EpollServerSocketChannelFactory.h"
+
+#include "cetty/channel/IpAddress.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/ChannelException.h"
+#include "cetty/channel/socket/asio/AsioSocketAddressImplFactory.h"
+#include "cetty/channel/socket/asio/AsioIpAddressImplFactory.h"
+#include "cetty/channel/socket/epoll/EpollServerSocketChannel.h"
+#include "cetty/channel/socket/epoll/EpollServerSocketPipelineSink.h"
+#include "cetty/util/internal/epoll/EpollHashedWheelTimerFactory.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::util::internal::epoll;
+
+EpollServerSocketChannelFactory::EpollServerSocketChannelFactory(int ioThreadCount)
+    : ipProtocol(IpAddress::IPv4),
+      eventLoopPool(ioThreadCount),
+      servicePool(1) {
+
+    this->sink = new EpollServerSocketPipelineSink(eventLoopPool);
+
+    timerFactory = TimerFactoryPtr(new EpollHashedWheelTimerFactory(eventLoopPool));
+    TimerFactory::setFactory(timerFactory);
+
+    socketAddressFactory = new AsioTcpSocketAddressImplFactory(servicePool.getIOService(0));
+    SocketAddress::setFacotry(socketAddressFactory);
+
+    ipAddressFactory = new AsioIpAddressImplFactory();
+    IpAddress::setFactory(ipAddressFactory);
+}
+
+EpollServerSocketChannelFactory::~EpollServerSocketChannelFactory() {
+    if (this->sink) {
+        delete sink;
+    }
+
+    if (socketAddressFactory) {
+        delete socketAddressFactory;
+        socketAddressFactory = NULL;
+    }
+
+    if (ipAddressFactory) {
+        delete ipAddressFactory;
+        ipAddressFactory = NULL;
+    }
+}
+
+Channel* EpollServerSocketChannelFactory::newChannel(cetty::channel::ChannelPipeline* pipeline) {
+    EpollServerSocketChannel* channel;
+    try {
+        channel = new EpollServerSocketChannel(this, pipeline, sink, ipProtocol);
+        eventLoopPool.run();
+    }
+    catch (const ChannelException& e) {
+        e.rethrow();
+    }
+    catch (...) {
+        throw ChannelException("may be memory allocation error, or others");
+    }
+
+    channels.push_back(channel);
+    return (Channel*)channel;
+}
+
+void EpollServerSocketChannelFactory::releaseExternalResources() {
+    eventLoopPool.stop();
+    eventLoopPool.waitForExit();
+
+    servicePool.stop();
+    servicePool.waitForExit();
+
+    std::vector<EpollServerSocketChannel*>::iterator itr;
+    for (itr = channels.begin(); itr != channels.end(); ++itr) {
+        delete *itr;
+    }
+    channels.clear();
+}
+
+}}}}
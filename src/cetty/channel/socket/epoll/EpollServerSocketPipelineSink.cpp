@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/epoll/EpollServerSocketPipelineSink.h"
+
+#include <errno.h>
+#include <string.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include <boost/bind.hpp>
+
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/ChannelState.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/ChannelException.h"
+#include "cetty/channel/ChannelPipelineFactory.h"
+#include "cetty/channel/socket/epoll/EpollAcceptedSocketChannel.h"
+#include "cetty/channel/socket/epoll/EpollServerSocketChannel.h"
+
+#include "cetty/logging/InternalLogger.h"
+#include "cetty/logging/InternalLoggerFactory.h"
+
+#include "cetty/util/internal/ConversionUtil.h"
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::logging;
+using namespace cetty::util::internal;
+
+InternalLogger* EpollServerSocketPipelineSink::logger =
+    InternalLoggerFactory::getInstance("EpollServerSocketPipelineSink");
+
+EpollServerSocketPipelineSink::Boss::Boss(EpollServerSocketPipelineSink& sink,
+                                          EpollServerSocketChannel& channel,
+                                          EpollEventLoopPool& eventLoopPool,
+                                          int listenFd,
+                                          bool ownsFd,
+                                          int eventLoopIndex)
+    : listenFd(listenFd),
+      ownsFd(ownsFd),
+      acceptOnOwnLoop(eventLoopIndex >= 0),
+      eventLoopPool(eventLoopPool),
+      eventLoop(eventLoopPool.getEventLoop(eventLoopIndex >= 0 ? eventLoopIndex : 0)),
+      serverChannel(channel),
+      sink(sink) {
+}
+
+EpollServerSocketPipelineSink::Boss::~Boss() {
+    // the event loops have been stopped, if the boss was not.
+    if (ownsFd && listenFd >= 0) {
+        ::close(listenFd);
+    }
+}
+
+bool EpollServerSocketPipelineSink::Boss::start() {
+    return eventLoop.add(listenFd, EPOLLIN, this);
+}
+
+void EpollServerSocketPipelineSink::Boss::stop() {
+    if (listenFd >= 0) {
+        eventLoop.remove(listenFd);
+
+        if (ownsFd) {
+            ::close(listenFd);
+        }
+        listenFd = -1;
+    }
+}
+
+void EpollServerSocketPipelineSink::Boss::handleEvents(boost::uint32_t events) {
+    // edge-triggered, accept until the backlog is empty.
+    while (listenFd >= 0) {
+        int fd = ::accept4(listenFd,
+                           NULL,
+                           NULL,
+                           SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd >= 0) {
+            handleAccept(fd);
+            continue;
+        }
+
+        if (errno == EINTR || errno == ECONNABORTED) {
+            continue;
+        }
+
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            logger->warn(
+                std::string("Failed to accept a connection. ErrorCode:") +
+                Integer::toString(errno));
+        }
+        break;
+    }
+}
+
+void EpollServerSocketPipelineSink::Boss::handleAccept(int fd) {
+    EpollAcceptedSocketChannel* channel = NULL;
+
+    try {
+        ChannelPipeline* pipeline =
+            serverChannel.getConfig().getPipelineFactory()->getPipeline();
+
+        EpollEventLoopPool::EventLoop& loop =
+            acceptOnOwnLoop ? eventLoop : eventLoopPool.getEventLoop();
+        channel = new EpollAcceptedSocketChannel(&serverChannel,
+                                                 &(serverChannel.getFactory()),
+                                                 pipeline,
+                                                 &sink,
+                                                 loop,
+                                                 fd);
+    }
+    catch (const std::exception& e) {
+        ::close(fd);
+        logger->warn(std::string("Failed to initialize an accepted socket: ") + e.what());
+        return;
+    }
+
+    {
+        boost::mutex::scoped_lock lock(sink.mutex);
+        sink.childrenChannels.insert(
+            std::make_pair(Integer(channel->getId()),
+                           static_cast<EpollSocketChannel*>(channel)));
+    }
+
+    channel->getEventLoop()->dispatch(boost::bind(
+        &EpollServerSocketPipelineSink::startAcceptedChannel, &sink, channel));
+}
+
+EpollServerSocketPipelineSink::~EpollServerSocketPipelineSink() {
+    // closes the listening sockets of the bosses which were never stopped.
+    for (std::size_t i = 0; i < bosses.size(); ++i) {
+        delete bosses[i];
+    }
+
+    for (std::size_t i = 0; i < reusePortFds.size(); ++i) {
+        ::close(reusePortFds[i]);
+    }
+}
+
+void EpollServerSocketPipelineSink::writeRequested(const cetty::channel::ChannelPipeline& pipeline,
+                                                   const cetty::channel::MessageEvent& e) {
+    Channel& channel = e.getChannel();
+    (static_cast<EpollSocketChannel*>(&channel))->write(e);
+}
+
+void EpollServerSocketPipelineSink::stateChangeRequested(const cetty::channel::ChannelPipeline& pipeline,
+                                                         const cetty::channel::ChannelStateEvent& e) {
+    Channel& channel = e.getChannel();
+    if (channel.getParent()) {
+        handleStateChange(*static_cast<EpollSocketChannel*>(&channel), e);
+    }
+    else {
+        handleStateChange(*static_cast<EpollServerSocketChannel*>(&channel), e);
+    }
+}
+
+void EpollServerSocketPipelineSink::handleStateChange(EpollServerSocketChannel& channel,
+                                                      const ChannelStateEvent& evt) {
+    const ChannelFuturePtr& future = evt.getFuture();
+    const ChannelState& state = evt.getState();
+    const boost::any& value = evt.getValue();
+
+    if (state == ChannelState::OPEN) {
+        if (value.empty()) {
+            closeServerChannel(channel, future);
+        }
+    }
+    else if (state == ChannelState::BOUND) {
+        if (value.empty()) {
+            closeServerChannel(channel, future);
+        }
+        else {
+            const SocketAddress* address = boost::any_cast<SocketAddress>(&value);
+            if (address) {
+                bind(channel, future, *address);
+            }
+            else {
+                closeServerChannel(channel, future);
+            }
+        }
+    }
+}
+
+void EpollServerSocketPipelineSink::handleStateChange(EpollSocketChannel& channel,
+                                                      const ChannelStateEvent& evt) {
+    const ChannelFuturePtr& future = evt.getFuture();
+    const ChannelState& state = evt.getState();
+    const boost::any& value = evt.getValue();
+
+    if (ChannelState::INTEREST_OPS == state) {
+        channel.setInterestOps(future, ConversionUtil::toInt(value));
+    }
+    else {
+        // when EpollAcceptedSocketChannel started, it has connected. So it will has
+        // no more OPEN, BOUND, CONNECTED event, but only CLOSE, UNBOUND, DISCONNECTED event.
+        if (value.empty()) {
+            closeAcceptChannel(channel, future);
+        }
+    }
+}
+
+void EpollServerSocketPipelineSink::bind(EpollServerSocketChannel& channel,
+                                         const ChannelFuturePtr& future,
+                                         const SocketAddress& localAddress) {
+    bool bound = false;
+    bool bossStarted = false;
+
+    try {
+        int family = AF_INET;
+        socklen_t length = sizeof(family);
+        ::getsockopt(channel.getFd(), SOL_SOCKET, SO_DOMAIN, &family, &length);
+
+        struct addrinfo hints;
+        struct addrinfo* result = NULL;
+
+        ::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = family;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+
+        std::string host = localAddress.address();
+        int error = ::getaddrinfo(host.empty() ? NULL : host.c_str(),
+                                  Integer::toString(localAddress.port()).c_str(),
+                                  &hints,
+                                  &result);
+        if (error != 0 || !result) {
+            throw ChannelException(std::string("can't resolve the address: ") +
+                                   ::gai_strerror(error));
+        }
+
+        struct sockaddr_storage address;
+        socklen_t addressLength = result->ai_addrlen;
+        ::memcpy(&address, result->ai_addr, addressLength);
+        ::freeaddrinfo(result);
+
+        if (::bind(channel.getFd(),
+                   reinterpret_cast<struct sockaddr*>(&address),
+                   addressLength) < 0) {
+            throw ChannelException("Failed to bind the server socket.", errno);
+        }
+
+        DefaultEpollServerSocketChannelConfig* config =
+            dynamic_cast<DefaultEpollServerSocketChannelConfig*>(&channel.getConfig());
+
+        if (::listen(channel.getFd(), config->getBacklog()) < 0) {
+            throw ChannelException("Failed to listen on the server socket.", errno);
+        }
+
+        bool reusePort = config->isReusePort() && eventLoopPool.size() > 1;
+        if (reusePort) {
+            // the port of the channel's socket, which may be an ephemeral
+            // one if the port 0 is asked for.
+            addressLength = sizeof(address);
+            if (::getsockname(channel.getFd(),
+                              reinterpret_cast<struct sockaddr*>(&address),
+                              &addressLength) < 0) {
+                throw ChannelException("Failed to get the local address.", errno);
+            }
+
+            bindReusePortSockets(channel,
+                                 reinterpret_cast<struct sockaddr*>(&address),
+                                 addressLength,
+                                 config->getBacklog());
+        }
+
+        bound = true;
+        channel.setBound();
+        Channels::fireChannelBound(channel, channel.getLocalAddress());
+
+        // the socket of the channel is closed by the channel.
+        bosses.push_back(new Boss(*this,
+                                  channel,
+                                  eventLoopPool,
+                                  channel.getFd(),
+                                  false,
+                                  reusePort ? 0 : -1));
+
+        for (std::size_t i = 0; i < reusePortFds.size(); ++i) {
+            bosses.push_back(new Boss(*this,
+                                      channel,
+                                      eventLoopPool,
+                                      reusePortFds[i],
+                                      true,
+                                      static_cast<int>(i + 1)));
+        }
+        reusePortFds.clear();
+
+        for (std::size_t i = 0; i < bosses.size(); ++i) {
+            if (!bosses[i]->start()) {
+                throw ChannelException("Failed to register the server socket.", errno);
+            }
+        }
+        bossStarted = true;
+
+        future->setSuccess();
+    }
+    catch (const std::exception& e) {
+        Exception exception(e.what());
+        future->setFailure(exception);
+        Channels::fireExceptionCaught(channel, exception);
+    }
+
+    if (!bossStarted && bound) {
+        closeServerChannel(channel, future);
+    }
+}
+
+void EpollServerSocketPipelineSink::bindReusePortSockets(
+                                        EpollServerSocketChannel& channel,
+                                        const struct sockaddr* address,
+                                        socklen_t addressLength,
+                                        int backlog) {
+    int reuseAddress = 0;
+    socklen_t length = sizeof(reuseAddress);
+    ::getsockopt(channel.getFd(), SOL_SOCKET, SO_REUSEADDR, &reuseAddress, &length);
+
+    for (int i = 1; i < eventLoopPool.size(); ++i) {
+        int fd = ::socket(address->sa_family,
+                          SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                          0);
+        if (fd < 0) {
+            throw ChannelException("Failed to open a server socket.", errno);
+        }
+        reusePortFds.push_back(fd);
+
+        int reusePort = 1;
+        if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &reusePort, sizeof(reusePort)) < 0 ||
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress)) < 0) {
+            throw ChannelException("Failed to set SO_REUSEPORT.", errno);
+        }
+
+        if (::bind(fd, address, addressLength) < 0) {
+            throw ChannelException("Failed to bind the server socket.", errno);
+        }
+
+        if (::listen(fd, backlog) < 0) {
+            throw ChannelException("Failed to listen on the server socket.", errno);
+        }
+    }
+}
+
+void EpollServerSocketPipelineSink::startAcceptedChannel(EpollAcceptedSocketChannel* channel) {
+    if (!channel->start()) {
+        // has no local address or remote address
+        // may never happened.
+        closeAcceptChannel(*channel, channel->getCloseFuture());
+    }
+}
+
+void EpollServerSocketPipelineSink::closeServerChannel(
+                                        EpollServerSocketChannel& channel,
+                                        const ChannelFuturePtr& future) {
+    if (bosses.empty()) {
+        finishCloseServerChannel(channel, future);
+        return;
+    }
+
+    // a boss may be accepting in its event loop right now, so its
+    // listening socket is closed there, not in the calling thread.
+    boost::shared_ptr<boost::detail::atomic_count> pendingBosses(
+        new boost::detail::atomic_count(static_cast<long>(bosses.size())));
+
+    for (std::size_t i = 0; i < bosses.size(); ++i) {
+        bosses[i]->getEventLoop().dispatch(boost::bind(
+            &EpollServerSocketPipelineSink::stopBoss,
+            this,
+            bosses[i],
+            pendingBosses,
+            &channel,
+            future));
+    }
+}
+
+void EpollServerSocketPipelineSink::stopBoss(
+        Boss* boss,
+        const boost::shared_ptr<boost::detail::atomic_count>& pendingBosses,
+        EpollServerSocketChannel* channel,
+        const ChannelFuturePtr& future) {
+    boss->stop();
+
+    if (--*pendingBosses == 0) {
+        finishCloseServerChannel(*channel, future);
+    }
+}
+
+void EpollServerSocketPipelineSink::finishCloseServerChannel(
+                                        EpollServerSocketChannel& channel,
+                                        const ChannelFuturePtr& future) {
+    bool bound = channel.isBound();
+
+    // the ones not handed to a boss yet, when the binding failed.
+    for (std::size_t i = 0; i < reusePortFds.size(); ++i) {
+        ::close(reusePortFds[i]);
+    }
+    reusePortFds.clear();
+
+    if (channel.setClosed()) {
+        future->setSuccess();
+        if (bound) {
+            Channels::fireChannelUnbound(channel);
+        }
+        Channels::fireChannelClosed(channel);
+    }
+    else {
+        future->setSuccess();
+    }
+
+    // close all children Channels, each one in its own event loop.  They
+    // are retained while in the map, a child closing in its loop meanwhile
+    // is only released by closeAcceptChannel after it is erased.
+    std::vector<EpollSocketChannel*> children;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        ChildrenChannels::iterator itr = childrenChannels.begin();
+        for (; itr != childrenChannels.end(); ++itr) {
+            itr->second->retain();
+            children.push_back(itr->second);
+        }
+    }
+
+    for (std::size_t i = 0; i < children.size(); ++i) {
+        children[i]->close();
+        children[i]->release();
+    }
+}
+
+void EpollServerSocketPipelineSink::closeAcceptChannel(
+                                        EpollSocketChannel& channel,
+                                        const ChannelFuturePtr& future) {
+    channel.close(future);
+
+    bool found = false;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        ChildrenChannels::iterator itr = childrenChannels.find(channel.getId());
+        if (itr != childrenChannels.end()) {
+            childrenChannels.erase(itr);
+            found = true;
+        }
+    }
+
+    // the channel may still be on the call stack, or have events pending
+    // in the current round, so it is deleted after the round, when the
+    // tasks which still refer to it have released it too.
+    if (found) {
+        channel.release();
+    }
+}
+
+}}}}
@@ -0,0 +1,170 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSERVERSOCKETPIPELINESINK_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSERVERSOCKETPIPELINESINK_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <map>
+#include <vector>
+#include <sys/socket.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/detail/atomic_count.hpp>
+
+#include "cetty/channel/AbstractChannelSink.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/socket/epoll/EpollEventLoopPool.h"
+#include "cetty/util/Integer.h"
+
+namespace cetty { namespace channel {
+class MessageEvent;
+class SocketAddress;
+}}
+
+namespace cetty { namespace logging {
+class InternalLogger;
+}}
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::logging;
+using namespace cetty::util;
+
+class EpollSocketChannel;
+class EpollAcceptedSocketChannel;
+class EpollServerSocketChannel;
+
+class EpollServerSocketPipelineSink : public cetty::channel::AbstractChannelSink {
+private:
+    typedef std::map<Integer, EpollSocketChannel*> ChildrenChannels;
+
+    /**
+     * Accepts the connections of a listening socket in an event loop.  The
+     * accepted channels are handed to the event loops of the pool in a
+     * round-robin way, or, when the boss owns a <tt>SO_REUSEPORT</tt>
+     * listening socket of an event loop, kept in the event loop of the boss.
+     * The boss is only started and stopped in its event loop, so the
+     * listening socket is never closed while it is accepting.
+     */
+    class Boss : public EpollEventLoopPool::EventHandler {
+    public:
+        Boss(EpollServerSocketPipelineSink& sink,
+             EpollServerSocketChannel& channel,
+             EpollEventLoopPool& eventLoopPool,
+             int listenFd,
+             bool ownsFd,
+             int eventLoopIndex = -1);
+
+        virtual ~Boss();
+
+        bool start();
+
+        /**
+         * Stops accepting, and closes the listening socket if the boss owns
+         * it.  Must be called in the event loop of the boss.
+         */
+        void stop();
+
+        EpollEventLoopPool::EventLoop& getEventLoop() { return eventLoop; }
+
+        virtual void handleEvents(boost::uint32_t events);
+
+    private:
+        void handleAccept(int fd);
+
+    private:
+        int listenFd;
+        bool ownsFd;
+        bool acceptOnOwnLoop;
+        EpollEventLoopPool& eventLoopPool;
+        EpollEventLoopPool::EventLoop& eventLoop;
+        EpollServerSocketChannel& serverChannel;
+        EpollServerSocketPipelineSink& sink;
+    };
+
+public:
+    EpollServerSocketPipelineSink(EpollEventLoopPool& eventLoopPool)
+        : eventLoopPool(eventLoopPool) {
+    }
+
+    virtual ~EpollServerSocketPipelineSink();
+
+    virtual void writeRequested(const cetty::channel::ChannelPipeline& pipeline,
+                                const cetty::channel::MessageEvent& e);
+
+    virtual void stateChangeRequested(const cetty::channel::ChannelPipeline& pipeline,
+                                      const cetty::channel::ChannelStateEvent& e);
+
+private:
+    void handleStateChange(EpollServerSocketChannel& channel, const ChannelStateEvent& evt);
+    void handleStateChange(EpollSocketChannel& channel, const ChannelStateEvent& evt);
+
+    void bind(EpollServerSocketChannel& channel,
+              const ChannelFuturePtr& future,
+              const SocketAddress& localAddress);
+
+    /**
+     * opens, binds and listens a <tt>SO_REUSEPORT</tt> socket for every
+     * event loop of the pool except the first one.
+     *
+     * @param address the address the channel's socket is bound to.
+     */
+    void bindReusePortSockets(EpollServerSocketChannel& channel,
+                              const struct sockaddr* address,
+                              socklen_t addressLength,
+                              int backlog);
+
+    void startAcceptedChannel(EpollAcceptedSocketChannel* channel);
+
+    /**
+     * stops every boss in its own event loop, and the last one finishes
+     * closing the channel.
+     */
+    void closeServerChannel(EpollServerSocketChannel& channel,
+                            const ChannelFuturePtr& future);
+
+    void stopBoss(Boss* boss,
+                  const boost::shared_ptr<boost::detail::atomic_count>& pendingBosses,
+                  EpollServerSocketChannel* channel,
+                  const ChannelFuturePtr& future);
+
+    void finishCloseServerChannel(EpollServerSocketChannel& channel,
+                                  const ChannelFuturePtr& future);
+
+    void closeAcceptChannel(EpollSocketChannel& channel,
+                            const ChannelFuturePtr& future);
+
+private:
+    static InternalLogger* logger;
+
+private:
+    std::vector<Boss*> bosses;
+
+    EpollEventLoopPool& eventLoopPool;
+
+    // the listening sockets of the other event loops in the SO_REUSEPORT
+    // mode, until they are owned by their bosses.
+    std::vector<int> reusePortFds;
+
+    // accessed by the boss and all the event loops.
+    boost::mutex mutex;
+    ChildrenChannels childrenChannels;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSERVERSOCKETPIPELINESINK_H)
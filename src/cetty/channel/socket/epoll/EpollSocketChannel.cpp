@@ -0,0 +1,966 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/channel/socket/epoll/EpollSocketChannel.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+
+#include <boost/bind.hpp>
+
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/ChannelException.h"
+#include "cetty/channel/ChannelPipeline.h"
+#include "cetty/channel/UpstreamMessageEvent.h"
+#include "cetty/channel/DownstreamMessageEvent.h"
+#include "cetty/channel/DownstreamChannelStateEvent.h"
+#include "cetty/channel/CopyableDownstreamMessageEvent.h"
+#include "cetty/channel/CopyableDownstreamChannelStateEvent.h"
+#include "cetty/channel/DefaultWriteCompletionEvent.h"
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/buffer/ChannelBufferFactory.h"
+#include "cetty/buffer/GatheringBuffer.h"
+
+#include "cetty/util/Integer.h"
+#include "cetty/util/Exception.h"
+
+#if !defined(IOV_MAX)
+#define IOV_MAX 1024
+#endif
+
+namespace cetty { namespace channel { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::buffer;
+using namespace cetty::util;
+
+namespace {
+
+// collects the memory blocks of a composite buffer as iovec segments.
+class IovecGatheringBuffer : public cetty::buffer::GatheringBuffer {
+public:
+    IovecGatheringBuffer(std::vector<struct iovec>& segments)
+        : segments(segments), byteSize(0) {}
+
+    virtual ~IovecGatheringBuffer() {}
+
+    virtual bool empty() const { return segments.empty(); }
+    virtual int  blockCount() const { return (int)segments.size(); }
+    virtual int  bytesCount() const { return byteSize; }
+
+    virtual void clear() {
+        segments.clear();
+        byteSize = 0;
+    }
+
+    virtual void append(char* data, int size) {
+        struct iovec segment;
+        segment.iov_base = data;
+        segment.iov_len = size;
+        segments.push_back(segment);
+        byteSize += size;
+    }
+
+    virtual std::pair<char*, int> at(int index) {
+        struct iovec& segment = segments.at(index);
+        return std::make_pair(static_cast<char*>(segment.iov_base),
+                              static_cast<int>(segment.iov_len));
+    }
+
+private:
+    std::vector<struct iovec>& segments;
+    int byteSize;
+};
+
+SocketAddress toSocketAddress(const struct sockaddr_storage& storage) {
+    char host[INET6_ADDRSTRLEN] = {0};
+    int port = 0;
+
+    if (storage.ss_family == AF_INET) {
+        const struct sockaddr_in* addr =
+            reinterpret_cast<const struct sockaddr_in*>(&storage);
+        ::inet_ntop(AF_INET, &addr->sin_addr, host, sizeof(host));
+        port = ntohs(addr->sin_port);
+    }
+    else if (storage.ss_family == AF_INET6) {
+        const struct sockaddr_in6* addr =
+            reinterpret_cast<const struct sockaddr_in6*>(&storage);
+        ::inet_ntop(AF_INET6, &addr->sin6_addr, host, sizeof(host));
+        port = ntohs(addr->sin6_port);
+    }
+    else {
+        return SocketAddress::NULL_ADDRESS;
+    }
+
+    return SocketAddress(std::string(host), port);
+}
+
+}
+
+EpollSocketChannel::EpollSocketChannel(Channel* parent,
+                                       ChannelFactory* factory,
+                                       ChannelPipeline* pipeline,
+                                       ChannelSink* sink,
+                                       EpollEventLoopPool::EventLoop& eventLoop,
+                                       int fd)
+    : SocketChannel(parent, factory, pipeline, sink),
+      eventLoop(eventLoop),
+      fd(fd),
+      registered(false),
+      waitingForWritable(false),
+      flushing(false),
+      writeBufferSize(0),
+      highWaterMarkCounter(0),
+      connectIndex(0),
+      config(fd),
+      state(ST_CHANNEL_OPEN) {
+    ChannelBufferFactory* bufferFactory = config.getBufferFactory();
+    readBuffer = bufferFactory->getBuffer(bufferFactory->getDefaultOrder(),
+                                          config.getChannelOwnBufferSize());
+}
+
+EpollSocketChannel::~EpollSocketChannel() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+const SocketAddress& EpollSocketChannel::getLocalAddress() const {
+    if (localAddress.validated() || fd < 0) {
+        return localAddress;
+    }
+
+    struct sockaddr_storage storage;
+    socklen_t length = sizeof(storage);
+
+    if (::getsockname(fd, reinterpret_cast<struct sockaddr*>(&storage), &length) == 0) {
+        localAddress = toSocketAddress(storage);
+    }
+    return localAddress;
+}
+
+const SocketAddress& EpollSocketChannel::getRemoteAddress() const {
+    if (remoteAddress.validated() || fd < 0) {
+        return remoteAddress;
+    }
+
+    struct sockaddr_storage storage;
+    socklen_t length = sizeof(storage);
+
+    if (::getpeername(fd, reinterpret_cast<struct sockaddr*>(&storage), &length) == 0) {
+        remoteAddress = toSocketAddress(storage);
+    }
+    return remoteAddress;
+}
+
+int EpollSocketChannel::getInterestOps() const {
+    if (!isOpen()) {
+        return Channel::OP_WRITE;
+    }
+
+    int interestOps = getRawInterestOps();
+
+    if (writeBufferSize != 0) {
+        int waterMark = highWaterMarkCounter > 0 ?
+                        config.getWriteBufferLowWaterMark() :
+                        config.getWriteBufferHighWaterMark();
+
+        if (writeBufferSize >= waterMark) {
+            interestOps |= Channel::OP_WRITE;
+        }
+        else {
+            interestOps &= ~Channel::OP_WRITE;
+        }
+    }
+    else {
+        interestOps &= ~Channel::OP_WRITE;
+    }
+
+    return interestOps;
+}
+
+ChannelFuturePtr EpollSocketChannel::write(const ChannelMessage& message,
+                                           const SocketAddress& remoteAddress,
+                                           bool  withFutrue) {
+    if (!remoteAddress.validated() || remoteAddress == this->remoteAddress) {
+        return write(message, withFutrue);
+    }
+    else {
+        return getUnsupportedOperationFuture();
+    }
+}
+
+ChannelFuturePtr EpollSocketChannel::write(const ChannelMessage& message,
+                                           bool  withFutrue) {
+    ChannelFuturePtr future = withFutrue ? Channels::future(*this) : voidFuture;
+
+    if (eventLoop.isInLoopThread()) {
+        pipeline->sendDownstream(
+            DownstreamMessageEvent(*this, future, message, this->remoteAddress));
+    }
+    else {
+        postRetained(boost::bind<void, ChannelPipeline, const MessageEvent&>(
+                         &ChannelPipeline::sendDownstream,
+                         pipeline,
+                         CopyableDownstreamMessageEvent(*this, future, message, this->remoteAddress)));
+    }
+
+    return future;
+}
+
+void EpollSocketChannel::write(const MessageEvent& evt) {
+    const ChannelFuturePtr& f = evt.getFuture();
+    if (!isConnected()) {
+        cleanUpWriteBuffer();
+
+        if (f) {
+            f->setFailure(ChannelException("Channel has been closed."));
+        }
+        return;
+    }
+
+    const ChannelMessage& message = evt.getMessage();
+    int count = message.vectorSize();
+    bool isVector = count > 0 && message.pointer<ChannelMessage>(0);
+
+    bool writable = true;
+    if (isVector) {
+        for (int i = 0; i < count && writable; ++i) {
+            writable = isWritableMessage(*message.pointer<ChannelMessage>(i));
+        }
+    }
+    else {
+        writable = isWritableMessage(message);
+    }
+
+    if (!writable) {
+        if (f) {
+            f->setFailure(ChannelException(
+                              "Only ChannelBuffer and FileRegion can be written."));
+        }
+        return;
+    }
+
+    if (isVector) {
+        // a vector of messages, such as a chunk header, a file region and
+        // a chunk trailer, each one is written in turn, the future is
+        // notified when the last one is written.
+        for (int i = 0; i < count; ++i) {
+            queueWrite(*message.pointer<ChannelMessage>(i),
+                       i == count - 1 ? f : ChannelFuturePtr());
+        }
+    }
+    else {
+        queueWrite(message, f);
+    }
+
+    // the socket is full, the rest will be flushed when EPOLLOUT comes.
+    if (!waitingForWritable) {
+        flush();
+    }
+}
+
+bool EpollSocketChannel::isWritableMessage(const ChannelMessage& message) {
+    return message.empty()
+           || message.isChannelBuffer()
+           || message.smartPointer<FileRegion>();
+}
+
+void EpollSocketChannel::queueWrite(const ChannelMessage& message,
+                                    const ChannelFuturePtr& future) {
+    writeQueue.push_back(WriteEntry());
+    WriteEntry& entry = writeQueue.back();
+
+    entry.future = future;
+
+    if (message.isChannelBuffer()) {
+        entry.buffer = message.value<ChannelBufferPtr>();
+
+        if (entry.buffer->hasArray()) {
+            Array array;
+            entry.buffer->readSlice(array);
+
+            if (array.length() > 0) {
+                struct iovec segment;
+                segment.iov_base = array.data();
+                segment.iov_len = array.length();
+                entry.segments.push_back(segment);
+            }
+            entry.size = array.length();
+        }
+        else {
+            IovecGatheringBuffer gathering(entry.segments);
+            entry.buffer->readSlice(gathering);
+            entry.size = gathering.bytesCount();
+        }
+    }
+    else {
+        entry.fileRegion = message.smartPointer<FileRegion>();
+
+        if (entry.fileRegion) {
+            // only for the water marks.
+            boost::int64_t count = entry.fileRegion->getCount();
+            entry.size = count > INT_MAX ? INT_MAX : static_cast<int>(count);
+        }
+    }
+
+    plusWriteBufferSize(entry.size);
+}
+
+void EpollSocketChannel::flush() {
+    // a write from a listener or an event handler, fired by the flush
+    // below, only queues its entry, which is written by the outer loop.
+    if (flushing) {
+        return;
+    }
+
+    flushing = true;
+    int spinCount = config.getWriteSpinCount();
+
+    while (!writeQueue.empty() && fd >= 0) {
+        CompletedWrites completed;
+
+        // a file region is transferred alone, after the buffers before it.
+        int progress = writeQueue.front().fileRegion ?
+                       transferFileRegion(completed) :
+                       writeBuffers(completed);
+
+        if (progress < 0) {
+            // the pending writes have failed and the channel is closed.
+            return;
+        }
+
+        if (progress == 0) {
+            waitingForWritable = true;
+            break;
+        }
+
+        for (std::size_t i = 0; i < completed.size(); ++i) {
+            if (completed[i].first) {
+                completed[i].first->setSuccess();
+            }
+            pipeline->sendUpstream(
+                DefaultWriteCompletionEvent(*this, completed[i].second));
+        }
+
+        if (--spinCount <= 0 && !writeQueue.empty() && fd >= 0) {
+            // give the other channels in this event loop a chance.
+            postRetained(boost::bind(&EpollSocketChannel::flush, this));
+            break;
+        }
+    }
+
+    flushing = false;
+}
+
+int EpollSocketChannel::writeBuffers(CompletedWrites& completed) {
+    struct iovec iovecs[IOV_MAX];
+
+    // gather as many pending segments as possible into one writev, up to
+    // the next file region.
+    int count = 0;
+    std::deque<WriteEntry>::iterator itr = writeQueue.begin();
+    for (; itr != writeQueue.end() && !itr->fileRegion && count < IOV_MAX; ++itr) {
+        for (std::size_t i = 0, j = itr->segments.size();
+                i < j && count < IOV_MAX; ++i) {
+            iovecs[count++] = itr->segments[i];
+        }
+    }
+
+    ssize_t written = 0;
+    if (count > 0) {
+        do {
+            written = ::writev(fd, iovecs, count);
+        }
+        while (written < 0 && errno == EINTR);
+    }
+
+    if (written < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+
+        int error = errno;
+        failWrites(RuntimeException(std::string("write buffer failed, code=") +
+                                    Integer::toString(error)));
+        return -1;
+    }
+
+    // retire the completed entries and trim the partial one, before
+    // any listener or handler may write again.
+    int remaining = static_cast<int>(written);
+
+    while (!writeQueue.empty() && !writeQueue.front().fileRegion) {
+        WriteEntry& entry = writeQueue.front();
+        int left = entry.size - entry.written;
+
+        if (remaining >= left) {
+            remaining -= left;
+            completed.push_back(std::make_pair(entry.future, left));
+            writeQueue.pop_front();
+            continue;
+        }
+
+        entry.written += remaining;
+
+        std::vector<struct iovec>::iterator seg = entry.segments.begin();
+        while (remaining > 0) {
+            if ((int)seg->iov_len <= remaining) {
+                remaining -= (int)seg->iov_len;
+                ++seg;
+            }
+            else {
+                seg->iov_base = static_cast<char*>(seg->iov_base) + remaining;
+                seg->iov_len -= remaining;
+                remaining = 0;
+            }
+        }
+        entry.segments.erase(entry.segments.begin(), seg);
+        break;
+    }
+
+    minusWriteBufferSize(static_cast<int>(written));
+    return 1;
+}
+
+int EpollSocketChannel::transferFileRegion(CompletedWrites& completed) {
+    WriteEntry& entry = writeQueue.front();
+    boost::int64_t count = entry.fileRegion->getCount();
+
+    // one transfer a spin, so a large file does not hold the event loop.
+    if (entry.fileTransferred < count) {
+        boost::int64_t transferred = 0;
+
+        try {
+            transferred = entry.fileRegion->transferTo(fd, entry.fileTransferred);
+        }
+        catch (const Exception& e) {
+            failWrites(e);
+            return -1;
+        }
+
+        if (transferred == 0) {
+            return 0;
+        }
+
+        entry.fileTransferred += transferred;
+        if (entry.future) {
+            entry.future->setProgress(transferred, entry.fileTransferred, count);
+        }
+
+        if (entry.fileTransferred < count) {
+            return 1;
+        }
+    }
+
+    int size = entry.size;
+    completed.push_back(std::make_pair(entry.future, size));
+    writeQueue.pop_front();
+    minusWriteBufferSize(size);
+
+    return 1;
+}
+
+void EpollSocketChannel::failWrites(const Exception& cause) {
+    std::vector<ChannelFuturePtr> failed;
+    int size = 0;
+
+    while (!writeQueue.empty()) {
+        WriteEntry& entry = writeQueue.front();
+        if (entry.future) {
+            failed.push_back(entry.future);
+        }
+        size += entry.size - entry.written;
+        writeQueue.pop_front();
+    }
+
+    flushing = false;
+    minusWriteBufferSize(size);
+
+    for (std::size_t i = 0; i < failed.size(); ++i) {
+        failed[i]->setFailure(cause);
+    }
+
+    close();
+}
+
+void EpollSocketChannel::postRetained(const EpollEventLoopPool::Functor& task) {
+    // the channel may be closed and released by its transport before the
+    // task runs, it is kept until then.
+    retain();
+    eventLoop.post(boost::bind(&EpollSocketChannel::runRetained, this, task));
+}
+
+void EpollSocketChannel::runRetained(const EpollEventLoopPool::Functor& task) {
+    task();
+    release();
+}
+
+ChannelFuturePtr EpollSocketChannel::unbind() {
+    ChannelFuturePtr future = Channels::future(*this);
+    if (eventLoop.isInLoopThread()) {
+        pipeline->sendDownstream(DownstreamChannelStateEvent(
+                                     *this, future, ChannelState::BOUND));
+    }
+    else {
+        postRetained(boost::bind<void, ChannelPipeline, const ChannelStateEvent&>(
+                         &ChannelPipeline::sendDownstream,
+                         pipeline,
+                         CopyableDownstreamChannelStateEvent(
+                             *this, future, ChannelState::BOUND)));
+    }
+
+    return future;
+}
+
+ChannelFuturePtr EpollSocketChannel::close() {
+    if (closeFuture->isDone()) {
+        return closeFuture;
+    }
+
+    if (eventLoop.isInLoopThread()) {
+        pipeline->sendDownstream(DownstreamChannelStateEvent(
+                                     *this, closeFuture, ChannelState::OPEN));
+    }
+    else {
+        postRetained(boost::bind<void, ChannelPipeline, const ChannelStateEvent&>(
+                         &ChannelPipeline::sendDownstream,
+                         pipeline,
+                         CopyableDownstreamChannelStateEvent(
+                             *this, closeFuture, ChannelState::OPEN)));
+    }
+
+    return closeFuture;
+}
+
+void EpollSocketChannel::close(const ChannelFuturePtr& future) {
+    bool connected = isConnected();
+    bool bound = isBound();
+
+    if (!isOpen() || fd < 0) {
+        return;
+    }
+
+    if (registered) {
+        eventLoop.remove(fd);
+        registered = false;
+    }
+
+    if (connected) {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+
+    int error = 0;
+    if (::close(fd) < 0) {
+        error = errno;
+    }
+    fd = -1;
+
+    // If failed when closing the socket, there is no ChannelClosed
+    // event fired, all what you can do is insert a FutureListener to
+    // ChannelCloseFuture.
+    if (error) {
+        IOException e("closing tcp socket has failed", error);
+        setClosed();
+        future->setFailure(e);
+        Channels::fireExceptionCaught(*this, e);
+        return;
+    }
+
+    if (setClosed()) {
+        future->setSuccess();
+        if (connected) {
+            Channels::fireChannelDisconnected(*this);
+        }
+        if (bound) {
+            Channels::fireChannelUnbound(*this);
+        }
+
+        cleanUpWriteBuffer();
+        Channels::fireChannelClosed(*this);
+    }
+    else {
+        future->setSuccess();
+    }
+}
+
+ChannelFuturePtr EpollSocketChannel::disconnect() {
+    ChannelFuturePtr future = Channels::future(*this);
+
+    if (eventLoop.isInLoopThread()) {
+        pipeline->sendDownstream(DownstreamChannelStateEvent(
+                                     *this, future, ChannelState::CONNECTED));
+    }
+    else {
+        postRetained(boost::bind<void, ChannelPipeline, const ChannelStateEvent&>(
+                         &ChannelPipeline::sendDownstream,
+                         pipeline,
+                         CopyableDownstreamChannelStateEvent(
+                             *this, future, ChannelState::CONNECTED)));
+    }
+
+    return future;
+}
+
+ChannelFuturePtr EpollSocketChannel::setInterestOps(int interestOps) {
+    interestOps = Channels::validateAndFilterDownstreamInteresOps(interestOps);
+    ChannelFuturePtr future = Channels::future(*this);
+
+    if (eventLoop.isInLoopThread()) {
+        pipeline->sendDownstream(DownstreamChannelStateEvent(
+            *this, future, ChannelState::INTEREST_OPS, boost::any(interestOps)));
+    }
+    else {
+        postRetained(boost::bind<void, ChannelPipeline, const ChannelStateEvent&>(
+                         &ChannelPipeline::sendDownstream,
+                         pipeline,
+                         CopyableDownstreamChannelStateEvent(
+                             *this, future, ChannelState::INTEREST_OPS, boost::any(interestOps))));
+    }
+
+    return future;
+}
+
+void EpollSocketChannel::setInterestOps(const ChannelFuturePtr& future, int interestOps) {
+    bool isOrgReadable = isReadable();
+
+    // Override OP_WRITE flag - a user cannot change this flag.
+    interestOps &= ~Channel::OP_WRITE;
+    interestOps |= getRawInterestOps() & Channel::OP_WRITE;
+
+    setRawInterestOpsNow(interestOps);
+
+    bool isNowReadable = isReadable();
+    bool changed = isOrgReadable != isNowReadable;
+
+    future->setSuccess();
+    if (changed) {
+        Channels::fireChannelInterestChanged(*this, interestOps);
+    }
+
+    // edge-triggered, the data arrived while suspended will not be
+    // notified again, so drain the socket now.
+    if (changed && isNowReadable && isConnected()) {
+        handleRead();
+    }
+}
+
+bool EpollSocketChannel::registerEvents() {
+    if (registered) {
+        return true;
+    }
+
+    registered = eventLoop.add(fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP, this);
+    return registered;
+}
+
+void EpollSocketChannel::handleEvents(boost::uint32_t events) {
+    if (fd < 0) {
+        return;
+    }
+
+    if (!connectAddresses.empty()) {
+        if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) {
+            handleConnect();
+        }
+        return;
+    }
+
+    if ((events & (EPOLLERR | EPOLLHUP)) && !(events & EPOLLIN)) {
+        close();
+        return;
+    }
+
+    if ((events & EPOLLOUT) && waitingForWritable) {
+        waitingForWritable = false;
+        flush();
+
+        if (fd < 0) {
+            return;
+        }
+    }
+
+    if ((events & (EPOLLIN | EPOLLRDHUP)) && isReadable()) {
+        handleRead();
+    }
+}
+
+void EpollSocketChannel::handleRead() {
+    Array array;
+
+    while (fd >= 0 && isReadable()) {
+        if (readBuffer->writableBytes() == 0) {
+            // the slices kept by the handlers still refer to the read bytes.
+            if (readBuffer->refcount() == 1) {
+                readBuffer->discardReadBytes();
+            }
+
+            if (readBuffer->writableBytes() == 0) {
+                ChannelBufferFactory* bufferFactory = config.getBufferFactory();
+                ChannelBufferPtr buffer = bufferFactory->getBuffer(
+                                              bufferFactory->getDefaultOrder(),
+                                              readBuffer->readableBytes() +
+                                              config.getChannelOwnBufferSize());
+                buffer->writeBytes(*readBuffer);
+                readBuffer = buffer;
+            }
+        }
+
+        readBuffer->writableBytes(array);
+
+        int length = array.length();
+        if (length > readBuffer->writableBytes()) {
+            length = readBuffer->writableBytes();
+        }
+
+        ssize_t n = ::read(fd, array.data(), length);
+
+        if (n > 0) {
+            readBuffer->offsetWriterIndex(static_cast<int>(n));
+
+            // Fire the event.
+            pipeline->sendUpstream(UpstreamMessageEvent(*this, readBuffer, remoteAddress));
+        }
+        else if (n == 0) {
+            close();
+            return;
+        }
+        else if (errno == EINTR) {
+            continue;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;
+        }
+        else {
+            close();
+            return;
+        }
+    }
+}
+
+void EpollSocketChannel::connect(const ChannelFuturePtr& future,
+                                 const SocketAddress& remoteAddress) {
+    struct addrinfo hints;
+    struct addrinfo* result = NULL;
+
+    ::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    int error = ::getaddrinfo(remoteAddress.hostName().c_str(),
+                              Integer::toString(remoteAddress.port()).c_str(),
+                              &hints,
+                              &result);
+    if (error != 0 || !result) {
+        ChannelException e(std::string("can't resolve the address: ") +
+                           ::gai_strerror(error));
+        future->setFailure(e);
+        Channels::fireExceptionCaught(*this, e);
+        close(getSucceededFuture());
+        return;
+    }
+
+    connectAddresses.clear();
+    connectAddressLengths.clear();
+
+    for (struct addrinfo* ai = result; ai != NULL; ai = ai->ai_next) {
+        struct sockaddr_storage storage;
+        ::memcpy(&storage, ai->ai_addr, ai->ai_addrlen);
+        connectAddresses.push_back(storage);
+        connectAddressLengths.push_back(ai->ai_addrlen);
+    }
+    ::freeaddrinfo(result);
+
+    this->connectFuture = future;
+    this->remoteAddress = remoteAddress;
+    this->connectIndex = 0;
+
+    while (connectIndex < connectAddresses.size()) {
+        if (connectNext()) {
+            return;
+        }
+        ++connectIndex;
+    }
+
+    failConnect(errno);
+}
+
+bool EpollSocketChannel::connectNext() {
+    const struct sockaddr_storage& address = connectAddresses[connectIndex];
+
+    if (connectIndex > 0 || address.ss_family != AF_INET) {
+        // the previous attempt left the socket unusable, or the family
+        // differs, swap a fresh socket in under the same descriptor.
+        int newFd = ::socket(address.ss_family,
+                             SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                             0);
+        if (newFd < 0) {
+            return false;
+        }
+
+        if (registered) {
+            eventLoop.remove(fd);
+            registered = false;
+        }
+
+        int duplicated = ::dup2(newFd, fd);
+        ::close(newFd);
+
+        // the options set on the channel went with the replaced socket.
+        if (duplicated < 0 || !config.reapplyOptions()) {
+            return false;
+        }
+    }
+
+    int ret = ::connect(fd,
+                        reinterpret_cast<const struct sockaddr*>(&address),
+                        connectAddressLengths[connectIndex]);
+
+    if (ret < 0 && errno != EINPROGRESS && errno != EINTR) {
+        return false;
+    }
+
+    // completes (or fails) with an EPOLLOUT notification.
+    return registerEvents();
+}
+
+void EpollSocketChannel::handleConnect() {
+    int error = 0;
+    socklen_t length = sizeof(error);
+
+    if (::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0) {
+        error = errno;
+    }
+
+    if (error == 0) {
+        connectAddresses.clear();
+        connectAddressLengths.clear();
+
+        ChannelFuturePtr future = connectFuture;
+        connectFuture.reset();
+
+        setConnected();
+        Channels::fireChannelConnected(*this, remoteAddress);
+        future->setSuccess();
+
+        // edge-triggered, the data may already be there.
+        if (isReadable()) {
+            handleRead();
+        }
+        return;
+    }
+
+    while (++connectIndex < connectAddresses.size()) {
+        if (connectNext()) {
+            return;
+        }
+    }
+
+    failConnect(error);
+}
+
+void EpollSocketChannel::failConnect(int error) {
+    connectAddresses.clear();
+    connectAddressLengths.clear();
+
+    ChannelFuturePtr future = connectFuture;
+    connectFuture.reset();
+
+    future->setFailure(ChannelException("can't connect to server", error));
+    close(future);
+}
+
+void EpollSocketChannel::cleanUpWriteBuffer() {
+    ChannelException cause;
+    bool fireExceptionCaught = false;
+
+    // Clean up the stale messages in the write buffer.
+    if (!writeQueue.empty()) {
+        if (isOpen()) {
+            cause = ChannelException("Channel has not close yet.");
+        }
+        else {
+            cause = ChannelException("Channel has closed.");
+        }
+
+        while (!writeQueue.empty()) {
+            WriteEntry& entry = writeQueue.front();
+            if (entry.future) {
+                entry.future->setFailure(cause);
+            }
+
+            int size = entry.size - entry.written;
+            writeQueue.pop_front();
+            minusWriteBufferSize(size);
+            fireExceptionCaught = true;
+        }
+    }
+
+    waitingForWritable = false;
+
+    if (fireExceptionCaught) {
+        Channels::fireExceptionCaught(*this, cause);
+    }
+}
+
+void EpollSocketChannel::plusWriteBufferSize(int messageSize) {
+    writeBufferSize += messageSize;
+
+    int highWaterMark = config.getWriteBufferHighWaterMark();
+    if (writeBufferSize >= highWaterMark) {
+        if (writeBufferSize - messageSize < highWaterMark) {
+            handleAtHighWaterMark();
+        }
+    }
+}
+
+void EpollSocketChannel::minusWriteBufferSize(int messageSize) {
+    writeBufferSize -= messageSize;
+
+    int lowWaterMark = config.getWriteBufferLowWaterMark();
+    if (writeBufferSize == 0 || writeBufferSize < lowWaterMark) {
+        if (writeBufferSize + messageSize >= lowWaterMark) {
+            handleAtLowWaterMark();
+        }
+    }
+}
+
+void EpollSocketChannel::handleAtHighWaterMark() {
+    ++highWaterMarkCounter;
+    Channels::fireChannelInterestChanged(*this, getInterestOps());
+}
+
+void EpollSocketChannel::handleAtLowWaterMark() {
+    if (highWaterMarkCounter <= 0) {
+        return;
+    }
+
+    --highWaterMarkCounter;
+    if (isConnected()) {
+        Channels::fireChannelInterestChanged(*this, getInterestOps());
+    }
+}
+
+}}}}
@@ -0,0 +1,226 @@
+#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSOCKETCHANNEL_H)
+#define CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSOCKETCHANNEL_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <deque>
+#include <vector>
+#include <sys/uio.h>
+#include <sys/socket.h>
+
+#include <boost/any.hpp>
+#include <boost/assert.hpp>
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/FileRegion.h"
+#include "cetty/channel/ChannelPipeline.h"
+#include "cetty/channel/socket/SocketChannel.h"
+#include "cetty/channel/socket/epoll/EpollEventLoopPool.h"
+#include "cetty/channel/socket/epoll/DefaultEpollSocketChannelConfig.h"
+#include "cetty/util/Exception.h"
+
+namespace cetty { namespace channel  { namespace socket { namespace epoll {
+
+using namespace cetty::channel;
+using namespace cetty::buffer;
+
+/**
+ * A {@link SocketChannel} driven by an edge-triggered epoll
+ * {@link EpollEventLoopPool::EventLoop EventLoop}.
+ *
+ * All the I/O of the channel happens in the thread of its event loop.  The
+ * pending writes are kept in a queue and flushed with as few
+ * <tt>writev</tt> calls as possible, so the small messages written in the
+ * same event loop round end up in the same TCP segment.  A
+ * {@link FileRegion} is transferred by itself, after the buffers queued
+ * before it.
+ *
+ * The operations called from other threads are posted to the event loop
+ * with the channel retained, until they have run.
+ */
+class EpollSocketChannel : public cetty::channel::socket::SocketChannel,
+                           public EpollEventLoopPool::EventHandler {
+public:
+    EpollSocketChannel(Channel* parent,
+                       ChannelFactory* factory,
+                       ChannelPipeline* pipeline,
+                       ChannelSink* sink,
+                       EpollEventLoopPool::EventLoop& eventLoop,
+                       int fd);
+
+    virtual ~EpollSocketChannel();
+
+    virtual ChannelConfig& getConfig() { return this->config; }
+    virtual const ChannelConfig& getConfig() const { return this->config; }
+
+    int getFd() const { return fd; }
+
+    virtual EpollEventLoopPool::EventLoop* getEventLoop() const {
+        return &eventLoop;
+    }
+
+    virtual const SocketAddress& getLocalAddress() const;
+    virtual const SocketAddress& getRemoteAddress() const;
+
+    virtual bool isOpen() const {
+        return state >= ST_CHANNEL_OPEN;
+    }
+
+    virtual bool isBound() const {
+        return state >= ST_CHANNEL_BOUND;
+    }
+
+    virtual bool isConnected() const {
+        return state == ST_CHANNEL_CONNECTED;
+    }
+
+    virtual int getInterestOps() const;
+
+    virtual bool setClosed() {
+        state = ST_CHANNEL_CLOSED;
+        return AbstractChannel::setClosed();
+    }
+
+    void setBound() {
+        BOOST_ASSERT(state == ST_CHANNEL_OPEN && "Invalid state.");
+        state = ST_CHANNEL_BOUND;
+    }
+
+    void setConnected() {
+        if (state != ST_CHANNEL_CLOSED) {
+            state = ST_CHANNEL_CONNECTED;
+        }
+    }
+
+    int getRawInterestOps() const {
+        return AbstractChannel::getInterestOps();
+    }
+
+    void setRawInterestOpsNow(int interestOps) {
+        AbstractChannel::setInterestOpsNow(interestOps);
+    }
+
+    virtual ChannelFuturePtr write(const ChannelMessage& message,
+                                   bool  withFutrue = true);
+    virtual ChannelFuturePtr write(const ChannelMessage& message,
+                                   const SocketAddress& remoteAddress,
+                                   bool  withFutrue = true);
+
+    virtual ChannelFuturePtr unbind();
+    virtual ChannelFuturePtr close();
+    virtual ChannelFuturePtr disconnect();
+    virtual ChannelFuturePtr setInterestOps(int interestOps);
+
+    /**
+     * the following methods must be called in the event loop thread.
+     */
+    void write(const MessageEvent& evt);
+    void close(const ChannelFuturePtr& future);
+    void setInterestOps(const ChannelFuturePtr& future, int interestOps);
+    void connect(const ChannelFuturePtr& future, const SocketAddress& remoteAddress);
+    void cleanUpWriteBuffer();
+
+    virtual void handleEvents(boost::uint32_t events);
+
+protected:
+    bool registerEvents();
+
+    void handleRead();
+    void handleConnect();
+    void flush();
+
+    /**
+     * posts the task to the event loop, the channel is retained until the
+     * task has run.
+     */
+    void postRetained(const EpollEventLoopPool::Functor& task);
+    void runRetained(const EpollEventLoopPool::Functor& task);
+
+private:
+    struct WriteEntry {
+        ChannelBufferPtr buffer;
+        ChannelFuturePtr future;
+        std::vector<struct iovec> segments;
+        int size;
+        int written;
+
+        // transferred by sendfile or splice instead of the segments.
+        FileRegionPtr fileRegion;
+        boost::int64_t fileTransferred;
+
+        WriteEntry() : size(0), written(0), fileTransferred(0) {}
+    };
+
+    typedef std::vector<std::pair<ChannelFuturePtr, int> > CompletedWrites;
+
+    static bool isWritableMessage(const ChannelMessage& message);
+    void queueWrite(const ChannelMessage& message, const ChannelFuturePtr& future);
+
+    int writeBuffers(CompletedWrites& completed);
+    int transferFileRegion(CompletedWrites& completed);
+    void failWrites(const cetty::util::Exception& cause);
+
+    bool connectNext();
+    void failConnect(int error);
+
+    void plusWriteBufferSize(int messageSize);
+    void minusWriteBufferSize(int messageSize);
+
+    void handleAtHighWaterMark();
+    void handleAtLowWaterMark();
+
+protected:
+    EpollEventLoopPool::EventLoop& eventLoop;
+
+    int fd;
+    bool registered;
+    bool waitingForWritable;
+    bool flushing;
+
+    ChannelBufferPtr readBuffer;
+
+    std::deque<WriteEntry> writeQueue;
+    int writeBufferSize;
+    int highWaterMarkCounter;
+
+    // the resolved addresses and the current one under connecting.
+    ChannelFuturePtr connectFuture;
+    std::vector<struct sockaddr_storage> connectAddresses;
+    std::vector<socklen_t> connectAddressLengths;
+    std::size_t connectIndex;
+
+    DefaultEpollSocketChannelConfig config;
+
+    mutable SocketAddress localAddress;
+    mutable SocketAddress remoteAddress;
+
+private:
+    static const int ST_CHANNEL_OPEN = 0;
+    static const int ST_CHANNEL_BOUND = 1;
+    static const int ST_CHANNEL_CONNECTED = 2;
+    static const int ST_CHANNEL_CLOSED = -1;
+
+    int state;
+};
+
+}}}}
+
+#endif //#if !defined(CETTY_CHANNEL_SOCKET_EPOLL_EPOLLSOCKETCHANNEL_H)
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/compression/ZlibDecoder.h"
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+ZlibDecoder::ZlibDecoder() : inflater(ZlibWrapper::ZLIB) {
+}
+
+ZlibDecoder::ZlibDecoder(const ZlibWrapper& wrapper) : inflater(wrapper) {
+}
+
+ChannelHandlerPtr ZlibDecoder::clone() {
+    return ChannelHandlerPtr(new ZlibDecoder(inflater.getWrapper()));
+}
+
+std::string ZlibDecoder::toString() const {
+    return "ZlibDecoder";
+}
+
+ChannelMessage ZlibDecoder::decode(ChannelHandlerContext& ctx,
+                                   Channel& channel,
+                                   const ChannelMessage& msg) {
+    const ChannelBufferPtr& buffer = msg.value<ChannelBufferPtr>();
+
+    if (!buffer) {
+        return msg;
+    }
+
+    if (inflater.isFinished()) {
+        return ChannelMessage();
+    }
+
+    ChannelBufferPtr decompressed = inflater.inflate(buffer);
+
+    if (!decompressed->readable()) {
+        return ChannelMessage();
+    }
+
+    return ChannelMessage(decompressed);
+}
+
+}}}}
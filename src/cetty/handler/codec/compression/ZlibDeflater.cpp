@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/compression/ZlibDeflater.h"
+
+#include <zlib.h>
+#include <string>
+#include <algorithm>
+
+#include "cetty/buffer/Array.h"
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/buffer/ChannelBufferFactory.h"
+#include "cetty/buffer/PooledChannelBufferFactory.h"
+#include "cetty/util/Exception.h"
+#include "cetty/handler/codec/compression/ZlibStreamPool.h"
+#include "cetty/handler/codec/compression/CompressionException.h"
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+using namespace cetty::util;
+
+static const int MIN_OUTPUT_BUFFER_SIZE = 64;
+static const int MAX_OUTPUT_BUFFER_SIZE = 64 * 1024;
+
+ZlibDeflater::ZlibDeflater()
+    : wrapper(ZlibWrapper::ZLIB),
+      compressionLevel(DEFAULT_COMPRESSION_LEVEL) {
+    init(PooledChannelBufferFactory::getInstance());
+}
+
+ZlibDeflater::ZlibDeflater(const ZlibWrapper& wrapper, int compressionLevel)
+    : wrapper(wrapper),
+      compressionLevel(compressionLevel) {
+    init(PooledChannelBufferFactory::getInstance());
+}
+
+ZlibDeflater::ZlibDeflater(const ZlibWrapper& wrapper,
+                           int compressionLevel,
+                           ChannelBufferFactory& factory)
+    : wrapper(wrapper),
+      compressionLevel(compressionLevel) {
+    init(factory);
+}
+
+ZlibDeflater::~ZlibDeflater() {
+    releaseStream();
+}
+
+void ZlibDeflater::init(ChannelBufferFactory& factory) {
+    if (compressionLevel < 0 || compressionLevel > 9) {
+        throw InvalidArgumentException(
+            "compressionLevel must be in [0, 9]", compressionLevel);
+    }
+
+    if (wrapper == ZlibWrapper::ZLIB_OR_NONE) {
+        throw InvalidArgumentException(
+            "ZLIB_OR_NONE is only allowed for decompression.");
+    }
+
+    this->finished = false;
+    this->stream = NULL;
+    this->factory = &factory;
+}
+
+ChannelBufferPtr ZlibDeflater::deflate(const ChannelBufferPtr& in, bool flush) {
+    if (finished) {
+        throw IllegalStateException("the deflater is finished.");
+    }
+
+    if (!stream) {
+        stream = ZlibStreamPool::acquireDeflater(wrapper.windowBits(),
+                 compressionLevel);
+    }
+
+    int mode = flush ? Z_SYNC_FLUSH : Z_NO_FLUSH;
+    int index = in ? in->readerIndex() : 0;
+    int end = in ? in->writerIndex() : 0;
+
+    // compresses the bytes in place, region by region.
+    ConstArray region;
+
+    while (index < end) {
+        int start = in->getContiguousBytes(index, region);
+
+        if (start < 0) {
+            break;
+        }
+
+        int regionEnd = std::min(start + region.length(), end);
+        compress(region.data() + (index - start),
+                 regionEnd - index,
+                 regionEnd == end ? mode : Z_NO_FLUSH);
+        index = regionEnd;
+    }
+
+    if (index < end) {
+        std::string bytes;
+        in->getBytes(index, bytes, end - index);
+        compress(bytes.data(), static_cast<int>(bytes.size()), mode);
+    }
+    else if (flush && (!in || !in->readable())) {
+        compress(NULL, 0, mode);
+    }
+
+    return drainOutput();
+}
+
+ChannelBufferPtr ZlibDeflater::finish() {
+    if (finished) {
+        return ChannelBuffers::EMPTY_BUFFER;
+    }
+
+    if (!stream) {
+        stream = ZlibStreamPool::acquireDeflater(wrapper.windowBits(),
+                 compressionLevel);
+    }
+
+    compress(NULL, 0, Z_FINISH);
+
+    finished = true;
+    releaseStream();
+
+    return drainOutput();
+}
+
+void ZlibDeflater::compress(const char* bytes, int length, int flush) {
+    stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(bytes));
+    stream->avail_in = length;
+
+    for (;;) {
+        if (outputs.empty() || !outputs.back()->writable()) {
+            int size = static_cast<int>(deflateBound(stream, stream->avail_in));
+            size = std::max(MIN_OUTPUT_BUFFER_SIZE,
+                            std::min(size, MAX_OUTPUT_BUFFER_SIZE));
+            outputs.push_back(factory->getBuffer(size));
+        }
+
+        const ChannelBufferPtr& output = outputs.back();
+        int writable = output->writableBytes();
+        Array array;
+        output->writableBytes(array);
+
+        stream->next_out = reinterpret_cast<Bytef*>(array.data());
+        stream->avail_out = writable;
+
+        int result = ::deflate(stream, flush);
+        output->offsetWriterIndex(writable - static_cast<int>(stream->avail_out));
+
+        if (result == Z_STREAM_END) {
+            break;
+        }
+
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            throw CompressionException(stream->msg ? stream->msg
+                                       : "failed to deflate", result);
+        }
+
+        // all the input is consumed and the output is flushed when zlib
+        // has not filled up the output buffer.
+        if (stream->avail_in == 0 && stream->avail_out != 0) {
+            break;
+        }
+    }
+
+    stream->next_in = NULL;
+    stream->next_out = NULL;
+}
+
+ChannelBufferPtr ZlibDeflater::drainOutput() {
+    // keeps the untouched buffer for the next time.
+    ChannelBufferPtr spare;
+
+    if (!outputs.empty() && !outputs.back()->readable()) {
+        spare = outputs.back();
+        outputs.pop_back();
+    }
+
+    ChannelBufferPtr result;
+
+    if (outputs.empty()) {
+        result = ChannelBuffers::EMPTY_BUFFER;
+    }
+    else if (outputs.size() == 1) {
+        result = outputs.front();
+    }
+    else {
+        result = ChannelBuffers::wrappedBuffer(outputs);
+    }
+
+    outputs.clear();
+
+    if (spare && !finished) {
+        outputs.push_back(spare);
+    }
+
+    return result;
+}
+
+void ZlibDeflater::releaseStream() {
+    if (stream) {
+        ZlibStreamPool::releaseDeflater(stream, wrapper.windowBits(), compressionLevel);
+        stream = NULL;
+    }
+}
+
+}}}}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/compression/ZlibEncoder.h"
+
+#include <typeinfo>
+#include <boost/bind.hpp>
+
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/ChannelState.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/ChannelHandlerContext.h"
+#include "cetty/channel/CopyableDownstreamChannelStateEvent.h"
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+static void sendStateChangeRequest(ChannelHandlerContext& ctx,
+                                   const CopyableDownstreamChannelStateEvent& e) {
+    ctx.sendDownstream(e);
+}
+
+ZlibEncoder::ZlibEncoder()
+    : deflater(ZlibWrapper::ZLIB, ZlibDeflater::DEFAULT_COMPRESSION_LEVEL) {
+}
+
+ZlibEncoder::ZlibEncoder(int compressionLevel)
+    : deflater(ZlibWrapper::ZLIB, compressionLevel) {
+}
+
+ZlibEncoder::ZlibEncoder(const ZlibWrapper& wrapper)
+    : deflater(wrapper, ZlibDeflater::DEFAULT_COMPRESSION_LEVEL) {
+}
+
+ZlibEncoder::ZlibEncoder(const ZlibWrapper& wrapper, int compressionLevel)
+    : deflater(wrapper, compressionLevel) {
+}
+
+ChannelHandlerPtr ZlibEncoder::clone() {
+    return ChannelHandlerPtr(new ZlibEncoder(deflater.getWrapper(),
+                             deflater.getCompressionLevel()));
+}
+
+std::string ZlibEncoder::toString() const {
+    return "ZlibEncoder";
+}
+
+ChannelMessage ZlibEncoder::encode(ChannelHandlerContext& ctx,
+                                   Channel& channel,
+                                   const ChannelMessage& msg) {
+    const ChannelBufferPtr& buffer = msg.value<ChannelBufferPtr>();
+
+    if (!buffer || deflater.isFinished()) {
+        return msg;
+    }
+
+    return deflater.deflate(buffer, true);
+}
+
+void ZlibEncoder::stateChangeRequested(ChannelHandlerContext& ctx,
+                                       const ChannelStateEvent& e) {
+    const ChannelState& state = e.getState();
+    const boost::any& value = e.getValue();
+
+    bool closing = (state == ChannelState::OPEN
+                    || state == ChannelState::BOUND
+                    || state == ChannelState::CONNECTED)
+                   && (value.empty()
+                       || (value.type() == typeid(bool) && !boost::any_cast<bool>(value)));
+
+    if (!closing || deflater.isFinished()) {
+        ctx.sendDownstream(e);
+        return;
+    }
+
+    ChannelBufferPtr footer = deflater.finish();
+
+    if (!footer->readable()) {
+        ctx.sendDownstream(e);
+        return;
+    }
+
+    // passes the request down once the footer is written.
+    ChannelFuturePtr future = Channels::future(ctx.getChannel());
+    future->setListener(boost::bind(sendStateChangeRequest,
+                                    boost::ref(ctx),
+                                    CopyableDownstreamChannelStateEvent(
+                                        e.getChannel(),
+                                        e.getFuture(),
+                                        state,
+                                        value)));
+
+    Channels::write(ctx, future, ChannelMessage(footer));
+}
+
+}}}}
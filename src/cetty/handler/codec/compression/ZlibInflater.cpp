@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/compression/ZlibInflater.h"
+
+#include <zlib.h>
+#include <algorithm>
+
+#include "cetty/buffer/Array.h"
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/buffer/ChannelBufferFactory.h"
+#include "cetty/buffer/PooledChannelBufferFactory.h"
+#include "cetty/handler/codec/compression/ZlibStreamPool.h"
+#include "cetty/handler/codec/compression/CompressionException.h"
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+static const int MIN_OUTPUT_BUFFER_SIZE = 256;
+static const int MAX_OUTPUT_BUFFER_SIZE = 64 * 1024;
+
+ZlibInflater::ZlibInflater()
+    : wrapper(ZlibWrapper::ZLIB),
+      windowBits(ZlibWrapper::ZLIB.windowBits()),
+      finished(false),
+      stream(NULL),
+      factory(&PooledChannelBufferFactory::getInstance()) {
+}
+
+ZlibInflater::ZlibInflater(const ZlibWrapper& wrapper)
+    : wrapper(wrapper),
+      windowBits(wrapper.windowBits()),
+      finished(false),
+      stream(NULL),
+      factory(&PooledChannelBufferFactory::getInstance()) {
+}
+
+ZlibInflater::ZlibInflater(const ZlibWrapper& wrapper,
+                           ChannelBufferFactory& factory)
+    : wrapper(wrapper),
+      windowBits(wrapper.windowBits()),
+      finished(false),
+      stream(NULL),
+      factory(&factory) {
+}
+
+ZlibInflater::~ZlibInflater() {
+    releaseStream();
+}
+
+ChannelBufferPtr ZlibInflater::inflate(const ChannelBufferPtr& in) {
+    if (finished || !in || !in->readable()) {
+        return ChannelBuffers::EMPTY_BUFFER;
+    }
+
+    int index = in->readerIndex();
+    int end = in->writerIndex();
+
+    ConstArray region;
+
+    while (index < end && !finished) {
+        int start = in->getContiguousBytes(index, region);
+
+        if (start < 0) {
+            break;
+        }
+
+        int regionEnd = std::min(start + region.length(), end);
+        decompress(region.data() + (index - start), regionEnd - index);
+        index = regionEnd;
+    }
+
+    if (index < end && !finished) {
+        std::string bytes;
+        in->getBytes(index, bytes, end - index);
+        decompress(bytes.data(), static_cast<int>(bytes.size()));
+    }
+
+    return drainOutput();
+}
+
+void ZlibInflater::decompress(const char* bytes, int length) {
+    std::string joined;
+
+    if (!stream) {
+        if (wrapper == ZlibWrapper::ZLIB_OR_NONE) {
+            if (header.size() + length < 2) {
+                header.append(bytes, length);
+                return;
+            }
+
+            if (!header.empty()) {
+                joined.swap(header);
+                joined.append(bytes, length);
+                bytes = joined.data();
+                length = static_cast<int>(joined.size());
+            }
+
+            // a zlib header (RFC 1950) is a multiple of 31 with CM = 8.
+            int cmf = static_cast<unsigned char>(bytes[0]);
+            int flg = static_cast<unsigned char>(bytes[1]);
+            bool zlib = (cmf & 0x0f) == 8 && ((cmf << 8) | flg) % 31 == 0;
+
+            windowBits = zlib ? ZlibWrapper::ZLIB.windowBits()
+                         : ZlibWrapper::NONE.windowBits();
+        }
+
+        stream = ZlibStreamPool::acquireInflater(windowBits);
+    }
+
+    stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(bytes));
+    stream->avail_in = length;
+
+    for (;;) {
+        if (outputs.empty() || !outputs.back()->writable()) {
+            int size = std::max(MIN_OUTPUT_BUFFER_SIZE,
+                                std::min(length * 4, MAX_OUTPUT_BUFFER_SIZE));
+            outputs.push_back(factory->getBuffer(size));
+        }
+
+        const ChannelBufferPtr& output = outputs.back();
+        int writable = output->writableBytes();
+        Array array;
+        output->writableBytes(array);
+
+        stream->next_out = reinterpret_cast<Bytef*>(array.data());
+        stream->avail_out = writable;
+
+        int result = ::inflate(stream, Z_SYNC_FLUSH);
+        output->offsetWriterIndex(writable - static_cast<int>(stream->avail_out));
+
+        if (result == Z_STREAM_END) {
+            finished = true;
+            break;
+        }
+
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            std::string message(stream->msg ? stream->msg : "failed to inflate");
+            releaseStream();
+            finished = true;
+            throw CompressionException(message, result);
+        }
+
+        if (stream->avail_in == 0 && stream->avail_out != 0) {
+            break;
+        }
+    }
+
+    stream->next_in = NULL;
+    stream->next_out = NULL;
+
+    if (finished) {
+        releaseStream();
+    }
+}
+
+ChannelBufferPtr ZlibInflater::drainOutput() {
+    ChannelBufferPtr spare;
+
+    if (!outputs.empty() && !outputs.back()->readable()) {
+        spare = outputs.back();
+        outputs.pop_back();
+    }
+
+    ChannelBufferPtr result;
+
+    if (outputs.empty()) {
+        result = ChannelBuffers::EMPTY_BUFFER;
+    }
+    else if (outputs.size() == 1) {
+        result = outputs.front();
+    }
+    else {
+        result = ChannelBuffers::wrappedBuffer(outputs);
+    }
+
+    outputs.clear();
+
+    if (spare && !finished) {
+        outputs.push_back(spare);
+    }
+
+    return result;
+}
+
+void ZlibInflater::releaseStream() {
+    if (stream) {
+        ZlibStreamPool::releaseInflater(stream, windowBits);
+        stream = NULL;
+    }
+}
+
+}}}}
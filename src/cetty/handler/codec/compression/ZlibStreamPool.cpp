@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/compression/ZlibStreamPool.h"
+
+#include <zlib.h>
+#include <cstring>
+#include <vector>
+#include <boost/thread/tss.hpp>
+
+#include "cetty/handler/codec/compression/CompressionException.h"
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+// the level of the inflaters, which have no level.
+static const int INFLATER_LEVEL = -100;
+
+class ZlibStreamPool::ThreadCache {
+public:
+    ~ThreadCache() {
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            Entry& entry = entries[i];
+
+            for (std::size_t j = 0; j < entry.streams.size(); ++j) {
+                destroy(entry.streams[j], entry.level == INFLATER_LEVEL);
+            }
+        }
+    }
+
+    z_stream* take(int windowBits, int level) {
+        Entry* entry = find(windowBits, level);
+
+        if (entry == NULL || entry->streams.empty()) {
+            return NULL;
+        }
+
+        z_stream* stream = entry->streams.back();
+        entry->streams.pop_back();
+        return stream;
+    }
+
+    bool put(z_stream* stream, int windowBits, int level) {
+        Entry* entry = find(windowBits, level);
+
+        if (entry == NULL) {
+            entries.push_back(Entry(windowBits, level));
+            entry = &entries.back();
+        }
+
+        if (static_cast<int>(entry->streams.size()) >= MAX_CACHED_COUNT) {
+            return false;
+        }
+
+        entry->streams.push_back(stream);
+        return true;
+    }
+
+    int count() const {
+        int count = 0;
+
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            count += static_cast<int>(entries[i].streams.size());
+        }
+
+        return count;
+    }
+
+    static void destroy(z_stream* stream, bool inflater) {
+        if (inflater) {
+            inflateEnd(stream);
+        }
+        else {
+            deflateEnd(stream);
+        }
+
+        delete stream;
+    }
+
+private:
+    struct Entry {
+        Entry(int windowBits, int level) : windowBits(windowBits), level(level) {}
+
+        int windowBits;
+        int level;
+        std::vector<z_stream*> streams;
+    };
+
+    Entry* find(int windowBits, int level) {
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].windowBits == windowBits && entries[i].level == level) {
+                return &entries[i];
+            }
+        }
+
+        return NULL;
+    }
+
+private:
+    // only a few kinds are used, so a linear search is enough.
+    std::vector<Entry> entries;
+};
+
+ZlibStreamPool::ThreadCache& ZlibStreamPool::threadCache() {
+    // never destroyed, the threads may exit after the static destruction.
+    static boost::thread_specific_ptr<ThreadCache>* caches =
+        new boost::thread_specific_ptr<ThreadCache>;
+
+    ThreadCache* cache = caches->get();
+
+    if (NULL == cache) {
+        cache = new ThreadCache;
+        caches->reset(cache);
+    }
+
+    return *cache;
+}
+
+z_stream_s* ZlibStreamPool::acquireDeflater(int windowBits, int compressionLevel) {
+    z_stream* stream = threadCache().take(windowBits, compressionLevel);
+
+    if (stream) {
+        return stream;
+    }
+
+    stream = new z_stream;
+    std::memset(stream, 0, sizeof(z_stream));
+
+    int result = deflateInit2(stream,
+                              compressionLevel,
+                              Z_DEFLATED,
+                              windowBits,
+                              8,
+                              Z_DEFAULT_STRATEGY);
+
+    if (result != Z_OK) {
+        delete stream;
+        throw CompressionException("failed to initialize a deflater", result);
+    }
+
+    return stream;
+}
+
+void ZlibStreamPool::releaseDeflater(z_stream_s* stream,
+                                     int windowBits,
+                                     int compressionLevel) {
+    if (deflateReset(stream) != Z_OK
+            || !threadCache().put(stream, windowBits, compressionLevel)) {
+        ThreadCache::destroy(stream, false);
+    }
+}
+
+z_stream_s* ZlibStreamPool::acquireInflater(int windowBits) {
+    z_stream* stream = threadCache().take(windowBits, INFLATER_LEVEL);
+
+    if (stream) {
+        return stream;
+    }
+
+    stream = new z_stream;
+    std::memset(stream, 0, sizeof(z_stream));
+
+    int result = inflateInit2(stream, windowBits);
+
+    if (result != Z_OK) {
+        delete stream;
+        throw CompressionException("failed to initialize an inflater", result);
+    }
+
+    return stream;
+}
+
+void ZlibStreamPool::releaseInflater(z_stream_s* stream, int windowBits) {
+    if (inflateReset(stream) != Z_OK
+            || !threadCache().put(stream, windowBits, INFLATER_LEVEL)) {
+        ThreadCache::destroy(stream, true);
+    }
+}
+
+int ZlibStreamPool::getCachedCount() {
+    return threadCache().count();
+}
+
+}}}}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/compression/ZlibWrapper.h"
+
+namespace cetty { namespace handler { namespace codec { namespace compression { 
+
+const ZlibWrapper ZlibWrapper::ZLIB         = 0;
+const ZlibWrapper ZlibWrapper::GZIP         = 1;
+const ZlibWrapper ZlibWrapper::NONE         = 2;
+const ZlibWrapper ZlibWrapper::ZLIB_OR_NONE = 3;
+
+int ZlibWrapper::windowBits() const {
+    switch (m_value) {
+    case 1:
+        return 15 + 16;
+
+    case 2:
+        return -15;
+
+    default:
+        return 15;
+    }
+}
+
+std::string ZlibWrapper::toString() const {
+    switch (m_value) {
+    case 0:
+        return "ZLIB";
+
+    case 1:
+        return "GZIP";
+
+    case 2:
+        return "NONE";
+
+    case 3:
+        return "ZLIB_OR_NONE";
+
+    default:
+        return "UNKNOWN";
+    }
+}
+
+}}}}
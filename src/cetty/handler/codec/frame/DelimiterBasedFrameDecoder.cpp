@@ -18,6 +18,7 @@
 #include "cetty/channel/ChannelHandlerContext.h"
 #include "cetty/util/Integer.h"
 #include "cetty/util/Exception.h"
+#include "cetty/util/internal/ByteScanner.h"
 
 #include "cetty/handler/codec/frame/TooLongFrameException.h"
 #include "cetty/handler/codec/frame/DelimiterBasedFrameDecoder.h"
@@ -25,6 +26,7 @@
 namespace cetty { namespace handler { namespace codec { namespace frame {
 
 using namespace cetty::util;
+using namespace cetty::util::internal;
 using namespace cetty::channel;
 
 DelimiterBasedFrameDecoder::DelimiterBasedFrameDecoder(
@@ -117,13 +119,14 @@ DelimiterBasedFrameDecoder::decode(ChannelHandlerContext& ctx,
             return ChannelMessage::EMPTY_MESSAGE;
         }
 
+        int readerIndex = buffer->readerIndex();
         if (stripDelimiter) {
-            frame = buffer->readBytes(minFrameLength);
-            buffer->skipBytes(minDelimLength);
+            frame = extractFrame(buffer, readerIndex, minFrameLength);
         }
         else {
-            frame = buffer->readBytes(minFrameLength + minDelimLength);
+            frame = extractFrame(buffer, readerIndex, minFrameLength + minDelimLength);
         }
+        buffer->readerIndex(readerIndex + minFrameLength + minDelimLength);
 
         return ChannelMessage(frame);
     }
@@ -171,25 +174,42 @@ void DelimiterBasedFrameDecoder::fail(ChannelHandlerContext& ctx, long frameLeng
 
 int DelimiterBasedFrameDecoder::indexOf(const ChannelBufferPtr& haystack,
                                         const ChannelBufferPtr& needle) {
-    for (int i = haystack->readerIndex(); i < haystack->writerIndex(); ++i) {
-        int haystackIndex = i;
-        int needleIndex;
-        for (needleIndex = 0; needleIndex < needle->capacity(); ++needleIndex) {
-            if (haystack->getByte(haystackIndex) != needle->getByte(needleIndex)) {
-                break;
-            }
-            else {
-                haystackIndex ++;
-                if (haystackIndex == haystack->writerIndex() &&
-                    needleIndex != needle->capacity() - 1) {
-                        return -1;
-                }
-            }
+    int readerIndex = haystack->readerIndex();
+    int writerIndex = haystack->writerIndex();
+    int needleLength = needle->capacity();
+
+    ConstArray bytes;
+    ConstArray delimiter;
+    int start = haystack->getContiguousBytes(readerIndex, bytes);
+
+    if (start >= 0 && start + bytes.length() >= writerIndex
+            && needle->getContiguousBytes(0, delimiter) == 0
+            && delimiter.length() >= needleLength) {
+        // all the readable bytes are in one region.
+        return ByteScanner::findSequence(bytes.data() + (readerIndex - start),
+                                         writerIndex - readerIndex,
+                                         delimiter.data(),
+                                         needleLength);
+    }
+
+    boost::int8_t first = needle->getByte(0);
+
+    for (int i = readerIndex; i + needleLength <= writerIndex; ++i) {
+        // jump to the next candidate with the bulk scanning.
+        i = haystack->indexOf(i, writerIndex - needleLength + 1, first);
+        if (i < 0) {
+            return -1;
+        }
+
+        int needleIndex = 1;
+        while (needleIndex < needleLength
+                && haystack->getByte(i + needleIndex) == needle->getByte(needleIndex)) {
+            ++needleIndex;
         }
 
-        if (needleIndex == needle->capacity()) {
+        if (needleIndex == needleLength) {
             // Found the needle from the haystack!
-            return i - haystack->readerIndex();
+            return i - readerIndex;
         }
     }
     return -1;
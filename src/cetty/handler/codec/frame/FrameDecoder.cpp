@@ -26,7 +26,8 @@
 #include "cetty/channel/ChannelStateEvent.h"
 
 #include "cetty/buffer/ChannelBuffers.h"
-#include "cetty/buffer/DynamicChannelBuffer.h"
+#include "cetty/buffer/ChannelBufferFactory.h"
+#include "cetty/buffer/CompositeChannelBuffer.h"
 #include "cetty/util/Exception.h"
 #include "cetty/handler/codec/frame/FrameDecoder.h"
 
@@ -50,21 +51,41 @@ void FrameDecoder::messageReceived(ChannelHandlerContext& ctx, const MessageEven
     channelOwnBuffer =
         ctx.getChannel().getConfig().channelOwnBuffer();
 
-    if (channelOwnBuffer) {
-        callDecode(ctx, e.getChannel(), input, e.getRemoteAddress());
+    if (decodingStopped) {
+        // keeps the bytes for the decoder which will replace this one.
+        if (!cumulation || !cumulation->readable()) {
+            cumulation = retain(input);
+            input->skipBytes(input->readableBytes());
+        }
+        else {
+            appendToCumulation(input);
+        }
+        return;
     }
-    else {
-        ChannelBufferPtr cumulation = getCumulation(ctx);
-        if (cumulation->readable()) {
-            cumulation->discardReadBytes();
-            cumulation->writeBytes(*input);
-            callDecode(ctx, e.getChannel(), cumulation, e.getRemoteAddress());
+
+    if (!cumulation || !cumulation->readable()) {
+        sliceable = channelOwnBuffer;
+        callDecode(ctx, e.getChannel(), input, e.getRemoteAddress());
+
+        if (input->readable()) {
+            cumulation = retain(input);
+            input->skipBytes(input->readableBytes());
         }
         else {
-            callDecode(ctx, e.getChannel(), input, e.getRemoteAddress());
-            if (input->readable()) {
-                cumulation->writeBytes(*input);
-            }
+            cumulation = ChannelBuffers::EMPTY_BUFFER;
+        }
+    }
+    else {
+        appendToCumulation(input);
+
+        // the handler may be removed while decoding.
+        ChannelBufferPtr buffer = cumulation;
+        sliceable = true;
+        callDecode(ctx, e.getChannel(), buffer, e.getRemoteAddress());
+
+        if (!buffer->readable() && buffer == cumulation) {
+            // do not keep the received buffers alive.
+            cumulation = ChannelBuffers::EMPTY_BUFFER;
         }
     }
 }
@@ -81,11 +102,23 @@ void FrameDecoder::exceptionCaught(ChannelHandlerContext& ctx, const ExceptionEv
     ctx.sendUpstream(e);
 }
 
+ChannelBufferPtr FrameDecoder::takeUndecoded() {
+    ChannelBufferPtr undecoded;
+
+    if (cumulation && cumulation->readable()) {
+        undecoded = cumulation;
+    }
+
+    cumulation = ChannelBuffers::EMPTY_BUFFER;
+    return undecoded;
+}
+
 void FrameDecoder::callDecode(ChannelHandlerContext& context,
                               Channel& channel,
                               const ChannelBufferPtr& cumulation,
                               const SocketAddress& remoteAddress) {
-    while (cumulation->readable()) {
+    // a handler of the frame may stop the decoding.
+    while (cumulation->readable() && !decodingStopped) {
         int oldReaderIndex = cumulation->readerIndex();
         ChannelMessage frame = decode(context, channel, cumulation);
         if (frame.empty()) {
@@ -108,13 +141,6 @@ void FrameDecoder::callDecode(ChannelHandlerContext& context,
 
         unfoldAndFireMessageReceived(context, remoteAddress, frame);
     }
-
-    // if the channel has private ChannelBuffer,
-    // then just move the left readable bytes to the begin of
-    // the ChannelBuffer.
-    if (channelOwnBuffer) {
-        cumulation->discardReadBytes();
-    }
 }
 
 void FrameDecoder::unfoldAndFireMessageReceived(ChannelHandlerContext& context,
@@ -141,39 +167,96 @@ void FrameDecoder::unfoldAndFireMessageReceived(ChannelHandlerContext& context,
 
 void FrameDecoder::cleanup(ChannelHandlerContext& ctx, const ChannelStateEvent& e) {
     try {
-        if (!cumulation) {
-            return;
-        }
+        ChannelBufferPtr buffer = cumulation;
+        cumulation.reset();
 
-        if (cumulation->readable()) {
-            // Make sure all frames are read before notifying a closed channel.
-            callDecode(ctx, ctx.getChannel(), cumulation, SocketAddress::NULL_ADDRESS);
-        }
+        // nothing to decode, or the bytes are not of the protocol of
+        // this decoder.
+        if (buffer && !decodingStopped) {
+            sliceable = true;
 
-        // Call decodeLast() finally.  Please note that decodeLast() is
-        // called even if there's nothing more to read from the buffer to
-        // notify a user that the connection was closed explicitly.
-        ChannelMessage partialFrame = decodeLast(ctx, ctx.getChannel(), cumulation);
-        if (!partialFrame.empty()) {
-            unfoldAndFireMessageReceived(ctx, SocketAddress::NULL_ADDRESS, partialFrame);
-        }
+            if (buffer->readable()) {
+                // Make sure all frames are read before notifying a closed channel.
+                callDecode(ctx, ctx.getChannel(), buffer, SocketAddress::NULL_ADDRESS);
+            }
 
-        cumulation->clear();
+            // Call decodeLast() finally.  Please note that decodeLast() is
+            // called even if there's nothing more to read from the buffer to
+            // notify a user that the connection was closed explicitly.
+            ChannelMessage partialFrame = decodeLast(ctx, ctx.getChannel(), buffer);
+            if (!partialFrame.empty()) {
+                unfoldAndFireMessageReceived(ctx, SocketAddress::NULL_ADDRESS, partialFrame);
+            }
+        }
     }
-    catch(...) {
+    catch (...) {
+        // the state event always goes on, the handlers after have to
+        // know the channel has been disconnected or closed.
         ctx.sendUpstream(e);
+        throw;
     }
+
+    ctx.sendUpstream(e);
 }
 
-ChannelBufferPtr& FrameDecoder::getCumulation(ChannelHandlerContext& ctx) {
-    if (!cumulation) {
-        ChannelBufferFactory* factory =
-            ctx.getChannel().getConfig().getBufferFactory();
-        
-        BOOST_ASSERT(factory);
-        cumulation = ChannelBuffers::dynamicBuffer(*factory);
+ChannelBufferPtr FrameDecoder::extractFrame(const ChannelBufferPtr& buffer,
+                                            int index,
+                                            int length) {
+    if (sliceable) {
+        return buffer->slice(index, length);
     }
-    return cumulation;
+
+    ChannelBufferPtr frame = buffer->factory().getBuffer(length);
+    frame->writeBytes(*buffer, index, length);
+    return frame;
+}
+
+void FrameDecoder::appendToCumulation(const ChannelBufferPtr& input) {
+    std::vector<ChannelBufferPtr> components;
+    CompositeChannelBufferPtr composite =
+        boost::dynamic_pointer_cast<CompositeChannelBuffer>(cumulation);
+
+    if (composite) {
+        components = composite->decompose();
+    }
+    else {
+        components.push_back(cumulation);
+    }
+
+    // merges the small fragments, so a stream of small reads does not
+    // end up with a component per read.
+    ChannelBufferPtr& last = components.back();
+    int mergedBytes = last->readableBytes() + input->readableBytes();
+
+    if (mergedBytes <= MAX_COPIED_FRAGMENT_SIZE) {
+        ChannelBufferPtr merged =
+            last->factory().getBuffer(last->order(), mergedBytes);
+
+        merged->writeBytes(*last);
+        merged->writeBytes(*input);
+        last = merged;
+    }
+    else {
+        components.push_back(retain(input));
+        input->skipBytes(input->readableBytes());
+    }
+
+    if (components.size() == 1) {
+        cumulation = components.front();
+    }
+    else {
+        cumulation = ChannelBuffers::wrappedBuffer(components);
+    }
+}
+
+ChannelBufferPtr FrameDecoder::retain(const ChannelBufferPtr& input) const {
+    // the channel will not overwrite the bytes of its own read buffer
+    // which are referenced by a slice.
+    if (channelOwnBuffer && input->readableBytes() > MAX_COPIED_FRAGMENT_SIZE) {
+        return input->slice();
+    }
+
+    return input->copy();
 }
 
-}}}}
\ No newline at end of file
+}}}}
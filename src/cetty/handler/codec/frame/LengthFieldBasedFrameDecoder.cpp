@@ -137,13 +137,6 @@ LengthFieldBasedFrameDecoder::decode(ChannelHandlerContext& ctx,
     return ChannelMessage(frame);
 }
 
-ChannelBufferPtr
-LengthFieldBasedFrameDecoder::extractFrame(const ChannelBufferPtr& buffer, int index, int length) {
-    ChannelBufferPtr frame = buffer->factory().getBuffer(length);
-    frame->writeBytes(*buffer, index, length);
-    return frame;
-}
-
 void LengthFieldBasedFrameDecoder::fail(ChannelHandlerContext& ctx, int frameLength) {
     std::string msg;
     msg.reserve(64);
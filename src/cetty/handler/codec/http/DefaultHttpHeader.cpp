@@ -18,6 +18,7 @@
 
 #include <string.h>
 
+#include "cetty/handler/codec/http/HttpHeaders.h"
 #include "cetty/handler/codec/http/HttpCodecUtil.h"
 #include "cetty/util/Integer.h"
 
@@ -25,8 +26,226 @@ namespace cetty { namespace handler { namespace codec { namespace http {
 
 using namespace cetty::util;
 
+/**
+ * The interned {@link HttpHeaders::Names}, which are looked up by the
+ * address of the constant or by the bytes of a received name.
+ */
+class KnownHeaderNames {
+public:
+    static const KnownHeaderNames& instance() {
+        static KnownHeaderNames names;
+        return names;
+    }
+
+    const std::string& name(int token) const { return *names[token]; }
+    int hash(int token) const { return hashes[token]; }
+
+    int tokenOf(const std::string& name) const {
+        const std::string* address = &name;
+        int i = slotOf(address);
+
+        while (addresses[i]) {
+            if (addresses[i] == address) {
+                return addressTokens[i];
+            }
+            i = (i + 1) & SLOT_MASK;
+        }
+        return -1;
+    }
+
+    int intern(int hash, const char* name, int size) const;
+
+private:
+    KnownHeaderNames();
+
+    static int slotOf(const std::string* address) {
+        size_t value = reinterpret_cast<size_t>(address);
+        return static_cast<int>((value >> 3) ^ (value >> 11)) & SLOT_MASK;
+    }
+
+private:
+    static const int SLOT_SIZE = 256;
+    static const int SLOT_MASK = SLOT_SIZE - 1;
+
+    std::vector<const std::string*> names;
+    std::vector<int> hashes;
+
+    // open addressing tables of the tokens.
+    int tokens[SLOT_SIZE];
+    const std::string* addresses[SLOT_SIZE];
+    int addressTokens[SLOT_SIZE];
+};
+
 const std::string DefaultHttpHeader::EMPTY_VALUE;
 
+KnownHeaderNames::KnownHeaderNames() {
+    static const std::string* const ALL_NAMES[] = {
+        &HttpHeaders::Names::ACCEPT,
+        &HttpHeaders::Names::ACCEPT_CHARSET,
+        &HttpHeaders::Names::ACCEPT_ENCODING,
+        &HttpHeaders::Names::ACCEPT_LANGUAGE,
+        &HttpHeaders::Names::ACCEPT_RANGES,
+        &HttpHeaders::Names::ACCEPT_PATCH,
+        &HttpHeaders::Names::AGE,
+        &HttpHeaders::Names::ALLOW,
+        &HttpHeaders::Names::AUTHORIZATION,
+        &HttpHeaders::Names::CACHE_CONTROL,
+        &HttpHeaders::Names::CONNECTION,
+        &HttpHeaders::Names::CONTENT_BASE,
+        &HttpHeaders::Names::CONTENT_ENCODING,
+        &HttpHeaders::Names::CONTENT_LANGUAGE,
+        &HttpHeaders::Names::CONTENT_LENGTH,
+        &HttpHeaders::Names::CONTENT_LOCATION,
+        &HttpHeaders::Names::CONTENT_TRANSFER_ENCODING,
+        &HttpHeaders::Names::CONTENT_MD5,
+        &HttpHeaders::Names::CONTENT_RANGE,
+        &HttpHeaders::Names::CONTENT_TYPE,
+        &HttpHeaders::Names::COOKIE,
+        &HttpHeaders::Names::DATE,
+        &HttpHeaders::Names::ETAG,
+        &HttpHeaders::Names::EXPECT,
+        &HttpHeaders::Names::EXPIRES,
+        &HttpHeaders::Names::FROM,
+        &HttpHeaders::Names::HOST,
+        &HttpHeaders::Names::IF_MATCH,
+        &HttpHeaders::Names::IF_MODIFIED_SINCE,
+        &HttpHeaders::Names::IF_NONE_MATCH,
+        &HttpHeaders::Names::IF_RANGE,
+        &HttpHeaders::Names::IF_UNMODIFIED_SINCE,
+        &HttpHeaders::Names::LAST_MODIFIED,
+        &HttpHeaders::Names::LOCATION,
+        &HttpHeaders::Names::MAX_FORWARDS,
+        &HttpHeaders::Names::ORIGIN,
+        &HttpHeaders::Names::PRAGMA,
+        &HttpHeaders::Names::PROXY_AUTHENTICATE,
+        &HttpHeaders::Names::PROXY_AUTHORIZATION,
+        &HttpHeaders::Names::RANGE,
+        &HttpHeaders::Names::REFERER,
+        &HttpHeaders::Names::RETRY_AFTER,
+        &HttpHeaders::Names::SEC_WEBSOCKET_ACCEPT,
+        &HttpHeaders::Names::SEC_WEBSOCKET_EXTENSIONS,
+        &HttpHeaders::Names::SEC_WEBSOCKET_KEY,
+        &HttpHeaders::Names::SEC_WEBSOCKET_KEY1,
+        &HttpHeaders::Names::SEC_WEBSOCKET_KEY2,
+        &HttpHeaders::Names::SEC_WEBSOCKET_LOCATION,
+        &HttpHeaders::Names::SEC_WEBSOCKET_ORIGIN,
+        &HttpHeaders::Names::SEC_WEBSOCKET_PROTOCOL,
+        &HttpHeaders::Names::SEC_WEBSOCKET_VERSION,
+        &HttpHeaders::Names::SERVER,
+        &HttpHeaders::Names::SET_COOKIE,
+        &HttpHeaders::Names::SET_COOKIE2,
+        &HttpHeaders::Names::TE,
+        &HttpHeaders::Names::TRAILER,
+        &HttpHeaders::Names::TRANSFER_ENCODING,
+        &HttpHeaders::Names::UPGRADE,
+        &HttpHeaders::Names::USER_AGENT,
+        &HttpHeaders::Names::VARY,
+        &HttpHeaders::Names::VIA,
+        &HttpHeaders::Names::WARNING,
+        &HttpHeaders::Names::WEBSOCKET_LOCATION,
+        &HttpHeaders::Names::WEBSOCKET_ORIGIN,
+        &HttpHeaders::Names::WEBSOCKET_PROTOCOL,
+        &HttpHeaders::Names::WWW_AUTHENTICATE,
+    };
+
+    int count = static_cast<int>(sizeof(ALL_NAMES) / sizeof(ALL_NAMES[0]));
+
+    memset(addresses, 0, sizeof(addresses));
+    for (int i = 0; i < SLOT_SIZE; ++i) {
+        tokens[i] = -1;
+    }
+
+    for (int token = 0; token < count; ++token) {
+        const std::string& name = *ALL_NAMES[token];
+        int h = DefaultHttpHeader::hash(name.data(), static_cast<int>(name.size()));
+
+        names.push_back(&name);
+        hashes.push_back(h);
+
+        int i = h & SLOT_MASK;
+        while (tokens[i] >= 0) {
+            i = (i + 1) & SLOT_MASK;
+        }
+        tokens[i] = token;
+
+        i = slotOf(&name);
+        while (addresses[i]) {
+            i = (i + 1) & SLOT_MASK;
+        }
+        addresses[i] = &name;
+        addressTokens[i] = token;
+    }
+}
+
+int KnownHeaderNames::intern(int hash, const char* name, int size) const {
+    int i = hash & SLOT_MASK;
+
+    while (tokens[i] >= 0) {
+        int token = tokens[i];
+        const std::string& known = *names[token];
+
+        if (hashes[token] == hash &&
+            DefaultHttpHeader::eq(known.data(), static_cast<int>(known.size()), name, size)) {
+            return token;
+        }
+        i = (i + 1) & SLOT_MASK;
+    }
+    return -1;
+}
+
+const std::string& DefaultHttpHeader::Entry::getKey() const {
+    if (token >= 0) {
+        return KnownHeaderNames::instance().name(token);
+    }
+
+    if (nameRef) {
+        key.assign(nameRef, nameSize);
+        nameRef = NULL;
+    }
+    return key;
+}
+
+bool DefaultHttpHeader::Entry::hasName(const Name& name) const {
+    if (hash != name.hash) {
+        return false;
+    }
+
+    // a well-known name is always interned.
+    if (token >= 0 || name.token >= 0) {
+        return token == name.token;
+    }
+
+    if (nameRef) {
+        return eq(nameRef, nameSize, name.data, name.size);
+    }
+    return eq(key.data(), static_cast<int>(key.size()), name.data, name.size);
+}
+
+bool DefaultHttpHeader::Entry::hasValue(const std::string& value) const {
+    if (valueRef) {
+        return eq(valueRef, valueSize, value.data(), static_cast<int>(value.size()));
+    }
+    return eq(this->value.data(), static_cast<int>(this->value.size()),
+              value.data(), static_cast<int>(value.size()));
+}
+
+void DefaultHttpHeader::Entry::setName(const Name& name, bool copy) {
+    hash = name.hash;
+    token = name.token;
+
+    if (token >= 0) {
+        return;
+    }
+
+    if (copy) {
+        key.assign(name.data, name.size);
+    }
+    else {
+        nameRef = name.data;
+        nameSize = name.size;
+    }
+}
+
 DefaultHttpHeader::DefaultHttpHeader()
     : head(new Entry), freelist(NULL) {
     head->before = head->after = head;
@@ -49,29 +268,50 @@ void DefaultHttpHeader::add(const std::string& name, const std::string& value) {
     validateHeaderName(name);
     HttpCodecUtil::validateHeaderValue(value);
 
-    int h = hash(name);
-    int i = index(h);
-    addHeader(h, i, name, value);
+    addHeader(nameOf(name), value);
 }
 
 void DefaultHttpHeader::add(const std::string& name, int value) {
     add(name, Integer::toString(value));
 }
 
+void DefaultHttpHeader::add(const ChannelBufferPtr& buffer,
+                            const char* name,
+                            int nameSize,
+                            const char* value,
+                            int valueSize) {
+    HttpCodecUtil::validateHeaderName(name, nameSize);
+    HttpCodecUtil::validateHeaderValue(value, valueSize);
+
+    if (buffers.empty() || buffers.back() != buffer) {
+        buffers.push_back(buffer);
+    }
+
+    Name n = nameOf(name, nameSize);
+    int i = index(n.hash);
+
+    Entry* entry = newEntry();
+    entry->setName(n, false);
+    entry->setValue(value, valueSize);
+
+    // Update the hash table.
+    entry->next = entries[i];
+    entries[i] = entry;
+
+    // Update the linked list.
+    entry->addBefore(head);
+}
+
 void DefaultHttpHeader::remove(const std::string& name) {
     if (name.empty()) return;
 
-    int h = hash(name);
-    int i = index(h);
-    removeHeader(h, i, name);
+    removeHeader(nameOf(name));
 }
 
 void DefaultHttpHeader::remove(const std::string& name, const std::string& value) {
     if (name.empty()) return;
 
-    int h = hash(name);
-    int i = index(h);
-    removeHeader(h, i, name, value);
+    removeHeader(nameOf(name), value);
 }
 
 void DefaultHttpHeader::set(const std::string& name, const std::string& value) {
@@ -80,10 +320,9 @@ void DefaultHttpHeader::set(const std::string& name, const std::string& value) {
     validateHeaderName(name);
     HttpCodecUtil::validateHeaderValue(value);
 
-    int h = hash(name);
-    int i = index(h);
-    removeHeader(h, i, name);
-    addHeader(h, i, name, value);
+    Name n = nameOf(name);
+    removeHeader(n);
+    addHeader(n, value);
 }
 
 void DefaultHttpHeader::set(const std::string& name, const StringList& values) {
@@ -93,10 +332,8 @@ void DefaultHttpHeader::set(const std::string& name, const StringList& values) {
 
     validateHeaderName(name);
 
-    int h = hash(name);
-    int i = index(h);
-
-    removeHeader(h, i, name);
+    Name n = nameOf(name);
+    removeHeader(n);
 
     for (size_t i = 0; i < values.size(); ++i) {
         if (values[i].empty()) {
@@ -104,7 +341,7 @@ void DefaultHttpHeader::set(const std::string& name, const StringList& values) {
         }
 
         HttpCodecUtil::validateHeaderValue(values[i]);
-        addHeader(h, i, name, values[i]);
+        addHeader(n, values[i]);
     }
 }
 
@@ -121,16 +358,16 @@ void DefaultHttpHeader::set(const std::string& name, const IntList& values) {
 }
 
 void DefaultHttpHeader::clear() {
-    for (int i = 0; i < BUCKET_SIZE; ++i) {
-        Entry* e = entries[i];
-        while (e != NULL) {
-            Entry* next = e->next;
-            delete e;
-            e = next;
-        }
-        entries[i] = NULL;
+    Entry* e = head->after;
+    while (e != head) {
+        Entry* next = e->after;
+        deleteEntry(e);
+        e = next;
     }
+
+    memset(entries, 0, sizeof(entries));
     head->before = head->after = head;
+    buffers.clear();
 }
 
 const std::string& DefaultHttpHeader::get(const std::string& name) const {
@@ -138,15 +375,9 @@ const std::string& DefaultHttpHeader::get(const std::string& name) const {
         return EMPTY_VALUE;
     }
 
-    int h = hash(name);
-    int i = index(h);
-    Entry* e = entries[i];
-    while (e != NULL) {
-        if (e->hash == h && eq(name, e->key)) {
-            return e->value;
-        }
-
-        e = e->next;
+    Entry* e = find(nameOf(name));
+    if (e) {
+        return e->getValue();
     }
     return EMPTY_VALUE;
 }
@@ -166,12 +397,11 @@ void DefaultHttpHeader::gets(const std::string& name, StringList& headers) const
     }
     headers.clear();
 
-    int h = hash(name);
-    int i = index(h);
-    Entry* e = entries[i];
+    Name n = nameOf(name);
+    Entry* e = entries[index(n.hash)];
     while (e != NULL) {
-        if (e->hash == h && eq(name, e->key)) {
-            headers.push_back(e->value);
+        if (e->hasName(n)) {
+            headers.push_back(e->getValue());
         }
         e = e->next;
     }
@@ -179,12 +409,7 @@ void DefaultHttpHeader::gets(const std::string& name, StringList& headers) const
 
 HttpHeader::NameValueList DefaultHttpHeader::gets() const {
     NameValueList all;
-
-    Entry* e = head->after;
-    while (e != head) {
-        all.push_back(std::make_pair(e->key, e->value));
-        e = e->after;
-    }
+    gets(all);
     return all;
 }
 
@@ -193,7 +418,7 @@ void DefaultHttpHeader::gets(NameValueList& nameValues) const {
 
     Entry* e = head->after;
     while (e != head) {
-        nameValues.push_back(std::make_pair(e->key, e->value));
+        nameValues.push_back(std::make_pair(e->getKey(), e->getValue()));
         e = e->after;
     }
 }
@@ -204,12 +429,7 @@ bool DefaultHttpHeader::contains(const std::string& name) const {
 
 HttpHeader::StringList DefaultHttpHeader::getNames() const {
     StringList names;
-
-    Entry* e = head->after;
-    while (e != head) {
-        names.push_back(e->key);
-        e = e->after;
-    }
+    getNames(names);
     return names;
 }
 
@@ -218,29 +438,26 @@ void DefaultHttpHeader::getNames(StringList& names) const {
 
     Entry* e = head->after;
     while (e != head) {
-        names.push_back(e->key);
+        names.push_back(e->getKey());
         e = e->after;
     }
 }
 
-DefaultHttpHeader::Entry* DefaultHttpHeader::newEntry(int h, const std::string& name, const std::string& value) {
+DefaultHttpHeader::Entry* DefaultHttpHeader::newEntry() {
     if (freelist) {
         Entry* entry = freelist;
         freelist = freelist->next;
+        entry->next = NULL;
         return entry;
     }
 
-    return new Entry(h, name, value);
+    return new Entry;
 }
 
 void DefaultHttpHeader::deleteEntry(Entry* entry) {
+    // keeps the entry and the capacity of its strings for the next header.
     entry->clear();
-
-    if (freelist) {
-        entry->next = freelist;
-        freelist = entry;
-    }
-
+    entry->next = freelist;
     freelist = entry;
 }
 
@@ -253,98 +470,84 @@ void DefaultHttpHeader::clearFreeList() {
     }
 }
 
-void DefaultHttpHeader::addHeader(int h, int i, const std::string& name, const std::string& value) {
+DefaultHttpHeader::Entry* DefaultHttpHeader::find(const Name& name) const {
+    Entry* e = entries[index(name.hash)];
+    while (e != NULL) {
+        if (e->hasName(name)) {
+            return e;
+        }
+        e = e->next;
+    }
+    return NULL;
+}
+
+void DefaultHttpHeader::addHeader(const Name& name, const std::string& value) {
+    int i = index(name.hash);
+
+    Entry* entry = newEntry();
+    entry->setName(name, true);
+    entry->setValue(value);
+
     // Update the hash table.
-    Entry* e = entries[i];
-    Entry* entry;
-    entries[i] = entry = newEntry(h, name, value);
-    entry->next = e;
+    entry->next = entries[i];
+    entries[i] = entry;
 
     // Update the linked list.
     entry->addBefore(head);
 }
 
-void DefaultHttpHeader::removeHeader(int h, int i, const std::string& name) {
-    Entry* e = entries[i];
-    if (e == NULL) {
-        return;
-    }
+void DefaultHttpHeader::removeHeader(const Name& name) {
+    Entry** link = &entries[index(name.hash)];
 
-    for (;;) {
-        if (e->hash == h && eq(name, e->key)) {
+    while (*link != NULL) {
+        Entry* e = *link;
+        if (e->hasName(name)) {
+            *link = e->next;
             e->remove();
-            Entry* next = e->next;
-            if (next != NULL) {
-                entries[i] = next;
-                e = next;
-            }
-            else {
-                entries[i] = NULL;
-                return;
-            }
-        }
-        else {
-            break;
-        }
-    }
-
-    for (;;) {
-        Entry* next = e->next;
-        if (next == NULL) {
-            break;
-        }
-        if (next->hash == h && eq(name, next->key)) {
-            e->next = next->next;
-            next->remove();
+            deleteEntry(e);
         }
         else {
-            e = next;
+            link = &e->next;
         }
     }
 }
 
-void DefaultHttpHeader::removeHeader(int h, int i, const std::string& name, const std::string& value) {
-    Entry* e = entries[i];
-    if (e == NULL) {
-        return;
-    }
+void DefaultHttpHeader::removeHeader(const Name& name, const std::string& value) {
+    Entry** link = &entries[index(name.hash)];
 
-    for (;;) {
-        if (e->hash == h && eq(name, e->key) && eq(value, e->value)) {
+    while (*link != NULL) {
+        Entry* e = *link;
+        if (e->hasName(name) && e->hasValue(value)) {
+            *link = e->next;
             e->remove();
-            Entry* next = e->next;
-            if (next != NULL) {
-                entries[i] = next;
-                e = next;
-            }
-            else {
-                entries[i] = NULL;
-                return;
-            }
+            deleteEntry(e);
         }
         else {
-            break;
+            link = &e->next;
         }
     }
+}
 
-    for (;;) {
-        Entry* next = e->next;
-        if (next == NULL) {
-            break;
-        }
-        if (next->hash == h && eq(name, next->key) && eq(value, next->value)) {
-            e->next = next->next;
-            next->remove();
-        }
-        else {
-            e = next;
-        }
+DefaultHttpHeader::Name DefaultHttpHeader::nameOf(const std::string& name) {
+    const KnownHeaderNames& knownNames = KnownHeaderNames::instance();
+    int token = knownNames.tokenOf(name);
+
+    if (token >= 0) {
+        Name n = { knownNames.hash(token), token, name.data(), static_cast<int>(name.size()) };
+        return n;
     }
+    return nameOf(name.data(), static_cast<int>(name.size()));
+}
+
+DefaultHttpHeader::Name DefaultHttpHeader::nameOf(const char* name, int size) {
+    int h = hash(name, size);
+    Name n = { h, KnownHeaderNames::instance().intern(h, name, size), name, size };
+    return n;
 }
 
-int DefaultHttpHeader::hash(const std::string& name) {
+int DefaultHttpHeader::hash(const char* name, int size) {
     int h = 0;
-    for (int i = (int)name.size() - 1; i >= 0; --i) {
+    for (int i = size - 1; i >= 0; --i) {
         char c = name[i];
         if (c >= 'A' && c <= 'Z') {
             c += 32;
@@ -363,15 +566,14 @@ int DefaultHttpHeader::hash(const std::string& name) {
     }
 }
 
-bool DefaultHttpHeader::eq(const std::string& name1, const std::string& name2) {
-    size_t nameLen = name1.size();
-    if (nameLen != name2.size()) {
+bool DefaultHttpHeader::eq(const char* name1, int size1, const char* name2, int size2) {
+    if (size1 != size2) {
         return false;
     }
 
-    for (int i = (int)nameLen - 1; i >= 0; --i) {
-        char c1 = name1.at(i);
-        char c2 = name2.at(i);
+    for (int i = size1 - 1; i >= 0; --i) {
+        char c1 = name1[i];
+        char c2 = name2[i];
         if (c1 != c2) {
             if (c1 >= 'A' && c1 <= 'Z') {
                 c1 += 32;
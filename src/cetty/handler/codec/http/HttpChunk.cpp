@@ -54,6 +54,13 @@ public:
     virtual void add(const std::string& name, int value) {
         throw IllegalStateException("read-only");
     }
+    virtual void add(const ChannelBufferPtr& buffer,
+                     const char* name,
+                     int nameSize,
+                     const char* value,
+                     int valueSize) {
+        throw IllegalStateException("read-only");
+    }
 
     virtual void set(const std::string& name, const std::string& value) {
         throw IllegalStateException("read-only");
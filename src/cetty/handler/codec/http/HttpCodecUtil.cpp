@@ -31,11 +31,16 @@ const char HttpCodecUtil::CRLF[2] = { (char)HttpCodecUtil::CR, (char)HttpCodecUt
 //static final Charset DEFAULT_CHARSET = CharsetUtil.UTF_8;
 
 void HttpCodecUtil::validateHeaderName(const std::string& name) {
-    for (size_t i = 0; i < name.size(); ++i) {
-        char c = name.at(i);
-        if (c > 127) {
+    validateHeaderName(name.data(), static_cast<int>(name.size()));
+}
+
+void HttpCodecUtil::validateHeaderName(const char* name, int size) {
+    for (int i = 0; i < size; ++i) {
+        char c = name[i];
+        if (c & 0x80) {
             throw InvalidArgumentException(
-                std::string("name contains non-ascii character: ") + name);
+                std::string("name contains non-ascii character: ") +
+                std::string(name, size));
         }
 
         // Check prohibited characters.
@@ -44,28 +49,32 @@ void HttpCodecUtil::validateHeaderName(const std::string& name) {
         case ' ':  case ',':  case ':':  case ';':  case '=':
             throw InvalidArgumentException(
                 std::string("name contains one of the following prohibited characters: ") +
-                std::string("=,;: \\t\\r\\n\\v\\f: ") + name);
+                std::string("=,;: \\t\\r\\n\\v\\f: ") + std::string(name, size));
         }
     }
 }
 
 void HttpCodecUtil::validateHeaderValue(const std::string& value) {
+    validateHeaderValue(value.data(), static_cast<int>(value.size()));
+}
+
+void HttpCodecUtil::validateHeaderValue(const char* value, int size) {
     // 0 - the previous character was neither CR nor LF
     // 1 - the previous character was CR
     // 2 - the previous character was LF
     int state = 0;
 
-    for (size_t i = 0; i < value.length(); ++i) {
-        char c = value.at(i);
+    for (int i = 0; i < size; ++i) {
+        char c = value[i];
 
         // Check the absolutely prohibited characters.
         switch (c) {
             case 0x0b: // Vertical tab
                 throw InvalidArgumentException(
-                    std::string("value contains a prohibited character '\\v': ") + value);
+                    std::string("value contains a prohibited character '\\v': ") + std::string(value, size));
             case '\f':
                 throw InvalidArgumentException(
-                    std::string("value contains a prohibited character '\\f': ") + value);
+                    std::string("value contains a prohibited character '\\f': ") + std::string(value, size));
         }
 
         // Check the CRLF (HT | SP) pattern
@@ -87,7 +96,7 @@ void HttpCodecUtil::validateHeaderValue(const std::string& value) {
                 break;
             default:
                 throw InvalidArgumentException(
-                    std::string("Only '\\n' is allowed after '\\r': ") + value);
+                    std::string("Only '\\n' is allowed after '\\r': ") + std::string(value, size));
                 }
                 break;
             case 2:
@@ -97,14 +106,14 @@ void HttpCodecUtil::validateHeaderValue(const std::string& value) {
                 break;
             default:
                 throw InvalidArgumentException(
-                    std::string("Only ' ' and '\\t' are allowed after '\\n': ") + value);
+                    std::string("Only ' ' and '\\t' are allowed after '\\n': ") + std::string(value, size));
                 }
         }
     }
 
     if (state != 0) {
         throw InvalidArgumentException(
-            std::string("value must not end with '\\r' or '\\n':") + value);
+            std::string("value must not end with '\\r' or '\\n':") + std::string(value, size));
     }
 }
 
@@ -0,0 +1,705 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/HttpConnectionPool.h"
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/ChannelException.h"
+#include "cetty/channel/ChannelPipeline.h"
+#include "cetty/channel/ChannelPipelineFactory.h"
+#include "cetty/channel/ChannelHandlerContext.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/ExceptionEvent.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/util/Exception.h"
+#include "cetty/util/Integer.h"
+#include "cetty/util/Timeout.h"
+#include "cetty/util/Timer.h"
+#include "cetty/util/TimerFactory.h"
+
+#include "cetty/handler/codec/http/HttpHeaders.h"
+#include "cetty/handler/codec/http/HttpClientCodec.h"
+#include "cetty/handler/codec/http/HttpChunkAggregator.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http {
+
+using namespace cetty::channel;
+using namespace cetty::util;
+
+/**
+ * Whether the pool is still alive, the idle timeouts hold it and check it
+ * under the mutex, which the destructor of the pool takes.
+ */
+class HttpConnectionPool::Liveness {
+public:
+    Liveness() : alive(true) {}
+
+    boost::mutex mutex;
+    bool alive;
+};
+
+static void cancelTimeout(const TimeoutPtr& timeout) {
+    if (timeout) {
+        timeout->cancel();
+    }
+}
+
+/**
+ * The connections of a host, all the members are guarded by the mutex.
+ */
+class HttpConnectionPool::HostPool {
+public:
+    struct Waiter {
+        Waiter() {}
+        Waiter(const HttpRequestPtr& request, const HttpResponseFuturePtr& future)
+            : request(request), future(future), since(boost::get_system_time()) {
+        }
+
+        HttpRequestPtr request;
+        HttpResponseFuturePtr future;
+        boost::system_time since;
+    };
+
+public:
+    HostPool(const std::string& host, int port)
+        : host(host), port(port), connections(0), generation(0),
+          hits(0), misses(0), waits(0), waitTime(0) {
+    }
+
+    bool removeIdle(Connection* connection) {
+        std::vector<Connection*>::iterator itr =
+            std::find(idle.begin(), idle.end(), connection);
+
+        if (itr == idle.end()) {
+            return false;
+        }
+
+        idle.erase(itr);
+        return true;
+    }
+
+    void popWaiter(Waiter& waiter) {
+        waiter = waiters.front();
+        waiters.pop_front();
+        waitTime += (boost::get_system_time() - waiter.since).total_milliseconds();
+    }
+
+public:
+    std::string host;
+    int port;
+
+    boost::mutex mutex;
+
+    // the open and the opening connections.
+    int connections;
+
+    // increased every time a connection becomes idle, so a stale idle
+    // timeout will not close the connection which has been reused.
+    int generation;
+
+    // the most recently used connection is at the back.
+    std::vector<Connection*> idle;
+    std::deque<Waiter> waiters;
+
+    boost::int64_t hits;
+    boost::int64_t misses;
+    boost::int64_t waits;
+    boost::int64_t waitTime;
+};
+
+/**
+ * The last handler of a pooled connection, which completes the future of
+ * the request in flight.
+ */
+class HttpConnectionPool::Connection : public SimpleChannelUpstreamHandler {
+public:
+    Connection(HttpConnectionPool& pool)
+        : generation(0), pool(pool), host(NULL), channel(NULL),
+          keepAlive(false), closed(false) {
+    }
+
+    virtual ~Connection() {}
+
+    virtual ChannelHandlerPtr clone() {
+        return ChannelHandlerPtr(new Connection(pool));
+    }
+
+    virtual std::string toString() const {
+        return "HttpConnectionPool::Connection";
+    }
+
+    void attach(HostPool* host, Channel* channel) {
+        this->host = host;
+        this->channel = channel;
+    }
+
+    HostPool* getHostPool() const { return host; }
+    Channel& getChannel() const { return *channel; }
+
+    /**
+     * Returns <tt>false</tt> if the connection has been closed.
+     */
+    bool send(const HttpRequestPtr& request, const HttpResponseFuturePtr& future) {
+        {
+            boost::lock_guard<boost::mutex> guard(mutex);
+
+            if (closed) {
+                return false;
+            }
+
+            this->future = future;
+            keepAlive = HttpHeaders::isKeepAlive(*request);
+        }
+
+        channel->write(ChannelMessage(request), false);
+        return true;
+    }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        HttpMessagePtr message = e.getMessage().smartPointer<HttpMessage>();
+        HttpResponsePtr response = boost::dynamic_pointer_cast<HttpResponse>(message);
+
+        if (!response) {
+            ctx.sendUpstream(e);
+            return;
+        }
+
+        HttpResponseFuturePtr future;
+        bool reusable;
+
+        {
+            boost::lock_guard<boost::mutex> guard(mutex);
+            future.swap(this->future);
+            reusable = keepAlive && HttpHeaders::isKeepAlive(*response);
+        }
+
+        if (!future) {
+            // the server should not respond without a request.
+            e.getChannel().close();
+            return;
+        }
+
+        // released before completing the future, so the next request sent
+        // from the listener can reuse this connection.
+        if (reusable) {
+            pool.release(*this);
+        }
+        else {
+            e.getChannel().close();
+        }
+
+        future->setResponse(response);
+    }
+
+    virtual void exceptionCaught(ChannelHandlerContext& ctx, const ExceptionEvent& e) {
+        HttpResponseFuturePtr future;
+
+        {
+            boost::lock_guard<boost::mutex> guard(mutex);
+            future.swap(this->future);
+        }
+
+        if (future) {
+            future->setFailure(e.getCause());
+        }
+
+        e.getChannel().close();
+    }
+
+    virtual void channelClosed(ChannelHandlerContext& ctx, const ChannelStateEvent& e) {
+        HttpResponseFuturePtr future;
+
+        {
+            boost::lock_guard<boost::mutex> guard(mutex);
+            closed = true;
+            future.swap(this->future);
+        }
+
+        pool.remove(*this);
+
+        if (future) {
+            future->setFailure(
+                ChannelException("Connection has been closed before the response."));
+        }
+
+        ctx.sendUpstream(e);
+    }
+
+public:
+    // guarded by the mutex of the host pool.
+    int generation;
+    TimeoutPtr timeout;
+
+private:
+    HttpConnectionPool& pool;
+    HostPool* host;
+    Channel* channel;
+
+    boost::mutex mutex;
+    HttpResponseFuturePtr future;
+    bool keepAlive;
+    bool closed;
+};
+
+class HttpConnectionPool::ConnectionPipelineFactory : public ChannelPipelineFactory {
+public:
+    ConnectionPipelineFactory(HttpConnectionPool& pool) : pool(pool) {}
+    virtual ~ConnectionPipelineFactory() {}
+
+    virtual ChannelPipeline* getPipeline() {
+        ChannelPipeline* pipeline = Channels::pipeline();
+
+        pipeline->addLast("codec", ChannelHandlerPtr(new HttpClientCodec));
+        pipeline->addLast("aggregator", ChannelHandlerPtr(
+                              new HttpChunkAggregator(pool.maxContentLength)));
+        pipeline->addLast("connection", ChannelHandlerPtr(new Connection(pool)));
+
+        return pipeline;
+    }
+
+private:
+    HttpConnectionPool& pool;
+};
+
+HttpConnectionPool::HttpConnectionPool(const ChannelFactoryPtr& factory)
+    : maxConnectionsPerHost(DEFAULT_MAX_CONNECTIONS_PER_HOST),
+      idleTimeout(DEFAULT_IDLE_TIMEOUT),
+      maxContentLength(DEFAULT_MAX_CONTENT_LENGTH),
+      closed(false),
+      liveness(new Liveness),
+      bootstrap(factory) {
+    bootstrap.setPipelineFactory(
+        ChannelPipelineFactoryPtr(new ConnectionPipelineFactory(*this)));
+}
+
+HttpConnectionPool::HttpConnectionPool(const ChannelFactoryPtr& factory,
+                                       int maxConnectionsPerHost,
+                                       int idleTimeout,
+                                       int maxContentLength)
+    : maxConnectionsPerHost(maxConnectionsPerHost),
+      idleTimeout(idleTimeout),
+      maxContentLength(maxContentLength),
+      closed(false),
+      liveness(new Liveness),
+      bootstrap(factory) {
+    if (maxConnectionsPerHost <= 0) {
+        throw InvalidArgumentException(
+            std::string("maxConnectionsPerHost must be a positive integer: ") +
+            Integer::toString(maxConnectionsPerHost));
+    }
+
+    if (idleTimeout <= 0) {
+        throw InvalidArgumentException(
+            std::string("idleTimeout must be a positive integer: ") +
+            Integer::toString(idleTimeout));
+    }
+
+    if (maxContentLength <= 0) {
+        throw InvalidArgumentException(
+            std::string("maxContentLength must be a positive integer: ") +
+            Integer::toString(maxContentLength));
+    }
+
+    bootstrap.setPipelineFactory(
+        ChannelPipelineFactoryPtr(new ConnectionPipelineFactory(*this)));
+}
+
+HttpConnectionPool::~HttpConnectionPool() {
+    close();
+
+    {
+        boost::lock_guard<boost::mutex> guard(liveness->mutex);
+        liveness->alive = false;
+    }
+
+    HostPools::iterator itr = hostPools.begin();
+
+    for (; itr != hostPools.end(); ++itr) {
+        delete itr->second;
+    }
+}
+
+HttpResponseFuturePtr HttpConnectionPool::request(const std::string& host,
+        int port,
+        const HttpRequestPtr& request) {
+    HostPool& pool = getHostPool(host, port);
+    HttpResponseFuturePtr future(new HttpResponseFuture);
+
+    for (;;) {
+        Connection* connection = NULL;
+        TimeoutPtr timeout;
+
+        {
+            boost::lock_guard<boost::mutex> guard(pool.mutex);
+
+            if (!pool.idle.empty()) {
+                connection = pool.idle.back();
+                pool.idle.pop_back();
+                timeout.swap(connection->timeout);
+            }
+            else if (pool.connections < maxConnectionsPerHost) {
+                ++pool.connections;
+                ++pool.misses;
+            }
+            else {
+                pool.waiters.push_back(HostPool::Waiter(request, future));
+                ++pool.waits;
+                return future;
+            }
+        }
+
+        if (!connection) {
+            connect(pool, request, future);
+            return future;
+        }
+
+        cancelTimeout(timeout);
+
+        if (connection->send(request, future)) {
+            boost::lock_guard<boost::mutex> guard(pool.mutex);
+            ++pool.hits;
+            return future;
+        }
+
+        // the connection has been closed while idle, and will be removed
+        // by itself, so tries the next one.
+    }
+}
+
+int HttpConnectionPool::getConnectionCount(const std::string& host, int port) const {
+    boost::lock_guard<boost::mutex> guard(mutex);
+    const HostPool* pool = findHostPool(host, port);
+
+    if (pool) {
+        boost::lock_guard<boost::mutex> hostGuard(const_cast<HostPool*>(pool)->mutex);
+        return pool->connections;
+    }
+
+    return 0;
+}
+
+int HttpConnectionPool::getIdleConnectionCount(const std::string& host, int port) const {
+    boost::lock_guard<boost::mutex> guard(mutex);
+    const HostPool* pool = findHostPool(host, port);
+
+    if (pool) {
+        boost::lock_guard<boost::mutex> hostGuard(const_cast<HostPool*>(pool)->mutex);
+        return static_cast<int>(pool->idle.size());
+    }
+
+    return 0;
+}
+
+#define CETTY_HTTPCONNECTIONPOOL_SUM(member) \
+    boost::int64_t sum = 0; \
+    boost::lock_guard<boost::mutex> guard(mutex); \
+    for (HostPools::const_iterator itr = hostPools.begin(); \
+         itr != hostPools.end(); ++itr) { \
+        boost::lock_guard<boost::mutex> hostGuard(itr->second->mutex); \
+        sum += itr->second->member; \
+    } \
+    return sum;
+
+boost::int64_t HttpConnectionPool::getHitCount() const {
+    CETTY_HTTPCONNECTIONPOOL_SUM(hits)
+}
+
+boost::int64_t HttpConnectionPool::getMissCount() const {
+    CETTY_HTTPCONNECTIONPOOL_SUM(misses)
+}
+
+boost::int64_t HttpConnectionPool::getWaitCount() const {
+    CETTY_HTTPCONNECTIONPOOL_SUM(waits)
+}
+
+boost::int64_t HttpConnectionPool::getWaitTime() const {
+    CETTY_HTTPCONNECTIONPOOL_SUM(waitTime)
+}
+
+#undef CETTY_HTTPCONNECTIONPOOL_SUM
+
+void HttpConnectionPool::close() {
+    std::vector<Connection*> idle;
+    std::vector<TimeoutPtr> timeouts;
+    std::vector<HostPool::Waiter> waiters;
+
+    {
+        boost::lock_guard<boost::mutex> guard(mutex);
+
+        if (closed.exchange(true)) {
+            return;
+        }
+
+        HostPools::iterator itr = hostPools.begin();
+
+        for (; itr != hostPools.end(); ++itr) {
+            HostPool& pool = *itr->second;
+            boost::lock_guard<boost::mutex> hostGuard(pool.mutex);
+
+            for (size_t i = 0; i < pool.idle.size(); ++i) {
+                idle.push_back(pool.idle[i]);
+                timeouts.push_back(TimeoutPtr());
+                timeouts.back().swap(pool.idle[i]->timeout);
+            }
+
+            waiters.insert(waiters.end(), pool.waiters.begin(), pool.waiters.end());
+
+            pool.idle.clear();
+            pool.waiters.clear();
+        }
+    }
+
+    for (size_t i = 0; i < waiters.size(); ++i) {
+        waiters[i].future->setFailure(
+            ChannelException("Connection pool has been closed."));
+    }
+
+    for (size_t i = 0; i < idle.size(); ++i) {
+        cancelTimeout(timeouts[i]);
+        idle[i]->getChannel().close();
+    }
+}
+
+void HttpConnectionPool::releaseExternalResources() {
+    close();
+    bootstrap.releaseExternalResources();
+}
+
+HttpConnectionPool::HostPool& HttpConnectionPool::getHostPool(const std::string& host, int port) {
+    std::string key = host + ":" + Integer::toString(port);
+    boost::lock_guard<boost::mutex> guard(mutex);
+
+    if (closed) {
+        throw IllegalStateException("Connection pool has been closed.");
+    }
+
+    HostPools::iterator itr = hostPools.find(key);
+
+    if (itr != hostPools.end()) {
+        return *itr->second;
+    }
+
+    HostPool* pool = new HostPool(host, port);
+    hostPools.insert(std::make_pair(key, pool));
+    return *pool;
+}
+
+const HttpConnectionPool::HostPool* HttpConnectionPool::findHostPool(
+    const std::string& host, int port) const {
+    HostPools::const_iterator itr =
+        hostPools.find(host + ":" + Integer::toString(port));
+
+    return itr != hostPools.end() ? itr->second : NULL;
+}
+
+void HttpConnectionPool::connect(HostPool& pool,
+                                 const HttpRequestPtr& request,
+                                 const HttpResponseFuturePtr& future) {
+    ChannelFuturePtr connectFuture;
+
+    // the channel factory does not create channels concurrently.
+    {
+        boost::lock_guard<boost::mutex> guard(mutex);
+        connectFuture = bootstrap.connect(SocketAddress(pool.host, pool.port));
+    }
+
+    connectFuture->setListener(boost::bind(&HttpConnectionPool::connected,
+                                           this,
+                                           &pool,
+                                           request,
+                                           future,
+                                           _1));
+}
+
+void HttpConnectionPool::connected(HostPool* pool,
+                                   const HttpRequestPtr& request,
+                                   const HttpResponseFuturePtr& future,
+                                   const ChannelFuturePtr& connectFuture) {
+    if (connectFuture->isSuccess()) {
+        Channel& channel = connectFuture->getChannel();
+        Connection* connection =
+            dynamic_cast<Connection*>(channel.getPipeline().get("connection").get());
+
+        connection->attach(pool, &channel);
+
+        if (connection->send(request, future)) {
+            return;
+        }
+    }
+
+    const Exception* cause = connectFuture->getCause();
+
+    if (cause) {
+        future->setFailure(*cause);
+    }
+    else {
+        future->setFailure(ChannelException("Connection has been closed before the request."));
+    }
+
+    HostPool::Waiter waiter;
+    bool hasWaiter = false;
+
+    {
+        boost::lock_guard<boost::mutex> guard(pool->mutex);
+        --pool->connections;
+
+        if (!closed && !pool->waiters.empty()) {
+            pool->popWaiter(waiter);
+            ++pool->connections;
+            hasWaiter = true;
+        }
+    }
+
+    if (hasWaiter) {
+        connect(*pool, waiter.request, waiter.future);
+    }
+}
+
+void HttpConnectionPool::release(Connection& connection) {
+    HostPool& pool = *connection.getHostPool();
+    HostPool::Waiter waiter;
+    bool hasWaiter = false;
+    int generation = 0;
+
+    {
+        boost::lock_guard<boost::mutex> guard(pool.mutex);
+
+        if (closed) {
+            // closes below.
+        }
+        else if (!pool.waiters.empty()) {
+            pool.popWaiter(waiter);
+            hasWaiter = true;
+        }
+        else {
+            generation = ++pool.generation;
+            connection.generation = generation;
+            pool.idle.push_back(&connection);
+        }
+    }
+
+    if (hasWaiter) {
+        if (!connection.send(waiter.request, waiter.future)) {
+            waiter.future->setFailure(
+                ChannelException("Connection has been closed before the request."));
+        }
+    }
+    else if (generation) {
+        TimeoutPtr timeout =
+            TimerFactory::getFactory().getTimer(connection.getChannel())->newTimeout(
+                boost::bind(&HttpConnectionPool::evict,
+                            this,
+                            liveness,
+                            &pool,
+                            &connection,
+                            generation,
+                            _1),
+                idleTimeout);
+
+        {
+            boost::lock_guard<boost::mutex> guard(pool.mutex);
+
+            // keeps it for cancelling, unless the connection has been
+            // reused or removed in the meantime.
+            if (connection.generation == generation
+                    && std::find(pool.idle.begin(), pool.idle.end(), &connection)
+                       != pool.idle.end()) {
+                connection.timeout = timeout;
+                timeout.reset();
+            }
+        }
+
+        cancelTimeout(timeout);
+    }
+    else {
+        connection.getChannel().close();
+    }
+}
+
+void HttpConnectionPool::remove(Connection& connection) {
+    HostPool* pool = connection.getHostPool();
+
+    // has not been attached, the connecting will handle it.
+    if (!pool) {
+        return;
+    }
+
+    HostPool::Waiter waiter;
+    bool hasWaiter = false;
+    TimeoutPtr timeout;
+
+    {
+        boost::lock_guard<boost::mutex> guard(pool->mutex);
+        pool->removeIdle(&connection);
+        timeout.swap(connection.timeout);
+        --pool->connections;
+
+        if (!closed && !pool->waiters.empty()) {
+            pool->popWaiter(waiter);
+            ++pool->connections;
+            hasWaiter = true;
+        }
+    }
+
+    cancelTimeout(timeout);
+
+    if (hasWaiter) {
+        connect(*pool, waiter.request, waiter.future);
+    }
+}
+
+void HttpConnectionPool::evict(const LivenessPtr& liveness,
+                               HostPool* pool,
+                               Connection* connection,
+                               int generation,
+                               Timeout& timeout) {
+    // holds the pool alive until the connection has been closed, which
+    // removes it from the pool.
+    boost::lock_guard<boost::mutex> livenessGuard(liveness->mutex);
+
+    if (!liveness->alive) {
+        return;
+    }
+
+    {
+        boost::lock_guard<boost::mutex> guard(pool->mutex);
+
+        // only touches the connection when it is still idle, otherwise
+        // it may have been closed and destroyed.
+        std::vector<Connection*>::iterator itr =
+            std::find(pool->idle.begin(), pool->idle.end(), connection);
+
+        if (itr == pool->idle.end() || connection->generation != generation) {
+            return;
+        }
+
+        pool->idle.erase(itr);
+        connection->timeout.reset();
+    }
+
+    connection->getChannel().close();
+}
+
+}}}}
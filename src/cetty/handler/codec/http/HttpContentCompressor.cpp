@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/HttpContentCompressor.h"
+
+#include <cstdlib>
+#include <algorithm>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/trim.hpp>
+
+#include "cetty/util/Integer.h"
+#include "cetty/util/Exception.h"
+#include "cetty/handler/codec/http/HttpHeaders.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { 
+
+using namespace cetty::util;
+
+HttpContentCompressor::HttpContentCompressor()
+    : HttpContentEncoder(DEFAULT_CONTENT_SIZE_THRESHOLD),
+      compressionLevel(ZlibDeflater::DEFAULT_COMPRESSION_LEVEL) {
+}
+
+HttpContentCompressor::HttpContentCompressor(int compressionLevel)
+    : HttpContentEncoder(DEFAULT_CONTENT_SIZE_THRESHOLD),
+      compressionLevel(compressionLevel) {
+    if (compressionLevel < 0 || compressionLevel > 9) {
+        throw InvalidArgumentException(
+            std::string("compressionLevel: ") +
+            Integer::toString(compressionLevel) +
+            std::string(" (expected: 0-9)"));
+    }
+}
+
+HttpContentCompressor::HttpContentCompressor(int compressionLevel,
+        int contentSizeThreshold)
+    : HttpContentEncoder(contentSizeThreshold),
+      compressionLevel(compressionLevel) {
+    if (compressionLevel < 0 || compressionLevel > 9) {
+        throw InvalidArgumentException(
+            std::string("compressionLevel: ") +
+            Integer::toString(compressionLevel) +
+            std::string(" (expected: 0-9)"));
+    }
+}
+
+ChannelHandlerPtr HttpContentCompressor::clone() {
+    return ChannelHandlerPtr(
+               new HttpContentCompressor(compressionLevel,
+                                         getContentSizeThreshold()));
+}
+
+std::string HttpContentCompressor::toString() const {
+    return "HttpContentCompressor";
+}
+
+ZlibDeflater* HttpContentCompressor::newContentEncoder(
+    const std::string& acceptEncoding) {
+    const ZlibWrapper* wrapper = determineWrapper(acceptEncoding);
+
+    if (!wrapper) {
+        return NULL;
+    }
+
+    return new ZlibDeflater(*wrapper, compressionLevel);
+}
+
+std::string HttpContentCompressor::getTargetContentEncoding(
+    const std::string& acceptEncoding) {
+    const ZlibWrapper* wrapper = determineWrapper(acceptEncoding);
+
+    if (wrapper == &ZlibWrapper::GZIP) {
+        return HttpHeaders::Values::GZIP;
+    }
+
+    if (wrapper == &ZlibWrapper::ZLIB) {
+        return HttpHeaders::Values::DEFLATE;
+    }
+
+    return HttpHeaders::Values::IDENTITY;
+}
+
+const ZlibWrapper* HttpContentCompressor::determineWrapper(
+    const std::string& acceptEncoding) const {
+    // the weights of gzip, deflate and "*", -1 if not listed.
+    double gzip = -1;
+    double deflate = -1;
+    double star = -1;
+
+    std::string::size_type start = 0;
+
+    while (start < acceptEncoding.size()) {
+        std::string::size_type end = acceptEncoding.find(',', start);
+
+        if (end == std::string::npos) {
+            end = acceptEncoding.size();
+        }
+
+        std::string coding = acceptEncoding.substr(start, end - start);
+        start = end + 1;
+
+        double q = 1.0;
+        std::string::size_type semicolon = coding.find(';');
+
+        if (semicolon != std::string::npos) {
+            std::string::size_type weight = coding.find("q=", semicolon);
+
+            if (weight != std::string::npos) {
+                q = std::atof(coding.c_str() + weight + 2);
+            }
+
+            coding.erase(semicolon);
+        }
+
+        boost::algorithm::trim(coding);
+        boost::algorithm::to_lower(coding);
+
+        if (coding == "gzip" || coding == "x-gzip") {
+            gzip = std::max(gzip, q);
+        }
+        else if (coding == "deflate" || coding == "x-deflate") {
+            deflate = std::max(deflate, q);
+        }
+        else if (coding == "*") {
+            star = std::max(star, q);
+        }
+    }
+
+    if (gzip < 0 && deflate < 0 && star > 0) {
+        return &ZlibWrapper::GZIP;
+    }
+
+    if (gzip > 0 && gzip >= deflate) {
+        return &ZlibWrapper::GZIP;
+    }
+
+    if (deflate > 0) {
+        return &ZlibWrapper::ZLIB;
+    }
+
+    return NULL;
+}
+
+}}}}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/HttpContentDecoder.h"
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelHandlerContext.h"
+
+#include "cetty/handler/codec/http/HttpChunk.h"
+#include "cetty/handler/codec/http/HttpHeaders.h"
+#include "cetty/handler/codec/http/HttpResponse.h"
+#include "cetty/handler/codec/http/HttpResponseStatus.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { 
+
+using namespace cetty::buffer;
+
+void HttpContentDecoder::messageReceived(ChannelHandlerContext& ctx,
+        const MessageEvent& e) {
+    HttpMessagePtr message = e.getMessage().smartPointer<HttpMessage>();
+
+    if (message) {
+        HttpResponse* response = dynamic_cast<HttpResponse*>(message.get());
+
+        if (response && response->getStatus().getCode() == 100) {
+            // 100-continue response must be passed through.
+            ctx.sendUpstream(e);
+            return;
+        }
+
+        decoder.reset();
+        decodeMessage(*message);
+
+        // Because HttpMessage is a mutable object, we can simply forward the received event.
+        ctx.sendUpstream(e);
+        return;
+    }
+
+    HttpChunkPtr chunk = e.getMessage().smartPointer<HttpChunk>();
+
+    if (!chunk || !decoder) {
+        ctx.sendUpstream(e);
+        return;
+    }
+
+    if (!chunk->isLast()) {
+        ChannelBufferPtr content = decoder->inflate(chunk->getContent());
+
+        // an empty chunk would be taken as the last one.
+        if (content->readable()) {
+            chunk->setContent(content);
+            ctx.sendUpstream(e);
+        }
+
+        return;
+    }
+
+    decoder.reset();
+    ctx.sendUpstream(e);
+}
+
+std::string HttpContentDecoder::getTargetContentEncoding(
+    const std::string& contentEncoding) {
+    return HttpHeaders::Values::IDENTITY;
+}
+
+void HttpContentDecoder::decodeMessage(HttpMessage& message) {
+    std::string contentEncoding =
+        message.getHeader(HttpHeaders::Names::CONTENT_ENCODING);
+    boost::algorithm::trim(contentEncoding);
+
+    if (contentEncoding.empty()) {
+        contentEncoding = HttpHeaders::Values::IDENTITY;
+    }
+
+    bool chunked = message.isChunked();
+    const ChannelBufferPtr& content = message.getContent();
+
+    if (!chunked && !content->readable()) {
+        return;
+    }
+
+    ZlibInflater* inflater = newContentDecoder(contentEncoding);
+
+    if (!inflater) {
+        return;
+    }
+
+    // Decode the content and remove or replace the existing headers
+    // so that the message looks like a decoded message.
+    decoder.reset(inflater);
+
+    std::string targetContentEncoding = getTargetContentEncoding(contentEncoding);
+
+    if (targetContentEncoding == HttpHeaders::Values::IDENTITY) {
+        message.removeHeader(HttpHeaders::Names::CONTENT_ENCODING);
+    }
+    else {
+        message.setHeader(HttpHeaders::Names::CONTENT_ENCODING,
+                          targetContentEncoding);
+    }
+
+    if (chunked) {
+        return;
+    }
+
+    ChannelBufferPtr decoded = decoder->inflate(content);
+    decoder.reset();
+
+    // Replace the content.
+    message.setContent(decoded);
+
+    if (message.containsHeader(HttpHeaders::Names::CONTENT_LENGTH)) {
+        message.setHeader(HttpHeaders::Names::CONTENT_LENGTH,
+                          decoded->readableBytes());
+    }
+}
+
+}}}}
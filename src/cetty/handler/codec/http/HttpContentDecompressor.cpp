@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/HttpContentDecompressor.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+
+namespace cetty { namespace handler { namespace codec { namespace http { 
+
+using namespace boost::algorithm;
+
+ChannelHandlerPtr HttpContentDecompressor::clone() {
+    return ChannelHandlerPtr(new HttpContentDecompressor);
+}
+
+std::string HttpContentDecompressor::toString() const {
+    return "HttpContentDecompressor";
+}
+
+ZlibInflater* HttpContentDecompressor::newContentDecoder(
+    const std::string& contentEncoding) {
+    if (iequals(contentEncoding, "gzip") || iequals(contentEncoding, "x-gzip")) {
+        return new ZlibInflater(ZlibWrapper::GZIP);
+    }
+    else if (iequals(contentEncoding, "deflate")
+             || iequals(contentEncoding, "x-deflate")) {
+        // some servers send the raw deflate stream without the zlib header.
+        return new ZlibInflater(ZlibWrapper::ZLIB_OR_NONE);
+    }
+
+    // 'identity' or unsupported
+    return NULL;
+}
+
+}}}}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/HttpContentEncoder.h"
+
+#include <boost/thread/locks.hpp>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelHandlerContext.h"
+#include "cetty/util/Exception.h"
+
+#include "cetty/handler/codec/http/HttpChunk.h"
+#include "cetty/handler/codec/http/HttpHeaders.h"
+#include "cetty/handler/codec/http/HttpRequest.h"
+#include "cetty/handler/codec/http/HttpResponse.h"
+#include "cetty/handler/codec/http/HttpResponseStatus.h"
+#include "cetty/handler/codec/http/DefaultHttpChunk.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { 
+
+using namespace cetty::buffer;
+using namespace cetty::util;
+
+HttpContentEncoder::HttpContentEncoder(int contentSizeThreshold)
+    : contentSizeThreshold(contentSizeThreshold) {
+    if (contentSizeThreshold < 0) {
+        throw InvalidArgumentException("contentSizeThreshold must not be negative.");
+    }
+}
+
+void HttpContentEncoder::messageReceived(ChannelHandlerContext& ctx,
+        const MessageEvent& e) {
+    HttpMessagePtr message = e.getMessage().smartPointer<HttpMessage>();
+
+    if (message) {
+        std::string acceptEncoding =
+            message->getHeader(HttpHeaders::Names::ACCEPT_ENCODING);
+
+        if (acceptEncoding.empty()) {
+            acceptEncoding = HttpHeaders::Values::IDENTITY;
+        }
+
+        boost::lock_guard<boost::mutex> guard(mutex);
+        acceptEncodings.push_back(acceptEncoding);
+    }
+
+    ctx.sendUpstream(e);
+}
+
+void HttpContentEncoder::writeRequested(ChannelHandlerContext& ctx,
+                                        const MessageEvent& e) {
+    const ChannelMessage& msg = e.getMessage();
+    HttpMessagePtr message = msg.smartPointer<HttpMessage>();
+
+    if (!message) {
+        message = msg.smartPointer<HttpMessage, HttpResponse>();
+
+        if (!message) {
+            message = msg.smartPointer<HttpMessage, HttpRequest>();
+        }
+    }
+
+    if (message) {
+        HttpResponse* response = dynamic_cast<HttpResponse*>(message.get());
+
+        if (response && response->getStatus().getCode() == 100) {
+            // 100-continue response must be passed through.
+            ctx.sendDownstream(e);
+            return;
+        }
+
+        std::string acceptEncoding;
+        {
+            boost::lock_guard<boost::mutex> guard(mutex);
+
+            if (acceptEncodings.empty()) {
+                throw IllegalStateException("cannot send more responses than requests");
+            }
+
+            acceptEncoding = acceptEncodings.front();
+            acceptEncodings.pop_front();
+        }
+
+        encoder.reset();
+        encodeMessage(*message, acceptEncoding);
+
+        // Because HttpMessage is a mutable object, we can simply forward the write request.
+        ctx.sendDownstream(e);
+        return;
+    }
+
+    HttpChunkPtr chunk = msg.smartPointer<HttpChunk>();
+
+    if (!chunk || !encoder) {
+        ctx.sendDownstream(e);
+        return;
+    }
+
+    if (!chunk->isLast()) {
+        // flushes every chunk, so the peer can decode it on arrival.
+        chunk->setContent(encoder->deflate(chunk->getContent(), true));
+        ctx.sendDownstream(e);
+        return;
+    }
+
+    ChannelBufferPtr footer = encoder->finish();
+    encoder.reset();
+
+    // Generate an additional chunk if the encoder produced
+    // the last product on closure.
+    if (footer->readable()) {
+        Channels::write(ctx,
+                        Channels::future(e.getChannel()),
+                        ChannelMessage(HttpChunkPtr(new DefaultHttpChunk(footer))),
+                        e.getRemoteAddress());
+    }
+
+    // Emit the last chunk.
+    ctx.sendDownstream(e);
+}
+
+void HttpContentEncoder::encodeMessage(HttpMessage& message,
+                                       const std::string& acceptEncoding) {
+    const std::string& contentEncoding =
+        message.getHeader(HttpHeaders::Names::CONTENT_ENCODING);
+
+    if (!contentEncoding.empty()
+            && contentEncoding != HttpHeaders::Values::IDENTITY) {
+        // already encoded by the application.
+        return;
+    }
+
+    bool chunked = message.isChunked();
+    const ChannelBufferPtr& content = message.getContent();
+
+    if (!chunked && (!content->readable()
+                     || content->readableBytes() < contentSizeThreshold)) {
+        return;
+    }
+
+    ZlibDeflater* deflater = newContentEncoder(acceptEncoding);
+
+    if (!deflater) {
+        return;
+    }
+
+    // Encode the content and remove or replace the existing headers
+    // so that the message looks like a decoded message.
+    encoder.reset(deflater);
+    message.setHeader(HttpHeaders::Names::CONTENT_ENCODING,
+                      getTargetContentEncoding(acceptEncoding));
+
+    if (chunked) {
+        message.removeHeader(HttpHeaders::Names::CONTENT_LENGTH);
+        return;
+    }
+
+    ChannelBufferPtr body = encoder->deflate(content, false);
+    ChannelBufferPtr encoded = ChannelBuffers::wrappedBuffer(body, encoder->finish());
+    encoder.reset();
+
+    // Replace the content.
+    message.setContent(encoded);
+
+    if (message.containsHeader(HttpHeaders::Names::CONTENT_LENGTH)) {
+        message.setHeader(HttpHeaders::Names::CONTENT_LENGTH,
+                          encoded->readableBytes());
+    }
+}
+
+}}}}
@@ -200,6 +200,18 @@ const std::string HttpHeaders::Names::REFERER = "Referer";
  * <tt>"Retry-After"</tt>
  */
 const std::string HttpHeaders::Names::RETRY_AFTER = "Retry-After";
+/**
+ * <tt>"Sec-WebSocket-Accept"</tt>
+ */
+const std::string HttpHeaders::Names::SEC_WEBSOCKET_ACCEPT = "Sec-WebSocket-Accept";
+/**
+ * <tt>"Sec-WebSocket-Extensions"</tt>
+ */
+const std::string HttpHeaders::Names::SEC_WEBSOCKET_EXTENSIONS = "Sec-WebSocket-Extensions";
+/**
+ * <tt>"Sec-WebSocket-Key"</tt>
+ */
+const std::string HttpHeaders::Names::SEC_WEBSOCKET_KEY = "Sec-WebSocket-Key";
 /**
  * <tt>"Sec-WebSocket-Key1"</tt>
  */
@@ -220,6 +232,10 @@ const std::string HttpHeaders::Names::SEC_WEBSOCKET_ORIGIN = "Sec-WebSocket-Orig
  * <tt>"Sec-WebSocket-Protocol"</tt>
  */
 const std::string HttpHeaders::Names::SEC_WEBSOCKET_PROTOCOL = "Sec-WebSocket-Protocol";
+/**
+ * <tt>"Sec-WebSocket-Version"</tt>
+ */
+const std::string HttpHeaders::Names::SEC_WEBSOCKET_VERSION = "Sec-WebSocket-Version";
 /**
  * <tt>"Server"</tt>
  */
@@ -511,7 +527,7 @@ int HttpHeaders::getContentLength(const HttpMessage& message) {
 }
 
 int HttpHeaders::getContentLength(const HttpMessage& message, int defaultValue) {
-    std::string contentLength = message.getHeader(Names::CONTENT_LENGTH);
+    const std::string& contentLength = message.getHeader(Names::CONTENT_LENGTH);
     if (!contentLength.empty()) {
         return Integer::parse(contentLength);
     }
@@ -569,7 +585,7 @@ bool HttpHeaders::is100ContinueExpected(const HttpMessage& message) {
     }
 
     // In most cases, there will be one or zero 'Expect' header.
-    std::string value = request->getHeader(Names::EXPECT);
+    const std::string& value = request->getHeader(Names::EXPECT);
     if (value.empty()) {
         return false;
     }
@@ -15,6 +15,8 @@
  */
 #include "cetty/handler/codec/http/HttpMessageDecoder.h"
 
+#include <cctype>
+
 #include "cetty/buffer/ChannelBuffers.h"
 #include "cetty/util/Integer.h"
 #include "cetty/util/Character.h"
@@ -48,44 +50,55 @@ HttpMessageDecoder::FastString::substring(int start, int end) const {
 }
 
 HttpMessageDecoder::FastString HttpMessageDecoder::FastString::trim() const {
-    char* newData = data;
-    int   newSize = size;
-    while((*newData == ' ' || *newData == '\t') && newSize > 0) {
-        newData++;
-        --newData;
-    }
+    int start = 0;
+    int end = size;
 
-    while((newData[newSize - 1] == ' ' || newData[newSize - 1] == '\t')
-        && newSize > 0) {
-            --newSize;
+    while (start < end && (data[start] == ' ' || data[start] == '\t')) {
+        ++start;
+    }
+    while (end > start && (data[end - 1] == ' ' || data[end - 1] == '\t')) {
+        --end;
     }
 
-    newData[newSize] = '\0';
-    return FastString(newData, newSize);
+    return FastString(data + start, end - start);
 }
 
 bool HttpMessageDecoder::FastString::equalsIgnoreCase(const std::string& str) const {
+    if (static_cast<int>(str.size()) != size) {
+        return false;
+    }
+
+    for (int i = 0; i < size; ++i) {
+        if (std::tolower(static_cast<unsigned char>(data[i])) !=
+            std::tolower(static_cast<unsigned char>(str[i]))) {
+            return false;
+        }
+    }
     return true;
 }
 
 HttpMessageDecoder::HttpMessageDecoder()
-    : ReplayingDecoder(SKIP_CONTROL_CHARS, true),
+    : FrameDecoder(true),
       maxInitialLineLength(4096),
       maxHeaderSize(8192),
       maxChunkSize(8192),
+      state(SKIP_CONTROL_CHARS),
       chunkSize(0),
-      headerSize(0) {
+      headerSize(0),
+      lineScanned(0) {
 }
 
 HttpMessageDecoder::HttpMessageDecoder(int maxInitialLineLength,
                                        int maxHeaderSize,
                                        int maxChunkSize)
-    : ReplayingDecoder(SKIP_CONTROL_CHARS, true),
+    : FrameDecoder(true),
       maxInitialLineLength(maxInitialLineLength),
       maxHeaderSize(maxHeaderSize),
       maxChunkSize(maxChunkSize),
+      state(SKIP_CONTROL_CHARS),
       chunkSize(0),
-      headerSize(0) {
+      headerSize(0),
+      lineScanned(0) {
     if (maxInitialLineLength <= 0) {
         throw InvalidArgumentException(
             std::string("maxInitialLineLength must be a positive integer: ") +
@@ -105,48 +118,32 @@ HttpMessageDecoder::HttpMessageDecoder(int maxInitialLineLength,
 
 ChannelMessage HttpMessageDecoder::decode(ChannelHandlerContext& ctx,
                                           Channel& channel,
-                                          const ReplayingDecoderBufferPtr& buffer,
-                                          int state) {
-    switch (state) {
+                                          const ChannelBufferPtr& buffer) {
+    // runs the states until a message is decoded or more bytes are needed,
+    // so a decoded message always consumes some bytes.
+    for (;;) {
+        switch (state) {
         case SKIP_CONTROL_CHARS: {
-            if (skipControlCharacters(buffer)) {
-                checkpoint(READ_INITIAL);
-            }
-            else {
-                checkpoint(); //do not care skipped control chars.
+            if (!skipControlCharacters(buffer)) {
+                return ChannelMessage::EMPTY_MESSAGE;
             }
+            state = READ_INITIAL;
             break;
         }
         case READ_INITIAL: {
-            std::vector<FastString> initialLine;
-            FastString line = readLine(buffer, maxInitialLineLength);
-            if (!splitInitialLine(line, initialLine)) {
-                    // need more bytes.
-                    break;
-            }
-
-            if (initialLine.size() < 3) {
-                // Invalid initial line - ignore.
-                checkpoint(SKIP_CONTROL_CHARS);
-                break;
+            if (!readInitialLine(buffer)) {
+                return ChannelMessage::EMPTY_MESSAGE;
             }
-
-            message = createMessage(initialLine[0], initialLine[1], initialLine[2]);
-            checkpoint(READ_HEADER);
-
-            // clear data, then step into the READ_HEADER state.
-            headerSize = 0;
-            message->clearHeaders();
             break;
         }
         case READ_HEADER: {
             int nextState = readHeaders(buffer);
             if (nextState == READ_HEADER) {
                 // need read more bytes to parse headers.
-                break;
+                return ChannelMessage::EMPTY_MESSAGE;
             }
 
-            checkpoint(nextState);
+            state = nextState;
             if (nextState == READ_CHUNK_SIZE) {
                 // Chunked encoding
                 message->setChunked(true);
@@ -159,103 +156,86 @@ ChannelMessage HttpMessageDecoder::decode(ChannelHandlerContext& ctx,
                 // Remove the headers which are not supposed to be present not
                 // to confuse subsequent handlers.
                 message->header().remove(HttpHeaders::Names::TRANSFER_ENCODING);
-                return ChannelMessage(message);
+                return reset();
             }
-            else {
-                int contentLength = HttpHeaders::getContentLength(*message, -1);
-                if (contentLength == 0 || (contentLength == -1 && isDecodingRequest())) {
-                    content = ChannelBuffers::EMPTY_BUFFER;
-                    return reset();
-                }
 
-                switch (nextState) {
-                case READ_FIXED_LENGTH_CONTENT:
-                    if (contentLength > maxChunkSize
-                        || HttpHeaders::is100ContinueExpected(*message)) {
-                            // Generate HttpMessage first.  HttpChunks will follow.
-                            checkpoint(READ_FIXED_LENGTH_CONTENT_AS_CHUNKS);
-                            message->setChunked(true);
-                            // chunkSize will be decreased as the READ_FIXED_LENGTH_CONTENT_AS_CHUNKS
-                            // state reads data chunk by chunk.
-                            chunkSize = HttpHeaders::getContentLength(*message, -1);
-                            return ChannelMessage(message);
-                    }
-                    break;
-                case READ_VARIABLE_LENGTH_CONTENT:
-                    if (buffer->readableBytes() > maxChunkSize
-                        || HttpHeaders::is100ContinueExpected(*message)) {
-                            // Generate HttpMessage first.  HttpChunks will follow.
-                            checkpoint(READ_VARIABLE_LENGTH_CONTENT_AS_CHUNKS);
-                            message->setChunked(true);
-                            return ChannelMessage(message);
-                    }
-                    break;
-                default:
-                    throw IllegalStateException(
-                        std::string("Unexpected state: ") +
-                        Integer::toString(nextState));
-                }
+            int contentLength = HttpHeaders::getContentLength(*message, -1);
+            if (contentLength == 0 || (contentLength == -1 && isDecodingRequest())) {
+                content = ChannelBuffers::EMPTY_BUFFER;
+                return reset();
             }
 
-            // We return null here, this forces decode to be called again where we will decode the content
-            return ChannelMessage::EMPTY_MESSAGE;
+            switch (nextState) {
+            case READ_FIXED_LENGTH_CONTENT:
+                // chunkSize will be decreased as the READ_FIXED_LENGTH_CONTENT_AS_CHUNKS
+                // state reads data chunk by chunk.
+                chunkSize = contentLength;
+
+                if (contentLength > maxChunkSize
+                    || HttpHeaders::is100ContinueExpected(*message)) {
+                    // Generate HttpMessage first.  HttpChunks will follow.
+                    state = READ_FIXED_LENGTH_CONTENT_AS_CHUNKS;
+                    message->setChunked(true);
+                    return ChannelMessage(message);
+                }
+                break;
+            case READ_VARIABLE_LENGTH_CONTENT:
+                if (buffer->readableBytes() > maxChunkSize
+                    || HttpHeaders::is100ContinueExpected(*message)) {
+                    // Generate HttpMessage first.  HttpChunks will follow.
+                    state = READ_VARIABLE_LENGTH_CONTENT_AS_CHUNKS;
+                    message->setChunked(true);
+                    return ChannelMessage(message);
+                }
+                break;
+            default:
+                throw IllegalStateException(
+                    std::string("Unexpected state: ") +
+                    Integer::toString(nextState));
+            }
+            break;
         }
         case READ_VARIABLE_LENGTH_CONTENT: {
-            content = buffer->readSlice(buffer->readableBytes());
-            if (buffer->needMoreBytes()) {
+            // the content ends with the connection, see decodeLast.
+            if (buffer->readableBytes() <= maxChunkSize) {
                 return ChannelMessage::EMPTY_MESSAGE;
             }
-            return reset();
+
+            // too large to keep, so sends the message and the content as chunks.
+            state = READ_VARIABLE_LENGTH_CONTENT_AS_CHUNKS;
+            message->setChunked(true);
+
+            HttpChunkPtr chunk(new DefaultHttpChunk(readContent(buffer, maxChunkSize)));
+            return ChannelMessage(ChannelMessage(message), ChannelMessage(chunk));
         }
         case READ_VARIABLE_LENGTH_CONTENT_AS_CHUNKS: {
             // Keep reading data as a chunk until the end of connection is reached.
-            int chunkSize = std::min(maxChunkSize, buffer->readableBytes());
-            ChannelBufferPtr buff = buffer->readSlice(chunkSize);
-            if (buffer->needMoreBytes()) {
+            int readable = buffer->readableBytes();
+            if (readable == 0) {
                 return ChannelMessage::EMPTY_MESSAGE;
             }
 
-            HttpChunkPtr chunk = HttpChunkPtr(new DefaultHttpChunk(buff));
-            if (!buffer->readable()) {
-                // Reached to the end of the connection.
-                reset();
-                if (!chunk->isLast()) {
-                    // Append the last chunk.
-                    return ChannelMessage(ChannelMessage(chunk),
-                                          ChannelMessage(HttpChunk::LAST_CHUNK));
-                }
-            }
-            return ChannelMessage(chunk);
+            int length = maxChunkSize > 0 ? std::min(maxChunkSize, readable) : readable;
+            return ChannelMessage(
+                       HttpChunkPtr(new DefaultHttpChunk(readContent(buffer, length))));
         }
         case READ_FIXED_LENGTH_CONTENT: {
             //we have a content-length so we just read the correct number of bytes
-            if (readFixedLengthContent(buffer)) {
-                return reset();
+            if (buffer->readableBytes() < chunkSize) {
+                return ChannelMessage::EMPTY_MESSAGE;
             }
 
-            return ChannelMessage::EMPTY_MESSAGE;
+            content = readContent(buffer, chunkSize);
+            return reset();
         }
         case READ_FIXED_LENGTH_CONTENT_AS_CHUNKS: {
-            int chunkSize = this->chunkSize;
-            HttpChunkPtr chunk;
-            ChannelBufferPtr buff;
-            if (chunkSize > maxChunkSize) {
-                buff = buffer->readSlice(maxChunkSize);
-                if (buffer->needMoreBytes()) {
-                    return ChannelMessage::EMPTY_MESSAGE;
-                }
-                chunkSize -= maxChunkSize;
-            }
-            else {
-                BOOST_ASSERT(chunkSize <= Integer::MAX_VALUE);
-                buff = buffer->readSlice(chunkSize);
-                if (buffer->needMoreBytes()) {
-                    return ChannelMessage::EMPTY_MESSAGE;
-                }
-                chunkSize = 0;
+            int length = maxChunkSize > 0 ? std::min(chunkSize, maxChunkSize) : chunkSize;
+            if (buffer->readableBytes() < length) {
+                return ChannelMessage::EMPTY_MESSAGE;
             }
-            chunk = HttpChunkPtr(new DefaultHttpChunk(buff));
-            this->chunkSize = chunkSize;
+
+            HttpChunkPtr chunk(new DefaultHttpChunk(readContent(buffer, length)));
+            chunkSize -= length;
 
             if (chunkSize == 0) {
                 // Read all content.
@@ -273,94 +253,69 @@ ChannelMessage HttpMessageDecoder::decode(ChannelHandlerContext& ctx,
         * read chunk, read and ignore the CRLF and repeat until 0
         */
         case READ_CHUNK_SIZE: {
-            FastString line = readLine(buffer, maxInitialLineLength);
-            if (buffer->needMoreBytes()) {
+            FastString line;
+            if (!readLine(buffer, maxInitialLineLength, line)) {
                 return ChannelMessage::EMPTY_MESSAGE;
             }
 
             chunkSize = getChunkSize(line);
             if (chunkSize == 0) {
-                checkpoint(READ_CHUNK_FOOTER);
-                return ChannelMessage::EMPTY_MESSAGE;
+                headerSize = 0;
+                state = READ_CHUNK_FOOTER;
             }
-            else if (chunkSize > maxChunkSize) {
+            else if (maxChunkSize > 0 && chunkSize > maxChunkSize) {
                 // A chunk is too large. Split them into multiple chunks again.
-                checkpoint(READ_CHUNKED_CONTENT_AS_CHUNKS);
+                state = READ_CHUNKED_CONTENT_AS_CHUNKS;
             }
             else {
-                checkpoint(READ_CHUNKED_CONTENT);
+                state = READ_CHUNKED_CONTENT;
             }
             break;
         }
         case READ_CHUNKED_CONTENT: {
-            BOOST_ASSERT(chunkSize <= Integer::MAX_VALUE);
-            ChannelBufferPtr buff = buffer->readSlice(chunkSize);
-            if (buffer->needMoreBytes()) {
+            if (buffer->readableBytes() < chunkSize) {
                 return ChannelMessage::EMPTY_MESSAGE;
             }
 
-            HttpChunkPtr chunk = HttpChunkPtr(new DefaultHttpChunk(buff));
-            checkpoint(READ_CHUNK_DELIMITER);
+            HttpChunkPtr chunk(new DefaultHttpChunk(readContent(buffer, chunkSize)));
+            state = READ_CHUNK_DELIMITER;
             return ChannelMessage(chunk);
         }
         case READ_CHUNKED_CONTENT_AS_CHUNKS: {
-            long chunkSize = this->chunkSize;
-            HttpChunkPtr chunk;
-            ChannelBufferPtr buff;
-            if (chunkSize > maxChunkSize) {
-                buff = buffer->readSlice(maxChunkSize);
-                if (buffer->needMoreBytes()) {
-                    return ChannelMessage::EMPTY_MESSAGE;
-                }
-                chunkSize -= maxChunkSize;
-            }
-            else {
-                BOOST_ASSERT(chunkSize <= Integer::MAX_VALUE);
-                buff = buffer->readSlice(chunkSize);
-                if (buffer->needMoreBytes()) {
-                    return ChannelMessage::EMPTY_MESSAGE;
-                }
-                chunkSize = 0;
+            int length = std::min(chunkSize, maxChunkSize);
+            if (buffer->readableBytes() < length) {
+                return ChannelMessage::EMPTY_MESSAGE;
             }
-            chunk = HttpChunkPtr(new DefaultHttpChunk(buff));
-            this->chunkSize = chunkSize;
+
+            HttpChunkPtr chunk(new DefaultHttpChunk(readContent(buffer, length)));
+            chunkSize -= length;
 
             if (chunkSize == 0) {
                 // Read all content.
-                checkpoint(READ_CHUNK_DELIMITER);
+                state = READ_CHUNK_DELIMITER;
             }
-
-            if (!chunk->isLast()) {
-                return ChannelMessage(chunk);
-            }
-            break;
+            return ChannelMessage(chunk);
         }
         case READ_CHUNK_DELIMITER: {
-            for (;;) {
-                boost::int8_t next = buffer->readByte();
-                if (buffer->needMoreBytes()) {
-                    return ChannelMessage::EMPTY_MESSAGE;
-                }
-
-                if (next == HttpCodecUtil::CR) {
-                    if (buffer->readByte() == HttpCodecUtil::LF) {
-                        checkpoint(READ_CHUNK_SIZE);
-                        return ChannelMessage::EMPTY_MESSAGE;
-                    }
-
-                    if (buffer->needMoreBytes()) {
-                        return ChannelMessage::EMPTY_MESSAGE;
-                    }
-                }
-                else if (next == HttpCodecUtil::LF) {
-                    checkpoint(READ_CHUNK_SIZE);
-                    return ChannelMessage::EMPTY_MESSAGE;
-                }
+            FastString line;
+            if (!readLine(buffer, maxInitialLineLength, line)) {
+                return ChannelMessage::EMPTY_MESSAGE;
             }
+            state = READ_CHUNK_SIZE;
             break;
         }
         case READ_CHUNK_FOOTER: {
-            HttpChunkTrailerPtr trailer = readTrailingHeaders(buffer);
+            if (!readTrailingHeaders(buffer)) {
+                return ChannelMessage::EMPTY_MESSAGE;
+            }
+
+            HttpChunkTrailerPtr trailer = this->trailer;
+            this->trailer.reset();
+
+            if (!trailer) {
+                trailer = boost::dynamic_pointer_cast<HttpChunkTrailer>(HttpChunk::LAST_CHUNK);
+            }
+
             if (maxChunkSize == 0) {
                 // Chunked encoding disabled.
                 return reset();
@@ -368,15 +323,39 @@ ChannelMessage HttpMessageDecoder::decode(ChannelHandlerContext& ctx,
             else {
                 reset();
                 // The last chunk, which is empty
-                return ChannelMessage(trailer);
+                return ChannelMessage(HttpChunkPtr(trailer));
             }
         }
         default: {
             throw RuntimeException("Shouldn't reach here.");
         }
+        }
     }
+}
 
-    return ChannelMessage::EMPTY_MESSAGE;
+ChannelMessage HttpMessageDecoder::decodeLast(ChannelHandlerContext& ctx,
+                                              Channel& channel,
+                                              const ChannelBufferPtr& buffer) {
+    switch (state) {
+    case READ_VARIABLE_LENGTH_CONTENT: {
+        // the connection is closed, so all the rest is the content.
+        content = readContent(buffer, buffer->readableBytes());
+        return reset();
+    }
+    case READ_VARIABLE_LENGTH_CONTENT_AS_CHUNKS: {
+        reset();
+        if (buffer->readable()) {
+            HttpChunkPtr chunk(new DefaultHttpChunk(
+                                   readContent(buffer, buffer->readableBytes())));
+            return ChannelMessage(ChannelMessage(chunk),
+                                  ChannelMessage(HttpChunk::LAST_CHUNK));
+        }
+        // Append the last chunk.
+        return ChannelMessage(HttpChunk::LAST_CHUNK);
+    }
+    default:
+        return decode(ctx, channel, buffer);
+    }
 }
 
 bool HttpMessageDecoder::isContentAlwaysEmpty(const HttpMessage& msg) const {
@@ -394,7 +373,7 @@ bool HttpMessageDecoder::isContentAlwaysEmpty(const HttpMessage& msg) const {
     return false;
 }
 
-cetty::channel::ChannelMessage HttpMessageDecoder::reset() {
+ChannelMessage HttpMessageDecoder::reset() {
     HttpMessagePtr message = this->message;
     ChannelBufferPtr content = this->content;
 
@@ -404,254 +383,322 @@ cetty::channel::ChannelMessage HttpMessageDecoder::reset() {
     }
     this->message.reset();
 
-    checkpoint(SKIP_CONTROL_CHARS);
+    state = SKIP_CONTROL_CHARS;
     return ChannelMessage(message);
 }
 
-bool HttpMessageDecoder::skipControlCharacters(const ReplayingDecoderBufferPtr& buffer) const {
-    for (;;) {
-        boost::uint8_t c = buffer->readUnsignedByte();
-        if (buffer->needMoreBytes()) return false;
+ChannelBufferPtr HttpMessageDecoder::readContent(const ChannelBufferPtr& buffer,
+                                                 int length) {
+    if (length == 0) {
+        return ChannelBuffers::EMPTY_BUFFER;
+    }
+
+    int index = buffer->readerIndex();
+    ChannelBufferPtr content = extractFrame(buffer, index, length);
+    buffer->readerIndex(index + length);
+    return content;
+}
+
+bool HttpMessageDecoder::skipControlCharacters(const ChannelBufferPtr& buffer) const {
+    int index = buffer->readerIndex();
+    int writerIndex = buffer->writerIndex();
+
+    for (; index < writerIndex; ++index) {
+        boost::uint8_t c = buffer->getUnsignedByte(index);
 
         if (!Character::isISOControl(c) &&
             !Character::isWhitespace(c)) {
-                buffer->readerIndex(buffer->readerIndex() - 1);
-                return true;
+            buffer->readerIndex(index);
+            return true;
         }
     }
+
+    //do not care skipped control chars.
+    buffer->readerIndex(writerIndex);
+    return false;
 }
 
-bool HttpMessageDecoder::readFixedLengthContent(const ReplayingDecoderBufferPtr& buffer) {
-    int length = HttpHeaders::getContentLength(*message, -1);
-    BOOST_ASSERT(length <= Integer::MAX_VALUE);
+bool HttpMessageDecoder::readInitialLine(const ChannelBufferPtr& buffer) {
+    FastString line;
+    if (!readLine(buffer, maxInitialLineLength, line)) {
+        return false;
+    }
 
-    content.reset();
-    content = buffer->readSlice(length);
+    // createMessage takes the parts as c strings, so splits a copy.
+    if (line.data != lineBuffer.data()) {
+        lineBuffer.assign(line.data, line.size);
+    }
+    lineBuffer.append(1, '\0');
 
-    return !(buffer->needMoreBytes());
-}
+    const char* parts[3];
+    if (splitInitialLine(&lineBuffer[0], line.size, parts) < 3) {
+        // Invalid initial line - ignore.
+        state = SKIP_CONTROL_CHARS;
+        return true;
+    }
 
-int HttpMessageDecoder::readHeaders(const ReplayingDecoderBufferPtr& buffer) {
-    int nextState;
-    FastString line = readHeader(buffer);
-    FastString name;
-    FastString value;
+    message = createMessage(parts[0], parts[1], parts[2]);
+    state = READ_HEADER;
 
+    // clear data, then step into the READ_HEADER state.
     headerSize = 0;
-    if (buffer->needMoreBytes()) { // need more data
-        return READ_HEADER;
-    }
+    headerName.clear();
+    headerValue.clear();
+    headerBuffer.reset();
+    message->clearHeaders();
+    return true;
+}
 
-    if (line.length() != 0) {
-        std::vector<FastString> header;
-        std::string multiValueStr;
+int HttpMessageDecoder::readHeaders(const ChannelBufferPtr& buffer) {
+    FastString line;
 
-        while (line.length() != 0) {
-            char firstChar = line.at(0);
-            if (!name.empty() && (firstChar == ' ' || firstChar == '\t')) {
-                multiValueStr.clear();
-                FastString trimedLine = line.trim();
+    while (readHeaderLine(buffer, line)) {
+        if (line.empty()) {
+            // Add the last header.
+            flushHeader();
 
-                multiValueStr.append(value.c_str());
-                multiValueStr.append(1, ' ');
-                multiValueStr.append(trimedLine.data, trimedLine.size);
+            if (isContentAlwaysEmpty(*message)) {
+                return SKIP_CONTROL_CHARS;
+            }
+            else if (message->isChunked()) {
+                // HttpMessage.isChunked() returns true when either:
+                // 1) HttpMessage.setChunked(true) was called or
+                // 2) 'Transfer-Encoding' is 'chunked'.
+                // Because this decoder did not call HttpMessage.setChunked(true)
+                // yet, HttpMessage.isChunked() should return true only when
+                // 'Transfer-Encoding' is 'chunked'.
+                return READ_CHUNK_SIZE;
+            }
+            else if (HttpHeaders::getContentLength(*message, -1) >= 0) {
+                return READ_FIXED_LENGTH_CONTENT;
             }
             else {
-                if (!name.empty()) {
-                    if (!multiValueStr.empty()) {
-                        message->addHeader(name.c_str(), multiValueStr);
-                    }
-                    else {
-                        message->addHeader(name.c_str(), value.c_str());
-                    }
-                }
-
-                header.clear();
-                splitHeader(line, header);
-                name = header[0];
-                value = header[1];
+                return READ_VARIABLE_LENGTH_CONTENT;
             }
+        }
 
-            line = readHeader(buffer);
-            if (buffer->needMoreBytes()) { // need more data
-                return READ_HEADER;
-            }
+        char firstChar = line.at(0);
+        if (hasHeader() && (firstChar == ' ' || firstChar == '\t')) {
+            appendHeaderValue(line);
+        }
+        else {
+            flushHeader();
+            setHeader(buffer, line, sliceable);
         }
+    }
 
-        // Add the last header.
-        if (!name.empty()) {
-            if (!multiValueStr.empty()) {
-                message->addHeader(name.c_str(), multiValueStr);
-            }
-            else {
-                message->addHeader(name.c_str(), value.c_str());
-            }
+    // need more data
+    return READ_HEADER;
+}
+
+bool HttpMessageDecoder::readTrailingHeaders(const ChannelBufferPtr& buffer) {
+    FastString line;
+
+    while (readHeaderLine(buffer, line)) {
+        if (line.empty()) {
+            flushTrailingHeader();
+            return true;
+        }
+
+        char firstChar = line.at(0);
+        if (hasHeader() && (firstChar == ' ' || firstChar == '\t')) {
+            appendHeaderValue(line);
+        }
+        else {
+            flushTrailingHeader();
+            setHeader(buffer, line, false);
         }
     }
 
-    if (isContentAlwaysEmpty(*message)) {
-        nextState = SKIP_CONTROL_CHARS;
+    return false;
+}
+
+void HttpMessageDecoder::setHeader(const ChannelBufferPtr& buffer,
+                                   const FastString& line,
+                                   bool referable) {
+    FastString name;
+    FastString value;
+    splitHeader(line, name, value);
+
+    // the line in the lineBuffer will be overwritten by the next line.
+    if (referable && line.data != lineBuffer.data()) {
+        headerBuffer = buffer;
+        headerNameRef = name;
+        headerValueRef = value;
     }
-    else if (message->isChunked()) {
-        // HttpMessage.isChunked() returns true when either:
-        // 1) HttpMessage.setChunked(true) was called or
-        // 2) 'Transfer-Encoding' is 'chunked'.
-        // Because this decoder did not call HttpMessage.setChunked(true)
-        // yet, HttpMessage.isChunked() should return true only when
-        // 'Transfer-Encoding' is 'chunked'.
-        nextState = READ_CHUNK_SIZE;
+    else {
+        headerName.assign(name.data, name.size);
+        headerValue.assign(value.data, value.size);
+    }
+}
+
+void HttpMessageDecoder::appendHeaderValue(const FastString& line) {
+    if (headerBuffer) {
+        headerNameRef.appendTo(headerName);
+        headerValueRef.appendTo(headerValue);
+        headerBuffer.reset();
     }
-    else if (HttpHeaders::getContentLength(*message, -1) >= 0) {
-        nextState = READ_FIXED_LENGTH_CONTENT;
+
+    headerValue.append(1, ' ');
+    line.trim().appendTo(headerValue);
+}
+
+void HttpMessageDecoder::flushHeader() {
+    if (headerBuffer) {
+        message->header().add(headerBuffer,
+                              headerNameRef.data,
+                              headerNameRef.size,
+                              headerValueRef.data,
+                              headerValueRef.size);
+        headerBuffer.reset();
     }
-    else {
-        nextState = READ_VARIABLE_LENGTH_CONTENT;
+    else if (!headerName.empty()) {
+        message->addHeader(headerName, headerValue);
+        headerName.clear();
+        headerValue.clear();
     }
-    return nextState;
 }
 
-HttpChunkTrailerPtr
-HttpMessageDecoder::readTrailingHeaders(const ReplayingDecoderBufferPtr& buffer) {
-    headerSize = 0;
-    FastString line = readHeader(buffer);
-    FastString lastHeader;
-    if (line.length() != 0) {
-        std::vector<FastString> header;
-        HttpChunkTrailerPtr trailer = HttpChunkTrailerPtr(new DefaultHttpChunkTrailer);
-        do {
-            char firstChar = line.at(0);
-            if (!lastHeader.empty() && (firstChar == ' ' || firstChar == '\t')) {
-                HttpHeader::StringList current = trailer->header().gets(lastHeader.c_str());
-                if (current.size() != 0) {
-                    current.back().append(line.trim().c_str());
-                }
-                else {
-                    // Content-Length, Transfer-Encoding, or Trailer
-                }
-            }
-            else {
-                header.clear();
-                splitHeader(line, header);
-                FastString name = header[0];
-                if (!name.equalsIgnoreCase(HttpHeaders::Names::CONTENT_LENGTH) &&
-                    !name.equalsIgnoreCase(HttpHeaders::Names::TRANSFER_ENCODING) &&
-                    !name.equalsIgnoreCase(HttpHeaders::Names::TRAILER)) {
-                        trailer->header().add(name.c_str(), header[1].c_str());
-                }
-                lastHeader = name;
-            }
+void HttpMessageDecoder::flushTrailingHeader() {
+    if (headerName.empty()) {
+        return;
+    }
 
-            line = readHeader(buffer);
+    FastString name(headerName.data(), static_cast<int>(headerName.size()));
+    if (!name.equalsIgnoreCase(HttpHeaders::Names::CONTENT_LENGTH) &&
+        !name.equalsIgnoreCase(HttpHeaders::Names::TRANSFER_ENCODING) &&
+        !name.equalsIgnoreCase(HttpHeaders::Names::TRAILER)) {
+        if (!trailer) {
+            trailer = HttpChunkTrailerPtr(new DefaultHttpChunkTrailer);
         }
-        while (line.length() != 0);
-
-        return trailer;
+        trailer->header().add(headerName, headerValue);
     }
 
-    return boost::dynamic_pointer_cast<HttpChunkTrailer>(HttpChunk::LAST_CHUNK);
+    headerName.clear();
+    headerValue.clear();
 }
 
-HttpMessageDecoder::FastString
-HttpMessageDecoder::readHeader(const ReplayingDecoderBufferPtr& buffer) {
-    FastString str;
-    str.data = buffer->array().data(buffer->readerIndex());
-
-    int headerSize = this->headerSize;
-    int strSize = 0;
-    while (true) {
-        boost::int8_t nextByte = buffer->readByte();
-        if (buffer->needMoreBytes()) return str;
-
-        ++headerSize;
-        ++strSize;
-        if (nextByte == HttpCodecUtil::CR) {
-            nextByte = buffer->readByte();
-            if (buffer->needMoreBytes()) return str;
-
-            ++headerSize;
-            if (nextByte == HttpCodecUtil::LF) {
-                break;
-            }
-        }
-        else if (nextByte == HttpCodecUtil::LF) {
-            break;
-        }
+bool HttpMessageDecoder::readLine(const ChannelBufferPtr& buffer, FastString& line) {
+    int readerIndex = buffer->readerIndex();
+    int writerIndex = buffer->writerIndex();
+    int lf = buffer->indexOf(readerIndex + lineScanned, writerIndex, HttpCodecUtil::LF);
+
+    if (lf < 0) {
+        lineScanned = writerIndex - readerIndex;
+        return false;
+    }
+
+    int length = lf - readerIndex;
+    if (length > 0 && buffer->getByte(lf - 1) == HttpCodecUtil::CR) {
+        --length;
+    }
 
-        // Abort decoding if the header part is too large.
-        if (headerSize >= maxHeaderSize) {
-            // TODO: Respond with Bad Request and discard the traffic
-            //    or close the connection.
-            //       No need to notify the upstream handlers - just log.
-            //       If decoding a response, just throw an exception.
-            throw TooLongFrameException(
-                std::string("HTTP header is larger than ") +
-                Integer::toString(maxHeaderSize) +
-                std::string(" bytes."));
+    ConstArray bytes;
+    int start = buffer->getContiguousBytes(readerIndex, bytes);
 
+    if (start >= 0 && readerIndex - start + length <= bytes.length()) {
+        line = FastString(bytes.data() + (readerIndex - start), length);
+    }
+    else {
+        // the line spans the received packets.
+        lineBuffer.resize(length);
+        if (length > 0) {
+            buffer->getBytes(readerIndex, Array(&lineBuffer[0], length));
         }
+        line = FastString(lineBuffer.data(), length);
     }
-    str.data[strSize - 1] = '\0';
-    str.size = strSize - 1;
 
-    this->headerSize = headerSize;
-    return str;
+    lineScanned = 0;
+    buffer->readerIndex(lf + 1);
+    return true;
 }
 
-int HttpMessageDecoder::getChunkSize(const FastString& hex) const {
-    FastString h = hex.trim();
-    for (int i = 0; i < h.length(); ++i) {
-        char c = h.at(i);
-        if (c == ';' || Character::isWhitespace(c) || Character::isISOControl(c)) {
-            h = h.substring(0, i);
-            break;
-        }
+bool HttpMessageDecoder::readLine(const ChannelBufferPtr& buffer,
+                                  int maxLineLength,
+                                  FastString& line) {
+    bool read = readLine(buffer, line);
+
+    // the scanned bytes may include the CR.
+    if ((read && line.size > maxLineLength) ||
+        (!read && lineScanned > maxLineLength + 1)) {
+        // TODO: Respond with Bad Request and discard the traffic
+        //    or close the connection.
+        //       No need to notify the upstream handlers - just log.
+        //       If decoding a response, just throw an exception.
+        throw TooLongFrameException(
+            std::string("An HTTP line is larger than ") +
+            Integer::toString(maxLineLength) +
+            std::string(" bytes."));
     }
 
-    return Integer::parse(h.c_str(), 16);
+    return read;
 }
 
-HttpMessageDecoder::FastString HttpMessageDecoder::readLine(const ReplayingDecoderBufferPtr& buffer, int maxLineLength) {
-    FastString str;
-    str.data = buffer->array().data(buffer->readerIndex());
+bool HttpMessageDecoder::readHeaderLine(const ChannelBufferPtr& buffer,
+                                        FastString& line) {
+    int readerIndex = buffer->readerIndex();
+    bool read = readLine(buffer, line);
 
-    while (true) {
-        boost::int8_t nextByte = buffer->readByte();
-        if (buffer->needMoreBytes()) return str;
+    if (read) {
+        headerSize += buffer->readerIndex() - readerIndex;
+    }
 
-        if (nextByte == HttpCodecUtil::CR) {
-            nextByte = buffer->readByte();
-            if (buffer->needMoreBytes()) return str;
+    // Abort decoding if the header part is too large.
+    if (headerSize + lineScanned > maxHeaderSize) {
+        throw TooLongFrameException(
+            std::string("HTTP header is larger than ") +
+            Integer::toString(maxHeaderSize) +
+            std::string(" bytes."));
+    }
 
-            if (nextByte == HttpCodecUtil::LF) {
-                break;
-            }
+    return read;
+}
+
+int HttpMessageDecoder::getChunkSize(const FastString& hex) const {
+    FastString h = hex.trim();
+    int size = 0;
+    int digits = 0;
+
+    for (int i = 0; i < h.length(); ++i) {
+        char c = h.at(i);
+        int digit;
+
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
         }
-        else if (nextByte == HttpCodecUtil::LF) {
+        else if (c == ';' || Character::isWhitespace(c) || Character::isISOControl(c)) {
             break;
         }
         else {
-            if (str.size >= maxLineLength) {
-                // TODO: Respond with Bad Request and discard the traffic
-                //    or close the connection.
-                //       No need to notify the upstream handlers - just log.
-                //       If decoding a response, just throw an exception.
-                throw TooLongFrameException(
-                    std::string("An HTTP line is larger than ") +
-                    Integer::toString(maxLineLength) +
-                    std::string(" bytes."));
-            }
-            ++str.size;
+            throw NumberFormatException(
+                std::string("invalid chunk size: ") + std::string(h.data, h.size));
+        }
+
+        if (size > (Integer::MAX_VALUE >> 4)) {
+            throw NumberFormatException(
+                std::string("chunk size is too large: ") + std::string(h.data, h.size));
         }
+
+        size = (size << 4) + digit;
+        ++digits;
     }
 
-    // make sure sb.data is exactly a c string.
-    str[str.size] = '\0';
-    --str.size;
+    if (digits == 0) {
+        throw NumberFormatException(
+            std::string("invalid chunk size: ") + std::string(h.data, h.size));
+    }
 
-    return str;
+    return size;
 }
 
-bool HttpMessageDecoder::splitInitialLine(FastString& sb, std::vector<FastString>& lines) {
+int HttpMessageDecoder::splitInitialLine(char* line, int length, const char* parts[3]) {
+    FastString sb(line, length);
     int aStart;
     int aEnd;
     int bStart;
@@ -659,8 +706,6 @@ bool HttpMessageDecoder::splitInitialLine(FastString& sb, std::vector<FastString
     int cStart;
     int cEnd;
 
-    if (sb.empty()) return false;
-
     aStart = findNonWhitespace(sb, 0);
     aEnd = findWhitespace(sb, aStart);
 
@@ -670,16 +715,24 @@ bool HttpMessageDecoder::splitInitialLine(FastString& sb, std::vector<FastString
     cStart = findNonWhitespace(sb, bEnd);
     cEnd = findEndOfString(sb);
 
-    sb[aEnd] = '\0';
-    sb[bEnd] = '\0';
-    lines.push_back(sb.substring(aStart, aEnd));
-    lines.push_back(sb.substring(bStart, bEnd));
-    lines.push_back(sb.substring(cStart, cEnd));
+    if (aStart >= aEnd || bStart >= bEnd || cStart >= cEnd) {
+        return aStart >= aEnd ? 0 : (bStart >= bEnd ? 1 : 2);
+    }
 
-    return true;
+    // the line has a NUL after its end.
+    line[aEnd] = '\0';
+    line[bEnd] = '\0';
+    line[cEnd] = '\0';
+
+    parts[0] = line + aStart;
+    parts[1] = line + bStart;
+    parts[2] = line + cStart;
+    return 3;
 }
 
-void HttpMessageDecoder::splitHeader(FastString& sb, std::vector<FastString>& header) {
+void HttpMessageDecoder::splitHeader(const FastString& sb,
+                                     FastString& name,
+                                     FastString& value) {
     int length = sb.length();
     int nameStart;
     int nameEnd;
@@ -702,18 +755,16 @@ void HttpMessageDecoder::splitHeader(FastString& sb, std::vector<FastString>& he
         }
     }
 
+    name = sb.substring(nameStart, nameEnd);
+
     valueStart = findNonWhitespace(sb, colonEnd);
     if (valueStart == length) {
-        header.push_back(sb.substring(nameStart, nameEnd));
-        header.push_back(FastString());
+        value.clear();
         return;
     }
 
     valueEnd = findEndOfString(sb);
-
-    sb[nameEnd] = '\0';
-    header.push_back(sb.substring(nameStart, nameEnd));
-    header.push_back(sb.substring(valueStart, valueEnd));
+    value = sb.substring(valueStart, valueEnd);
 }
 
 int HttpMessageDecoder::findNonWhitespace(const FastString& sb, int offset) {
@@ -20,6 +20,9 @@
 #include "cetty/channel/ChannelConfig.h"
 #include "cetty/channel/Channel.h"
 #include "cetty/channel/Channels.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/FileRegion.h"
 #include "cetty/util/Exception.h"
 
 #include "cetty/handler/codec/http/HttpHeader.h"
@@ -37,6 +40,37 @@ using namespace cetty::channel;
 using namespace cetty::buffer;
 using namespace cetty::util;
 
+static std::string toHexString(boost::int64_t value) {
+    static const char DIGITS[] = "0123456789abcdef";
+    char str[17];
+    int pos = sizeof(str);
+
+    do {
+        str[--pos] = DIGITS[value & 0x0F];
+        value >>= 4;
+    }
+    while (value > 0);
+
+    return std::string(str + pos, sizeof(str) - pos);
+}
+
+void HttpMessageEncoder::writeRequested(ChannelHandlerContext& ctx,
+                                        const MessageEvent& e) {
+    if (this->chunked) {
+        FileRegionPtr region = e.getMessage().smartPointer<FileRegion>();
+
+        if (region && region->getCount() == 0) {
+            const ChannelFuturePtr& future = e.getFuture();
+            if (future) {
+                future->setSuccess();
+            }
+            return;
+        }
+    }
+
+    OneToOneEncoder::writeRequested(ctx, e);
+}
+
 ChannelMessage HttpMessageEncoder::encode(ChannelHandlerContext& ctx,
                                           Channel& channel,
                                           const ChannelMessage& msg) {
@@ -120,6 +154,31 @@ ChannelMessage HttpMessageEncoder::encode(ChannelHandlerContext& ctx,
         }
     }
 
+    FileRegionPtr region = msg.smartPointer<FileRegion>();
+    if (region) {
+        if (this->chunked) {
+            // an empty region would be written as "0\r\n", the last-chunk
+            // marker, and end the body early.
+            if (region->getCount() == 0) {
+                return ChannelMessage::EMPTY_MESSAGE;
+            }
+
+            // the region is still transferred by itself, between the
+            // chunk size and the line break.
+            std::string size = toHexString(region->getCount());
+            size.append((const char*)HttpCodecUtil::CRLF, 2);
+
+            return ChannelMessage(
+                ChannelMessage(ChannelBuffers::copiedBuffer(size)),
+                ChannelMessage(region),
+                ChannelMessage(ChannelBuffers::copiedBuffer(
+                    Array((char*)HttpCodecUtil::CRLF, 2))));
+        }
+        else {
+            return msg;
+        }
+    }
+
     // Unknown message type.
     return msg;
 }
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/HttpPipeliningHandler.h"
+
+#include <boost/bind.hpp>
+
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/ChannelEventLoop.h"
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/ChannelException.h"
+#include "cetty/channel/ChannelHandlerContext.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/util/Exception.h"
+#include "cetty/util/Integer.h"
+
+#include "cetty/handler/codec/http/HttpMessage.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http {
+
+using namespace cetty::channel;
+using namespace cetty::util;
+
+HttpPipeliningHandler::HttpPipeliningHandler()
+    : maxOutstandingRequests(DEFAULT_MAX_OUTSTANDING_REQUESTS),
+      outstandingRequests(0),
+      nextRequestSequence(0),
+      nextWriteSequence(0),
+      suspended(false),
+      resuming(false) {
+}
+
+HttpPipeliningHandler::HttpPipeliningHandler(int maxOutstandingRequests)
+    : maxOutstandingRequests(maxOutstandingRequests),
+      outstandingRequests(0),
+      nextRequestSequence(0),
+      nextWriteSequence(0),
+      suspended(false),
+      resuming(false) {
+    if (maxOutstandingRequests <= 0) {
+        throw InvalidArgumentException(
+            std::string("maxOutstandingRequests must be a positive integer: ") +
+            Integer::toString(maxOutstandingRequests));
+    }
+}
+
+ChannelHandlerPtr HttpPipeliningHandler::clone() {
+    return ChannelHandlerPtr(new HttpPipeliningHandler(maxOutstandingRequests));
+}
+
+std::string HttpPipeliningHandler::toString() const {
+    return "HttpPipeliningHandler";
+}
+
+int HttpPipeliningHandler::getOutstandingRequests() const {
+    boost::recursive_mutex::scoped_lock lock(mutex);
+    return outstandingRequests;
+}
+
+void HttpPipeliningHandler::messageReceived(ChannelHandlerContext& ctx,
+        const MessageEvent& e) {
+    const ChannelMessage& message = e.getMessage();
+    bool isRequest = !!message.smartPointer<HttpMessage>();
+
+    if (!suspendedRequests.empty() || (isRequest && suspendRequests())) {
+        if (suspendedRequests.empty()) {
+            ctx.getChannel().setReadable(false);
+        }
+
+        // keeps the following chunks too, so they are not received before
+        // their request.
+        suspendedRequests.push_back(message);
+        return;
+    }
+
+    if (isRequest) {
+        forwardRequest(ctx, message);
+    }
+    else {
+        ctx.sendUpstream(e);
+    }
+}
+
+void HttpPipeliningHandler::channelClosed(ChannelHandlerContext& ctx,
+        const ChannelStateEvent& e) {
+    PendingResponses responses;
+
+    {
+        boost::recursive_mutex::scoped_lock lock(mutex);
+        responses.swap(pendingResponses);
+        suspended = false;
+    }
+
+    // fails the futures out of the lock, their listeners may write.
+    PendingResponses::iterator itr = responses.begin();
+
+    for (; itr != responses.end(); ++itr) {
+        PendingWrites& writes = itr->second;
+
+        for (size_t i = 0; i < writes.size(); ++i) {
+            if (writes[i].future) {
+                writes[i].future->setFailure(
+                    ChannelException("Channel has been closed."));
+            }
+        }
+    }
+
+    suspendedRequests.clear();
+
+    SimpleChannelUpstreamHandler::channelClosed(ctx, e);
+}
+
+void HttpPipeliningHandler::writeRequested(ChannelHandlerContext& ctx,
+        const MessageEvent& e) {
+    HttpPipelinedResponsePtr response =
+        e.getMessage().smartPointer<HttpPipelinedResponse>();
+
+    if (!response) {
+        ctx.sendDownstream(e);
+        return;
+    }
+
+    int sequence = response->getSequence();
+    bool resume = false;
+
+    {
+        // the responses are written down in the lock, so the writes of
+        // different threads are still in the order of the requests.
+        boost::recursive_mutex::scoped_lock lock(mutex);
+
+        if (sequence == nextWriteSequence) {
+            Channels::write(ctx,
+                            e.getFuture(),
+                            response->getMessage(),
+                            e.getRemoteAddress());
+
+            if (response->isLast()) {
+                completeResponse(ctx);
+                flushResponses(ctx);
+                resume = suspended;
+            }
+        }
+        else if (sequence > nextWriteSequence && sequence < nextRequestSequence) {
+            pendingResponses[sequence].push_back(
+                PendingWrite(response->getMessage(), e.getFuture(), response->isLast()));
+        }
+        else if (e.getFuture()) {
+            e.getFuture()->setFailure(IllegalStateException(
+                                          std::string("no request is waiting for the response: ") +
+                                          Integer::toString(sequence)));
+        }
+    }
+
+    if (resume) {
+        scheduleResume(ctx);
+    }
+}
+
+bool HttpPipeliningHandler::suspendRequests() {
+    boost::recursive_mutex::scoped_lock lock(mutex);
+
+    // checked and set in the lock, so a response completed meanwhile
+    // always sees the requests suspended and resumes them.
+    if (outstandingRequests >= maxOutstandingRequests) {
+        suspended = true;
+    }
+
+    return suspended;
+}
+
+void HttpPipeliningHandler::forwardRequest(ChannelHandlerContext& ctx,
+        const ChannelMessage& message) {
+    HttpMessagePtr request = message.smartPointer<HttpMessage>();
+
+    if (request) {
+        int sequence;
+
+        {
+            boost::recursive_mutex::scoped_lock lock(mutex);
+            ++outstandingRequests;
+            sequence = nextRequestSequence++;
+        }
+
+        HttpPipelinedRequestPtr pipelined(
+            new HttpPipelinedRequest(sequence, request));
+        Channels::fireMessageReceived(ctx, ChannelMessage(pipelined));
+    }
+    else {
+        Channels::fireMessageReceived(ctx, message);
+    }
+}
+
+void HttpPipeliningHandler::completeResponse(ChannelHandlerContext& ctx) {
+    ++nextWriteSequence;
+    --outstandingRequests;
+}
+
+void HttpPipeliningHandler::flushResponses(ChannelHandlerContext& ctx) {
+    PendingResponses::iterator itr = pendingResponses.find(nextWriteSequence);
+
+    // writes all the finished responses back to back, the channel gathers
+    // the writes which are requested while it is writing.
+    while (itr != pendingResponses.end()) {
+        PendingWrites writes;
+        writes.swap(itr->second);
+        pendingResponses.erase(itr);
+
+        bool last = false;
+
+        for (size_t i = 0; i < writes.size(); ++i) {
+            const PendingWrite& write = writes[i];
+            Channels::write(ctx, write.future, write.message);
+            last = write.last;
+        }
+
+        // the rest of the response will be written when requested.
+        if (!last) {
+            break;
+        }
+
+        completeResponse(ctx);
+        itr = pendingResponses.find(nextWriteSequence);
+    }
+}
+
+void HttpPipeliningHandler::scheduleResume(ChannelHandlerContext& ctx) {
+    ChannelEventLoop* eventLoop = ctx.getChannel().getEventLoop();
+
+    // the response may be written by another thread, while the requests are
+    // only forwarded in the I/O thread.
+    if (eventLoop) {
+        eventLoop->execute(boost::bind(&HttpPipeliningHandler::resumeRequests,
+                                       this,
+                                       boost::ref(ctx)));
+    }
+    else {
+        resumeRequests(ctx);
+    }
+}
+
+void HttpPipeliningHandler::resumeRequests(ChannelHandlerContext& ctx) {
+    // the requests may be answered while they are forwarded.
+    if (resuming || suspendedRequests.empty()) {
+        return;
+    }
+
+    resuming = true;
+
+    try {
+        while (!suspendedRequests.empty()) {
+            ChannelMessage message = suspendedRequests.front();
+
+            // still suspended, resumed again by the next response.
+            if (message.smartPointer<HttpMessage>()
+                    && getOutstandingRequests() >= maxOutstandingRequests) {
+                break;
+            }
+
+            suspendedRequests.pop_front();
+            forwardRequest(ctx, message);
+        }
+    }
+    catch (...) {
+        resuming = false;
+        throw;
+    }
+
+    resuming = false;
+
+    if (suspendedRequests.empty()) {
+        {
+            boost::recursive_mutex::scoped_lock lock(mutex);
+            suspended = false;
+        }
+
+        ctx.getChannel().setReadable(true);
+    }
+}
+
+}}}}
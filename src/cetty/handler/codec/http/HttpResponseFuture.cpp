@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/HttpResponseFuture.h"
+
+#include <boost/thread/thread_time.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace cetty { namespace handler { namespace codec { namespace http {
+
+using namespace cetty::util;
+
+HttpResponseFuture::HttpResponseFuture() : done(false), cause(NULL) {
+}
+
+HttpResponseFuture::~HttpResponseFuture() {
+    if (cause) {
+        delete cause;
+    }
+}
+
+bool HttpResponseFuture::isDone() const {
+    boost::lock_guard<boost::mutex> guard(mutex);
+    return done;
+}
+
+bool HttpResponseFuture::isSuccess() const {
+    boost::lock_guard<boost::mutex> guard(mutex);
+    return done && cause == NULL;
+}
+
+HttpResponsePtr HttpResponseFuture::getResponse() const {
+    boost::lock_guard<boost::mutex> guard(mutex);
+    return response;
+}
+
+const Exception* HttpResponseFuture::getCause() const {
+    boost::lock_guard<boost::mutex> guard(mutex);
+    return cause;
+}
+
+void HttpResponseFuture::setListener(const ListenerFunction& listener) {
+    {
+        boost::lock_guard<boost::mutex> guard(mutex);
+
+        if (!done) {
+            this->listener = listener;
+            return;
+        }
+    }
+
+    listener(HttpResponseFuturePtr(this));
+}
+
+HttpResponseFuture& HttpResponseFuture::awaitUninterruptibly() {
+    boost::unique_lock<boost::mutex> lock(mutex);
+
+    while (!done) {
+        cond.wait(lock);
+    }
+
+    return *this;
+}
+
+bool HttpResponseFuture::awaitUninterruptibly(boost::int64_t timeoutMillis) {
+    boost::system_time expiredTime =
+        boost::get_system_time() + boost::posix_time::milliseconds(timeoutMillis);
+
+    boost::unique_lock<boost::mutex> lock(mutex);
+
+    while (!done) {
+        if (!cond.timed_wait(lock, expiredTime)) {
+            return done;
+        }
+    }
+
+    return true;
+}
+
+bool HttpResponseFuture::setResponse(const HttpResponsePtr& response) {
+    {
+        boost::lock_guard<boost::mutex> guard(mutex);
+
+        // Allow only once.
+        if (done) {
+            return false;
+        }
+
+        this->response = response;
+        done = true;
+        cond.notify_all();
+    }
+
+    notifyListener();
+    return true;
+}
+
+bool HttpResponseFuture::setFailure(const Exception& cause) {
+    {
+        boost::lock_guard<boost::mutex> guard(mutex);
+
+        // Allow only once.
+        if (done) {
+            return false;
+        }
+
+        this->cause = new Exception(cause);
+        done = true;
+        cond.notify_all();
+    }
+
+    notifyListener();
+    return true;
+}
+
+void HttpResponseFuture::notifyListener() {
+    // the listener is only set before done, so no lock is needed now.
+    if (listener) {
+        ListenerFunction l;
+        l.swap(listener);
+        l(HttpResponseFuturePtr(this));
+    }
+}
+
+}}}}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/websocketx/WebSocket13FrameDecoder.h"
+
+#include <boost/cstdint.hpp>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/ChannelFutureListener.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/handler/codec/frame/CorruptedFrameException.h"
+#include "cetty/handler/codec/frame/TooLongFrameException.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketFrame.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketUtil.h"
+#include "cetty/util/Integer.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::util;
+using namespace cetty::channel;
+using namespace cetty::buffer;
+using namespace cetty::handler::codec::frame;
+
+static const int PROTOCOL_ERROR = 1002;
+static const int MESSAGE_TOO_BIG = 1009;
+
+static const int MAX_CONTROL_FRAME_PAYLOAD_LENGTH = 125;
+
+WebSocket13FrameDecoder::WebSocket13FrameDecoder()
+    : expectMaskedFrames(true),
+      allowExtensions(false),
+      maxFramePayloadLength(DEFAULT_MAX_FRAME_PAYLOAD_LENGTH),
+      fragmentedOpcode(-1),
+      receivedClosingHandshake(false) {
+}
+
+WebSocket13FrameDecoder::WebSocket13FrameDecoder(bool expectMaskedFrames,
+                                                 bool allowExtensions,
+                                                 int maxFramePayloadLength)
+    : expectMaskedFrames(expectMaskedFrames),
+      allowExtensions(allowExtensions),
+      maxFramePayloadLength(maxFramePayloadLength),
+      fragmentedOpcode(-1),
+      receivedClosingHandshake(false) {
+}
+
+ChannelHandlerPtr WebSocket13FrameDecoder::clone() {
+    return ChannelHandlerPtr(new WebSocket13FrameDecoder(expectMaskedFrames,
+                             allowExtensions,
+                             maxFramePayloadLength));
+}
+
+ChannelMessage WebSocket13FrameDecoder::decode(ChannelHandlerContext& ctx,
+        Channel& channel,
+        const ChannelBufferPtr& buffer) {
+    if (receivedClosingHandshake) {
+        buffer->skipBytes(buffer->readableBytes());
+        return ChannelMessage::EMPTY_MESSAGE;
+    }
+
+    int readerIndex = buffer->readerIndex();
+    int readable = buffer->readableBytes();
+
+    if (readable < 2) {
+        return ChannelMessage::EMPTY_MESSAGE;
+    }
+
+    int b0 = buffer->getUnsignedByte(readerIndex);
+    int b1 = buffer->getUnsignedByte(readerIndex + 1);
+
+    bool finalFragment = (b0 & 0x80) != 0;
+    int rsv = (b0 & 0x70) >> 4;
+    int opcode = b0 & 0x0F;
+    bool masked = (b1 & 0x80) != 0;
+    int payloadLength7 = b1 & 0x7F;
+
+    int headerLength = 2;
+    if (payloadLength7 == 126) {
+        headerLength += 2;
+    }
+    else if (payloadLength7 == 127) {
+        headerLength += 8;
+    }
+    if (masked) {
+        headerLength += WebSocketUtil::MASK_KEY_SIZE;
+    }
+
+    if (readable < headerLength) {
+        return ChannelMessage::EMPTY_MESSAGE;
+    }
+
+    if (rsv != 0 && !allowExtensions) {
+        protocolViolation(channel, buffer,
+                          PROTOCOL_ERROR, "reserved bits set: " + Integer::toString(rsv));
+    }
+
+    if (masked != expectMaskedFrames) {
+        protocolViolation(channel, buffer, PROTOCOL_ERROR,
+                          masked ? "received a masked frame" : "received an unmasked frame");
+    }
+
+    if (!WebSocketFrameType::isDefined(opcode)) {
+        protocolViolation(channel, buffer,
+                          PROTOCOL_ERROR, "reserved opcode: " + Integer::toString(opcode));
+    }
+
+    const WebSocketFrameType& type = WebSocketFrameType::valueOf(opcode);
+
+    if (type.isControl()) {
+        if (!finalFragment) {
+            protocolViolation(channel, buffer,
+                              PROTOCOL_ERROR, "fragmented control frame");
+        }
+
+        if (payloadLength7 > MAX_CONTROL_FRAME_PAYLOAD_LENGTH) {
+            protocolViolation(channel, buffer,
+                              PROTOCOL_ERROR, "control frame with a too long payload");
+        }
+
+        if (type == WebSocketFrameType::CLOSE && payloadLength7 == 1) {
+            protocolViolation(channel, buffer,
+                              PROTOCOL_ERROR, "close frame with a one byte payload");
+        }
+    }
+    else if (type == WebSocketFrameType::CONTINUATION) {
+        if (fragmentedOpcode < 0) {
+            protocolViolation(channel, buffer,
+                              PROTOCOL_ERROR, "continuation frame out of a fragmented message");
+        }
+    }
+    else if (fragmentedOpcode >= 0) {
+        protocolViolation(channel, buffer,
+                          PROTOCOL_ERROR, "data frame in a fragmented message");
+    }
+
+    boost::uint64_t payloadLength = payloadLength7;
+    int index = readerIndex + 2;
+
+    if (payloadLength7 == 126) {
+        payloadLength = buffer->getUnsignedShort(index);
+        index += 2;
+
+        if (payloadLength < 126) {
+            protocolViolation(channel, buffer,
+                              PROTOCOL_ERROR, "payload length not in the minimal bytes");
+        }
+    }
+    else if (payloadLength7 == 127) {
+        payloadLength = static_cast<boost::uint64_t>(buffer->getLong(index));
+        index += 8;
+
+        if (payloadLength >> 63) {
+            protocolViolation(channel, buffer,
+                              PROTOCOL_ERROR, "the most significant bit of the payload length set");
+        }
+
+        if (payloadLength < 65536) {
+            protocolViolation(channel, buffer,
+                              PROTOCOL_ERROR, "payload length not in the minimal bytes");
+        }
+    }
+
+    if (payloadLength > static_cast<boost::uint64_t>(maxFramePayloadLength)) {
+        protocolViolation(channel, buffer, MESSAGE_TOO_BIG,
+                          "frame payload length exceeds " + Integer::toString(maxFramePayloadLength));
+    }
+
+    int length = static_cast<int>(payloadLength);
+
+    if (readable < headerLength + length) {
+        return ChannelMessage::EMPTY_MESSAGE;
+    }
+
+    char maskKey[WebSocketUtil::MASK_KEY_SIZE];
+    if (masked) {
+        for (int i = 0; i < WebSocketUtil::MASK_KEY_SIZE; ++i) {
+            maskKey[i] = static_cast<char>(buffer->getByte(index + i));
+        }
+    }
+
+    ChannelBufferPtr payload = length > 0
+                               ? extractFrame(buffer, readerIndex + headerLength, length)
+                               : ChannelBuffers::EMPTY_BUFFER;
+    buffer->skipBytes(headerLength + length);
+
+    if (masked && length > 0) {
+        // the payload has been taken out of the received bytes, which
+        // nobody else reads, so it is unmasked in place.
+        WebSocketUtil::mask(payload, maskKey);
+    }
+
+    if (!type.isControl()) {
+        if (!finalFragment && type != WebSocketFrameType::CONTINUATION) {
+            fragmentedOpcode = opcode;
+        }
+        else if (finalFragment) {
+            fragmentedOpcode = -1;
+        }
+    }
+    else if (type == WebSocketFrameType::CLOSE) {
+        receivedClosingHandshake = true;
+    }
+
+    return ChannelMessage(WebSocketFramePtr(
+                              new WebSocketFrame(type, finalFragment, rsv, payload)));
+}
+
+void WebSocket13FrameDecoder::protocolViolation(Channel& channel,
+        const ChannelBufferPtr& buffer,
+        int statusCode,
+        const std::string& reason) {
+    receivedClosingHandshake = true;
+    buffer->skipBytes(buffer->readableBytes());
+
+    if (channel.isConnected()) {
+        ChannelFuturePtr future = channel.write(ChannelMessage(
+                WebSocketFrame::createCloseFrame(statusCode, std::string())));
+        future->addListener(ChannelFutureListener::CLOSE);
+    }
+
+    if (statusCode == MESSAGE_TOO_BIG) {
+        throw TooLongFrameException(reason);
+    }
+
+    throw CorruptedFrameException(reason);
+}
+
+}}}}}
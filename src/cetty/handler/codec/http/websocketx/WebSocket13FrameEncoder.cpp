@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/websocketx/WebSocket13FrameEncoder.h"
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/buffer/ChannelBufferFactory.h"
+#include "cetty/buffer/HeapChannelBufferFactory.h"
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/ChannelConfig.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/handler/codec/frame/TooLongFrameException.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketFrame.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketUtil.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::channel;
+using namespace cetty::buffer;
+using namespace cetty::handler::codec::frame;
+
+static const int MAX_HEADER_LENGTH = 14;
+
+// a small payload is copied after the header rather than written as
+// another buffer.
+static const int MAX_COPIED_PAYLOAD_LENGTH = 128;
+
+ChannelHandlerPtr WebSocket13FrameEncoder::clone() {
+    return ChannelHandlerPtr(new WebSocket13FrameEncoder(maskPayload));
+}
+
+// encodes the frame, masks the payload if the mask key is not NULL.
+static ChannelMessage encodeWebSocketFrame(const WebSocketFrame& frame,
+                                           ChannelBufferFactory& factory,
+                                           const char* maskKey) {
+    const ChannelBufferPtr& data = frame.getBinaryData();
+    int length = data->readableBytes();
+
+    if (frame.isControl() && length > 125) {
+        throw TooLongFrameException("control frame payload longer than 125 bytes");
+    }
+
+    bool copied = maskKey || length <= MAX_COPIED_PAYLOAD_LENGTH;
+    ChannelBufferPtr header = factory.getBuffer(
+                                  MAX_HEADER_LENGTH + (copied ? length : 0));
+
+    int b0 = (frame.isFinalFragment() ? 0x80 : 0)
+             | (frame.getRsv() << 4)
+             | frame.getType().value();
+    int maskBit = maskKey ? 0x80 : 0;
+
+    header->writeByte(b0);
+
+    if (length < 126) {
+        header->writeByte(maskBit | length);
+    }
+    else if (length <= 0xFFFF) {
+        header->writeByte(maskBit | 126);
+        header->writeShort(length);
+    }
+    else {
+        header->writeByte(maskBit | 127);
+        header->writeLong(length);
+    }
+
+    if (maskKey) {
+        header->writeBytes(ConstArray(maskKey, WebSocketUtil::MASK_KEY_SIZE));
+
+        int payloadIndex = header->writerIndex();
+        header->writeBytes(*data, data->readerIndex(), length);
+        WebSocketUtil::mask(header->slice(payloadIndex, length), maskKey);
+
+        return ChannelMessage(header);
+    }
+
+    if (copied) {
+        header->writeBytes(*data, data->readerIndex(), length);
+        return ChannelMessage(header);
+    }
+
+    // the payload is shared by the frame, which may be written to other
+    // channels, so it is only referenced.
+    return ChannelMessage(header, data);
+}
+
+ChannelMessage WebSocket13FrameEncoder::encodeFrame(const ChannelMessage& msg) {
+    WebSocketFramePtr frame = msg.smartPointer<WebSocketFrame>();
+
+    if (!frame) {
+        return msg;
+    }
+
+    return encodeWebSocketFrame(*frame, HeapChannelBufferFactory::getInstance(), NULL);
+}
+
+ChannelMessage WebSocket13FrameEncoder::encode(ChannelHandlerContext& ctx,
+        Channel& channel,
+        const ChannelMessage& msg) {
+    WebSocketFramePtr frame = msg.smartPointer<WebSocketFrame>();
+
+    if (!frame) {
+        return msg;
+    }
+
+    ChannelBufferFactory& factory = *channel.getConfig().getBufferFactory();
+
+    if (maskPayload) {
+        char maskKey[WebSocketUtil::MASK_KEY_SIZE];
+        random.nextBytes(maskKey, WebSocketUtil::MASK_KEY_SIZE);
+        return encodeWebSocketFrame(*frame, factory, maskKey);
+    }
+
+    return encodeWebSocketFrame(*frame, factory, NULL);
+}
+
+}}}}}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/websocketx/WebSocketFrame.h"
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/util/Integer.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::util;
+using namespace cetty::buffer;
+
+WebSocketFrame::WebSocketFrame(const WebSocketFrameType& type,
+                               const ChannelBufferPtr& binaryData)
+    : type(type), finalFragment(true), rsv(0) {
+    setBinaryData(binaryData);
+}
+
+WebSocketFrame::WebSocketFrame(const WebSocketFrameType& type,
+                               bool finalFragment,
+                               int rsv,
+                               const ChannelBufferPtr& binaryData)
+    : type(type), finalFragment(finalFragment), rsv(rsv & 0x07) {
+    setBinaryData(binaryData);
+}
+
+WebSocketFrame::WebSocketFrame(const std::string& text)
+    : type(WebSocketFrameType::TEXT), finalFragment(true), rsv(0) {
+    setBinaryData(ChannelBuffers::copiedBuffer(text));
+}
+
+WebSocketFramePtr WebSocketFrame::createCloseFrame(int statusCode,
+                                                   const std::string& reasonText) {
+    if (statusCode == NO_STATUS_CODE) {
+        return WebSocketFramePtr(new WebSocketFrame(WebSocketFrameType::CLOSE,
+                                 ChannelBuffers::EMPTY_BUFFER));
+    }
+
+    ChannelBufferPtr data =
+        ChannelBuffers::buffer(2 + static_cast<int>(reasonText.size()));
+
+    data->writeShort(statusCode);
+    data->writeBytes(reasonText);
+
+    return WebSocketFramePtr(new WebSocketFrame(WebSocketFrameType::CLOSE, data));
+}
+
+void WebSocketFrame::setBinaryData(const ChannelBufferPtr& binaryData) {
+    this->binaryData = binaryData ? binaryData : ChannelBuffers::EMPTY_BUFFER;
+}
+
+std::string WebSocketFrame::getTextData() const {
+    std::string text;
+    binaryData->getBytes(binaryData->readerIndex(), text, binaryData->readableBytes());
+    return text;
+}
+
+int WebSocketFrame::getCloseStatusCode() const {
+    if (type != WebSocketFrameType::CLOSE || binaryData->readableBytes() < 2) {
+        return NO_STATUS_CODE;
+    }
+
+    return binaryData->getUnsignedShort(binaryData->readerIndex());
+}
+
+std::string WebSocketFrame::getCloseReasonText() const {
+    if (type != WebSocketFrameType::CLOSE || binaryData->readableBytes() <= 2) {
+        return std::string();
+    }
+
+    std::string reason;
+    binaryData->getBytes(binaryData->readerIndex() + 2,
+                         reason,
+                         binaryData->readableBytes() - 2);
+    return reason;
+}
+
+std::string WebSocketFrame::toString() const {
+    std::string str("WebSocketFrame(type: ");
+
+    str += type.toString();
+    str += finalFragment ? ", final" : ", fragment";
+    str += ", rsv: ";
+    str += Integer::toString(rsv);
+    str += ", data: ";
+    str += Integer::toString(binaryData->readableBytes());
+    str += " bytes)";
+
+    return str;
+}
+
+}}}}}
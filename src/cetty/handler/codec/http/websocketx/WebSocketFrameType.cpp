@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/websocketx/WebSocketFrameType.h"
+#include "cetty/util/Exception.h"
+#include "cetty/util/Integer.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::util;
+
+const WebSocketFrameType WebSocketFrameType::CONTINUATION = 0x0;
+const WebSocketFrameType WebSocketFrameType::TEXT         = 0x1;
+const WebSocketFrameType WebSocketFrameType::BINARY       = 0x2;
+const WebSocketFrameType WebSocketFrameType::CLOSE        = 0x8;
+const WebSocketFrameType WebSocketFrameType::PING         = 0x9;
+const WebSocketFrameType WebSocketFrameType::PONG         = 0xA;
+
+bool WebSocketFrameType::isDefined(int opcode) {
+    return (opcode >= 0x0 && opcode <= 0x2) || (opcode >= 0x8 && opcode <= 0xA);
+}
+
+const WebSocketFrameType& WebSocketFrameType::valueOf(int opcode) {
+    switch (opcode) {
+    case 0x0: return CONTINUATION;
+    case 0x1: return TEXT;
+    case 0x2: return BINARY;
+    case 0x8: return CLOSE;
+    case 0x9: return PING;
+    case 0xA: return PONG;
+
+    default:
+        throw InvalidArgumentException(
+            std::string("reserved web socket opcode: ") + Integer::toString(opcode));
+    }
+}
+
+std::string WebSocketFrameType::toString() const {
+    switch (m_value) {
+    case 0x0: return "CONTINUATION";
+    case 0x1: return "TEXT";
+    case 0x2: return "BINARY";
+    case 0x8: return "CLOSE";
+    case 0x9: return "PING";
+    case 0xA: return "PONG";
+
+    default:
+        return "UNKNOWN";
+    }
+}
+
+}}}}}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/websocketx/WebSocketPerMessageDeflateDecoder.h"
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/handler/codec/compression/ZlibWrapper.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketFrame.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::handler::codec::compression;
+
+// the empty stored block ending a sync flush, which the peer strips.
+static const char TRAILER[] = { 0x00, 0x00, static_cast<char>(0xFF), static_cast<char>(0xFF) };
+
+ChannelHandlerPtr WebSocketPerMessageDeflateDecoder::clone() {
+    return ChannelHandlerPtr(new WebSocketPerMessageDeflateDecoder(noContextTakeover));
+}
+
+ChannelMessage WebSocketPerMessageDeflateDecoder::decode(ChannelHandlerContext& ctx,
+        Channel& channel,
+        const ChannelMessage& msg) {
+    WebSocketFramePtr frame = msg.smartPointer<WebSocketFrame>();
+
+    if (!frame || frame->isControl()) {
+        return msg;
+    }
+
+    if (frame->getType() != WebSocketFrameType::CONTINUATION) {
+        decompressing = (frame->getRsv() & WebSocketFrame::RSV1) != 0;
+    }
+
+    if (!decompressing) {
+        return msg;
+    }
+
+    if (!inflater) {
+        inflater.reset(new ZlibInflater(ZlibWrapper::NONE));
+    }
+
+    ChannelBufferPtr data = inflater->inflate(frame->getBinaryData());
+
+    if (frame->isFinalFragment()) {
+        ChannelBufferPtr tail = inflater->inflate(
+                                    ChannelBuffers::copiedBuffer(ConstArray(TRAILER, sizeof(TRAILER))));
+
+        if (tail->readable()) {
+            data = data->readable() ? ChannelBuffers::wrappedBuffer(data, tail) : tail;
+        }
+
+        if (noContextTakeover) {
+            inflater.reset();
+        }
+    }
+
+    return ChannelMessage(WebSocketFramePtr(new WebSocketFrame(frame->getType(),
+                          frame->isFinalFragment(),
+                          frame->getRsv() & ~WebSocketFrame::RSV1,
+                          data)));
+}
+
+}}}}}
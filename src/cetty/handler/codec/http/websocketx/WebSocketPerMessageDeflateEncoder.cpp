@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/websocketx/WebSocketPerMessageDeflateEncoder.h"
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/handler/codec/compression/ZlibWrapper.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketFrame.h"
+#include "cetty/util/Exception.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::util;
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::handler::codec::compression;
+
+// the empty stored block ending a sync flush.
+static const int TRAILER_LENGTH = 4;
+
+WebSocketPerMessageDeflateEncoder::WebSocketPerMessageDeflateEncoder()
+    : compressionLevel(ZlibDeflater::DEFAULT_COMPRESSION_LEVEL),
+      noContextTakeover(true),
+      compressing(false) {
+}
+
+WebSocketPerMessageDeflateEncoder::WebSocketPerMessageDeflateEncoder(
+    int compressionLevel,
+    bool noContextTakeover)
+    : compressionLevel(compressionLevel),
+      noContextTakeover(noContextTakeover),
+      compressing(false) {
+    if (compressionLevel < 0 || compressionLevel > 9) {
+        throw InvalidArgumentException("compressionLevel must be in [0, 9].");
+    }
+}
+
+ChannelHandlerPtr WebSocketPerMessageDeflateEncoder::clone() {
+    return ChannelHandlerPtr(
+               new WebSocketPerMessageDeflateEncoder(compressionLevel, noContextTakeover));
+}
+
+ChannelMessage WebSocketPerMessageDeflateEncoder::encode(ChannelHandlerContext& ctx,
+        Channel& channel,
+        const ChannelMessage& msg) {
+    WebSocketFramePtr frame = msg.smartPointer<WebSocketFrame>();
+
+    if (!frame || frame->isControl()) {
+        return msg;
+    }
+
+    bool firstFrame = frame->getType() != WebSocketFrameType::CONTINUATION;
+
+    if (firstFrame) {
+        // a message compressed by the user is sent as it is.
+        compressing = (frame->getRsv() & WebSocketFrame::RSV1) == 0;
+    }
+
+    if (!compressing) {
+        return msg;
+    }
+
+    if (!deflater) {
+        deflater.reset(new ZlibDeflater(ZlibWrapper::NONE, compressionLevel));
+    }
+
+    ChannelBufferPtr compressed = deflater->deflate(frame->getBinaryData(), true);
+
+    if (frame->isFinalFragment()) {
+        int length = compressed->readableBytes();
+
+        if (length >= TRAILER_LENGTH) {
+            compressed = compressed->slice(compressed->readerIndex(),
+                                           length - TRAILER_LENGTH);
+        }
+
+        if (noContextTakeover) {
+            deflater.reset();
+        }
+    }
+
+    int rsv = frame->getRsv() | (firstFrame ? WebSocketFrame::RSV1 : 0);
+
+    return ChannelMessage(WebSocketFramePtr(new WebSocketFrame(frame->getType(),
+                          frame->isFinalFragment(),
+                          rsv,
+                          compressed)));
+}
+
+}}}}}
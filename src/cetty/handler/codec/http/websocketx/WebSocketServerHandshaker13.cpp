@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/websocketx/WebSocketServerHandshaker13.h"
+
+#include <boost/bind.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelPipeline.h"
+#include "cetty/channel/ChannelEventLoop.h"
+#include "cetty/channel/ChannelHandlerContext.h"
+#include "cetty/channel/ChannelUpstreamHandler.h"
+#include "cetty/channel/UpstreamMessageEvent.h"
+#include "cetty/channel/ChannelFutureListener.h"
+#include "cetty/handler/codec/http/HttpHeaders.h"
+#include "cetty/handler/codec/http/HttpMethod.h"
+#include "cetty/handler/codec/http/HttpVersion.h"
+#include "cetty/handler/codec/http/HttpServerCodec.h"
+#include "cetty/handler/codec/http/HttpChunkAggregator.h"
+#include "cetty/handler/codec/http/HttpRequestDecoder.h"
+#include "cetty/handler/codec/http/HttpResponseEncoder.h"
+#include "cetty/handler/codec/http/HttpResponseStatus.h"
+#include "cetty/handler/codec/http/DefaultHttpResponse.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketUtil.h"
+#include "cetty/handler/codec/http/websocketx/WebSocket13FrameDecoder.h"
+#include "cetty/handler/codec/http/websocketx/WebSocket13FrameEncoder.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketPerMessageDeflateDecoder.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketPerMessageDeflateEncoder.h"
+#include "cetty/util/Exception.h"
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::util;
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::handler::codec::frame;
+using namespace cetty::handler::codec::http;
+
+const std::string WebSocketServerHandshaker13::VERSION = "13";
+const std::string WebSocketServerHandshaker13::PERMESSAGE_DEFLATE = "permessage-deflate";
+
+typedef std::vector<std::string> StringList;
+
+// splits the comma separated list of the header values, which may be
+// repeated, into its trimmed items.
+static void splitList(const StringList& values, char separator, StringList& items) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        StringList parts;
+        boost::split(parts, values[i], boost::is_any_of(std::string(1, separator)));
+
+        for (size_t j = 0; j < parts.size(); ++j) {
+            boost::trim(parts[j]);
+            if (!parts[j].empty()) {
+                items.push_back(parts[j]);
+            }
+        }
+    }
+}
+
+static bool containsToken(const StringList& values, const std::string& token) {
+    StringList tokens;
+    splitList(values, ',', tokens);
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (boost::iequals(tokens[i], token)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+WebSocketServerHandshaker13::WebSocketServerHandshaker13(
+    const std::string& subprotocols,
+    bool allowExtensions)
+    : allowExtensions(allowExtensions),
+      maxFramePayloadLength(WebSocket13FrameDecoder::DEFAULT_MAX_FRAME_PAYLOAD_LENGTH),
+      deflateNegotiated(false) {
+    splitList(StringList(1, subprotocols), ',', this->subprotocols);
+}
+
+WebSocketServerHandshaker13::WebSocketServerHandshaker13(
+    const std::string& subprotocols,
+    bool allowExtensions,
+    int maxFramePayloadLength)
+    : allowExtensions(allowExtensions),
+      maxFramePayloadLength(maxFramePayloadLength),
+      deflateNegotiated(false) {
+    splitList(StringList(1, subprotocols), ',', this->subprotocols);
+}
+
+bool WebSocketServerHandshaker13::isUpgradeRequest(const HttpRequest& request) {
+    return request.getMethod().compareTo(HttpMethod::HM_GET) == 0
+           && containsToken(request.getHeaders(HttpHeaders::Names::UPGRADE),
+                            HttpHeaders::Values::WEBSOCKET)
+           && containsToken(request.getHeaders(HttpHeaders::Names::CONNECTION),
+                            HttpHeaders::Values::UPGRADE);
+}
+
+ChannelFuturePtr WebSocketServerHandshaker13::sendUnsupportedVersionResponse(
+    Channel& channel) {
+    HttpResponsePtr response(new DefaultHttpResponse(HttpVersion::HTTP_1_1,
+                             HttpResponseStatus::UPGRADE_REQUIRED));
+
+    response->setHeader(HttpHeaders::Names::SEC_WEBSOCKET_VERSION, VERSION);
+    HttpHeaders::setContentLength(*response, 0);
+
+    return channel.write(ChannelMessage(response));
+}
+
+ChannelFuturePtr WebSocketServerHandshaker13::handshake(Channel& channel,
+        const HttpRequest& request) {
+    // the HTTP decoder is replaced in the event loop, after the current
+    // event, so it is never reentered.
+    if (!channel.getEventLoop()) {
+        throw IllegalStateException("the channel to upgrade has no event loop.");
+    }
+
+    bool clientNoContextTakeover = false;
+    HttpResponsePtr response = newHandshakeResponse(request, &clientNoContextTakeover);
+
+    // the response is encoded by the HTTP encoder during the write.
+    ChannelFuturePtr future = channel.write(ChannelMessage(response));
+    upgradePipeline(channel, clientNoContextTakeover);
+
+    return future;
+}
+
+ChannelFuturePtr WebSocketServerHandshaker13::close(Channel& channel,
+        const WebSocketFramePtr& frame) {
+    ChannelFuturePtr future = channel.write(ChannelMessage(frame));
+    future->addListener(ChannelFutureListener::CLOSE);
+    return future;
+}
+
+HttpResponsePtr WebSocketServerHandshaker13::newHandshakeResponse(
+    const HttpRequest& request,
+    bool* clientNoContextTakeover) {
+    if (!isUpgradeRequest(request)) {
+        throw InvalidArgumentException("not a web socket upgrade request.");
+    }
+
+    if (request.getHeader(HttpHeaders::Names::SEC_WEBSOCKET_VERSION) != VERSION) {
+        throw InvalidArgumentException("unsupported web socket version.");
+    }
+
+    std::string key = request.getHeader(HttpHeaders::Names::SEC_WEBSOCKET_KEY);
+    boost::trim(key);
+
+    if (key.empty()) {
+        throw InvalidArgumentException("missing Sec-WebSocket-Key.");
+    }
+
+    HttpResponsePtr response(new DefaultHttpResponse(HttpVersion::HTTP_1_1,
+                             HttpResponseStatus::SWITCHING_PROTOCOLS));
+
+    response->setHeader(HttpHeaders::Names::UPGRADE, HttpHeaders::Values::WEBSOCKET);
+    response->setHeader(HttpHeaders::Names::CONNECTION, HttpHeaders::Values::UPGRADE);
+    response->setHeader(HttpHeaders::Names::SEC_WEBSOCKET_ACCEPT,
+                        WebSocketUtil::calculateAccept(key));
+
+    StringList protocols =
+        request.getHeaders(HttpHeaders::Names::SEC_WEBSOCKET_PROTOCOL);
+    selectedSubprotocol.clear();
+
+    if (!protocols.empty()) {
+        StringList requested;
+        splitList(protocols, ',', requested);
+
+        for (size_t i = 0; i < requested.size() && selectedSubprotocol.empty(); ++i) {
+            selectedSubprotocol = selectSubprotocol(requested[i]);
+        }
+
+        if (!selectedSubprotocol.empty()) {
+            response->setHeader(HttpHeaders::Names::SEC_WEBSOCKET_PROTOCOL,
+                                selectedSubprotocol);
+        }
+    }
+
+    deflateNegotiated = false;
+    *clientNoContextTakeover = false;
+
+    if (allowExtensions) {
+        StringList extensions =
+            request.getHeaders(HttpHeaders::Names::SEC_WEBSOCKET_EXTENSIONS);
+
+        StringList offers;
+        splitList(extensions, ',', offers);
+
+        for (size_t i = 0; i < offers.size() && !deflateNegotiated; ++i) {
+            deflateNegotiated = acceptDeflate(offers[i], clientNoContextTakeover);
+        }
+
+        if (deflateNegotiated) {
+            std::string accepted(PERMESSAGE_DEFLATE);
+            accepted += "; server_no_context_takeover";
+
+            if (*clientNoContextTakeover) {
+                accepted += "; client_no_context_takeover";
+            }
+
+            response->setHeader(HttpHeaders::Names::SEC_WEBSOCKET_EXTENSIONS, accepted);
+        }
+    }
+
+    return response;
+}
+
+std::string WebSocketServerHandshaker13::selectSubprotocol(
+    const std::string& requested) const {
+    for (size_t i = 0; i < subprotocols.size(); ++i) {
+        if (subprotocols[i] == "*" || subprotocols[i] == requested) {
+            return requested;
+        }
+    }
+
+    return std::string();
+}
+
+bool WebSocketServerHandshaker13::acceptDeflate(const std::string& offer,
+        bool* clientNoContextTakeover) {
+    StringList parameters;
+    splitList(StringList(1, offer), ';', parameters);
+
+    if (parameters.empty() || !boost::iequals(parameters[0], PERMESSAGE_DEFLATE)) {
+        return false;
+    }
+
+    bool noContextTakeover = false;
+
+    for (size_t i = 1; i < parameters.size(); ++i) {
+        std::string name = parameters[i].substr(0, parameters[i].find('='));
+        boost::trim(name);
+
+        if (boost::iequals(name, "client_no_context_takeover")) {
+            noContextTakeover = true;
+        }
+        else if (boost::iequals(name, "client_max_window_bits")
+                 || boost::iequals(name, "server_no_context_takeover")) {
+            // the client may use any window, and the server always drops
+            // its context.
+            continue;
+        }
+        else {
+            // a smaller server window or an unknown parameter.
+            return false;
+        }
+    }
+
+    *clientNoContextTakeover = noContextTakeover;
+    return true;
+}
+
+// returns the HTTP decoder of the decoder or the codec handler.
+static FrameDecoder* getHttpDecoder(const ChannelHandlerPtr& handler) {
+    boost::intrusive_ptr<HttpServerCodec> codec =
+        boost::dynamic_pointer_cast<HttpServerCodec>(handler);
+
+    if (codec) {
+        return &codec->getDecoder();
+    }
+
+    return boost::dynamic_pointer_cast<HttpRequestDecoder>(handler).get();
+}
+
+void WebSocketServerHandshaker13::upgradePipeline(Channel& channel,
+        bool clientNoContextTakeover) {
+    ChannelPipeline& pipeline = channel.getPipeline();
+    ChannelPipeline::ChannelHandlers handlers = pipeline.toMap();
+
+    std::string codecName;
+    std::string decoderName;
+    std::string encoderName;
+    std::string aggregatorName;
+
+    for (size_t i = 0; i < handlers.size(); ++i) {
+        const ChannelHandlerPtr& handler = handlers[i].second;
+
+        if (boost::dynamic_pointer_cast<HttpServerCodec>(handler)) {
+            codecName = handlers[i].first;
+        }
+        else if (boost::dynamic_pointer_cast<HttpRequestDecoder>(handler)) {
+            decoderName = handlers[i].first;
+        }
+        else if (boost::dynamic_pointer_cast<HttpResponseEncoder>(handler)) {
+            encoderName = handlers[i].first;
+        }
+        else if (boost::dynamic_pointer_cast<HttpChunkAggregator>(handler)) {
+            aggregatorName = handlers[i].first;
+        }
+    }
+
+    if (codecName.empty() && (decoderName.empty() || encoderName.empty())) {
+        throw IllegalStateException("no HTTP codec in the pipeline to upgrade.");
+    }
+
+    // the encoder is not on the call stack, so the frames written right
+    // after the handshake are encoded at once.  The HTTP encoder of the
+    // codec passes the encoded frames through.
+    ChannelHandlerPtr encoder(new WebSocket13FrameEncoder(false));
+
+    if (!codecName.empty()) {
+        pipeline.addAfter(codecName, "wsencoder", encoder);
+    }
+    else {
+        pipeline.replace(encoderName, "wsencoder", encoder);
+    }
+
+    if (deflateNegotiated) {
+        // the deflater precedes the frame encoder downstream.
+        pipeline.addAfter("wsencoder", "wsdeflater", ChannelHandlerPtr(
+                              new WebSocketPerMessageDeflateEncoder(
+                                  ZlibDeflater::DEFAULT_COMPRESSION_LEVEL, true)));
+    }
+
+    // the handshake is usually answered by a handler of the decoded
+    // request, while the HTTP decoder and the aggregator are still on the
+    // call stack.  The HTTP decoder keeps the bytes after the request, and
+    // is replaced after the current event.
+    std::string httpDecoderName = codecName.empty() ? decoderName : codecName;
+    getHttpDecoder(pipeline.get(httpDecoderName))->stopDecoding();
+
+    // released by the task, so a channel closed in the meantime is not
+    // deleted before it.
+    channel.retain();
+    channel.getEventLoop()->execute(
+        boost::bind(&WebSocketServerHandshaker13::upgradeDecoder,
+                    &channel,
+                    httpDecoderName,
+                    aggregatorName,
+                    deflateNegotiated,
+                    clientNoContextTakeover,
+                    maxFramePayloadLength));
+}
+
+namespace {
+
+class ChannelReleaser {
+public:
+    ChannelReleaser(Channel* channel) : channel(channel) {}
+    ~ChannelReleaser() { channel->release(); }
+
+private:
+    Channel* channel;
+};
+
+}
+
+void WebSocketServerHandshaker13::upgradeDecoder(Channel* channel,
+        const std::string& httpDecoderName,
+        const std::string& aggregatorName,
+        bool deflateNegotiated,
+        bool clientNoContextTakeover,
+        int maxFramePayloadLength) {
+    ChannelReleaser releaser(channel);
+    ChannelPipeline& pipeline = channel->getPipeline();
+    ChannelHandlerPtr httpDecoder = pipeline.get(httpDecoderName);
+
+    if (!httpDecoder) {
+        return;
+    }
+
+    ChannelBufferPtr undecoded = getHttpDecoder(httpDecoder)->takeUndecoded();
+
+    if (!aggregatorName.empty() && pipeline.get(aggregatorName)) {
+        pipeline.remove(aggregatorName);
+    }
+
+    pipeline.replace(httpDecoderName, "wsdecoder", ChannelHandlerPtr(
+                         new WebSocket13FrameDecoder(true,
+                                                     deflateNegotiated,
+                                                     maxFramePayloadLength)));
+
+    if (deflateNegotiated) {
+        // the inflater follows the frame decoder upstream.
+        pipeline.addAfter("wsdecoder", "wsinflater", ChannelHandlerPtr(
+                              new WebSocketPerMessageDeflateDecoder(clientNoContextTakeover)));
+    }
+
+    // the frames received together with, or right after the request.
+    if (!undecoded) {
+        return;
+    }
+
+    ChannelHandlerContext* ctx = pipeline.getContext("wsdecoder");
+
+    try {
+        ctx->getUpstreamHandler()->messageReceived(*ctx,
+                UpstreamMessageEvent(*channel,
+                                     ChannelMessage(undecoded),
+                                     channel->getRemoteAddress()));
+    }
+    catch (const Exception& e) {
+        Channels::fireExceptionCaught(*ctx, e);
+    }
+    catch (const std::exception& e) {
+        Channels::fireExceptionCaught(*ctx, Exception(e.what()));
+    }
+    catch (...) {
+        Channels::fireExceptionCaught(*ctx, Exception("Unknow Exception"));
+    }
+}
+
+}}}}}
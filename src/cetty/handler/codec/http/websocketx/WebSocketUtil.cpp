@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/codec/http/websocketx/WebSocketUtil.h"
+
+#include <algorithm>
+#include <boost/cstdint.hpp>
+
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define CETTY_WEBSOCKETUTIL_SSE2 1
+#include <emmintrin.h>
+
+#if defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#define CETTY_WEBSOCKETUTIL_AVX2 1
+#define CETTY_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+#endif
+
+namespace cetty { namespace handler { namespace codec { namespace http { namespace websocketx { 
+
+using namespace cetty::buffer;
+
+const std::string WebSocketUtil::ACCEPT_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// the key repeated from the key offset, so a vector of it lines up with
+// the bytes from the offset.
+static void repeatKey(const char* key, int keyOffset, char* repeated, int size) {
+    for (int i = 0; i < size; ++i) {
+        repeated[i] = key[(keyOffset + i) & 3];
+    }
+}
+
+static int maskScalar(char* bytes, int length, const char* key, int keyOffset) {
+    for (int i = 0; i < length; ++i) {
+        bytes[i] ^= key[keyOffset];
+        keyOffset = (keyOffset + 1) & 3;
+    }
+
+    return keyOffset;
+}
+
+#if defined(CETTY_WEBSOCKETUTIL_SSE2)
+
+static int maskSse2(char* bytes, int length, const char* key, int keyOffset) {
+    char repeated[16];
+    repeatKey(key, keyOffset, repeated, 16);
+
+    __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(repeated));
+    int i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i* p = reinterpret_cast<__m128i*>(bytes + i);
+        _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), k));
+    }
+
+    // 16 is a multiple of the key size, so the offset is unchanged.
+    return maskScalar(bytes + i, length - i, key, keyOffset);
+}
+
+#endif
+
+#if defined(CETTY_WEBSOCKETUTIL_AVX2)
+
+CETTY_AVX2_TARGET
+static int maskAvx2(char* bytes, int length, const char* key, int keyOffset) {
+    char repeated[32];
+    repeatKey(key, keyOffset, repeated, 32);
+
+    __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(repeated));
+    int i = 0;
+
+    for (; i + 64 <= length; i += 64) {
+        __m256i* p0 = reinterpret_cast<__m256i*>(bytes + i);
+        __m256i* p1 = reinterpret_cast<__m256i*>(bytes + i + 32);
+        _mm256_storeu_si256(p0, _mm256_xor_si256(_mm256_loadu_si256(p0), k));
+        _mm256_storeu_si256(p1, _mm256_xor_si256(_mm256_loadu_si256(p1), k));
+    }
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i* p = reinterpret_cast<__m256i*>(bytes + i);
+        _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), k));
+    }
+
+    return maskSse2(bytes + i, length - i, key, keyOffset);
+}
+
+static bool hasAvx2() {
+    static const bool supported = (__builtin_cpu_init(),
+                                   __builtin_cpu_supports("avx2") != 0);
+    return supported;
+}
+
+#endif
+
+// the vector loops do not pay off for a few bytes.
+static const int MIN_VECTOR_LENGTH = 16;
+
+int WebSocketUtil::mask(char* bytes, int length, const char* key, int keyOffset) {
+    keyOffset &= 3;
+
+    if (!bytes || length <= 0) {
+        return keyOffset;
+    }
+
+    if (length < MIN_VECTOR_LENGTH) {
+        return maskScalar(bytes, length, key, keyOffset);
+    }
+
+#if defined(CETTY_WEBSOCKETUTIL_AVX2)
+    if (hasAvx2()) {
+        return maskAvx2(bytes, length, key, keyOffset);
+    }
+#endif
+#if defined(CETTY_WEBSOCKETUTIL_SSE2)
+    return maskSse2(bytes, length, key, keyOffset);
+#else
+    return maskScalar(bytes, length, key, keyOffset);
+#endif
+}
+
+void WebSocketUtil::mask(const ChannelBufferPtr& buffer, const char* key) {
+    int index = buffer->readerIndex();
+    int end = buffer->writerIndex();
+    int keyOffset = 0;
+
+    ConstArray region;
+
+    while (index < end) {
+        int start = buffer->getContiguousBytes(index, region);
+
+        if (start < 0) {
+            break;
+        }
+
+        // the bytes belong to the buffer, which is writable,
+        // only the accessor is const.
+        int regionEnd = std::min(start + region.length(), end);
+        char* bytes = const_cast<char*>(region.data()) + (index - start);
+        keyOffset = mask(bytes, regionEnd - index, key, keyOffset);
+        index = regionEnd;
+    }
+
+    if (index < end) {
+        std::string bytes;
+        buffer->getBytes(index, bytes, end - index);
+        mask(&bytes[0], static_cast<int>(bytes.size()), key, keyOffset);
+        buffer->setBytes(index, ConstArray::fromString(bytes));
+    }
+}
+
+static inline boost::uint32_t rotateLeft(boost::uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+std::string WebSocketUtil::sha1(const std::string& data) {
+    boost::uint32_t h[5] = {
+        0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+    };
+
+    // pads with 0x80, zeros and the 64 bits length in bits.
+    std::string message(data);
+    boost::uint64_t bitLength = static_cast<boost::uint64_t>(data.size()) * 8;
+
+    message += static_cast<char>(0x80);
+    while (message.size() % 64 != 56) {
+        message += static_cast<char>(0);
+    }
+    for (int i = 7; i >= 0; --i) {
+        message += static_cast<char>((bitLength >> (i * 8)) & 0xFF);
+    }
+
+    boost::uint32_t w[80];
+
+    for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        for (int i = 0; i < 16; ++i) {
+            const unsigned char* p =
+                reinterpret_cast<const unsigned char*>(message.data() + chunk + i * 4);
+            w[i] = (static_cast<boost::uint32_t>(p[0]) << 24) |
+                   (static_cast<boost::uint32_t>(p[1]) << 16) |
+                   (static_cast<boost::uint32_t>(p[2]) << 8) |
+                   static_cast<boost::uint32_t>(p[3]);
+        }
+
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        boost::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+
+        for (int i = 0; i < 80; ++i) {
+            boost::uint32_t f, k;
+
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            }
+            else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            }
+            else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            }
+            else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+
+            boost::uint32_t temp = rotateLeft(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotateLeft(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::string digest;
+    digest.reserve(20);
+
+    for (int i = 0; i < 5; ++i) {
+        digest += static_cast<char>((h[i] >> 24) & 0xFF);
+        digest += static_cast<char>((h[i] >> 16) & 0xFF);
+        digest += static_cast<char>((h[i] >> 8) & 0xFF);
+        digest += static_cast<char>(h[i] & 0xFF);
+    }
+
+    return digest;
+}
+
+std::string WebSocketUtil::base64(const std::string& data) {
+    static const char ALPHABET[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string encoded;
+    encoded.reserve((data.size() + 2) / 3 * 4);
+
+    size_t i = 0;
+    for (; i + 3 <= data.size(); i += 3) {
+        boost::uint32_t triple =
+            (static_cast<unsigned char>(data[i]) << 16) |
+            (static_cast<unsigned char>(data[i + 1]) << 8) |
+            static_cast<unsigned char>(data[i + 2]);
+
+        encoded += ALPHABET[(triple >> 18) & 0x3F];
+        encoded += ALPHABET[(triple >> 12) & 0x3F];
+        encoded += ALPHABET[(triple >> 6) & 0x3F];
+        encoded += ALPHABET[triple & 0x3F];
+    }
+
+    size_t remaining = data.size() - i;
+    if (remaining) {
+        boost::uint32_t triple = static_cast<unsigned char>(data[i]) << 16;
+        if (remaining == 2) {
+            triple |= static_cast<unsigned char>(data[i + 1]) << 8;
+        }
+
+        encoded += ALPHABET[(triple >> 18) & 0x3F];
+        encoded += ALPHABET[(triple >> 12) & 0x3F];
+        encoded += remaining == 2 ? ALPHABET[(triple >> 6) & 0x3F] : '=';
+        encoded += '=';
+    }
+
+    return encoded;
+}
+
+std::string WebSocketUtil::calculateAccept(const std::string& key) {
+    return base64(sha1(key + ACCEPT_GUID));
+}
+
+const char* WebSocketUtil::getInstructionSet() {
+#if defined(CETTY_WEBSOCKETUTIL_AVX2)
+    if (hasAvx2()) {
+        return "AVX2";
+    }
+#endif
+#if defined(CETTY_WEBSOCKETUTIL_SSE2)
+    return "SSE2";
+#else
+    return "NONE";
+#endif
+}
+
+}}}}}
@@ -191,7 +191,7 @@ const ChannelBufferPtr& ReplayingDecoder::getCumulation(ChannelHandlerContext& c
     }
 
     // input buffer changes (may re allocate memory) which channel owns buffer
-    if (channelOwnBuffer && !cumulation->equals(*input)) {
+    if (channelOwnBuffer && cumulation != input) {
         cumulation = input;
         replayable = ReplayingDecoderBufferPtr(new ReplayingDecoderBuffer(input));
     }
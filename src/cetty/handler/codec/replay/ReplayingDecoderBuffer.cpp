@@ -50,6 +50,10 @@ int ReplayingDecoderBuffer::arrayOffset() const {
     return buffer->arrayOffset();
 }
 
+int ReplayingDecoderBuffer::getContiguousBytes(int index, ConstArray& bytes) const {
+    return buffer->getContiguousBytes(index, bytes);
+}
+
 void ReplayingDecoderBuffer::clear() {
     throw UnreplayableOperationException();
 }
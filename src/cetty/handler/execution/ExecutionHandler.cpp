@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/execution/ExecutionHandler.h"
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/ChannelState.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelHandlerContext.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/ChildChannelStateEvent.h"
+#include "cetty/channel/WriteCompletionEvent.h"
+#include "cetty/channel/ExceptionEvent.h"
+#include "cetty/channel/DefaultExceptionEvent.h"
+#include "cetty/channel/DefaultWriteCompletionEvent.h"
+#include "cetty/channel/DefaultChildChannelStateEvent.h"
+#include "cetty/channel/CopyableUpstreamMessageEvent.h"
+#include "cetty/channel/CopyableUpstreamChannelStateEvent.h"
+#include "cetty/util/Exception.h"
+
+namespace cetty { namespace handler { namespace execution {
+
+using namespace cetty::buffer;
+
+// the size of a message which is not a buffer or a string.
+static const int DEFAULT_MESSAGE_SIZE = 8;
+
+template<typename EventT>
+class ChannelEventRunnable : public OrderedMemoryAwareThreadPool::Runnable {
+public:
+    ChannelEventRunnable(ChannelHandlerContext& ctx, const EventT& e)
+        : ctx(ctx), e(e) {
+    }
+
+    virtual ~ChannelEventRunnable() {}
+
+    virtual void run() {
+        ctx.sendUpstream(e);
+    }
+
+private:
+    ChannelHandlerContext& ctx;
+    EventT e;
+};
+
+ExecutionHandler::ExecutionHandler(const OrderedMemoryAwareThreadPoolPtr& threadPool)
+    : threadPool(threadPool) {
+    if (!threadPool) {
+        throw NullPointerException("threadPool");
+    }
+}
+
+ExecutionHandler::~ExecutionHandler() {
+}
+
+void ExecutionHandler::releaseExternalResources() {
+    threadPool->shutdown();
+}
+
+void ExecutionHandler::handleUpstream(ChannelHandlerContext& ctx,
+                                      const ChannelEvent& e) {
+    // can not copy an event of unknown type.
+    ctx.sendUpstream(e);
+}
+
+void ExecutionHandler::messageReceived(ChannelHandlerContext& ctx,
+                                       const MessageEvent& e) {
+    const ChannelMessage& message = e.getMessage();
+
+    if (message.isChannelBuffer()) {
+        // the I/O thread will write into the read buffer again.
+        const ChannelBufferPtr& buffer = message.value<ChannelBufferPtr>();
+        ChannelMessage copied(buffer->readBytes(buffer->readableBytes()));
+
+        execute(ctx,
+                new ChannelEventRunnable<CopyableUpstreamMessageEvent>(ctx,
+                        CopyableUpstreamMessageEvent(e.getChannel(),
+                                                     copied,
+                                                     e.getRemoteAddress())),
+                estimateSize(copied));
+    }
+    else {
+        execute(ctx,
+                new ChannelEventRunnable<CopyableUpstreamMessageEvent>(ctx,
+                        CopyableUpstreamMessageEvent(e)),
+                estimateSize(message));
+    }
+}
+
+void ExecutionHandler::exceptionCaught(ChannelHandlerContext& ctx,
+                                       const ExceptionEvent& e) {
+    execute(ctx,
+            new ChannelEventRunnable<DefaultExceptionEvent>(ctx,
+                    DefaultExceptionEvent(e.getChannel(), e.getCause())),
+            0);
+}
+
+void ExecutionHandler::writeCompleted(ChannelHandlerContext& ctx,
+                                      const WriteCompletionEvent& e) {
+    execute(ctx,
+            new ChannelEventRunnable<DefaultWriteCompletionEvent>(ctx,
+                    DefaultWriteCompletionEvent(e.getChannel(),
+                                                e.getWrittenAmount())),
+            0);
+}
+
+void ExecutionHandler::channelStateChanged(ChannelHandlerContext& ctx,
+                                           const ChannelStateEvent& e) {
+    execute(ctx,
+            new ChannelEventRunnable<CopyableUpstreamChannelStateEvent>(ctx,
+                    CopyableUpstreamChannelStateEvent(e)),
+            0);
+
+    // the last event of the channel, the queued tasks keep the child alive,
+    // and the child keeps the channel and its pipeline alive.
+    if (e.getState() == ChannelState::OPEN && e.getValue().empty()) {
+        ChildExecutor* child = static_cast<ChildExecutor*>(ctx.getAttachment());
+
+        if (child) {
+            ctx.setAttachment(NULL);
+            child->release();
+        }
+    }
+}
+
+void ExecutionHandler::childChannelStateChanged(ChannelHandlerContext& ctx,
+                                                const ChildChannelStateEvent& e) {
+    execute(ctx,
+            new ChannelEventRunnable<DefaultChildChannelStateEvent>(ctx,
+                    DefaultChildChannelStateEvent(e.getChannel(),
+                                                  e.getChildChannel())),
+            0);
+}
+
+int ExecutionHandler::estimateSize(const ChannelMessage& message) const {
+    if (message.isChannelBuffer()) {
+        return message.value<ChannelBufferPtr>()->readableBytes();
+    }
+    else if (message.isString()) {
+        return static_cast<int>(message.value<std::string>().size());
+    }
+    else if (message.isWideString()) {
+        return static_cast<int>(
+                   message.value<std::wstring>().size() * sizeof(wchar_t));
+    }
+
+    return DEFAULT_MESSAGE_SIZE;
+}
+
+void ExecutionHandler::execute(ChannelHandlerContext& ctx,
+                               Runnable* task,
+                               int size) {
+    ChildExecutor* child = static_cast<ChildExecutor*>(ctx.getAttachment());
+
+    if (child) {
+        threadPool->execute(ChildExecutorPtr(child), task, size);
+        return;
+    }
+
+    ChildExecutorPtr created = threadPool->newChildExecutor(ctx.getChannel());
+
+    if (ctx.getChannel().isOpen()) {
+        // the context holds a reference until the channel is closed.
+        created->duplicate();
+        ctx.setAttachment(created.get());
+    }
+
+    threadPool->execute(created, task, size);
+}
+
+}}}
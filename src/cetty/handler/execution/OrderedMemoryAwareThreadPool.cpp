@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/execution/OrderedMemoryAwareThreadPool.h"
+
+#include <boost/bind.hpp>
+
+#include "cetty/channel/Channel.h"
+#include "cetty/util/Exception.h"
+#include "cetty/logging/InternalLogger.h"
+#include "cetty/logging/InternalLoggerFactory.h"
+
+namespace cetty { namespace handler { namespace execution {
+
+InternalLogger* OrderedMemoryAwareThreadPool::logger =
+    InternalLoggerFactory::getInstance("OrderedMemoryAwareThreadPool");
+
+OrderedMemoryAwareThreadPool::ChildExecutor::ChildExecutor(Channel& channel,
+                                                           int worker)
+    : channel(channel),
+      pendingSize(0),
+      worker(worker),
+      scheduled(false),
+      suspended(false) {
+    channel.retain();
+}
+
+OrderedMemoryAwareThreadPool::ChildExecutor::~ChildExecutor() {
+    // the tasks left when the pool was shut down.
+    while (!tasks.empty()) {
+        delete tasks.front().runnable;
+        tasks.pop_front();
+    }
+
+    channel.release();
+}
+
+int OrderedMemoryAwareThreadPool::ChildExecutor::getPendingSize() const {
+    boost::recursive_mutex::scoped_lock lock(mutex);
+    return pendingSize;
+}
+
+bool OrderedMemoryAwareThreadPool::ChildExecutor::isSuspended() const {
+    boost::recursive_mutex::scoped_lock lock(mutex);
+    return suspended;
+}
+
+OrderedMemoryAwareThreadPool::OrderedMemoryAwareThreadPool(int threadCount,
+        int maxChannelMemorySize,
+        int maxTotalMemorySize)
+    : maxChannelMemorySize(maxChannelMemorySize),
+      maxTotalMemorySize(maxTotalMemorySize),
+      nextWorker(0),
+      totalPendingSize(0),
+      scheduledCount(0),
+      idleCount(0),
+      stopped(false) {
+    if (threadCount <= 0) {
+        throw InvalidArgumentException("threadCount must be a positive integer.");
+    }
+    if (maxChannelMemorySize < 0) {
+        throw InvalidArgumentException("maxChannelMemorySize must not be negative.");
+    }
+    if (maxTotalMemorySize < 0) {
+        throw InvalidArgumentException("maxTotalMemorySize must not be negative.");
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        workers.push_back(WorkerPtr(new Worker));
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        ThreadPtr thread(new boost::thread(
+            boost::bind(&OrderedMemoryAwareThreadPool::run, this, i)));
+        threads.push_back(thread);
+    }
+}
+
+OrderedMemoryAwareThreadPool::~OrderedMemoryAwareThreadPool() {
+    shutdown();
+}
+
+OrderedMemoryAwareThreadPool::ChildExecutorPtr
+OrderedMemoryAwareThreadPool::newChildExecutor(Channel& channel) {
+    unsigned int next = static_cast<unsigned int>(nextWorker.fetch_add(1));
+    return ChildExecutorPtr(
+        new ChildExecutor(channel, static_cast<int>(next % workers.size())));
+}
+
+void OrderedMemoryAwareThreadPool::execute(const ChildExecutorPtr& child,
+        Runnable* task,
+        int size) {
+    if (!child || !task) {
+        delete task;
+        throw NullPointerException("child or task");
+    }
+
+    if (stopped) {
+        delete task;
+        throw IllegalStateException("the thread pool has been shut down.");
+    }
+
+    int index = 0;
+    bool needSchedule = false;
+
+    {
+        boost::recursive_mutex::scoped_lock lock(child->mutex);
+        child->tasks.push_back(ChildExecutor::Task(task, size));
+        child->pendingSize += size;
+        int total = (totalPendingSize += size);
+
+        if (!child->scheduled) {
+            child->scheduled = true;
+            needSchedule = true;
+            index = child->worker;
+        }
+
+        if (!child->suspended
+                && ((maxChannelMemorySize > 0 && child->pendingSize > maxChannelMemorySize)
+                    || (maxTotalMemorySize > 0 && total > maxTotalMemorySize))) {
+            // keep the lock, or a worker may resume the channel before
+            // it is suspended.
+            child->suspended = true;
+            child->channel.setReadable(false);
+        }
+    }
+
+    if (needSchedule) {
+        schedule(child, index);
+    }
+}
+
+void OrderedMemoryAwareThreadPool::shutdown() {
+    boost::mutex::scoped_lock shutdownLock(shutdownMutex);
+
+    stopped = true;
+    {
+        boost::mutex::scoped_lock lock(idleMutex);
+        idleCondition.notify_all();
+    }
+
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        if (threads[i]->joinable()) {
+            threads[i]->join();
+        }
+    }
+}
+
+bool OrderedMemoryAwareThreadPool::isShutdown() const {
+    return stopped;
+}
+
+void OrderedMemoryAwareThreadPool::run(int index) {
+    while (true) {
+        ChildExecutorPtr child = take(index);
+
+        if (!child) {
+            child = steal(index);
+        }
+
+        if (child) {
+            runChild(child, index);
+            continue;
+        }
+
+        if (stopped && scheduledCount <= 0) {
+            break;
+        }
+
+        ++idleCount;
+        {
+            boost::mutex::scoped_lock lock(idleMutex);
+
+            while (scheduledCount <= 0 && !stopped) {
+                idleCondition.wait(lock);
+            }
+        }
+        --idleCount;
+    }
+}
+
+void OrderedMemoryAwareThreadPool::runChild(const ChildExecutorPtr& child,
+        int index) {
+    ChildExecutor::Task task(NULL, 0);
+
+    for (int i = 0; i < MAX_TASKS_PER_RUN; ++i) {
+        {
+            boost::recursive_mutex::scoped_lock lock(child->mutex);
+
+            if (child->tasks.empty()) {
+                child->scheduled = false;
+                return;
+            }
+
+            child->worker = index;
+            task = child->tasks.front();
+            child->tasks.pop_front();
+        }
+
+        try {
+            task.runnable->run();
+        }
+        catch (const Exception& e) {
+            logger->warn("Unexpected exception raised by a task.", e);
+        }
+        catch (const std::exception& e) {
+            logger->warn(std::string("Unexpected exception raised by a task: ") + e.what());
+        }
+        catch (...) {
+            logger->warn("Unknown exception raised by a task.");
+        }
+
+        delete task.runnable;
+        taskDone(*child, task.size);
+    }
+
+    {
+        boost::recursive_mutex::scoped_lock lock(child->mutex);
+
+        if (child->tasks.empty()) {
+            child->scheduled = false;
+            return;
+        }
+    }
+
+    // give the other channels in the deque a chance.
+    schedule(child, index);
+}
+
+void OrderedMemoryAwareThreadPool::schedule(const ChildExecutorPtr& child,
+        int index) {
+    Worker& worker = *workers[index];
+    {
+        boost::mutex::scoped_lock lock(worker.mutex);
+        worker.children.push_back(child);
+        ++scheduledCount;
+    }
+
+    // the idle worker increases idleCount before checking scheduledCount,
+    // so either it sees the child or the child sees it.
+    if (idleCount > 0) {
+        boost::mutex::scoped_lock lock(idleMutex);
+        idleCondition.notify_one();
+    }
+}
+
+OrderedMemoryAwareThreadPool::ChildExecutorPtr
+OrderedMemoryAwareThreadPool::take(int index) {
+    Worker& worker = *workers[index];
+    boost::mutex::scoped_lock lock(worker.mutex);
+
+    if (worker.children.empty()) {
+        return ChildExecutorPtr();
+    }
+
+    ChildExecutorPtr child = worker.children.front();
+    worker.children.pop_front();
+    --scheduledCount;
+    return child;
+}
+
+OrderedMemoryAwareThreadPool::ChildExecutorPtr
+OrderedMemoryAwareThreadPool::steal(int index) {
+    int count = static_cast<int>(workers.size());
+
+    for (int i = 1; i < count; ++i) {
+        Worker& victim = *workers[(index + i) % count];
+        boost::mutex::scoped_lock lock(victim.mutex);
+
+        if (!victim.children.empty()) {
+            ChildExecutorPtr child = victim.children.back();
+            victim.children.pop_back();
+            --scheduledCount;
+            return child;
+        }
+    }
+
+    return ChildExecutorPtr();
+}
+
+void OrderedMemoryAwareThreadPool::taskDone(ChildExecutor& child, int size) {
+    boost::recursive_mutex::scoped_lock lock(child.mutex);
+
+    child.pendingSize -= size;
+    int total = (totalPendingSize -= size);
+
+    if (!child.suspended) {
+        return;
+    }
+
+    bool channelBelow = maxChannelMemorySize == 0
+                        || child.pendingSize <= maxChannelMemorySize / 2;
+    bool totalBelow = maxTotalMemorySize == 0 || total <= maxTotalMemorySize;
+
+    if (child.tasks.empty() || (channelBelow && totalBelow)) {
+        child.suspended = false;
+        child.channel.setReadable(true);
+    }
+}
+
+}}}
@@ -16,12 +16,14 @@
 
 #include "cetty/handler/timeout/IdleStateHandler.h"
 
+#include <boost/bind.hpp>
 #include <boost/thread/thread_time.hpp>
 
 #include "cetty/channel/ChannelHandlerContext.h"
 #include "cetty/channel/ChannelPipeline.h"
 #include "cetty/channel/Channel.h"
 #include "cetty/channel/Channels.h"
+#include "cetty/channel/ChannelEventLoop.h"
 #include "cetty/channel/WriteCompletionEvent.h"
 
 #include "cetty/handler/timeout/DefaultIdleStateEvent.h"
@@ -35,39 +37,55 @@ namespace cetty { namespace handler { namespace timeout {
 using namespace cetty::channel;
 using namespace cetty::util;
 
+static boost::int64_t toIdleTimeMillis(boost::int64_t time, const TimeUnit& unit) {
+    if (time <= 0) {
+        return 0;
+    }
+
+    boost::int64_t millis = unit.toMillis(time);
+    return millis ? millis : 1;
+}
+
 IdleStateHandler::IdleStateHandler(int readerIdleTimeSeconds,
                                    int writerIdleTimeSeconds,
                                    int allIdleTimeSeconds)
     : readerIdleTimeMillis(TimeUnit::SECONDS.toMillis(readerIdleTimeSeconds)),
+      readerTimeoutTask(NULL),
       writerIdleTimeMillis(TimeUnit::SECONDS.toMillis(writerIdleTimeSeconds)),
-      allIdleTimeMillis(TimeUnit::SECONDS.toMillis(allIdleTimeSeconds)) {
+      writerTimeoutTask(NULL),
+      allIdleTimeMillis(TimeUnit::SECONDS.toMillis(allIdleTimeSeconds)),
+      allTimeoutTask(NULL),
+      sweepIntervalMillis(0),
+      sweepGeneration(0) {
 }
 
 IdleStateHandler::IdleStateHandler(boost::int64_t readerIdleTime,
                                    boost::int64_t writerIdleTime,
                                    boost::int64_t allIdleTime,
-                                   const TimeUnit& unit) {
-    if (readerIdleTime <= 0) {
-        readerIdleTimeMillis = 0;
-    }
-    else {
-        readerIdleTimeMillis = unit.toMillis(readerIdleTime);
-        if (!readerIdleTimeMillis) readerIdleTimeMillis = 1;
-    }
-    if (writerIdleTime <= 0) {
-        writerIdleTimeMillis = 0;
-    }
-    else {
-        writerIdleTimeMillis = unit.toMillis(writerIdleTime);
-        if (!writerIdleTimeMillis) writerIdleTimeMillis = 1;
-    }
-    if (allIdleTime <= 0) {
-        allIdleTimeMillis = 0;
-    }
-    else {
-        allIdleTimeMillis = unit.toMillis(allIdleTime);
-        if (!allIdleTime) allIdleTime = 1;
-    }
+                                   const TimeUnit& unit)
+    : readerIdleTimeMillis(toIdleTimeMillis(readerIdleTime, unit)),
+      readerTimeoutTask(NULL),
+      writerIdleTimeMillis(toIdleTimeMillis(writerIdleTime, unit)),
+      writerTimeoutTask(NULL),
+      allIdleTimeMillis(toIdleTimeMillis(allIdleTime, unit)),
+      allTimeoutTask(NULL),
+      sweepIntervalMillis(0),
+      sweepGeneration(0) {
+}
+
+IdleStateHandler::IdleStateHandler(boost::int64_t readerIdleTime,
+                                   boost::int64_t writerIdleTime,
+                                   boost::int64_t allIdleTime,
+                                   boost::int64_t sweepInterval,
+                                   const TimeUnit& unit)
+    : readerIdleTimeMillis(toIdleTimeMillis(readerIdleTime, unit)),
+      readerTimeoutTask(NULL),
+      writerIdleTimeMillis(toIdleTimeMillis(writerIdleTime, unit)),
+      writerTimeoutTask(NULL),
+      allIdleTimeMillis(toIdleTimeMillis(allIdleTime, unit)),
+      allTimeoutTask(NULL),
+      sweepIntervalMillis(toIdleTimeMillis(sweepInterval, unit)),
+      sweepGeneration(0) {
 }
 
 void IdleStateHandler::releaseExternalResources() {
@@ -90,7 +108,7 @@ void IdleStateHandler::beforeAdd(ChannelHandlerContext& ctx) {
 }
 
 void IdleStateHandler::beforeRemove(ChannelHandlerContext& ctx) {
-    destroy();
+    destroy(ctx);
 }
 
 void IdleStateHandler::channelOpen(ChannelHandlerContext& ctx, const ChannelStateEvent& e) {
@@ -102,18 +120,28 @@ void IdleStateHandler::channelOpen(ChannelHandlerContext& ctx, const ChannelStat
 }
 
 void IdleStateHandler::channelClosed(ChannelHandlerContext& ctx, const ChannelStateEvent& e) {
-    destroy();
+    destroy(ctx);
     ctx.sendUpstream(e);
 }
 
 void IdleStateHandler::messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
-    lastReadTime = boost::get_system_time();
+    if (sweepIntervalMillis > 0) {
+        IdleStateSweeper::touch(readerEntry, allEntry);
+    }
+    else {
+        lastReadTime = boost::get_system_time();
+    }
     ctx.sendUpstream(e);
 }
 
 void IdleStateHandler::writeCompleted(ChannelHandlerContext& ctx, const WriteCompletionEvent& e) {
     if (e.getWrittenAmount() > 0) {
-        lastWriteTime = boost::get_system_time();
+        if (sweepIntervalMillis > 0) {
+            IdleStateSweeper::touch(writerEntry, allEntry);
+        }
+        else {
+            lastWriteTime = boost::get_system_time();
+        }
     }
     ctx.sendUpstream(e);
 }
@@ -123,6 +151,7 @@ ChannelHandlerPtr IdleStateHandler::clone() {
         new IdleStateHandler(readerIdleTimeMillis,
                              writerIdleTimeMillis,
                              allIdleTimeMillis,
+                             sweepIntervalMillis,
                              TimeUnit::MILLISECONDS));
 }
 
@@ -134,6 +163,11 @@ void IdleStateHandler::channelIdle(ChannelHandlerContext& ctx,
 }
 
 void IdleStateHandler::initialize(ChannelHandlerContext& ctx) {
+    if (sweepIntervalMillis > 0) {
+        initializeSweep(ctx);
+        return;
+    }
+
     lastReadTime = lastWriteTime = boost::get_system_time();
 
     if (!timer) {
@@ -164,7 +198,95 @@ void IdleStateHandler::initialize(ChannelHandlerContext& ctx) {
     }
 }
 
-void IdleStateHandler::destroy() {
+void IdleStateHandler::initializeSweep(ChannelHandlerContext& ctx) {
+    if (sweeper) {
+        return;
+    }
+
+    if (!timer) {
+        timer = TimerFactory::getFactory().getTimer(ctx.getChannel());
+    }
+
+    Channel& channel = ctx.getChannel();
+    ChannelEventLoop* eventLoop = channel.getEventLoop();
+
+    sweeper = IdleStateSweeper::getSweeper(eventLoop, timer, sweepIntervalMillis);
+
+    // held until the entries are removed.
+    channel.retain();
+
+    // the channel may be opened in another thread, while the sweeper is
+    // only used in the event loop.
+    if (eventLoop) {
+        eventLoop->execute(boost::bind(&IdleStateHandler::addToSweeper,
+                                       ChannelHandlerPtr(this),
+                                       &ctx,
+                                       sweeper,
+                                       sweepGeneration.load()));
+    }
+    else {
+        addToSweeper(ChannelHandlerPtr(this), &ctx, sweeper, sweepGeneration);
+    }
+}
+
+void IdleStateHandler::addToSweeper(const ChannelHandlerPtr& handler,
+                                    ChannelHandlerContext* ctx,
+                                    const IdleStateSweeperPtr& sweeper,
+                                    int generation) {
+    IdleStateHandler& self = *dynamic_cast<IdleStateHandler*>(handler.get());
+
+    if (generation != self.sweepGeneration) {
+        // destroyed already, the context may be gone.
+        return;
+    }
+
+    if (self.readerIdleTimeMillis > 0) {
+        sweeper->add(self.readerEntry, *ctx, self,
+                     IdleState::READER_IDLE, self.readerIdleTimeMillis);
+    }
+    if (self.writerIdleTimeMillis > 0) {
+        sweeper->add(self.writerEntry, *ctx, self,
+                     IdleState::WRITER_IDLE, self.writerIdleTimeMillis);
+    }
+    if (self.allIdleTimeMillis > 0) {
+        sweeper->add(self.allEntry, *ctx, self,
+                     IdleState::ALL_IDLE, self.allIdleTimeMillis);
+    }
+}
+
+void IdleStateHandler::removeFromSweeper(const ChannelHandlerPtr& handler,
+        Channel* channel,
+        const IdleStateSweeperPtr& sweeper) {
+    IdleStateHandler& self = *dynamic_cast<IdleStateHandler*>(handler.get());
+
+    sweeper->remove(self.readerEntry);
+    sweeper->remove(self.writerEntry);
+    sweeper->remove(self.allEntry);
+
+    channel->release();
+}
+
+void IdleStateHandler::destroy(ChannelHandlerContext& ctx) {
+    if (sweeper) {
+        // a pending add is skipped, the removal follows it in the event loop.
+        ++sweepGeneration;
+
+        Channel* channel = &ctx.getChannel();
+        ChannelEventLoop* eventLoop = sweeper->getEventLoop();
+
+        if (eventLoop) {
+            eventLoop->execute(boost::bind(&IdleStateHandler::removeFromSweeper,
+                                           ChannelHandlerPtr(this),
+                                           channel,
+                                           sweeper));
+        }
+        else {
+            removeFromSweeper(ChannelHandlerPtr(this), channel, sweeper);
+        }
+
+        sweeper.reset();
+    }
+
     if (timer) {
         timer.reset();
     }
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/handler/timeout/IdleStateSweeper.h"
+
+#include <boost/bind.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/ChannelEventLoop.h"
+#include "cetty/channel/ChannelHandlerContext.h"
+#include "cetty/handler/timeout/IdleState.h"
+#include "cetty/handler/timeout/IdleStateHandler.h"
+#include "cetty/util/Exception.h"
+
+namespace cetty { namespace handler { namespace timeout {
+
+class IdleStateSweeper::ActivityList {
+public:
+    ActivityList(IdleStateSweeper& sweeper,
+                 const IdleState& state,
+                 boost::int64_t idleTimeMillis)
+        : sweeper(sweeper),
+          state(state),
+          idleTime(boost::posix_time::milliseconds(idleTimeMillis)),
+          head(NULL), tail(NULL) {
+    }
+
+    IdleStateSweeper& sweeper;
+    const IdleState& state;
+    boost::posix_time::time_duration idleTime;
+
+    Entry* head;
+    Entry* tail;
+};
+
+typedef std::pair<std::pair<ChannelEventLoop*, Timer*>, boost::int64_t> SweeperKey;
+typedef std::map<SweeperKey, boost::weak_ptr<IdleStateSweeper> > Sweepers;
+
+static boost::mutex sweepersMutex;
+static Sweepers sweepers;
+
+IdleStateSweeper::IdleStateSweeper(ChannelEventLoop* eventLoop,
+                                   const TimerPtr& timer,
+                                   boost::int64_t sweepIntervalMillis)
+    : eventLoop(eventLoop),
+      timer(timer),
+      sweepIntervalMillis(sweepIntervalMillis),
+      currentTime(boost::get_system_time()),
+      entryCount(0),
+      sweeping(false) {
+    if (!timer) {
+        throw NullPointerException("timer");
+    }
+
+    if (sweepIntervalMillis <= 0) {
+        throw InvalidArgumentException("sweepInterval must be greater than 0");
+    }
+}
+
+IdleStateSweeper::~IdleStateSweeper() {
+    ActivityLists::iterator itr = lists.begin();
+    for (; itr != lists.end(); ++itr) {
+        delete itr->second;
+    }
+
+    boost::mutex::scoped_lock lock(sweepersMutex);
+
+    // a new sweeper may have taken the place already.
+    Sweepers::iterator sweeper = sweepers.find(
+        SweeperKey(std::make_pair(eventLoop, timer.get()), sweepIntervalMillis));
+
+    if (sweeper != sweepers.end() && sweeper->second.expired()) {
+        sweepers.erase(sweeper);
+    }
+}
+
+IdleStateSweeperPtr IdleStateSweeper::getSweeper(ChannelEventLoop* eventLoop,
+        const TimerPtr& timer,
+        boost::int64_t sweepIntervalMillis) {
+    boost::mutex::scoped_lock lock(sweepersMutex);
+
+    boost::weak_ptr<IdleStateSweeper>& weakSweeper = sweepers[
+        SweeperKey(std::make_pair(eventLoop, timer.get()), sweepIntervalMillis)];
+
+    IdleStateSweeperPtr sweeper = weakSweeper.lock();
+    if (!sweeper) {
+        sweeper = IdleStateSweeperPtr(
+            new IdleStateSweeper(eventLoop, timer, sweepIntervalMillis));
+        weakSweeper = sweeper;
+    }
+
+    return sweeper;
+}
+
+void IdleStateSweeper::add(Entry& entry,
+                           ChannelHandlerContext& ctx,
+                           IdleStateHandler& handler,
+                           const IdleState& state,
+                           boost::int64_t idleTimeMillis) {
+    if (entry.list) {
+        return;
+    }
+
+    ActivityList*& list = lists[ListKey(state.value(), idleTimeMillis)];
+    if (!list) {
+        list = new ActivityList(*this, state, idleTimeMillis);
+    }
+
+    // the cached time is not refreshed while there is no sweep.
+    const time_type& time = sweeping ? currentTime : refreshTime();
+
+    entry.ctx = &ctx;
+    entry.handler = &handler;
+    entry.list = list;
+    entry.lastActivityTime = time;
+    entry.deadline = time + list->idleTime;
+    link(entry);
+
+    ++entryCount;
+
+    if (!sweeping) {
+        sweeping = true;
+        scheduleSweep();
+    }
+}
+
+void IdleStateSweeper::remove(Entry& entry) {
+    if (entry.list) {
+        unlink(entry);
+        entry.list = NULL;
+        --entryCount;
+    }
+}
+
+void IdleStateSweeper::touch(Entry& entry, Entry& allEntry) {
+    if (entry.list) {
+        IdleStateSweeper& sweeper = entry.list->sweeper;
+        sweeper.stamp(entry, sweeper.currentTime);
+    }
+
+    if (allEntry.list) {
+        IdleStateSweeper& sweeper = allEntry.list->sweeper;
+        sweeper.stamp(allEntry, sweeper.currentTime);
+    }
+}
+
+void IdleStateSweeper::sweep() {
+    const time_type time = refreshTime();
+
+    ActivityLists::const_iterator itr = lists.begin();
+    for (; itr != lists.end(); ++itr) {
+        ActivityList* list = itr->second;
+
+        for (;;) {
+            // the list is ordered by the deadline, which is the last
+            // activity plus the idle time.
+            Entry* entry = list->head;
+            if (!entry || entry->deadline > time) {
+                break;
+            }
+
+            // triggers again after another idle time, if there is still
+            // no activity.
+            unlink(*entry);
+            entry->deadline = time + list->idleTime;
+            link(*entry);
+
+            // the entry may be removed or stamped by the handlers of the
+            // event, so nothing of it is used after the event.
+            ChannelHandlerContext& ctx = *entry->ctx;
+            IdleStateHandler* handler = entry->handler;
+            time_type lastActivityTime = entry->lastActivityTime;
+
+            if (!ctx.getChannel().isOpen()) {
+                continue;
+            }
+
+            try {
+                handler->channelIdle(ctx, list->state, lastActivityTime);
+            }
+            catch (const Exception& t) {
+                Channels::fireExceptionCaught(ctx, t);
+            }
+            catch (const std::exception& t) {
+                Channels::fireExceptionCaught(ctx, Exception(t.what()));
+            }
+            catch (...) {
+                Channels::fireExceptionCaught(ctx, Exception("Unknow Exception"));
+            }
+        }
+    }
+
+    if (entryCount > 0) {
+        scheduleSweep();
+    }
+    else {
+        sweeping = false;
+    }
+}
+
+void IdleStateSweeper::scheduleSweep() {
+    try {
+        // the pending sweep holds the sweeper.
+        timer->newTimeout(boost::bind(&IdleStateSweeper::expired,
+                                      shared_from_this(),
+                                      _1),
+                          sweepIntervalMillis);
+    }
+    catch (const IllegalStateException&) {
+        // the timer has been stopped.
+        sweeping = false;
+    }
+}
+
+void IdleStateSweeper::expired(const IdleStateSweeperPtr& sweeper,
+                               Timeout& timeout) {
+    if (sweeper->eventLoop) {
+        sweeper->eventLoop->execute(
+            boost::bind(&IdleStateSweeper::sweep, sweeper));
+    }
+    else {
+        sweeper->sweep();
+    }
+}
+
+const IdleStateSweeper::time_type& IdleStateSweeper::refreshTime() {
+    // never goes back, or the lists would be out of order.
+    currentTime = std::max(currentTime, boost::get_system_time());
+    return currentTime;
+}
+
+void IdleStateSweeper::stamp(Entry& entry, const time_type& time) {
+    if (entry.lastActivityTime == time) {
+        // already stamped since the last sweep, the order is not changed.
+        return;
+    }
+
+    unlink(entry);
+    entry.lastActivityTime = time;
+    entry.deadline = time + entry.list->idleTime;
+    link(entry);
+}
+
+void IdleStateSweeper::link(Entry& entry) {
+    ActivityList* list = entry.list;
+
+    entry.prev = list->tail;
+    entry.next = NULL;
+
+    if (list->tail) {
+        list->tail->next = &entry;
+    }
+    else {
+        list->head = &entry;
+    }
+
+    list->tail = &entry;
+}
+
+void IdleStateSweeper::unlink(Entry& entry) {
+    ActivityList* list = entry.list;
+
+    if (entry.prev) {
+        entry.prev->next = entry.next;
+    }
+    else {
+        list->head = entry.next;
+    }
+
+    if (entry.next) {
+        entry.next->prev = entry.prev;
+    }
+    else {
+        list->tail = entry.prev;
+    }
+
+    entry.prev = NULL;
+    entry.next = NULL;
+}
+
+}}}
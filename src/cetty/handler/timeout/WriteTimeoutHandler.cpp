@@ -67,7 +67,7 @@ void WriteTimeoutHandler::writeRequested(ChannelHandlerContext& ctx,
 
         // Set timeout only when getTimeoutMillis() returns a positive value.
         const ChannelFuturePtr& future = e.getFuture();
-        if (future) {
+        if (future && !future->isVoid()) {
             const TimeoutPtr& timeout =
                 timer->newTimeout(boost::bind(&WriteTimeoutHandler::handleWriteTimeout,
                                               this,
@@ -110,7 +110,7 @@ void WriteTimeoutHandler::handleWriteTimeout(Timeout& timeout,
         catch (const Exception& t) {
             // TODO
             // here may have problems:
-            // if the timer is in the different thread (not the default AsioDeadlineTimer)
+            // if the timer is in the different thread (not the default timer of the channel factories)
             // with this pipeline, and user override the 
             // {@link writeTimedOut(ChannelHandlerContext&) writeTimedOut}, 
             // and also unfortunately, the writeTimedOut throw an exception,
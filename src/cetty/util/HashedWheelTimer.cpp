@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/util/HashedWheelTimer.h"
+
+#include <boost/bind.hpp>
+#include <boost/asio/placeholders.hpp>
+
+#include "cetty/logging/InternalLogger.h"
+#include "cetty/logging/InternalLoggerFactory.h"
+#include "cetty/util/Exception.h"
+#include "cetty/util/TimerTask.h"
+#include "cetty/util/TimeUnit.h"
+
+namespace cetty { namespace util {
+
+using namespace cetty::logging;
+
+static InternalLogger* logger =
+    InternalLoggerFactory::getInstance("HashedWheelTimer");
+
+class HashedWheelTimer::HashedWheelTimeout : public cetty::util::Timeout {
+public:
+    HashedWheelTimeout(HashedWheelTimer& timer, TimerTask* task)
+        : state(TIMER_ACTIVE),
+          timer(timer),
+          task(task),
+          remainingRounds(0),
+          bucket(0),
+          prev(NULL),
+          next(NULL) {
+        BOOST_ASSERT(task);
+    }
+
+    HashedWheelTimeout(HashedWheelTimer& timer, const TaskType& function)
+        : state(TIMER_ACTIVE),
+          timer(timer),
+          task(NULL),
+          function(function),
+          remainingRounds(0),
+          bucket(0),
+          prev(NULL),
+          next(NULL) {
+    }
+
+    virtual ~HashedWheelTimeout() {}
+
+    virtual Timer& getTimer() const { return timer; }
+
+    virtual bool isExpired() const { return (state == TIMER_EXPIRED); }
+    virtual bool isCancelled() const { return (state == TIMER_CANCELLED); }
+    virtual bool isActive() const { return (state == TIMER_ACTIVE); }
+
+    virtual int expiresFromNow() const {
+        return static_cast<int>(
+                   (deadline - boost::asio::deadline_timer::traits_type::now())
+                   .total_milliseconds());
+    }
+
+    virtual void cancel() {
+        timer.cancel(*this);
+    }
+
+    void expire() {
+        try {
+            if (task) {
+                task->run(*this);
+            }
+            else if (function) {
+                function(*this);
+            }
+        }
+        catch (const Exception& e) {
+            logger->warn("An exception was thrown by TimerTask.", e);
+        }
+        catch (const std::exception& e) {
+            logger->warn(std::string("An exception was thrown by TimerTask: ") + e.what());
+        }
+
+        releaseTask();
+    }
+
+    // the timeout may outlive its run, as the last scheduled timeout of the
+    // thread or by the caller, but not what the task has bound.
+    void releaseTask() {
+        task = NULL;
+        TaskType().swap(function);
+    }
+
+public:
+    enum {
+        TIMER_CANCELLED      = 1,
+        TIMER_EXPIRED        = 2,
+        TIMER_ACTIVE         = 4,
+    };
+
+    int state;
+    HashedWheelTimer& timer;
+
+    TimerTask* task;
+    TaskType function;
+
+    TimeType deadline;
+    boost::int64_t remainingRounds;
+
+    int bucket;
+    HashedWheelTimeout* prev;
+    HashedWheelTimeout* next;
+};
+
+HashedWheelTimer::HashedWheelTimer(boost::asio::io_service& ioService)
+    : tickDuration(DEFAULT_TICK_DURATION),
+      mask(0),
+      tick(0),
+      pendingCount(0),
+      ticking(false),
+      stopped(false),
+      tickTimer(new boost::asio::deadline_timer(ioService)),
+      tickSource(NULL) {
+    init(DEFAULT_TICK_DURATION, DEFAULT_TICKS_PER_WHEEL);
+}
+
+HashedWheelTimer::HashedWheelTimer(boost::asio::io_service& ioService,
+                                   boost::int64_t tickDuration,
+                                   int ticksPerWheel)
+    : tickDuration(tickDuration),
+      mask(0),
+      tick(0),
+      pendingCount(0),
+      ticking(false),
+      stopped(false),
+      tickTimer(new boost::asio::deadline_timer(ioService)),
+      tickSource(NULL) {
+    init(tickDuration, ticksPerWheel);
+}
+
+HashedWheelTimer::HashedWheelTimer(TickSource& tickSource,
+                                   boost::int64_t tickDuration,
+                                   int ticksPerWheel)
+    : tickDuration(tickDuration),
+      mask(0),
+      tick(0),
+      pendingCount(0),
+      ticking(false),
+      stopped(false),
+      tickSource(&tickSource) {
+    init(tickDuration, ticksPerWheel);
+}
+
+void HashedWheelTimer::init(boost::int64_t tickDuration, int ticksPerWheel) {
+    if (tickDuration <= 0) {
+        throw InvalidArgumentException("tickDuration must be greater than 0");
+    }
+
+    wheel.resize(normalizeTicksPerWheel(ticksPerWheel), NULL);
+    mask = static_cast<int>(wheel.size()) - 1;
+}
+
+HashedWheelTimer::~HashedWheelTimer() {
+    std::vector<TimeoutPtr> cancelled;
+    clear(cancelled);
+}
+
+const TimeoutPtr& HashedWheelTimer::newTimeout(TimerTask& task, boost::int64_t delay) {
+    return schedule(new HashedWheelTimeout(*this, &task), delay);
+}
+
+const TimeoutPtr& HashedWheelTimer::newTimeout(TimerTask& task, boost::int64_t delay, const TimeUnit& unit) {
+    return schedule(new HashedWheelTimeout(*this, &task), unit.toMillis(delay));
+}
+
+const TimeoutPtr& HashedWheelTimer::newTimeout(const TaskType& task, boost::int64_t delay) {
+    return schedule(new HashedWheelTimeout(*this, task), delay);
+}
+
+const TimeoutPtr& HashedWheelTimer::newTimeout(const TaskType& task, boost::int64_t delay, const TimeUnit& unit) {
+    return schedule(new HashedWheelTimeout(*this, task), unit.toMillis(delay));
+}
+
+void HashedWheelTimer::stop() {
+    std::vector<TimeoutPtr> cancelled;
+
+    {
+        boost::mutex::scoped_lock lock(mutex);
+
+        if (stopped) {
+            return;
+        }
+
+        stopped = true;
+        clear(cancelled);
+
+        // the io_service is not touched any more once stopped, it may be
+        // destroyed before the last reference of the timer goes away.
+        if (tickTimer) {
+            boost::system::error_code error;
+            tickTimer->cancel(error);
+            tickTimer.reset();
+        }
+    }
+
+    // the armed tick holds this timer, so it is dropped out of the lock.
+    if (tickSource) {
+        tickSource->cancel();
+    }
+
+    // out of the lock, the tasks may hold anything using the timer.
+    std::size_t j = cancelled.size();
+    for (std::size_t i = 0; i < j; ++i) {
+        static_cast<HashedWheelTimeout*>(cancelled[i].get())->releaseTask();
+    }
+}
+
+int HashedWheelTimer::getPendingCount() const {
+    boost::mutex::scoped_lock lock(mutex);
+    return pendingCount;
+}
+
+const TimeoutPtr& HashedWheelTimer::schedule(HashedWheelTimeout* timeout,
+        boost::int64_t delay) {
+    TimeoutPtr* scheduled = scheduledTimeouts.get();
+    if (!scheduled) {
+        scheduled = new TimeoutPtr;
+        scheduledTimeouts.reset(scheduled);
+    }
+    *scheduled = timeout;
+
+    if (delay < 0) {
+        delay = 0;
+    }
+
+    TimeType now = boost::asio::deadline_timer::traits_type::now();
+    boost::mutex::scoped_lock lock(mutex);
+
+    if (stopped) {
+        throw IllegalStateException("cannot be started once stopped");
+    }
+
+    if (!ticking) {
+        // restarts the ticks from now, the ticks passed while there was
+        // nothing to expire are skipped.
+        startTime = now - boost::posix_time::milliseconds(tickDuration * tick);
+    }
+
+    timeout->deadline = now + boost::posix_time::milliseconds(delay);
+
+    // the first tick at which the deadline has been reached.
+    boost::int64_t elapsed = (timeout->deadline - startTime).total_microseconds();
+    boost::int64_t tickMicros = tickDuration * 1000;
+    boost::int64_t deadlineTick = (elapsed + tickMicros - 1) / tickMicros;
+
+    if (deadlineTick <= tick) {
+        deadlineTick = tick + 1;
+    }
+
+    timeout->remainingRounds = (deadlineTick - tick - 1) / (mask + 1);
+    link(timeout, static_cast<int>(deadlineTick & mask));
+
+    if (!ticking) {
+        startTicking();
+    }
+
+    return *scheduled;
+}
+
+void HashedWheelTimer::cancel(HashedWheelTimeout& timeout) {
+    {
+        boost::mutex::scoped_lock lock(mutex);
+
+        if (timeout.state != HashedWheelTimeout::TIMER_ACTIVE) {
+            return;
+        }
+
+        timeout.state = HashedWheelTimeout::TIMER_CANCELLED;
+
+        // the caller holds the timeout, which will not be deleted here.
+        unlink(&timeout);
+    }
+
+    timeout.releaseTask();
+}
+
+void HashedWheelTimer::startTicking() {
+    ticking = true;
+
+    if (tickSource) {
+        tickSource->expiresAt(getTickTime(tick + 1),
+                              boost::bind(&HashedWheelTimer::onTick,
+                                          boost::intrusive_ptr<HashedWheelTimer>(this),
+                                          boost::system::error_code()));
+        return;
+    }
+
+    tickTimer->expires_at(getTickTime(tick + 1));
+    tickTimer->async_wait(boost::bind(&HashedWheelTimer::onTick,
+                                      boost::intrusive_ptr<HashedWheelTimer>(this),
+                                      boost::asio::placeholders::error));
+}
+
+void HashedWheelTimer::onTick(const boost::system::error_code& error) {
+    std::vector<TimeoutPtr> expired;
+
+    {
+        boost::mutex::scoped_lock lock(mutex);
+
+        if (stopped) {
+            ticking = false;
+            return;
+        }
+
+        // catches up with the ticks missed while the thread was busy.
+        TimeType now = boost::asio::deadline_timer::traits_type::now();
+
+        while (pendingCount > 0 && getTickTime(tick + 1) <= now) {
+            ++tick;
+            expireTimeouts(static_cast<int>(tick & mask), expired);
+        }
+
+        if (pendingCount > 0) {
+            startTicking();
+        }
+        else {
+            ticking = false;
+        }
+    }
+
+    // runs the tasks out of the lock, which may schedule new timeouts.
+    std::size_t j = expired.size();
+    for (std::size_t i = 0; i < j; ++i) {
+        static_cast<HashedWheelTimeout*>(expired[i].get())->expire();
+    }
+}
+
+void HashedWheelTimer::expireTimeouts(int bucket, std::vector<TimeoutPtr>& expired) {
+    HashedWheelTimeout* timeout = wheel[bucket];
+
+    while (timeout) {
+        HashedWheelTimeout* next = timeout->next;
+
+        if (timeout->remainingRounds > 0) {
+            --timeout->remainingRounds;
+        }
+        else {
+            timeout->state = HashedWheelTimeout::TIMER_EXPIRED;
+            expired.push_back(TimeoutPtr(timeout));
+            unlink(timeout);
+        }
+
+        timeout = next;
+    }
+}
+
+void HashedWheelTimer::link(HashedWheelTimeout* timeout, int bucket) {
+    // the wheel holds the timeout until it is unlinked.
+    timeout->duplicate();
+
+    timeout->bucket = bucket;
+    timeout->prev = NULL;
+    timeout->next = wheel[bucket];
+
+    if (wheel[bucket]) {
+        wheel[bucket]->prev = timeout;
+    }
+
+    wheel[bucket] = timeout;
+    ++pendingCount;
+}
+
+void HashedWheelTimer::unlink(HashedWheelTimeout* timeout) {
+    if (timeout->prev) {
+        timeout->prev->next = timeout->next;
+    }
+    else {
+        wheel[timeout->bucket] = timeout->next;
+    }
+
+    if (timeout->next) {
+        timeout->next->prev = timeout->prev;
+    }
+
+    timeout->prev = NULL;
+    timeout->next = NULL;
+    --pendingCount;
+
+    timeout->release();
+}
+
+void HashedWheelTimer::clear(std::vector<TimeoutPtr>& cancelled) {
+    std::size_t j = wheel.size();
+    for (std::size_t i = 0; i < j; ++i) {
+        while (wheel[i]) {
+            HashedWheelTimeout* timeout = wheel[i];
+            timeout->state = HashedWheelTimeout::TIMER_CANCELLED;
+
+            cancelled.push_back(TimeoutPtr(timeout));
+            unlink(timeout);
+        }
+    }
+}
+
+HashedWheelTimer::TimeType HashedWheelTimer::getTickTime(boost::int64_t tick) const {
+    return startTime + boost::posix_time::milliseconds(tickDuration * tick);
+}
+
+int HashedWheelTimer::normalizeTicksPerWheel(int ticksPerWheel) {
+    if (ticksPerWheel <= 0) {
+        throw InvalidArgumentException("ticksPerWheel must be greater than 0");
+    }
+
+    if (ticksPerWheel > 1073741824) {
+        throw InvalidArgumentException("ticksPerWheel may not be greater than 2^30");
+    }
+
+    int normalizedTicksPerWheel = 1;
+    while (normalizedTicksPerWheel < ticksPerWheel) {
+        normalizedTicksPerWheel <<= 1;
+    }
+
+    return normalizedTicksPerWheel;
+}
+
+}}
@@ -41,6 +41,13 @@ void TimerFactory::resetFactory(const TimerFactoryPtr& timerFactory) {
     }
 }
 
+void TimerFactory::resetFactory() {
+    if (factory) {
+        factory->stopTimers();
+        factory.reset();
+    }
+}
+
 TimerFactory& TimerFactory::getFactory() {
     BOOST_ASSERT(factory && "Factory has not been set.");
     if (!factory) {
@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cetty/util/internal/ByteScanner.h"
+
+#include <string.h>
+#include "cetty/util/Exception.h"
+
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define CETTY_BYTESCANNER_SSE2 1
+#include <emmintrin.h>
+
+#if defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#define CETTY_BYTESCANNER_AVX2 1
+#define CETTY_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+#endif
+
+namespace cetty { namespace util { namespace internal {
+
+ByteScanner::ByteSet::ByteSet(char b0, bool negated)
+    : count(1), negated(negated) {
+    values[0] = values[1] = values[2] = values[3] = b0;
+}
+
+ByteScanner::ByteSet::ByteSet(char b0, char b1, bool negated)
+    : count(2), negated(negated) {
+    values[0] = values[2] = values[3] = b0;
+    values[1] = b1;
+}
+
+ByteScanner::ByteSet::ByteSet(const char* bytes, int size, bool negated)
+    : count(size), negated(negated) {
+    if (!bytes || size <= 0 || size > MAX_SIZE) {
+        throw InvalidArgumentException("the size of a ByteSet must be in [1, 4].");
+    }
+
+    for (int i = 0; i < MAX_SIZE; ++i) {
+        values[i] = bytes[i < size ? i : 0];
+    }
+}
+
+static int firstScalar(const char* bytes, int length, const ByteScanner::ByteSet& set) {
+    for (int i = 0; i < length; ++i) {
+        if (set.matches(bytes[i])) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static int lastScalar(const char* bytes, int length, const ByteScanner::ByteSet& set) {
+    for (int i = length - 1; i >= 0; --i) {
+        if (set.matches(bytes[i])) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static int pairScalar(const char* bytes, int length, char first, char second) {
+    for (int i = 0; i + 1 < length; ++i) {
+        if (bytes[i] == first && bytes[i + 1] == second) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+#if defined(CETTY_BYTESCANNER_SSE2)
+
+template<int N>
+static inline int matchSse2(__m128i chunk, const __m128i* needles) {
+    __m128i matched = _mm_cmpeq_epi8(chunk, needles[0]);
+
+    for (int i = 1; i < N; ++i) {
+        matched = _mm_or_si128(matched, _mm_cmpeq_epi8(chunk, needles[i]));
+    }
+
+    return _mm_movemask_epi8(matched);
+}
+
+template<int N>
+static int firstSse2(const char* bytes, int length, const ByteScanner::ByteSet& set) {
+    __m128i needles[N];
+    for (int i = 0; i < N; ++i) {
+        needles[i] = _mm_set1_epi8(set.bytes()[i]);
+    }
+
+    int flip = set.isNegated() ? 0xFFFF : 0;
+    int i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        int mask = matchSse2<N>(chunk, needles) ^ flip;
+
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    int found = firstScalar(bytes + i, length - i, set);
+    return found < 0 ? -1 : i + found;
+}
+
+template<int N>
+static int lastSse2(const char* bytes, int length, const ByteScanner::ByteSet& set) {
+    __m128i needles[N];
+    for (int i = 0; i < N; ++i) {
+        needles[i] = _mm_set1_epi8(set.bytes()[i]);
+    }
+
+    int flip = set.isNegated() ? 0xFFFF : 0;
+    int i = length;
+
+    while (i >= 16) {
+        i -= 16;
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        int mask = matchSse2<N>(chunk, needles) ^ flip;
+
+        if (mask) {
+            return i + 31 - __builtin_clz(mask);
+        }
+    }
+
+    return lastScalar(bytes, i, set);
+}
+
+static int pairSse2(const char* bytes, int length, char first, char second) {
+    __m128i a = _mm_set1_epi8(first);
+    __m128i b = _mm_set1_epi8(second);
+    int i = 0;
+
+    for (; i + 17 <= length; i += 16) {
+        __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 1));
+        int mask = _mm_movemask_epi8(
+                       _mm_and_si128(_mm_cmpeq_epi8(c0, a), _mm_cmpeq_epi8(c1, b)));
+
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    int found = pairScalar(bytes + i, length - i, first, second);
+    return found < 0 ? -1 : i + found;
+}
+
+#endif
+
+#if defined(CETTY_BYTESCANNER_AVX2)
+
+template<int N> CETTY_AVX2_TARGET
+static inline unsigned int matchAvx2(__m256i chunk, const __m256i* needles) {
+    __m256i matched = _mm256_cmpeq_epi8(chunk, needles[0]);
+
+    for (int i = 1; i < N; ++i) {
+        matched = _mm256_or_si256(matched, _mm256_cmpeq_epi8(chunk, needles[i]));
+    }
+
+    return static_cast<unsigned int>(_mm256_movemask_epi8(matched));
+}
+
+template<int N> CETTY_AVX2_TARGET
+static int firstAvx2(const char* bytes, int length, const ByteScanner::ByteSet& set) {
+    __m256i needles[N];
+    for (int i = 0; i < N; ++i) {
+        needles[i] = _mm256_set1_epi8(set.bytes()[i]);
+    }
+
+    unsigned int flip = set.isNegated() ? 0xFFFFFFFFU : 0;
+    int i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+        unsigned int mask = matchAvx2<N>(chunk, needles) ^ flip;
+
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    int found = firstSse2<N>(bytes + i, length - i, set);
+    return found < 0 ? -1 : i + found;
+}
+
+template<int N> CETTY_AVX2_TARGET
+static int lastAvx2(const char* bytes, int length, const ByteScanner::ByteSet& set) {
+    __m256i needles[N];
+    for (int i = 0; i < N; ++i) {
+        needles[i] = _mm256_set1_epi8(set.bytes()[i]);
+    }
+
+    unsigned int flip = set.isNegated() ? 0xFFFFFFFFU : 0;
+    int i = length;
+
+    while (i >= 32) {
+        i -= 32;
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+        unsigned int mask = matchAvx2<N>(chunk, needles) ^ flip;
+
+        if (mask) {
+            return i + 31 - __builtin_clz(mask);
+        }
+    }
+
+    return lastSse2<N>(bytes, i, set);
+}
+
+CETTY_AVX2_TARGET
+static int pairAvx2(const char* bytes, int length, char first, char second) {
+    __m256i a = _mm256_set1_epi8(first);
+    __m256i b = _mm256_set1_epi8(second);
+    int i = 0;
+
+    for (; i + 33 <= length; i += 32) {
+        __m256i c0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+        __m256i c1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i + 1));
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(
+                                _mm256_and_si256(_mm256_cmpeq_epi8(c0, a),
+                                                 _mm256_cmpeq_epi8(c1, b))));
+
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    int found = pairSse2(bytes + i, length - i, first, second);
+    return found < 0 ? -1 : i + found;
+}
+
+static bool hasAvx2() {
+    static const bool supported = (__builtin_cpu_init(),
+                                   __builtin_cpu_supports("avx2") != 0);
+    return supported;
+}
+
+#endif
+
+// the vector loops do not pay off for a few bytes.
+static const int MIN_VECTOR_LENGTH = 16;
+
+template<int N>
+static int first(const char* bytes, int length, const ByteScanner::ByteSet& set) {
+#if defined(CETTY_BYTESCANNER_AVX2)
+    if (hasAvx2()) {
+        return firstAvx2<N>(bytes, length, set);
+    }
+#endif
+#if defined(CETTY_BYTESCANNER_SSE2)
+    return firstSse2<N>(bytes, length, set);
+#else
+    return firstScalar(bytes, length, set);
+#endif
+}
+
+template<int N>
+static int last(const char* bytes, int length, const ByteScanner::ByteSet& set) {
+#if defined(CETTY_BYTESCANNER_AVX2)
+    if (hasAvx2()) {
+        return lastAvx2<N>(bytes, length, set);
+    }
+#endif
+#if defined(CETTY_BYTESCANNER_SSE2)
+    return lastSse2<N>(bytes, length, set);
+#else
+    return lastScalar(bytes, length, set);
+#endif
+}
+
+int ByteScanner::findFirst(const char* bytes, int length, char value) {
+    if (length <= 0) {
+        return -1;
+    }
+
+    // the libc one is vectorized already.
+    const void* found = memchr(bytes, value, length);
+    return found ? static_cast<int>(static_cast<const char*>(found) - bytes) : -1;
+}
+
+int ByteScanner::findFirst(const char* bytes, int length, const ByteSet& set) {
+    if (length < MIN_VECTOR_LENGTH) {
+        return firstScalar(bytes, length, set);
+    }
+
+    switch (set.size()) {
+    case 1:
+        return first<1>(bytes, length, set);
+
+    case 2:
+        return first<2>(bytes, length, set);
+
+    default:
+        return first<ByteSet::MAX_SIZE>(bytes, length, set);
+    }
+}
+
+int ByteScanner::findLast(const char* bytes, int length, char value) {
+    return findLast(bytes, length, ByteSet(value));
+}
+
+int ByteScanner::findLast(const char* bytes, int length, const ByteSet& set) {
+    if (length < MIN_VECTOR_LENGTH) {
+        return lastScalar(bytes, length, set);
+    }
+
+    switch (set.size()) {
+    case 1:
+        return last<1>(bytes, length, set);
+
+    case 2:
+        return last<2>(bytes, length, set);
+
+    default:
+        return last<ByteSet::MAX_SIZE>(bytes, length, set);
+    }
+}
+
+int ByteScanner::findPair(const char* bytes, int length, char first, char second) {
+    if (length < MIN_VECTOR_LENGTH + 1) {
+        return pairScalar(bytes, length, first, second);
+    }
+
+#if defined(CETTY_BYTESCANNER_AVX2)
+    if (hasAvx2()) {
+        return pairAvx2(bytes, length, first, second);
+    }
+#endif
+#if defined(CETTY_BYTESCANNER_SSE2)
+    return pairSse2(bytes, length, first, second);
+#else
+    return pairScalar(bytes, length, first, second);
+#endif
+}
+
+int ByteScanner::findSequence(const char* bytes,
+                              int length,
+                              const char* needle,
+                              int needleLength) {
+    if (needleLength <= 0) {
+        return 0;
+    }
+
+    if (needleLength > length) {
+        return -1;
+    }
+
+    if (needleLength == 1) {
+        return findFirst(bytes, length, needle[0]);
+    }
+
+    // the last index a match can start at.
+    int lastStart = length - needleLength;
+    int from = 0;
+
+    while (from <= lastStart) {
+        // find the first two bytes, then compare the rest.
+        int found = findPair(bytes + from,
+                             lastStart - from + 2,
+                             needle[0],
+                             needle[1]);
+
+        if (found < 0) {
+            return -1;
+        }
+
+        int start = from + found;
+
+        if (memcmp(bytes + start + 2, needle + 2, needleLength - 2) == 0) {
+            return start;
+        }
+
+        from = start + 1;
+    }
+
+    return -1;
+}
+
+const char* ByteScanner::getInstructionSet() {
+#if defined(CETTY_BYTESCANNER_AVX2)
+    if (hasAvx2()) {
+        return "AVX2";
+    }
+#endif
+#if defined(CETTY_BYTESCANNER_SSE2)
+    return "SSE2";
+#else
+    return "NONE";
+#endif
+}
+
+}}}
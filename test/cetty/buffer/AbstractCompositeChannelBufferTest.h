@@ -19,6 +19,7 @@
 
 #include "cetty/buffer/AbstractChannelBufferTest.h"
 #include "cetty/buffer/ArrayUtil.h"
+#include "cetty/buffer/GatheringBuffer.h"
 
 namespace cetty { namespace buffer { 
 
@@ -361,6 +362,47 @@ public:
         ASSERT_FALSE(ChannelBuffers::equals(a, b));
     }
 
+    void testReadSliceGathering() {
+        class Gathering : public GatheringBuffer {
+        public:
+            virtual bool empty() const { return blocks.empty(); }
+            virtual int  blockCount() const { return (int)blocks.size(); }
+            virtual int  bytesCount() const {
+                int bytes = 0;
+                for (size_t i = 0; i < blocks.size(); ++i) {
+                    bytes += blocks[i].second;
+                }
+                return bytes;
+            }
+            virtual void clear() { blocks.clear(); }
+            virtual void append(char* data, int size) {
+                blocks.push_back(std::make_pair(data, size));
+            }
+            virtual std::pair<char*, int> at(int index) { return blocks[index]; }
+
+            std::vector<std::pair<char*, int> > blocks;
+        };
+
+        // more components than the inline blocks of any gathering buffer.
+        std::vector<ChannelBufferPtr> parts;
+        for (int i = 0; i < 20; ++i) {
+            parts.push_back(ChannelBuffers::wrappedBuffer(order, ArrayUtil::create(2, i, i)));
+        }
+
+        ChannelBufferPtr composite = ChannelBuffers::wrappedBuffer(parts);
+        composite->skipBytes(3);
+
+        Gathering gathering;
+        composite->readSlice(gathering);
+
+        ASSERT_EQ(19, gathering.blockCount());
+        ASSERT_EQ(37, gathering.bytesCount());
+        ASSERT_EQ(1, gathering.at(0).second);
+        ASSERT_EQ(1, gathering.at(0).first[0]);
+        ASSERT_EQ(19, gathering.at(18).first[1]);
+        ASSERT_EQ(0, composite->readableBytes());
+    }
+
 private:
     ByteOrder order;
 
@@ -18,3 +18,7 @@ TEST_F(CHANNEL_BUFFER_IMPL_TEST, testWrappedBuffer) {
 TEST_F(CHANNEL_BUFFER_IMPL_TEST, testWrittenBuffersEquals) {
     testWrittenBuffersEquals();
 }
+
+TEST_F(CHANNEL_BUFFER_IMPL_TEST, testReadSliceGathering) {
+    testReadSliceGathering();
+}
@@ -56,3 +56,46 @@ TEST(ChannelBufferIndexFinderTest, testBackward) {
     EXPECT_EQ(-1, buf->indexOf(3, 0, ChannelBufferIndexFinder::CRLF));
 }
 
+TEST(ChannelBufferIndexFinderTest, testScanAcrossComponents) {
+    // 4 copies of the string in 3 uneven components, sliced in the middle.
+    std::string data;
+    for (int i = 0; i < 4; ++i) {
+        data.append(str, 29);
+    }
+
+    ChannelBufferPtr composite = ChannelBuffers::wrappedBuffer(
+        Array((char*)data.data(), 37),
+        Array((char*)data.data() + 37, 50),
+        Array((char*)data.data() + 87, 29));
+    ChannelBufferPtr sliced = composite->slice(5, 100);
+    ChannelBufferPtr heap = ChannelBuffers::copiedBuffer(
+        Array((char*)data.data() + 5, 100));
+
+    const ChannelBufferIndexFinder* finders[] = {
+        &ChannelBufferIndexFinder::CRLF,
+        &ChannelBufferIndexFinder::NOT_CRLF,
+        &ChannelBufferIndexFinder::NUL,
+        &ChannelBufferIndexFinder::NOT_LINEAR_WHITESPACE
+    };
+
+    for (int k = 0; k < 4; ++k) {
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_EQ(heap->indexOf(i, 100, *finders[k]),
+                      sliced->indexOf(i, 100, *finders[k]));
+            ASSERT_EQ(heap->indexOf(i, 0, *finders[k]),
+                      sliced->indexOf(i, 0, *finders[k]));
+        }
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(heap->indexOf(i, 100, (boost::int8_t)'j'),
+                  sliced->indexOf(i, 100, (boost::int8_t)'j'));
+        ASSERT_EQ(heap->indexOf(100, i, (boost::int8_t)'\t'),
+                  sliced->indexOf(100, i, (boost::int8_t)'\t'));
+    }
+
+    ConstArray bytes;
+    ASSERT_EQ(32, sliced->getContiguousBytes(40, bytes));
+    ASSERT_EQ(50, bytes.length());
+    ASSERT_EQ(-1, sliced->getContiguousBytes(100, bytes));
+}
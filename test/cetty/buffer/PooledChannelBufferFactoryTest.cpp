@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/buffer/DynamicChannelBuffer.h"
+#include "cetty/buffer/PooledChannelBufferFactory.h"
+#include "cetty/util/Exception.h"
+
+using namespace cetty::buffer;
+using namespace cetty::util;
+
+static void releaseBuffer(ChannelBufferPtr* buffer) {
+    buffer->reset();
+}
+
+TEST(PooledChannelBufferFactoryTest, testSizeClassOf) {
+    ASSERT_EQ(64, PooledChannelBufferFactory::sizeClassOf(1));
+    ASSERT_EQ(64, PooledChannelBufferFactory::sizeClassOf(64));
+    ASSERT_EQ(128, PooledChannelBufferFactory::sizeClassOf(65));
+    ASSERT_EQ(8192, PooledChannelBufferFactory::sizeClassOf(5000));
+}
+
+TEST(PooledChannelBufferFactoryTest, testGetBuffer) {
+    PooledChannelBufferFactory factory;
+    ChannelBufferPtr buffer = factory.getBuffer(100);
+
+    ASSERT_EQ(100, buffer->capacity());
+    ASSERT_EQ(0, buffer->readerIndex());
+    ASSERT_EQ(0, buffer->writerIndex());
+    ASSERT_TRUE(ByteOrder::BYTE_ORDER_BIG == buffer->order());
+    ASSERT_EQ(&factory, &buffer->factory());
+
+    buffer->writeInt(0x01020304);
+    ASSERT_EQ(0x01020304, buffer->readInt());
+
+    ChannelBufferPtr little = factory.getBuffer(ByteOrder::BYTE_ORDER_LITTLE, 8);
+    ASSERT_TRUE(ByteOrder::BYTE_ORDER_LITTLE == little->order());
+
+    ASSERT_THROW(factory.getBuffer(-1), InvalidArgumentException);
+}
+
+TEST(PooledChannelBufferFactoryTest, testRecycle) {
+    PooledChannelBufferFactory factory;
+
+    ChannelBufferPtr buffer = factory.getBuffer(100);
+    const char* bytes = buffer->array().data();
+    buffer.reset();
+    ASSERT_EQ(1, factory.getCachedCount());
+
+    // the same size class reuses the block.
+    buffer = factory.getBuffer(128);
+    ASSERT_EQ(bytes, buffer->array().data());
+    ASSERT_EQ(0, factory.getCachedCount());
+
+    // the other size class does not.
+    ChannelBufferPtr other = factory.getBuffer(129);
+    ASSERT_NE(bytes, other->array().data());
+}
+
+TEST(PooledChannelBufferFactoryTest, testNotPooled) {
+    PooledChannelBufferFactory factory(ByteOrder::BYTE_ORDER_BIG, 1024, 1);
+
+    ChannelBufferPtr large = factory.getBuffer(2048);
+    ASSERT_EQ(2048, large->capacity());
+    large.reset();
+    ASSERT_EQ(0, factory.getCachedCount());
+
+    // no more than maxCachedCount blocks are kept.
+    ChannelBufferPtr first = factory.getBuffer(100);
+    ChannelBufferPtr second = factory.getBuffer(100);
+    first.reset();
+    second.reset();
+    ASSERT_EQ(1, factory.getCachedCount());
+}
+
+TEST(PooledChannelBufferFactoryTest, testReleaseByOtherThread) {
+    PooledChannelBufferFactory factory;
+
+    ChannelBufferPtr buffer = factory.getBuffer(100);
+    const char* bytes = buffer->array().data();
+
+    boost::thread thread(boost::bind(&releaseBuffer, &buffer));
+    thread.join();
+
+    ASSERT_FALSE(buffer);
+    ASSERT_EQ(0, factory.getCachedCount());
+
+    // drained back when the free list runs out.
+    buffer = factory.getBuffer(100);
+    ASSERT_EQ(bytes, buffer->array().data());
+}
+
+static void allocateBuffers(PooledChannelBufferFactory* factory,
+                            ChannelBufferPtr* kept) {
+    ChannelBufferPtr cached = factory->getBuffer(100);
+    *kept = factory->getBuffer(100);
+}
+
+TEST(PooledChannelBufferFactoryTest, testReleaseAfterThreadExit) {
+    PooledChannelBufferFactory factory;
+    ChannelBufferPtr buffer;
+
+    // the cache of the thread is orphaned when it exits.
+    boost::thread thread(boost::bind(&allocateBuffers, &factory, &buffer));
+    thread.join();
+
+    ASSERT_TRUE(buffer);
+    buffer->writeInt(1);
+
+    // freed directly, not cached by this thread.
+    buffer.reset();
+    ASSERT_EQ(0, factory.getCachedCount());
+}
+
+static void allocateAndReleaseLater(PooledChannelBufferFactory* factory,
+                                    ChannelBufferPtr* remote,
+                                    boost::barrier* allocated,
+                                    boost::barrier* destroyed) {
+    ChannelBufferPtr local = factory->getBuffer(100);
+    *remote = factory->getBuffer(100);
+    allocated->wait();
+
+    // released by the owner thread after the factory is gone.
+    destroyed->wait();
+    local.reset();
+}
+
+TEST(PooledChannelBufferFactoryTest, testReleaseAfterFactoryDestroyed) {
+    PooledChannelBufferFactory* factory = new PooledChannelBufferFactory;
+    ChannelBufferPtr buffer;
+    boost::barrier allocated(2);
+    boost::barrier destroyed(2);
+
+    boost::thread thread(boost::bind(&allocateAndReleaseLater,
+                                     factory, &buffer, &allocated, &destroyed));
+    allocated.wait();
+
+    // the cache of the thread, which is still running, outlives the factory.
+    delete factory;
+
+    buffer->writeInt(1);
+    buffer.reset();
+
+    destroyed.wait();
+    thread.join();
+}
+
+TEST(PooledChannelBufferFactoryTest, testDynamicBuffer) {
+    PooledChannelBufferFactory factory;
+    DynamicChannelBuffer buffer(ByteOrder::BYTE_ORDER_BIG, 64, factory);
+
+    for (int i = 0; i < 1000; ++i) {
+        buffer.writeInt(i);
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(i, buffer.readInt());
+    }
+
+    // the outgrown blocks were given back.
+    ASSERT_LT(0, factory.getCachedCount());
+}
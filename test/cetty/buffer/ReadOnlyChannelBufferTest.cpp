@@ -188,3 +188,22 @@ TEST(ReadOnlyChannelBufferTest, shouldRejectSetBytes4) {
 //         ChannelBuffers::unmodifiableBuffer(ChannelBuffers::EMPTY_BUFFER).setBytes(0, (ByteBuffer) null),
 //         ReadOnlyBufferException);
 // }
+
+TEST(ReadOnlyChannelBufferTest, shouldSliceReadableBytesForWriting) {
+    ChannelBufferPtr buf = ChannelBuffers::copiedBuffer("abcdef");
+    buf->skipBytes(1);
+
+    ChannelBufferPtr roBuf = ChannelBuffers::unmodifiableBuffer(buf);
+    roBuf->skipBytes(1);
+
+    // the duplicate keeps the indexes of the read-only buffer.
+    ChannelBufferPtr dup = roBuf->duplicate();
+    ASSERT_EQ(2, dup->readerIndex());
+
+    Array array;
+    dup->readSlice(array);
+    ASSERT_EQ(std::string("cdef"), std::string(array.data(), array.length()));
+    ASSERT_EQ(0, dup->readableBytes());
+    ASSERT_EQ(4, roBuf->readableBytes());
+    ASSERT_EQ(5, buf->readableBytes());
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include "cetty/channel/AbstractChannel.h"
+#include "cetty/channel/ChannelFactory.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/DefaultChannelConfig.h"
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/ChannelTestUtil.h"
+
+using namespace cetty::channel;
+
+class NoChannelFactory : public ChannelFactory {
+public:
+    virtual Channel* newChannel(ChannelPipeline* pipeline) { return NULL; }
+    virtual void releaseExternalResources() {}
+};
+
+// a channel which tells when it is deleted, closed by the test as the
+// transport would do.
+class CountedChannel : public AbstractChannel {
+public:
+    CountedChannel(ChannelFactory* factory,
+                   ChannelSink* sink,
+                   ChannelEventLoop* eventLoop,
+                   bool* deleted)
+        : AbstractChannel(NULL, factory, new DefaultChannelPipeline, sink),
+          eventLoop(eventLoop),
+          deleted(deleted) {
+    }
+
+    virtual ~CountedChannel() { *deleted = true; }
+
+    virtual ChannelConfig& getConfig() { return config; }
+    virtual const ChannelConfig& getConfig() const { return config; }
+
+    virtual bool isBound() const { return false; }
+    virtual bool isConnected() const { return false; }
+
+    virtual const SocketAddress& getLocalAddress() const {
+        return SocketAddress::NULL_ADDRESS;
+    }
+    virtual const SocketAddress& getRemoteAddress() const {
+        return SocketAddress::NULL_ADDRESS;
+    }
+
+    virtual ChannelEventLoop* getEventLoop() const { return eventLoop; }
+
+    void closeByTransport() { setClosed(); }
+
+private:
+    DefaultChannelConfig config;
+    ChannelEventLoop* eventLoop;
+    bool* deleted;
+};
+
+TEST(AbstractChannelTest, testAcceptedChannelDeletedByLastRelease) {
+    NoChannelFactory factory;
+    DiscardingSink sink;
+    ManualEventLoop eventLoop;
+    bool deleted = false;
+
+    CountedChannel* channel =
+        new CountedChannel(&factory, &sink, &eventLoop, &deleted);
+
+    // a task which still refers to the channel.
+    channel->retain();
+
+    // the server sink releases the first count when the channel is closed.
+    channel->closeByTransport();
+    channel->release();
+    ASSERT_EQ(0, eventLoop.getTaskCount());
+    ASSERT_FALSE(channel->isOpen());
+
+    // the last release deletes it later in its event loop.
+    channel->release();
+    ASSERT_FALSE(deleted);
+    ASSERT_EQ(1, eventLoop.runTasks());
+    ASSERT_TRUE(deleted);
+}
+
+TEST(AbstractChannelTest, testReleaseWithoutEventLoop) {
+    NoChannelFactory factory;
+    DiscardingSink sink;
+    bool deleted = false;
+
+    CountedChannel* channel =
+        new CountedChannel(&factory, &sink, NULL, &deleted);
+
+    channel->retain();
+    channel->release();
+    ASSERT_FALSE(deleted);
+
+    channel->closeByTransport();
+    channel->release();
+    ASSERT_TRUE(deleted);
+}
+
+TEST(AbstractChannelTest, testClientChannelKeptAfterClose) {
+    NoChannelFactory factory;
+    DiscardingSink sink;
+    ManualEventLoop eventLoop;
+    bool deleted = false;
+
+    CountedChannel* channel =
+        new CountedChannel(&factory, &sink, &eventLoop, &deleted);
+
+    // the client factory keeps its count after the channel is closed, so
+    // the channel is still valid for the user.
+    channel->retain();
+    channel->closeByTransport();
+    channel->release();
+
+    ASSERT_EQ(0, eventLoop.getTaskCount());
+    ASSERT_FALSE(deleted);
+    ASSERT_FALSE(channel->isOpen());
+
+    // releaseExternalResources deletes it after the event loops exited.
+    delete channel;
+    ASSERT_TRUE(deleted);
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "cetty/channel/AdaptiveReceiveBufferSizePredictor.h"
+
+using namespace cetty::channel;
+
+TEST(AdaptiveReceiveBufferSizePredictorTest, testGrowAndShrink) {
+    AdaptiveReceiveBufferSizePredictor predictor(64, 1024, 65536);
+    ASSERT_EQ(1024, predictor.nextReceiveBufferSize());
+
+    // grows quickly while the reads fill up the buffer.
+    predictor.previousReceiveBufferSize(1024);
+    int grown = predictor.nextReceiveBufferSize();
+    ASSERT_GT(grown, 1024);
+
+    for (int i = 0; i < 100; ++i) {
+        predictor.previousReceiveBufferSize(predictor.nextReceiveBufferSize());
+    }
+    ASSERT_EQ(65536, predictor.nextReceiveBufferSize());
+
+    // shrinks slowly, after two small reads in a row.
+    predictor.previousReceiveBufferSize(10);
+    ASSERT_EQ(65536, predictor.nextReceiveBufferSize());
+    predictor.previousReceiveBufferSize(10);
+    ASSERT_GT(65536, predictor.nextReceiveBufferSize());
+
+    for (int i = 0; i < 1000; ++i) {
+        predictor.previousReceiveBufferSize(10);
+    }
+    ASSERT_EQ(64, predictor.nextReceiveBufferSize());
+}
@@ -1,16 +1,17 @@
 
 #include <string>
 #include <vector>
-#include "boost/shared_ptr.hpp"
+#include "boost/intrusive_ptr.hpp"
 
 #include "gtest/gtest.h"
 #include "cetty/channel/ChannelMessage.h"
 #include "cetty/util/Exception.h"
+#include "cetty/util/ReferenceCounter.h"
 
 using namespace cetty::channel;
 using namespace cetty::util;
 
-class BaseInterface {
+class BaseInterface : public ReferenceCounter<BaseInterface> {
 public:
     virtual ~BaseInterface() {}
 
@@ -50,31 +51,31 @@ public:
 
 };
 
-typedef boost::shared_ptr<BaseInterface> BaseInterfacePtr;
-typedef boost::shared_ptr<BaseImpl>      BaseImplPtr;
-typedef boost::shared_ptr<BaseImpl2>     BaseImpl2Ptr;
-typedef boost::shared_ptr<Impl>          ImplPtr;
+typedef boost::intrusive_ptr<BaseInterface> BaseInterfacePtr;
+typedef boost::intrusive_ptr<BaseImpl>      BaseImplPtr;
+typedef boost::intrusive_ptr<BaseImpl2>     BaseImpl2Ptr;
+typedef boost::intrusive_ptr<Impl>          ImplPtr;
 
-TEST(ChannelMessageTest, testSharedPointer) {
+TEST(ChannelMessageTest, testSmartPointer) {
     ImplPtr implPtr(new Impl);
     BaseInterfacePtr p = boost::dynamic_pointer_cast<BaseInterface>(implPtr);
     ChannelMessage msg1(p);
     ChannelMessage msg2(implPtr);
 
-    ASSERT_TRUE(msg1.isSharedPointer());
+    ASSERT_TRUE(msg1.isSmartPointer());
     ASSERT_FALSE(msg1.isRawPointer());
 
-    ASSERT_EQ((msg1.sharedPointer<Impl, BaseInterface>()).get(), implPtr.get());
-    ASSERT_EQ(msg2.sharedPointer<Impl>().get(), implPtr.get());
-    ASSERT_EQ((msg1.sharedPointer<BaseImpl, BaseInterface>()).get(), implPtr.get());
-    ASSERT_EQ((msg2.sharedPointer<BaseImpl, Impl>()).get(), implPtr.get());
-    ASSERT_EQ(msg1.sharedPointer<BaseInterface>().get(), implPtr.get());
-    ASSERT_EQ((msg2.sharedPointer<BaseInterface, Impl>()).get(), implPtr.get());
+    ASSERT_EQ((msg1.smartPointer<Impl, BaseInterface>()).get(), implPtr.get());
+    ASSERT_EQ(msg2.smartPointer<Impl>().get(), implPtr.get());
+    ASSERT_EQ((msg1.smartPointer<BaseImpl, BaseInterface>()).get(), implPtr.get());
+    ASSERT_EQ((msg2.smartPointer<BaseImpl, Impl>()).get(), implPtr.get());
+    ASSERT_EQ(msg1.smartPointer<BaseInterface>().get(), implPtr.get());
+    ASSERT_EQ((msg2.smartPointer<BaseInterface, Impl>()).get(), implPtr.get());
 
-    ASSERT_TRUE((msg1.sharedPointer<BaseImpl2, BaseInterface>()).get() == 0);
-    ASSERT_TRUE((msg2.sharedPointer<BaseImpl2, Impl>()).get() == 0);
-    ASSERT_TRUE((msg1.sharedPointer<Impl>()).get() == 0);
-    ASSERT_TRUE((msg2.sharedPointer<BaseImpl>()).get() == 0);
+    ASSERT_TRUE((msg1.smartPointer<BaseImpl2, BaseInterface>()).get() == 0);
+    ASSERT_TRUE((msg2.smartPointer<BaseImpl2, Impl>()).get() == 0);
+    ASSERT_TRUE((msg1.smartPointer<Impl>()).get() == 0);
+    ASSERT_TRUE((msg2.smartPointer<BaseImpl>()).get() == 0);
 
     ASSERT_TRUE(msg1.rawPointer<Impl>() == 0);
     ASSERT_TRUE(msg1.rawPointer<BaseImpl2>() == 0);
@@ -110,8 +111,8 @@ TEST(ChannelMessageTest, testRawPointer) {
 
     ASSERT_EQ(msg2.rawPointer<BaseInterface>(), impl);
     ASSERT_EQ((msg1.rawPointer<Impl>()), impl);
-    ASSERT_FALSE(msg1.sharedPointer<Impl>());
-    ASSERT_FALSE(msg1.sharedPointer<BaseInterface>());
+    ASSERT_FALSE(msg1.smartPointer<Impl>());
+    ASSERT_FALSE(msg1.smartPointer<BaseInterface>());
 }
 
 TEST(ChannelMessageTest, testVector1) {
@@ -126,10 +127,10 @@ TEST(ChannelMessageTest, testVector1) {
 
     ChannelMessage msg1(ptrs);
 
-    ASSERT_EQ(msg1.sharedPointer<BaseInterface>(0).get(), impl1);
-    ASSERT_EQ(msg1.sharedPointer<BaseInterface>(1).get(), impl2);
-    ASSERT_EQ(msg1.sharedPointer<BaseInterface>(2).get(), baseImpl);
-    ASSERT_FALSE(msg1.sharedPointer<BaseInterface>(3));
+    ASSERT_EQ(msg1.smartPointer<BaseInterface>(0).get(), impl1);
+    ASSERT_EQ(msg1.smartPointer<BaseInterface>(1).get(), impl2);
+    ASSERT_EQ(msg1.smartPointer<BaseInterface>(2).get(), baseImpl);
+    ASSERT_FALSE(msg1.smartPointer<BaseInterface>(3));
     ASSERT_THROW(msg1.value<BaseInterfacePtr>(3), RangeException);
 }
 
@@ -152,17 +153,74 @@ TEST(ChannelMessageTest, testVector2) {
                         ChannelMessage(impl2Ptr),
                         ChannelMessage(baseImplPtr));
 
-    ASSERT_EQ(msg1.value<ChannelMessage>(0).sharedPointer<BaseInterface>().get(), impl1);
-    ASSERT_EQ(msg1.value<ChannelMessage>(1).sharedPointer<BaseInterface>().get(), impl2);
-    ASSERT_EQ(msg1.value<ChannelMessage>(2).sharedPointer<BaseInterface>().get(), baseImpl);
+    ASSERT_EQ(msg1.value<ChannelMessage>(0).smartPointer<BaseInterface>().get(), impl1);
+    ASSERT_EQ(msg1.value<ChannelMessage>(1).smartPointer<BaseInterface>().get(), impl2);
+    ASSERT_EQ(msg1.value<ChannelMessage>(2).smartPointer<BaseInterface>().get(), baseImpl);
     ASSERT_TRUE(msg1.value<ChannelMessage>(3).empty());
     ASSERT_THROW(msg1.value<std::vector<ChannelMessage> >(3), RangeException);
 }
 
 TEST(ChannelMessageTest, testString) {
-    
+    ChannelMessage msg1("hello");
+    ChannelMessage msg2(std::string("hello"));
+    ChannelMessage msg3(msg1);
+
+    ASSERT_TRUE(msg1.isString());
+    ASSERT_FALSE(msg1.isChannelBuffer());
+    ASSERT_EQ(std::string("hello"), msg1.value<std::string>());
+    ASSERT_EQ(std::string("hello"), msg2.value<std::string>());
+    ASSERT_TRUE(msg1.value<std::wstring>().empty());
+
+    // the copies share the string.
+    ASSERT_TRUE(msg1 == msg3);
+    ASSERT_FALSE(msg1 == msg2);
+    ASSERT_EQ(msg1.pointer<std::string>(), msg3.pointer<std::string>());
 }
 
 TEST(ChannelMessageTest, testBasicAny) {
+    ChannelMessage msg1(42);
+    ChannelMessage msg2(42);
+    ChannelMessage msg3(42L);
+
+    ASSERT_EQ(42, msg1.value<int>());
+    ASSERT_TRUE(msg1 == msg2);
+    ASSERT_FALSE(msg1 == msg3);
+    ASSERT_TRUE(msg1.pointer<long>() == NULL);
+    ASSERT_THROW(msg1.value<long>(), BadCastException);
+    ASSERT_THROW(ChannelMessage().value<int>(), InvalidAccessException);
+
+    msg1 = msg3;
+    ASSERT_EQ(42L, msg1.value<long>());
+    ASSERT_TRUE(msg1.pointer<int>() == NULL);
+}
+
+TEST(ChannelMessageTest, testChannelBuffer) {
+    ChannelBufferPtr buffer = ChannelBuffers::buffer(16);
+    ChannelMessage msg1(buffer);
+    ChannelMessage msg2;
+
+    ASSERT_TRUE(msg1.isChannelBuffer());
+    ASSERT_TRUE(msg1.isSmartPointer());
+    ASSERT_EQ(buffer, msg1.value<ChannelBufferPtr>());
+    ASSERT_EQ(buffer, msg1.smartPointer<ChannelBuffer>());
+    ASSERT_TRUE(ChannelMessage(ChannelBufferPtr()).empty());
+    ASSERT_FALSE(msg2.value<ChannelBufferPtr>());
+
+    msg2 = msg1;
+    msg1 = ChannelMessage();
+    ASSERT_TRUE(msg1.empty());
+    ASSERT_EQ(buffer, msg2.smartPointer<ChannelBuffer>());
+}
+
+TEST(ChannelMessageTest, testAssignFromElement) {
+    BaseInterfacePtr impl(new Impl);
+    ChannelMessage msg(ChannelMessage(impl), ChannelMessage("tail"));
+
+    ASSERT_TRUE(msg.isVector());
+    ASSERT_EQ(2, msg.vectorSize());
 
+    // the element is owned by the message it is assigned to.
+    msg = msg.value<ChannelMessage>(0);
+    ASSERT_EQ(impl, msg.smartPointer<BaseInterface>());
+    ASSERT_EQ(0, msg.vectorSize());
 }
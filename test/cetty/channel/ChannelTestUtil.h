@@ -0,0 +1,96 @@
+#if !defined(CETTY_CHANNEL_CHANNELTESTUTIL_H)
+#define CETTY_CHANNEL_CHANNELTESTUTIL_H
+
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <deque>
+#include <boost/thread/mutex.hpp>
+
+#include "cetty/channel/NullChannel.h"
+#include "cetty/channel/ChannelEventLoop.h"
+#include "cetty/channel/AbstractChannelSink.h"
+#include "cetty/channel/DefaultChannelConfig.h"
+
+using namespace cetty::channel;
+
+/**
+ * An event loop which runs its tasks only when asked to, so a test can
+ * check what has been deferred to the event loop.
+ */
+class ManualEventLoop : public ChannelEventLoop {
+public:
+    virtual void execute(const Task& task) {
+        boost::mutex::scoped_lock lock(mutex);
+        tasks.push_back(task);
+    }
+
+    int getTaskCount() {
+        boost::mutex::scoped_lock lock(mutex);
+        return static_cast<int>(tasks.size());
+    }
+
+    /**
+     * Runs the tasks queued so far, not the ones they queue, and returns
+     * the count of them.
+     */
+    int runTasks() {
+        std::deque<Task> running;
+
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            running.swap(tasks);
+        }
+
+        for (std::size_t i = 0; i < running.size(); ++i) {
+            running[i]();
+        }
+        return static_cast<int>(running.size());
+    }
+
+private:
+    boost::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+/**
+ * A sink which drops all the downstream events.
+ */
+class DiscardingSink : public AbstractChannelSink {
+public:
+    virtual void writeRequested(const ChannelPipeline& pipeline, const MessageEvent& e) {}
+    virtual void stateChangeRequested(const ChannelPipeline& pipeline, const ChannelStateEvent& e) {}
+};
+
+class OwnBufferChannelConfig : public DefaultChannelConfig {
+public:
+    virtual bool channelOwnBuffer() const { return true; }
+};
+
+/**
+ * A channel which owns the buffers it receives, as the socket channels
+ * reading into their own buffers do, so the decoders may keep them.
+ */
+class OwnBufferChannel : public NullChannel {
+public:
+    virtual ChannelConfig& getConfig() { return config; }
+    virtual const ChannelConfig& getConfig() const { return config; }
+
+private:
+    OwnBufferChannelConfig config;
+};
+
+#endif //#if !defined(CETTY_CHANNEL_CHANNELTESTUTIL_H)
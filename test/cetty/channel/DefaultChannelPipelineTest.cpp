@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/ChannelHandlerContext.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+
+using namespace cetty::channel;
+
+class NopHandler : public SimpleChannelUpstreamHandler {
+};
+
+TEST(DefaultChannelPipelineTest, testFreshContextHasNoAttachment) {
+    DefaultChannelPipeline pipeline;
+
+    // ExecutionHandler and the others take a NULL attachment as the first
+    // event of the context.
+    for (int i = 0; i < 8; ++i) {
+        std::string name = std::string("nop") + static_cast<char>('0' + i);
+        pipeline.addLast(name, ChannelHandlerPtr(new NopHandler));
+
+        ChannelHandlerContext* ctx = pipeline.getContext(name);
+        ASSERT_TRUE(ctx != NULL);
+        ASSERT_TRUE(ctx->getAttachment() == NULL);
+
+        int value = i;
+        ctx->setAttachment(&value);
+        ASSERT_EQ(&value, ctx->getAttachment());
+        ctx->setAttachment(NULL);
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+
+#include <string>
+#include "cetty/channel/DefaultFileRegion.h"
+#include "cetty/util/Exception.h"
+
+using namespace cetty::channel;
+using namespace cetty::util;
+
+class DefaultFileRegionTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        file = ::tmpfile();
+        ASSERT_TRUE(file != NULL);
+
+        content = "0123456789abcdef";
+        ::fwrite(content.data(), 1, content.size(), file);
+        ::fflush(file);
+
+        ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    }
+
+    virtual void TearDown() {
+        ::close(sockets[0]);
+        ::close(sockets[1]);
+        ::fclose(file);
+    }
+
+    std::string receive(int size) {
+        std::string received(size, '\0');
+        int n = ::read(sockets[1], &received[0], size);
+        received.resize(n > 0 ? n : 0);
+        return received;
+    }
+
+    FILE* file;
+    std::string content;
+    int sockets[2];
+};
+
+TEST_F(DefaultFileRegionTest, testTransferTo) {
+    FileRegionPtr region(new DefaultFileRegion(::fileno(file), 4, 8));
+
+    ASSERT_EQ(4, region->getPosition());
+    ASSERT_EQ(8, region->getCount());
+
+    ASSERT_EQ(8, region->transferTo(sockets[0], 0));
+    ASSERT_EQ(content.substr(4, 8), receive(8));
+
+    // from the relative offset.
+    ASSERT_EQ(3, region->transferTo(sockets[0], 5));
+    ASSERT_EQ(content.substr(9, 3), receive(3));
+
+    // nothing left.
+    ASSERT_EQ(0, region->transferTo(sockets[0], 8));
+    ASSERT_THROW(region->transferTo(sockets[0], 9), InvalidArgumentException);
+}
+
+TEST_F(DefaultFileRegionTest, testFileShorterThanRegion) {
+    FileRegionPtr region(new DefaultFileRegion(::fileno(file), 8, 16));
+
+    ASSERT_EQ(8, region->transferTo(sockets[0], 0));
+    ASSERT_THROW(region->transferTo(sockets[0], 8), IOException);
+}
+
+TEST_F(DefaultFileRegionTest, testReleaseExternalResources) {
+    DefaultFileRegion region(::dup(::fileno(file)), 0, 16, true);
+    ASSERT_TRUE(region.releaseAfterTransfer());
+
+    region.releaseExternalResources();
+    ASSERT_EQ(-1, region.getFd());
+    ASSERT_THROW(region.transferTo(sockets[0], 0), IOException);
+
+    ASSERT_THROW(DefaultFileRegion("/nonexistent/file"), FileException);
+}
+
+#if defined(__linux__)
+TEST_F(DefaultFileRegionTest, testTransferEmptyPipe) {
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    FileRegionPtr region(new DefaultFileRegion(fds[0], 0, 8, true));
+
+    // nothing in the pipe yet, returns instead of blocking.
+    ASSERT_EQ(0, region->transferTo(sockets[0], 0));
+
+    ASSERT_EQ(3, ::write(fds[1], "abc", 3));
+    ASSERT_EQ(3, region->transferTo(sockets[0], 0));
+    ASSERT_EQ("abc", receive(3));
+    ASSERT_EQ(0, region->transferTo(sockets[0], 3));
+
+    ::close(fds[1]);
+}
+#endif
+
+TEST_F(DefaultFileRegionTest, testOpenRegularFileOnly) {
+    char path[] = "/tmp/DefaultFileRegionTest.XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(10, ::write(fd, "0123456789", 10));
+    ::close(fd);
+
+    {
+        DefaultFileRegion region(path);
+        ASSERT_EQ(10, region.getCount());
+        ASSERT_FALSE(region.isPipe());
+    }
+    ::unlink(path);
+
+    // a fifo without a writer, neither blocks nor opens with no count.
+    ASSERT_EQ(0, ::mkfifo(path, 0600));
+    ASSERT_THROW(DefaultFileRegion region(path), FileException);
+    ::unlink(path);
+}
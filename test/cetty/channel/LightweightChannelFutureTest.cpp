@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "cetty/channel/LightweightChannelFuture.h"
+#include "cetty/channel/VoidChannelFuture.h"
+#include "cetty/util/Exception.h"
+
+using namespace cetty::channel;
+using namespace cetty::util;
+
+// the futures only keep the reference of the channel.
+static Channel& channel = *reinterpret_cast<Channel*>(&channel);
+
+static int notified = 0;
+
+static void count(const ChannelFuturePtr& future) {
+    ++notified;
+}
+
+static void completeLater(ChannelFuturePtr future) {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    future->setFailure(IOException("failed"));
+}
+
+TEST(LightweightChannelFutureTest, testComplete) {
+    ChannelFuturePtr future(new LightweightChannelFuture(channel, false));
+
+    notified = 0;
+    future->setListener(boost::bind(&count, _1));
+    ASSERT_FALSE(future->isDone());
+    ASSERT_FALSE(future->cancel());
+
+    ASSERT_TRUE(future->setSuccess());
+    ASSERT_EQ(1, notified);
+    ASSERT_TRUE(future->isDone());
+    ASSERT_TRUE(future->isSuccess());
+    ASSERT_FALSE(future->setFailure(IOException("failed")));
+    ASSERT_TRUE(future->getCause() == NULL);
+
+    // notified at once after done.
+    future->setListener(boost::bind(&count, _1));
+    ASSERT_EQ(2, notified);
+
+    ChannelFuturePtr cancellable(new LightweightChannelFuture(channel, true));
+    ASSERT_TRUE(cancellable->cancel());
+    ASSERT_TRUE(cancellable->isCancelled());
+    ASSERT_FALSE(cancellable->isSuccess());
+}
+
+TEST(LightweightChannelFutureTest, testAwaitFromOtherThread) {
+    ChannelFuturePtr future(new LightweightChannelFuture(channel, false));
+
+    ASSERT_FALSE(future->await(10));
+
+    boost::thread completer(boost::bind(&completeLater, future));
+    future->awaitUninterruptibly();
+    completer.join();
+
+    ASSERT_TRUE(future->isDone());
+    ASSERT_FALSE(future->isSuccess());
+    ASSERT_TRUE(future->getCause() != NULL);
+    ASSERT_EQ(std::string("failed"), future->getCause()->getMessage());
+}
+
+TEST(LightweightChannelFutureTest, testReuseMemory) {
+    LightweightChannelFuture* first = new LightweightChannelFuture(channel, false);
+    ChannelFuturePtr(first).reset();
+
+    int cached = LightweightChannelFuture::getCachedCount();
+    ASSERT_GT(cached, 0);
+
+    ChannelFuturePtr second(new LightweightChannelFuture(channel, false));
+    ASSERT_EQ(first, second.get());
+    ASSERT_EQ(cached - 1, LightweightChannelFuture::getCachedCount());
+}
+
+TEST(LightweightChannelFutureTest, testVoidFuture) {
+    ChannelFuturePtr future(new VoidChannelFuture(channel));
+
+    ASSERT_TRUE(future->isVoid());
+    ASSERT_FALSE(future->setSuccess());
+    ASSERT_FALSE(future->isDone());
+    ASSERT_THROW(future->setListener(boost::bind(&count, _1)), IllegalStateException);
+    ASSERT_THROW(future->await(), IllegalStateException);
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * Compares the per-event cost of dispatching through a
+ * {@link DefaultChannelPipeline} and a {@link StaticChannelPipeline} with
+ * the same decoder -> handler -> encoder chain.
+ *
+ * usage: StaticChannelPipelineBenchmark [events]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "cetty/channel/StaticChannelPipeline.h"
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/channel/SimpleChannelDownstreamHandler.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/util/Exception.h"
+
+using namespace cetty::channel;
+using namespace cetty::util;
+
+static long received = 0;
+static long written = 0;
+
+class BenchmarkMessageEvent : public MessageEvent {
+public:
+    BenchmarkMessageEvent() {}
+    virtual ~BenchmarkMessageEvent() {}
+
+    virtual Channel& getChannel() const {
+        throw UnsupportedOperationException("no channel");
+    }
+    virtual const ChannelFuturePtr& getFuture() const { return future; }
+    virtual const ChannelMessage& getMessage() const { return message; }
+    virtual const SocketAddress& getRemoteAddress() const {
+        return SocketAddress::NULL_ADDRESS;
+    }
+    virtual std::string toString() const { return "BenchmarkMessageEvent"; }
+
+private:
+    ChannelMessage message;
+    ChannelFuturePtr future;
+};
+
+class CountingSink : public ChannelSink {
+public:
+    virtual ~CountingSink() {}
+
+    virtual void eventSunk(const ChannelPipeline& pipeline, const ChannelEvent& e) {}
+    virtual void writeRequested(const ChannelPipeline& pipeline, const MessageEvent& e) {
+        ++written;
+    }
+    virtual void stateChangeRequested(const ChannelPipeline& pipeline, const ChannelStateEvent& e) {}
+    virtual void exceptionCaught(const ChannelPipeline& pipeline,
+                                 const ChannelEvent& e,
+                                 const ChannelPipelineException& cause) {}
+};
+
+class Decoder : public SimpleChannelUpstreamHandler {
+public:
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        ctx.sendUpstream(e);
+    }
+};
+
+class Handler : public SimpleChannelUpstreamHandler {
+public:
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        ++received;
+    }
+};
+
+class Encoder : public SimpleChannelDownstreamHandler {
+public:
+    virtual void writeRequested(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        ctx.sendDownstream(e);
+    }
+};
+
+static void benchmark(const char* name, ChannelPipeline& pipeline, int count) {
+    BenchmarkMessageEvent e;
+
+    received = 0;
+    written = 0;
+
+    boost::posix_time::ptime start =
+        boost::posix_time::microsec_clock::universal_time();
+
+    for (int i = 0; i < count; ++i) {
+        pipeline.sendUpstream(e);
+        pipeline.sendDownstream(e);
+    }
+
+    boost::posix_time::ptime end =
+        boost::posix_time::microsec_clock::universal_time();
+
+    long total = (long)(end - start).total_microseconds();
+
+    printf("%-8s received: %ld, written: %ld, total: %ld us, %.1f ns/event\n",
+           name, received, written, total, total * 1000.0 / (2.0 * count));
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 10000000;
+
+    // the handlers never touch the channel.
+    CountingSink sink;
+    Channel* channel = reinterpret_cast<Channel*>(&sink);
+
+    DefaultChannelPipeline dynamic;
+    dynamic.addLast("decoder", new Decoder);
+    dynamic.addLast("handler", new Handler);
+    dynamic.addLast("encoder", new Encoder);
+    dynamic.attach(channel, &sink);
+
+    StaticChannelPipeline<Decoder, Handler, Encoder> fixed(
+        new Decoder, new Handler, new Encoder);
+    fixed.attach(channel, &sink);
+
+    benchmark("default", dynamic, count);
+    benchmark("static", fixed, count);
+
+    return 0;
+}
@@ -1,9 +1,9 @@
 /*
- * Copyright 2010 Red Hat, Inc.
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
  *
- * Red Hat licenses this file to you under the Apache License, version 2.0
- * (the "License"); you may not use this file except in compliance with the
- * License.  You may obtain a copy of the License at:
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
  *
  *    http://www.apache.org/licenses/LICENSE-2.0
  *
@@ -13,61 +13,157 @@
  * License for the specific language governing permissions and limitations
  * under the License.
  */
-package org.jboss.netty.channel;
 
-import java.util.Map;
+#include "gtest/gtest.h"
 
-import junit.framework.Assert;
+#include <string>
+#include "cetty/channel/StaticChannelPipeline.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/channel/SimpleChannelDownstreamHandler.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelPipelineException.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/util/Exception.h"
 
-import org.junit.Test;
+using namespace cetty::channel;
+using namespace cetty::util;
 
-/**
- * @author <a href="http://www.jboss.org/netty/">The Netty Project</a>
- * @author <a href="http://gleamynode.net/">Trustin Lee</a>
- * @version $Rev: 2267 $, $Date: 2010-05-06 16:00:52 +0900 (Thu, 06 May 2010) $
- */
-public class StaticChannelPipelineTest {
-
-    @Test
-    public void testConstructionWithoutNull() {
-        StaticChannelPipeline p = new StaticChannelPipeline(new A(), new B());
-        Map<String, ChannelHandler> m = p.toMap();
-        Assert.assertEquals(2, m.size());
-        Assert.assertTrue(m.get("0") instanceof A);
-        Assert.assertTrue(m.get("1") instanceof B);
+// a message event without a channel, the handlers here do not touch it.
+class TestMessageEvent : public MessageEvent {
+public:
+    TestMessageEvent(const std::string& message) : message(message) {}
+    virtual ~TestMessageEvent() {}
+
+    virtual Channel& getChannel() const {
+        throw UnsupportedOperationException("no channel");
+    }
+    virtual const ChannelFuturePtr& getFuture() const { return future; }
+    virtual const ChannelMessage& getMessage() const { return message; }
+    virtual const SocketAddress& getRemoteAddress() const {
+        return SocketAddress::NULL_ADDRESS;
     }
+    virtual std::string toString() const { return "TestMessageEvent"; }
 
-    @Test
-    public void testConstructionWithNull1() {
-        StaticChannelPipeline p = new StaticChannelPipeline(null, new A(), new B());
-        Map<String, ChannelHandler> m = p.toMap();
-        Assert.assertEquals(0, m.size());
+private:
+    ChannelMessage message;
+    ChannelFuturePtr future;
+};
 
+class RecordingSink : public ChannelSink {
+public:
+    RecordingSink() : written(0), exceptions(0) {}
+    virtual ~RecordingSink() {}
+
+    virtual void eventSunk(const ChannelPipeline& pipeline, const ChannelEvent& e) {}
+    virtual void writeRequested(const ChannelPipeline& pipeline, const MessageEvent& e) {
+        ++written;
+    }
+    virtual void stateChangeRequested(const ChannelPipeline& pipeline, const ChannelStateEvent& e) {}
+    virtual void exceptionCaught(const ChannelPipeline& pipeline,
+                                 const ChannelEvent& e,
+                                 const ChannelPipelineException& cause) {
+        ++exceptions;
     }
 
-    @Test
-    public void testConstructionWithNull2() {
-        StaticChannelPipeline p = new StaticChannelPipeline(new A(), null, new B());
-        Map<String, ChannelHandler> m = p.toMap();
-        Assert.assertEquals(1, m.size());
-        Assert.assertTrue(m.get("0") instanceof A);
+    int written;
+    int exceptions;
+};
+
+static std::string trace;
 
+class A : public SimpleChannelUpstreamHandler {
+public:
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        trace += "A";
+        ctx.sendUpstream(e);
     }
+};
 
-    @Test
-    public void testConstructionWithNull() {
-        StaticChannelPipeline p = new StaticChannelPipeline(new A(), new B(), null);
-        Map<String, ChannelHandler> m = p.toMap();
-        Assert.assertEquals(2, m.size());
-        Assert.assertTrue(m.get("0") instanceof A);
-        Assert.assertTrue(m.get("1") instanceof B);
+class B : public SimpleChannelUpstreamHandler {
+public:
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        trace += "B";
+        if (e.getMessage().value<std::string>() == "throw") {
+            throw RuntimeException("B");
+        }
+        ctx.sendUpstream(e);
     }
+};
 
-    static final class A extends SimpleChannelHandler {
-        // Dummy
+class SubA : public A {
+public:
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        trace += "a";
+        ctx.sendUpstream(e);
     }
+};
 
-    static final class B extends SimpleChannelHandler {
-        // Dummy
+class D : public SimpleChannelDownstreamHandler {
+public:
+    virtual void writeRequested(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        trace += "D";
+        ctx.sendDownstream(e);
     }
+};
+
+TEST(StaticChannelPipelineTest, testConstruction) {
+    boost::intrusive_ptr<A> a(new A);
+    boost::intrusive_ptr<B> b(new B);
+    StaticChannelPipeline<A, B> p(a, b);
+
+    ASSERT_EQ(2, (StaticChannelPipeline<A, B>::COUNT));
+    ASSERT_EQ(a.get(), p.getHandler<0>());
+    ASSERT_EQ(b.get(), p.getHandler<1>());
+
+    ChannelPipeline::ChannelHandlers m = p.toMap();
+    ASSERT_EQ(2U, m.size());
+    ASSERT_EQ("0", m[0].first);
+    ASSERT_TRUE(m[0].second == a);
+    ASSERT_EQ("1", m[1].first);
+    ASSERT_TRUE(m[1].second == b);
+
+    ASSERT_TRUE(p.get("1") == b);
+    ASSERT_EQ(p.getContext("0"), p.getContext(a));
+    ASSERT_TRUE(p.getContext("2") == NULL);
+
+    ASSERT_THROW((StaticChannelPipeline<A, B>(a, NULL)), NullPointerException);
+
+    // the override of a subclass would be bypassed.
+    boost::intrusive_ptr<A> subA(new SubA);
+    ASSERT_THROW((StaticChannelPipeline<A, B>(subA, b)), InvalidArgumentException);
+
+    ASSERT_THROW(p.addLast("2", a), UnsupportedOperationException);
+    ASSERT_THROW(p.removeFirst(), UnsupportedOperationException);
+}
+
+TEST(StaticChannelPipelineTest, testDispatch) {
+    RecordingSink sink;
+    StaticChannelPipeline<A, D, B> p(new A, new D, new B);
+    p.attach(reinterpret_cast<Channel*>(&sink), &sink);
+
+    trace.clear();
+    p.sendUpstream(TestMessageEvent("up"));
+    ASSERT_EQ("AB", trace);
+
+    trace.clear();
+    p.sendDownstream(TestMessageEvent("down"));
+    ASSERT_EQ("D", trace);
+    ASSERT_EQ(1, sink.written);
+
+    // the downstream from a context goes to the handlers before it.
+    trace.clear();
+    p.getContext("2")->sendDownstream(TestMessageEvent("down"));
+    ASSERT_EQ("D", trace);
+    ASSERT_EQ(2, sink.written);
+}
+
+TEST(StaticChannelPipelineTest, testHandlerException) {
+    RecordingSink sink;
+    StaticChannelPipeline<A, B> p(new A, new B);
+    p.attach(reinterpret_cast<Channel*>(&sink), &sink);
+
+    trace.clear();
+    p.sendUpstream(TestMessageEvent("throw"));
+    ASSERT_EQ("AB", trace);
+    ASSERT_EQ(1, sink.exceptions);
 }
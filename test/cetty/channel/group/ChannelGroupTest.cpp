@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/buffer/ReadOnlyChannelBuffer.h"
+#include "cetty/channel/NullChannel.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelEventLoop.h"
+#include "cetty/channel/DefaultChannelFuture.h"
+#include "cetty/channel/group/ChannelGroup.h"
+#include "cetty/channel/ChannelTestUtil.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::channel::group;
+
+class RecordingChannel : public NullChannel {
+public:
+    RecordingChannel(int id, ChannelEventLoop* eventLoop)
+        : id(id), eventLoop(eventLoop), closeFuture(new DefaultChannelFuture(*this, false)) {
+    }
+
+    virtual Integer getId() const { return Integer(id); }
+    virtual bool isOpen() const { return !closeFuture->isDone(); }
+
+    virtual ChannelEventLoop* getEventLoop() const { return eventLoop; }
+    virtual ChannelFuturePtr& getCloseFuture() { return closeFuture; }
+
+    virtual ChannelFuturePtr write(const ChannelMessage& message,
+                                   bool withFuture = true) {
+        ChannelBufferPtr buffer = message.value<ChannelBufferPtr>();
+        buffers.push_back(buffer);
+
+        std::string str;
+        buffer->readBytes(str);
+        written.push_back(str);
+
+        if (!withFuture) {
+            return voidFuture;
+        }
+
+        ChannelFuturePtr future(new DefaultChannelFuture(*this, false));
+        futures.push_back(future);
+        return future;
+    }
+
+    virtual ChannelFuturePtr close() {
+        closeFuture->setSuccess();
+        return closeFuture;
+    }
+
+    int id;
+    ChannelEventLoop* eventLoop;
+    ChannelFuturePtr closeFuture;
+    ChannelFuturePtr voidFuture;
+
+    std::vector<ChannelBufferPtr> buffers;
+    std::vector<std::string> written;
+    std::vector<ChannelFuturePtr> futures;
+};
+
+static int encodedCount = 0;
+
+static ChannelMessage encodeUpperCase(const ChannelMessage& message) {
+    std::string str = message.value<std::string>();
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        str[i] = toupper(str[i]);
+    }
+
+    ++encodedCount;
+    return ChannelMessage(ChannelBuffers::copiedBuffer(str));
+}
+
+TEST(ChannelGroupTest, testWriteInBatches) {
+    ManualEventLoop loopA;
+    ManualEventLoop loopB;
+
+    RecordingChannel a1(1, &loopA);
+    RecordingChannel a2(2, &loopA);
+    RecordingChannel a3(3, &loopA);
+    RecordingChannel b1(4, &loopB);
+    RecordingChannel own(5, NULL);
+
+    ChannelGroup group("test");
+    ASSERT_TRUE(group.add(a1));
+    ASSERT_TRUE(group.add(a2));
+    ASSERT_TRUE(group.add(a3));
+    ASSERT_TRUE(group.add(b1));
+    ASSERT_TRUE(group.add(own));
+    ASSERT_FALSE(group.add(a2));
+    ASSERT_EQ(5, group.size());
+    ASSERT_EQ(&b1, group.find(Integer(4)));
+
+    ChannelBufferPtr buffer = ChannelBuffers::copiedBuffer("hello");
+    ChannelGroupFuturePtr future = group.write(ChannelMessage(buffer));
+
+    // the channels without an event loop are written at once.
+    ASSERT_EQ(1U, own.written.size());
+    ASSERT_EQ(1, loopA.getTaskCount());
+    ASSERT_EQ(1, loopB.getTaskCount());
+    ASSERT_TRUE(a1.written.empty());
+    ASSERT_FALSE(future->isDone());
+
+    ASSERT_EQ(1, loopA.runTasks());
+    ASSERT_EQ(1, loopB.runTasks());
+
+    RecordingChannel* channels[] = { &a1, &a2, &a3, &b1, &own };
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(1U, channels[i]->written.size());
+        ASSERT_EQ("hello", channels[i]->written[0]);
+
+        // every channel writes its own read-only duplicate.
+        ASSERT_TRUE(boost::dynamic_pointer_cast<ReadOnlyChannelBuffer>(
+                        channels[i]->buffers[0]));
+        for (int j = 0; j < i; ++j) {
+            ASSERT_NE(channels[j]->buffers[0], channels[i]->buffers[0]);
+        }
+    }
+    ASSERT_EQ(5, buffer->readableBytes());
+
+    ASSERT_FALSE(future->isDone());
+    for (int i = 0; i < 4; ++i) {
+        channels[i]->futures[0]->setSuccess();
+    }
+    ASSERT_FALSE(future->isDone());
+
+    own.futures[0]->setFailure(IOException("failed"));
+    ASSERT_TRUE(future->isDone());
+    ASSERT_TRUE(future->await(0));
+    ASSERT_EQ(5, future->getCompletedCount());
+    ASSERT_EQ(4, future->getSuccessCount());
+    ASSERT_TRUE(future->isPartialSuccess());
+    ASSERT_FALSE(future->isCompleteSuccess());
+}
+
+TEST(ChannelGroupTest, testRemoveClosedChannels) {
+    ManualEventLoop loop;
+    RecordingChannel c1(1, &loop);
+    RecordingChannel c2(2, &loop);
+    RecordingChannel c3(3, &loop);
+
+    ChannelGroup group;
+    group.add(c1);
+    group.add(c2);
+    group.add(c3);
+
+    c1.close();
+    ASSERT_EQ(2, group.size());
+    ASSERT_TRUE(group.find(Integer(1)) == NULL);
+
+    // closed before the batch runs.
+    ASSERT_TRUE(group.write(ChannelMessage(ChannelBuffers::copiedBuffer("x")), false) == NULL);
+    c2.close();
+    loop.runTasks();
+
+    ASSERT_TRUE(c1.written.empty());
+    ASSERT_TRUE(c2.written.empty());
+    ASSERT_EQ(1U, c3.written.size());
+    ASSERT_TRUE(c3.futures.empty());
+
+    ASSERT_TRUE(group.remove(c3));
+    ASSERT_FALSE(group.remove(c3));
+    ASSERT_TRUE(group.empty());
+
+    // a closed channel is not added.
+    group.add(c1);
+    ASSERT_TRUE(group.empty());
+
+    // nothing to do.
+    ChannelGroupFuturePtr future = group.write(ChannelMessage(ChannelBuffers::copiedBuffer("x")));
+    ASSERT_TRUE(future->isDone());
+    ASSERT_TRUE(future->isCompleteSuccess());
+    ASSERT_EQ(0, loop.getTaskCount());
+}
+
+TEST(ChannelGroupTest, testEncodeOnceAndClose) {
+    ManualEventLoop loopA;
+    ManualEventLoop loopB;
+    RecordingChannel a(1, &loopA);
+    RecordingChannel b(2, &loopB);
+
+    ChannelGroup group;
+    group.add(a);
+    group.add(b);
+
+    encodedCount = 0;
+    group.write(ChannelMessage(std::string("chat")), encodeUpperCase, false);
+    loopA.runTasks();
+    loopB.runTasks();
+
+    ASSERT_EQ(1, encodedCount);
+    ASSERT_EQ("CHAT", a.written[0]);
+    ASSERT_EQ("CHAT", b.written[0]);
+
+    ChannelGroupFuturePtr future = group.close();
+    loopA.runTasks();
+    ASSERT_FALSE(future->isDone());
+    loopB.runTasks();
+
+    ASSERT_TRUE(future->isDone());
+    ASSERT_TRUE(future->isCompleteSuccess());
+    ASSERT_EQ(2, future->getSuccessCount());
+    ASSERT_TRUE(group.empty());
+    ASSERT_FALSE(a.isOpen());
+    ASSERT_FALSE(b.isOpen());
+}
+
+TEST(ChannelGroupTest, testBatchAfterGroupDestroyed) {
+    ManualEventLoop loop;
+    RecordingChannel c(1, &loop);
+    ChannelGroupFuturePtr future;
+
+    {
+        ChannelGroup group;
+        group.add(c);
+        future = group.write(ChannelMessage(ChannelBuffers::copiedBuffer("x")));
+    }
+
+    // the batch finds no channel of the destroyed group.
+    ASSERT_EQ(1, loop.runTasks());
+    ASSERT_TRUE(c.written.empty());
+    ASSERT_TRUE(future->isDone());
+    ASSERT_TRUE(future->isCompleteSuccess());
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * Compares handing the operations over to the thread of an io_service by
+ * <tt>io_service::post</tt> with {@link AsioServicePool::IOService#execute}.
+ *
+ * usage: AsioServicePoolBenchmark [producers] [operations per producer]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "cetty/channel/socket/asio/AsioServicePool.h"
+
+using namespace cetty::channel::socket::asio;
+
+// only touched by the thread of the io_service.
+static long counter = 0;
+
+static boost::mutex mutex;
+static boost::condition_variable condition;
+static bool done = false;
+
+static void count() {
+    ++counter;
+}
+
+static void finish() {
+    boost::mutex::scoped_lock lock(mutex);
+    done = true;
+    condition.notify_one();
+}
+
+class CountOperation : public AsioServicePool::Operation {
+public:
+    virtual void run() { count(); }
+};
+
+class FinishOperation : public AsioServicePool::Operation {
+public:
+    virtual void run() { finish(); }
+};
+
+static void post(AsioServicePool::IOService* ioService, int count) {
+    for (int i = 0; i < count; ++i) {
+        ioService->service().post(&::count);
+    }
+}
+
+static void postFinish(AsioServicePool::IOService* ioService) {
+    ioService->service().post(&::finish);
+}
+
+static void execute(AsioServicePool::IOService* ioService, int count) {
+    for (int i = 0; i < count; ++i) {
+        ioService->execute(new CountOperation);
+    }
+}
+
+static void executeFinish(AsioServicePool::IOService* ioService) {
+    ioService->execute(new FinishOperation);
+}
+
+static void benchmark(const char* name,
+                      void (*produce)(AsioServicePool::IOService*, int),
+                      void (*produceFinish)(AsioServicePool::IOService*),
+                      int producers,
+                      int count) {
+    AsioServicePool pool(1);
+    AsioServicePool::IOService& ioService = pool.at(0);
+    long operations = (long)producers * count;
+
+    counter = 0;
+    done = false;
+
+    boost::posix_time::ptime start =
+        boost::posix_time::microsec_clock::universal_time();
+
+    boost::thread_group threads;
+    for (int i = 0; i < producers; ++i) {
+        threads.create_thread(boost::bind(produce, &ioService, count));
+    }
+    threads.join_all();
+
+    boost::posix_time::ptime produced =
+        boost::posix_time::microsec_clock::universal_time();
+
+    // queued after all the others, so it runs the last.
+    produceFinish(&ioService);
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        while (!done) {
+            condition.wait(lock);
+        }
+    }
+
+    boost::posix_time::ptime end =
+        boost::posix_time::microsec_clock::universal_time();
+
+    pool.stop();
+    pool.waitForExit();
+
+    long producing = (long)(produced - start).total_microseconds();
+    long total = (long)(end - start).total_microseconds();
+
+    printf("%-8s producers: %2d, operations: %ld/%ld, producing: %ld us, "
+           "total: %ld us, %.1f ns/op\n",
+           name, producers, counter, operations, producing, total,
+           total * 1000.0 / operations);
+}
+
+int main(int argc, char* argv[]) {
+    int producers = argc > 1 ? atoi(argv[1]) : 4;
+    int count = argc > 2 ? atoi(argv[2]) : 1000000;
+
+    benchmark("post", &post, &postFinish, producers, count);
+    benchmark("execute", &execute, &executeFinish, producers, count);
+
+    return 0;
+}
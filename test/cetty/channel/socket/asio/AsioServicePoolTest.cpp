@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
+#include "cetty/channel/socket/asio/AsioServicePool.h"
+#include "cetty/util/Exception.h"
+
+using namespace cetty::util;
+using namespace cetty::channel::socket::asio;
+
+class SequenceOperation : public AsioServicePool::Operation {
+public:
+    SequenceOperation(std::vector<int>* sequence, int value)
+        : sequence(sequence), value(value) {}
+
+    virtual void run() {
+        sequence->push_back(value);
+    }
+
+private:
+    std::vector<int>* sequence;
+    int value;
+};
+
+static void executeSequence(AsioServicePool::IOService* ioService,
+                            std::vector<int>* sequence,
+                            int count) {
+    for (int i = 0; i < count; ++i) {
+        ioService->execute(new SequenceOperation(sequence, i));
+    }
+}
+
+class AsioServicePoolTest : public testing::Test {
+protected:
+    AsioServicePoolTest() : pool(3) {}
+
+    virtual void TearDown() {
+        pool.stop();
+        pool.waitForExit();
+    }
+
+    AsioServicePool pool;
+};
+
+TEST_F(AsioServicePoolTest, testRoundRobin) {
+    ASSERT_EQ(0, pool.getIOService().index());
+    ASSERT_EQ(1, pool.getIOService().index());
+    ASSERT_EQ(2, pool.getIOService().index());
+    ASSERT_EQ(0, pool.getIOService().index());
+}
+
+TEST_F(AsioServicePoolTest, testSameStrategyKeepsState) {
+    ASSERT_EQ(0, pool.getIOService().index());
+
+    // the bootstraps set the option again on every connect.
+    pool.setPlacementStrategy(AsioServicePool::ROUND_ROBIN);
+    ASSERT_EQ(1, pool.getIOService().index());
+
+    pool.setPlacementStrategy(AsioServicePool::ROUND_ROBIN);
+    ASSERT_EQ(2, pool.getIOService().index());
+}
+
+TEST_F(AsioServicePoolTest, testLeastConnections) {
+    pool.setPlacementStrategy(AsioServicePool::LEAST_CONNECTIONS);
+
+    pool.at(0).increaseChannelCount();
+    pool.at(0).increaseChannelCount();
+    pool.at(2).increaseChannelCount();
+    ASSERT_EQ(1, pool.getIOService().index());
+
+    pool.at(1).increaseChannelCount();
+    pool.at(1).increaseChannelCount();
+    pool.at(2).decreaseChannelCount();
+    ASSERT_EQ(2, pool.getIOService().index());
+}
+
+TEST_F(AsioServicePoolTest, testLeastPendingBytes) {
+    pool.setPlacementStrategy(AsioServicePool::LEAST_PENDING_BYTES);
+
+    pool.at(0).addPendingWriteBytes(1024);
+    pool.at(1).addPendingWriteBytes(512);
+    pool.at(2).addPendingWriteBytes(4096);
+    ASSERT_EQ(1, pool.getIOService().index());
+
+    pool.at(1).addPendingWriteBytes(1024);
+    ASSERT_EQ(0, pool.getIOService().index());
+}
+
+TEST_F(AsioServicePoolTest, testPowerOfTwoChoices) {
+    pool.setPlacementStrategy(AsioServicePool::POWER_OF_TWO_CHOICES);
+
+    // the most loaded one always loses the comparison.
+    for (int i = 0; i < 10; ++i) {
+        pool.at(2).increaseChannelCount();
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_NE(2, pool.getIOService().index());
+    }
+}
+
+TEST_F(AsioServicePoolTest, testUnknownStrategy) {
+    ASSERT_THROW(pool.setPlacementStrategy("unknown"), InvalidArgumentException);
+}
+
+static void countRun(boost::atomic<int>* count) {
+    ++*count;
+}
+
+TEST(AsioServicePoolAffinityTest, testCpuAffinity) {
+    std::vector<int> cpus;
+    cpus.push_back(0);
+
+    AsioServicePool pinnedPool(3, cpus);
+    ASSERT_EQ(cpus, pinnedPool.getCpuAffinity());
+
+    // the threads are pinned before they run anything.
+    boost::atomic<int> count(0);
+    for (int i = 0; i < pinnedPool.size(); ++i) {
+        pinnedPool.getIOService(i).post(boost::bind(countRun, &count));
+    }
+    while (count < pinnedPool.size()) {
+        boost::this_thread::yield();
+    }
+
+    for (int i = 0; i < pinnedPool.size(); ++i) {
+        // not supported by the operating system, or not allowed.
+        if (!pinnedPool.at(i).isPinned()) {
+            continue;
+        }
+        ASSERT_EQ(0, pinnedPool.at(i).cpu());
+    }
+
+    pinnedPool.stop();
+    pinnedPool.waitForExit();
+
+    std::vector<int> invalid;
+    invalid.push_back(-1);
+    ASSERT_THROW(AsioServicePool(3, invalid), InvalidArgumentException);
+}
+
+TEST_F(AsioServicePoolTest, testExecute) {
+    static const int PRODUCERS = 4;
+    static const int COUNT = 10000;
+
+    // all the sequences are only touched by the thread of the io_service.
+    std::vector<int> sequences[PRODUCERS];
+    boost::thread_group producers;
+
+    for (int i = 0; i < PRODUCERS; ++i) {
+        producers.create_thread(
+            boost::bind(&executeSequence, &pool.at(0), &sequences[i], COUNT));
+    }
+    producers.join_all();
+
+    pool.stop();
+    pool.waitForExit();
+    pool.at(0).service().reset();
+    pool.at(0).service().poll();
+
+    for (int i = 0; i < PRODUCERS; ++i) {
+        ASSERT_EQ(COUNT, (int)sequences[i].size());
+        for (int j = 0; j < COUNT; ++j) {
+            ASSERT_EQ(j, sequences[i][j]);
+        }
+    }
+}
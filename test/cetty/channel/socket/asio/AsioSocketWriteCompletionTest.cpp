@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/buffer/ChannelBuffers.h"
+
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/ChannelFactory.h"
+#include "cetty/channel/ChannelHandler.h"
+#include "cetty/channel/ChannelPipeline.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/channel/socket/asio/AsioClientSocketChannelFactory.h"
+#include "cetty/channel/socket/asio/AsioServerSocketChannelFactory.h"
+
+#include "cetty/bootstrap/ClientBootstrap.h"
+#include "cetty/bootstrap/ServerBootstrap.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::bootstrap;
+using namespace cetty::channel::socket::asio;
+
+static const int MESSAGE_COUNT = 256;
+static const int BURST_COUNT = 16;
+
+/**
+ * Writes a burst of one byte messages when connected, and the listener of
+ * each one writes the message after the next burst, so the writes are
+ * issued while the batch of the previous ones is being completed.
+ */
+class ListenerWriteHandler : public SimpleChannelUpstreamHandler {
+public:
+    virtual ~ListenerWriteHandler() {}
+
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "ListenerWriteHandler"; }
+
+    virtual void channelConnected(ChannelHandlerContext& ctx,
+                                  const ChannelStateEvent& e) {
+        for (int i = 0; i < BURST_COUNT; ++i) {
+            write(e.getChannel(), i);
+        }
+    }
+
+private:
+    void write(Channel& channel, int id) {
+        ChannelFuturePtr future = channel.write(
+            ChannelBuffers::copiedBuffer(std::string(1, static_cast<char>(id))));
+
+        if (id + BURST_COUNT < MESSAGE_COUNT) {
+            future->setListener(boost::bind(&ListenerWriteHandler::writeNext,
+                                            this,
+                                            _1,
+                                            id + BURST_COUNT));
+        }
+    }
+
+    void writeNext(const ChannelFuturePtr& future, int id) {
+        if (future->isSuccess()) {
+            write(future->getChannel(), id);
+        }
+    }
+};
+
+class CountingHandler : public SimpleChannelUpstreamHandler {
+public:
+    CountingHandler() : total(0) {
+        for (int i = 0; i < MESSAGE_COUNT; ++i) {
+            counts[i] = 0;
+        }
+    }
+
+    virtual ~CountingHandler() {}
+
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "CountingHandler"; }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        ChannelBufferPtr buffer = e.getMessage().smartPointer<ChannelBuffer>();
+
+        boost::mutex::scoped_lock lock(mutex);
+        while (buffer->readable()) {
+            ++counts[static_cast<unsigned char>(buffer->readByte())];
+            ++total;
+        }
+    }
+
+    int getTotal() {
+        boost::mutex::scoped_lock lock(mutex);
+        return total;
+    }
+
+    int getCount(int id) {
+        boost::mutex::scoped_lock lock(mutex);
+        return counts[id];
+    }
+
+private:
+    boost::mutex mutex;
+    int counts[MESSAGE_COUNT];
+    int total;
+};
+
+typedef boost::intrusive_ptr<ListenerWriteHandler> ListenerWriteHandlerPtr;
+typedef boost::intrusive_ptr<CountingHandler> CountingHandlerPtr;
+
+TEST(AsioSocketWriteCompletionTest, testWriteFromListener) {
+    ServerBootstrap sb(ChannelFactoryPtr(new AsioServerSocketChannelFactory()));
+    ClientBootstrap cb(ChannelFactoryPtr(new AsioClientSocketChannelFactory()));
+
+    ListenerWriteHandlerPtr sh(new ListenerWriteHandler);
+    CountingHandlerPtr ch(new CountingHandler);
+
+    sb.getPipeline()->addFirst("server-handler",
+                               boost::dynamic_pointer_cast<ChannelHandler>(sh));
+    cb.getPipeline()->addFirst("client-handler",
+                               boost::dynamic_pointer_cast<ChannelHandler>(ch));
+
+    Channel* sc = sb.bind(SocketAddress(IpAddress::IPv4, 0));
+    int port = sc->getLocalAddress().port();
+
+    ChannelFuturePtr ccf = cb.connect(SocketAddress("127.0.0.1", port));
+    ASSERT_TRUE(ccf->awaitUninterruptibly().isSuccess());
+
+    for (int i = 0; i < 5000 && ch->getTotal() < MESSAGE_COUNT; ++i) {
+        boost::this_thread::sleep(boost::posix_time::millisec(1));
+    }
+
+    // gives a resent message the chance to arrive.
+    boost::this_thread::sleep(boost::posix_time::millisec(50));
+
+    ccf->getChannel().close()->awaitUninterruptibly();
+    sc->close()->awaitUninterruptibly();
+
+    // every message is written exactly once, none is written again by the
+    // flush from the listener.
+    ASSERT_EQ(MESSAGE_COUNT, ch->getTotal());
+    for (int i = 0; i < MESSAGE_COUNT; ++i) {
+        ASSERT_EQ(1, ch->getCount(i)) << "message " << i;
+    }
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "cetty/util/Timeout.h"
+#include "cetty/util/Exception.h"
+#include "cetty/util/HashedWheelTimer.h"
+#include "cetty/channel/socket/epoll/EpollEventLoopPool.h"
+
+using namespace cetty::util;
+using namespace cetty::channel::socket::epoll;
+
+// records the thread and the order of the expired timeouts.
+class ExpireRecorder {
+public:
+    void expire(Timeout& timeout, int id) {
+        boost::mutex::scoped_lock lock(mutex);
+        threadIds.push_back(boost::this_thread::get_id());
+        ids.push_back(id);
+        expired.notify_all();
+    }
+
+    bool waitFor(std::size_t count, int millis) {
+        boost::mutex::scoped_lock lock(mutex);
+        boost::system_time deadline =
+            boost::get_system_time() + boost::posix_time::milliseconds(millis);
+
+        while (ids.size() < count) {
+            if (!expired.timed_wait(lock, deadline)) {
+                return ids.size() >= count;
+            }
+        }
+        return true;
+    }
+
+    boost::mutex mutex;
+    boost::condition_variable expired;
+    std::vector<boost::thread::id> threadIds;
+    std::vector<int> ids;
+};
+
+TEST(EpollEventLoopPoolTest, testTimerTicksInLoopThread) {
+    EpollEventLoopPool pool(2);
+    ExpireRecorder recorder;
+
+    EpollEventLoopPool::EventLoop& loop = pool.getEventLoop(1);
+    const TimerPtr& timer = loop.getTimer();
+    ASSERT_NE(pool.getEventLoop(0).getTimer(), timer);
+
+    boost::system_time start = boost::get_system_time();
+
+    // scheduled from this thread, expired in the loop thread.
+    timer->newTimeout(boost::bind(&ExpireRecorder::expire, &recorder, _1, 150), 150);
+    timer->newTimeout(boost::bind(&ExpireRecorder::expire, &recorder, _1, 20), 20);
+    TimeoutPtr cancelled = timer->newTimeout(
+        boost::bind(&ExpireRecorder::expire, &recorder, _1, 50), 50);
+    cancelled->cancel();
+
+    ASSERT_TRUE(recorder.waitFor(2, 2000));
+    ASSERT_GE((boost::get_system_time() - start).total_milliseconds(), 150);
+
+    ASSERT_EQ(2U, recorder.ids.size());
+    ASSERT_EQ(20, recorder.ids[0]);
+    ASSERT_EQ(150, recorder.ids[1]);
+    ASSERT_EQ(loop.getThreadId(), recorder.threadIds[0]);
+    ASSERT_EQ(loop.getThreadId(), recorder.threadIds[1]);
+
+    // ticks again once the wheel was idle.
+    timer->newTimeout(boost::bind(&ExpireRecorder::expire, &recorder, _1, 10), 10);
+    ASSERT_TRUE(recorder.waitFor(3, 2000));
+    ASSERT_EQ(10, recorder.ids[2]);
+
+    pool.stop();
+    pool.waitForExit();
+}
+
+TEST(EpollEventLoopPoolTest, testTimerStopped) {
+    EpollEventLoopPool pool(1);
+    ExpireRecorder recorder;
+
+    const TimerPtr& timer = pool.getEventLoop(0).getTimer();
+    TimeoutPtr timeout = timer->newTimeout(
+        boost::bind(&ExpireRecorder::expire, &recorder, _1, 1), 50);
+
+    timer->stop();
+    ASSERT_TRUE(timeout->isCancelled());
+    ASSERT_FALSE(recorder.waitFor(1, 200));
+    ASSERT_THROW(timer->newTimeout(
+        boost::bind(&ExpireRecorder::expire, &recorder, _1, 2), 10),
+        IllegalStateException);
+
+    pool.stop();
+    pool.waitForExit();
+}
+
+static void takeEventLoops(EpollEventLoopPool* pool,
+                           int count,
+                           std::vector<EpollEventLoopPool::EventLoop*>* taken) {
+    for (int i = 0; i < count; ++i) {
+        taken->push_back(&pool->getEventLoop());
+    }
+}
+
+TEST(EpollEventLoopPoolTest, testGetEventLoopFromThreads) {
+    static const int THREAD_COUNT = 4;
+    static const int TAKE_COUNT = 3000;
+
+    EpollEventLoopPool pool(3);
+    std::vector<std::vector<EpollEventLoopPool::EventLoop*> > taken(THREAD_COUNT);
+
+    boost::thread_group threads;
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        threads.create_thread(boost::bind(&takeEventLoops,
+                                          &pool, TAKE_COUNT, &taken[i]));
+    }
+    threads.join_all();
+
+    // still round-robin, each loop is taken as many times as the others.
+    std::vector<int> counts(pool.size(), 0);
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        for (std::size_t j = 0; j < taken[i].size(); ++j) {
+            for (int k = 0; k < pool.size(); ++k) {
+                if (taken[i][j] == &pool.getEventLoop(k)) {
+                    ++counts[k];
+                }
+            }
+        }
+    }
+
+    for (int k = 0; k < pool.size(); ++k) {
+        ASSERT_EQ(THREAD_COUNT * TAKE_COUNT / pool.size(), counts[k]);
+    }
+
+    pool.stop();
+    pool.waitForExit();
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+
+#include "cetty/buffer/ChannelBuffer.h"
+#include "cetty/buffer/ChannelBuffers.h"
+
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/ChannelFactory.h"
+#include "cetty/channel/ChannelStateEvent.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/DefaultFileRegion.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/channel/socket/epoll/EpollClientSocketChannelFactory.h"
+#include "cetty/channel/socket/epoll/EpollServerSocketChannelFactory.h"
+#include "cetty/channel/socket/epoll/DefaultEpollSocketChannelConfig.h"
+
+#include "cetty/bootstrap/ClientBootstrap.h"
+#include "cetty/bootstrap/ServerBootstrap.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::bootstrap;
+using namespace cetty::channel::socket::epoll;
+
+// larger than the socket buffers, so the region is transferred in turns.
+static const int FILE_SIZE = 4 * 1024 * 1024;
+
+/**
+ * Writes a chunk header, a file region and a chunk trailer in one vector
+ * message when connected, as the chunked HttpMessageEncoder does.
+ */
+class RegionWriteHandler : public SimpleChannelUpstreamHandler {
+public:
+    RegionWriteHandler(int fd) : fd(fd) {}
+    virtual ~RegionWriteHandler() {}
+
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "RegionWriteHandler"; }
+
+    virtual void channelConnected(ChannelHandlerContext& ctx,
+                                  const ChannelStateEvent& e) {
+        FileRegionPtr region(new DefaultFileRegion(fd, 0, FILE_SIZE));
+
+        boost::mutex::scoped_lock lock(mutex);
+        future = e.getChannel().write(ChannelMessage(
+            ChannelMessage(ChannelBuffers::copiedBuffer(std::string("head"))),
+            ChannelMessage(region),
+            ChannelMessage(ChannelBuffers::copiedBuffer(std::string("tail")))));
+    }
+
+    ChannelFuturePtr getFuture() {
+        boost::mutex::scoped_lock lock(mutex);
+        return future;
+    }
+
+private:
+    int fd;
+    boost::mutex mutex;
+    ChannelFuturePtr future;
+};
+
+class ReceiveHandler : public SimpleChannelUpstreamHandler {
+public:
+    virtual ~ReceiveHandler() {}
+
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "ReceiveHandler"; }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        ChannelBufferPtr buffer = e.getMessage().smartPointer<ChannelBuffer>();
+
+        boost::mutex::scoped_lock lock(mutex);
+        std::string bytes;
+        buffer->readBytes(bytes);
+        received += bytes;
+    }
+
+    std::string getReceived() {
+        boost::mutex::scoped_lock lock(mutex);
+        return received;
+    }
+
+private:
+    boost::mutex mutex;
+    std::string received;
+};
+
+class ConnectCounter : public SimpleChannelUpstreamHandler {
+public:
+    ConnectCounter() : count(0) {}
+    virtual ~ConnectCounter() {}
+
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "ConnectCounter"; }
+
+    virtual void channelConnected(ChannelHandlerContext& ctx,
+                                  const ChannelStateEvent& e) {
+        boost::mutex::scoped_lock lock(mutex);
+        ++count;
+    }
+
+    int getCount() {
+        boost::mutex::scoped_lock lock(mutex);
+        return count;
+    }
+
+private:
+    boost::mutex mutex;
+    int count;
+};
+
+typedef boost::intrusive_ptr<RegionWriteHandler> RegionWriteHandlerPtr;
+typedef boost::intrusive_ptr<ReceiveHandler> ReceiveHandlerPtr;
+typedef boost::intrusive_ptr<ConnectCounter> ConnectCounterPtr;
+
+TEST(EpollSocketChannelTest, testWriteFileRegionInVector) {
+    FILE* file = ::tmpfile();
+    ASSERT_TRUE(file != NULL);
+
+    std::string content(FILE_SIZE, '\0');
+    for (int i = 0; i < FILE_SIZE; ++i) {
+        content[i] = static_cast<char>('a' + i % 26);
+    }
+    ::fwrite(content.data(), 1, content.size(), file);
+    ::fflush(file);
+
+    ServerBootstrap sb(ChannelFactoryPtr(new EpollServerSocketChannelFactory()));
+    ClientBootstrap cb(ChannelFactoryPtr(new EpollClientSocketChannelFactory()));
+
+    RegionWriteHandlerPtr sh(new RegionWriteHandler(::fileno(file)));
+    ReceiveHandlerPtr ch(new ReceiveHandler);
+
+    sb.getPipeline()->addFirst("server-handler",
+                               boost::dynamic_pointer_cast<ChannelHandler>(sh));
+    cb.getPipeline()->addFirst("client-handler",
+                               boost::dynamic_pointer_cast<ChannelHandler>(ch));
+
+    Channel* sc = sb.bind(SocketAddress(IpAddress::IPv4, 0));
+    int port = sc->getLocalAddress().port();
+
+    ChannelFuturePtr ccf = cb.connect(SocketAddress("127.0.0.1", port));
+    ASSERT_TRUE(ccf->awaitUninterruptibly().isSuccess());
+
+    std::string expected = "head" + content + "tail";
+    for (int i = 0; i < 5000 && ch->getReceived().size() < expected.size(); ++i) {
+        boost::this_thread::sleep(boost::posix_time::millisec(1));
+    }
+
+    ccf->getChannel().close()->awaitUninterruptibly();
+    sc->close()->awaitUninterruptibly();
+    ::fclose(file);
+
+    ASSERT_EQ(expected.size(), ch->getReceived().size());
+    ASSERT_TRUE(expected == ch->getReceived());
+
+    // the future of the vector is notified with the trailer.
+    ASSERT_TRUE(sh->getFuture());
+    ASSERT_TRUE(sh->getFuture()->isSuccess());
+}
+
+TEST(EpollSocketChannelTest, testCloseServerClosesChildren) {
+    static const int CLIENT_COUNT = 8;
+
+    ServerBootstrap sb(ChannelFactoryPtr(new EpollServerSocketChannelFactory(4)));
+    ClientBootstrap cb(ChannelFactoryPtr(new EpollClientSocketChannelFactory(2)));
+
+    ConnectCounterPtr counter(new ConnectCounter);
+    sb.getPipeline()->addFirst("counter",
+                               boost::dynamic_pointer_cast<ChannelHandler>(counter));
+    cb.getPipeline()->addFirst("client-handler", ChannelHandlerPtr(new ReceiveHandler));
+
+    Channel* sc = sb.bind(SocketAddress(IpAddress::IPv4, 0));
+    int port = sc->getLocalAddress().port();
+
+    std::vector<Channel*> clients;
+    for (int i = 0; i < CLIENT_COUNT; ++i) {
+        ChannelFuturePtr f = cb.connect(SocketAddress("127.0.0.1", port));
+        ASSERT_TRUE(f->awaitUninterruptibly().isSuccess());
+        clients.push_back(&f->getChannel());
+    }
+
+    for (int i = 0; i < 2000 && counter->getCount() < CLIENT_COUNT; ++i) {
+        boost::this_thread::sleep(boost::posix_time::millisec(1));
+    }
+    ASSERT_EQ(CLIENT_COUNT, counter->getCount());
+
+    // half of the children close from the other side at the same time.
+    for (int i = 0; i < CLIENT_COUNT / 2; ++i) {
+        clients[i]->close();
+    }
+
+    // the children are closed in their own loops, so the clients see it.
+    ASSERT_TRUE(sc->close()->awaitUninterruptibly(2000));
+    for (int i = 0; i < CLIENT_COUNT; ++i) {
+        ASSERT_TRUE(clients[i]->getCloseFuture()->awaitUninterruptibly(2000));
+    }
+}
+
+TEST(EpollSocketChannelTest, testReapplyOptions) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(fd, 0);
+
+    DefaultEpollSocketChannelConfig config(fd);
+    config.setTcpNoDelay(true);
+    config.setSoLinger(3);
+    config.setSendBufferSize(64 * 1024);
+    int sendBufferSize = config.getSendBufferSize();
+
+    // swaps a fresh socket in under the same descriptor, as a connect to
+    // the next address does.
+    int newFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(fd, ::dup2(newFd, fd));
+    ::close(newFd);
+    ASSERT_FALSE(config.isTcpNoDelay());
+
+    ASSERT_TRUE(config.reapplyOptions());
+    ASSERT_TRUE(config.isTcpNoDelay());
+    ASSERT_EQ(3, config.getSoLinger());
+    ASSERT_EQ(sendBufferSize, config.getSendBufferSize());
+
+    ::close(fd);
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/handler/codec/compression/ZlibWrapper.h"
+#include "cetty/handler/codec/compression/ZlibDeflater.h"
+#include "cetty/handler/codec/compression/ZlibInflater.h"
+#include "cetty/handler/codec/compression/ZlibStreamPool.h"
+#include "cetty/handler/codec/compression/CompressionException.h"
+
+using namespace cetty::buffer;
+using namespace cetty::handler::codec::compression;
+
+static std::string contentOf(const ChannelBufferPtr& buffer) {
+    std::string str;
+    buffer->getBytes(buffer->readerIndex(), str, buffer->readableBytes());
+    return str;
+}
+
+static std::string makeText(int size) {
+    std::string text;
+
+    for (int i = 0; text.size() < static_cast<size_t>(size); ++i) {
+        text += "line ";
+        text += static_cast<char>('a' + i % 26);
+        text += static_cast<char>('0' + i % 7);
+        text += "\n";
+    }
+
+    text.resize(size);
+    return text;
+}
+
+// compresses the text in pieces, then decompresses in other pieces.
+static std::string roundTrip(const ZlibWrapper& wrapper,
+                             const ZlibWrapper& inflaterWrapper,
+                             const std::string& text,
+                             int deflateSize,
+                             int inflateSize) {
+    std::string compressed;
+    {
+        ZlibDeflater deflater(wrapper, 6);
+
+        for (size_t i = 0; i < text.size(); i += deflateSize) {
+            compressed += contentOf(deflater.deflate(
+                ChannelBuffers::copiedBuffer(text.substr(i, deflateSize)),
+                i / deflateSize % 2 == 0));
+        }
+
+        compressed += contentOf(deflater.finish());
+        EXPECT_TRUE(deflater.isFinished());
+    }
+
+    std::string decompressed;
+    ZlibInflater inflater(inflaterWrapper);
+
+    for (size_t i = 0; i < compressed.size(); i += inflateSize) {
+        decompressed += contentOf(inflater.inflate(
+            ChannelBuffers::copiedBuffer(compressed.substr(i, inflateSize))));
+    }
+
+    EXPECT_TRUE(inflater.isFinished());
+    return decompressed;
+}
+
+TEST(ZlibTest, testStreamingRoundTrip) {
+    std::string text = makeText(200 * 1024);
+
+    EXPECT_EQ(text, roundTrip(ZlibWrapper::GZIP, ZlibWrapper::GZIP, text, 4096, 1));
+    EXPECT_EQ(text, roundTrip(ZlibWrapper::GZIP, ZlibWrapper::GZIP, text, 100000, 333));
+    EXPECT_EQ(text, roundTrip(ZlibWrapper::ZLIB, ZlibWrapper::ZLIB, text, 7, 70000));
+    EXPECT_EQ(text, roundTrip(ZlibWrapper::NONE, ZlibWrapper::NONE, text, 1000, 1000));
+
+    // guesses the wrapper, even from the bytes one by one.
+    EXPECT_EQ(text, roundTrip(ZlibWrapper::ZLIB, ZlibWrapper::ZLIB_OR_NONE, text, 5000, 1));
+    EXPECT_EQ(text, roundTrip(ZlibWrapper::NONE, ZlibWrapper::ZLIB_OR_NONE, text, 5000, 1));
+}
+
+TEST(ZlibTest, testFlushedBytesAreDecodable) {
+    ZlibDeflater deflater(ZlibWrapper::GZIP, 6);
+    ZlibInflater inflater(ZlibWrapper::GZIP);
+
+    ChannelBufferPtr first = deflater.deflate(
+                                 ChannelBuffers::copiedBuffer(std::string("hello ")), true);
+    ASSERT_EQ("hello ", contentOf(inflater.inflate(first)));
+
+    ChannelBufferPtr second = deflater.deflate(
+                                  ChannelBuffers::copiedBuffer(std::string("world")), true);
+    ASSERT_EQ("world", contentOf(inflater.inflate(second)));
+
+    ASSERT_FALSE(inflater.isFinished());
+    ASSERT_FALSE(inflater.inflate(deflater.finish())->readable());
+    ASSERT_TRUE(inflater.isFinished());
+
+    // the bytes after the end are ignored.
+    ASSERT_FALSE(inflater.inflate(
+                     ChannelBuffers::copiedBuffer(std::string("garbage")))->readable());
+}
+
+TEST(ZlibTest, testReuseStreams) {
+    int cached = ZlibStreamPool::getCachedCount();
+
+    for (int i = 0; i < 3; ++i) {
+        ZlibDeflater deflater(ZlibWrapper::GZIP, 1);
+        deflater.deflate(ChannelBuffers::copiedBuffer(std::string("reused")), false);
+        deflater.finish();
+    }
+
+    // the stream is given back once finished, then taken again.
+    ASSERT_EQ(cached + 1, ZlibStreamPool::getCachedCount());
+
+    {
+        ZlibInflater inflater(ZlibWrapper::ZLIB);
+        ASSERT_THROW(inflater.inflate(
+                         ChannelBuffers::copiedBuffer(std::string("not compressed"))),
+                     CompressionException);
+    }
+
+    ASSERT_THROW(ZlibDeflater(ZlibWrapper::ZLIB, 10),
+                 cetty::util::InvalidArgumentException);
+    ASSERT_THROW(ZlibDeflater(ZlibWrapper::ZLIB_OR_NONE, 6),
+                 cetty::util::InvalidArgumentException);
+}
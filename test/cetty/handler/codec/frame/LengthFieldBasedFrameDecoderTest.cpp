@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/UpstreamMessageEvent.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/channel/ChannelTestUtil.h"
+#include "cetty/handler/codec/frame/LengthFieldBasedFrameDecoder.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::handler::codec::frame;
+
+class FrameRecorder : public SimpleChannelUpstreamHandler {
+public:
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "FrameRecorder"; }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        frames.push_back(e.getMessage().smartPointer<ChannelBuffer>());
+    }
+
+    std::vector<ChannelBufferPtr> frames;
+};
+
+// receives the frames, in chunks of the given size, into one read buffer
+// like a channel which owns its read buffer.
+static void receive(const std::vector<int>& lengths,
+                    int chunkSize,
+                    std::vector<ChannelBufferPtr>& frames) {
+    OwnBufferChannel channel;
+    DiscardingSink sink;
+    DefaultChannelPipeline pipeline;
+    FrameRecorder* recorder = new FrameRecorder;
+
+    pipeline.attach(&channel, &sink);
+    pipeline.addLast("decoder", ChannelHandlerPtr(
+                         new LengthFieldBasedFrameDecoder(1024 * 1024, 0, 4, 0, 4)));
+    pipeline.addLast("recorder", ChannelHandlerPtr(recorder));
+
+    ChannelBufferPtr stream = ChannelBuffers::dynamicBuffer();
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        stream->writeInt(lengths[i]);
+        for (int j = 0; j < lengths[i]; ++j) {
+            stream->writeByte((boost::int8_t)(i + j));
+        }
+    }
+
+    ChannelBufferPtr readBuffer = ChannelBuffers::buffer(chunkSize * 4);
+    while (stream->readable()) {
+        if (readBuffer->writableBytes() < chunkSize) {
+            // only reuse the buffer when no frame refers to it.
+            if (readBuffer->refcount() == 1) {
+                readBuffer->discardReadBytes();
+            }
+            if (readBuffer->writableBytes() < chunkSize) {
+                readBuffer = ChannelBuffers::buffer(chunkSize * 4);
+            }
+        }
+
+        readBuffer->writeBytes(*stream, std::min(chunkSize, stream->readableBytes()));
+        pipeline.sendUpstream(UpstreamMessageEvent(channel,
+                              ChannelMessage(readBuffer),
+                              SocketAddress::NULL_ADDRESS));
+    }
+
+    frames = recorder->frames;
+}
+
+TEST(LengthFieldBasedFrameDecoderTest, testFramesSurviveNextReads) {
+    int sizes[] = { 3, 100, 5000, 0, 70000, 1, 2048, 12 };
+    std::vector<int> lengths(sizes, sizes + sizeof(sizes) / sizeof(int));
+
+    int chunkSizes[] = { 1, 7, 1000, 4096 };
+
+    for (int k = 0; k < 4; ++k) {
+        std::vector<ChannelBufferPtr> frames;
+        receive(lengths, chunkSizes[k], frames);
+
+        ASSERT_EQ(lengths.size(), frames.size());
+        for (size_t i = 0; i < frames.size(); ++i) {
+            ASSERT_EQ(lengths[i], frames[i]->readableBytes());
+
+            for (int j = 0; j < lengths[i]; ++j) {
+                ASSERT_EQ((boost::int8_t)(i + j),
+                          frames[i]->getByte(frames[i]->readerIndex() + j));
+            }
+        }
+    }
+}
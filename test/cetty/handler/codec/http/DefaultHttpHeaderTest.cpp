@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/handler/codec/http/HttpHeaders.h"
+#include "cetty/handler/codec/http/DefaultHttpHeader.h"
+
+using namespace cetty::buffer;
+using namespace cetty::handler::codec::http;
+
+static void addFrom(DefaultHttpHeader& header,
+                    const ChannelBufferPtr& buffer,
+                    const std::string& name,
+                    const std::string& value) {
+    int nameIndex = buffer->writerIndex();
+    buffer->writeBytes(name);
+    int valueIndex = buffer->writerIndex();
+    buffer->writeBytes(value);
+
+    const char* bytes = buffer->array().data();
+    header.add(buffer,
+               bytes + nameIndex, static_cast<int>(name.size()),
+               bytes + valueIndex, static_cast<int>(value.size()));
+}
+
+TEST(DefaultHttpHeaderTest, testWellKnownNames) {
+    DefaultHttpHeader header;
+
+    header.add("content-length", "10");
+    header.add(HttpHeaders::Names::HOST, "localhost");
+
+    ASSERT_EQ("10", header.get(HttpHeaders::Names::CONTENT_LENGTH));
+    ASSERT_EQ("10", header.get("Content-Length"));
+    ASSERT_EQ("localhost", header.get("HOST"));
+    ASSERT_TRUE(header.contains(HttpHeaders::Names::HOST));
+    ASSERT_FALSE(header.contains(HttpHeaders::Names::CONTENT_TYPE));
+
+    // the interned names keep their canonical spelling.
+    HttpHeader::StringList names = header.getNames();
+    ASSERT_EQ(2U, names.size());
+    ASSERT_EQ("Content-Length", names[0]);
+    ASSERT_EQ("Host", names[1]);
+
+    header.set(HttpHeaders::Names::CONTENT_LENGTH, 20);
+    ASSERT_EQ("20", header.get("content-length"));
+
+    header.remove("HOST");
+    ASSERT_TRUE(header.get(HttpHeaders::Names::HOST).empty());
+}
+
+TEST(DefaultHttpHeaderTest, testReferencedHeaders) {
+    DefaultHttpHeader header;
+    ChannelBufferPtr buffer = ChannelBuffers::buffer(256);
+
+    addFrom(header, buffer, "Connection", "keep-alive");
+    addFrom(header, buffer, "X-Custom", "first value");
+    addFrom(header, buffer, "x-custom", "second value");
+    header.add("X-Custom", "third value");
+
+    ASSERT_EQ(2, buffer->refcount());
+
+    ASSERT_EQ("keep-alive", header.get(HttpHeaders::Names::CONNECTION));
+    // the last added value is found first.
+    ASSERT_EQ("third value", header.get("X-CUSTOM"));
+
+    HttpHeader::StringList values = header.gets("X-Custom");
+    ASSERT_EQ(3U, values.size());
+    ASSERT_EQ("second value", values[1]);
+
+    HttpHeader::NameValueList all = header.gets();
+    ASSERT_EQ(4U, all.size());
+    ASSERT_EQ("Connection", all[0].first);
+    ASSERT_EQ("x-custom", all[2].first);
+
+    header.remove("X-Custom", "SECOND VALUE");
+    ASSERT_EQ(2U, header.gets("X-Custom").size());
+
+    header.clear();
+    ASSERT_EQ(1, buffer->refcount());
+    ASSERT_TRUE(header.gets().empty());
+
+    // reuses the entries.
+    addFrom(header, buffer, "Accept", "*/*");
+    ASSERT_EQ("*/*", header.get(HttpHeaders::Names::ACCEPT));
+}
+
+TEST(DefaultHttpHeaderTest, testInvalidReferencedHeader) {
+    DefaultHttpHeader header;
+    ChannelBufferPtr buffer = ChannelBuffers::buffer(256);
+
+    ASSERT_THROW(addFrom(header, buffer, "Bad Name", "value"),
+                 cetty::util::InvalidArgumentException);
+    ASSERT_TRUE(header.gets().empty());
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <boost/thread.hpp>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/Channel.h"
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/ChannelPipelineFactory.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#if defined(__linux__)
+#include "cetty/channel/socket/epoll/EpollClientSocketChannelFactory.h"
+#include "cetty/channel/socket/epoll/EpollServerSocketChannelFactory.h"
+#else
+#include "cetty/channel/socket/asio/AsioClientSocketChannelFactory.h"
+#include "cetty/channel/socket/asio/AsioServerSocketChannelFactory.h"
+#endif
+#include "cetty/bootstrap/ServerBootstrap.h"
+#include "cetty/handler/codec/http/HttpHeaders.h"
+#include "cetty/handler/codec/http/HttpMethod.h"
+#include "cetty/handler/codec/http/HttpVersion.h"
+#include "cetty/handler/codec/http/HttpResponseStatus.h"
+#include "cetty/handler/codec/http/DefaultHttpRequest.h"
+#include "cetty/handler/codec/http/DefaultHttpResponse.h"
+#include "cetty/handler/codec/http/HttpRequestDecoder.h"
+#include "cetty/handler/codec/http/HttpResponseEncoder.h"
+#include "cetty/handler/codec/http/HttpConnectionPool.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::bootstrap;
+using namespace cetty::handler::codec::http;
+
+// the pool works over any client factory, the epoll one is used where
+// it is available.
+#if defined(__linux__)
+typedef cetty::channel::socket::epoll::EpollClientSocketChannelFactory ClientSocketChannelFactory;
+typedef cetty::channel::socket::epoll::EpollServerSocketChannelFactory ServerSocketChannelFactory;
+#else
+typedef cetty::channel::socket::asio::AsioClientSocketChannelFactory ClientSocketChannelFactory;
+typedef cetty::channel::socket::asio::AsioServerSocketChannelFactory ServerSocketChannelFactory;
+#endif
+
+// responds "ok" to every request, keeping the connection alive.
+class OkHandler : public SimpleChannelUpstreamHandler {
+public:
+    virtual ChannelHandlerPtr clone() { return ChannelHandlerPtr(new OkHandler); }
+    virtual std::string toString() const { return "OkHandler"; }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        // the decoder sends the requests up as HttpMessagePtr.
+        HttpMessagePtr message = e.getMessage().smartPointer<HttpMessage>();
+        if (!boost::dynamic_pointer_cast<HttpRequest>(message)) {
+            return;
+        }
+
+        HttpResponsePtr response(
+            new DefaultHttpResponse(HttpVersion::HTTP_1_1, HttpResponseStatus::OK));
+        response->setContent(ChannelBuffers::copiedBuffer(std::string("ok")));
+        response->setHeader(HttpHeaders::Names::CONTENT_LENGTH, 2);
+
+        e.getChannel().write(ChannelMessage(response));
+    }
+};
+
+class OkPipelineFactory : public ChannelPipelineFactory {
+public:
+    virtual ChannelPipeline* getPipeline() {
+        ChannelPipeline* pipeline = Channels::pipeline();
+
+        pipeline->addLast("decoder", ChannelHandlerPtr(new HttpRequestDecoder()));
+        pipeline->addLast("encoder", ChannelHandlerPtr(new HttpResponseEncoder()));
+        pipeline->addLast("handler", ChannelHandlerPtr(new OkHandler()));
+
+        return pipeline;
+    }
+};
+
+class HttpConnectionPoolTest : public ::testing::Test {
+protected:
+    HttpConnectionPoolTest()
+        : server(ChannelFactoryPtr(new ServerSocketChannelFactory())),
+          serverChannel(NULL),
+          port(0) {
+    }
+
+    virtual void SetUp() {
+        server.setPipelineFactory(ChannelPipelineFactoryPtr(new OkPipelineFactory));
+        serverChannel = server.bind(SocketAddress(IpAddress::IPv4, 0));
+        port = serverChannel->getLocalAddress().port();
+    }
+
+    virtual void TearDown() {
+        serverChannel->close()->awaitUninterruptibly();
+        server.releaseExternalResources();
+    }
+
+    HttpRequestPtr newRequest() {
+        HttpRequestPtr request(
+            new DefaultHttpRequest(HttpVersion::HTTP_1_1, HttpMethod::HM_GET, "/"));
+        request->setHeader(HttpHeaders::Names::HOST, "127.0.0.1");
+        return request;
+    }
+
+    // waits for the condition a while, as the connections are released and
+    // closed in the I/O threads.
+    template<typename Condition>
+    bool eventually(Condition condition) {
+        for (int i = 0; i < 200; ++i) {
+            if (condition()) {
+                return true;
+            }
+            boost::this_thread::sleep(boost::posix_time::millisec(10));
+        }
+        return false;
+    }
+
+    ServerBootstrap server;
+    Channel* serverChannel;
+    int port;
+};
+
+struct IdleCountIs {
+    IdleCountIs(const HttpConnectionPool& pool, int port, int count)
+        : pool(pool), port(port), count(count) {}
+
+    bool operator()() const {
+        return pool.getIdleConnectionCount("127.0.0.1", port) == count;
+    }
+
+    const HttpConnectionPool& pool;
+    int port;
+    int count;
+};
+
+struct ConnectionCountIs {
+    ConnectionCountIs(const HttpConnectionPool& pool, int port, int count)
+        : pool(pool), port(port), count(count) {}
+
+    bool operator()() const {
+        return pool.getConnectionCount("127.0.0.1", port) == count;
+    }
+
+    const HttpConnectionPool& pool;
+    int port;
+    int count;
+};
+
+TEST_F(HttpConnectionPoolTest, testReuseReleasedConnection) {
+    HttpConnectionPool pool(
+        ChannelFactoryPtr(new ClientSocketChannelFactory()), 4, 60000);
+
+    HttpResponseFuturePtr first = pool.request("127.0.0.1", port, newRequest());
+    ASSERT_TRUE(first->awaitUninterruptibly().isSuccess());
+    ASSERT_TRUE(eventually(IdleCountIs(pool, port, 1)));
+
+    HttpResponseFuturePtr second = pool.request("127.0.0.1", port, newRequest());
+    ASSERT_TRUE(second->awaitUninterruptibly().isSuccess());
+
+    ASSERT_EQ(1, pool.getMissCount());
+    ASSERT_EQ(1, pool.getHitCount());
+    ASSERT_EQ(1, pool.getConnectionCount("127.0.0.1", port));
+
+    pool.releaseExternalResources();
+}
+
+TEST_F(HttpConnectionPoolTest, testWaitForConnectionAtCap) {
+    HttpConnectionPool pool(
+        ChannelFactoryPtr(new ClientSocketChannelFactory()), 1, 60000);
+
+    HttpResponseFuturePtr first = pool.request("127.0.0.1", port, newRequest());
+    HttpResponseFuturePtr second = pool.request("127.0.0.1", port, newRequest());
+
+    // the second one is queued, not opening another connection.
+    ASSERT_EQ(1, pool.getWaitCount());
+    ASSERT_EQ(1, pool.getMissCount());
+    ASSERT_EQ(1, pool.getConnectionCount("127.0.0.1", port));
+
+    // and is sent over the first connection once its response has come.
+    ASSERT_TRUE(first->awaitUninterruptibly().isSuccess());
+    ASSERT_TRUE(second->awaitUninterruptibly().isSuccess());
+
+    ASSERT_EQ(1, pool.getMissCount());
+    ASSERT_EQ(0, pool.getHitCount());
+    ASSERT_EQ(1, pool.getConnectionCount("127.0.0.1", port));
+    ASSERT_TRUE(eventually(IdleCountIs(pool, port, 1)));
+
+    pool.releaseExternalResources();
+}
+
+TEST_F(HttpConnectionPoolTest, testEvictIdleConnection) {
+    HttpConnectionPool pool(
+        ChannelFactoryPtr(new ClientSocketChannelFactory()), 4, 100);
+
+    HttpResponseFuturePtr future = pool.request("127.0.0.1", port, newRequest());
+    ASSERT_TRUE(future->awaitUninterruptibly().isSuccess());
+    ASSERT_TRUE(eventually(IdleCountIs(pool, port, 1)));
+
+    // closed after the idle timeout.
+    ASSERT_TRUE(eventually(ConnectionCountIs(pool, port, 0)));
+    ASSERT_EQ(0, pool.getIdleConnectionCount("127.0.0.1", port));
+
+    pool.releaseExternalResources();
+}
+
+TEST_F(HttpConnectionPoolTest, testDestroyWithIdleConnection) {
+    {
+        HttpConnectionPool pool(
+            ChannelFactoryPtr(new ClientSocketChannelFactory()), 4, 100);
+
+        HttpResponseFuturePtr future = pool.request("127.0.0.1", port, newRequest());
+        ASSERT_TRUE(future->awaitUninterruptibly().isSuccess());
+        ASSERT_TRUE(eventually(IdleCountIs(pool, port, 1)));
+
+        pool.releaseExternalResources();
+    }
+
+    // the idle timeout must not touch the destroyed pool.
+    boost::this_thread::sleep(boost::posix_time::millisec(200));
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <cstdlib>
+#include <vector>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/NullChannel.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/AbstractChannelSink.h"
+#include "cetty/channel/UpstreamMessageEvent.h"
+#include "cetty/channel/DownstreamMessageEvent.h"
+#include "cetty/handler/codec/compression/ZlibInflater.h"
+#include "cetty/handler/codec/http/HttpHeaders.h"
+#include "cetty/handler/codec/http/HttpVersion.h"
+#include "cetty/handler/codec/http/HttpResponseStatus.h"
+#include "cetty/handler/codec/http/DefaultHttpChunk.h"
+#include "cetty/handler/codec/http/DefaultHttpResponse.h"
+#include "cetty/handler/codec/http/HttpRequestDecoder.h"
+#include "cetty/handler/codec/http/HttpContentCompressor.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::handler::codec::http;
+using namespace cetty::handler::codec::compression;
+
+static std::string contentOf(const ChannelBufferPtr& content) {
+    std::string str;
+    content->getBytes(content->readerIndex(), str, content->readableBytes());
+    return str;
+}
+
+// records the written responses and the content of the chunks.
+class WriteRecorder : public AbstractChannelSink {
+public:
+    virtual void writeRequested(const ChannelPipeline& pipeline, const MessageEvent& e) {
+        HttpResponsePtr response = e.getMessage().smartPointer<HttpResponse>();
+        HttpChunkPtr chunk = e.getMessage().smartPointer<HttpChunk>();
+
+        if (response) {
+            responses.push_back(response);
+        }
+        else if (chunk) {
+            chunks.push_back(chunk->isLast() ? "last" : contentOf(chunk->getContent()));
+        }
+    }
+
+    virtual void stateChangeRequested(const ChannelPipeline& pipeline, const ChannelStateEvent& e) {}
+
+    std::vector<HttpResponsePtr> responses;
+    std::vector<std::string> chunks;
+};
+
+class HttpContentCompressorTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        pipeline.attach(&channel, &sink);
+        pipeline.addLast("decoder", ChannelHandlerPtr(new HttpRequestDecoder()));
+        pipeline.addLast("compressor", ChannelHandlerPtr(new HttpContentCompressor(6, 100)));
+    }
+
+    void receive(const std::string& acceptEncoding) {
+        std::string request = "GET / HTTP/1.1\r\nAccept-Encoding: " + acceptEncoding + "\r\n\r\n";
+        pipeline.sendUpstream(UpstreamMessageEvent(channel,
+                              ChannelMessage(ChannelBuffers::copiedBuffer(request)),
+                              SocketAddress::NULL_ADDRESS));
+    }
+
+    void write(const ChannelMessage& message) {
+        pipeline.sendDownstream(DownstreamMessageEvent(channel,
+                                ChannelFuturePtr(),
+                                message,
+                                SocketAddress::NULL_ADDRESS));
+    }
+
+    HttpResponsePtr respond(const std::string& content) {
+        HttpResponsePtr response(
+            new DefaultHttpResponse(HttpVersion::HTTP_1_1, HttpResponseStatus::OK));
+
+        response->setContent(ChannelBuffers::copiedBuffer(content));
+        response->setHeader(HttpHeaders::Names::CONTENT_LENGTH,
+                            static_cast<int>(content.size()));
+        write(ChannelMessage(response));
+        return response;
+    }
+
+    NullChannel channel;
+    WriteRecorder sink;
+    DefaultChannelPipeline pipeline;
+};
+
+TEST_F(HttpContentCompressorTest, testCompressAboveThreshold) {
+    std::string text(4096, 'x');
+
+    receive("gzip;q=0.5, deflate");
+    receive("gzip");
+    receive("identity");
+
+    HttpResponsePtr deflated = respond(text);
+    HttpResponsePtr small = respond("short");
+    HttpResponsePtr identity = respond(text);
+
+    ASSERT_EQ("deflate", deflated->getHeader(HttpHeaders::Names::CONTENT_ENCODING));
+    ZlibInflater inflater(ZlibWrapper::ZLIB);
+    ASSERT_EQ(text, contentOf(inflater.inflate(deflated->getContent())));
+    ASSERT_EQ(deflated->getContent()->readableBytes(),
+              std::atoi(deflated->getHeader(HttpHeaders::Names::CONTENT_LENGTH).c_str()));
+
+    // below the threshold, passes through.
+    ASSERT_TRUE(small->getHeader(HttpHeaders::Names::CONTENT_ENCODING).empty());
+    ASSERT_EQ("short", contentOf(small->getContent()));
+
+    ASSERT_TRUE(identity->getHeader(HttpHeaders::Names::CONTENT_ENCODING).empty());
+    ASSERT_EQ(3U, sink.responses.size());
+}
+
+TEST_F(HttpContentCompressorTest, testCompressChunks) {
+    receive("gzip, deflate");
+
+    HttpResponsePtr response(
+        new DefaultHttpResponse(HttpVersion::HTTP_1_1, HttpResponseStatus::OK));
+    response->setChunked(true);
+    write(ChannelMessage(response));
+
+    ASSERT_EQ("gzip", response->getHeader(HttpHeaders::Names::CONTENT_ENCODING));
+
+    write(ChannelMessage(HttpChunkPtr(new DefaultHttpChunk(
+                                          ChannelBuffers::copiedBuffer(std::string("first "))))));
+    write(ChannelMessage(HttpChunkPtr(new DefaultHttpChunk(
+                                          ChannelBuffers::copiedBuffer(std::string("second"))))));
+    write(ChannelMessage(HttpChunk::LAST_CHUNK));
+
+    // the two chunks, the footer and the last one.
+    ASSERT_EQ(4U, sink.chunks.size());
+    ASSERT_EQ("last", sink.chunks[3]);
+
+    ZlibInflater inflater(ZlibWrapper::GZIP);
+    ASSERT_EQ("first ", contentOf(inflater.inflate(
+                                      ChannelBuffers::copiedBuffer(sink.chunks[0]))));
+    ASSERT_EQ("second", contentOf(inflater.inflate(
+                                      ChannelBuffers::copiedBuffer(sink.chunks[1]))));
+    inflater.inflate(ChannelBuffers::copiedBuffer(sink.chunks[2]));
+    ASSERT_TRUE(inflater.isFinished());
+}
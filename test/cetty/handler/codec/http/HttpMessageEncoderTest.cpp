@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/NullChannel.h"
+#include "cetty/channel/Channels.h"
+#include "cetty/channel/ChannelFuture.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/DefaultFileRegion.h"
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/AbstractChannelSink.h"
+#include "cetty/channel/DownstreamMessageEvent.h"
+#include "cetty/handler/codec/http/HttpHeaders.h"
+#include "cetty/handler/codec/http/HttpVersion.h"
+#include "cetty/handler/codec/http/HttpResponseStatus.h"
+#include "cetty/handler/codec/http/DefaultHttpResponse.h"
+#include "cetty/handler/codec/http/HttpResponseEncoder.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::handler::codec::http;
+
+// records the messages written by the encoder.
+class EncodedRecorder : public AbstractChannelSink {
+public:
+    virtual void writeRequested(const ChannelPipeline& pipeline, const MessageEvent& e) {
+        messages.push_back(e.getMessage());
+    }
+
+    virtual void stateChangeRequested(const ChannelPipeline& pipeline, const ChannelStateEvent& e) {}
+
+    std::vector<ChannelMessage> messages;
+};
+
+class HttpMessageEncoderTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        file = ::tmpfile();
+        ASSERT_TRUE(file != NULL);
+        ::fwrite("0123456789", 1, 10, file);
+        ::fflush(file);
+
+        pipeline.attach(&channel, &sink);
+        pipeline.addLast("encoder", ChannelHandlerPtr(new HttpResponseEncoder()));
+
+        HttpResponsePtr response(
+            new DefaultHttpResponse(HttpVersion::HTTP_1_1, HttpResponseStatus::OK));
+        response->setChunked(true);
+        response->setHeader(HttpHeaders::Names::TRANSFER_ENCODING,
+                            HttpHeaders::Values::CHUNKED);
+        write(ChannelMessage(response));
+    }
+
+    virtual void TearDown() {
+        ::fclose(file);
+    }
+
+    void write(const ChannelMessage& message,
+               const ChannelFuturePtr& future = ChannelFuturePtr()) {
+        pipeline.sendDownstream(DownstreamMessageEvent(channel,
+                                future,
+                                message,
+                                SocketAddress::NULL_ADDRESS));
+    }
+
+    FILE* file;
+    NullChannel channel;
+    EncodedRecorder sink;
+    DefaultChannelPipeline pipeline;
+};
+
+TEST_F(HttpMessageEncoderTest, testChunkedFileRegion) {
+    FileRegionPtr region(new DefaultFileRegion(::fileno(file), 2, 6, false));
+    write(ChannelMessage(region));
+
+    // the header, then the chunk size, the region and the line break.
+    ASSERT_EQ(2U, sink.messages.size());
+    std::vector<ChannelMessage>& parts = sink.messages[1].channelMessages();
+    ASSERT_EQ(3U, parts.size());
+
+    ChannelBufferPtr size = parts[0].smartPointer<ChannelBuffer>();
+    ASSERT_TRUE(size);
+    std::string str;
+    size->getBytes(size->readerIndex(), str, size->readableBytes());
+    ASSERT_EQ("6\r\n", str);
+    ASSERT_TRUE(parts[1].smartPointer<FileRegion>() == region);
+}
+
+TEST_F(HttpMessageEncoderTest, testChunkedEmptyFileRegion) {
+    FileRegionPtr region(new DefaultFileRegion(::fileno(file), 2, 0, false));
+    ChannelFuturePtr future = Channels::future(channel);
+    write(ChannelMessage(region), future);
+
+    // nothing but the header, no "0\r\n" ending the body early.
+    ASSERT_EQ(1U, sink.messages.size());
+
+    // the write is done, though nothing was sent.
+    ASSERT_TRUE(future->isDone());
+    ASSERT_TRUE(future->isSuccess());
+}
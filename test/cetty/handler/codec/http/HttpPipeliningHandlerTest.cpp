@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/NullChannel.h"
+#include "cetty/channel/ChannelEventLoop.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/AbstractChannelSink.h"
+#include "cetty/channel/UpstreamMessageEvent.h"
+#include "cetty/channel/DownstreamMessageEvent.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/channel/ChannelTestUtil.h"
+#include "cetty/handler/codec/http/HttpVersion.h"
+#include "cetty/handler/codec/http/HttpResponseStatus.h"
+#include "cetty/handler/codec/http/DefaultHttpChunk.h"
+#include "cetty/handler/codec/http/DefaultHttpResponse.h"
+#include "cetty/handler/codec/http/HttpRequestDecoder.h"
+#include "cetty/handler/codec/http/HttpPipeliningHandler.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::handler::codec::http;
+
+class LoopChannel : public NullChannel {
+public:
+    LoopChannel() : eventLoop(NULL) {}
+
+    virtual ChannelEventLoop* getEventLoop() const { return eventLoop; }
+
+    ChannelEventLoop* eventLoop;
+};
+
+// records the uri of the answered request, or the chunk content.
+class ResponseRecorder : public AbstractChannelSink {
+public:
+    virtual void writeRequested(const ChannelPipeline& pipeline, const MessageEvent& e) {
+        HttpResponsePtr response = e.getMessage().smartPointer<HttpResponse>();
+        HttpChunkPtr chunk = e.getMessage().smartPointer<HttpChunk>();
+
+        if (response) {
+            written.push_back(response->getHeader("X-Uri"));
+        }
+        else if (chunk) {
+            written.push_back(chunk->isLast() ? "last" : "chunk");
+        }
+    }
+
+    virtual void stateChangeRequested(const ChannelPipeline& pipeline, const ChannelStateEvent& e) {}
+
+    std::vector<std::string> written;
+};
+
+class RequestRecorder : public SimpleChannelUpstreamHandler {
+public:
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "RequestRecorder"; }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        HttpPipelinedRequestPtr request =
+            e.getMessage().smartPointer<HttpPipelinedRequest>();
+        ASSERT_TRUE(request);
+        requests.push_back(request);
+    }
+
+    std::vector<HttpPipelinedRequestPtr> requests;
+};
+
+class HttpPipeliningHandlerTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        recorder = new RequestRecorder;
+        pipelining = new HttpPipeliningHandler(2);
+
+        pipeline.attach(&channel, &sink);
+        pipeline.addLast("decoder", ChannelHandlerPtr(new HttpRequestDecoder()));
+        pipeline.addLast("pipelining", ChannelHandlerPtr(pipelining));
+        pipeline.addLast("recorder", ChannelHandlerPtr(recorder));
+    }
+
+    void receive(const std::string& requests) {
+        pipeline.sendUpstream(UpstreamMessageEvent(channel,
+                              ChannelMessage(ChannelBuffers::copiedBuffer(requests)),
+                              SocketAddress::NULL_ADDRESS));
+    }
+
+    void respond(int index, bool chunked = false) {
+        const HttpPipelinedRequestPtr& request = recorder->requests[index];
+        HttpResponsePtr response(
+            new DefaultHttpResponse(HttpVersion::HTTP_1_1, HttpResponseStatus::OK));
+
+        response->setHeader("X-Uri", request->getRequest()->getHeader("X-Uri"));
+        response->setChunked(chunked);
+        write(ChannelMessage(request->respond(response)));
+    }
+
+    // responds from another thread, like the workers of an ExecutionHandler.
+    void respondInThread(int index) {
+        boost::thread worker(boost::bind(&HttpPipeliningHandlerTest::respond,
+                                         this,
+                                         index,
+                                         false));
+        worker.join();
+    }
+
+    void respondChunk(int index, const std::string& content) {
+        HttpChunkPtr chunk(new DefaultHttpChunk(content.empty()
+                                                ? ChannelBuffers::EMPTY_BUFFER
+                                                : ChannelBuffers::copiedBuffer(content)));
+        write(ChannelMessage(recorder->requests[index]->respond(chunk)));
+    }
+
+    void write(const ChannelMessage& message) {
+        pipeline.sendDownstream(DownstreamMessageEvent(channel,
+                                ChannelFuturePtr(),
+                                message,
+                                SocketAddress::NULL_ADDRESS));
+    }
+
+    LoopChannel channel;
+    ResponseRecorder sink;
+    DefaultChannelPipeline pipeline;
+    RequestRecorder* recorder;
+    HttpPipeliningHandler* pipelining;
+};
+
+static std::string requestOf(const std::string& uri) {
+    return "GET " + uri + " HTTP/1.1\r\nHost: localhost\r\nX-Uri: " + uri + "\r\n\r\n";
+}
+
+TEST_F(HttpPipeliningHandlerTest, testWriteInRequestOrder) {
+    receive(requestOf("/a") + requestOf("/b") + requestOf("/c"));
+
+    // the third request waits for the limit.
+    ASSERT_EQ(2U, recorder->requests.size());
+    ASSERT_EQ(2, pipelining->getOutstandingRequests());
+    ASSERT_EQ(0, recorder->requests[0]->getSequence());
+    ASSERT_EQ(1, recorder->requests[1]->getSequence());
+
+    respond(1);
+    ASSERT_TRUE(sink.written.empty());
+
+    respond(0);
+    ASSERT_EQ(2U, sink.written.size());
+    ASSERT_EQ("/a", sink.written[0]);
+    ASSERT_EQ("/b", sink.written[1]);
+
+    ASSERT_EQ(3U, recorder->requests.size());
+    ASSERT_EQ("/c", recorder->requests[2]->getRequest()->getHeader("X-Uri"));
+    ASSERT_EQ(1, pipelining->getOutstandingRequests());
+
+    // the still referenced requests are not reused by the decoder.
+    ASSERT_EQ("/a", recorder->requests[0]->getRequest()->getHeader("X-Uri"));
+
+    respond(2);
+    ASSERT_EQ(3U, sink.written.size());
+    ASSERT_EQ("/c", sink.written[2]);
+    ASSERT_EQ(0, pipelining->getOutstandingRequests());
+}
+
+TEST_F(HttpPipeliningHandlerTest, testChunkedResponse) {
+    receive(requestOf("/a") + requestOf("/b"));
+    ASSERT_EQ(2U, recorder->requests.size());
+
+    respond(1, true);
+    respondChunk(1, "data");
+    ASSERT_TRUE(sink.written.empty());
+
+    respond(0);
+    ASSERT_EQ(3U, sink.written.size());
+    ASSERT_EQ("/a", sink.written[0]);
+    ASSERT_EQ("/b", sink.written[1]);
+    ASSERT_EQ("chunk", sink.written[2]);
+    ASSERT_EQ(1, pipelining->getOutstandingRequests());
+
+    // the rest of the response goes out at once.
+    respondChunk(1, "");
+    ASSERT_EQ(4U, sink.written.size());
+    ASSERT_EQ("last", sink.written[3]);
+    ASSERT_EQ(0, pipelining->getOutstandingRequests());
+}
+
+TEST_F(HttpPipeliningHandlerTest, testRespondInAnotherThread) {
+    ManualEventLoop eventLoop;
+    channel.eventLoop = &eventLoop;
+
+    receive(requestOf("/a") + requestOf("/b") + requestOf("/c"));
+    ASSERT_EQ(2U, recorder->requests.size());
+
+    respondInThread(1);
+    ASSERT_TRUE(sink.written.empty());
+
+    respondInThread(0);
+    ASSERT_EQ(2U, sink.written.size());
+    ASSERT_EQ("/a", sink.written[0]);
+    ASSERT_EQ("/b", sink.written[1]);
+    ASSERT_EQ(0, pipelining->getOutstandingRequests());
+
+    // the suspended request is only forwarded in the I/O thread.
+    ASSERT_EQ(2U, recorder->requests.size());
+    ASSERT_EQ(1, eventLoop.getTaskCount());
+
+    eventLoop.runTasks();
+    ASSERT_EQ(3U, recorder->requests.size());
+    ASSERT_EQ("/c", recorder->requests[2]->getRequest()->getHeader("X-Uri"));
+    ASSERT_EQ(1, pipelining->getOutstandingRequests());
+
+    // nothing is suspended any more.
+    respondInThread(2);
+    ASSERT_EQ(3U, sink.written.size());
+    ASSERT_EQ("/c", sink.written[2]);
+    ASSERT_EQ(0, eventLoop.getTaskCount());
+}
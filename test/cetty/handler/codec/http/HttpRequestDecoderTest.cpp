@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/NullChannel.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/UpstreamMessageEvent.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/channel/ChannelTestUtil.h"
+#include "cetty/handler/codec/http/HttpRequestDecoder.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::handler::codec::http;
+
+static std::string contentOf(const ChannelBufferPtr& content) {
+    std::string str;
+    content->getBytes(content->readerIndex(), str, content->readableBytes());
+    return str;
+}
+
+// the decoder reuses its request, so records the messages as text.
+class MessageRecorder : public SimpleChannelUpstreamHandler {
+public:
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "MessageRecorder"; }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        HttpMessagePtr message = e.getMessage().smartPointer<HttpMessage>();
+        HttpChunkPtr chunk = e.getMessage().smartPointer<HttpChunk>();
+
+        if (message) {
+            HttpRequest* request = dynamic_cast<HttpRequest*>(message.get());
+            ASSERT_TRUE(request != NULL);
+
+            std::string text = request->getMethod().getName() + " " + request->getUri();
+            text += " host=" + request->getHeader("Host");
+            text += " accept=" + request->getHeader("Accept");
+
+            if (message->isChunked()) {
+                text += " chunked";
+            }
+            else {
+                text += " " + contentOf(message->getContent());
+            }
+            messages.push_back(text);
+        }
+        else if (chunk) {
+            HttpChunkTrailer* trailer = dynamic_cast<HttpChunkTrailer*>(chunk.get());
+
+            if (trailer) {
+                std::string text = "trailer";
+                const HttpHeader::StringList& values = trailer->header().gets("X-Sum");
+                for (size_t i = 0; i < values.size(); ++i) {
+                    text += " " + values[i];
+                }
+                messages.push_back(text);
+            }
+            else {
+                messages.push_back("chunk " + contentOf(chunk->getContent()));
+            }
+        }
+    }
+
+    std::vector<std::string> messages;
+};
+
+static const char* REQUESTS =
+    "\r\n"
+    "GET /index.html HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "Accept: text/html,\r\n"
+    "\t text/plain\r\n"
+    "\r\n"
+    "POST /form HTTP/1.1\n"
+    "Host:localhost\n"
+    "Content-Length: 11\n"
+    "\n"
+    "hello world"
+    "PUT /upload HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "\r\n"
+    "5;name=value\r\n"
+    "abcde\r\n"
+    "1A\r\n"
+    "abcdefghijklmnopqrstuvwxyz\r\n"
+    "0\r\n"
+    "X-Sum: 31\r\n"
+    "Content-Length: 31\r\n"
+    "\r\n";
+
+// receives the requests, in chunks of the given size, by a channel which
+// owns its read buffers or not, so the headers are referenced or copied.
+static void receive(int chunkSize,
+                    int maxChunkSize,
+                    bool ownBuffer,
+                    std::vector<std::string>& messages) {
+    NullChannel nullChannel;
+    OwnBufferChannel ownBufferChannel;
+    Channel& channel = ownBuffer ? static_cast<Channel&>(ownBufferChannel) : nullChannel;
+    DiscardingSink sink;
+    DefaultChannelPipeline pipeline;
+    MessageRecorder* recorder = new MessageRecorder;
+
+    pipeline.attach(&channel, &sink);
+    pipeline.addLast("decoder", ChannelHandlerPtr(
+                         new HttpRequestDecoder(4096, 8192, maxChunkSize)));
+    pipeline.addLast("recorder", ChannelHandlerPtr(recorder));
+
+    std::string stream(REQUESTS);
+    for (size_t i = 0; i < stream.size(); i += chunkSize) {
+        ChannelBufferPtr buffer = ChannelBuffers::copiedBuffer(
+                                      stream.substr(i, chunkSize));
+        pipeline.sendUpstream(UpstreamMessageEvent(channel,
+                              ChannelMessage(buffer),
+                              SocketAddress::NULL_ADDRESS));
+    }
+
+    messages = recorder->messages;
+}
+
+TEST(HttpRequestDecoderTest, testDecodeInAnyFragments) {
+    const char* expected[] = {
+        "GET /index.html host=localhost accept=text/html, text/plain ",
+        "POST /form host=localhost accept= hello world",
+        "PUT /upload host=localhost accept= chunked",
+        "chunk abcde",
+        "chunk abcdefghijklmnopqrstuvwxyz",
+        "trailer 31"
+    };
+
+    int chunkSizes[] = { 1, 2, 7, 64, 4096 };
+
+    for (int k = 0; k < 10; ++k) {
+        std::vector<std::string> messages;
+        receive(chunkSizes[k / 2], 8192, k % 2 == 1, messages);
+
+        ASSERT_EQ(6U, messages.size()) << "chunk size " << chunkSizes[k / 2];
+        for (int i = 0; i < 6; ++i) {
+            EXPECT_EQ(expected[i], messages[i]) << "chunk size " << chunkSizes[k / 2];
+        }
+    }
+}
+
+TEST(HttpRequestDecoderTest, testSplitLargeContent) {
+    const char* expected[] = {
+        "GET /index.html host=localhost accept=text/html, text/plain ",
+        "POST /form host=localhost accept= chunked",
+        "chunk hello wor",
+        "chunk ld",
+        "trailer",
+        "PUT /upload host=localhost accept= chunked",
+        "chunk abcde",
+        "chunk abcdefghi",
+        "chunk jklmnopqr",
+        "chunk stuvwxyz",
+        "trailer 31"
+    };
+
+    std::vector<std::string> messages;
+    receive(3, 9, true, messages);
+
+    ASSERT_EQ(11U, messages.size());
+    for (int i = 0; i < 11; ++i) {
+        EXPECT_EQ(expected[i], messages[i]);
+    }
+}
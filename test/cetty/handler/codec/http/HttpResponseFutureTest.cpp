@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "cetty/handler/codec/http/HttpVersion.h"
+#include "cetty/handler/codec/http/HttpResponseStatus.h"
+#include "cetty/handler/codec/http/DefaultHttpResponse.h"
+#include "cetty/handler/codec/http/HttpResponseFuture.h"
+
+using namespace cetty::util;
+using namespace cetty::handler::codec::http;
+
+static void countDone(int* count, const HttpResponseFuturePtr& future) {
+    ASSERT_TRUE(future->isDone());
+    ++*count;
+}
+
+static void respondLater(HttpResponseFuturePtr future, HttpResponsePtr response) {
+    boost::this_thread::sleep(boost::posix_time::millisec(20));
+    future->setResponse(response);
+}
+
+TEST(HttpResponseFutureTest, testSetResponse) {
+    HttpResponseFuturePtr future(new HttpResponseFuture);
+    HttpResponsePtr response(
+        new DefaultHttpResponse(HttpVersion::HTTP_1_1, HttpResponseStatus::OK));
+    int count = 0;
+
+    future->setListener(boost::bind(countDone, &count, _1));
+    ASSERT_FALSE(future->isDone());
+    ASSERT_FALSE(future->awaitUninterruptibly(1));
+
+    boost::thread thread(boost::bind(respondLater, future, response));
+    ASSERT_TRUE(future->awaitUninterruptibly().isSuccess());
+    thread.join();
+
+    ASSERT_EQ(1, count);
+    ASSERT_TRUE(future->getResponse() == response);
+    ASSERT_TRUE(future->getCause() == NULL);
+
+    // allows only once.
+    ASSERT_FALSE(future->setFailure(Exception("late")));
+    ASSERT_TRUE(future->isSuccess());
+
+    // notified at once when done.
+    future->setListener(boost::bind(countDone, &count, _1));
+    ASSERT_EQ(2, count);
+}
+
+TEST(HttpResponseFutureTest, testSetFailure) {
+    HttpResponseFuturePtr future(new HttpResponseFuture);
+
+    ASSERT_TRUE(future->setFailure(Exception("connection refused")));
+    ASSERT_TRUE(future->awaitUninterruptibly(1));
+    ASSERT_FALSE(future->isSuccess());
+    ASSERT_FALSE(future->getResponse());
+    ASSERT_TRUE(future->getCause() != NULL);
+}
@@ -0,0 +1,483 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/NullChannel.h"
+#include "cetty/channel/ChannelEventLoop.h"
+#include "cetty/channel/MessageEvent.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/AbstractChannelSink.h"
+#include "cetty/channel/UpstreamMessageEvent.h"
+#include "cetty/channel/DownstreamMessageEvent.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/channel/ChannelTestUtil.h"
+#include "cetty/handler/codec/http/HttpMethod.h"
+#include "cetty/handler/codec/http/HttpVersion.h"
+#include "cetty/handler/codec/http/DefaultHttpRequest.h"
+#include "cetty/handler/codec/http/HttpRequestDecoder.h"
+#include "cetty/handler/codec/http/HttpResponseEncoder.h"
+#include "cetty/handler/codec/http/HttpChunkAggregator.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketUtil.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketFrame.h"
+#include "cetty/handler/codec/http/websocketx/WebSocket13FrameDecoder.h"
+#include "cetty/handler/codec/http/websocketx/WebSocket13FrameEncoder.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketPerMessageDeflateDecoder.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketPerMessageDeflateEncoder.h"
+#include "cetty/handler/codec/http/websocketx/WebSocketServerHandshaker13.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::handler::codec::http;
+using namespace cetty::handler::codec::http::websocketx;
+
+static std::string contentOf(const ChannelBufferPtr& content) {
+    std::string str;
+    content->getBytes(content->readerIndex(), str, content->readableBytes());
+    return str;
+}
+
+class WriteRecorder : public AbstractChannelSink {
+public:
+    virtual void writeRequested(const ChannelPipeline& pipeline, const MessageEvent& e) {
+        written += contentOf(e.getMessage().value<ChannelBufferPtr>());
+    }
+
+    virtual void stateChangeRequested(const ChannelPipeline& pipeline, const ChannelStateEvent& e) {}
+
+    std::string written;
+};
+
+class FrameRecorder : public SimpleChannelUpstreamHandler {
+public:
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "FrameRecorder"; }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        frames.push_back(e.getMessage().smartPointer<WebSocketFrame>());
+    }
+
+    std::vector<WebSocketFramePtr> frames;
+};
+
+// a client, which masks and deflates, writes to a server, which unmasks
+// and inflates.
+class WebSocket13FrameCodecTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        recorder = new FrameRecorder;
+
+        client.attach(&channel, &written);
+        server.attach(&channel, &discarded);
+
+        server.addLast("wsdecoder", ChannelHandlerPtr(
+                           new WebSocket13FrameDecoder(true, true, 1 << 20)));
+        server.addLast("recorder", ChannelHandlerPtr(recorder));
+        client.addLast("wsencoder", ChannelHandlerPtr(new WebSocket13FrameEncoder(true)));
+    }
+
+    void enableDeflate() {
+        server.addAfter("wsdecoder", "wsinflater", ChannelHandlerPtr(
+                            new WebSocketPerMessageDeflateDecoder(false)));
+        client.addLast("wsdeflater", ChannelHandlerPtr(
+                           new WebSocketPerMessageDeflateEncoder(6, true)));
+    }
+
+    void write(const WebSocketFramePtr& frame) {
+        client.sendDownstream(DownstreamMessageEvent(channel,
+                              ChannelFuturePtr(),
+                              ChannelMessage(frame),
+                              SocketAddress::NULL_ADDRESS));
+    }
+
+    // receives the written bytes in pieces of the chunk size.
+    void receive(const std::string& bytes, size_t chunkSize) {
+        for (size_t i = 0; i < bytes.size(); i += chunkSize) {
+            server.sendUpstream(UpstreamMessageEvent(channel,
+                                ChannelMessage(ChannelBuffers::copiedBuffer(bytes.substr(i, chunkSize))),
+                                SocketAddress::NULL_ADDRESS));
+        }
+    }
+
+    void flush(size_t chunkSize) {
+        receive(written.written, chunkSize);
+        written.written.clear();
+    }
+
+    static WebSocketFramePtr newFrame(const WebSocketFrameType& type,
+                                      bool finalFragment,
+                                      const std::string& data) {
+        return WebSocketFramePtr(new WebSocketFrame(type,
+                                 finalFragment,
+                                 0,
+                                 ChannelBuffers::copiedBuffer(data)));
+    }
+
+    NullChannel channel;
+    WriteRecorder written;
+    WriteRecorder discarded;
+    DefaultChannelPipeline client;
+    DefaultChannelPipeline server;
+    FrameRecorder* recorder;
+};
+
+TEST(WebSocketUtilTest, testCalculateAccept) {
+    // the sample of RFC 6455, section 1.3.
+    ASSERT_EQ("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=",
+              WebSocketUtil::calculateAccept("dGhlIHNhbXBsZSBub25jZQ=="));
+    ASSERT_EQ("qUqP5cyxm6YcTAhz05Hph5gvu9M=",
+              WebSocketUtil::base64(WebSocketUtil::sha1("test")));
+    ASSERT_EQ("YQ==", WebSocketUtil::base64("a"));
+    ASSERT_EQ("YWI=", WebSocketUtil::base64("ab"));
+}
+
+TEST(WebSocketUtilTest, testMaskMatchesScalar) {
+    const char key[] = { 0x12, 0x34, 0x56, static_cast<char>(0x78) };
+    std::string original;
+
+    for (int i = 0; i < 300; ++i) {
+        original += static_cast<char>(i * 7);
+    }
+
+    for (int offset = 0; offset < 4; ++offset) {
+        for (int length = 0; length < 200; length += 13) {
+            std::string masked = original.substr(3, length);
+            int next = WebSocketUtil::mask(&masked[0], length, key, offset);
+
+            ASSERT_EQ((offset + length) & 3, next);
+            for (int i = 0; i < length; ++i) {
+                ASSERT_EQ(static_cast<char>(original[3 + i] ^ key[(offset + i) & 3]), masked[i])
+                        << WebSocketUtil::getInstructionSet() << " offset " << offset
+                        << " length " << length << " at " << i;
+            }
+        }
+    }
+
+    // masks a composite buffer across its components.
+    ChannelBufferPtr buffer = ChannelBuffers::wrappedBuffer(
+                                  ChannelBuffers::copiedBuffer(original.substr(0, 37)),
+                                  ChannelBuffers::copiedBuffer(original.substr(37)));
+    WebSocketUtil::mask(buffer, key);
+    WebSocketUtil::mask(buffer, key);
+    ASSERT_EQ(original, contentOf(buffer));
+}
+
+TEST_F(WebSocket13FrameCodecTest, testRoundTripLengths) {
+    int lengths[] = { 0, 1, 125, 126, 127, 1000, 65535, 65536, 70000 };
+    int count = sizeof(lengths) / sizeof(lengths[0]);
+
+    for (int i = 0; i < count; ++i) {
+        write(newFrame(WebSocketFrameType::BINARY, true, std::string(lengths[i], 'a' + i)));
+    }
+
+    flush(4093);
+
+    ASSERT_EQ(count, static_cast<int>(recorder->frames.size()));
+    for (int i = 0; i < count; ++i) {
+        const WebSocketFramePtr& frame = recorder->frames[i];
+
+        ASSERT_TRUE(frame);
+        ASSERT_TRUE(frame->isBinary());
+        ASSERT_TRUE(frame->isFinalFragment());
+        ASSERT_EQ(std::string(lengths[i], 'a' + i), frame->getTextData()) << lengths[i];
+    }
+}
+
+TEST_F(WebSocket13FrameCodecTest, testFragmentsAndControlFrames) {
+    write(newFrame(WebSocketFrameType::TEXT, false, "Hel"));
+    write(newFrame(WebSocketFrameType::PING, true, "ping"));
+    write(newFrame(WebSocketFrameType::CONTINUATION, true, "lo"));
+    write(WebSocketFrame::createCloseFrame(WebSocketFrame::NORMAL_CLOSURE, "bye"));
+    write(newFrame(WebSocketFrameType::TEXT, true, "ignored"));
+
+    flush(1);
+
+    ASSERT_EQ(4U, recorder->frames.size());
+    ASSERT_EQ(WebSocketFrameType::TEXT, recorder->frames[0]->getType());
+    ASSERT_FALSE(recorder->frames[0]->isFinalFragment());
+    ASSERT_EQ("Hel", recorder->frames[0]->getTextData());
+    ASSERT_EQ(WebSocketFrameType::PING, recorder->frames[1]->getType());
+    ASSERT_EQ("ping", recorder->frames[1]->getTextData());
+    ASSERT_EQ(WebSocketFrameType::CONTINUATION, recorder->frames[2]->getType());
+    ASSERT_EQ("lo", recorder->frames[2]->getTextData());
+    ASSERT_EQ(1000, recorder->frames[3]->getCloseStatusCode());
+    ASSERT_EQ("bye", recorder->frames[3]->getCloseReasonText());
+}
+
+TEST_F(WebSocket13FrameCodecTest, testProtocolViolations) {
+    // an unmasked frame sent to a server.
+    receive(std::string("\x81\x02hi", 4), 4);
+    ASSERT_TRUE(recorder->frames.empty());
+
+    // discards everything after the violation.
+    write(newFrame(WebSocketFrameType::TEXT, true, "after"));
+    flush(64);
+    ASSERT_TRUE(recorder->frames.empty());
+}
+
+TEST_F(WebSocket13FrameCodecTest, testContinuationWithoutMessage) {
+    write(newFrame(WebSocketFrameType::CONTINUATION, true, "orphan"));
+    write(newFrame(WebSocketFrameType::TEXT, true, "after"));
+    flush(64);
+
+    ASSERT_TRUE(recorder->frames.empty());
+}
+
+TEST_F(WebSocket13FrameCodecTest, testPerMessageDeflate) {
+    enableDeflate();
+
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text += "a repeated sentence compresses well. ";
+    }
+
+    write(newFrame(WebSocketFrameType::TEXT, true, text));
+    write(newFrame(WebSocketFrameType::TEXT, false, text.substr(0, 1000)));
+    write(newFrame(WebSocketFrameType::PING, true, "ping"));
+    write(newFrame(WebSocketFrameType::CONTINUATION, true, text.substr(1000)));
+    write(newFrame(WebSocketFrameType::BINARY, true, ""));
+
+    ASSERT_LT(written.written.size(), text.size());
+    flush(512);
+
+    ASSERT_EQ(5U, recorder->frames.size());
+    ASSERT_EQ(text, recorder->frames[0]->getTextData());
+    ASSERT_EQ(0, recorder->frames[0]->getRsv());
+    ASSERT_EQ(text.substr(0, 1000), recorder->frames[1]->getTextData());
+    ASSERT_EQ("ping", recorder->frames[2]->getTextData());
+    ASSERT_EQ(text.substr(1000), recorder->frames[3]->getTextData());
+    ASSERT_TRUE(recorder->frames[4]->isBinary());
+    ASSERT_EQ("", recorder->frames[4]->getTextData());
+}
+
+// a channel which writes through its pipeline.
+class PipelineChannel : public NullChannel {
+public:
+    PipelineChannel(DefaultChannelPipeline& pipeline) : pipeline(pipeline) {}
+
+    virtual ChannelPipeline& getPipeline() const { return pipeline; }
+
+    virtual ChannelFuturePtr write(const ChannelMessage& message, bool withFuture = true) {
+        pipeline.sendDownstream(DownstreamMessageEvent(*this,
+                                ChannelFuturePtr(),
+                                message,
+                                SocketAddress::NULL_ADDRESS));
+        return NullChannel::write(message, withFuture);
+    }
+
+private:
+    DefaultChannelPipeline& pipeline;
+};
+
+class LoopChannel : public PipelineChannel {
+public:
+    LoopChannel(DefaultChannelPipeline& pipeline, ManualEventLoop& eventLoop)
+        : PipelineChannel(pipeline), eventLoop(eventLoop) {}
+
+    virtual ChannelEventLoop* getEventLoop() const { return &eventLoop; }
+
+private:
+    ManualEventLoop& eventLoop;
+};
+
+TEST(WebSocketServerHandshaker13Test, testHandshake) {
+    DefaultChannelPipeline pipeline;
+    ManualEventLoop eventLoop;
+    LoopChannel channel(pipeline, eventLoop);
+    WriteRecorder sink;
+
+    pipeline.attach(&channel, &sink);
+    pipeline.addLast("decoder", ChannelHandlerPtr(new HttpRequestDecoder()));
+    pipeline.addLast("aggregator", ChannelHandlerPtr(new HttpChunkAggregator(65536)));
+    pipeline.addLast("encoder", ChannelHandlerPtr(new HttpResponseEncoder()));
+
+    DefaultHttpRequest request(HttpVersion::HTTP_1_1, HttpMethod::HM_GET, "/websocket");
+    request.setHeader("Upgrade", "websocket");
+    request.setHeader("Connection", "keep-alive, Upgrade");
+    request.setHeader("Sec-WebSocket-Key", "dGhlIHNhbXBsZSBub25jZQ==");
+    request.setHeader("Sec-WebSocket-Version", "13");
+    request.setHeader("Sec-WebSocket-Protocol", "chat, superchat");
+    request.setHeader("Sec-WebSocket-Extensions",
+                      "permessage-deflate; server_max_window_bits=10, "
+                      "permessage-deflate; client_max_window_bits");
+
+    WebSocketServerHandshaker13 handshaker("superchat", true);
+    handshaker.handshake(channel, request);
+
+    ASSERT_NE(std::string::npos, sink.written.find("HTTP/1.1 101 Switching Protocols"));
+    ASSERT_NE(std::string::npos,
+              sink.written.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo="));
+    ASSERT_NE(std::string::npos, sink.written.find("Sec-WebSocket-Protocol: superchat"));
+    ASSERT_NE(std::string::npos, sink.written.find(
+                  "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover\r\n"));
+    ASSERT_TRUE(handshaker.isDeflateNegotiated());
+
+    // the decoder is replaced in the event loop.
+    ASSERT_TRUE(pipeline.get("decoder"));
+    eventLoop.runTasks();
+
+    const char* names[] = { "wsdecoder", "wsinflater", "wsencoder", "wsdeflater" };
+    ChannelPipeline::ChannelHandlers handlers = pipeline.toMap();
+
+    ASSERT_EQ(4U, handlers.size());
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(names[i], handlers[i].first);
+    }
+
+    // the frames are written by the upgraded pipeline.
+    sink.written.clear();
+    channel.write(ChannelMessage(WebSocketFramePtr(new WebSocketFrame("hi"))));
+    ASSERT_EQ(0xC1, static_cast<unsigned char>(sink.written[0]));
+
+    request.setHeader("Sec-WebSocket-Version", "8");
+    ASSERT_THROW(handshaker.handshake(channel, request), cetty::util::InvalidArgumentException);
+}
+
+TEST(WebSocketServerHandshaker13Test, testHandshakeWithoutEventLoop) {
+    DefaultChannelPipeline pipeline;
+    PipelineChannel channel(pipeline);
+    WriteRecorder sink;
+
+    pipeline.attach(&channel, &sink);
+    pipeline.addLast("decoder", ChannelHandlerPtr(new HttpRequestDecoder()));
+    pipeline.addLast("encoder", ChannelHandlerPtr(new HttpResponseEncoder()));
+
+    DefaultHttpRequest request(HttpVersion::HTTP_1_1, HttpMethod::HM_GET, "/websocket");
+    request.setHeader("Upgrade", "websocket");
+    request.setHeader("Connection", "Upgrade");
+    request.setHeader("Sec-WebSocket-Key", "dGhlIHNhbXBsZSBub25jZQ==");
+    request.setHeader("Sec-WebSocket-Version", "13");
+
+    // the decoder could only be replaced while it is decoding.
+    WebSocketServerHandshaker13 handshaker("", false);
+    ASSERT_THROW(handshaker.handshake(channel, request), cetty::util::IllegalStateException);
+    ASSERT_TRUE(sink.written.empty());
+    ASSERT_TRUE(pipeline.get("decoder"));
+    ASSERT_TRUE(pipeline.get("encoder"));
+}
+
+// answers the handshake from the decode path, and greets at once.
+class HandshakeHandler : public SimpleChannelUpstreamHandler {
+public:
+    HandshakeHandler() : handshaker("", false) {}
+
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "HandshakeHandler"; }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        HttpRequestPtr request = boost::dynamic_pointer_cast<HttpRequest>(
+                                     e.getMessage().smartPointer<HttpMessage>());
+
+        if (!request) {
+            ctx.sendUpstream(e);
+            return;
+        }
+
+        handshaker.handshake(ctx.getChannel(), *request);
+        ctx.getChannel().write(ChannelMessage(WebSocketFramePtr(new WebSocketFrame("hi"))));
+    }
+
+private:
+    WebSocketServerHandshaker13 handshaker;
+};
+
+// a masked text frame from the client.
+static std::string maskedFrame(const std::string& text) {
+    const char mask[4] = { 0x11, 0x22, 0x33, 0x44 };
+    std::string frame;
+
+    frame.push_back(static_cast<char>(0x81));
+    frame.push_back(static_cast<char>(0x80 | text.size()));
+    frame.append(mask, 4);
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        frame.push_back(text[i] ^ mask[i % 4]);
+    }
+
+    return frame;
+}
+
+TEST(WebSocketServerHandshaker13Test, testHandshakeWhileDecoding) {
+    DefaultChannelPipeline pipeline;
+    ManualEventLoop eventLoop;
+    LoopChannel channel(pipeline, eventLoop);
+    WriteRecorder sink;
+    FrameRecorder* recorder = new FrameRecorder;
+
+    pipeline.attach(&channel, &sink);
+    pipeline.addLast("decoder", ChannelHandlerPtr(new HttpRequestDecoder()));
+    pipeline.addLast("aggregator", ChannelHandlerPtr(new HttpChunkAggregator(65536)));
+    pipeline.addLast("encoder", ChannelHandlerPtr(new HttpResponseEncoder()));
+    pipeline.addLast("handshake", ChannelHandlerPtr(new HandshakeHandler));
+    pipeline.addLast("recorder", ChannelHandlerPtr(recorder));
+
+    // a frame comes right after the request, in the same read.
+    std::string bytes("GET /websocket HTTP/1.1\r\n"
+                      "Host: localhost\r\n"
+                      "Upgrade: websocket\r\n"
+                      "Connection: Upgrade\r\n"
+                      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                      "Sec-WebSocket-Version: 13\r\n"
+                      "\r\n");
+    bytes += maskedFrame("first");
+
+    pipeline.sendUpstream(UpstreamMessageEvent(channel,
+                          ChannelMessage(ChannelBuffers::copiedBuffer(bytes)),
+                          SocketAddress::NULL_ADDRESS));
+
+    // the response is written by the HTTP encoder, and the greeting by
+    // the frame encoder.
+    size_t end = sink.written.find("\r\n\r\n");
+    ASSERT_EQ(0U, sink.written.find("HTTP/1.1 101 Switching Protocols"));
+    ASSERT_NE(std::string::npos, end);
+    ASSERT_EQ(std::string("\x81\x02hi"), sink.written.substr(end + 4));
+
+    // the HTTP decoder is still on the pipeline, and keeps the frame.
+    ASSERT_TRUE(pipeline.get("decoder"));
+    ASSERT_TRUE(recorder->frames.empty());
+    ASSERT_EQ(1, eventLoop.getTaskCount());
+
+    // the bytes received before the upgrade are kept too.
+    pipeline.sendUpstream(UpstreamMessageEvent(channel,
+                          ChannelMessage(ChannelBuffers::copiedBuffer(maskedFrame("second"))),
+                          SocketAddress::NULL_ADDRESS));
+    ASSERT_TRUE(recorder->frames.empty());
+
+    eventLoop.runTasks();
+
+    const char* names[] = { "wsdecoder", "wsencoder", "handshake", "recorder" };
+    ChannelPipeline::ChannelHandlers handlers = pipeline.toMap();
+
+    ASSERT_EQ(4U, handlers.size());
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(names[i], handlers[i].first);
+    }
+
+    ASSERT_EQ(2U, recorder->frames.size());
+    ASSERT_EQ("first", recorder->frames[0]->getTextData());
+    ASSERT_EQ("second", recorder->frames[1]->getTextData());
+
+    pipeline.sendUpstream(UpstreamMessageEvent(channel,
+                          ChannelMessage(ChannelBuffers::copiedBuffer(maskedFrame("third"))),
+                          SocketAddress::NULL_ADDRESS));
+    ASSERT_EQ(3U, recorder->frames.size());
+    ASSERT_EQ("third", recorder->frames[2]->getTextData());
+}
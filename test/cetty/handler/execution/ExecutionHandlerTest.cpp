@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <boost/any.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
+#include "cetty/channel/NullChannel.h"
+#include "cetty/channel/ChannelState.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/AbstractChannelSink.h"
+#include "cetty/channel/UpstreamMessageEvent.h"
+#include "cetty/channel/UpstreamChannelStateEvent.h"
+#include "cetty/channel/SimpleChannelUpstreamHandler.h"
+#include "cetty/handler/execution/ExecutionHandler.h"
+#include "cetty/handler/execution/OrderedMemoryAwareThreadPool.h"
+
+using namespace cetty::channel;
+using namespace cetty::handler::execution;
+
+/**
+ * A channel which records when its transport would delete it.
+ */
+class RetainedChannel : public NullChannel {
+public:
+    RetainedChannel() : open(true), retainCount(1) {}
+
+    virtual bool isOpen() const { return open; }
+
+    virtual void retain() { ++retainCount; }
+    virtual void release() { --retainCount; }
+
+    bool isDeleted() const { return retainCount == 0; }
+
+    boost::atomic<bool> open;
+    boost::atomic<int> retainCount;
+};
+
+class NullSink : public AbstractChannelSink {
+public:
+    virtual void writeRequested(const ChannelPipeline& pipeline, const MessageEvent& e) {}
+    virtual void stateChangeRequested(const ChannelPipeline& pipeline, const ChannelStateEvent& e) {}
+};
+
+class BlockedHandler : public SimpleChannelUpstreamHandler {
+public:
+    BlockedHandler(RetainedChannel& channel, boost::mutex& blocker)
+        : channel(channel),
+          blocker(blocker),
+          receivedCount(0),
+          closed(false),
+          deletedWhenClosed(false) {
+    }
+
+    virtual ChannelHandlerPtr clone() { return shared_from_this(); }
+    virtual std::string toString() const { return "BlockedHandler"; }
+
+    virtual void messageReceived(ChannelHandlerContext& ctx, const MessageEvent& e) {
+        boost::mutex::scoped_lock lock(blocker);
+        ++receivedCount;
+    }
+
+    virtual void channelClosed(ChannelHandlerContext& ctx, const ChannelStateEvent& e) {
+        deletedWhenClosed = channel.isDeleted();
+        closed = true;
+    }
+
+    RetainedChannel& channel;
+    boost::mutex& blocker;
+
+    boost::atomic<int> receivedCount;
+    boost::atomic<bool> closed;
+    boost::atomic<bool> deletedWhenClosed;
+};
+
+TEST(ExecutionHandlerTest, testCloseWithQueuedTasks) {
+    static const int MESSAGE_COUNT = 10;
+
+    OrderedMemoryAwareThreadPoolPtr pool(new OrderedMemoryAwareThreadPool(2, 0, 0));
+
+    RetainedChannel channel;
+    NullSink sink;
+    DefaultChannelPipeline pipeline;
+    pipeline.attach(&channel, &sink);
+
+    boost::mutex blocker;
+    boost::mutex::scoped_lock lock(blocker);
+
+    BlockedHandler* handler = new BlockedHandler(channel, blocker);
+    pipeline.addLast("execution", ChannelHandlerPtr(new ExecutionHandler(pool)));
+    pipeline.addLast("handler", ChannelHandlerPtr(handler));
+
+    for (int i = 0; i < MESSAGE_COUNT; ++i) {
+        pipeline.sendUpstream(UpstreamMessageEvent(channel,
+                              ChannelMessage(std::string("message")),
+                              SocketAddress::NULL_ADDRESS));
+    }
+    ASSERT_EQ(2, (int)channel.retainCount);
+
+    // closed in the I/O thread while the tasks are still queued, and the
+    // transport releases the channel right after.
+    channel.open = false;
+    pipeline.sendUpstream(UpstreamChannelStateEvent(channel,
+                          ChannelState::OPEN,
+                          boost::any()));
+    channel.release();
+
+    ASSERT_FALSE(channel.isDeleted());
+    ASSERT_FALSE(handler->closed);
+
+    lock.unlock();
+    pool->shutdown();
+
+    ASSERT_EQ(MESSAGE_COUNT, (int)handler->receivedCount);
+    ASSERT_TRUE(handler->closed);
+    ASSERT_FALSE(handler->deletedWhenClosed);
+
+    // released by the child executor after the last task.
+    ASSERT_TRUE(channel.isDeleted());
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <boost/thread.hpp>
+
+#include "cetty/channel/NullChannel.h"
+#include "cetty/handler/execution/OrderedMemoryAwareThreadPool.h"
+
+using namespace cetty::channel;
+using namespace cetty::handler::execution;
+
+typedef OrderedMemoryAwareThreadPool::Runnable Runnable;
+typedef OrderedMemoryAwareThreadPool::ChildExecutorPtr ChildExecutorPtr;
+
+class ToggledChannel : public NullChannel {
+public:
+    ToggledChannel() : readable(true), suspendCount(0) {}
+
+    virtual ChannelFuturePtr setReadable(bool readable) {
+        if (!readable) {
+            ++suspendCount;
+        }
+        this->readable = readable;
+        return NullChannel::setReadable(readable);
+    }
+
+    boost::atomic<bool> readable;
+    boost::atomic<int> suspendCount;
+};
+
+class RecordTask : public Runnable {
+public:
+    RecordTask(std::vector<int>& records, int value)
+        : records(records), value(value) {}
+
+    virtual void run() {
+        records.push_back(value);
+    }
+
+private:
+    std::vector<int>& records;
+    int value;
+};
+
+class BlockTask : public Runnable {
+public:
+    BlockTask(boost::mutex& mutex) : mutex(mutex) {}
+
+    virtual void run() {
+        boost::mutex::scoped_lock lock(mutex);
+    }
+
+private:
+    boost::mutex& mutex;
+};
+
+TEST(OrderedMemoryAwareThreadPoolTest, testOrderPerChannel) {
+    static const int CHANNEL_COUNT = 8;
+    static const int TASK_COUNT = 1000;
+
+    OrderedMemoryAwareThreadPoolPtr pool(new OrderedMemoryAwareThreadPool(4, 0, 0));
+
+    ToggledChannel channels[CHANNEL_COUNT];
+    std::vector<int> records[CHANNEL_COUNT];
+    std::vector<ChildExecutorPtr> children;
+
+    for (int i = 0; i < CHANNEL_COUNT; ++i) {
+        children.push_back(pool->newChildExecutor(channels[i]));
+    }
+
+    for (int j = 0; j < TASK_COUNT; ++j) {
+        for (int i = 0; i < CHANNEL_COUNT; ++i) {
+            pool->execute(children[i], new RecordTask(records[i], j), 1);
+        }
+    }
+
+    pool->shutdown();
+    ASSERT_TRUE(pool->isShutdown());
+    ASSERT_EQ(0, pool->getTotalPendingSize());
+    ASSERT_THROW(pool->execute(children[0], new RecordTask(records[0], 0), 1),
+                 IllegalStateException);
+
+    for (int i = 0; i < CHANNEL_COUNT; ++i) {
+        ASSERT_EQ(TASK_COUNT, (int)records[i].size());
+
+        for (int j = 0; j < TASK_COUNT; ++j) {
+            ASSERT_EQ(j, records[i][j]);
+        }
+    }
+}
+
+TEST(OrderedMemoryAwareThreadPoolTest, testSuspendChannel) {
+    OrderedMemoryAwareThreadPoolPtr pool(new OrderedMemoryAwareThreadPool(1, 250, 0));
+
+    ToggledChannel channel;
+    std::vector<int> records;
+    ChildExecutorPtr child = pool->newChildExecutor(channel);
+
+    boost::mutex blocker;
+    boost::mutex::scoped_lock lock(blocker);
+    pool->execute(child, new BlockTask(blocker), 0);
+
+    pool->execute(child, new RecordTask(records, 0), 100);
+    pool->execute(child, new RecordTask(records, 1), 100);
+    ASSERT_TRUE(channel.readable);
+
+    pool->execute(child, new RecordTask(records, 2), 100);
+    ASSERT_FALSE(channel.readable);
+    ASSERT_TRUE(child->isSuspended());
+    ASSERT_EQ(300, child->getPendingSize());
+
+    lock.unlock();
+    pool->shutdown();
+
+    ASSERT_TRUE(channel.readable);
+    ASSERT_EQ(1, channel.suspendCount);
+    ASSERT_EQ(3, (int)records.size());
+    ASSERT_EQ(0, child->getPendingSize());
+}
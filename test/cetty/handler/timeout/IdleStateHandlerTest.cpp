@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <boost/weak_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "cetty/buffer/ChannelBuffers.h"
+#include "cetty/channel/NullChannel.h"
+#include "cetty/channel/ChannelMessage.h"
+#include "cetty/channel/SocketAddress.h"
+#include "cetty/channel/DefaultChannelPipeline.h"
+#include "cetty/channel/AbstractChannelSink.h"
+#include "cetty/channel/UpstreamMessageEvent.h"
+#include "cetty/util/TimeUnit.h"
+#include "cetty/util/TimerFactory.h"
+#include "cetty/util/HashedWheelTimer.h"
+#include "cetty/handler/timeout/IdleState.h"
+#include "cetty/handler/timeout/IdleStateEvent.h"
+#include "cetty/handler/timeout/IdleStateHandler.h"
+#include "cetty/handler/timeout/IdleStateSweeper.h"
+#include "cetty/handler/timeout/IdleStateAwareChannelUpstreamHandler.h"
+
+using namespace cetty::buffer;
+using namespace cetty::channel;
+using namespace cetty::util;
+using namespace cetty::handler::timeout;
+
+class OpenChannel : public NullChannel {
+public:
+    virtual bool isOpen() const { return true; }
+};
+
+class NullSink : public AbstractChannelSink {
+public:
+    virtual void writeRequested(const ChannelPipeline& pipeline, const MessageEvent& e) {}
+    virtual void stateChangeRequested(const ChannelPipeline& pipeline, const ChannelStateEvent& e) {}
+};
+
+class SingleTimerFactory : public TimerFactory {
+public:
+    SingleTimerFactory(const TimerPtr& timer) : timer(timer) {}
+
+    virtual const TimerPtr& getTimer(Channel& channel) { return timer; }
+    virtual void stopTimers() { timer->stop(); }
+
+private:
+    TimerPtr timer;
+};
+
+class IdleRecorder : public IdleStateAwareChannelUpstreamHandler {
+public:
+    virtual void channelIdle(ChannelHandlerContext& ctx, const IdleStateEvent& e) {
+        states.push_back(e.getState().value());
+    }
+
+    std::vector<int> states;
+};
+
+class IdleStateHandlerTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        work.reset(new boost::asio::io_service::work(ioService));
+
+        timer = new HashedWheelTimer(ioService, 5, 64);
+        TimerFactory::resetFactory(TimerFactoryPtr(new SingleTimerFactory(timer)));
+
+        recorder = new IdleRecorder;
+        pipeline.attach(&channel, &sink);
+    }
+
+    virtual void TearDown() {
+        // stops and drops the timer before its io_service goes away.
+        TimerFactory::resetFactory();
+    }
+
+    void receive() {
+        pipeline.sendUpstream(UpstreamMessageEvent(channel,
+                              ChannelMessage(ChannelBuffers::copiedBuffer("ping")),
+                              SocketAddress::NULL_ADDRESS));
+    }
+
+    // runs the timer for a while, and receives a message every interval.
+    void runFor(int millis, int receiveInterval = 0) {
+        boost::system_time deadline =
+            boost::get_system_time() + boost::posix_time::milliseconds(millis);
+        boost::system_time nextReceive =
+            boost::get_system_time() + boost::posix_time::milliseconds(receiveInterval);
+
+        while (boost::get_system_time() < deadline) {
+            ioService.poll();
+
+            if (receiveInterval > 0 && boost::get_system_time() >= nextReceive) {
+                receive();
+                nextReceive += boost::posix_time::milliseconds(receiveInterval);
+            }
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        }
+    }
+
+    boost::asio::io_service ioService;
+    boost::scoped_ptr<boost::asio::io_service::work> work;
+    TimerPtr timer;
+
+    OpenChannel channel;
+    NullSink sink;
+    DefaultChannelPipeline pipeline;
+    IdleRecorder* recorder;
+};
+
+TEST_F(IdleStateHandlerTest, testSweepReaderIdle) {
+    pipeline.addLast("idle", ChannelHandlerPtr(
+                         new IdleStateHandler(60, 0, 0, 10, TimeUnit::MILLISECONDS)));
+    pipeline.addLast("recorder", ChannelHandlerPtr(recorder));
+
+    IdleStateSweeperPtr sweeper = IdleStateSweeper::getSweeper(NULL, timer, 10);
+    ASSERT_EQ(1, sweeper->getEntryCount());
+
+    // keeps reading, which is never idle.
+    runFor(200, 15);
+    ASSERT_TRUE(recorder->states.empty());
+
+    // idle after 60ms, and again after every 60ms.
+    runFor(200);
+    ASSERT_GE(recorder->states.size(), 2U);
+    ASSERT_LE(recorder->states.size(), 4U);
+    ASSERT_EQ(IdleState::READER_IDLE.value(), recorder->states[0]);
+
+    pipeline.remove("idle");
+    ASSERT_EQ(0, sweeper->getEntryCount());
+
+    std::size_t count = recorder->states.size();
+    runFor(100);
+    ASSERT_EQ(count, recorder->states.size());
+}
+
+TEST_F(IdleStateHandlerTest, testSweepStampsCachedTime) {
+    pipeline.addLast("idle", ChannelHandlerPtr(
+                         new IdleStateHandler(60, 0, 0, 10, TimeUnit::MILLISECONDS)));
+    pipeline.addLast("recorder", ChannelHandlerPtr(recorder));
+
+    IdleStateSweeperPtr sweeper = IdleStateSweeper::getSweeper(NULL, timer, 10);
+    IdleStateSweeper::time_type cachedTime = sweeper->getCachedTime();
+
+    // reads between the sweeps do not move the clock of the sweeper.
+    boost::this_thread::sleep(boost::posix_time::milliseconds(5));
+    receive();
+    receive();
+    ASSERT_TRUE(cachedTime == sweeper->getCachedTime());
+
+    runFor(30);
+    ASSERT_TRUE(cachedTime < sweeper->getCachedTime());
+
+    pipeline.remove("idle");
+}
+
+TEST_F(IdleStateHandlerTest, testSweepAllIdleWithClone) {
+    IdleStateHandler prototype(0, 0, 50, 10, TimeUnit::MILLISECONDS);
+    pipeline.addLast("idle", prototype.clone());
+    pipeline.addLast("recorder", ChannelHandlerPtr(recorder));
+
+    IdleStateSweeperPtr sweeper = IdleStateSweeper::getSweeper(NULL, timer, 10);
+    ASSERT_EQ(1, sweeper->getEntryCount());
+
+    runFor(120);
+    ASSERT_FALSE(recorder->states.empty());
+    ASSERT_EQ(IdleState::ALL_IDLE.value(), recorder->states[0]);
+
+    pipeline.remove("idle");
+    ASSERT_EQ(0, sweeper->getEntryCount());
+}
+
+TEST_F(IdleStateHandlerTest, testSweeperReleasedWithChannels) {
+    pipeline.addLast("idle", ChannelHandlerPtr(
+                         new IdleStateHandler(60, 0, 0, 10, TimeUnit::MILLISECONDS)));
+    // the pipeline does not notify the removal of its only handler.
+    pipeline.addLast("recorder", ChannelHandlerPtr(recorder));
+
+    boost::weak_ptr<IdleStateSweeper> sweeper =
+        IdleStateSweeper::getSweeper(NULL, timer, 10);
+    ASSERT_FALSE(sweeper.expired());
+
+    // held by the pending sweep until it finds no entry.
+    pipeline.remove("idle");
+    runFor(50);
+    ASSERT_TRUE(sweeper.expired());
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "cetty/util/Exception.h"
+#include "cetty/util/TimerTask.h"
+#include "cetty/util/HashedWheelTimer.h"
+
+using namespace cetty::util;
+
+static void record(Timeout& timeout, std::vector<int>* expired, int id) {
+    expired->push_back(id);
+}
+
+static void hold(Timeout& timeout, const boost::shared_ptr<int>& held) {
+}
+
+class RescheduleTask : public TimerTask {
+public:
+    RescheduleTask(Timer& timer) : timer(timer), count(0) {}
+
+    virtual void run(Timeout& timeout) {
+        if (++count < 3) {
+            timer.newTimeout(*this, 10);
+        }
+    }
+
+    Timer& timer;
+    int count;
+};
+
+TEST(HashedWheelTimerTest, testExpireInOrder) {
+    boost::asio::io_service ioService;
+
+    // 8 ticks of 10ms, so the 200ms timeout has to wait for 2 rounds.
+    TimerPtr timer(new HashedWheelTimer(ioService, 10, 5));
+    HashedWheelTimer& wheel = static_cast<HashedWheelTimer&>(*timer);
+    ASSERT_EQ(8, wheel.getTicksPerWheel());
+
+    std::vector<int> expired;
+    boost::system_time start = boost::get_system_time();
+
+    TimeoutPtr t50 = timer->newTimeout(boost::bind(record, _1, &expired, 50), 50);
+    TimeoutPtr t10 = timer->newTimeout(boost::bind(record, _1, &expired, 10), 10);
+    TimeoutPtr t200 = timer->newTimeout(boost::bind(record, _1, &expired, 200), 200);
+
+    ASSERT_EQ(3, wheel.getPendingCount());
+    ASSERT_TRUE(t50->isActive());
+    ASSERT_GT(t200->expiresFromNow(), 100);
+
+    // returns when there is no pending timeout to tick for.
+    ioService.run();
+
+    ASSERT_GE((boost::get_system_time() - start).total_milliseconds(), 200);
+    ASSERT_EQ(3U, expired.size());
+    ASSERT_EQ(10, expired[0]);
+    ASSERT_EQ(50, expired[1]);
+    ASSERT_EQ(200, expired[2]);
+
+    ASSERT_TRUE(t10->isExpired());
+    ASSERT_TRUE(t50->isExpired());
+    ASSERT_TRUE(t200->isExpired());
+    ASSERT_EQ(0, wheel.getPendingCount());
+}
+
+TEST(HashedWheelTimerTest, testCancelAndReschedule) {
+    boost::asio::io_service ioService;
+    TimerPtr timer(new HashedWheelTimer(ioService, 10, 16));
+    HashedWheelTimer& wheel = static_cast<HashedWheelTimer&>(*timer);
+
+    std::vector<int> expired;
+    TimeoutPtr cancelled = timer->newTimeout(boost::bind(record, _1, &expired, 1), 30);
+    TimeoutPtr kept = timer->newTimeout(boost::bind(record, _1, &expired, 2), 30);
+
+    RescheduleTask task(*timer);
+    timer->newTimeout(task, 10);
+
+    cancelled->cancel();
+    ASSERT_TRUE(cancelled->isCancelled());
+    ASSERT_EQ(2, wheel.getPendingCount());
+
+    ioService.run();
+
+    ASSERT_EQ(1U, expired.size());
+    ASSERT_EQ(2, expired[0]);
+    ASSERT_TRUE(kept->isExpired());
+    ASSERT_TRUE(cancelled->isCancelled());
+    ASSERT_EQ(3, task.count);
+    ASSERT_EQ(0, wheel.getPendingCount());
+
+    // cancelling an expired timeout does nothing.
+    kept->cancel();
+    ASSERT_TRUE(kept->isExpired());
+}
+
+TEST(HashedWheelTimerTest, testReleaseTask) {
+    boost::asio::io_service ioService;
+    TimerPtr timer(new HashedWheelTimer(ioService, 10, 16));
+
+    boost::shared_ptr<int> expiredHeld(new int(1));
+    boost::shared_ptr<int> cancelledHeld(new int(2));
+    boost::weak_ptr<int> expiredRef(expiredHeld);
+    boost::weak_ptr<int> cancelledRef(cancelledHeld);
+
+    TimeoutPtr cancelled =
+        timer->newTimeout(boost::bind(hold, _1, cancelledHeld), 10);
+    // the last scheduled timeout, which the thread keeps.
+    TimeoutPtr expired =
+        timer->newTimeout(boost::bind(hold, _1, expiredHeld), 10);
+
+    expiredHeld.reset();
+    cancelledHeld.reset();
+
+    cancelled->cancel();
+    ASSERT_TRUE(cancelledRef.expired());
+
+    ioService.run();
+    ASSERT_TRUE(expired->isExpired());
+    ASSERT_TRUE(expiredRef.expired());
+}
+
+TEST(HashedWheelTimerTest, testStop) {
+    boost::asio::io_service ioService;
+    TimerPtr timer(new HashedWheelTimer(ioService));
+
+    std::vector<int> expired;
+    TimeoutPtr timeout = timer->newTimeout(boost::bind(record, _1, &expired, 1), 1000);
+
+    timer->stop();
+    ASSERT_TRUE(timeout->isCancelled());
+    ASSERT_THROW(timer->newTimeout(boost::bind(record, _1, &expired, 2), 10),
+                 IllegalStateException);
+
+    ioService.run();
+    ASSERT_TRUE(expired.empty());
+}
+
+TEST(HashedWheelTimerTest, testInvalidArguments) {
+    boost::asio::io_service ioService;
+
+    ASSERT_THROW(HashedWheelTimer(ioService, 0, 8), InvalidArgumentException);
+    ASSERT_THROW(HashedWheelTimer(ioService, 10, 0), InvalidArgumentException);
+}
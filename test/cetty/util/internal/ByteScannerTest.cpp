@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2010-2011 frankee zhou (frankee.zhou at gmail dot com)
+ *
+ * Distributed under under the Apache License, version 2.0 (the "License").
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <string>
+#include "cetty/util/internal/ByteScanner.h"
+
+using namespace cetty::util::internal;
+
+typedef ByteScanner::ByteSet ByteSet;
+
+static int naiveFirst(const std::string& s, int offset, int length, const ByteSet& set) {
+    for (int i = 0; i < length; ++i) {
+        if (set.matches(s[offset + i])) return i;
+    }
+    return -1;
+}
+
+static int naiveLast(const std::string& s, int offset, int length, const ByteSet& set) {
+    for (int i = length - 1; i >= 0; --i) {
+        if (set.matches(s[offset + i])) return i;
+    }
+    return -1;
+}
+
+static int naiveSequence(const std::string& s, int offset, int length, const std::string& needle) {
+    std::string::size_type pos = s.substr(offset, length).find(needle);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+// a few distinct bytes, so there are matches in most of the ranges.
+static std::string randomBytes(int length) {
+    static const char alphabet[] = "ab\r\n \t\0\xff";
+    std::string s;
+    for (int i = 0; i < length; ++i) {
+        s.push_back(alphabet[std::rand() % 8]);
+    }
+    return s;
+}
+
+TEST(ByteScannerTest, testByteSetAgainstNaive) {
+    const ByteSet sets[] = {
+        ByteSet('\n'),
+        ByteSet('\0', true),
+        ByteSet('\r', '\n'),
+        ByteSet(' ', '\t', true),
+        ByteSet("ab\xff", 3),
+        ByteSet("ab\r\n", 4, true)
+    };
+
+    std::srand(7);
+    for (int round = 0; round < 200; ++round) {
+        std::string s = randomBytes(std::rand() % 300);
+        int offset = s.empty() ? 0 : std::rand() % (s.size() / 4 + 1);
+        int length = static_cast<int>(s.size()) - offset;
+
+        for (size_t k = 0; k < sizeof(sets) / sizeof(sets[0]); ++k) {
+            ASSERT_EQ(naiveFirst(s, offset, length, sets[k]),
+                      ByteScanner::findFirst(s.data() + offset, length, sets[k]));
+            ASSERT_EQ(naiveLast(s, offset, length, sets[k]),
+                      ByteScanner::findLast(s.data() + offset, length, sets[k]));
+        }
+
+        ASSERT_EQ(naiveFirst(s, offset, length, ByteSet('\xff')),
+                  ByteScanner::findFirst(s.data() + offset, length, '\xff'));
+        ASSERT_EQ(naiveLast(s, offset, length, ByteSet('\t')),
+                  ByteScanner::findLast(s.data() + offset, length, '\t'));
+    }
+}
+
+TEST(ByteScannerTest, testSequenceAgainstNaive) {
+    const char* needles[] = { "\r\n", "\r\n\r\n", "ab", "\n", "a\r\n b\t" };
+
+    std::srand(11);
+    for (int round = 0; round < 200; ++round) {
+        std::string s = randomBytes(std::rand() % 300);
+        int length = static_cast<int>(s.size());
+
+        for (size_t k = 0; k < sizeof(needles) / sizeof(needles[0]); ++k) {
+            std::string needle(needles[k]);
+            ASSERT_EQ(naiveSequence(s, 0, length, needle),
+                      ByteScanner::findSequence(s.data(), length, needle.data(), (int)needle.size()));
+        }
+
+        ASSERT_EQ(naiveSequence(s, 0, length, "\r\n"),
+                  ByteScanner::findPair(s.data(), length, '\r', '\n'));
+    }
+
+    ASSERT_EQ(0, ByteScanner::findSequence("abc", 3, "", 0));
+    ASSERT_EQ(-1, ByteScanner::findSequence("ab", 2, "abc", 3));
+}